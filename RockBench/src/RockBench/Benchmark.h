@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "RockEngine/Core/Log.h"
+
+namespace RockEngine
+{
+	class BenchmarkContext
+	{
+	public:
+		// Runs `func` once to warm up, then `iterations` times, and returns the median time in ms
+		template<typename Func>
+		double Measure(Func&& func, uint32_t iterations = 10)
+		{
+			func();
+
+			std::vector<double> samples(iterations);
+			for (double& sample : samples)
+			{
+				auto start = std::chrono::steady_clock::now();
+				func();
+				sample = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			}
+
+			std::sort(samples.begin(), samples.end());
+			return samples[samples.size() / 2];
+		}
+
+		void Report(const std::string& label, double ms, const std::string& extra = "")
+		{
+			RE_CORE_INFO("  {:<48} {:>10.3f} ms  {}", label, ms, extra);
+		}
+
+		// Logs a failed correctness check, RockBench exits non-zero if any were recorded
+		template<typename... Args>
+		void Fail(const char* format, const Args&... args)
+		{
+			RE_CORE_ERROR(format, args...);
+			m_Failures++;
+		}
+
+		template<typename... Args>
+		bool Check(bool condition, const char* format, const Args&... args)
+		{
+			if (!condition)
+				Fail(format, args...);
+			return condition;
+		}
+
+		uint32_t GetFailureCount() const { return m_Failures; }
+	private:
+		uint32_t m_Failures = 0;
+	};
+
+	using BenchmarkFunction = void(*)(BenchmarkContext&);
+
+	struct Benchmark
+	{
+		const char* Name;
+		BenchmarkFunction Function;
+	};
+
+	class BenchmarkRegistry
+	{
+	public:
+		static std::vector<Benchmark>& Get()
+		{
+			static std::vector<Benchmark> s_Benchmarks;
+			return s_Benchmarks;
+		}
+	};
+
+	struct BenchmarkRegistrar
+	{
+		BenchmarkRegistrar(const char* name, BenchmarkFunction function)
+		{
+			BenchmarkRegistry::Get().push_back({ name, function });
+		}
+	};
+
+	// Volatile, so stores to it can't be dropped
+	inline volatile char s_DoNotOptimizeSink = 0;
+
+	// Keeps the optimizer from discarding a benchmarked result
+	template<typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+		s_DoNotOptimizeSink = *reinterpret_cast<const volatile char*>(&value);
+	}
+}
+
+#define RE_BENCHMARK(name) \
+	static void name(RockEngine::BenchmarkContext& context); \
+	static RockEngine::BenchmarkRegistrar s_##name##Registrar(#name, name); \
+	static void name(RockEngine::BenchmarkContext& context)
@@ -0,0 +1,290 @@
+#include "RockBench/Benchmark.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include "RockEngine/Asset/ArchiveWriter.h"
+#include "RockEngine/Asset/AssetStreamer.h"
+#include "RockEngine/Core/Profiler.h"
+
+namespace RockEngine
+{
+	// Two thirds structured (vertex-like records, text) and one third noise (already compressed
+	// textures), 1 KB to 256 KB
+	struct AssetTestSet
+	{
+		std::vector<std::string> Names;
+		std::vector<std::vector<uint8_t>> Data;
+		uint64_t TotalBytes = 0;
+		uint32_t State = 11;
+
+		explicit AssetTestSet(uint32_t count)
+		{
+			for (uint32_t i = 0; i < count; i++)
+			{
+				size_t size = (size_t)(1024.0 * std::pow(256.0, Random() / 4294967296.0));
+				std::vector<uint8_t> data(size);
+				if (i % 3 == 2)
+				{
+					for (uint8_t& byte : data)
+						byte = (uint8_t)(Random() >> 24);
+				}
+				else
+				{
+					// 32 byte records with a few varying fields
+					for (size_t k = 0; k < size; k++)
+						data[k] = (k % 32) < 8 ? (uint8_t)(Random() >> 29) : (uint8_t)((k % 32) * 7 + (k / 4096));
+				}
+
+				static const char* s_Folders[] = { "textures", "meshes", "shaders", "audio" };
+				Names.push_back(fmt::format("{}/asset_{:05}.bin", s_Folders[i % 4], i));
+				TotalBytes += size;
+				Data.push_back(std::move(data));
+			}
+		}
+
+		uint32_t Random()
+		{
+			State = State * 1664525u + 1013904223u;
+			return State;
+		}
+	};
+
+	static double ToMB(uint64_t bytes) { return bytes / (1024.0 * 1024.0); }
+
+	RE_BENCHMARK(AssetCompression)
+	{
+		AssetTestSet set(256);
+		std::vector<std::vector<uint8_t>> compressed(set.Data.size());
+		uint64_t compressedBytes = 0;
+
+		double compressMs = context.Measure([&]()
+		{
+			compressedBytes = 0;
+			for (size_t i = 0; i < set.Data.size(); i++)
+			{
+				compressed[i].resize(Compression::GetBound(set.Data[i].size()));
+				size_t size = Compression::CompressLZ4(set.Data[i].data(), set.Data[i].size(), compressed[i].data(), compressed[i].size());
+				compressed[i].resize(size);
+				compressedBytes += size;
+			}
+		}, 3);
+		context.Report(fmt::format("LZ4 compress {:.1f} MB", ToMB(set.TotalBytes)), compressMs,
+			fmt::format("{:.0f} MB/s, ratio {:.2f}", ToMB(set.TotalBytes) / (compressMs / 1000.0), (double)set.TotalBytes / compressedBytes));
+
+		std::vector<uint8_t> output;
+		uint32_t errors = 0;
+		double decompressMs = context.Measure([&]()
+		{
+			errors = 0;
+			for (size_t i = 0; i < set.Data.size(); i++)
+			{
+				output.resize(set.Data[i].size());
+				if (!Compression::DecompressLZ4(compressed[i].data(), compressed[i].size(), output.data(), output.size()) || output != set.Data[i])
+					errors++;
+			}
+		}, 5);
+		context.Report("LZ4 decompress + compare", decompressMs, fmt::format("{:.0f} MB/s", ToMB(set.TotalBytes) / (decompressMs / 1000.0)));
+		if (errors)
+			context.Fail("AssetCompression: {} assets didn't round trip", errors);
+
+		// Corrupt input has to fail cleanly, never read or write out of bounds
+		uint32_t accepted = 0;
+		for (uint32_t trial = 0; trial < 2000; trial++)
+		{
+			std::vector<uint8_t> damaged = compressed[trial % compressed.size()];
+			if (damaged.empty())
+				continue;
+			for (uint32_t flips = 0; flips < 1 + trial % 4; flips++)
+				damaged[set.Random() % damaged.size()] ^= (uint8_t)(1 + (set.Random() >> 24) % 255);
+			if (trial % 7 == 0)
+				damaged.resize(damaged.size() / 2);
+
+			output.assign(set.Data[trial % set.Data.size()].size(), 0);
+			if (Compression::DecompressLZ4(damaged.data(), damaged.size(), output.data(), output.size()) && output != set.Data[trial % set.Data.size()])
+				accepted++;
+		}
+		// Flipped literal bytes decode fine but wrong, LZ4 has no checksum: only report it
+		RE_CORE_INFO("  damaged blocks decoded without an error: {}/2000", accepted);
+	}
+
+	RE_BENCHMARK(AssetLoading)
+	{
+		namespace fs = std::filesystem;
+
+		AssetTestSet set(2000);
+		fs::path directory = fs::temp_directory_path() / "RockBench-assets";
+		fs::remove_all(directory);
+		for (const std::string& name : set.Names)
+			fs::create_directories((directory / "loose" / name).parent_path());
+
+		for (size_t i = 0; i < set.Names.size(); i++)
+		{
+			std::ofstream stream(directory / "loose" / set.Names[i], std::ios::binary);
+			stream.write(reinterpret_cast<const char*>(set.Data[i].data()), set.Data[i].size());
+		}
+
+		std::string archivePath = (directory / "assets.rpak").string();
+		ArchiveWriter writer;
+		for (size_t i = 0; i < set.Names.size(); i++)
+			writer.Add(set.Names[i], set.Data[i].data(), set.Data[i].size());
+
+		auto packStart = std::chrono::steady_clock::now();
+		bool written = writer.Write(archivePath);
+		double packMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - packStart).count();
+		const ArchiveWriterStats& packStats = writer.GetStats();
+		context.Report(fmt::format("pack {} assets, {:.1f} MB", packStats.Assets, ToMB(packStats.InputBytes)), packMs,
+			fmt::format("{:.1f} MB archive, {} compressed", ToMB(packStats.FileBytes), packStats.Compressed));
+		if (!written)
+		{
+			context.Fail("AssetLoading: writing {} failed", archivePath);
+			return;
+		}
+
+		// Everything is in the page cache after writing, these compare the CPU side of loading
+		uint32_t errors = 0;
+		double looseMs = context.Measure([&]()
+		{
+			errors = 0;
+			for (size_t i = 0; i < set.Names.size(); i++)
+			{
+				std::ifstream stream(directory / "loose" / set.Names[i], std::ios::binary);
+				std::vector<uint8_t> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+				errors += data.size() != set.Data[i].size();
+			}
+		}, 5);
+		context.Report("loose files, open + read", looseMs);
+
+		double archiveMs = context.Measure([&]()
+		{
+			AssetArchive archive;
+			archive.Open(archivePath);
+			std::vector<uint8_t> buffer;
+			for (size_t i = 0; i < set.Names.size(); i++)
+			{
+				const ArchiveEntry* entry = archive.Find(set.Names[i]);
+				if (!entry)
+				{
+					errors++;
+					continue;
+				}
+
+				AssetView view = archive.GetView(*entry);
+				const uint8_t* data = view.Data;
+				if (view.Compression != CompressionType::None)
+				{
+					buffer.resize((size_t)entry->Size);
+					archive.Read(*entry, buffer.data());
+					data = buffer.data();
+				}
+				errors += std::memcmp(data, set.Data[i].data(), set.Data[i].size()) != 0;
+			}
+		}, 5);
+		context.Report("archive, map + find + view/decompress + compare", archiveMs, fmt::format("{:.1f}x", looseMs / archiveMs));
+
+		AssetArchive archive;
+		archive.Open(archivePath);
+
+		uint32_t lookups = 0;
+		double findMs = context.Measure([&]()
+		{
+			lookups = 0;
+			for (uint32_t round = 0; round < 100; round++)
+			{
+				for (const std::string& name : set.Names)
+					lookups += archive.Find(name) != nullptr;
+			}
+		});
+		context.Report(fmt::format("{} lookups", set.Names.size() * 100), findMs, fmt::format("{:.0f} ns each", findMs * 1e6 / (set.Names.size() * 100)));
+		errors += lookups != set.Names.size() * 100;
+		errors += archive.Find("textures/missing.bin") != nullptr;
+		errors += archive.Find("textures\\asset_00000.bin") != archive.Find("textures/asset_00000.bin");
+
+		// Streaming from the main loop: one Update per frame until everything called back
+		uint32_t callbacks = 0, zeroCopy = 0, frames = 0;
+		LoadPriority lastPriority = LoadPriority::Critical;
+		bool orderKept = true;
+		double worstUpdateMs = 0.0;
+
+		auto streamStart = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < set.Names.size(); i++)
+		{
+			LoadPriority priority = (LoadPriority)(i % 4);
+			AssetStreamer::Load(archive, set.Names[i], priority, [&, i](AssetLoadResult& result)
+			{
+				callbacks++;
+				zeroCopy += result.Data.IsZeroCopy();
+				if (result.Status != AssetLoadStatus::Loaded || result.Data.GetSize() != set.Data[i].size()
+					|| std::memcmp(result.Data.GetData(), set.Data[i].data(), set.Data[i].size()) != 0)
+					errors++;
+
+				// Loads start most important first, so lower priorities only finish after the higher ones
+				if (frames == 0 && result.Priority > lastPriority)
+					orderKept = false;
+				lastPriority = result.Priority;
+			});
+		}
+		AssetStreamer::Load(archive, "shaders/missing.glsl", LoadPriority::Low, [&](AssetLoadResult& result)
+		{
+			errors += result.Status != AssetLoadStatus::NotFound;
+			callbacks++;
+		});
+
+		while (callbacks < set.Names.size() + 1 && frames < 100000)
+		{
+			auto updateStart = std::chrono::steady_clock::now();
+			AssetStreamer::Update();
+			worstUpdateMs = std::max(worstUpdateMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - updateStart).count());
+			frames++;
+		}
+		double streamMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - streamStart).count();
+		context.Report("streamed with AssetStreamer::Update", streamMs,
+			fmt::format("{} frames, worst Update {:.2f} ms, {} zero copy", frames, worstUpdateMs, zeroCopy));
+
+		callbacks = 0;
+		auto flushStart = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < set.Names.size(); i++)
+			AssetStreamer::Load(archive, set.Names[i], LoadPriority::Normal, [&](AssetLoadResult&) { callbacks++; });
+		AssetStreamer::Flush();
+		double flushMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - flushStart).count();
+		context.Report("streamed with AssetStreamer::Flush", flushMs, fmt::format("{:.0f} MB/s", ToMB(set.TotalBytes) / (flushMs / 1000.0)));
+		errors += callbacks != set.Names.size();
+
+		if (!orderKept)
+			context.Fail("AssetLoading: a lower priority load called back before a higher one in the first frame");
+		if (errors)
+			context.Fail("AssetLoading: {} assets failed to load or compare", errors);
+
+		uint32_t compressedEntry = 0;
+		while (compressedEntry < archive.GetAssetCount() && archive.GetEntry(compressedEntry).Compression != CompressionType::LZ4)
+			compressedEntry++;
+
+		// A truncated copy has to be refused when opening
+		archive.Close();
+		fs::copy_file(archivePath, directory / "truncated.rpak");
+		fs::resize_file(directory / "truncated.rpak", fs::file_size(archivePath) / 2);
+		RE_CORE_INFO("  opening a truncated copy, one error expected:");
+		AssetArchive truncated;
+		if (truncated.Open((directory / "truncated.rpak").string()))
+			context.Fail("AssetLoading: opened a truncated archive");
+
+		// So does one with a compressed asset larger than its data can decompress to
+		fs::copy_file(archivePath, directory / "damaged.rpak");
+		{
+			std::fstream damaged(directory / "damaged.rpak", std::ios::binary | std::ios::in | std::ios::out);
+			const uint64_t size = ~0ull;
+			damaged.seekp(sizeof(ArchiveHeader) + (uint64_t)compressedEntry * sizeof(ArchiveEntry) + offsetof(ArchiveEntry, Size));
+			damaged.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		}
+		RE_CORE_INFO("  opening a copy with a damaged entry, one error expected:");
+		AssetArchive damaged;
+		if (damaged.Open((directory / "damaged.rpak").string()))
+			context.Fail("AssetLoading: opened an archive with a damaged entry");
+
+		fs::remove_all(directory);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "RockBench/Benchmark.h"
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <thread>
+
+#include "RockEngine/Asset/AssetHotReload.h"
+#include "RockEngine/Core/Profiler.h"
+
+namespace RockEngine
+{
+	namespace fs = std::filesystem;
+
+	static constexpr uint32_t s_StandaloneAssets = 200;
+
+	static void WriteText(const fs::path& path, const std::string& text)
+	{
+		std::ofstream(path, std::ios::trunc) << text;
+	}
+
+	// What the game would see of every asset: its contents, and which Update swapped it in
+	struct HotReloadObserver
+	{
+		std::map<std::string, std::string> Contents;
+		std::map<std::string, uint32_t> SwappedInUpdate;
+		std::map<std::string, std::atomic<uint32_t>> Processed;
+		uint32_t Update = 0;
+
+		void Register(const fs::path& directory, const std::string& name)
+		{
+			std::atomic<uint32_t>* processed = &Processed[name];
+			AssetHotReload::Register(name, (directory / name).string(),
+				[processed](const std::string& source, std::vector<uint8_t>& output, std::vector<std::string>& dependencies)
+				{
+					processed->fetch_add(1);
+					return AssetHotReload::ExpandIncludes(source, output, dependencies);
+				},
+				[this](std::string_view asset, AssetData& data)
+				{
+					Contents[std::string(asset)].assign(reinterpret_cast<const char*>(data.GetData()), data.GetSize());
+					SwappedInUpdate[std::string(asset)] = Update;
+				});
+		}
+
+		uint32_t GetProcessedTotal()
+		{
+			uint32_t total = 0;
+			for (auto& [name, count] : Processed)
+				total += count.load();
+			return total;
+		}
+
+		// Runs frames until `reloads` more assets were swapped in, returns the wall time in ms or -1
+		double WaitForReloads(uint64_t reloads)
+		{
+			uint64_t target = AssetHotReload::GetStats().Reloaded + reloads;
+			uint64_t start = Profiler::Now();
+			while (AssetHotReload::GetStats().Reloaded < target)
+			{
+				if (Profiler::Now() - start > 3000000000ull)
+					return -1.0;
+				Update++;
+				AssetHotReload::Update();
+				std::this_thread::sleep_for(std::chrono::microseconds(250));
+			}
+			return (Profiler::Now() - start) / 1e6;
+		}
+	};
+
+	RE_BENCHMARK(AssetHotReload)
+	{
+		const fs::path directory = fs::temp_directory_path() / "RockBenchHotReload";
+		fs::remove_all(directory);
+		fs::create_directories(directory / "shaders" / "include");
+		fs::create_directories(directory / "data");
+
+		// lit.glsl -> lighting.glsl -> common.glsl <- flat.glsl, unlit.glsl includes nothing
+		WriteText(directory / "shaders/include/common.glsl", "#define PI 3.14159\n");
+		WriteText(directory / "shaders/include/lighting.glsl", "#include \"common.glsl\"\nfloat Lambert(float x) { return x / PI; }\n");
+		WriteText(directory / "shaders/lit.glsl", "#include \"include/lighting.glsl\"\nvoid main() {}\n");
+		WriteText(directory / "shaders/flat.glsl", "  #include \"include/common.glsl\"\nvoid main() {}\n");
+		WriteText(directory / "shaders/unlit.glsl", "void main() {}\n");
+		for (uint32_t i = 0; i < s_StandaloneAssets; i++)
+			WriteText(directory / fmt::format("data/{}.txt", i), std::string(4096, (char)('a' + i % 26)));
+
+		AssetHotReloadProps props;
+		props.Directory = directory.string();
+		props.Watcher.CoalesceMs = 20.0f;
+		if (!AssetHotReload::Init(props))
+		{
+#ifdef __linux__
+			context.Fail("AssetHotReload: can't watch {}", directory.string());
+#else
+			RE_CORE_WARN("AssetHotReload: no file watching here, skipped");
+#endif
+			fs::remove_all(directory);
+			return;
+		}
+
+		HotReloadObserver observer;
+		for (const char* shader : { "shaders/lit.glsl", "shaders/flat.glsl", "shaders/unlit.glsl" })
+			observer.Register(directory, shader);
+		for (uint32_t i = 0; i < s_StandaloneAssets; i++)
+			observer.Register(directory, fmt::format("data/{}.txt", i));
+
+		uint64_t start = Profiler::Now();
+		AssetHotReload::Flush();
+		AssetHotReloadStats stats = AssetHotReload::GetStats();
+		context.Report(fmt::format("Register + process {} assets", stats.Assets), (Profiler::Now() - start) / 1e6, fmt::format("{} files in the graph", stats.Files));
+		if (observer.Contents["shaders/lit.glsl"] != "#define PI 3.14159\nfloat Lambert(float x) { return x / PI; }\nvoid main() {}\n")
+			context.Fail("AssetHotReload: lit.glsl's includes weren't expanded");
+
+		// A shared include: exactly its two dependents are reprocessed, and swapped in together
+		uint32_t processedBefore = observer.GetProcessedTotal();
+		WriteText(directory / "shaders/include/common.glsl", "#define PI 3.14159265\n");
+		double waitMs = observer.WaitForReloads(2);
+		uint32_t processed = observer.GetProcessedTotal() - processedBefore;
+		if (waitMs < 0.0 || processed != 2 || observer.SwappedInUpdate["shaders/lit.glsl"] != observer.SwappedInUpdate["shaders/flat.glsl"]
+			|| observer.Contents["shaders/flat.glsl"].find("3.14159265") == std::string::npos)
+			context.Fail("AssetHotReload: changing common.glsl reprocessed {} assets, expected lit and flat in the same frame", processed);
+		context.Report("Include changed, 2 of 203 assets reloaded", AssetHotReload::GetStats().LastLatencyMs,
+			fmt::format("change to swap, {:.0f} ms of it coalescing", props.Watcher.CoalesceMs));
+
+		// A burst of saves is one reprocess
+		processedBefore = observer.GetProcessedTotal();
+		for (uint32_t i = 0; i < 50; i++)
+			WriteText(directory / "shaders/unlit.glsl", fmt::format("void main() {{ /* {} */ }}\n", i));
+		waitMs = observer.WaitForReloads(1);
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		AssetHotReload::Update();
+		processed = observer.GetProcessedTotal() - processedBefore;
+		if (waitMs < 0.0 || processed != 1 || observer.Contents["shaders/unlit.glsl"] != "void main() { /* 49 */ }\n")
+			context.Fail("AssetHotReload: 50 saves of unlit.glsl were processed {} times, expected once with the last contents", processed);
+		context.Report("50 saves in a burst", AssetHotReload::GetStats().LastLatencyMs, fmt::format("{} reprocess", processed));
+
+		// Dependencies are learned from processing: a new include that doesn't exist yet fails,
+		// and creating it reloads the asset that asked for it
+		RE_CORE_INFO("  including a missing file, two errors expected:");
+		WriteText(directory / "shaders/unlit.glsl", "#include \"include/fog.glsl\"\nvoid main() {}\n");
+		uint64_t failedBefore = AssetHotReload::GetStats().Failed;
+		for (uint64_t wait = Profiler::Now(); AssetHotReload::GetStats().Failed == failedBefore && Profiler::Now() - wait < 3000000000ull; )
+		{
+			AssetHotReload::Update();
+			std::this_thread::sleep_for(std::chrono::microseconds(250));
+		}
+		WriteText(directory / "shaders/include/fog.glsl", "float Fog() { return 1.0; }\n");
+		waitMs = observer.WaitForReloads(1);
+		if (waitMs < 0.0 || observer.Contents["shaders/unlit.glsl"] != "float Fog() { return 1.0; }\nvoid main() {}\n")
+			context.Fail("AssetHotReload: creating a missing include didn't reload unlit.glsl");
+		context.Report("Missing include created", AssetHotReload::GetStats().LastLatencyMs);
+
+		// Everything at once, the standalone assets are processed in parallel on the job system
+		processedBefore = observer.GetProcessedTotal();
+		for (uint32_t i = 0; i < s_StandaloneAssets; i++)
+			WriteText(directory / fmt::format("data/{}.txt", i), std::string(4096, (char)('A' + i % 26)));
+		waitMs = observer.WaitForReloads(s_StandaloneAssets);
+		processed = observer.GetProcessedTotal() - processedBefore;
+		if (waitMs < 0.0 || processed != s_StandaloneAssets)
+			context.Fail("AssetHotReload: rewriting {} assets reprocessed {}", s_StandaloneAssets, processed);
+		context.Report(fmt::format("{} assets rewritten at once", s_StandaloneAssets), AssetHotReload::GetStats().LastLatencyMs,
+			fmt::format("{} change batches so far", AssetHotReload::GetStats().Batches));
+
+		AssetHotReload::Shutdown();
+		fs::remove_all(directory);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "RockBench/Benchmark.h"
+
+#include "RockEngine/Core/JobSystem.h"
+#include "RockEngine/Core/LayerStack.h"
+#include "RockEngine/Events/EventQueue.h"
+
+namespace RockEngine
+{
+	static constexpr uint32_t s_EventCount = 1000000;
+	static constexpr uint32_t s_BatchSize = 256;
+
+	static Event MakeInputEvent(uint32_t i)
+	{
+		switch (i & 3)
+		{
+			case 0:  return Event::Make(MouseMovedEvent{ (float)(i & 1023), (float)(i >> 10) });
+			case 1:  return Event::Make(KeyPressedEvent{ (int32_t)(i & 255), 0, false });
+			case 2:  return Event::Make(KeyReleasedEvent{ (int32_t)(i & 255), 0 });
+			default: return Event::Make(MouseScrolledEvent{ 0.0f, 1.0f });
+		}
+	}
+
+	class InputLayer : public Layer
+	{
+	public:
+		InputLayer()
+			: Layer("InputLayer")
+		{
+			Subscribe<&InputLayer::OnMouseMoved>();
+			Subscribe<&InputLayer::OnKeyPressed>();
+			Subscribe<&InputLayer::OnKeyReleased>();
+			Subscribe<&InputLayer::OnMouseScrolled>();
+		}
+
+		bool OnMouseMoved(const MouseMovedEvent& event) { Checksum += (uint64_t)event.X; return true; }
+		bool OnKeyPressed(const KeyPressedEvent& event) { Checksum += event.KeyCode; return true; }
+		bool OnKeyReleased(const KeyReleasedEvent& event) { Checksum -= event.KeyCode; return true; }
+		bool OnMouseScrolled(const MouseScrolledEvent& /*event*/) { Checksum++; return true; }
+
+		uint64_t Checksum = 0;
+	};
+
+	// Sees key events first and lets them through, like an overlay that only sometimes captures
+	class PassThroughOverlay : public Layer
+	{
+	public:
+		PassThroughOverlay()
+			: Layer("PassThroughOverlay")
+		{
+			Subscribe<&PassThroughOverlay::OnKeyPressed>();
+		}
+
+		bool OnKeyPressed(const KeyPressedEvent& /*event*/) { Seen++; return false; }
+
+		uint64_t Seen = 0;
+	};
+
+	RE_BENCHMARK(EventQueueDispatch)
+	{
+		EventQueue queue(s_BatchSize * 64);
+		LayerStack stack;
+		InputLayer* input = new InputLayer();
+		PassThroughOverlay* overlay = new PassThroughOverlay();
+		stack.PushLayer(new Layer("Idle"));
+		stack.PushLayer(input);
+		stack.PushOverlay(overlay);
+
+		// Producer and consumer alternate on one thread, roughly what the main loop does
+		Event batch[s_BatchSize];
+		uint64_t runs = 0;
+		double ms = context.Measure([&]()
+		{
+			runs++;
+			for (uint32_t i = 0; i < s_EventCount; i += queue.GetCapacity())
+			{
+				uint32_t end = std::min(s_EventCount, i + queue.GetCapacity());
+				for (uint32_t k = i; k < end; k++)
+					queue.Push(MakeInputEvent(k));
+
+				uint32_t count;
+				while ((count = queue.PopBatch(batch, s_BatchSize)) > 0)
+					stack.DispatchEvents(batch, count);
+			}
+		});
+		DoNotOptimize(input->Checksum);
+
+		context.Report("1M events push + batched dispatch", ms, fmt::format("{:.1f} M events/s", s_EventCount / ms / 1000.0));
+
+		if (overlay->Seen != (uint64_t)(s_EventCount / 4) * runs || queue.GetDropped() != 0)
+			context.Fail("EventQueueDispatch: overlay saw {} key presses, {} dropped", overlay->Seen, queue.GetDropped());
+	}
+
+	RE_BENCHMARK(EventQueueProducers)
+	{
+		EventQueue queue(s_EventCount);
+
+		// Every worker pushes concurrently, then the consumer drains everything
+		double pushMs = context.Measure([&]()
+		{
+			JobSystem::ParallelFor(s_EventCount, JobSystem::GetDefaultGrainSize(s_EventCount, 4096), [&](uint32_t begin, uint32_t end)
+			{
+				for (uint32_t i = begin; i < end; i++)
+					queue.Push(MakeInputEvent(i));
+			});
+
+			Event batch[s_BatchSize];
+			uint64_t drained = 0;
+			uint32_t count;
+			while ((count = queue.PopBatch(batch, s_BatchSize)) > 0)
+				drained += count;
+			DoNotOptimize(drained);
+		});
+
+		context.Report(fmt::format("1M events from {} workers + drain", JobSystem::GetWorkerCount()), pushMs,
+			fmt::format("{:.1f} M events/s", s_EventCount / pushMs / 1000.0));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "RockBench/Benchmark.h"
+
+#include <cmath>
+#include <thread>
+
+#include "RockEngine/Core/JobSystem.h"
+
+namespace RockEngine
+{
+	static std::vector<uint32_t> GetWorkerCounts()
+	{
+		uint32_t maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+		std::vector<uint32_t> counts;
+		for (uint32_t count = 1; count < maxWorkers; count *= 2)
+			counts.push_back(count);
+		counts.push_back(maxWorkers);
+		return counts;
+	}
+
+	RE_BENCHMARK(JobSystemScaling)
+	{
+		constexpr uint32_t count = 1 << 20;
+		std::vector<float> data(count);
+
+		double baseline = 0.0;
+		for (uint32_t workers : GetWorkerCounts())
+		{
+			JobSystem::Shutdown();
+			JobSystem::Init({ workers });
+
+			double ms = context.Measure([&]()
+			{
+				JobSystem::ParallelFor(count, JobSystem::GetDefaultGrainSize(count, 1024), [&](uint32_t begin, uint32_t end)
+				{
+					for (uint32_t i = begin; i < end; i++)
+					{
+						float x = (float)i;
+						for (uint32_t k = 0; k < 16; k++)
+							x = std::sqrt(x * 1.0001f + 1.0f);
+						data[i] = x;
+					}
+				});
+			});
+			DoNotOptimize(data[count / 2]);
+
+			if (workers == 1)
+				baseline = ms;
+			context.Report("ParallelFor 1M x 16 sqrt, " + std::to_string(workers) + " workers", ms,
+				fmt::format("{:.2f}x", baseline / ms));
+		}
+
+		JobSystem::Shutdown();
+		JobSystem::Init();
+	}
+
+	RE_BENCHMARK(JobSystemOverhead)
+	{
+		constexpr uint32_t jobs = 100000;
+		std::atomic<uint32_t> executed{ 0 };
+
+		double ms = context.Measure([&]()
+		{
+			JobCounter counter;
+			for (uint32_t i = 0; i < jobs; i++)
+				JobSystem::Run([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); }, &counter);
+			JobSystem::Wait(counter);
+		});
+
+		context.Report("100k empty jobs, " + std::to_string(JobSystem::GetWorkerCount()) + " workers", ms,
+			fmt::format("{:.1f} ns/job", ms * 1e6 / jobs));
+	}
+}
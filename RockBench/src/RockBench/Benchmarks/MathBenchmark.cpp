@@ -0,0 +1,324 @@
+#include "RockBench/Benchmark.h"
+
+#include <cmath>
+
+#include "RockEngine/Math/Math.h"
+
+namespace RockEngine
+{
+	static constexpr uint32_t s_BatchCount = 100003;	// not a multiple of 8, so the tails run too
+
+	// Calls func(tag) for every backend the build has
+	template<typename Func>
+	static void ForEachBackend(Func&& func)
+	{
+		func(SimdScalar{});
+	#ifdef RE_SIMD_SSE
+		func(SimdSSE{});
+	#endif
+	#ifdef RE_SIMD_AVX
+		func(SimdAVX{});
+	#endif
+	}
+
+	static float RandomFloat(uint32_t& state, float low, float high)
+	{
+		state = state * 1664525u + 1013904223u;
+		return low + (high - low) * (float)(state >> 8) / (float)(1u << 24);
+	}
+
+	// Double precision reference, written independently of the library: column-major 4x4
+	struct ReferenceMat4
+	{
+		double M[16];
+	};
+
+	static ReferenceMat4 ReferenceMultiply(const ReferenceMat4& a, const ReferenceMat4& b)
+	{
+		ReferenceMat4 r = {};
+		for (int column = 0; column < 4; column++)
+		{
+			for (int row = 0; row < 4; row++)
+			{
+				for (int k = 0; k < 4; k++)
+					r.M[column * 4 + row] += a.M[k * 4 + row] * b.M[column * 4 + k];
+			}
+		}
+		return r;
+	}
+
+	static ReferenceMat4 ReferenceTRS(const float t[3], const float q[4], const float s[3])
+	{
+		double x = q[0], y = q[1], z = q[2], w = q[3];
+		double rotation[9] =
+		{
+			1 - 2 * (y * y + z * z), 2 * (x * y + w * z), 2 * (x * z - w * y),
+			2 * (x * y - w * z), 1 - 2 * (x * x + z * z), 2 * (y * z + w * x),
+			2 * (x * z + w * y), 2 * (y * z - w * x), 1 - 2 * (x * x + y * y)
+		};
+
+		ReferenceMat4 r = {};
+		for (int column = 0; column < 3; column++)
+		{
+			for (int row = 0; row < 3; row++)
+				r.M[column * 4 + row] = rotation[column * 3 + row] * s[column];
+		}
+		r.M[12] = t[0];
+		r.M[13] = t[1];
+		r.M[14] = t[2];
+		r.M[15] = 1.0;
+		return r;
+	}
+
+	template<typename B>
+	static ReferenceMat4 ToReference(const BasicMat4<B>& m)
+	{
+		ReferenceMat4 r;
+		for (int i = 0; i < 16; i++)
+			r.M[i] = m.Data()[i];
+		return r;
+	}
+
+	template<typename B>
+	static double MatrixError(const BasicMat4<B>& m, const ReferenceMat4& reference)
+	{
+		double error = 0.0;
+		for (int i = 0; i < 16; i++)
+			error = std::max(error, std::abs(m.Data()[i] - reference.M[i]));
+		return error;
+	}
+
+	template<typename B>
+	static double IdentityError(const BasicMat4<B>& m)
+	{
+		return MatrixError(m, ToReference(BasicMat4<B>::Identity()));
+	}
+
+	template<typename B>
+	static double VectorError(const BasicVec3<B>& a, const BasicVec3<B>& b)
+	{
+		return std::max({ std::abs(a.GetX() - b.GetX()), std::abs(a.GetY() - b.GetY()), std::abs(a.GetZ() - b.GetZ()) });
+	}
+
+	// Inputs for the batch kernels, as SoA streams
+	struct TransformStreams
+	{
+		std::vector<float> T[3], R[4], S[3];
+
+		TransformStreams(uint32_t count)
+		{
+			uint32_t state = 7;
+			for (auto& stream : T)
+				stream.resize(count);
+			for (auto& stream : R)
+				stream.resize(count);
+			for (auto& stream : S)
+				stream.resize(count);
+
+			for (uint32_t i = 0; i < count; i++)
+			{
+				for (auto& stream : T)
+					stream[i] = RandomFloat(state, -100.0f, 100.0f);
+				for (auto& stream : S)
+					stream[i] = RandomFloat(state, 0.5f, 2.0f);
+
+				float q[4], length = 0.0f;
+				for (float& component : q)
+				{
+					component = RandomFloat(state, -1.0f, 1.0f);
+					length += component * component;
+				}
+				for (int k = 0; k < 4; k++)
+					R[k][i] = q[k] / std::sqrt(length);
+			}
+		}
+
+		ConstVec3Stream Translations() const { return { T[0].data(), T[1].data(), T[2].data() }; }
+		ConstQuatStream Rotations() const { return { R[0].data(), R[1].data(), R[2].data(), R[3].data() }; }
+		ConstVec3Stream Scales() const { return { S[0].data(), S[1].data(), S[2].data() }; }
+
+		void Get(uint32_t i, float t[3], float q[4], float s[3]) const
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				t[k] = T[k][i];
+				s[k] = S[k][i];
+			}
+			for (int k = 0; k < 4; k++)
+				q[k] = R[k][i];
+		}
+	};
+
+	struct AccuracyReport
+	{
+		double Matrices = 0.0;
+		double Inverses = 0.0;
+		double Quaternions = 0.0;
+		double Batches = 0.0;
+	};
+
+	template<typename B>
+	static AccuracyReport CheckAccuracy(const TransformStreams& streams)
+	{
+		using Vec3 = BasicVec3<B>;
+		using Vec4 = BasicVec4<B>;
+		using Quat = BasicQuat<B>;
+		using Mat3 = BasicMat3<B>;
+		using Mat4 = BasicMat4<B>;
+
+		AccuracyReport report;
+		uint32_t state = 1;
+		auto randomMatrix = [&state]()
+		{
+			float elements[16];
+			for (float& element : elements)
+				element = RandomFloat(state, -2.0f, 2.0f);
+			return Mat4::FromData(elements);
+		};
+
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			Mat4 a = randomMatrix(), b = randomMatrix();
+			report.Matrices = std::max(report.Matrices, MatrixError(a * b, ReferenceMultiply(ToReference(a), ToReference(b))));
+
+			// Mat4 * Vec4 is the product with a matrix whose first column is the vector
+			Vec4 v(RandomFloat(state, -2.0f, 2.0f), RandomFloat(state, -2.0f, 2.0f), RandomFloat(state, -2.0f, 2.0f), RandomFloat(state, -2.0f, 2.0f));
+			Vec4 av = a * v;
+			ReferenceMat4 column = ReferenceMultiply(ToReference(a), ToReference(Mat4(v, Vec4(), Vec4(), Vec4())));
+			float product[4] = { av.GetX(), av.GetY(), av.GetZ(), av.GetW() };
+			for (int k = 0; k < 4; k++)
+				report.Matrices = std::max(report.Matrices, std::abs(product[k] - column.M[k]));
+
+			float t[3], q[4], s[3];
+			streams.Get(i, t, q, s);
+			Vec3 translation(t[0], t[1], t[2]), scale(s[0], s[1], s[2]);
+			Quat rotation(q[0], q[1], q[2], q[3]);
+			Mat4 trs = Mat4::TRS(translation, rotation, scale);
+			report.Matrices = std::max(report.Matrices, MatrixError(trs, ReferenceTRS(t, q, s)) / 100.0);
+
+			// Translations are up to 100, so these are relative
+			report.Inverses = std::max(report.Inverses, IdentityError(trs * trs.AffineInverse()) / 100.0);
+			report.Inverses = std::max(report.Inverses, IdentityError(trs.Inverse() * trs) / 100.0);
+			Mat4 projection = Mat4::Perspective(RandomFloat(state, 0.5f, 2.0f), RandomFloat(state, 0.5f, 2.0f), 0.1f, 100.0f);
+			report.Inverses = std::max(report.Inverses, IdentityError(projection * projection.Inverse()));
+			Mat3 linear = trs.GetMat3();
+			report.Inverses = std::max(report.Inverses, IdentityError(Mat4(linear * linear.Inverse(), Vec3())));
+
+			Quat other = Quat::FromAxisAngle(Normalize(Vec3(RandomFloat(state, -1.0f, 1.0f), RandomFloat(state, -1.0f, 1.0f), 1.0f)), RandomFloat(state, -Pi, Pi));
+			Vec3 point(RandomFloat(state, -2.0f, 2.0f), RandomFloat(state, -2.0f, 2.0f), RandomFloat(state, -2.0f, 2.0f));
+			report.Quaternions = std::max(report.Quaternions, VectorError(rotation.Rotate(point), Mat3::Rotation(rotation) * point));
+			report.Quaternions = std::max(report.Quaternions, VectorError((rotation * other).Rotate(point), rotation.Rotate(other.Rotate(point))));
+			report.Quaternions = std::max(report.Quaternions, VectorError((rotation * rotation.Inverse()).Rotate(point), point));
+			report.Quaternions = std::max(report.Quaternions, VectorError(Slerp(rotation, other, 1.0f).Rotate(point), other.Rotate(point)));
+		}
+
+		// Batch kernels against the reference, on a count with a tail
+		uint32_t count = 1003;
+		std::vector<Mat4> matrices(count), products(count);
+		BatchKernels<B>::BuildTRS(streams.Translations(), streams.Rotations(), streams.Scales(), matrices.data(), count);
+		Mat4 parent = randomMatrix();
+		BatchKernels<B>::MultiplyMatrices(parent, matrices.data(), products.data(), count);
+
+		std::vector<float> points[3];
+		for (auto& stream : points)
+			stream.resize(count);
+		BatchKernels<B>::TransformPoints(parent, streams.Translations(), { points[0].data(), points[1].data(), points[2].data() }, count);
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			float t[3], q[4], s[3];
+			streams.Get(i, t, q, s);
+			ReferenceMat4 trs = ReferenceTRS(t, q, s);
+			report.Batches = std::max(report.Batches, MatrixError(matrices[i], trs) / 100.0);
+			report.Batches = std::max(report.Batches, MatrixError(products[i], ReferenceMultiply(ToReference(parent), trs)) / 100.0);
+
+			for (int row = 0; row < 3; row++)
+			{
+				double expected = parent.Get(row, 3);
+				for (int k = 0; k < 3; k++)
+					expected += parent.Get(row, k) * (double)t[k];
+				report.Batches = std::max(report.Batches, std::abs(points[row][i] - expected) / 100.0);
+			}
+		}
+		return report;
+	}
+
+	RE_BENCHMARK(MathAccuracy)
+	{
+		TransformStreams streams(1024);
+		ForEachBackend([&](auto backend)
+		{
+			using B = decltype(backend);
+			AccuracyReport report = CheckAccuracy<B>(streams);
+			RE_CORE_INFO("  {:<8} matrices {:.1e}  inverses {:.1e}  quaternions {:.1e}  batches {:.1e}", SimdTraits<B>::Name,
+				report.Matrices, report.Inverses, report.Quaternions, report.Batches);
+
+			// A few ulps of the largest intermediate
+			if (report.Matrices > 1e-5 || report.Inverses > 1e-4 || report.Quaternions > 1e-5 || report.Batches > 1e-5)
+				context.Fail("MathAccuracy: {} backend is off the double precision reference", SimdTraits<B>::Name);
+		});
+	}
+
+	RE_BENCHMARK(MathBatchKernels)
+	{
+		TransformStreams streams(s_BatchCount);
+		std::vector<Mat4> matrices(s_BatchCount), products(s_BatchCount);
+		std::vector<float> points[3];
+		for (auto& stream : points)
+			stream.resize(s_BatchCount);
+		Mat4 parent = Mat4::TRS(Vec3(1.0f, 2.0f, 3.0f), Quat::FromAxisAngle(Vec3(0.0f, 1.0f, 0.0f), 0.5f), Vec3(2.0f));
+
+		// What code without the batch kernels does: one element at a time, AoS
+		std::vector<Vec3> aosPoints(s_BatchCount);
+		for (uint32_t i = 0; i < s_BatchCount; i++)
+			aosPoints[i] = Vec3(streams.T[0][i], streams.T[1][i], streams.T[2][i]);
+
+		double pointsMs = context.Measure([&]()
+		{
+			for (Vec3& point : aosPoints)
+				point = parent.TransformPoint(point);
+		});
+		context.Report("100k Mat4::TransformPoint (AoS)", pointsMs);
+
+		double trsMs = context.Measure([&]()
+		{
+			for (uint32_t i = 0; i < s_BatchCount; i++)
+			{
+				matrices[i] = Mat4::TRS(Vec3(streams.T[0][i], streams.T[1][i], streams.T[2][i]),
+					Quat(streams.R[0][i], streams.R[1][i], streams.R[2][i], streams.R[3][i]),
+					Vec3(streams.S[0][i], streams.S[1][i], streams.S[2][i]));
+			}
+		});
+		context.Report("100k Mat4::TRS", trsMs);
+
+		double multiplyMs = context.Measure([&]()
+		{
+			for (uint32_t i = 0; i < s_BatchCount; i++)
+				products[i] = parent * matrices[i];
+		});
+		context.Report("100k parent * local", multiplyMs);
+
+		ForEachBackend([&](auto backend)
+		{
+			using B = decltype(backend);
+			using Kernels = BatchKernels<B>;
+			using BackendMat4 = BasicMat4<B>;
+			std::vector<BackendMat4> backendMatrices(s_BatchCount), backendProducts(s_BatchCount);
+			BackendMat4 backendParent = BackendMat4::FromData(parent.Data());
+			Vec3Stream out = { points[0].data(), points[1].data(), points[2].data() };
+
+			double ms = context.Measure([&]() { Kernels::TransformPoints(backendParent, streams.Translations(), out, s_BatchCount); });
+			context.Report(fmt::format("100k TransformPoints ({})", SimdTraits<B>::Name), ms, fmt::format("{:.1f}x", pointsMs / ms));
+
+			ms = context.Measure([&]() { Kernels::BuildTRS(streams.Translations(), streams.Rotations(), streams.Scales(), backendMatrices.data(), s_BatchCount); });
+			context.Report(fmt::format("100k BuildTRS ({})", SimdTraits<B>::Name), ms, fmt::format("{:.1f}x", trsMs / ms));
+
+			ms = context.Measure([&]() { Kernels::MultiplyMatrices(backendParent, backendMatrices.data(), backendProducts.data(), s_BatchCount); });
+			context.Report(fmt::format("100k MultiplyMatrices ({})", SimdTraits<B>::Name), ms, fmt::format("{:.1f}x", multiplyMs / ms));
+
+			DoNotOptimize(backendProducts.back());
+		});
+		DoNotOptimize(aosPoints.back());
+		DoNotOptimize(products.back());
+	}
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "RockBench/Benchmark.h"
+
+#include <cstdlib>
+
+#include "RockEngine/Memory/MemoryTracker.h"
+#include "RockEngine/Memory/STLAllocators.h"
+
+namespace RockEngine
+{
+	static constexpr uint32_t s_AllocationCount = 100000;
+
+	RE_BENCHMARK(FrameAllocatorVsMalloc)
+	{
+		std::vector<void*> blocks(s_AllocationCount);
+
+		double mallocMs = context.Measure([&]()
+		{
+			for (uint32_t i = 0; i < s_AllocationCount; i++)
+				blocks[i] = std::malloc(16 + (i & 63));
+			for (uint32_t i = 0; i < s_AllocationCount; i++)
+				std::free(blocks[i]);
+		});
+
+		double frameMs = context.Measure([&]()
+		{
+			for (uint32_t i = 0; i < s_AllocationCount; i++)
+				blocks[i] = FrameAllocator::Allocate(16 + (i & 63), 16);
+			DoNotOptimize(blocks[s_AllocationCount - 1]);
+			// Two frame boundaries release everything, like the main loop would
+			FrameAllocator::BeginFrame();
+			FrameAllocator::BeginFrame();
+		});
+
+		context.Report("100k malloc/free (16-79 bytes)", mallocMs);
+		context.Report("100k FrameAllocator::Allocate + reset", frameMs, fmt::format("{:.1f}x", mallocMs / frameMs));
+	}
+
+	RE_BENCHMARK(PoolAllocatorVsMalloc)
+	{
+		std::vector<void*> blocks(s_AllocationCount);
+
+		// Interleaved alloc/free with a working set, the pattern small objects usually see
+		double mallocMs = context.Measure([&]()
+		{
+			for (uint32_t i = 0; i < s_AllocationCount; i++)
+				blocks[i] = std::malloc(48);
+			for (uint32_t i = 0; i < s_AllocationCount; i += 2)
+				std::free(blocks[i]);
+			for (uint32_t i = 0; i < s_AllocationCount; i += 2)
+				blocks[i] = std::malloc(48);
+			for (uint32_t i = 0; i < s_AllocationCount; i++)
+				std::free(blocks[i]);
+		});
+
+		double poolMs = context.Measure([&]()
+		{
+			for (uint32_t i = 0; i < s_AllocationCount; i++)
+				blocks[i] = SmallObjectAllocator::Allocate(48);
+			for (uint32_t i = 0; i < s_AllocationCount; i += 2)
+				SmallObjectAllocator::Free(blocks[i], 48);
+			for (uint32_t i = 0; i < s_AllocationCount; i += 2)
+				blocks[i] = SmallObjectAllocator::Allocate(48);
+			for (uint32_t i = 0; i < s_AllocationCount; i++)
+				SmallObjectAllocator::Free(blocks[i], 48);
+		});
+
+		context.Report("100k malloc/free churn (48 bytes)", mallocMs);
+		context.Report("100k SmallObjectAllocator churn (48 bytes)", poolMs, fmt::format("{:.1f}x", mallocMs / poolMs));
+	}
+
+	RE_BENCHMARK(FrameContainers)
+	{
+		constexpr uint32_t containers = 10000;
+
+		double heapMs = context.Measure([&]()
+		{
+			for (uint32_t i = 0; i < containers; i++)
+			{
+				std::vector<uint32_t> values;
+				for (uint32_t k = 0; k < 32; k++)
+					values.push_back(k);
+				std::string name = "Entity_" + std::to_string(i) + "_with_a_long_enough_name";
+				DoNotOptimize(values.back());
+				DoNotOptimize(name[0]);
+			}
+		});
+
+		double frameMs = context.Measure([&]()
+		{
+			for (uint32_t i = 0; i < containers; i++)
+			{
+				FrameVector<uint32_t> values;
+				for (uint32_t k = 0; k < 32; k++)
+					values.push_back(k);
+				FrameString name = "Entity_";
+				name += std::to_string(i).c_str();
+				name += "_with_a_long_enough_name";
+				DoNotOptimize(values.back());
+				DoNotOptimize(name[0]);
+			}
+			FrameAllocator::BeginFrame();
+		});
+
+		context.Report("10k std::vector + std::string temporaries", heapMs);
+		context.Report("10k FrameVector + FrameString temporaries", frameMs, fmt::format("{:.1f}x", heapMs / frameMs));
+	}
+
+	// Cost the tracker adds to every new/delete. Without --memory-tracking both lines
+	// measure the plain heap.
+	RE_BENCHMARK(MemoryTrackerOverhead)
+	{
+		std::vector<void*> blocks(s_AllocationCount);
+
+		double mallocMs = context.Measure([&]()
+		{
+			for (uint32_t i = 0; i < s_AllocationCount; i++)
+				blocks[i] = std::malloc(48);
+			for (uint32_t i = 0; i < s_AllocationCount; i++)
+				std::free(blocks[i]);
+		});
+
+		std::vector<MemoryTagStats> before, after;
+		MemoryTracker::GetStats(before);
+		double newMs = context.Measure([&]()
+		{
+			RE_MEMORY_SCOPE("RockBench");
+			for (uint32_t i = 0; i < s_AllocationCount; i++)
+				blocks[i] = ::operator new(48);
+			for (uint32_t i = 0; i < s_AllocationCount; i++)
+				::operator delete(blocks[i]);
+		});
+		MemoryTracker::GetStats(after);
+
+		context.Report("100k malloc/free (48 bytes)", mallocMs);
+		context.Report(MemoryTracker::IsEnabled() ? "100k tracked new/delete (48 bytes)" : "100k new/delete (48 bytes, untracked)",
+			newMs, fmt::format("{:.2f}x malloc", newMs / mallocMs));
+
+		if (MemoryTracker::IsEnabled())
+		{
+			// Warm-up plus the measured iterations, all under the RockBench tag
+			MemoryTag tag = MemoryTracker::RegisterTag("RockBench");
+			uint64_t counted = after[tag].TotalAllocations - (tag < before.size() ? before[tag].TotalAllocations : 0);
+			if (counted < s_AllocationCount * 11ull || after[tag].CurrentBytes != 0)
+				context.Fail("MemoryTracker: expected {} allocations under 'RockBench' and none live, got {} ({} bytes live)",
+					s_AllocationCount * 11ull, counted, after[tag].CurrentBytes);
+		}
+	}
+}
@@ -0,0 +1,224 @@
+#include "RockBench/Benchmark.h"
+
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "RockEngine/Core/Profiler.h"
+#include "RockEngine/Platform/Null/NullRendererBackend.h"
+#include "RockEngine/Platform/Software/SoftwareRendererBackend.h"
+#include "RockEngine/Renderer/QuadBatcher.h"
+#include "RockEngine/Renderer/RenderCapture.h"
+#include "RockEngine/Renderer/Renderer2D.h"
+#include "RockEngine/Renderer/RendererAPI.h"
+
+namespace RockEngine
+{
+	static constexpr uint32_t s_CaptureWidth = 1280;
+	static constexpr uint32_t s_CaptureHeight = 720;
+	static constexpr float s_CaptureViewProjection[16] = {
+		2.0f / s_CaptureWidth, 0.0f, 0.0f, 0.0f,
+		0.0f, 2.0f / s_CaptureHeight, 0.0f, 0.0f,
+		0.0f, 0.0f, -1.0f, 0.0f,
+		-1.0f, -1.0f, 0.0f, 1.0f
+	};
+
+	// Frames the way Renderer2D hands them over: a clear, a viewport, a few mesh draws and the
+	// quad batches, in a frame slot of their own. Quads drift from frame to frame.
+	struct CapturedWorkload
+	{
+		std::vector<std::vector<RenderCommand>> Frames;
+		std::vector<QuadBatchData> Slots;
+
+		CapturedWorkload(uint32_t frames, uint32_t quads)
+		{
+			std::vector<QuadInstance> instances(quads);
+			QuadBatcher batcher;
+			Slots.resize(frames);
+			for (uint32_t frame = 0; frame < frames; frame++)
+			{
+				for (uint32_t i = 0; i < quads; i++)
+				{
+					uint32_t hash = i * 2654435761u;
+					instances[i] = { { (float)((hash + frame * 3) % s_CaptureWidth), (float)((hash >> 11) % s_CaptureHeight), 0.0f }, 0.0f,
+						{ 4.0f + (hash >> 28), 4.0f + ((hash >> 24) & 15) }, { 0.0f, 0.0f, 1.0f, 1.0f }, hash | 0xff000000u, (i / 256) % 20 };
+				}
+
+				std::vector<DrawQuadsCommand> batches;
+				batcher.Build(instances.data(), quads, s_CaptureViewProjection, frame, Slots[frame], batches);
+
+				std::vector<RenderCommand> commands;
+				commands.push_back(RenderCommand::Make(ClearCommand{ { 0.1f, 0.1f, 0.1f, 1.0f } }));
+				commands.push_back(RenderCommand::Make(SetViewportCommand{ 0, 0, s_CaptureWidth, s_CaptureHeight }));
+				for (uint32_t i = 0; i < 64; i++)
+					commands.push_back(RenderCommand::Make(DrawCommand{ i & 7, i & 15, i, 36, 0, 1 }));
+				for (const DrawQuadsCommand& batch : batches)
+					commands.push_back(RenderCommand::Make(batch));
+				Frames.push_back(std::move(commands));
+			}
+		}
+	};
+
+	// Same commands, DrawQuads compared by the quads and textures they draw rather than offsets
+	static bool MatchesCapture(const std::vector<RenderCommand>& commands, const QuadBatchData& quads, const RenderCaptureFrame& frame)
+	{
+		if (commands.size() != frame.Commands.size())
+			return false;
+		for (size_t i = 0; i < commands.size(); i++)
+		{
+			const RenderCommand& a = commands[i];
+			const RenderCommand& b = frame.Commands[i];
+			if (a.Type != b.Type)
+				return false;
+			if (a.Type != RenderCommandType::DrawQuads)
+			{
+				if (std::memcmp(a.Payload, b.Payload, sizeof(a.Payload)) != 0)
+					return false;
+				continue;
+			}
+
+			const DrawQuadsCommand& original = a.DrawQuads;
+			const DrawQuadsCommand& captured = b.DrawQuads;
+			if (original.QuadCount != captured.QuadCount || original.TextureCount != captured.TextureCount
+				|| std::memcmp(&quads.Vertices[(size_t)original.FirstQuad * 4], &frame.Quads.Vertices[(size_t)captured.FirstQuad * 4], (size_t)original.QuadCount * 4 * sizeof(QuadVertex)) != 0
+				|| std::memcmp(&quads.Textures[original.FirstTexture], &frame.Quads.Textures[captured.FirstTexture], original.TextureCount * sizeof(uint32_t)) != 0)
+				return false;
+		}
+		return true;
+	}
+
+	static void RemoveMeshDraws(std::vector<RenderCommand>& commands)
+	{
+		commands.erase(std::remove_if(commands.begin(), commands.end(), [](const RenderCommand& command) { return command.Type == RenderCommandType::Draw; }), commands.end());
+	}
+
+	RE_BENCHMARK(RenderCaptureReplay)
+	{
+		namespace fs = std::filesystem;
+		constexpr uint32_t frameCount = 30;
+		constexpr uint32_t quadCount = 20000;
+
+		const fs::path directory = fs::temp_directory_path() / "RockBenchCapture";
+		fs::remove_all(directory);
+		fs::create_directories(directory);
+		const std::string path = (directory / "frames.rcap").string();
+
+		CapturedWorkload workload(frameCount, quadCount);
+		NullRendererBackend source;
+		source.SetQuadBatchSource(workload.Slots.data(), frameCount);
+
+		// Capturing: what each frame costs the thread that executes it
+		RenderCapture::Begin(path, frameCount, s_CaptureWidth, s_CaptureHeight, RendererAPIType::Null);
+		double captureMs = 0.0;
+		for (uint32_t frame = 0; frame < frameCount; frame++)
+		{
+			uint64_t start = Profiler::Now();
+			RenderCapture::Record(source, workload.Frames[frame].data(), (uint32_t)workload.Frames[frame].size());
+			captureMs += (double)(Profiler::Now() - start) / 1e6;
+		}
+		RenderCaptureStats stats = RenderCapture::GetStats();
+		if (RenderCapture::IsCapturing() || stats.Frames != frameCount)
+			context.Fail("RenderCaptureReplay: the capture recorded {} of {} frames", stats.Frames, frameCount);
+		context.Report(fmt::format("Capture, {} commands + {}k quads", workload.Frames[0].size(), quadCount / 1000), captureMs / frameCount,
+			fmt::format("per frame, {} KB/frame, {:.1f}x smaller than raw", stats.FileBytes / frameCount / 1024, (double)stats.RawBytes / stats.FileBytes));
+
+		RenderCaptureFile capture;
+		std::vector<RenderCaptureFrame> frames(frameCount);
+		bool opened = capture.Open(path) && capture.GetFrameCount() == frameCount;
+		double readMs = context.Measure([&]()
+		{
+			for (uint32_t frame = 0; opened && frame < frameCount; frame++)
+				opened &= capture.ReadFrame(frame, frames[frame]);
+		}, 3);
+		uint32_t mismatches = 0;
+		for (uint32_t frame = 0; opened && frame < frameCount; frame++)
+			mismatches += !MatchesCapture(workload.Frames[frame], workload.Slots[frame], frames[frame]);
+		if (!opened || mismatches)
+			context.Fail("RenderCaptureReplay: {} frames read back differently", opened ? mismatches : frameCount);
+		context.Report("Read and decompress all frames", readMs, fmt::format("{:.1f} MB/s", stats.RawBytes / readMs / 1000.0));
+
+		// The null backend has to see the same work from the replay as from the original
+		NullRendererBackend original, replayed;
+		original.SetQuadBatchSource(workload.Slots.data(), frameCount);
+		double replayMs = context.Measure([&]()
+		{
+			original.ResetStats();
+			replayed.ResetStats();
+			for (uint32_t frame = 0; frame < frameCount; frame++)
+			{
+				original.Execute(workload.Frames[frame].data(), (uint32_t)workload.Frames[frame].size());
+				replayed.SetQuadBatchSource(&frames[frame].Quads, 1);
+				replayed.Execute(frames[frame].Commands.data(), (uint32_t)frames[frame].Commands.size());
+			}
+		}, 3);
+		const NullRendererBackend::Stats& a = original.GetStats();
+		const NullRendererBackend::Stats& b = replayed.GetStats();
+		if (a.Commands != b.Commands || a.Draws != b.Draws || a.QuadBatches != b.QuadBatches || a.Quads != b.Quads || a.QuadTextureBinds != b.QuadTextureBinds)
+			context.Fail("RenderCaptureReplay: the null backend saw {} quads originally and {} replayed", a.Quads, b.Quads);
+		context.Report("Execute original + replay, null backend", replayMs, fmt::format("{} frames", frameCount));
+
+		// Deterministic: replaying on the software backend draws exactly what the original did
+		SoftwareRendererBackend direct(s_CaptureWidth, s_CaptureHeight), replay(s_CaptureWidth, s_CaptureHeight);
+		direct.Init();
+		replay.Init();
+		direct.SetQuadBatchSource(workload.Slots.data(), frameCount);
+		for (uint32_t frame = frameCount - 2; frame < frameCount; frame++)
+		{
+			std::vector<RenderCommand> commands = workload.Frames[frame];
+			RemoveMeshDraws(commands);
+			direct.Execute(commands.data(), (uint32_t)commands.size());
+
+			commands = frames[frame].Commands;
+			RemoveMeshDraws(commands);
+			replay.SetQuadBatchSource(&frames[frame].Quads, 1);
+			double ms = context.Measure([&]() { replay.Execute(commands.data(), (uint32_t)commands.size()); }, 3);
+			if (frame == frameCount - 1)
+				context.Report("Replay one frame, software backend", ms);
+		}
+		size_t pixels = (size_t)s_CaptureWidth * s_CaptureHeight;
+		if (std::memcmp(direct.GetFramebuffer().GetColor(), replay.GetFramebuffer().GetColor(), pixels * sizeof(uint32_t)) != 0)
+			context.Fail("RenderCaptureReplay: the replayed frame differs from the original");
+
+		// Through the engine: RendererAPI::Flush records while a capture runs
+		const std::string enginePath = (directory / "engine.rcap").string();
+		RenderCapture::Begin(enginePath, 3, s_CaptureWidth, s_CaptureHeight, RendererAPI::GetType());
+		for (uint32_t frame = 0; frame < 4; frame++)
+		{
+			Renderer2D::BeginFrame();
+			Renderer2D::BeginScene(s_CaptureViewProjection);
+			Renderer2D::DrawQuad(QuadInstance{ { 100.0f, 100.0f, 0.0f }, 0.0f, { 10.0f, 10.0f }, { 0.0f, 0.0f, 1.0f, 1.0f }, 0xffffffffu, 0 });
+			Renderer2D::EndScene();
+			RendererAPI::Flush();
+		}
+		RenderCaptureFile engineCapture;
+		RenderCaptureFrame engineFrame;
+		if (!engineCapture.Open(enginePath) || engineCapture.GetFrameCount() != 3 || !engineCapture.ReadFrame(2, engineFrame) || engineFrame.Quads.Vertices.size() != 4)
+			context.Fail("RenderCaptureReplay: RendererAPI::Flush wasn't captured");
+
+		// A truncated capture has to be refused when opening
+		fs::copy_file(path, directory / "truncated.rcap");
+		fs::resize_file(directory / "truncated.rcap", fs::file_size(path) / 2);
+		RE_CORE_INFO("  opening a truncated capture, one error expected:");
+		RenderCaptureFile truncated;
+		if (truncated.Open((directory / "truncated.rcap").string()))
+			context.Fail("RenderCaptureReplay: opened a truncated capture");
+
+		// So does one whose frame table claims more data than a frame can decompress to
+		fs::copy_file(path, directory / "damaged.rcap");
+		{
+			std::fstream damaged(directory / "damaged.rcap", std::ios::binary | std::ios::in | std::ios::out);
+			const uint32_t quadCount = 0xFFFFFFFFu;
+			damaged.seekp(capture.GetHeader().FrameTableOffset + offsetof(RenderCaptureFrameEntry, QuadCount));
+			damaged.write(reinterpret_cast<const char*>(&quadCount), sizeof(quadCount));
+		}
+		RE_CORE_INFO("  opening a capture with a damaged frame table, one error expected:");
+		RenderCaptureFile damaged;
+		if (damaged.Open((directory / "damaged.rcap").string()))
+			context.Fail("RenderCaptureReplay: opened a capture with a damaged frame table");
+
+		capture.Close();
+		engineCapture.Close();
+		fs::remove_all(directory);
+	}
+}
\ No newline at end of file
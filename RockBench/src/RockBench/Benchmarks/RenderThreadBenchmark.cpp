@@ -0,0 +1,80 @@
+#include "RockBench/Benchmark.h"
+
+#include "RockEngine/Core/Profiler.h"
+#include "RockEngine/Platform/Headless/HeadlessWindow.h"
+#include "RockEngine/Platform/Null/NullRendererBackend.h"
+#include "RockEngine/Renderer/RenderQueue.h"
+#include "RockEngine/Renderer/RenderThread.h"
+
+namespace RockEngine
+{
+	static constexpr uint32_t s_Frames = 120;
+	static constexpr uint32_t s_DrawsPerFrame = 2000;
+	static constexpr uint32_t s_CommandCostNs = 500;		// ~1 ms of "driver" time per frame
+	static constexpr uint64_t s_SimulationNs = 1000000;	// 1 ms of update per frame
+
+	static void SimulateFrame(RenderQueue& queue, uint32_t frame)
+	{
+		uint64_t end = Profiler::Now() + s_SimulationNs;
+		while (Profiler::Now() < end)
+			;
+
+		for (uint32_t i = 0; i < s_DrawsPerFrame; i++)
+		{
+			uint32_t hash = (i + frame) * 2654435761u;
+			queue.Submit(RenderSortKey::Make(0, hash & 15, (hash >> 4) & 255, hash >> 8), DrawCommand{ hash & 15, (hash >> 4) & 255, 0, 36, 0, 1 });
+		}
+	}
+
+	RE_BENCHMARK(RenderThreadPipelining)
+	{
+		HeadlessWindow window({ "RenderThreadPipelining", 1280, 720 });
+		NullRendererBackend backend;
+		backend.SetSimulatedCommandCost(s_CommandCostNs);
+		RenderQueue queue;
+
+		// Everything on the calling thread, like Application::Run without a render thread
+		uint64_t start = Profiler::Now();
+		for (uint32_t frame = 0; frame < s_Frames; frame++)
+		{
+			SimulateFrame(queue, frame);
+			queue.Sort();
+			queue.Execute(backend);
+			queue.Reset();
+			window.SwapBuffers();
+		}
+		double serialMs = (Profiler::Now() - start) / 1e6 / s_Frames;
+		context.Report("serial update + submit, per frame", serialMs, "latency = frame time");
+
+		for (uint32_t framesInFlight = 1; framesInFlight <= 2; framesInFlight++)
+		{
+			RenderThread renderThread(window, backend, nullptr, { framesInFlight });
+			renderThread.Start();
+
+			start = Profiler::Now();
+			for (uint32_t frame = 0; frame < s_Frames; frame++)
+			{
+				uint64_t frameStart = Profiler::Now();
+				SimulateFrame(queue, frame);
+
+				FramePacket& packet = renderThread.BeginPacket();
+				packet.Frame = frame;
+				packet.FrameStart = frameStart;
+				queue.Sort();
+				queue.TakeSorted(packet.Commands);
+				queue.Reset();
+				renderThread.SubmitPacket();
+			}
+			renderThread.WaitIdle();
+			double threadedMs = (Profiler::Now() - start) / 1e6 / s_Frames;
+
+			RenderThreadStats stats = renderThread.GetStats();
+			renderThread.Stop();
+
+			if (stats.FramesPresented != s_Frames)
+				context.Fail("RenderThreadPipelining: presented {} of {} frames", stats.FramesPresented, s_Frames);
+			context.Report(fmt::format("render thread, {} in flight, per frame", framesInFlight), threadedMs,
+				fmt::format("{:.2f}x, latency {:.2f} ms", serialMs / threadedMs, stats.AverageLatencyMs));
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "RockBench/Benchmark.h"
+
+#include "RockEngine/Core/Profiler.h"
+#include "RockEngine/Platform/Null/NullRendererBackend.h"
+#include "RockEngine/Renderer/QuadBatcher.h"
+#include "RockEngine/Renderer/Renderer2D.h"
+#include "RockEngine/Renderer/RendererAPI.h"
+
+#include <cmath>
+
+namespace RockEngine
+{
+	static constexpr uint32_t s_QuadCount = 100000;
+
+	// Orthographic projection over a 1280x720 screen, column-major
+	static constexpr float s_ViewProjection[16] = {
+		2.0f / 1280.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 2.0f / 720.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, -1.0f, 0.0f,
+		-1.0f, -1.0f, 0.0f, 1.0f
+	};
+
+	// Sprites from a handful of atlases plus some untextured UI, a quarter of them rotated
+	static std::vector<QuadInstance> MakeQuads(uint32_t count, uint32_t textureCount)
+	{
+		std::vector<QuadInstance> quads(count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			uint32_t hash = i * 2654435761u;
+			QuadInstance& quad = quads[i];
+			quad = { { (float)(hash % 1280), (float)((hash >> 11) % 720), (float)(i % 7) * 0.1f }, (i & 3) == 0 ? (float)(hash & 255) * 0.0245f : 0.0f,
+				{ 8.0f + (hash >> 24), 8.0f + ((hash >> 16) & 31) }, { 0.0f, 0.0f, 1.0f + (i & 1), 1.0f }, hash | 0xff000000u, (i / 64) % textureCount };
+		}
+		return quads;
+	}
+
+	// Checks a batch split against the rules and the vertices against the scalar reference
+	static bool ValidateBatches(const std::vector<QuadInstance>& quads, const QuadBatchData& data, const std::vector<DrawQuadsCommand>& commands)
+	{
+		uint32_t expectedQuad = 0;
+		for (const DrawQuadsCommand& command : commands)
+		{
+			if (command.FirstQuad != expectedQuad || command.QuadCount == 0 || command.QuadCount > DrawQuadsCommand::MaxQuads
+				|| command.TextureCount == 0 || command.TextureCount > DrawQuadsCommand::MaxTextures)
+				return false;
+
+			for (uint32_t quad = command.FirstQuad; quad < command.FirstQuad + command.QuadCount; quad++)
+			{
+				uint32_t slot = data.Vertices[(size_t)quad * 4].TextureSlot;
+				if (slot >= command.TextureCount || data.Textures[command.FirstTexture + slot] != quads[quad].Texture)
+					return false;
+			}
+			expectedQuad += command.QuadCount;
+		}
+		return expectedQuad == quads.size();
+	}
+
+	static float MaxVertexError(const QuadBatchData& a, const QuadBatchData& b)
+	{
+		float error = 0.0f;
+		for (size_t i = 0; i < a.Vertices.size(); i++)
+		{
+			const QuadVertex& va = a.Vertices[i];
+			const QuadVertex& vb = b.Vertices[i];
+			for (int k = 0; k < 4; k++)
+				error = std::max(error, std::abs(va.Position[k] - vb.Position[k]));
+			for (int k = 0; k < 2; k++)
+				error = std::max(error, std::abs(va.TexCoord[k] - vb.TexCoord[k]));
+			if (va.Color != vb.Color || va.TextureSlot != vb.TextureSlot)
+				return INFINITY;
+		}
+		return error;
+	}
+
+	RE_BENCHMARK(QuadBatcherKernels)
+	{
+		std::vector<QuadInstance> quads = MakeQuads(s_QuadCount, 40);
+
+		QuadBatchData reference;
+		std::vector<DrawQuadsCommand> referenceCommands;
+		QuadBatcher(QuadKernel::Scalar).Build(quads.data(), s_QuadCount, s_ViewProjection, 0, reference, referenceCommands);
+		if (!ValidateBatches(quads, reference, referenceCommands))
+			context.Fail("QuadBatcherKernels: scalar batches break the batching rules");
+
+		double scalarMs = 0.0;
+		QuadKernel kernels[] = { QuadKernel::Scalar, QuadKernel::SSE, QuadKernel::AVX };
+		for (QuadKernel kernel : kernels)
+		{
+			if (kernel > QuadBatcher::GetDefaultKernel())
+				continue;
+
+			QuadBatcher batcher(kernel);
+			QuadBatchData data;
+			std::vector<DrawQuadsCommand> commands;
+			double ms = context.Measure([&]()
+			{
+				data.Vertices.clear();
+				data.Textures.clear();
+				commands.clear();
+				batcher.Build(quads.data(), s_QuadCount, s_ViewProjection, 0, data, commands);
+			});
+			if (kernel == QuadKernel::Scalar)
+				scalarMs = ms;
+
+			float error = MaxVertexError(reference, data);
+			if (commands.size() != referenceCommands.size() || error > 1e-4f)
+				context.Fail("QuadBatcherKernels: {} kernel differs from scalar ({} batches, max error {})", QuadBatcher::GetKernelName(kernel), commands.size(), error);
+
+			context.Report(fmt::format("100k quads, {} kernel", QuadBatcher::GetKernelName(kernel)), ms,
+				fmt::format("{:.1f}x, {} batches, {:.1f} M quads/s", scalarMs / ms, commands.size(), s_QuadCount / ms / 1000.0));
+		}
+	}
+
+	RE_BENCHMARK(QuadBatchSplits)
+	{
+		struct Case { const char* Name; uint32_t Textures; uint32_t Quads; };
+		Case cases[] = {
+			{ "1 texture", 1, s_QuadCount },
+			{ "16 textures", 16, s_QuadCount },
+			{ "17 textures", 17, s_QuadCount },
+			{ "40 textures", 40, s_QuadCount },
+			{ "exact capacity", 1, DrawQuadsCommand::MaxQuads },
+		};
+
+		for (const Case& test : cases)
+		{
+			std::vector<QuadInstance> quads = MakeQuads(test.Quads, test.Textures);
+			QuadBatcher batcher;
+			QuadBatchData data;
+			std::vector<DrawQuadsCommand> commands;
+			batcher.Build(quads.data(), test.Quads, s_ViewProjection, 0, data, commands);
+
+			const QuadBatcherStats& stats = batcher.GetStats();
+			uint64_t minimum = (test.Quads + DrawQuadsCommand::MaxQuads - 1) / DrawQuadsCommand::MaxQuads;
+			bool valid = ValidateBatches(quads, data, commands) && stats.Batches == commands.size()
+				&& (test.Textures > DrawQuadsCommand::MaxTextures || commands.size() == minimum);
+			if (!valid)
+				context.Fail("QuadBatchSplits: {} produced {} batches", test.Name, commands.size());
+
+			RE_CORE_INFO("  {:<20} {:>4} batches ({} texture splits, {} capacity splits)", test.Name, commands.size(), stats.TextureSplits, stats.CapacitySplits);
+		}
+	}
+
+	RE_BENCHMARK(Renderer2DSubmit)
+	{
+		// The whole path: DrawQuad calls, batching, sorting and the null backend
+		std::vector<QuadInstance> quads = MakeQuads(s_QuadCount, 40);
+		NullRendererBackend& backend = static_cast<NullRendererBackend&>(RendererAPI::GetBackend());
+
+		double ms = context.Measure([&]()
+		{
+			Renderer2D::BeginFrame();
+			Renderer2D::BeginScene(s_ViewProjection);
+			for (const QuadInstance& quad : quads)
+				Renderer2D::DrawQuad(quad);
+			Renderer2D::EndScene();
+			RendererAPI::Flush();
+		});
+
+		backend.ResetStats();
+		Renderer2D::BeginFrame();
+		Renderer2D::BeginScene(s_ViewProjection);
+		for (const QuadInstance& quad : quads)
+			Renderer2D::DrawQuad(quad);
+		Renderer2D::EndScene();
+		RendererAPI::Flush();
+
+		const Renderer2DStats& stats = Renderer2D::GetStats();
+		const NullRendererBackend::Stats& executed = backend.GetStats();
+		if (executed.QuadBatches != stats.DrawCalls || executed.Quads != s_QuadCount || stats.Quads != s_QuadCount)
+			context.Fail("Renderer2DSubmit: backend saw {} batches / {} quads, Renderer2D counted {} / {}", executed.QuadBatches, executed.Quads, stats.DrawCalls, stats.Quads);
+
+		context.Report("100k DrawQuad + EndScene + Flush", ms,
+			fmt::format("{} draw calls, {} vertices, {} indices", stats.DrawCalls, stats.GetVertexCount(), stats.GetIndexCount()));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,258 @@
+#include "RockBench/Benchmark.h"
+
+#include "RockEngine/Core/Profiler.h"
+#include "RockEngine/Scene/Scene.h"
+
+namespace RockEngine
+{
+	static constexpr uint32_t s_EntityCount = 200000;
+	static constexpr float s_DeltaTime = 1.0f / 60.0f;
+
+	namespace SceneBench
+	{
+		struct Position { float X, Y, Z; };
+		struct Velocity { float X, Y, Z; };
+		struct Health { float Current, Max; };
+		// Stands in for everything an update loop doesn't touch: render state, physics, audio...
+		struct Cold { float Data[24]; };
+		struct Name { std::string Value; };
+		struct Frozen {};
+	}
+	using namespace SceneBench;
+
+	// The usual object-oriented layout: one heap object per thing, a virtual update, optional
+	// parts as owned pointers
+	class GameObject
+	{
+	public:
+		virtual ~GameObject() = default;
+		virtual void Update(float dt)
+		{
+			if (FrozenPart)
+				return;
+			Pos.X += Vel.X * dt;
+			Pos.Y += Vel.Y * dt;
+			Pos.Z += Vel.Z * dt;
+		}
+
+		Position Pos;
+		Velocity Vel;
+		Health Hp;
+		Cold Other;
+		std::string ObjectName;
+		std::unique_ptr<Frozen> FrozenPart;
+	};
+
+	static Velocity MakeVelocity(uint32_t i)
+	{
+		return { (float)(i % 17) - 8.0f, (float)(i % 13) - 6.0f, (float)(i % 5) };
+	}
+
+	static void PopulateScene(Scene& scene, std::vector<Entity>& entities)
+	{
+		entities.resize(s_EntityCount);
+		for (uint32_t i = 0; i < s_EntityCount; i++)
+		{
+			// A few archetypes, like a real scene: some things don't move, some have no health
+			if (i % 10 == 0)
+				entities[i] = scene.CreateEntity(Position{ (float)i, 0.0f, 0.0f }, Cold{}, Name{ "Static" });
+			else if (i % 3 == 0)
+				entities[i] = scene.CreateEntity(Position{ (float)i, 0.0f, 0.0f }, MakeVelocity(i), Cold{}, Name{ "Projectile" });
+			else
+				entities[i] = scene.CreateEntity(Position{ (float)i, 0.0f, 0.0f }, MakeVelocity(i), Health{ 100.0f, 100.0f }, Cold{}, Name{ "Unit" });
+		}
+	}
+
+	static double SumPositions(Scene& scene)
+	{
+		double sum = 0.0;
+		scene.Each<Position>([&](const Position& position) { sum += position.X + position.Y + position.Z; });
+		return sum;
+	}
+
+	RE_BENCHMARK(SceneIteration)
+	{
+		std::vector<std::unique_ptr<GameObject>> objects;
+		for (uint32_t i = 0; i < s_EntityCount; i++)
+		{
+			auto object = std::make_unique<GameObject>();
+			object->Pos = { (float)i, 0.0f, 0.0f };
+			object->Vel = i % 10 == 0 ? Velocity{ 0.0f, 0.0f, 0.0f } : MakeVelocity(i);
+			object->ObjectName = "Object";
+			objects.push_back(std::move(object));
+		}
+
+		Scene scene;
+		std::vector<Entity> entities;
+		PopulateScene(scene, entities);
+
+		// Each timed run is one step, counted so the layouts can be compared afterwards
+		uint32_t objectSteps = 0;
+		uint32_t sceneSteps = 0;
+
+		double objectMs = context.Measure([&]()
+		{
+			for (const std::unique_ptr<GameObject>& object : objects)
+				object->Update(s_DeltaTime);
+			objectSteps++;
+		});
+		context.Report("200k objects, virtual Update", objectMs);
+
+		double eachMs = context.Measure([&]()
+		{
+			scene.Each<Position, Velocity>([](Position& position, const Velocity& velocity)
+			{
+				position.X += velocity.X * s_DeltaTime;
+				position.Y += velocity.Y * s_DeltaTime;
+				position.Z += velocity.Z * s_DeltaTime;
+			});
+			sceneSteps++;
+		});
+		context.Report("180k entities, Each<Position, Velocity>", eachMs, fmt::format("{:.1f}x", objectMs / eachMs));
+
+		double chunkMs = context.Measure([&]()
+		{
+			scene.EachChunk<Position, Velocity>([](uint32_t count, const Entity*, Position* positions, const Velocity* velocities)
+			{
+				for (uint32_t i = 0; i < count; i++)
+				{
+					positions[i].X += velocities[i].X * s_DeltaTime;
+					positions[i].Y += velocities[i].Y * s_DeltaTime;
+					positions[i].Z += velocities[i].Z * s_DeltaTime;
+				}
+			});
+			sceneSteps++;
+		});
+		context.Report("180k entities, EachChunk<Position, Velocity>", chunkMs, fmt::format("{:.1f}x", objectMs / chunkMs));
+
+		double parallelMs = context.Measure([&]()
+		{
+			scene.ParallelEach<Position, Velocity>([](Position& position, const Velocity& velocity)
+			{
+				position.X += velocity.X * s_DeltaTime;
+				position.Y += velocity.Y * s_DeltaTime;
+				position.Z += velocity.Z * s_DeltaTime;
+			});
+			sceneSteps++;
+		});
+		context.Report(fmt::format("180k entities, ParallelEach ({} workers)", JobSystem::GetWorkerCount()), parallelMs, fmt::format("{:.1f}x", objectMs / parallelMs));
+
+		// Same per-entity arithmetic, so after the same number of steps only the summation order differs
+		for (; objectSteps < sceneSteps; objectSteps++)
+		{
+			for (const std::unique_ptr<GameObject>& object : objects)
+				object->Update(s_DeltaTime);
+		}
+		double objectSum = 0.0;
+		for (const std::unique_ptr<GameObject>& object : objects)
+			objectSum += object->Pos.X + object->Pos.Y + object->Pos.Z;
+		double sceneSum = SumPositions(scene);
+		if (std::abs(sceneSum - objectSum) > std::abs(objectSum) * 1e-9)
+			context.Fail("SceneIteration: position sum {} doesn't match the objects' {}", sceneSum, objectSum);
+
+		// Exclusion filters go through the same cached queries
+		uint32_t expectedMovers = 0;
+		uint32_t expectedProjectiles = 0;
+		for (uint32_t i = 0; i < s_EntityCount; i++)
+		{
+			expectedMovers += i % 10 != 0;
+			expectedProjectiles += i % 10 != 0 && i % 3 == 0;
+		}
+		uint32_t movers = scene.Count<Position, Velocity>();
+		uint32_t projectiles = scene.Count<Position, Velocity>(Without<Health>());
+		if (movers != expectedMovers || projectiles != expectedProjectiles)
+			context.Fail("SceneIteration: {} movers and {} projectiles, expected {} and {}", movers, projectiles, expectedMovers, expectedProjectiles);
+		RE_CORE_INFO("  {} archetypes, {} cached queries", scene.GetArchetypeCount(), scene.GetQueryCount());
+	}
+
+	RE_BENCHMARK(SceneStructuralChanges)
+	{
+		std::vector<std::unique_ptr<GameObject>> objects;
+		for (uint32_t i = 0; i < s_EntityCount; i++)
+			objects.push_back(std::make_unique<GameObject>());
+
+		Scene scene;
+		std::vector<Entity> entities;
+		PopulateScene(scene, entities);
+
+		double objectMs = context.Measure([&]()
+		{
+			for (uint32_t i = 0; i < s_EntityCount; i += 2)
+				objects[i]->FrozenPart = std::make_unique<Frozen>();
+			for (uint32_t i = 0; i < s_EntityCount; i += 2)
+				objects[i]->FrozenPart.reset();
+		});
+		context.Report("100k objects, attach + detach a part", objectMs);
+
+		double immediateMs = context.Measure([&]()
+		{
+			for (uint32_t i = 0; i < s_EntityCount; i += 2)
+				scene.AddComponent<Frozen>(entities[i]);
+			for (uint32_t i = 0; i < s_EntityCount; i += 2)
+				scene.RemoveComponent<Frozen>(entities[i]);
+		});
+		context.Report("100k entities, AddComponent + RemoveComponent", immediateMs, fmt::format("{:.1f}x", objectMs / immediateMs));
+
+		double deferredMs = context.Measure([&]()
+		{
+			// Recorded while iterating, which is what command buffers are for
+			EntityCommandBuffer& commands = scene.GetCommandBuffer();
+			scene.Each<Position>([&](Entity entity, const Position&)
+			{
+				if (entity.Index % 2 == 0)
+					commands.Add(entity, Frozen{});
+			});
+			scene.PlaybackCommands();
+
+			scene.Each<Frozen>([&](Entity entity, const Frozen&) { commands.Remove<Frozen>(entity); });
+			scene.PlaybackCommands();
+		});
+		context.Report("100k entities, same through a command buffer", deferredMs, fmt::format("{:.1f}x", objectMs / deferredMs));
+
+		// Non-trivial components have to survive every move between archetypes
+		bool namesIntact = true;
+		scene.Each<Name>([&](const Name& name) { namesIntact &= name.Value == "Static" || name.Value == "Projectile" || name.Value == "Unit"; });
+		if (!namesIntact || scene.Count<Frozen>() != 0 || scene.GetEntityCount() != s_EntityCount)
+			context.Fail("SceneStructuralChanges: {} frozen, {} entities, names intact: {}", scene.Count<Frozen>(), scene.GetEntityCount(), namesIntact);
+
+		double createObjectsMs = context.Measure([&]()
+		{
+			std::vector<std::unique_ptr<GameObject>> spawned;
+			for (uint32_t i = 0; i < s_EntityCount / 4; i++)
+			{
+				spawned.push_back(std::make_unique<GameObject>());
+				spawned.back()->Vel = MakeVelocity(i);
+			}
+		});
+		context.Report("50k objects, create + destroy", createObjectsMs);
+
+		double createMs = context.Measure([&]()
+		{
+			std::vector<Entity> spawned;
+			for (uint32_t i = 0; i < s_EntityCount / 4; i++)
+				spawned.push_back(scene.CreateEntity(Position{}, MakeVelocity(i), Health{ 1.0f, 1.0f }, Cold{}, Name{}));
+			for (Entity entity : spawned)
+				scene.DestroyEntity(entity);
+		});
+		context.Report("50k entities, create + destroy", createMs, fmt::format("{:.1f}x", createObjectsMs / createMs));
+
+		// Deferred creation from parallel jobs, each worker into its own buffer
+		uint32_t before = scene.GetEntityCount();
+		scene.ParallelEach<Position, Health>([&](Entity entity, const Position&, const Health&)
+		{
+			if (entity.Index % 64 == 0)
+			{
+				EntityCommandBuffer& commands = scene.GetCommandBuffer();
+				Entity spawned = commands.Create();
+				commands.Add(spawned, Position{ 1.0f, 2.0f, 3.0f });
+			}
+		});
+		scene.PlaybackCommands();
+
+		uint32_t expected = 0;
+		for (uint32_t i = 0; i < s_EntityCount; i++)
+			expected += i % 10 != 0 && i % 3 != 0 && i % 64 == 0;
+		if (scene.GetEntityCount() - before != expected)
+			context.Fail("SceneStructuralChanges: deferred creation made {} entities, expected {}", scene.GetEntityCount() - before, expected);
+	}
+}
\ No newline at end of file
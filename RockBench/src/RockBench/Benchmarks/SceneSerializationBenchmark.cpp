@@ -0,0 +1,318 @@
+#include "RockBench/Benchmark.h"
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "RockEngine/Core/Profiler.h"
+#include "RockEngine/Scene/Scene.h"
+#include "RockEngine/Scene/SceneSerializer.h"
+
+namespace RockEngine
+{
+	namespace SceneSerializationBench
+	{
+		struct Position { float X, Y, Z; };
+		struct Velocity { float X, Y, Z; };
+		struct Health { float Current, Max; };
+		struct Team { uint32_t ID; };
+		struct Bounds { float Min[3], Max[3]; };
+		// Not trivially copyable, never saved
+		struct Label { std::string Value; };
+
+		// The next version of Health, as a later build would register it
+		struct HealthV2 { float Current, Max, Regeneration; };
+	}
+	using namespace SceneSerializationBench;
+
+	static constexpr uint32_t s_SerializedEntityCount = 500000;
+
+	static void RegisterSerializedComponents()
+	{
+		SceneSchema::Register<Position>("Position");
+		SceneSchema::Register<Velocity>("Velocity");
+		SceneSchema::Register<Health>("Health");
+		SceneSchema::Register<Team>("Team");
+		SceneSchema::Register<Bounds>("Bounds");
+	}
+
+	static void PopulateSerializedScene(Scene& scene, std::vector<Entity>& entities)
+	{
+		entities.resize(s_SerializedEntityCount);
+		for (uint32_t i = 0; i < s_SerializedEntityCount; i++)
+		{
+			Position position = { (float)i, (float)(i % 100), 0.5f * i };
+			if (i % 10 == 0)
+				entities[i] = scene.CreateEntity(position, Bounds{ { -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, (float)i } }, Label{ "Static" });
+			else if (i % 3 == 0)
+				entities[i] = scene.CreateEntity(position, Velocity{ (float)(i % 17), 1.0f, -2.0f }, Team{ i % 4 });
+			else
+				entities[i] = scene.CreateEntity(position, Velocity{ 1.0f, (float)(i % 13), 0.0f }, Health{ (float)(i % 100), 100.0f }, Team{ i % 4 });
+		}
+
+		// Some dead slots with bumped generations, their indices have to come back free
+		for (uint32_t i = 7; i < s_SerializedEntityCount; i += 97)
+			scene.DestroyEntity(entities[i]);
+	}
+
+	template<typename T>
+	static bool SameComponent(Scene& a, Scene& b, Entity entity)
+	{
+		T* left = a.TryGetComponent<T>(entity);
+		T* right = b.TryGetComponent<T>(entity);
+		if (!left || !right)
+			return !left && !right;
+		return std::memcmp(left, right, sizeof(T)) == 0;
+	}
+
+	// Every entity of `original` alive in `loaded` under the same handle with the same saved
+	// components, every dead one dead
+	static uint32_t CompareScenes(Scene& original, Scene& loaded, const std::vector<Entity>& entities)
+	{
+		uint32_t errors = original.GetEntityCount() != loaded.GetEntityCount();
+		for (Entity entity : entities)
+		{
+			if (original.IsAlive(entity) != loaded.IsAlive(entity))
+			{
+				errors++;
+				continue;
+			}
+			if (!original.IsAlive(entity))
+				continue;
+
+			bool same = SameComponent<Position>(original, loaded, entity) && SameComponent<Velocity>(original, loaded, entity)
+				&& SameComponent<Health>(original, loaded, entity) && SameComponent<Team>(original, loaded, entity)
+				&& SameComponent<Bounds>(original, loaded, entity) && !loaded.HasComponent<Label>(entity);
+			errors += !same;
+		}
+		return errors;
+	}
+
+	// What a first version usually looks like: one text record per entity through iostreams
+	static void SaveNaive(Scene& scene, const std::string& path)
+	{
+		std::ofstream stream(path);
+		scene.Each<Position>([&](Entity entity, Position& position)
+		{
+			stream << entity.Index << ' ' << position.X << ' ' << position.Y << ' ' << position.Z;
+			if (Velocity* velocity = scene.TryGetComponent<Velocity>(entity))
+				stream << " v " << velocity->X << ' ' << velocity->Y << ' ' << velocity->Z;
+			if (Health* health = scene.TryGetComponent<Health>(entity))
+				stream << " h " << health->Current << ' ' << health->Max;
+			if (Team* team = scene.TryGetComponent<Team>(entity))
+				stream << " t " << team->ID;
+			if (Bounds* bounds = scene.TryGetComponent<Bounds>(entity))
+			{
+				stream << " b";
+				for (uint32_t i = 0; i < 3; i++)
+					stream << ' ' << bounds->Min[i] << ' ' << bounds->Max[i];
+			}
+			stream << '\n';
+		});
+	}
+
+	static void LoadNaive(Scene& scene, const std::string& path)
+	{
+		std::ifstream stream(path);
+		std::string line;
+		while (std::getline(stream, line))
+		{
+			std::istringstream record(line);
+			uint32_t index;
+			Position position;
+			record >> index >> position.X >> position.Y >> position.Z;
+			Entity entity = scene.CreateEntity(position);
+
+			std::string tag;
+			while (record >> tag)
+			{
+				if (tag == "v")
+				{
+					Velocity velocity;
+					record >> velocity.X >> velocity.Y >> velocity.Z;
+					scene.AddComponent(entity, velocity);
+				}
+				else if (tag == "h")
+				{
+					Health health;
+					record >> health.Current >> health.Max;
+					scene.AddComponent(entity, health);
+				}
+				else if (tag == "t")
+				{
+					Team team;
+					record >> team.ID;
+					scene.AddComponent(entity, team);
+				}
+				else if (tag == "b")
+				{
+					Bounds bounds;
+					for (uint32_t i = 0; i < 3; i++)
+						record >> bounds.Min[i] >> bounds.Max[i];
+					scene.AddComponent(entity, bounds);
+				}
+			}
+		}
+	}
+
+	RE_BENCHMARK(SceneSerialization)
+	{
+		namespace fs = std::filesystem;
+
+		RegisterSerializedComponents();
+		fs::path directory = fs::temp_directory_path() / "RockBench-scenes";
+		fs::remove_all(directory);
+		fs::create_directories(directory);
+		std::string naivePath = (directory / "naive.txt").string();
+		std::string binaryPath = (directory / "scene.rscn").string();
+
+		Scene scene;
+		std::vector<Entity> entities;
+		PopulateSerializedScene(scene, entities);
+		uint32_t errors = 0;
+
+		double naiveSaveMs = context.Measure([&]() { SaveNaive(scene, naivePath); }, 3);
+		context.Report(fmt::format("naive text save, {} entities", scene.GetEntityCount()), naiveSaveMs,
+			fmt::format("{:.1f} MB", fs::file_size(naivePath) / (1024.0 * 1024.0)));
+
+		double saveMs = context.Measure([&]() { errors += !SceneSerializer::Save(scene, binaryPath); }, 5);
+		context.Report("binary save", saveMs, fmt::format("{:.1f} MB, {:.1f}x", fs::file_size(binaryPath) / (1024.0 * 1024.0), naiveSaveMs / saveMs));
+
+		double naiveLoadMs = context.Measure([&]()
+		{
+			Scene loaded;
+			LoadNaive(loaded, naivePath);
+			errors += loaded.GetEntityCount() != scene.GetEntityCount();
+		}, 3);
+		context.Report("naive text load", naiveLoadMs);
+
+		double loadMs = context.Measure([&]()
+		{
+			SceneFile file;
+			Scene loaded;
+			errors += !file.Open(binaryPath) || !SceneSerializer::Load(file, loaded);
+		}, 5);
+		context.Report("binary map + load into a Scene", loadMs, fmt::format("{:.1f}x", naiveLoadMs / loadMs));
+
+		// Used in place: no Scene at all, the columns are read from the mapping
+		double expected = 0.0;
+		scene.Each<Position, Velocity>([&](Position& position, Velocity& velocity) { expected += position.X * velocity.X + position.Z; });
+		double inPlace = 0.0;
+		double inPlaceMs = context.Measure([&]()
+		{
+			SceneFile file;
+			file.Open(binaryPath);
+			inPlace = 0.0;
+			file.EachChunk<Position, Velocity>([&](uint32_t count, const Entity*, const Position* positions, const Velocity* velocities)
+			{
+				for (uint32_t i = 0; i < count; i++)
+					inPlace += positions[i].X * velocities[i].X + positions[i].Z;
+			});
+		}, 5);
+		context.Report("binary map + read in place", inPlaceMs, fmt::format("{:.0f}x naive load", naiveLoadMs / inPlaceMs));
+		if (std::abs(inPlace - expected) > 1e-9 * std::abs(expected))
+			context.Fail("SceneSerialization: reading in place gave {}, expected {}", inPlace, expected);
+
+		// Round trip: same handles, same components, and the free slots come back in the same order
+		{
+			SceneFile file;
+			Scene loaded;
+			file.Open(binaryPath);
+			SceneSerializer::Load(file, loaded);
+			errors += CompareScenes(scene, loaded, entities);
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				Entity a = scene.CreateEntity(Team{ 9 });
+				Entity b = loaded.CreateEntity(Team{ 9 });
+				errors += a.Index != b.Index || a.Generation != b.Generation;
+			}
+			errors += !SceneSerializer::Save(scene, binaryPath);
+		}
+
+		// Incremental saves: an edit touching 1% of the entities, contiguous like a moved group,
+		// then one scattered over the whole scene
+		SceneWriter writer(binaryPath);
+		errors += !writer.Save(scene);
+		double fullMs = context.Measure([&]() { writer.Reset(); errors += !writer.Save(scene); }, 3);
+
+		uint32_t round = 0;
+		double incrementalMs = context.Measure([&]()
+		{
+			round++;
+			for (uint32_t i = 0; i < s_SerializedEntityCount / 100; i++)
+			{
+				if (Position* position = scene.TryGetComponent<Position>(entities[i]))
+					position->Y += (float)round;
+			}
+			errors += !writer.Save(scene);
+		}, 5);
+		const SceneWriterStats& stats = writer.GetStats();
+		context.Report("incremental save, 1% changed together", incrementalMs,
+			fmt::format("{:.1f}x full, {} chunks written, {} reused", fullMs / incrementalMs, stats.ChunksWritten, stats.ChunksReused));
+
+		double scatteredMs = context.Measure([&]()
+		{
+			round++;
+			for (uint32_t i = 0; i < s_SerializedEntityCount; i += 101)
+			{
+				if (Position* position = scene.TryGetComponent<Position>(entities[i]))
+					position->Y += (float)round;
+			}
+			errors += !writer.Save(scene);
+		}, 5);
+		context.Report("incremental save, 1% changed scattered", scatteredMs,
+			fmt::format("{} chunks written, {} reused, rewritten {}", stats.ChunksWritten, stats.ChunksReused, stats.Rewritten));
+
+		// A structural change and a save with nothing changed have to load back right too
+		scene.DestroyEntity(entities[1]);
+		Entity created = scene.CreateEntity(Position{ 1.0f, 2.0f, 3.0f }, Health{ 1.0f, 2.0f });
+		errors += !writer.Save(scene);
+		errors += !writer.Save(scene);
+		errors += writer.GetStats().ChunksWritten != 0;
+		{
+			SceneFile file;
+			Scene loaded;
+			errors += !file.Open(binaryPath) || !SceneSerializer::Load(file, loaded);
+			entities.push_back(created);
+			errors += CompareScenes(scene, loaded, entities);
+		}
+
+		// A later build with Health at version 2 upgrades the saved ones
+		SceneSchema::Register<HealthV2>("Health", 2, [](const void* old, uint32_t, uint32_t, void* component)
+		{
+			const Health& health = *static_cast<const Health*>(old);
+			*static_cast<HealthV2*>(component) = { health.Current, health.Max, 1.0f };
+		});
+		{
+			SceneFile file;
+			Scene loaded;
+			errors += !file.Open(binaryPath) || !SceneSerializer::Load(file, loaded);
+			for (Entity entity : entities)
+			{
+				Health* health = scene.TryGetComponent<Health>(entity);
+				HealthV2* upgraded = loaded.TryGetComponent<HealthV2>(entity);
+				if (!health || !upgraded)
+					errors += !health != !upgraded;
+				else
+					errors += upgraded->Current != health->Current || upgraded->Max != health->Max || upgraded->Regeneration != 1.0f;
+			}
+			errors += loaded.HasComponent<Health>(entities[2]);
+		}
+		RegisterSerializedComponents();
+
+		if (errors)
+			context.Fail("SceneSerialization: {} entities or saves didn't round trip", errors);
+
+		// A truncated copy has to be refused when opening
+		fs::copy_file(binaryPath, directory / "truncated.rscn");
+		fs::resize_file(directory / "truncated.rscn", fs::file_size(binaryPath) / 2);
+		RE_CORE_INFO("  opening a truncated copy, one error expected:");
+		SceneFile truncated;
+		if (truncated.Open((directory / "truncated.rscn").string()))
+			context.Fail("SceneSerialization: opened a truncated scene file");
+
+		fs::remove_all(directory);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,433 @@
+#include "RockBench/Benchmark.h"
+
+#include "RockEngine/Core/JobSystem.h"
+#include "RockEngine/Platform/Software/SoftwareRendererBackend.h"
+#include "RockEngine/Renderer/QuadBatcher.h"
+
+#include <cmath>
+#include <filesystem>
+#include <thread>
+
+namespace RockEngine
+{
+	static constexpr uint32_t s_Width = 1280;
+	static constexpr uint32_t s_Height = 720;
+
+	struct ColorVertex
+	{
+		float Position[4];		// clip space
+		uint32_t Color;
+		float U;
+	};
+
+	// Per instance offset along x and a perspective projection: x, y and z are view space when
+	// Perspective is set, otherwise already clip space
+	struct MeshUniforms
+	{
+		float Origin = 0.0f;
+		float InstanceOffset = 0.0f;
+		bool Perspective = false;
+	};
+
+	static void ColorVertexShader(const void* vertex, uint32_t instance, const void* uniforms, SoftwareVertexOutput& out)
+	{
+		const ColorVertex& in = *static_cast<const ColorVertex*>(vertex);
+		const MeshUniforms& mesh = *static_cast<const MeshUniforms*>(uniforms);
+		float x = in.Position[0] + mesh.Origin + mesh.InstanceOffset * instance;
+		if (mesh.Perspective)
+		{
+			// 60 degree vertical field of view, near 0.1, far 100, looking down -z
+			constexpr float focal = 1.7320508f, nearZ = 0.1f, farZ = 100.0f;
+			out.Position[0] = x * focal * ((float)s_Height / s_Width);
+			out.Position[1] = in.Position[1] * focal;
+			out.Position[2] = in.Position[2] * (farZ + nearZ) / (nearZ - farZ) + 2.0f * farZ * nearZ / (nearZ - farZ);
+			out.Position[3] = -in.Position[2];
+		}
+		else
+		{
+			out.Position[0] = x;
+			out.Position[1] = in.Position[1];
+			out.Position[2] = in.Position[2];
+			out.Position[3] = in.Position[3];
+		}
+		for (uint32_t channel = 0; channel < 4; channel++)
+			out.Varyings[channel] = (float)((in.Color >> (channel * 8)) & 0xff) * (1.0f / 255.0f);
+		out.Varyings[4] = in.U;
+	}
+
+	static uint32_t ColorFragmentShader(const float* varyings, const void* /*uniforms*/)
+	{
+		return PackRGBA8(varyings[0], varyings[1], varyings[2], varyings[3]);
+	}
+
+	// The interpolated U in red, for checking perspective correction
+	static uint32_t CoordinateFragmentShader(const float* varyings, const void* /*uniforms*/)
+	{
+		return PackRGBA8(varyings[4], 0.0f, 0.0f, 1.0f);
+	}
+
+	static SoftwareShader MakeColorShader(bool depth, bool blend)
+	{
+		SoftwareShader shader;
+		shader.Vertex = ColorVertexShader;
+		shader.Fragment = ColorFragmentShader;
+		shader.VaryingCount = 5;
+		shader.DepthTest = shader.DepthWrite = depth;
+		shader.Blend = blend;
+		return shader;
+	}
+
+	struct Mesh
+	{
+		std::vector<ColorVertex> Vertices;
+		std::vector<uint32_t> Indices;
+
+		void AddQuad(const ColorVertex& a, const ColorVertex& b, const ColorVertex& c, const ColorVertex& d)
+		{
+			uint32_t base = (uint32_t)Vertices.size();
+			Vertices.insert(Vertices.end(), { a, b, c, d });
+			Indices.insert(Indices.end(), { base, base + 1, base + 2, base + 2, base + 3, base });
+		}
+
+		SoftwareDrawCall MakeDrawCall(const SoftwareShader& shader, const MeshUniforms& uniforms, uint32_t instances = 1) const
+		{
+			SoftwareDrawCall call;
+			call.Shader = &shader;
+			call.Uniforms = &uniforms;
+			call.UniformSize = sizeof(uniforms);
+			call.Vertices = Vertices.data();
+			call.VertexStride = sizeof(ColorVertex);
+			call.VertexCount = (uint32_t)Vertices.size();
+			call.Indices = Indices.data();
+			call.IndexCount = (uint32_t)Indices.size();
+			call.InstanceCount = instances;
+			return call;
+		}
+	};
+
+	static ColorVertex MakeVertex(float x, float y, float z, uint32_t color, float u = 0.0f)
+	{
+		return { { x, y, z, 1.0f }, color, u };
+	}
+
+	// Triangles of about `size` pixels on a side scattered over the screen
+	static Mesh MakeSmallTriangles(uint32_t count, float size)
+	{
+		Mesh mesh;
+		mesh.Vertices.reserve((size_t)count * 3);
+		mesh.Indices.reserve((size_t)count * 3);
+		float sizeX = size * 2.0f / s_Width, sizeY = size * 2.0f / s_Height;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			uint32_t hash = i * 2654435761u;
+			float x = (float)(hash % 4096) / 2048.0f - 1.0f, y = (float)((hash >> 12) % 4096) / 2048.0f - 1.0f;
+			uint32_t base = (uint32_t)mesh.Vertices.size();
+			uint32_t color = hash | 0xff000000u;
+			mesh.Vertices.push_back(MakeVertex(x, y, 0.0f, color));
+			mesh.Vertices.push_back(MakeVertex(x + sizeX, y, 0.0f, color));
+			mesh.Vertices.push_back(MakeVertex(x, y + sizeY, 0.0f, color));
+			mesh.Indices.insert(mesh.Indices.end(), { base, base + 1, base + 2 });
+		}
+		return mesh;
+	}
+
+	// Cells covering the whole screen, inner corners jittered so edges have every slope
+	static Mesh MakeJitteredGrid(uint32_t cells, uint32_t color)
+	{
+		Mesh mesh;
+		uint32_t side = cells + 1;
+		for (uint32_t y = 0; y < side; y++)
+		{
+			for (uint32_t x = 0; x < side; x++)
+			{
+				uint32_t hash = (y * side + x) * 2654435761u;
+				bool inner = x > 0 && y > 0 && x < cells && y < cells;
+				float jitterX = inner ? ((float)(hash & 255) / 255.0f - 0.5f) * 0.8f : 0.0f;
+				float jitterY = inner ? ((float)((hash >> 8) & 255) / 255.0f - 0.5f) * 0.8f : 0.0f;
+				mesh.Vertices.push_back(MakeVertex(((float)x + jitterX) / cells * 2.0f - 1.0f, ((float)y + jitterY) / cells * 2.0f - 1.0f, 0.0f, color));
+			}
+		}
+
+		for (uint32_t y = 0; y < cells; y++)
+		{
+			for (uint32_t x = 0; x < cells; x++)
+			{
+				uint32_t corner = y * side + x;
+				// Alternate the diagonal so both orientations of shared edges show up
+				if ((x + y) & 1)
+					mesh.Indices.insert(mesh.Indices.end(), { corner, corner + 1, corner + side + 1, corner + side + 1, corner + side, corner });
+				else
+					mesh.Indices.insert(mesh.Indices.end(), { corner, corner + 1, corner + side, corner + 1, corner + side + 1, corner + side });
+			}
+		}
+		return mesh;
+	}
+
+	// A floor grid in view space, receding into the distance
+	static Mesh MakeTerrain(uint32_t cells)
+	{
+		Mesh mesh;
+		uint32_t side = cells + 1;
+		for (uint32_t z = 0; z < side; z++)
+		{
+			for (uint32_t x = 0; x < side; x++)
+			{
+				float height = std::sin(x * 0.3f) * std::cos(z * 0.2f) * 0.5f;
+				uint32_t shade = 96 + (uint32_t)((height + 0.5f) * 159.0f);
+				mesh.Vertices.push_back(MakeVertex(((float)x / cells - 0.5f) * 8.0f, height - 1.5f, -1.0f - (float)z / cells * 20.0f, shade | shade << 8 | 0xff000000u));
+			}
+		}
+		for (uint32_t z = 0; z < cells; z++)
+		{
+			for (uint32_t x = 0; x < cells; x++)
+			{
+				uint32_t corner = z * side + x;
+				mesh.Indices.insert(mesh.Indices.end(), { corner, corner + 1, corner + side + 1, corner + side + 1, corner + side, corner });
+			}
+		}
+		return mesh;
+	}
+
+	static void Render(SoftwareRasterizer& rasterizer, SoftwareFramebuffer& framebuffer, const SoftwareDrawCall& call)
+	{
+		framebuffer.Clear(0xff000000u);
+		rasterizer.Draw(call);
+		rasterizer.Flush();
+	}
+
+	RE_BENCHMARK(SoftwareRasterization)
+	{
+		SoftwareFramebuffer framebuffer(s_Width, s_Height);
+		SoftwareRasterizer rasterizer;
+		rasterizer.SetTarget(&framebuffer);
+		MeshUniforms flat;
+
+		SoftwareShader opaque = MakeColorShader(false, false);
+		{
+			constexpr uint32_t count = 200000;
+			Mesh mesh = MakeSmallTriangles(count, 6.0f);
+			SoftwareDrawCall call = mesh.MakeDrawCall(opaque, flat);
+			rasterizer.ResetStats();
+			double ms = context.Measure([&]() { Render(rasterizer, framebuffer, call); });
+			uint64_t pixels = rasterizer.GetStats().Pixels / 11;
+			context.Report("200k small triangles (6 px)", ms, fmt::format("{:.1f} M tris/s, {} px/frame", count / ms / 1000.0, pixels));
+		}
+
+		{
+			// Overdraw: 32 full screen quads, opaque and then blended
+			constexpr uint32_t layers = 32;
+			Mesh mesh;
+			for (uint32_t layer = 0; layer < layers; layer++)
+			{
+				uint32_t color = (layer * 2654435761u & 0x00ffffffu) | 0x80000000u;
+				mesh.AddQuad(MakeVertex(-1, -1, 0, color), MakeVertex(1, -1, 0, color), MakeVertex(1, 1, 0, color), MakeVertex(-1, 1, 0, color));
+			}
+			SoftwareShader blended = MakeColorShader(false, true);
+			for (const SoftwareShader* shader : { &opaque, &blended })
+			{
+				SoftwareDrawCall call = mesh.MakeDrawCall(*shader, flat);
+				double ms = context.Measure([&]() { Render(rasterizer, framebuffer, call); });
+				double pixels = (double)layers * s_Width * s_Height;
+				context.Report(fmt::format("32x full screen overdraw, {}", shader->Blend ? "blended" : "opaque"), ms,
+					fmt::format("{:.0f} M pixels/s", pixels / ms / 1000.0));
+			}
+		}
+
+		{
+			// Perspective terrain, 8 instances side by side, depth tested
+			SoftwareShader depth = MakeColorShader(true, false);
+			Mesh mesh = MakeTerrain(128);
+			MeshUniforms uniforms;
+			uniforms.Origin = -28.0f;
+			uniforms.InstanceOffset = 8.0f;
+			uniforms.Perspective = true;
+			SoftwareDrawCall call = mesh.MakeDrawCall(depth, uniforms, 8);
+			rasterizer.ResetStats();
+			double ms = context.Measure([&]() { Render(rasterizer, framebuffer, call); });
+			const SoftwareRasterizerStats& stats = rasterizer.GetStats();
+			uint64_t triangles = call.IndexCount / 3 * call.InstanceCount;
+			context.Report("Perspective terrain, 8x 32k triangles, depth", ms,
+				fmt::format("{:.1f} M tris/s, {} outside the view per frame", triangles / ms / 1000.0, stats.TrianglesCulled / 11));
+		}
+	}
+
+	static std::vector<uint32_t> GetRasterizerWorkerCounts()
+	{
+		uint32_t maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+		std::vector<uint32_t> counts;
+		for (uint32_t count = 1; count < maxWorkers; count *= 2)
+			counts.push_back(count);
+		counts.push_back(maxWorkers);
+		return counts;
+	}
+
+	RE_BENCHMARK(SoftwareRasterizerScaling)
+	{
+		Mesh triangles = MakeSmallTriangles(200000, 6.0f);
+		Mesh overdraw;
+		for (uint32_t layer = 0; layer < 16; layer++)
+			overdraw.AddQuad(MakeVertex(-1, -1, 0, 0xff404040u), MakeVertex(1, -1, 0, 0xff404040u), MakeVertex(1, 1, 0, 0xff404040u), MakeVertex(-1, 1, 0, 0xff404040u));
+
+		SoftwareShader opaque = MakeColorShader(false, false);
+		MeshUniforms flat;
+		double triangleBaseline = 0.0, fillBaseline = 0.0;
+		for (uint32_t workers : GetRasterizerWorkerCounts())
+		{
+			JobSystem::Shutdown();
+			JobSystem::Init({ workers });
+
+			SoftwareFramebuffer framebuffer(s_Width, s_Height);
+			SoftwareRasterizer rasterizer;
+			rasterizer.SetTarget(&framebuffer);
+
+			SoftwareDrawCall triangleCall = triangles.MakeDrawCall(opaque, flat);
+			double triangleMs = context.Measure([&]() { Render(rasterizer, framebuffer, triangleCall); });
+			SoftwareDrawCall fillCall = overdraw.MakeDrawCall(opaque, flat);
+			double fillMs = context.Measure([&]() { Render(rasterizer, framebuffer, fillCall); });
+			if (workers == 1)
+			{
+				triangleBaseline = triangleMs;
+				fillBaseline = fillMs;
+			}
+
+			context.Report(fmt::format("{} workers, 200k small triangles", workers), triangleMs,
+				fmt::format("{:.2f}x, {:.1f} M tris/s", triangleBaseline / triangleMs, 200000 / triangleMs / 1000.0));
+			context.Report(fmt::format("{} workers, 16x full screen fill", workers), fillMs,
+				fmt::format("{:.2f}x, {:.0f} M pixels/s", fillBaseline / fillMs, 16.0 * s_Width * s_Height / fillMs / 1000.0));
+		}
+
+		JobSystem::Shutdown();
+		JobSystem::Init();
+	}
+
+	RE_BENCHMARK(SoftwareRasterizerCorrectness)
+	{
+		SoftwareFramebuffer framebuffer(s_Width, s_Height);
+		SoftwareRasterizer rasterizer;
+		rasterizer.SetTarget(&framebuffer);
+		MeshUniforms flat;
+
+		{
+			// Half transparent white over black: a pixel hit twice comes out brighter, a missed one black
+			SoftwareShader blended = MakeColorShader(false, true);
+			Mesh grid = MakeJitteredGrid(97, 0x80ffffffu);
+			Render(rasterizer, framebuffer, grid.MakeDrawCall(blended, flat));
+
+			uint32_t expected = framebuffer.GetPixel(s_Width / 2, s_Height / 2);
+			uint32_t wrong = 0;
+			for (uint32_t i = 0; i < s_Width * s_Height; i++)
+				wrong += framebuffer.GetColor()[i] != expected;
+			if (wrong || (expected & 0xff) == 0)
+				context.Fail("SoftwareRasterizerCorrectness: {} pixels of a shared edge grid were drawn zero or two times", wrong);
+			RE_CORE_INFO("  Shared edges: {} triangles, {} pixels wrong", grid.Indices.size() / 3, wrong);
+		}
+
+		{
+			// The nearer quad wins whichever is drawn first
+			SoftwareShader depth = MakeColorShader(true, false);
+			Mesh nearFirst, farFirst;
+			ColorVertex nearQuad[4] = { MakeVertex(-0.5f, -0.5f, -0.2f, 0xff0000ffu), MakeVertex(0.5f, -0.5f, -0.2f, 0xff0000ffu), MakeVertex(0.5f, 0.5f, -0.2f, 0xff0000ffu), MakeVertex(-0.5f, 0.5f, -0.2f, 0xff0000ffu) };
+			ColorVertex farQuad[4] = { MakeVertex(-1, -1, 0.5f, 0xff00ff00u), MakeVertex(1, -1, 0.5f, 0xff00ff00u), MakeVertex(1, 1, 0.5f, 0xff00ff00u), MakeVertex(-1, 1, 0.5f, 0xff00ff00u) };
+			nearFirst.AddQuad(nearQuad[0], nearQuad[1], nearQuad[2], nearQuad[3]);
+			nearFirst.AddQuad(farQuad[0], farQuad[1], farQuad[2], farQuad[3]);
+			farFirst.AddQuad(farQuad[0], farQuad[1], farQuad[2], farQuad[3]);
+			farFirst.AddQuad(nearQuad[0], nearQuad[1], nearQuad[2], nearQuad[3]);
+
+			for (const Mesh* mesh : { &nearFirst, &farFirst })
+			{
+				Render(rasterizer, framebuffer, mesh->MakeDrawCall(depth, flat));
+				if (framebuffer.GetPixel(s_Width / 2, s_Height / 2) != 0xff0000ffu || framebuffer.GetPixel(10, 10) != 0xff00ff00u)
+					context.Fail("SoftwareRasterizerCorrectness: depth test kept the wrong surface ({:08x} in the center)", framebuffer.GetPixel(s_Width / 2, s_Height / 2));
+			}
+		}
+
+		{
+			// U goes 0 to 1 across a quad whose right edge is 4 times as far away. Linear in
+			// screen space would be t, perspective correct is 0.25 t / (1 - 0.75 t).
+			SoftwareShader coordinates = MakeColorShader(false, false);
+			coordinates.Fragment = CoordinateFragmentShader;
+			Mesh mesh;
+			ColorVertex left[2] = { MakeVertex(-1, -1, 0, 0, 0.0f), MakeVertex(-1, 1, 0, 0, 0.0f) };
+			ColorVertex right[2] = { { { 4, -4, 0, 4 }, 0, 1.0f }, { { 4, 4, 0, 4 }, 0, 1.0f } };
+			mesh.AddQuad(left[0], right[0], right[1], left[1]);
+			Render(rasterizer, framebuffer, mesh.MakeDrawCall(coordinates, flat));
+
+			int32_t maxError = 0;
+			for (uint32_t x = 0; x < s_Width; x++)
+			{
+				float t = (x + 0.5f) / s_Width;
+				int32_t expected = (int32_t)(0.25f * t / (1.0f - 0.75f * t) * 255.0f + 0.5f);
+				for (uint32_t y : { 1u, s_Height / 2, s_Height - 2 })
+					maxError = std::max(maxError, std::abs((int32_t)(framebuffer.GetPixel(x, y) & 0xff) - expected));
+			}
+			if (maxError > 1)
+				context.Fail("SoftwareRasterizerCorrectness: perspective interpolation off by up to {}/255", maxError);
+			RE_CORE_INFO("  Perspective interpolation: max error {}/255", maxError);
+		}
+
+		{
+			// Top edge behind the camera: clipped at the near plane, which crosses the middle of the
+			// screen, instead of wrapping around through infinity
+			SoftwareShader opaque = MakeColorShader(false, false);
+			Mesh mesh;
+			mesh.AddQuad({ { -1, -1, 0, 1 }, 0xffffffffu, 0 }, { { 1, -1, 0, 1 }, 0xffffffffu, 0 }, { { 1, 3, -2, -1 }, 0xffffffffu, 0 }, { { -1, 3, -2, -1 }, 0xffffffffu, 0 });
+			rasterizer.ResetStats();
+			Render(rasterizer, framebuffer, mesh.MakeDrawCall(opaque, flat));
+			if (rasterizer.GetStats().TrianglesClipped != 2 || framebuffer.GetPixel(s_Width / 2, 0) != 0xff000000u || framebuffer.GetPixel(s_Width / 2, s_Height - 1) != 0xffffffffu)
+				context.Fail("SoftwareRasterizerCorrectness: near plane clipping drew {} triangles wrong", rasterizer.GetStats().TrianglesClipped);
+		}
+	}
+
+	RE_BENCHMARK(SoftwareRendererQuads)
+	{
+		// Renderer2D's batches through the backend, the path the sandbox takes with --software
+		std::vector<QuadInstance> quads(5000);
+		for (uint32_t i = 0; i < quads.size(); i++)
+		{
+			uint32_t hash = i * 2654435761u;
+			quads[i] = { { (float)(hash % s_Width), (float)((hash >> 11) % s_Height), 0.0f }, (i & 3) == 0 ? (float)(hash & 255) * 0.0245f : 0.0f,
+				{ 8.0f + (hash >> 26), 8.0f + ((hash >> 20) & 31) }, { 0.0f, 0.0f, 1.0f, 1.0f }, hash | 0xff000000u, 0 };
+		}
+
+		static constexpr float viewProjection[16] = {
+			2.0f / s_Width, 0.0f, 0.0f, 0.0f,
+			0.0f, 2.0f / s_Height, 0.0f, 0.0f,
+			0.0f, 0.0f, -1.0f, 0.0f,
+			-1.0f, -1.0f, 0.0f, 1.0f
+		};
+
+		SoftwareRendererBackend backend(s_Width, s_Height);
+		backend.Init();
+		uint32_t checker[4] = { 0xffffffffu, 0xff808080u, 0xff808080u, 0xffffffffu };
+		uint32_t texture = backend.CreateTexture(2, 2, checker);
+		for (uint32_t i = 0; i < quads.size(); i += 2)
+			quads[i].Texture = texture;
+
+		QuadBatchData data;
+		std::vector<DrawQuadsCommand> batches;
+		QuadBatcher().Build(quads.data(), (uint32_t)quads.size(), viewProjection, 0, data, batches);
+		backend.SetQuadBatchSource(&data, 1);
+
+		std::vector<RenderCommand> commands;
+		ClearCommand clear = { { 0.1f, 0.1f, 0.1f, 1.0f } };
+		commands.push_back(RenderCommand::Make(clear));
+		for (const DrawQuadsCommand& batch : batches)
+			commands.push_back(RenderCommand::Make(batch));
+
+		backend.GetRasterizer().ResetStats();
+		double ms = context.Measure([&]() { backend.Execute(commands.data(), (uint32_t)commands.size()); });
+		const SoftwareRasterizerStats& stats = backend.GetRasterizer().GetStats();
+		if (stats.Triangles != quads.size() * 2 * 11)
+			context.Fail("SoftwareRendererQuads: rasterized {} triangles for {} quads", stats.Triangles / 11, quads.size());
+		context.Report("5k Renderer2D quads, blended, textured", ms, fmt::format("{} batches, {:.1f} M pixels/frame", batches.size(), stats.Pixels / 11 / 1e6));
+
+		std::filesystem::path path = std::filesystem::temp_directory_path() / "RockBenchSoftware.png";
+		ms = context.Measure([&]() { backend.GetFramebuffer().SavePNG(path.string()); }, 3);
+		std::error_code error;
+		uintmax_t size = std::filesystem::file_size(path, error);
+		if (error || size < (uintmax_t)s_Width * s_Height * 4)
+			context.Fail("SoftwareRendererQuads: {} is {} bytes", path.string(), size);
+		std::filesystem::remove(path, error);
+		context.Report("SavePNG 1280x720", ms, fmt::format("{:.1f} MB", size / 1e6));
+	}
+}
\ No newline at end of file
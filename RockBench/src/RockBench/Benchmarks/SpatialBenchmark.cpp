@@ -0,0 +1,321 @@
+#include "RockBench/Benchmark.h"
+
+#include <cmath>
+
+#include "RockEngine/Spatial/Visibility.h"
+
+namespace RockEngine
+{
+	// Boxes at a constant density, so the camera sees about the same share of every size
+	struct SpatialTestScene
+	{
+		std::vector<AABB> Boxes;
+		std::vector<float> Streams[6];		// MinX, MinY, MinZ, MaxX, MaxY, MaxZ
+		float Size;
+		uint32_t State = 7;
+
+		explicit SpatialTestScene(uint32_t count)
+			: Size(200.0f * std::cbrt(count / 10000.0f))
+		{
+			Boxes.reserve(count);
+			for (uint32_t i = 0; i < count; i++)
+			{
+				Vec3 center(Random(0.0f, Size), Random(0.0f, Size), Random(0.0f, Size));
+				Vec3 extents(Random(0.25f, 2.0f), Random(0.25f, 2.0f), Random(0.25f, 2.0f));
+				Boxes.push_back(AABB::FromCenterExtents(center, extents));
+			}
+			UpdateStreams();
+		}
+
+		float Random(float low, float high)
+		{
+			State = State * 1664525u + 1013904223u;
+			return low + (high - low) * (float)(State >> 8) / (float)(1u << 24);
+		}
+
+		void UpdateStreams()
+		{
+			for (std::vector<float>& stream : Streams)
+				stream.resize(Boxes.size());
+			for (size_t i = 0; i < Boxes.size(); i++)
+			{
+				const AABB& box = Boxes[i];
+				float values[6] = { box.Min.GetX(), box.Min.GetY(), box.Min.GetZ(), box.Max.GetX(), box.Max.GetY(), box.Max.GetZ() };
+				for (uint32_t k = 0; k < 6; k++)
+					Streams[k][i] = values[k];
+			}
+		}
+
+		ConstBoxStream GetStream() const
+		{
+			return { Streams[0].data(), Streams[1].data(), Streams[2].data(), Streams[3].data(), Streams[4].data(), Streams[5].data() };
+		}
+
+		// From inside the volume, seeing roughly a tenth of it
+		Mat4 GetViewProjection(float angle) const
+		{
+			Vec3 eye(Size * 0.5f, Size * 0.5f, Size * 0.5f);
+			Vec3 target = eye + Vec3(std::cos(angle), 0.2f, std::sin(angle));
+			return Mat4::Perspective(Radians(60.0f), 16.0f / 9.0f, 0.1f, Size * 0.6f) * Mat4::LookAt(eye, target, Vec3(0.0f, 1.0f, 0.0f));
+		}
+
+		Ray GetRay(float t)
+		{
+			Vec3 origin(Random(0.0f, Size), Random(0.0f, Size), Random(0.0f, Size));
+			return Ray(origin, Normalize(Vec3(std::cos(t), Random(-0.5f, 0.5f), std::sin(t))));
+		}
+
+		void Fill(DynamicBVH& tree) const
+		{
+			for (uint32_t i = 0; i < Boxes.size(); i++)
+				tree.Insert(Boxes[i], i);
+		}
+	};
+
+	// A BVH result differing from brute force only counts if the box isn't touching a plane,
+	// where FMA rounding may legitimately tip it either way
+	static uint32_t CountCullErrors(const SpatialTestScene& scene, const Frustum& frustum, std::vector<uint32_t> visible)
+	{
+		std::vector<uint8_t> found(scene.Boxes.size(), 0);
+		for (uint32_t object : visible)
+			found[object]++;
+
+		uint32_t errors = 0;
+		for (uint32_t i = 0; i < scene.Boxes.size(); i++)
+		{
+			const AABB& box = scene.Boxes[i];
+			bool expected = frustum.Intersects(box);
+			bool clear = frustum.Intersects(box.Expanded(1e-3f)) == frustum.Intersects(box.Expanded(-1e-3f));
+			if (found[i] > 1 || ((found[i] == 1) != expected && clear))
+				errors++;
+		}
+		return errors;
+	}
+
+	template<typename Backend, uint32_t Width>
+	static void ReportCulling(BenchmarkContext& context, const char* name, const SpatialTestScene& scene, const DynamicBVH& tree, const Frustum& frustum, double bruteMs)
+	{
+		BasicQueryBVH<Backend, Width> bvh;
+		double buildMs = context.Measure([&]() { bvh.Build(tree); }, 3);
+
+		std::vector<uint32_t> visible;
+		visible.reserve(scene.Boxes.size());
+		double cullMs = context.Measure([&]()
+		{
+			visible.clear();
+			bvh.CullFrustum(frustum, visible);
+		});
+
+		context.Report(fmt::format("  BVH{} {} cull (compile {:.2f} ms)", Width, name, buildMs), cullMs, fmt::format("{:.1f}x", bruteMs / cullMs));
+		if (uint32_t errors = CountCullErrors(scene, frustum, visible))
+			context.Fail("SpatialCulling: BVH{} {} disagrees with brute force on {} objects", Width, name, errors);
+	}
+
+	RE_BENCHMARK(SpatialCulling)
+	{
+		for (uint32_t count : { 10000u, 100000u, 1000000u })
+		{
+			SpatialTestScene scene(count);
+			Frustum frustum = Frustum::FromViewProjection(scene.GetViewProjection(0.7f));
+			RE_CORE_INFO("  {} objects", count);
+
+			DynamicBVH tree;
+			double insertMs = context.Measure([&]()
+			{
+				tree = DynamicBVH();
+				scene.Fill(tree);
+			}, 3);
+			float insertCost = tree.GetCost();
+			uint32_t insertHeight = tree.GetHeight();
+			context.Report("  incremental insert", insertMs, fmt::format("cost {:.0f}, height {}", insertCost, insertHeight));
+
+			double rebuildMs = context.Measure([&]() { tree.Rebuild(); }, 3);
+			context.Report("  SAH rebuild", rebuildMs, fmt::format("cost {:.0f}, height {}", tree.GetCost(), tree.GetHeight()));
+
+			uint32_t scalarVisible = 0;
+			double scalarMs = context.Measure([&]()
+			{
+				scalarVisible = 0;
+				for (const AABB& box : scene.Boxes)
+					scalarVisible += frustum.Intersects(box);
+			}, 3);
+			context.Report("  brute force scalar cull", scalarMs, fmt::format("{} visible", scalarVisible));
+
+			std::vector<uint32_t> indices(count);
+			uint32_t simdVisible = 0;
+			double simdMs = context.Measure([&]() { simdVisible = Culling::CullBoxes(scene.GetStream(), count, frustum, indices.data()); });
+			context.Report(fmt::format("  brute force {} cull", SimdTraits<SimdDefault>::Name), simdMs, fmt::format("{:.1f}x", scalarMs / simdMs));
+			indices.resize(simdVisible);
+			if (uint32_t errors = CountCullErrors(scene, frustum, indices))
+				context.Fail("SpatialCulling: brute force kernel disagrees with the scalar test on {} objects", errors);
+
+			ReportCulling<SimdScalar, 8>(context, "Scalar", scene, tree, frustum, scalarMs);
+			ReportCulling<SimdDefault, 4>(context, SimdTraits<SimdDefault>::Name, scene, tree, frustum, scalarMs);
+			ReportCulling<SimdDefault, 8>(context, SimdTraits<SimdDefault>::Name, scene, tree, frustum, scalarMs);
+
+			// Straight into a render queue, as a frame would
+			if (count == 100000)
+			{
+				std::vector<Drawable> drawables(count);
+				for (uint32_t i = 0; i < count; i++)
+				{
+					Vec3 center = scene.Boxes[i].GetCenter();
+					drawables[i].Draw = DrawCommand{ i & 15, i & 255, i & 63, 36, 0, 1 };
+					drawables[i].Center[0] = center.GetX();
+					drawables[i].Center[1] = center.GetY();
+					drawables[i].Center[2] = center.GetZ();
+				}
+
+				QueryBVH bvh;
+				bvh.Build(tree);
+				RenderQueue queue;
+				queue.Init();
+				Mat4 viewProjection = scene.GetViewProjection(0.7f);
+				std::vector<uint32_t> visible;
+				uint32_t submitted = 0, sorted = 0;
+				double submitMs = context.Measure([&]()
+				{
+					submitted = Visibility::CullAndSubmit(queue, bvh, drawables.data(), viewProjection, visible);
+					queue.Sort();
+					sorted = queue.GetSortedCount();
+					queue.Reset();
+				});
+				context.Report("  cull + submit + sort", submitMs, fmt::format("{} draws", submitted));
+				if (sorted != submitted || CountCullErrors(scene, frustum, visible))
+					context.Fail("SpatialCulling: {} of {} visible objects reached the queue", sorted, submitted);
+			}
+		}
+	}
+
+	RE_BENCHMARK(SpatialRays)
+	{
+		static constexpr uint32_t s_RayCount = 1000;
+		for (uint32_t count : { 10000u, 100000u, 1000000u })
+		{
+			SpatialTestScene scene(count);
+			DynamicBVH tree;
+			scene.Fill(tree);
+			tree.Rebuild();
+			QueryBVH bvh;
+			bvh.Build(tree);
+
+			std::vector<Ray> rays;
+			for (uint32_t i = 0; i < s_RayCount; i++)
+				rays.push_back(scene.GetRay(i * 0.1f));
+			float maxT = scene.Size * 0.25f;
+
+			// Brute force on a sample only, it's linear in the object count
+			uint32_t bruteRays = std::min(s_RayCount, 10000000u / count);
+			std::vector<RayHit> bruteHits(bruteRays);
+			double bruteMs = context.Measure([&]()
+			{
+				for (uint32_t i = 0; i < bruteRays; i++)
+					Culling::Raycast(scene.GetStream(), count, rays[i], maxT, bruteHits[i]);
+			}, 3) * s_RayCount / bruteRays;
+
+			std::vector<RayHit> hits(s_RayCount);
+			double bvhMs = context.Measure([&]()
+			{
+				for (uint32_t i = 0; i < s_RayCount; i++)
+					bvh.Raycast(rays[i], maxT, hits[i]);
+			});
+
+			uint32_t hitCount = 0, errors = 0;
+			for (uint32_t i = 0; i < bruteRays; i++)
+			{
+				hitCount += hits[i].Object != ~0u;
+				if ((hits[i].Object == ~0u) != (bruteHits[i].Object == ~0u) || std::abs(hits[i].T - bruteHits[i].T) > 1e-4f * maxT)
+					errors++;
+			}
+			context.Report(fmt::format("  {} objects, {} closest hit rays, brute force", count, s_RayCount), bruteMs);
+			context.Report(fmt::format("  {} objects, {} closest hit rays, BVH{}", count, s_RayCount, QueryBVH::NodeWidth), bvhMs,
+				fmt::format("{:.0f}x, {}/{} sampled rays hit", bruteMs / bvhMs, hitCount, bruteRays));
+			if (errors)
+				context.Fail("SpatialRays: {} closest hits differ from brute force", errors);
+
+			// Every hit along the ray, against the scalar slab test
+			std::vector<uint32_t> all;
+			uint32_t queryErrors = 0;
+			for (uint32_t i = 0; i < std::min(bruteRays, 100u); i++)
+			{
+				all.clear();
+				bvh.RayQuery(rays[i], maxT, all);
+				std::sort(all.begin(), all.end());
+
+				std::vector<uint32_t> expected;
+				for (uint32_t object = 0; object < count; object++)
+				{
+					float t;
+					if (rays[i].Intersects(scene.Boxes[object], maxT, t))
+						expected.push_back(object);
+				}
+				queryErrors += all != expected;
+			}
+			if (queryErrors)
+				context.Fail("SpatialRays: {} ray queries differ from brute force", queryErrors);
+		}
+	}
+
+	RE_BENCHMARK(SpatialDynamic)
+	{
+		for (uint32_t count : { 10000u, 100000u, 1000000u })
+		{
+			SpatialTestScene scene(count);
+			DynamicBVH tree(0.5f);
+			std::vector<uint32_t> proxies;
+			for (uint32_t i = 0; i < count; i++)
+				proxies.push_back(tree.Insert(scene.Boxes[i], i));
+			tree.Rebuild();
+
+			// A tenth of the objects drift every frame
+			uint32_t moving = count / 10;
+			auto drift = [&]()
+			{
+				for (uint32_t i = 0; i < moving; i++)
+				{
+					AABB& box = scene.Boxes[i * 10];
+					Vec3 offset(scene.Random(-0.2f, 0.2f), scene.Random(-0.2f, 0.2f), scene.Random(-0.2f, 0.2f));
+					box = AABB(box.Min + offset, box.Max + offset);
+				}
+			};
+
+			uint32_t reinserted = 0;
+			double moveMs = context.Measure([&]()
+			{
+				drift();
+				for (uint32_t i = 0; i < moving; i++)
+					reinserted += tree.Move(proxies[i * 10], scene.Boxes[i * 10]);
+			});
+			context.Report(fmt::format("  {} objects, {} moved, Move", count, moving), moveMs, fmt::format("{} reinserted in total", reinserted));
+
+			double refitMs = context.Measure([&]()
+			{
+				drift();
+				for (uint32_t i = 0; i < moving; i++)
+					tree.SetBounds(proxies[i * 10], scene.Boxes[i * 10]);
+				tree.Refit();
+			});
+			context.Report(fmt::format("  {} objects, {} moved, SetBounds + Refit", count, moving), refitMs, fmt::format("cost {:.0f}", tree.GetCost()));
+
+			QueryBVH bvh;
+			double compileMs = context.Measure([&]() { bvh.Build(tree); }, 3);
+			context.Report("  compile query BVH", compileMs);
+
+			// Remove and insert half, then check the tree still matches brute force
+			for (uint32_t i = 0; i < count; i += 2)
+				tree.Remove(proxies[i]);
+			for (uint32_t i = 0; i < count; i += 2)
+				proxies[i] = tree.Insert(scene.Boxes[i], i);
+			bvh.Build(tree);
+
+			scene.UpdateStreams();
+			Frustum frustum = Frustum::FromViewProjection(scene.GetViewProjection(2.0f));
+			std::vector<uint32_t> visible;
+			bvh.CullFrustum(frustum, visible);
+			if (uint32_t errors = CountCullErrors(scene, frustum, visible))
+				context.Fail("SpatialDynamic: culling after moves and reinserts disagrees with brute force on {} objects", errors);
+			if (tree.GetProxyCount() != count || bvh.GetObjectCount() != count)
+				context.Fail("SpatialDynamic: {} proxies, {} compiled objects, expected {}", tree.GetProxyCount(), bvh.GetObjectCount(), count);
+		}
+	}
+}
\ No newline at end of file
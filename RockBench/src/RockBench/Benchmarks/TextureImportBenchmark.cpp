@@ -0,0 +1,796 @@
+#include "RockBench/Benchmark.h"
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "RockEngine/Asset/BlockCompression.h"
+#include "RockEngine/Asset/ImageDecoder.h"
+#include "RockEngine/Asset/MipGenerator.h"
+#include "RockEngine/Asset/TextureImporter.h"
+#include "RockEngine/Core/Profiler.h"
+
+namespace RockEngine
+{
+	namespace fs = std::filesystem;
+
+	static constexpr uint32_t s_SourceSize = 512;
+	static constexpr uint32_t s_SourcesPerFormat = 8;
+
+	template<typename Func>
+	static void ForEachBackend(Func&& func)
+	{
+		func(SimdScalar{});
+	#ifdef RE_SIMD_SSE
+		func(SimdSSE{});
+	#endif
+	#ifdef RE_SIMD_AVX
+		func(SimdAVX{});
+	#endif
+	}
+
+	static double ToMB(uint64_t bytes) { return bytes / (1024.0 * 1024.0); }
+
+	// Smooth gradients, waves, hard edged tiles and a noisy band: some of everything photos and
+	// painted textures have. `alpha` adds a soft disc of coverage with a fully transparent outside.
+	static std::vector<uint8_t> MakeImage(uint32_t width, uint32_t height, uint32_t seed, bool alpha)
+	{
+		std::vector<uint8_t> pixels((size_t)width * height * 4);
+		uint32_t state = seed * 2654435761u + 1;
+		for (uint32_t y = 0; y < height; y++)
+		{
+			for (uint32_t x = 0; x < width; x++)
+			{
+				state = state * 1664525u + 1013904223u;
+				float u = (float)x / width, v = (float)y / height;
+				bool tile = ((x / 32) + (y / 32) + seed) % 5 == 0;
+				float noise = v > 0.75f ? (float)(state >> 24) / 8.0f - 16.0f : 0.0f;
+
+				uint8_t* pixel = &pixels[((size_t)y * width + x) * 4];
+				pixel[0] = (uint8_t)std::clamp(255.0f * u + noise, 0.0f, 255.0f);
+				pixel[1] = (uint8_t)std::clamp(128.0f + 100.0f * std::sin(u * 12.0f + seed) * std::cos(v * 9.0f) + noise, 0.0f, 255.0f);
+				pixel[2] = tile ? 240 : (uint8_t)std::clamp(255.0f * v + noise, 0.0f, 255.0f);
+				pixel[3] = 255;
+				if (alpha)
+				{
+					float distance = std::sqrt((u - 0.5f) * (u - 0.5f) + (v - 0.5f) * (v - 0.5f));
+					pixel[3] = (uint8_t)std::clamp((0.45f - distance) * 2048.0f, 0.0f, 255.0f);
+				}
+			}
+		}
+		return pixels;
+	}
+
+	static void WriteFile(const fs::path& path, const std::vector<uint8_t>& data)
+	{
+		std::ofstream stream(path, std::ios::binary);
+		stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+	}
+
+	static void AppendBigEndian(std::vector<uint8_t>& out, uint32_t value, uint32_t bytes)
+	{
+		for (uint32_t i = bytes; i-- > 0;)
+			out.push_back((uint8_t)(value >> (i * 8)));
+	}
+
+	// --- PNG: every filter type, one fixed Huffman deflate block of literals and runs ---------
+
+	class DeflateWriter
+	{
+	public:
+		void WriteBits(uint32_t value, uint32_t count)
+		{
+			m_Bits |= (uint64_t)value << m_Count;
+			m_Count += count;
+			while (m_Count >= 8)
+			{
+				Data.push_back((uint8_t)m_Bits);
+				m_Bits >>= 8;
+				m_Count -= 8;
+			}
+		}
+
+		// Huffman codes go out most significant bit first
+		void WriteCode(uint32_t code, uint32_t length)
+		{
+			for (uint32_t i = length; i-- > 0;)
+				WriteBits((code >> i) & 1, 1);
+		}
+
+		void WriteSymbol(uint32_t symbol)
+		{
+			if (symbol < 144)
+				WriteCode(0x30 + symbol, 8);
+			else if (symbol < 256)
+				WriteCode(0x190 + symbol - 144, 9);
+			else if (symbol < 280)
+				WriteCode(symbol - 256, 7);
+			else
+				WriteCode(0xC0 + symbol - 280, 8);
+		}
+
+		void Flush()
+		{
+			if (m_Count)
+				WriteBits(0, 8 - m_Count);
+		}
+
+		std::vector<uint8_t> Data;
+	private:
+		uint64_t m_Bits = 0;
+		uint32_t m_Count = 0;
+	};
+
+	static std::vector<uint8_t> Deflate(const std::vector<uint8_t>& data)
+	{
+		static constexpr uint16_t s_LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+		static constexpr uint8_t s_LengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+		DeflateWriter writer;
+		writer.Data = { 0x78, 0x01 };
+		writer.WriteBits(1, 1);		// final
+		writer.WriteBits(1, 2);		// fixed Huffman codes
+		for (size_t i = 0; i < data.size();)
+		{
+			size_t run = 0;
+			while (i > 0 && run < 258 && i + run < data.size() && data[i + run] == data[i - 1])
+				run++;
+			if (run < 3)
+			{
+				writer.WriteSymbol(data[i++]);
+				continue;
+			}
+
+			// Copies of the previous byte: distance 1 is code 0 with no extra bits
+			uint32_t code = run == 258 ? 28 : 0;
+			while (run != 258 && s_LengthBase[code + 1] <= run)
+				code++;
+			writer.WriteSymbol(257 + code);
+			writer.WriteBits((uint32_t)run - s_LengthBase[code], s_LengthExtra[code]);
+			writer.WriteCode(0, 5);
+			i += run;
+		}
+		writer.WriteSymbol(256);
+		writer.Flush();
+
+		uint32_t a = 1, b = 0;
+		for (uint8_t byte : data)
+		{
+			a = (a + byte) % 65521;
+			b = (b + a) % 65521;
+		}
+		AppendBigEndian(writer.Data, (b << 16) | a, 4);
+		return writer.Data;
+	}
+
+	static uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+	{
+		static const std::vector<uint32_t> s_Table = []()
+		{
+			std::vector<uint32_t> table(256);
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				uint32_t value = i;
+				for (uint32_t bit = 0; bit < 8; bit++)
+					value = value & 1 ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+				table[i] = value;
+			}
+			return table;
+		}();
+
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++)
+			crc = s_Table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		return ~crc;
+	}
+
+	static void AppendChunk(std::vector<uint8_t>& png, const char* type, const std::vector<uint8_t>& data)
+	{
+		AppendBigEndian(png, (uint32_t)data.size(), 4);
+		size_t start = png.size();
+		png.insert(png.end(), type, type + 4);
+		png.insert(png.end(), data.begin(), data.end());
+		AppendBigEndian(png, Crc32(&png[start], png.size() - start), 4);
+	}
+
+	static uint8_t Paeth(int32_t a, int32_t b, int32_t c)
+	{
+		int32_t p = a + b - c, pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+		return (uint8_t)(pa <= pb && pa <= pc ? a : pb <= pc ? b : c);
+	}
+
+	static std::vector<uint8_t> EncodePNG(const std::vector<uint8_t>& pixels, uint32_t width, uint32_t height, bool alpha)
+	{
+		const uint32_t channels = alpha ? 4 : 3, stride = width * channels;
+		std::vector<uint8_t> raw, previous(stride, 0), row(stride);
+		for (uint32_t y = 0; y < height; y++)
+		{
+			for (uint32_t x = 0; x < width; x++)
+				std::memcpy(&row[x * channels], &pixels[((size_t)y * width + x) * 4], channels);
+
+			uint8_t filter = (uint8_t)(y % 5);
+			raw.push_back(filter);
+			for (uint32_t i = 0; i < stride; i++)
+			{
+				int32_t a = i >= channels ? row[i - channels] : 0, b = previous[i], c = i >= channels ? previous[i - channels] : 0;
+				int32_t predictor = filter == 1 ? a : filter == 2 ? b : filter == 3 ? (a + b) / 2 : filter == 4 ? Paeth(a, b, c) : 0;
+				raw.push_back((uint8_t)(row[i] - predictor));
+			}
+			previous.swap(row);
+		}
+
+		std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A }, header;
+		AppendBigEndian(header, width, 4);
+		AppendBigEndian(header, height, 4);
+		header.insert(header.end(), { 8, (uint8_t)(alpha ? 6 : 2), 0, 0, 0 });
+		AppendChunk(png, "IHDR", header);
+		AppendChunk(png, "IDAT", Deflate(raw));
+		AppendChunk(png, "IEND", {});
+		return png;
+	}
+
+	// --- JPEG: baseline 4:4:4 with simple fixed length Huffman codes -------------------------
+
+	class JPEGBitWriter
+	{
+	public:
+		void WriteBits(uint32_t value, uint32_t count)
+		{
+			for (uint32_t i = count; i-- > 0;)
+			{
+				m_Byte = (uint8_t)((m_Byte << 1) | ((value >> i) & 1));
+				if (++m_Count == 8)
+				{
+					Data.push_back(m_Byte);
+					if (m_Byte == 0xFF)
+						Data.push_back(0x00);
+					m_Byte = 0;
+					m_Count = 0;
+				}
+			}
+		}
+
+		void Flush()
+		{
+			if (m_Count)
+				WriteBits(0x7F, 8 - m_Count);
+		}
+
+		std::vector<uint8_t> Data;
+	private:
+		uint8_t m_Byte = 0;
+		uint32_t m_Count = 0;
+	};
+
+	static uint32_t GetMagnitudeSize(int32_t value)
+	{
+		uint32_t size = 0;
+		for (uint32_t magnitude = (uint32_t)std::abs(value); magnitude; magnitude >>= 1)
+			size++;
+		return size;
+	}
+
+	static void WriteMagnitude(JPEGBitWriter& writer, int32_t value, uint32_t size)
+	{
+		writer.WriteBits((uint32_t)(value < 0 ? value + (1 << size) - 1 : value), size);
+	}
+
+	// DC categories get 4 bit codes and run/size symbols 9 bit ones, both equal to the symbol
+	static std::vector<uint8_t> EncodeJPEG(const std::vector<uint8_t>& pixels, uint32_t width, uint32_t height)
+	{
+		uint8_t zigzag[64];
+		for (uint32_t sum = 0, k = 0; sum < 15; sum++)
+		{
+			int32_t first = sum < 8 ? 0 : sum - 7, last = sum < 8 ? sum : 7;
+			for (int32_t i = first; i <= last; i++, k++)
+			{
+				int32_t row = sum % 2 ? i : (int32_t)sum - i;
+				zigzag[k] = (uint8_t)(row * 8 + sum - row);
+			}
+		}
+
+		float cosines[8][8];
+		uint8_t quantization[64];
+		for (uint32_t u = 0; u < 8; u++)
+		{
+			for (uint32_t x = 0; x < 8; x++)
+				cosines[u][x] = (u ? 0.5f : 0.5f / std::sqrt(2.0f)) * std::cos((2 * x + 1) * u * 3.14159265f / 16.0f);
+			for (uint32_t v = 0; v < 8; v++)
+				quantization[v * 8 + u] = (uint8_t)(4 + 2 * (u + v));
+		}
+
+		std::vector<uint8_t> jpeg = { 0xFF, 0xD8, 0xFF, 0xDB, 0x00, 67, 0x00 };
+		for (uint32_t k = 0; k < 64; k++)
+			jpeg.push_back(quantization[zigzag[k]]);
+
+		jpeg.insert(jpeg.end(), { 0xFF, 0xC0, 0x00, 17, 8 });
+		AppendBigEndian(jpeg, height, 2);
+		AppendBigEndian(jpeg, width, 2);
+		jpeg.insert(jpeg.end(), { 3, 1, 0x11, 0, 2, 0x11, 0, 3, 0x11, 0 });
+
+		jpeg.insert(jpeg.end(), { 0xFF, 0xC4 });
+		AppendBigEndian(jpeg, 2 + 17 + 12 + 17 + 255, 2);
+		jpeg.insert(jpeg.end(), { 0x00, 0, 0, 0, 12, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 });
+		for (uint8_t symbol = 0; symbol < 12; symbol++)
+			jpeg.push_back(symbol);
+		jpeg.insert(jpeg.end(), { 0x10, 0, 0, 0, 0, 0, 0, 0, 0, 255, 0, 0, 0, 0, 0, 0, 0 });
+		for (uint32_t symbol = 0; symbol < 255; symbol++)
+			jpeg.push_back((uint8_t)symbol);
+
+		jpeg.insert(jpeg.end(), { 0xFF, 0xDA, 0x00, 12, 3, 1, 0x00, 2, 0x00, 3, 0x00, 0, 63, 0 });
+
+		JPEGBitWriter writer;
+		int32_t predictions[3] = {};
+		for (uint32_t blockY = 0; blockY < (height + 7) / 8; blockY++)
+		{
+			for (uint32_t blockX = 0; blockX < (width + 7) / 8; blockX++)
+			{
+				float samples[3][64];
+				for (uint32_t i = 0; i < 64; i++)
+				{
+					uint32_t x = std::min(blockX * 8 + i % 8, width - 1), y = std::min(blockY * 8 + i / 8, height - 1);
+					const uint8_t* pixel = &pixels[((size_t)y * width + x) * 4];
+					float r = pixel[0], g = pixel[1], b = pixel[2];
+					samples[0][i] = 0.299f * r + 0.587f * g + 0.114f * b - 128.0f;
+					samples[1][i] = -0.168736f * r - 0.331264f * g + 0.5f * b;
+					samples[2][i] = 0.5f * r - 0.418688f * g - 0.081312f * b;
+				}
+
+				for (uint32_t component = 0; component < 3; component++)
+				{
+					int32_t coefficients[64];
+					for (uint32_t v = 0; v < 8; v++)
+					{
+						for (uint32_t u = 0; u < 8; u++)
+						{
+							float sum = 0.0f;
+							for (uint32_t y = 0; y < 8; y++)
+							{
+								for (uint32_t x = 0; x < 8; x++)
+									sum += cosines[u][x] * cosines[v][y] * samples[component][y * 8 + x];
+							}
+							coefficients[v * 8 + u] = (int32_t)std::lround(sum / quantization[v * 8 + u]);
+						}
+					}
+
+					int32_t difference = coefficients[0] - predictions[component];
+					predictions[component] = coefficients[0];
+					uint32_t size = GetMagnitudeSize(difference);
+					writer.WriteBits(size, 4);
+					WriteMagnitude(writer, difference, size);
+
+					uint32_t run = 0;
+					for (uint32_t k = 1; k < 64; k++)
+					{
+						int32_t value = coefficients[zigzag[k]];
+						if (value == 0)
+						{
+							run++;
+							continue;
+						}
+						for (; run > 15; run -= 16)
+							writer.WriteBits(0xF0, 9);
+						size = GetMagnitudeSize(value);
+						writer.WriteBits((run << 4) | size, 9);
+						WriteMagnitude(writer, value, size);
+						run = 0;
+					}
+					if (run)
+						writer.WriteBits(0x00, 9);
+				}
+			}
+		}
+		writer.Flush();
+
+		jpeg.insert(jpeg.end(), writer.Data.begin(), writer.Data.end());
+		jpeg.insert(jpeg.end(), { 0xFF, 0xD9 });
+		return jpeg;
+	}
+
+	// --- TGA: 32 bit RLE, top left origin ----------------------------------------------------
+
+	static std::vector<uint8_t> EncodeTGA(const std::vector<uint8_t>& pixels, uint32_t width, uint32_t height)
+	{
+		std::vector<uint8_t> tga = { 0, 0, 10, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			(uint8_t)width, (uint8_t)(width >> 8), (uint8_t)height, (uint8_t)(height >> 8), 32, 0x28 };
+
+		auto bgra = [&](size_t i) { return std::array<uint8_t, 4>{ pixels[i * 4 + 2], pixels[i * 4 + 1], pixels[i * 4], pixels[i * 4 + 3] }; };
+		const size_t count = (size_t)width * height;
+		for (size_t i = 0; i < count;)
+		{
+			size_t run = 1;
+			while (i + run < count && run < 128 && bgra(i + run) == bgra(i))
+				run++;
+			if (run > 1)
+			{
+				tga.push_back((uint8_t)(0x80 | (run - 1)));
+				auto pixel = bgra(i);
+				tga.insert(tga.end(), pixel.begin(), pixel.end());
+				i += run;
+				continue;
+			}
+
+			// Raw packet up to the next run
+			size_t raw = 1;
+			while (i + raw < count && raw < 128 && !(i + raw + 1 < count && bgra(i + raw) == bgra(i + raw + 1)))
+				raw++;
+			tga.push_back((uint8_t)(raw - 1));
+			for (size_t k = 0; k < raw; k++)
+			{
+				auto pixel = bgra(i + k);
+				tga.insert(tga.end(), pixel.begin(), pixel.end());
+			}
+			i += raw;
+		}
+		return tga;
+	}
+
+	struct TextureSource
+	{
+		std::string Path;
+		ImageFileFormat Format;
+		uint32_t Width, Height;
+		std::vector<uint8_t> Pixels;
+		uint64_t FileBytes;
+	};
+
+	static std::vector<TextureSource> WriteSources(const fs::path& directory)
+	{
+		std::vector<TextureSource> sources;
+		auto add = [&](ImageFileFormat format, uint32_t width, uint32_t height, uint32_t seed)
+		{
+			bool alpha = format == ImageFileFormat::TGA || (format == ImageFileFormat::PNG && seed % 2 == 0);
+			TextureSource& source = sources.emplace_back();
+			source.Format = format;
+			source.Width = width;
+			source.Height = height;
+			source.Pixels = MakeImage(width, height, seed, alpha);
+
+			std::vector<uint8_t> file;
+			const char* extension = "";
+			switch (format)
+			{
+			case ImageFileFormat::PNG: file = EncodePNG(source.Pixels, width, height, alpha); extension = "png"; break;
+			case ImageFileFormat::JPEG: file = EncodeJPEG(source.Pixels, width, height); extension = "jpg"; break;
+			default: file = EncodeTGA(source.Pixels, width, height); extension = "tga"; break;
+			}
+			source.Path = (directory / fmt::format("texture_{:02}.{}", seed, extension)).string();
+			source.FileBytes = file.size();
+			WriteFile(source.Path, file);
+		};
+
+		uint32_t seed = 0;
+		for (ImageFileFormat format : { ImageFileFormat::PNG, ImageFileFormat::JPEG, ImageFileFormat::TGA })
+		{
+			for (uint32_t i = 0; i < s_SourcesPerFormat; i++)
+				add(format, s_SourceSize, s_SourceSize, seed++);
+		}
+		// Odd sizes: partial JPEG blocks, mips that halve unevenly, partial BC blocks
+		add(ImageFileFormat::PNG, 301, 177, seed++);
+		add(ImageFileFormat::JPEG, 333, 64, seed++);
+		add(ImageFileFormat::TGA, 1, 1, seed++);
+		return sources;
+	}
+
+	static const char* GetFormatName(ImageFileFormat format)
+	{
+		switch (format)
+		{
+		case ImageFileFormat::PNG: return "PNG";
+		case ImageFileFormat::JPEG: return "JPEG";
+		case ImageFileFormat::TGA: return "TGA";
+		default: return "?";
+		}
+	}
+
+	RE_BENCHMARK(TextureImport)
+	{
+		fs::path directory = fs::temp_directory_path() / "RockBench-textures";
+		fs::remove_all(directory);
+		fs::create_directories(directory / "sources");
+		std::vector<TextureSource> sources = WriteSources(directory / "sources");
+		uint32_t errors = 0;
+
+		// Decoding: lossless formats have to match exactly, JPEG within its quantization error
+		for (ImageFileFormat format : { ImageFileFormat::PNG, ImageFileFormat::JPEG, ImageFileFormat::TGA })
+		{
+			std::vector<std::vector<uint8_t>> files;
+			std::vector<const TextureSource*> matching;
+			uint64_t pixelBytes = 0;
+			for (const TextureSource& source : sources)
+			{
+				if (source.Format != format)
+					continue;
+				std::ifstream stream(source.Path, std::ios::binary);
+				files.emplace_back((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+				matching.push_back(&source);
+				pixelBytes += source.Pixels.size();
+			}
+
+			std::vector<DecodedImage> images(files.size());
+			double ms = context.Measure([&]()
+			{
+				for (size_t i = 0; i < files.size(); i++)
+					errors += !ImageDecoder::Decode(files[i].data(), files[i].size(), images[i], matching[i]->Path);
+			}, 3);
+			context.Report(fmt::format("decode {} {}", files.size(), GetFormatName(format)), ms, fmt::format("{:.0f} MB/s of pixels", ToMB(pixelBytes) / (ms / 1000.0)));
+
+			double worstMean = 0.0;
+			for (size_t i = 0; i < images.size(); i++)
+			{
+				const TextureSource& source = *matching[i];
+				if (images[i].Width != source.Width || images[i].Height != source.Height || images[i].Pixels.size() != source.Pixels.size())
+				{
+					errors++;
+					continue;
+				}
+
+				uint64_t difference = 0;
+				for (size_t k = 0; k < source.Pixels.size(); k++)
+				{
+					uint8_t expected = format == ImageFileFormat::JPEG && k % 4 == 3 ? 255 : source.Pixels[k];
+					difference += (uint64_t)std::abs(images[i].Pixels[k] - expected);
+				}
+				double mean = (double)difference / source.Pixels.size();
+				worstMean = std::max(worstMean, mean);
+				if (format == ImageFileFormat::JPEG ? mean > 4.0 : difference != 0)
+				{
+					context.Fail("TextureImport: {} decoded wrong, mean difference {:.2f}", source.Path, mean);
+					errors++;
+				}
+			}
+			if (format == ImageFileFormat::JPEG)
+				RE_CORE_INFO("  JPEG mean difference to the source pixels: {:.2f}", worstMean);
+		}
+
+		// Mip filtering, one thread, per SIMD backend: 1024x1024 to 512x512 with the Kaiser filter
+		{
+			const uint32_t size = 1024, half = size / 2;
+			std::vector<uint8_t> image = MakeImage(size, size, 3, false);
+			std::vector<float> source((size_t)size * size * 4), horizontal((size_t)half * size * 4), scalarResult, result((size_t)half * half * 4);
+			for (size_t i = 0; i < source.size(); i++)
+				source[i] = image[i] / 255.0f;
+			const ResampleTaps taps = MipGenerator::GetTaps(size, half, MipFilter::Kaiser, false);
+
+			double scalarMs = 0.0;
+			ForEachBackend([&](auto backend)
+			{
+				using B = decltype(backend);
+				using Kernels = MipKernels<B>;
+				double ms = context.Measure([&]()
+				{
+					for (uint32_t y = 0; y < size; y++)
+						Kernels::ResampleRow(&source[(size_t)y * size * 4], &horizontal[(size_t)y * half * 4], taps, half);
+					const float* rows[16];
+					for (uint32_t y = 0; y < half; y++)
+					{
+						for (uint32_t tap = 0; tap < taps.TapCount; tap++)
+							rows[tap] = &horizontal[(size_t)taps.Indices[y * taps.TapCount + tap] * half * 4];
+						Kernels::BlendRows(rows, &taps.Weights[y * taps.TapCount], taps.TapCount, &result[(size_t)y * half * 4], half * 4);
+					}
+				}, 5);
+
+				if (scalarResult.empty())
+				{
+					scalarMs = ms;
+					scalarResult = result;
+				}
+				float worst = 0.0f;
+				for (size_t i = 0; i < result.size(); i++)
+					worst = std::max(worst, std::abs(result[i] - scalarResult[i]));
+				if (worst > 1e-4f)
+				{
+					context.Fail("TextureImport: the {} mip kernels are off the scalar ones by {}", SimdTraits<B>::Name, worst);
+					errors++;
+				}
+				context.Report(fmt::format("Kaiser 1024x1024 to 512x512 ({})", SimdTraits<B>::Name), ms, fmt::format("{:.1f}x", scalarMs / ms));
+			});
+
+			for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser })
+			{
+				std::vector<MipLevel> levels;
+				double ms = context.Measure([&]()
+				{
+					levels.clear();
+					MipGenerator::Generate(image.data(), size, size, filter, true, false, levels);
+				}, 5);
+				context.Report(fmt::format("full sRGB mip chain of 1024x1024, {}", filter == MipFilter::Box ? "box" : "Kaiser"), ms,
+					fmt::format("{} levels", levels.size() + 1));
+			}
+		}
+
+		// Gamma correctness: a flat color stays the same color all the way down, and a one texel
+		// checkerboard of black and white averages to half the light, 188 in sRGB (not 128)
+		{
+			std::vector<uint8_t> flat(64 * 48 * 4), checker(64 * 64 * 4);
+			for (size_t i = 0; i < flat.size(); i += 4)
+			{
+				flat[i] = 200;
+				flat[i + 1] = 100;
+				flat[i + 2] = 30;
+				flat[i + 3] = 255;
+			}
+			for (uint32_t i = 0; i < 64 * 64; i++)
+			{
+				uint8_t value = (i % 64 + i / 64) % 2 ? 255 : 0;
+				checker[i * 4] = checker[i * 4 + 1] = checker[i * 4 + 2] = value;
+				checker[i * 4 + 3] = 255;
+			}
+
+			for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser })
+			{
+				std::vector<MipLevel> levels;
+				MipGenerator::Generate(flat.data(), 64, 48, filter, true, false, levels);
+				for (const MipLevel& level : levels)
+				{
+					for (size_t i = 0; i < level.Pixels.size(); i++)
+						errors += level.Pixels[i] != flat[i % 4];
+				}
+				errors += levels.size() != 6 || levels.back().Width != 1 || levels.back().Height != 1;
+			}
+
+			std::vector<MipLevel> levels;
+			MipGenerator::Generate(checker.data(), 64, 64, MipFilter::Box, true, true, levels);
+			RE_CORE_INFO("  black/white checkerboard mip: {} (sRGB 188 is half the light)", levels[0].Pixels[0]);
+			if (levels[0].Pixels[0] != 188)
+			{
+				context.Fail("TextureImport: mips aren't filtered in linear light");
+				errors++;
+			}
+		}
+
+		// Block compression of a 1024x1024 color texture, and BC1 cutout alpha
+		{
+			const uint32_t size = 1024;
+			std::vector<uint8_t> image = MakeImage(size, size, 5, true), decoded(image.size());
+			for (bool bc3 : { false, true })
+			{
+				const uint32_t blockSize = bc3 ? BlockCompression::BC3BlockSize : BlockCompression::BC1BlockSize;
+				std::vector<uint8_t> blocks(BlockCompression::GetSize(size, size, blockSize));
+				double ms = context.Measure([&]()
+				{
+					if (bc3)
+						BlockCompression::EncodeBC3(image.data(), size, size, blocks.data());
+					else
+						BlockCompression::EncodeBC1(image.data(), size, size, blocks.data());
+				}, 3);
+
+				if (bc3)
+					BlockCompression::DecodeBC3(blocks.data(), size, size, decoded.data());
+				else
+					BlockCompression::DecodeBC1(blocks.data(), size, size, decoded.data());
+
+				// Color error over the texels that stay visible, alpha error over all of them
+				double colorError = 0.0, alphaError = 0.0;
+				uint64_t visible = 0;
+				for (size_t i = 0; i < image.size(); i += 4)
+				{
+					uint8_t expectedAlpha = bc3 ? image[i + 3] : (image[i + 3] < 128 ? 0 : 255);
+					alphaError += std::pow(decoded[i + 3] - expectedAlpha, 2.0);
+					if (image[i + 3] < 128)
+						continue;
+					visible++;
+					for (uint32_t c = 0; c < 3; c++)
+						colorError += std::pow(decoded[i + c] - image[i + c], 2.0);
+				}
+				double colorRMSE = std::sqrt(colorError / (visible * 3)), alphaRMSE = std::sqrt(alphaError / (size * size));
+				context.Report(fmt::format("{} encode 1024x1024", bc3 ? "BC3" : "BC1"), ms,
+					fmt::format("{:.1f} MP/s, RMSE color {:.2f} alpha {:.2f}", size * size / (ms * 1000.0), colorRMSE, alphaRMSE));
+				if (colorRMSE > 6.0 || alphaRMSE > (bc3 ? 2.0 : 0.0))
+				{
+					context.Fail("TextureImport: {} quality is off", bc3 ? "BC3" : "BC1");
+					errors++;
+				}
+			}
+		}
+
+		// Importing: cold with an empty cache, then warm as the next launch would (a fresh Init)
+		TextureImporterProps props;
+		props.CacheDirectory = (directory / "cache").string();
+		TextureImportSettings settings;
+		settings.Compression = TextureCompression::Auto;
+
+		std::vector<TextureData> cold(sources.size());
+		uint64_t outputBytes = 0;
+		auto importAll = [&](bool keep)
+		{
+			TextureImporter::Init(props);
+			uint32_t callbacks = 0;
+			for (size_t i = 0; i < sources.size(); i++)
+			{
+				TextureImporter::Import(sources[i].Path, settings, [&, i, keep](TextureImportResult& result)
+				{
+					callbacks++;
+					if (result.Status == TextureImportStatus::Failed)
+					{
+						errors++;
+						return;
+					}
+					if (keep)
+						cold[i] = std::move(result.Texture);
+				});
+			}
+			TextureImporter::Flush();
+			errors += callbacks != sources.size();
+		};
+
+		uint64_t sourceBytes = 0;
+		for (const TextureSource& source : sources)
+			sourceBytes += source.FileBytes;
+
+		double coldMs = context.Measure([&]()
+		{
+			fs::remove_all(directory / "cache");
+			importAll(true);
+		}, 3);
+		TextureImporterStats coldStats = TextureImporter::GetStats();
+		for (const TextureData& texture : cold)
+			outputBytes += texture.Data.GetSize();
+		context.Report(fmt::format("cold import of {} textures, {:.1f} MB", sources.size(), ToMB(sourceBytes)), coldMs,
+			fmt::format("decode {:.0f} ms, mips {:.0f} ms, encode {:.0f} ms, {:.1f} MB cached", coldStats.DecodeMs, coldStats.MipMs, coldStats.EncodeMs, ToMB(coldStats.CacheBytesWritten)));
+		errors += coldStats.Imported != sources.size() || coldStats.CacheHits != 0;
+
+		uint32_t mismatches = 0;
+		double warmMs = context.Measure([&]()
+		{
+			mismatches = 0;
+			TextureImporter::Init(props);
+			for (size_t i = 0; i < sources.size(); i++)
+			{
+				TextureImporter::Import(sources[i].Path, settings, [&, i](TextureImportResult& result)
+				{
+					const TextureData& texture = result.Texture, &expected = cold[i];
+					bool same = result.Status == TextureImportStatus::Cached && texture.Format == expected.Format
+						&& texture.Mips.size() == expected.Mips.size() && texture.Data.GetSize() == expected.Data.GetSize()
+						&& std::memcmp(texture.Data.GetData(), expected.Data.GetData(), expected.Data.GetSize()) == 0;
+					for (size_t level = 0; same && level < texture.Mips.size(); level++)
+						same = std::memcmp(&texture.Mips[level], &expected.Mips[level], sizeof(TextureMip)) == 0;
+					mismatches += !same;
+				});
+			}
+			TextureImporter::Flush();
+		}, 5);
+		TextureImporterStats warmStats = TextureImporter::GetStats();
+		context.Report("warm import, every texture from the cache", warmMs,
+			fmt::format("{:.1f}x, {:.0f} MB/s of mips", coldMs / warmMs, ToMB(outputBytes) / (warmMs / 1000.0)));
+		if (mismatches || warmStats.CacheHits != sources.size() || warmStats.Imported != 0)
+		{
+			context.Fail("TextureImport: {} cache hits differ from the cold import, {} of {} hit", mismatches, warmStats.CacheHits, sources.size());
+			errors++;
+		}
+
+		// A damaged entry is a miss: imported again and rewritten
+		{
+			TextureData texture;
+			uint64_t key = 0;
+			{
+				std::ifstream stream(sources[0].Path, std::ios::binary);
+				std::vector<uint8_t> file((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+				key = TextureImporter::GetCacheKey(file.data(), file.size(), settings);
+			}
+			fs::path entry = directory / "cache" / fmt::format("{:016x}.rtex", key);
+			std::error_code error;
+			fs::resize_file(entry, fs::file_size(entry, error) / 2, error);
+			RE_CORE_INFO("  importing over a truncated cache entry, one warning expected:");
+			TextureImporter::Init(props);
+			errors += TextureImporter::ImportNow(sources[0].Path, settings, texture) != TextureImportStatus::Imported;
+			errors += TextureImporter::ImportNow(sources[0].Path, settings, texture) != TextureImportStatus::Cached;
+			errors += texture.Data.GetSize() != cold[0].Data.GetSize() || std::memcmp(texture.Data.GetData(), cold[0].Data.GetData(), cold[0].Data.GetSize()) != 0;
+
+			// Other settings are another entry
+			TextureImportSettings linear = settings;
+			linear.SRGB = false;
+			errors += TextureImporter::ImportNow(sources[0].Path, linear, texture) != TextureImportStatus::Imported;
+			errors += texture.Format != TextureFormat::BC3;
+		}
+
+		if (errors)
+			context.Fail("TextureImport: {} checks failed", errors);
+
+		cold.clear();
+		TextureImporter::Init();
+		fs::remove_all(directory);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,218 @@
+#include "RockBench/Benchmark.h"
+
+#include "RockEngine/Core/JobSystem.h"
+#include "RockEngine/Scene/TransformHierarchy.h"
+
+namespace RockEngine
+{
+	static constexpr uint32_t s_NodeCount = 131072;
+
+	// What code without the subsystem does: a tree of heap nodes, every world matrix recomputed
+	// recursively every frame
+	struct NaiveNode
+	{
+		Vec3 Translation;
+		Quat Rotation;
+		Vec3 Scale = Vec3(1.0f);
+		Mat4 World;
+		std::vector<NaiveNode*> Children;
+
+		void Update(const Mat4& parentWorld)
+		{
+			World = parentWorld * Mat4::TRS(Translation, Rotation, Scale);
+			for (NaiveNode* child : Children)
+				child->Update(World);
+		}
+	};
+
+	struct TransformTestScene
+	{
+		TransformHierarchy Hierarchy;
+		std::vector<TransformNode> Nodes;
+		std::vector<std::unique_ptr<NaiveNode>> NaiveNodes;
+		std::vector<NaiveNode*> NaiveRoots;
+		uint32_t State = 3;
+
+		float Random(float low, float high)
+		{
+			State = State * 1664525u + 1013904223u;
+			return low + (high - low) * (float)(State >> 8) / (float)(1u << 24);
+		}
+
+		// A wide forest like a level: 64 roots, 0 to 4 children per node, breadth first
+		TransformTestScene()
+		{
+			std::vector<uint32_t> parents;
+			for (uint32_t i = 0; i < 64; i++)
+				parents.push_back(~0u);
+			for (uint32_t parent = 0; parents.size() < s_NodeCount; parent++)
+			{
+				uint32_t children = (uint32_t)Random(0.0f, 5.0f);
+				for (uint32_t c = 0; c < children && parents.size() < s_NodeCount; c++)
+					parents.push_back(parent);
+			}
+
+			for (uint32_t i = 0; i < s_NodeCount; i++)
+			{
+				bool root = parents[i] == ~0u;
+				Nodes.push_back(Hierarchy.Create(root ? TransformNode() : Nodes[parents[i]]));
+				NaiveNodes.push_back(std::make_unique<NaiveNode>());
+				if (root)
+					NaiveRoots.push_back(NaiveNodes.back().get());
+				else
+					NaiveNodes[parents[i]]->Children.push_back(NaiveNodes.back().get());
+				Randomize(i);
+			}
+		}
+
+		void Randomize(uint32_t i)
+		{
+			Vec3 translation(Random(-10.0f, 10.0f), Random(-10.0f, 10.0f), Random(-10.0f, 10.0f));
+			Quat rotation = Quat::FromAxisAngle(Normalize(Vec3(Random(-1.0f, 1.0f), 1.0f, Random(-1.0f, 1.0f))), Random(-1.0f, 1.0f));
+			Vec3 scale(Random(0.9f, 1.1f));
+			Hierarchy.SetLocal(Nodes[i], translation, rotation, scale);
+
+			NaiveNode& naive = *NaiveNodes[i];
+			naive.Translation = translation;
+			naive.Rotation = rotation;
+			naive.Scale = scale;
+		}
+
+		void UpdateNaive()
+		{
+			for (NaiveNode* root : NaiveRoots)
+				root->Update(Mat4::Identity());
+		}
+
+		// Largest difference to the naive world matrices, relative to the translation scale
+		float Error()
+		{
+			float error = 0.0f;
+			for (uint32_t i = 0; i < s_NodeCount; i++)
+			{
+				if (!Hierarchy.IsAlive(Nodes[i]))
+					continue;
+				const float* a = Hierarchy.GetWorld(Nodes[i]).Data();
+				const float* b = NaiveNodes[i]->World.Data();
+				for (uint32_t k = 0; k < 16; k++)
+					error = std::max(error, std::abs(a[k] - b[k]) / std::max(1.0f, std::abs(b[k])));
+			}
+			return error;
+		}
+	};
+
+	RE_BENCHMARK(TransformHierarchyUpdate)
+	{
+		TransformTestScene scene;
+		scene.Hierarchy.Update();
+		scene.UpdateNaive();
+		const TransformHierarchyStats& stats = scene.Hierarchy.GetStats();
+		RE_CORE_INFO("  {} nodes in {} levels, {} workers", stats.Nodes, stats.Levels, JobSystem::GetWorkerCount());
+
+		auto check = [&](const char* what)
+		{
+			scene.UpdateNaive();
+			float error = scene.Error();
+			if (error > 1e-4f)
+				context.Fail("TransformHierarchyUpdate: {} is off the naive update by {}", what, error);
+		};
+		check("initial update");
+
+		double naiveMs = context.Measure([&]() { scene.UpdateNaive(); });
+		context.Report("131k nodes, naive recursive update", naiveMs);
+
+		double fullMs = context.Measure([&]()
+		{
+			for (uint32_t i = 0; i < s_NodeCount; i++)
+				scene.Hierarchy.SetTranslation(scene.Nodes[i], scene.Hierarchy.GetTranslation(scene.Nodes[i]));
+			scene.Hierarchy.Update();
+		});
+		context.Report("every local changed", fullMs, fmt::format("{:.1f}x", naiveMs / fullMs));
+		check("full update");
+
+		double rootsMs = context.Measure([&]()
+		{
+			for (uint32_t i = 0; i < 64; i++)
+				scene.Randomize(i);
+			scene.Hierarchy.Update();
+		});
+		context.Report("roots moved (every world matrix)", rootsMs, fmt::format("{:.1f}x", naiveMs / rootsMs));
+		check("root update");
+
+		for (uint32_t percentage : { 1u, 0u })
+		{
+			uint32_t dirty = percentage ? s_NodeCount / 100 : 10;
+			uint32_t updated = 0;
+			double sparseMs = context.Measure([&]()
+			{
+				for (uint32_t i = 0; i < dirty; i++)
+					scene.Randomize(64 + (uint32_t)scene.Random(0.0f, (float)(s_NodeCount - 64)));
+				scene.Hierarchy.Update();
+				updated = stats.UpdatedNodes;
+			});
+			context.Report(fmt::format("{} random locals changed ({} recomputed)", dirty, updated), sparseMs, fmt::format("{:.1f}x", naiveMs / sparseMs));
+			check("sparse update");
+		}
+
+		double idleMs = context.Measure([&]() { scene.Hierarchy.Update(); });
+		context.Report("nothing changed", idleMs, fmt::format("{:.0f}x", naiveMs / idleMs));
+	}
+
+	RE_BENCHMARK(TransformHierarchyStructure)
+	{
+		TransformTestScene scene;
+		scene.Hierarchy.Update();
+
+		// Reparenting moves whole subtrees to other levels
+		uint32_t reparented = 0;
+		for (uint32_t i = 1000; i < 2000; i++)
+		{
+			uint32_t parent = (uint32_t)scene.Random(0.0f, (float)s_NodeCount);
+			if (!scene.Hierarchy.SetParent(scene.Nodes[i], scene.Nodes[parent]))
+				continue;
+
+			NaiveNode* node = scene.NaiveNodes[i].get();
+			for (auto& candidate : scene.NaiveNodes)
+			{
+				auto& children = candidate->Children;
+				children.erase(std::remove(children.begin(), children.end(), node), children.end());
+			}
+			scene.NaiveRoots.erase(std::remove(scene.NaiveRoots.begin(), scene.NaiveRoots.end(), node), scene.NaiveRoots.end());
+			scene.NaiveNodes[parent]->Children.push_back(node);
+			reparented++;
+		}
+
+		// Only the first Update after the changes sorts, so this is timed once
+		auto start = std::chrono::steady_clock::now();
+		scene.Hierarchy.Update();
+		double rebuildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		context.Report(fmt::format("{} reparented, sort + update", reparented), rebuildMs, fmt::format("{} levels", scene.Hierarchy.GetStats().Levels));
+
+		// Random reparenting makes long chains, rounding differences grow with the depth
+		scene.UpdateNaive();
+		float error = scene.Error();
+		if (error > std::max(1e-4f, 1e-6f * scene.Hierarchy.GetStats().Levels))
+			context.Fail("TransformHierarchyStructure: reparented update is off by {}", error);
+
+		// Cycles are refused
+		TransformNode child = scene.Hierarchy.Create(scene.Nodes[0]);
+		if (scene.Hierarchy.SetParent(scene.Nodes[0], child) || scene.Hierarchy.SetParent(child, child))
+			context.Fail("TransformHierarchyStructure: SetParent accepted a cycle");
+
+		// Destroying a root takes its subtree along on the next update
+		TransformNode grandchild = scene.Hierarchy.Create(child);
+		scene.Hierarchy.Destroy(scene.Nodes[0]);
+		scene.Hierarchy.Update();
+		if (scene.Hierarchy.IsAlive(child) || scene.Hierarchy.IsAlive(grandchild) || scene.Hierarchy.GetStats().Nodes >= s_NodeCount)
+			context.Fail("TransformHierarchyStructure: destroyed subtree survived, {} nodes left", scene.Hierarchy.GetStats().Nodes);
+
+		double createMs = context.Measure([&]()
+		{
+			TransformNode parent = scene.Nodes[1];
+			for (uint32_t i = 0; i < 1000; i++)
+				scene.Hierarchy.Create(parent);
+			scene.Hierarchy.Update();
+		});
+		context.Report("1000 nodes created, sort + update", createMs);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "TheRock.h"
+#include "Benchmark.h"
+
+// Runs every registered benchmark (or those whose name contains one of the
+// command line filters) from a layer of a headless application, then exits.
+class BenchmarkLayer : public RockEngine::Layer
+{
+public:
+	BenchmarkLayer(const std::vector<std::string>& filters)
+		: Layer("BenchmarkLayer"), m_Filters(filters) {}
+
+	void OnUpdate(RockEngine::Timestep /*ts*/) override
+	{
+		RockEngine::BenchmarkContext context;
+		for (const RockEngine::Benchmark& benchmark : RockEngine::BenchmarkRegistry::Get())
+		{
+			if (!m_Filters.empty() && std::none_of(m_Filters.begin(), m_Filters.end(),
+				[&](const std::string& filter) { return std::string(benchmark.Name).find(filter) != std::string::npos; }))
+				continue;
+
+			RE_CORE_INFO("[{}]", benchmark.Name);
+			benchmark.Function(context);
+		}
+
+		m_Failures = context.GetFailureCount();
+		if (m_Failures > 0)
+		{
+			RE_CORE_ERROR("RockBench: {} checks failed", m_Failures);
+			RockEngine::Application::Get().SetExitCode(1);
+		}
+
+		RockEngine::Application::Get().Close();
+	}
+
+	uint32_t GetFailureCount() const { return m_Failures; }
+private:
+	std::vector<std::string> m_Filters;
+	uint32_t m_Failures = 0;
+};
+
+class RockBench : public RockEngine::Application
+{
+public:
+	RockBench(const RockEngine::ApplicationProps& props, const std::vector<std::string>& filters)
+		: RockEngine::Application(props), m_Filters(filters)
+	{}
+
+	void OnInit() override
+	{
+		PushLayer(new BenchmarkLayer(m_Filters));
+	}
+private:
+	std::vector<std::string> m_Filters;
+};
+
+RockEngine::Application* RockEngine::CreateApplication(RockEngine::ApplicationCommandLineArgs args)
+{
+	RockEngine::ApplicationProps props;
+	props.WindowHeight = 720;
+	props.WindowWidth = 1280;
+	props.Name = "RockBench";
+	props.Window = RockEngine::WindowType::Headless;
+	props.Renderer = RockEngine::RendererAPIType::Null;
+
+	std::vector<std::string> filters;
+	for (int i = 1; i < args.Count; i++)
+		filters.push_back(args[i]);
+
+	return new RockBench(props, filters);
+}
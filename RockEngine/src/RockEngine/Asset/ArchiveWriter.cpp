@@ -0,0 +1,174 @@
+#include "pch.h"
+#include "ArchiveWriter.h"
+
+#include <fstream>
+#include <iterator>
+
+#include "RockEngine/Core/JobSystem.h"
+#include "RockEngine/Memory/LinearAllocator.h"
+#include "RockEngine/Memory/MemoryTracker.h"
+
+namespace RockEngine
+{
+	ArchiveWriter::ArchiveWriter(const ArchiveWriterProps& props /* = ArchiveWriterProps() */)
+		: m_Props(props)
+	{
+		RE_CORE_ASSERT(props.Alignment && (props.Alignment & (props.Alignment - 1)) == 0, "Archive alignment has to be a power of two");
+	}
+
+	bool ArchiveWriter::Add(std::string_view name, const void* data, size_t size)
+	{
+		RE_MEMORY_SCOPE("Assets");
+
+		std::string normalized(name);
+		std::replace(normalized.begin(), normalized.end(), '\\', '/');
+		if (normalized.empty() || normalized.size() > UINT16_MAX)
+		{
+			RE_CORE_ERROR("ArchiveWriter: invalid asset name '{}'", normalized);
+			return false;
+		}
+		if (!m_Names.insert(normalized).second)
+		{
+			RE_CORE_ERROR("ArchiveWriter: {} was added twice", normalized);
+			return false;
+		}
+
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		m_Assets.push_back({ std::move(normalized), std::vector<uint8_t>(bytes, bytes + size), {} });
+		return true;
+	}
+
+	bool ArchiveWriter::AddFile(std::string_view name, const std::string& path)
+	{
+		std::ifstream stream(path, std::ios::binary);
+		if (!stream)
+		{
+			RE_CORE_ERROR("ArchiveWriter: can't read {}", path);
+			return false;
+		}
+
+		std::vector<uint8_t> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		return Add(name, data.data(), data.size());
+	}
+
+	bool ArchiveWriter::Write(const std::string& path)
+	{
+		RE_PROFILE_FUNC();
+		RE_MEMORY_SCOPE("Assets");
+
+		m_Stats = {};
+		m_Stats.Assets = (uint32_t)m_Assets.size();
+
+		if (m_Props.Compress)
+		{
+			JobSystem::ParallelFor((uint32_t)m_Assets.size(), 1, [this](uint32_t begin, uint32_t end)
+			{
+				for (uint32_t i = begin; i < end; i++)
+				{
+					Asset& asset = m_Assets[i];
+					asset.Stored.resize(Compression::GetBound(asset.Data.size()));
+					size_t size = Compression::CompressLZ4(asset.Data.data(), asset.Data.size(), asset.Stored.data(), asset.Stored.size());
+					if (size == 0 || (float)size > (float)asset.Data.size() * (1.0f - m_Props.MinSavings))
+						size = 0;
+					asset.Stored.resize(size);
+					asset.Stored.shrink_to_fit();
+				}
+			});
+		}
+
+		// Load factor of at most a half keeps probe sequences short
+		uint32_t slotCount = 1;
+		while (slotCount < std::max<uint32_t>((uint32_t)m_Assets.size() * 2, 2))
+			slotCount <<= 1;
+
+		std::vector<ArchiveEntry> entries(m_Assets.size());
+		std::vector<uint32_t> slots(slotCount, ~0u);
+		std::string names;
+
+		for (uint32_t i = 0; i < (uint32_t)m_Assets.size(); i++)
+		{
+			ArchiveEntry& entry = entries[i];
+			entry.Hash = AssetArchive::Hash(m_Assets[i].Name);
+			entry.NameOffset = (uint32_t)names.size();
+			entry.NameLength = (uint16_t)m_Assets[i].Name.size();
+			names += m_Assets[i].Name;
+
+			uint32_t slot = (uint32_t)entry.Hash & (slotCount - 1);
+			while (slots[slot] != ~0u)
+				slot = (slot + 1) & (slotCount - 1);
+			slots[slot] = i;
+		}
+
+		if (names.size() > UINT32_MAX)
+		{
+			RE_CORE_ERROR("ArchiveWriter: asset names exceed 4 GB");
+			return false;
+		}
+
+		uint64_t tablesEnd = sizeof(ArchiveHeader) + entries.size() * sizeof(ArchiveEntry) + slots.size() * sizeof(uint32_t) + names.size();
+		uint64_t offset = tablesEnd;
+		for (uint32_t i = 0; i < (uint32_t)m_Assets.size(); i++)
+		{
+			const Asset& asset = m_Assets[i];
+			ArchiveEntry& entry = entries[i];
+			bool compressed = !asset.Stored.empty();
+
+			offset = AlignUp(offset, m_Props.Alignment);
+			entry.Offset = offset;
+			entry.Size = asset.Data.size();
+			entry.StoredSize = compressed ? asset.Stored.size() : asset.Data.size();
+			entry.Compression = compressed ? CompressionType::LZ4 : CompressionType::None;
+			offset += entry.StoredSize;
+
+			m_Stats.Compressed += compressed ? 1 : 0;
+			m_Stats.InputBytes += entry.Size;
+		}
+
+		ArchiveHeader header = {};
+		header.Magic = ArchiveHeader::MagicValue;
+		header.Version = ArchiveHeader::CurrentVersion;
+		header.EntryCount = (uint32_t)entries.size();
+		header.SlotCount = slotCount;
+		header.Alignment = m_Props.Alignment;
+		header.NamesSize = (uint32_t)names.size();
+		header.FileSize = offset;
+
+		std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+		if (!stream)
+		{
+			RE_CORE_ERROR("ArchiveWriter: can't create {}", path);
+			return false;
+		}
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		stream.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(ArchiveEntry));
+		stream.write(reinterpret_cast<const char*>(slots.data()), slots.size() * sizeof(uint32_t));
+		stream.write(names.data(), names.size());
+
+		static const char s_Padding[256] = {};
+		uint64_t written = tablesEnd;
+		for (uint32_t i = 0; i < (uint32_t)m_Assets.size(); i++)
+		{
+			const Asset& asset = m_Assets[i];
+			for (uint64_t padding = entries[i].Offset - written; padding > 0;)
+			{
+				uint64_t chunk = std::min<uint64_t>(padding, sizeof(s_Padding));
+				stream.write(s_Padding, chunk);
+				padding -= chunk;
+			}
+
+			const std::vector<uint8_t>& blob = asset.Stored.empty() ? asset.Data : asset.Stored;
+			stream.write(reinterpret_cast<const char*>(blob.data()), blob.size());
+			written = entries[i].Offset + blob.size();
+		}
+
+		if (!stream)
+		{
+			RE_CORE_ERROR("ArchiveWriter: writing {} failed", path);
+			return false;
+		}
+
+		m_Stats.FileBytes = offset;
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "RockEngine/Asset/AssetArchive.h"
+
+namespace RockEngine
+{
+	struct ArchiveWriterProps
+	{
+		// Blob alignment, a power of two. 16 keeps SIMD loads from uncompressed assets aligned.
+		uint32_t Alignment = 16;
+		bool Compress = true;
+		// Assets are only stored compressed if that saves at least this fraction of their size,
+		// otherwise zero copy loads are worth more than the space
+		float MinSavings = 0.125f;
+	};
+
+	struct ArchiveWriterStats
+	{
+		uint32_t Assets;
+		uint32_t Compressed;
+		uint64_t InputBytes;
+		uint64_t FileBytes;
+	};
+
+	// Builds an AssetArchive file. Assets are kept in memory until Write, which compresses them
+	// on the job system.
+	class ArchiveWriter
+	{
+	public:
+		explicit ArchiveWriter(const ArchiveWriterProps& props = ArchiveWriterProps());
+
+		// False if the name is taken
+		bool Add(std::string_view name, const void* data, size_t size);
+		bool AddFile(std::string_view name, const std::string& path);
+
+		bool Write(const std::string& path);
+
+		inline uint32_t GetAssetCount() const { return (uint32_t)m_Assets.size(); }
+		inline const ArchiveWriterStats& GetStats() const { return m_Stats; }
+	private:
+		struct Asset
+		{
+			std::string Name;
+			std::vector<uint8_t> Data;
+			std::vector<uint8_t> Stored;	// compressed, empty if it's stored as is
+		};
+	private:
+		ArchiveWriterProps m_Props;
+		std::vector<Asset> m_Assets;
+		std::unordered_set<std::string> m_Names;
+		ArchiveWriterStats m_Stats = {};
+	};
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "pch.h"
+#include "AssetArchive.h"
+
+#include <cstring>
+
+namespace RockEngine
+{
+	static inline char NormalizeSeparator(char c)
+	{
+		return c == '\\' ? '/' : c;
+	}
+
+	uint64_t AssetArchive::Hash(std::string_view name)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for (char c : name)
+		{
+			hash ^= (uint8_t)NormalizeSeparator(c);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	bool AssetArchive::Open(const std::string& path)
+	{
+		RE_PROFILE_FUNC();
+		Close();
+
+		if (!m_File.Open(path))
+			return false;
+
+		const uint8_t* data = m_File.GetData();
+		m_Header = reinterpret_cast<const ArchiveHeader*>(data);
+		size_t tablesOffset = sizeof(ArchiveHeader);
+		if (m_File.GetSize() >= tablesOffset)
+		{
+			m_Entries = reinterpret_cast<const ArchiveEntry*>(data + tablesOffset);
+			m_Slots = reinterpret_cast<const uint32_t*>(m_Entries + m_Header->EntryCount);
+			m_Names = reinterpret_cast<const char*>(m_Slots + m_Header->SlotCount);
+		}
+
+		if (!Validate())
+		{
+			RE_CORE_ERROR("AssetArchive: {} is not a valid version {} archive", path, ArchiveHeader::CurrentVersion);
+			Close();
+			return false;
+		}
+
+		m_Path = path;
+		RE_CORE_INFO("AssetArchive: {} ({} assets, {} KB)", path, m_Header->EntryCount, m_File.GetSize() / 1024);
+		return true;
+	}
+
+	void AssetArchive::Close()
+	{
+		m_File.Close();
+		m_Path.clear();
+		m_Header = nullptr;
+		m_Entries = nullptr;
+		m_Slots = nullptr;
+		m_Names = nullptr;
+	}
+
+	// Everything Find, GetView and Read rely on, so a truncated or foreign file fails here
+	// instead of faulting later
+	bool AssetArchive::Validate() const
+	{
+		size_t fileSize = m_File.GetSize();
+		if (fileSize < sizeof(ArchiveHeader))
+			return false;
+
+		const ArchiveHeader& header = *m_Header;
+		if (header.Magic != ArchiveHeader::MagicValue || header.Version != ArchiveHeader::CurrentVersion || header.FileSize != fileSize)
+			return false;
+		if (header.SlotCount == 0 || (header.SlotCount & (header.SlotCount - 1)) || header.SlotCount <= header.EntryCount)
+			return false;
+
+		uint64_t namesEnd = sizeof(ArchiveHeader) + (uint64_t)header.EntryCount * sizeof(ArchiveEntry)
+			+ (uint64_t)header.SlotCount * sizeof(uint32_t) + header.NamesSize;
+		if (namesEnd > fileSize)
+			return false;
+
+		for (uint32_t i = 0; i < header.EntryCount; i++)
+		{
+			const ArchiveEntry& entry = m_Entries[i];
+			if (entry.Offset < namesEnd || entry.Offset > fileSize || entry.StoredSize > fileSize - entry.Offset)
+				return false;
+			if ((uint64_t)entry.NameOffset + entry.NameLength > header.NamesSize)
+				return false;
+			if (entry.Compression == CompressionType::None ? entry.StoredSize != entry.Size : entry.Compression != CompressionType::LZ4)
+				return false;
+			// Readers allocate Size up front
+			if (entry.Compression == CompressionType::LZ4 && entry.Size > entry.StoredSize * Compression::MaxLZ4Ratio)
+				return false;
+		}
+		for (uint32_t i = 0; i < header.SlotCount; i++)
+		{
+			if (m_Slots[i] != ~0u && m_Slots[i] >= header.EntryCount)
+				return false;
+		}
+		return true;
+	}
+
+	const ArchiveEntry* AssetArchive::Find(std::string_view name) const
+	{
+		if (!m_Header)
+			return nullptr;
+
+		uint64_t hash = Hash(name);
+		uint32_t mask = m_Header->SlotCount - 1;
+		// The table is never full, so probing always reaches an empty slot
+		for (uint32_t slot = (uint32_t)hash & mask;; slot = (slot + 1) & mask)
+		{
+			uint32_t index = m_Slots[slot];
+			if (index == ~0u)
+				return nullptr;
+
+			const ArchiveEntry& entry = m_Entries[index];
+			if (entry.Hash != hash || entry.NameLength != name.size())
+				continue;
+
+			std::string_view stored = GetName(entry);
+			if (std::equal(stored.begin(), stored.end(), name.begin(), [](char a, char b) { return a == NormalizeSeparator(b); }))
+				return &entry;
+		}
+	}
+
+	std::string_view AssetArchive::GetName(const ArchiveEntry& entry) const
+	{
+		return std::string_view(m_Names + entry.NameOffset, entry.NameLength);
+	}
+
+	AssetView AssetArchive::GetView(const ArchiveEntry& entry) const
+	{
+		return { m_File.GetData() + entry.Offset, (size_t)entry.StoredSize, entry.Compression };
+	}
+
+	bool AssetArchive::Read(const ArchiveEntry& entry, void* destination) const
+	{
+		AssetView view = GetView(entry);
+		if (view.Compression == CompressionType::None)
+		{
+			std::memcpy(destination, view.Data, view.Size);
+			return true;
+		}
+
+		if (!Compression::DecompressLZ4(view.Data, view.Size, destination, (size_t)entry.Size))
+		{
+			RE_CORE_ERROR("AssetArchive: {} in {} is corrupt", GetName(entry), m_Path);
+			return false;
+		}
+		return true;
+	}
+
+	void AssetArchive::Prefetch(const ArchiveEntry& entry) const
+	{
+		m_File.Prefetch((size_t)entry.Offset, (size_t)entry.StoredSize);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "RockEngine/Asset/Compression.h"
+#include "RockEngine/Asset/MappedFile.h"
+
+namespace RockEngine
+{
+	// Archive layout, all little endian:
+	//   ArchiveHeader
+	//   ArchiveEntry[EntryCount]
+	//   uint32_t slots[SlotCount]	open addressing table of entry indices by name hash, ~0 empty
+	//   names					entry names back to back, not terminated
+	//   blobs					each aligned to ArchiveHeader::Alignment
+	struct ArchiveHeader
+	{
+		static constexpr uint32_t MagicValue = 0x4B415052;	// "RPAK"
+		static constexpr uint32_t CurrentVersion = 1;
+
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t EntryCount;
+		uint32_t SlotCount;		// power of two
+		uint32_t Alignment;
+		uint32_t NamesSize;
+		uint64_t FileSize;
+	};
+
+	struct ArchiveEntry
+	{
+		uint64_t Hash;				// AssetArchive::Hash of the name
+		uint64_t Offset;			// of the blob, from the start of the file
+		uint64_t StoredSize;
+		uint64_t Size;				// uncompressed
+		uint32_t NameOffset;		// into the names
+		uint16_t NameLength;
+		CompressionType Compression;
+		uint8_t Reserved;
+	};
+
+	static_assert(sizeof(ArchiveHeader) == 32, "ArchiveHeader is read straight from the file");
+	static_assert(sizeof(ArchiveEntry) == 40, "ArchiveEntry is read straight from the file");
+
+	// The bytes of an asset as stored in the archive. Points into the mapping, no copy.
+	struct AssetView
+	{
+		const uint8_t* Data = nullptr;
+		size_t Size = 0;
+		CompressionType Compression = CompressionType::None;
+	};
+
+	// A packed archive (see ArchiveWriter and the RockPack tool) mapped into memory. Lookups hash
+	// the name and probe the table in place, nothing is parsed or copied when opening.
+	// Everything is const and safe to call from several threads once it's open.
+	class AssetArchive
+	{
+	public:
+		AssetArchive() = default;
+
+		bool Open(const std::string& path);
+		void Close();
+
+		inline bool IsOpen() const { return m_File.IsOpen(); }
+		inline const std::string& GetPath() const { return m_Path; }
+		inline uint32_t GetAssetCount() const { return m_Header ? m_Header->EntryCount : 0; }
+		inline const ArchiveEntry& GetEntry(uint32_t index) const { return m_Entries[index]; }
+
+		// Null if there's no such asset
+		const ArchiveEntry* Find(std::string_view name) const;
+		std::string_view GetName(const ArchiveEntry& entry) const;
+
+		// Uncompressed assets can be used from here directly, for as long as the archive is open
+		AssetView GetView(const ArchiveEntry& entry) const;
+		// Decompresses (or copies) the asset into `destination`, which holds entry.Size bytes
+		bool Read(const ArchiveEntry& entry, void* destination) const;
+		void Prefetch(const ArchiveEntry& entry) const;
+
+		// FNV-1a of the name with backslashes as slashes, so "a\b.png" and "a/b.png" are one asset
+		static uint64_t Hash(std::string_view name);
+	private:
+		bool Validate() const;
+	private:
+		std::string m_Path;
+		MappedFile m_File;
+		const ArchiveHeader* m_Header = nullptr;
+		const ArchiveEntry* m_Entries = nullptr;
+		const uint32_t* m_Slots = nullptr;
+		const char* m_Names = nullptr;
+	};
+}
\ No newline at end of file
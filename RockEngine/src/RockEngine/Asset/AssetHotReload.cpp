@@ -0,0 +1,332 @@
+#include "pch.h"
+#include "AssetHotReload.h"
+
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "RockEngine/Core/JobSystem.h"
+#include "RockEngine/Memory/MemoryTracker.h"
+
+namespace RockEngine
+{
+	namespace fs = std::filesystem;
+
+	struct HotAsset
+	{
+		std::string Name;
+		std::string Source;
+		AssetProcessor Processor;
+		AssetReloadCallback OnReload;
+		std::vector<std::string> Files;		// source and dependencies, as the graph knows them
+		uint64_t Version = 0;				// of the last processing started
+	};
+
+	struct ReloadBatch;
+
+	struct ReloadJob
+	{
+		ReloadJob(std::shared_ptr<HotAsset> asset, uint64_t version, ReloadBatch* batch)
+			: Asset(std::move(asset)), Version(version), Batch(batch) {}
+
+		std::shared_ptr<HotAsset> Asset;
+		uint64_t Version;
+		ReloadBatch* Batch;
+
+		// Written by the job
+		bool Success = false;
+		AssetData Data;
+		std::vector<std::string> Files;
+		float ProcessMs = 0.0f;
+	};
+
+	// One change batch (or a Register), swapped in as a whole
+	struct ReloadBatch
+	{
+		uint64_t FirstEventTime;
+		bool Initial;
+		std::vector<std::unique_ptr<ReloadJob>> Jobs;
+		std::atomic<uint32_t> Pending{ 0 };
+	};
+
+	// Everything but the jobs themselves lives on the main thread
+	static std::unique_ptr<FileWatcher> s_Watcher;
+	static std::unordered_map<std::string, std::shared_ptr<HotAsset>> s_Assets;
+	static std::unordered_map<std::string, std::unordered_set<std::string>> s_Dependents;	// file to the assets reading it
+	static std::deque<std::unique_ptr<ReloadBatch>> s_Batches;
+	static AssetHotReloadStats s_Stats;
+	static JobCounter s_Jobs;
+
+	static void Process(ReloadJob& job)
+	{
+		RE_PROFILE_SCOPE("AssetHotReload::Process");
+		RE_MEMORY_SCOPE("Assets");
+
+		uint64_t start = Profiler::Now();
+		const HotAsset& asset = *job.Asset;
+		std::vector<uint8_t> output;
+		std::vector<std::string> dependencies;
+		job.Success = asset.Processor(asset.Source, output, dependencies);
+
+		if (job.Success)
+		{
+			std::unique_ptr<uint8_t[]> buffer = std::make_unique<uint8_t[]>(output.size());
+			std::memcpy(buffer.get(), output.data(), output.size());
+			job.Data = AssetData(std::move(buffer), output.size());
+		}
+
+		// Paths as the watcher reports them, resolved here rather than on the main thread
+		job.Files.push_back(FileWatcher::NormalizePath(asset.Source));
+		for (const std::string& dependency : dependencies)
+			job.Files.push_back(FileWatcher::NormalizePath(dependency));
+		std::sort(job.Files.begin() + 1, job.Files.end());
+		job.Files.erase(std::unique(job.Files.begin() + 1, job.Files.end()), job.Files.end());
+
+		job.ProcessMs = (float)((Profiler::Now() - start) / 1e6);
+		job.Batch->Pending.fetch_sub(1, std::memory_order_release);
+	}
+
+	static void Schedule(const std::vector<std::shared_ptr<HotAsset>>& assets, uint64_t firstEventTime, bool initial)
+	{
+		std::unique_ptr<ReloadBatch> batch = std::make_unique<ReloadBatch>();
+		batch->FirstEventTime = firstEventTime;
+		batch->Initial = initial;
+		for (const std::shared_ptr<HotAsset>& asset : assets)
+			batch->Jobs.push_back(std::make_unique<ReloadJob>(asset, ++asset->Version, batch.get()));
+		batch->Pending = (uint32_t)batch->Jobs.size();
+
+		for (const std::unique_ptr<ReloadJob>& job : batch->Jobs)
+		{
+			// With no other worker the job would only run once the main thread waits for it
+			ReloadJob* pointer = job.get();
+			if (JobSystem::GetWorkerCount() > 1)
+				JobSystem::Run([pointer]() { Process(*pointer); }, &s_Jobs);
+			else
+				Process(*pointer);
+		}
+		s_Batches.push_back(std::move(batch));
+	}
+
+	static void SetFiles(HotAsset& asset, std::vector<std::string> files)
+	{
+		for (const std::string& file : asset.Files)
+		{
+			auto dependents = s_Dependents.find(file);
+			if (dependents == s_Dependents.end())
+				continue;
+			dependents->second.erase(asset.Name);
+			if (dependents->second.empty())
+				s_Dependents.erase(dependents);
+		}
+
+		asset.Files = std::move(files);
+		for (const std::string& file : asset.Files)
+			s_Dependents[file].insert(asset.Name);
+	}
+
+	static void SwapCompleted()
+	{
+		// In order: a later batch may hold a newer version of the same asset
+		while (!s_Batches.empty() && s_Batches.front()->Pending.load(std::memory_order_acquire) == 0)
+		{
+			std::unique_ptr<ReloadBatch> batch = std::move(s_Batches.front());
+			s_Batches.pop_front();
+			float latencyMs = (float)((Profiler::Now() - batch->FirstEventTime) / 1e6);
+
+			for (const std::unique_ptr<ReloadJob>& job : batch->Jobs)
+			{
+				// Unregistered, registered again or already being processed again since
+				HotAsset& asset = *job->Asset;
+				auto registered = s_Assets.find(asset.Name);
+				if (registered == s_Assets.end() || registered->second != job->Asset || job->Version != asset.Version)
+					continue;
+
+				s_Stats.Processed++;
+				if (!job->Success)
+				{
+					// Whatever it read before and now stays watched, fixing any of it retries
+					std::vector<std::string> files = asset.Files;
+					files.insert(files.end(), job->Files.begin(), job->Files.end());
+					std::sort(files.begin(), files.end());
+					files.erase(std::unique(files.begin(), files.end()), files.end());
+					SetFiles(asset, std::move(files));
+
+					s_Stats.Failed++;
+					RE_CORE_ERROR("AssetHotReload: processing {} failed, keeping the previous version", asset.Name);
+					continue;
+				}
+
+				SetFiles(asset, std::move(job->Files));
+				if (asset.OnReload)
+					asset.OnReload(asset.Name, job->Data);
+
+				s_Stats.Reloaded++;
+				s_Stats.LastLatencyMs = latencyMs;
+				if (!batch->Initial)
+					RE_CORE_INFO("AssetHotReload: reloaded {} in {:.1f} ms ({:.2f} ms processing)", asset.Name, latencyMs, job->ProcessMs);
+			}
+		}
+	}
+
+	bool AssetHotReload::Init(const AssetHotReloadProps& props)
+	{
+		Shutdown();
+
+		s_Watcher = std::make_unique<FileWatcher>(props.Watcher);
+		if (!s_Watcher->Start(props.Directory))
+		{
+			s_Watcher.reset();
+			return false;
+		}
+		return true;
+	}
+
+	void AssetHotReload::Shutdown()
+	{
+		if (s_Watcher)
+			s_Watcher->Stop();
+		s_Watcher.reset();
+
+		JobSystem::Wait(s_Jobs);
+		s_Batches.clear();
+		s_Assets.clear();
+		s_Dependents.clear();
+		s_Stats = AssetHotReloadStats();
+	}
+
+	bool AssetHotReload::IsRunning()
+	{
+		return s_Watcher && s_Watcher->IsRunning();
+	}
+
+	void AssetHotReload::Register(std::string_view name, const std::string& source, AssetProcessor processor, AssetReloadCallback onReload)
+	{
+		Unregister(name);
+
+		std::shared_ptr<HotAsset> asset = std::make_shared<HotAsset>();
+		asset->Name = name;
+		asset->Source = source;
+		asset->Processor = std::move(processor);
+		asset->OnReload = std::move(onReload);
+
+		// Until the first processing reports the dependencies, at least the source is watched
+		SetFiles(*asset, { FileWatcher::NormalizePath(source) });
+		s_Assets.emplace(asset->Name, asset);
+		Schedule({ asset }, Profiler::Now(), true);
+	}
+
+	void AssetHotReload::Unregister(std::string_view name)
+	{
+		auto asset = s_Assets.find(std::string(name));
+		if (asset == s_Assets.end())
+			return;
+
+		SetFiles(*asset->second, {});
+		s_Assets.erase(asset);
+	}
+
+	void AssetHotReload::Update()
+	{
+		RE_PROFILE_FUNC();
+
+		FileChangeBatch changes;
+		while (s_Watcher && s_Watcher->PopChanges(changes))
+		{
+			s_Stats.Batches++;
+
+			std::vector<std::shared_ptr<HotAsset>> affected;
+			std::unordered_set<std::string> seen;
+			for (const std::string& path : changes.Paths)
+			{
+				auto dependents = s_Dependents.find(path);
+				if (dependents == s_Dependents.end())
+					continue;
+				for (const std::string& name : dependents->second)
+				{
+					if (seen.insert(name).second)
+						affected.push_back(s_Assets[name]);
+				}
+			}
+
+			if (!affected.empty())
+				Schedule(affected, changes.FirstEventTime, false);
+		}
+
+		SwapCompleted();
+	}
+
+	void AssetHotReload::Flush()
+	{
+		RE_PROFILE_FUNC();
+
+		// Callbacks may register more assets, keep going until nothing is left
+		do
+		{
+			JobSystem::Wait(s_Jobs);
+			Update();
+		} while (!s_Batches.empty());
+	}
+
+	AssetHotReloadStats AssetHotReload::GetStats()
+	{
+		AssetHotReloadStats stats = s_Stats;
+		stats.Assets = (uint32_t)s_Assets.size();
+		stats.Files = (uint32_t)s_Dependents.size();
+		return stats;
+	}
+
+	static bool ExpandFile(const fs::path& path, std::string& output, std::vector<std::string>& dependencies, std::vector<fs::path>& stack)
+	{
+		std::ifstream stream(path);
+		if (!stream)
+		{
+			RE_CORE_ERROR("AssetHotReload: can't read {}", path.generic_string());
+			return false;
+		}
+
+		std::string line;
+		while (std::getline(stream, line))
+		{
+			size_t start = line.find_first_not_of(" \t");
+			size_t open = line.find('"');
+			size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+			if (start == std::string::npos || line.compare(start, 8, "#include") != 0 || close == std::string::npos)
+			{
+				output += line;
+				output += '\n';
+				continue;
+			}
+
+			// Reported before reading it: an include that doesn't exist yet reloads once it does
+			fs::path include = (path.parent_path() / line.substr(open + 1, close - open - 1)).lexically_normal();
+			dependencies.push_back(include.generic_string());
+			if (std::find(stack.begin(), stack.end(), include) != stack.end())
+			{
+				RE_CORE_ERROR("AssetHotReload: {} includes itself through {}", include.generic_string(), path.generic_string());
+				return false;
+			}
+
+			stack.push_back(include);
+			bool expanded = ExpandFile(include, output, dependencies, stack);
+			stack.pop_back();
+			if (!expanded)
+				return false;
+		}
+		return true;
+	}
+
+	bool AssetHotReload::ExpandIncludes(const std::string& source, std::vector<uint8_t>& output, std::vector<std::string>& dependencies)
+	{
+		std::string text;
+		std::vector<fs::path> stack = { fs::path(source).lexically_normal() };
+		if (!ExpandFile(stack.front(), text, dependencies, stack))
+			return false;
+
+		output.assign(text.begin(), text.end());
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "RockEngine/Asset/AssetStreamer.h"
+#include "RockEngine/Asset/FileWatcher.h"
+
+namespace RockEngine
+{
+	// Turns an asset's source file into what the engine uses. Every file it read besides the
+	// source (includes, referenced textures) goes into `dependencies`, changing any of them
+	// reprocesses the asset. Runs on a job thread; false keeps the asset as it was.
+	using AssetProcessor = std::function<bool(const std::string& source, std::vector<uint8_t>& output, std::vector<std::string>& dependencies)>;
+	// Runs on the main thread during AssetHotReload::Update, move the data out to keep it
+	using AssetReloadCallback = std::function<void(std::string_view name, AssetData& data)>;
+
+	struct AssetHotReloadProps
+	{
+		std::string Directory;		// watched recursively, sources and dependencies outside it never reload
+		FileWatcherProps Watcher;
+	};
+
+	struct AssetHotReloadStats
+	{
+		uint32_t Assets = 0;
+		uint32_t Files = 0;				// sources and dependencies in the graph
+		uint64_t Batches = 0;			// coalesced change batches seen
+		uint64_t Processed = 0;
+		uint64_t Failed = 0;
+		uint64_t Reloaded = 0;			// swapped in
+		float LastLatencyMs = 0.0f;		// first change event to swap
+	};
+
+	// Reloads assets from their source files while the game runs. A FileWatcher reports changed
+	// files in coalesced batches; Update (called by Application::Run at the start of every
+	// frame) looks up which assets read them in the dependency graph, reprocesses only those on
+	// the job system, and swaps in a batch's results together once all of them are done, so
+	// assets sharing an include never show up half old, half new.
+	class AssetHotReload
+	{
+	public:
+		static bool Init(const AssetHotReloadProps& props);
+		// Waits for running processors, drops results that weren't swapped in
+		static void Shutdown();
+		static bool IsRunning();
+
+		// Processes the asset once right away, its dependencies are known from then on; the
+		// result is handed to `onReload` at the next Update like every reload after it.
+		// Registering a name again replaces it.
+		static void Register(std::string_view name, const std::string& source, AssetProcessor processor, AssetReloadCallback onReload);
+		static void Unregister(std::string_view name);
+
+		static void Update();
+		// Calls Update until nothing is being processed or waiting to be swapped in
+		static void Flush();
+
+		static AssetHotReloadStats GetStats();
+
+		// Processor for text sources: expands `#include "file"` lines (relative to the including
+		// file) recursively and reports every included file as a dependency
+		static bool ExpandIncludes(const std::string& source, std::vector<uint8_t>& output, std::vector<std::string>& dependencies);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "pch.h"
+#include "AssetStreamer.h"
+
+#include <mutex>
+
+#include "RockEngine/Asset/RequestQueue.h"
+#include "RockEngine/Core/JobSystem.h"
+#include "RockEngine/Memory/MemoryTracker.h"
+
+namespace RockEngine
+{
+	static AssetStreamerProps s_Props;
+
+	static std::mutex s_StatsMutex;
+	static uint64_t s_Loaded = 0;
+	static uint64_t s_BytesLoaded = 0;
+
+	static RequestQueue s_Requests;
+
+	class LoadRequest : public QueuedRequest
+	{
+	public:
+		AssetLoadResult Result;
+		AssetLoadCallback Callback;
+
+		void Prefetch() override
+		{
+			Result.Archive->Prefetch(*Result.Entry);
+		}
+
+		void Execute() override
+		{
+			RE_PROFILE_SCOPE("AssetStreamer::Execute");
+			RE_MEMORY_SCOPE("Assets");
+
+			uint64_t start = Profiler::Now();
+			const ArchiveEntry& entry = *Result.Entry;
+			AssetView view = Result.Archive->GetView(entry);
+
+			if (view.Compression == CompressionType::None)
+			{
+				MappedFile::Touch(view.Data, view.Size);
+				Result.Data = AssetData(view.Data, view.Size);
+			}
+			else
+			{
+				std::unique_ptr<uint8_t[]> buffer = std::make_unique<uint8_t[]>((size_t)entry.Size);
+				if (Result.Archive->Read(entry, buffer.get()))
+					Result.Data = AssetData(std::move(buffer), (size_t)entry.Size);
+				else
+					Result.Status = AssetLoadStatus::Corrupt;
+			}
+			Result.LoadMs = (float)((Profiler::Now() - start) / 1e6);
+
+			if (Result.Status == AssetLoadStatus::Loaded)
+			{
+				std::lock_guard<std::mutex> lock(s_StatsMutex);
+				s_Loaded++;
+				s_BytesLoaded += entry.Size;
+			}
+		}
+
+		void Complete(float latencyMs) override
+		{
+			Result.LatencyMs = latencyMs;
+			if (Callback)
+				Callback(Result);
+		}
+	};
+
+	void AssetStreamer::Init(const AssetStreamerProps& props /* = AssetStreamerProps() */)
+	{
+		s_Props = props;
+		s_Loaded = 0;
+		s_BytesLoaded = 0;
+	}
+
+	void AssetStreamer::Shutdown()
+	{
+		s_Requests.Clear();
+	}
+
+	void AssetStreamer::Load(const AssetArchive& archive, std::string_view name, LoadPriority priority, AssetLoadCallback callback)
+	{
+		RE_MEMORY_SCOPE("Assets");
+
+		LoadRequest* request = new LoadRequest();
+		request->Priority = (uint8_t)priority;
+		request->Result.Archive = &archive;
+		request->Result.Entry = archive.Find(name);
+		request->Result.Status = request->Result.Entry ? AssetLoadStatus::Loaded : AssetLoadStatus::NotFound;
+		request->Result.Priority = priority;
+		request->Result.LoadMs = 0.0f;
+		request->Callback = std::move(callback);
+
+		if (!request->Result.Entry)
+		{
+			RE_CORE_WARN("AssetStreamer: {} is not in {}", name, archive.GetPath());
+			s_Requests.PushCompleted(request);
+			return;
+		}
+		s_Requests.Push(request);
+	}
+
+	void AssetStreamer::Update()
+	{
+		RE_PROFILE_FUNC();
+		s_Requests.Update(s_Props.MaxInFlight ? s_Props.MaxInFlight : JobSystem::GetWorkerCount() * 2, s_Props.InlineBudgetMs);
+	}
+
+	void AssetStreamer::Flush()
+	{
+		RE_PROFILE_FUNC();
+		s_Requests.Flush();
+	}
+
+	AssetStreamerStats AssetStreamer::GetStats()
+	{
+		RequestQueueStats requests = s_Requests.GetStats();
+		std::lock_guard<std::mutex> lock(s_StatsMutex);
+		return { requests.Queued, requests.InFlight, requests.Completed, s_Loaded, s_BytesLoaded };
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string_view>
+
+#include "RockEngine/Asset/AssetArchive.h"
+
+namespace RockEngine
+{
+	// Queued loads start in this order, first come first served within a priority
+	enum class LoadPriority : uint8_t
+	{
+		Low = 0,
+		Normal,
+		High,
+		Critical
+	};
+
+	enum class AssetLoadStatus : uint8_t
+	{
+		Loaded = 0,
+		NotFound,
+		Corrupt
+	};
+
+	// A loaded asset. Uncompressed ones point straight into the archive's mapping (no copy, valid
+	// while the archive is open), decompressed ones own their buffer.
+	class AssetData
+	{
+	public:
+		AssetData() = default;
+		AssetData(const uint8_t* data, size_t size)
+			: m_Data(data), m_Size(size) {}
+		AssetData(std::unique_ptr<uint8_t[]> buffer, size_t size)
+			: m_Data(buffer.get()), m_Size(size), m_Buffer(std::move(buffer)) {}
+
+		inline const uint8_t* GetData() const { return m_Data; }
+		inline size_t GetSize() const { return m_Size; }
+		inline bool IsZeroCopy() const { return m_Data && !m_Buffer; }
+	private:
+		const uint8_t* m_Data = nullptr;
+		size_t m_Size = 0;
+		std::unique_ptr<uint8_t[]> m_Buffer;
+	};
+
+	struct AssetLoadResult
+	{
+		const AssetArchive* Archive;
+		const ArchiveEntry* Entry;	// null if NotFound
+		AssetLoadStatus Status;
+		LoadPriority Priority;
+		AssetData Data;				// move it out to keep it past the callback
+		float LoadMs;				// reading and decompressing, on the job thread
+		float LatencyMs;			// request to callback
+	};
+
+	using AssetLoadCallback = std::function<void(AssetLoadResult& result)>;
+
+	struct AssetStreamerProps
+	{
+		// Loads running on the job system at once, 0 is two per worker
+		uint32_t MaxInFlight = 0;
+		// Without worker threads Update loads on the main thread, at most this long per frame
+		float InlineBudgetMs = 2.0f;
+	};
+
+	struct AssetStreamerStats
+	{
+		uint32_t Queued;
+		uint32_t InFlight;
+		uint32_t Completed;		// waiting for their callback
+		uint64_t Loaded;		// since Init
+		uint64_t BytesLoaded;
+	};
+
+	// Streams assets out of mapped archives: Load queues a request, Update (called by
+	// Application::Run every frame) starts the most important queued ones on the job system,
+	// where they're paged in and decompressed, and runs the callbacks of finished ones on the
+	// main thread. The archive has to stay open until its loads called back.
+	class AssetStreamer
+	{
+	public:
+		static void Init(const AssetStreamerProps& props = AssetStreamerProps());
+		// Waits for the running loads, drops the queued ones without calling back
+		static void Shutdown();
+
+		// Thread safe, the callback always runs on the main thread during Update or Flush
+		static void Load(const AssetArchive& archive, std::string_view name, LoadPriority priority, AssetLoadCallback callback);
+
+		static void Update();
+		// Runs every queued load to completion and calls back, for loading screens and tools
+		static void Flush();
+
+		static AssetStreamerStats GetStats();
+	};
+}
\ No newline at end of file
@@ -0,0 +1,453 @@
+#include "pch.h"
+#include "BlockCompression.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "RockEngine/Core/JobSystem.h"
+
+namespace RockEngine
+{
+	// Smaller images aren't worth splitting over the job system
+	static constexpr uint32_t s_ParallelBlocks = 32 * 32;
+
+	// A block's 16 texels, clamped at the image edge
+	static void LoadBlock(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t block[64])
+	{
+		for (uint32_t y = 0; y < 4; y++)
+		{
+			uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+			for (uint32_t x = 0; x < 4; x++)
+			{
+				uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+				std::memcpy(block + (y * 4 + x) * 4, pixels + ((size_t)sourceY * width + sourceX) * 4, 4);
+			}
+		}
+	}
+
+	static void StoreBlock(const uint8_t block[64], uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t* pixels)
+	{
+		for (uint32_t y = 0; y < 4 && blockY * 4 + y < height; y++)
+		{
+			for (uint32_t x = 0; x < 4 && blockX * 4 + x < width; x++)
+				std::memcpy(pixels + ((size_t)(blockY * 4 + y) * width + blockX * 4 + x) * 4, block + (y * 4 + x) * 4, 4);
+		}
+	}
+
+	template<typename Func>
+	static void ForBlockRows(uint32_t width, uint32_t height, const Func& func)
+	{
+		const uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+		auto rows = [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t blockY = begin; blockY < end; blockY++)
+			{
+				for (uint32_t blockX = 0; blockX < blocksX; blockX++)
+					func(blockX, blockY, (size_t)blockY * blocksX + blockX);
+			}
+		};
+
+		if (blocksX * blocksY < s_ParallelBlocks || JobSystem::GetWorkerCount() <= 1)
+			rows(0u, blocksY);
+		else
+			JobSystem::ParallelFor(blocksY, JobSystem::GetDefaultGrainSize(blocksY, 1), rows);
+	}
+
+	static uint16_t Quantize565(const float color[3])
+	{
+		uint32_t r = (uint32_t)std::clamp(color[0] * (31.0f / 255.0f) + 0.5f, 0.0f, 31.0f);
+		uint32_t g = (uint32_t)std::clamp(color[1] * (63.0f / 255.0f) + 0.5f, 0.0f, 63.0f);
+		uint32_t b = (uint32_t)std::clamp(color[2] * (31.0f / 255.0f) + 0.5f, 0.0f, 31.0f);
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	static void Expand565(uint16_t color, int32_t out[3])
+	{
+		uint32_t r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+		out[0] = (int32_t)((r << 3) | (r >> 2));
+		out[1] = (int32_t)((g << 2) | (g >> 4));
+		out[2] = (int32_t)((b << 3) | (b >> 2));
+	}
+
+	// The colors a decoder derives from two endpoints. Four color mode interpolates thirds, three
+	// color mode the half (its fourth entry is transparent black).
+	static void GetPalette(uint16_t color0, uint16_t color1, bool fourColor, int32_t palette[4][3])
+	{
+		Expand565(color0, palette[0]);
+		Expand565(color1, palette[1]);
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			if (fourColor)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+			}
+			else
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c] + 1) / 2;
+				palette[3][c] = 0;
+			}
+		}
+	}
+
+	// Picks the closest palette entry for every texel, transparent texels get index 3.
+	// Returns the summed squared error.
+	static uint32_t FitIndices(const uint8_t block[64], const bool transparent[16], uint16_t color0, uint16_t color1, bool fourColor, uint8_t indices[16])
+	{
+		int32_t palette[4][3];
+		GetPalette(color0, color1, fourColor, palette);
+		const uint32_t entries = fourColor ? 4 : 3;
+
+		uint32_t total = 0;
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			if (transparent[i])
+			{
+				indices[i] = 3;
+				continue;
+			}
+
+			uint32_t best = UINT32_MAX;
+			for (uint32_t entry = 0; entry < entries; entry++)
+			{
+				int32_t dr = block[i * 4] - palette[entry][0];
+				int32_t dg = block[i * 4 + 1] - palette[entry][1];
+				int32_t db = block[i * 4 + 2] - palette[entry][2];
+				uint32_t error = (uint32_t)(dr * dr + dg * dg + db * db);
+				if (error < best)
+				{
+					best = error;
+					indices[i] = (uint8_t)entry;
+				}
+			}
+			total += best;
+		}
+		return total;
+	}
+
+	// Least squares endpoints for fixed indices: texel ~ w * color0 + (1 - w) * color1
+	static bool RefineEndpoints(const uint8_t block[64], const bool transparent[16], const uint8_t indices[16], bool fourColor, float color0[3], float color1[3])
+	{
+		static constexpr float s_FourColorWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+		static constexpr float s_ThreeColorWeights[4] = { 1.0f, 0.0f, 0.5f, 0.0f };
+		const float* weights = fourColor ? s_FourColorWeights : s_ThreeColorWeights;
+
+		float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		float ax[3] = {}, bx[3] = {};
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			if (transparent[i])
+				continue;
+
+			float a = weights[indices[i]], b = 1.0f - a;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				ax[c] += a * block[i * 4 + c];
+				bx[c] += b * block[i * 4 + c];
+			}
+		}
+
+		float determinant = aa * bb - ab * ab;
+		if (std::abs(determinant) < 1e-6f)
+			return false;
+
+		float inverse = 1.0f / determinant;
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			color0[c] = (ax[c] * bb - bx[c] * ab) * inverse;
+			color1[c] = (bx[c] * aa - ax[c] * ab) * inverse;
+		}
+		return true;
+	}
+
+	// BC1 color half of a block. `punchThrough` allows the three color mode with transparent
+	// texels, BC3 blocks are always decoded with four colors.
+	static void EncodeColorBlock(const uint8_t block[64], bool punchThrough, uint8_t* out)
+	{
+		bool transparent[16];
+		uint32_t opaque = 0;
+		float mean[3] = {};
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			transparent[i] = punchThrough && block[i * 4 + 3] < 128;
+			if (transparent[i])
+				continue;
+
+			opaque++;
+			for (uint32_t c = 0; c < 3; c++)
+				mean[c] += block[i * 4 + c];
+		}
+
+		if (opaque == 0)
+		{
+			// Equal endpoints select the three color mode, index 3 everywhere is transparent
+			std::memset(out, 0, 4);
+			std::memset(out + 4, 0xFF, 4);
+			return;
+		}
+
+		for (uint32_t c = 0; c < 3; c++)
+			mean[c] /= (float)opaque;
+
+		// Principal axis of the colors by power iteration on their covariance
+		float covariance[6] = {};
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			if (transparent[i])
+				continue;
+
+			float d[3];
+			for (uint32_t c = 0; c < 3; c++)
+				d[c] = block[i * 4 + c] - mean[c];
+			covariance[0] += d[0] * d[0];
+			covariance[1] += d[0] * d[1];
+			covariance[2] += d[0] * d[2];
+			covariance[3] += d[1] * d[1];
+			covariance[4] += d[1] * d[2];
+			covariance[5] += d[2] * d[2];
+		}
+
+		// Starting from the covariance column of the widest channel, which can't be orthogonal
+		// to the axis the way a fixed start is for anti-correlated channels
+		float axis[3] = { covariance[0], covariance[1], covariance[2] };
+		if (covariance[3] > covariance[0] && covariance[3] >= covariance[5])
+		{
+			axis[0] = covariance[1];
+			axis[1] = covariance[3];
+			axis[2] = covariance[4];
+		}
+		else if (covariance[5] > covariance[0] && covariance[5] > covariance[3])
+		{
+			axis[0] = covariance[2];
+			axis[1] = covariance[4];
+			axis[2] = covariance[5];
+		}
+		for (uint32_t iteration = 0; iteration < 8; iteration++)
+		{
+			float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+			float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+			float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+			float length = std::max({ std::abs(x), std::abs(y), std::abs(z) });
+			if (length < 1e-6f)
+				break;
+
+			axis[0] = x / length;
+			axis[1] = y / length;
+			axis[2] = z / length;
+		}
+		float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+		if (length > 1e-6f)
+		{
+			for (uint32_t c = 0; c < 3; c++)
+				axis[c] /= length;
+		}
+
+		float low = 0.0f, high = 0.0f;
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			if (transparent[i])
+				continue;
+
+			float t = (block[i * 4] - mean[0]) * axis[0] + (block[i * 4 + 1] - mean[1]) * axis[1] + (block[i * 4 + 2] - mean[2]) * axis[2];
+			low = std::min(low, t);
+			high = std::max(high, t);
+		}
+
+		// Pull the endpoints in a little, the extremes are rarely worth a palette entry each
+		const float inset = (high - low) / 16.0f;
+		float endpoint0[3], endpoint1[3];
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			endpoint0[c] = mean[c] + axis[c] * (high - inset);
+			endpoint1[c] = mean[c] + axis[c] * (low + inset);
+		}
+
+		const bool fourColor = !punchThrough;
+		uint16_t color0 = Quantize565(endpoint0), color1 = Quantize565(endpoint1);
+		uint8_t indices[16];
+		uint32_t error = FitIndices(block, transparent, color0, color1, fourColor, indices);
+
+		if (error > 0 && RefineEndpoints(block, transparent, indices, fourColor, endpoint0, endpoint1))
+		{
+			uint16_t refined0 = Quantize565(endpoint0), refined1 = Quantize565(endpoint1);
+			uint8_t refinedIndices[16];
+			uint32_t refinedError = FitIndices(block, transparent, refined0, refined1, fourColor, refinedIndices);
+			if (refinedError < error)
+			{
+				color0 = refined0;
+				color1 = refined1;
+				std::memcpy(indices, refinedIndices, sizeof(indices));
+			}
+		}
+
+		// The endpoint order selects the mode: color0 > color1 for four colors, <= for three
+		if (fourColor ? color0 < color1 : color0 > color1)
+		{
+			std::swap(color0, color1);
+			for (uint8_t& index : indices)
+			{
+				// Three color mode keeps its midpoint and transparent entries in place
+				if (fourColor || index < 2)
+					index ^= 1;
+			}
+		}
+		else if (fourColor && color0 == color1)
+		{
+			// Decoded as three colors, where index 3 would be transparent; every entry but that
+			// one is the same color anyway
+			std::memset(indices, 0, sizeof(indices));
+		}
+
+		uint32_t bits = 0;
+		for (uint32_t i = 0; i < 16; i++)
+			bits |= (uint32_t)indices[i] << (i * 2);
+
+		out[0] = (uint8_t)color0;
+		out[1] = (uint8_t)(color0 >> 8);
+		out[2] = (uint8_t)color1;
+		out[3] = (uint8_t)(color1 >> 8);
+		std::memcpy(out + 4, &bits, 4);
+	}
+
+	// Eight value mode: alpha0 > alpha1, six interpolated steps between them
+	static void GetAlphaPalette(uint32_t alpha0, uint32_t alpha1, uint32_t palette[8])
+	{
+		palette[0] = alpha0;
+		palette[1] = alpha1;
+		if (alpha0 > alpha1)
+		{
+			for (uint32_t i = 1; i < 7; i++)
+				palette[i + 1] = ((7 - i) * alpha0 + i * alpha1 + 3) / 7;
+		}
+		else
+		{
+			for (uint32_t i = 1; i < 5; i++)
+				palette[i + 1] = ((5 - i) * alpha0 + i * alpha1 + 2) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	static void EncodeAlphaBlock(const uint8_t block[64], uint8_t* out)
+	{
+		uint32_t alpha0 = 0, alpha1 = 255;
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			alpha0 = std::max<uint32_t>(alpha0, block[i * 4 + 3]);
+			alpha1 = std::min<uint32_t>(alpha1, block[i * 4 + 3]);
+		}
+
+		uint64_t bits = 0;
+		if (alpha0 > alpha1)
+		{
+			uint32_t palette[8];
+			GetAlphaPalette(alpha0, alpha1, palette);
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				uint32_t alpha = block[i * 4 + 3], best = 0, bestError = UINT32_MAX;
+				for (uint32_t entry = 0; entry < 8; entry++)
+				{
+					uint32_t error = alpha > palette[entry] ? alpha - palette[entry] : palette[entry] - alpha;
+					if (error < bestError)
+					{
+						bestError = error;
+						best = entry;
+					}
+				}
+				bits |= (uint64_t)best << (i * 3);
+			}
+		}
+
+		out[0] = (uint8_t)alpha0;
+		out[1] = (uint8_t)alpha1;
+		for (uint32_t i = 0; i < 6; i++)
+			out[2 + i] = (uint8_t)(bits >> (i * 8));
+	}
+
+	static void DecodeColorBlock(const uint8_t* in, bool punchThrough, uint8_t block[64])
+	{
+		uint16_t color0 = (uint16_t)(in[0] | (in[1] << 8)), color1 = (uint16_t)(in[2] | (in[3] << 8));
+		uint32_t bits;
+		std::memcpy(&bits, in + 4, 4);
+
+		const bool fourColor = !punchThrough || color0 > color1;
+		int32_t palette[4][3];
+		GetPalette(color0, color1, fourColor, palette);
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			uint32_t index = (bits >> (i * 2)) & 3;
+			for (uint32_t c = 0; c < 3; c++)
+				block[i * 4 + c] = (uint8_t)palette[index][c];
+			block[i * 4 + 3] = !fourColor && index == 3 ? 0 : 255;
+		}
+	}
+
+	static void DecodeAlphaBlock(const uint8_t* in, uint8_t block[64])
+	{
+		uint32_t palette[8];
+		GetAlphaPalette(in[0], in[1], palette);
+		uint64_t bits = 0;
+		for (uint32_t i = 0; i < 6; i++)
+			bits |= (uint64_t)in[2 + i] << (i * 8);
+		for (uint32_t i = 0; i < 16; i++)
+			block[i * 4 + 3] = (uint8_t)palette[(bits >> (i * 3)) & 7];
+	}
+
+	size_t BlockCompression::GetSize(uint32_t width, uint32_t height, uint32_t blockSize)
+	{
+		return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+	}
+
+	void BlockCompression::EncodeBC1(const uint8_t* pixels, uint32_t width, uint32_t height, uint8_t* blocks)
+	{
+		RE_PROFILE_FUNC();
+
+		ForBlockRows(width, height, [&](uint32_t blockX, uint32_t blockY, size_t index)
+		{
+			uint8_t block[64];
+			LoadBlock(pixels, width, height, blockX, blockY, block);
+
+			bool punchThrough = false;
+			for (uint32_t i = 0; i < 16 && !punchThrough; i++)
+				punchThrough = block[i * 4 + 3] < 128;
+			EncodeColorBlock(block, punchThrough, blocks + index * BC1BlockSize);
+		});
+	}
+
+	void BlockCompression::EncodeBC3(const uint8_t* pixels, uint32_t width, uint32_t height, uint8_t* blocks)
+	{
+		RE_PROFILE_FUNC();
+
+		ForBlockRows(width, height, [&](uint32_t blockX, uint32_t blockY, size_t index)
+		{
+			uint8_t block[64];
+			LoadBlock(pixels, width, height, blockX, blockY, block);
+			EncodeAlphaBlock(block, blocks + index * BC3BlockSize);
+			EncodeColorBlock(block, false, blocks + index * BC3BlockSize + 8);
+		});
+	}
+
+	void BlockCompression::DecodeBC1(const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* pixels)
+	{
+		ForBlockRows(width, height, [&](uint32_t blockX, uint32_t blockY, size_t index)
+		{
+			uint8_t block[64];
+			DecodeColorBlock(blocks + index * BC1BlockSize, true, block);
+			StoreBlock(block, width, height, blockX, blockY, pixels);
+		});
+	}
+
+	void BlockCompression::DecodeBC3(const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* pixels)
+	{
+		ForBlockRows(width, height, [&](uint32_t blockX, uint32_t blockY, size_t index)
+		{
+			uint8_t block[64];
+			DecodeColorBlock(blocks + index * BC3BlockSize + 8, false, block);
+			DecodeAlphaBlock(blocks + index * BC3BlockSize, block);
+			StoreBlock(block, width, height, blockX, blockY, pixels);
+		});
+	}
+}
\ No newline at end of file
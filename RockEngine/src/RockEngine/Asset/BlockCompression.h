@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace RockEngine
+{
+	// GPU block compression of RGBA8 images (red in the lowest byte, rows top to bottom) into
+	// 4x4 texel blocks, the layout glCompressedTexImage2D and D3D expect:
+	//   BC1 (DXT1)	8 bytes a block, RGB 5:6:5 endpoints and 2 bit indices. Texels with alpha
+	//				below 128 become transparent through the three color mode.
+	//   BC3 (DXT5)	16 bytes a block, BC1 color plus 8 bit alpha endpoints and 3 bit indices
+	// Endpoints are fit along the principal axis of the block's colors and refined once by least
+	// squares. Colors are compared as stored, so sRGB data is fit in sRGB space.
+	// Images that aren't a multiple of 4 are padded by repeating their last row and column.
+	class BlockCompression
+	{
+	public:
+		static constexpr uint32_t BC1BlockSize = 8;
+		static constexpr uint32_t BC3BlockSize = 16;
+
+		static size_t GetSize(uint32_t width, uint32_t height, uint32_t blockSize);
+
+		static void EncodeBC1(const uint8_t* pixels, uint32_t width, uint32_t height, uint8_t* blocks);
+		static void EncodeBC3(const uint8_t* pixels, uint32_t width, uint32_t height, uint8_t* blocks);
+
+		// For tools, tests and the software renderer; the GPU decodes these itself
+		static void DecodeBC1(const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* pixels);
+		static void DecodeBC3(const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* pixels);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include "pch.h"
+#include "Compression.h"
+
+#include <cstring>
+
+namespace RockEngine
+{
+	// LZ4 block format: a stream of sequences, each a token (literal length << 4 | match length - 4,
+	// 15 meaning more length bytes follow), the literals, a 16 bit little endian offset and the
+	// match length's extra bytes. The last sequence is literals only.
+	static constexpr uint32_t s_MinMatch = 4;
+	static constexpr size_t s_LastLiterals = 5;		// the block ends with at least this many literals
+	static constexpr size_t s_MatchStartLimit = 12;	// and the last match starts this far from the end
+	static constexpr uint32_t s_MaxOffset = 65535;
+	static constexpr uint32_t s_HashBits = 12;
+
+	static inline uint32_t Read32(const uint8_t* p)
+	{
+		uint32_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	static inline uint32_t Hash4(uint32_t sequence)
+	{
+		return (sequence * 2654435761u) >> (32 - s_HashBits);
+	}
+
+	static inline uint8_t* WriteLength(uint8_t* out, size_t length)
+	{
+		for (; length >= 255; length -= 255)
+			*out++ = 255;
+		*out++ = (uint8_t)length;
+		return out;
+	}
+
+	// Token, literal length, literals, and the match if there is one. Null if out of space.
+	static uint8_t* WriteSequence(uint8_t* out, uint8_t* outEnd, const uint8_t* literals, size_t literalLength, uint32_t offset, size_t matchLength)
+	{
+		size_t needed = 1 + literalLength / 255 + 1 + literalLength + (matchLength ? 2 + matchLength / 255 + 1 : 0);
+		if (needed > (size_t)(outEnd - out))
+			return nullptr;
+
+		uint8_t* token = out++;
+		*token = (uint8_t)(std::min<size_t>(literalLength, 15) << 4);
+		if (literalLength >= 15)
+			out = WriteLength(out, literalLength - 15);
+		std::memcpy(out, literals, literalLength);
+		out += literalLength;
+
+		if (matchLength)
+		{
+			*out++ = (uint8_t)offset;
+			*out++ = (uint8_t)(offset >> 8);
+			size_t length = matchLength - s_MinMatch;
+			*token |= (uint8_t)std::min<size_t>(length, 15);
+			if (length >= 15)
+				out = WriteLength(out, length - 15);
+		}
+		return out;
+	}
+
+	size_t Compression::GetBound(size_t size)
+	{
+		return size + size / 255 + 16;
+	}
+
+	size_t Compression::CompressLZ4(const void* source, size_t size, void* destination, size_t capacity)
+	{
+		RE_PROFILE_FUNC();
+
+		const uint8_t* begin = static_cast<const uint8_t*>(source);
+		const uint8_t* end = begin + size;
+		uint8_t* out = static_cast<uint8_t*>(destination);
+		uint8_t* outEnd = out + capacity;
+
+		const uint8_t* anchor = begin;
+		if (size > s_MatchStartLimit)
+		{
+			// Last position each hashed 4 byte sequence was seen at. Stale or colliding entries
+			// are fine, candidates are compared before they're used.
+			uint32_t table[1u << s_HashBits] = {};
+			const uint8_t* matchStartLimit = end - s_MatchStartLimit;
+			const uint8_t* matchEndLimit = end - s_LastLiterals;
+
+			const uint8_t* in = begin + 1;
+			while (in <= matchStartLimit)
+			{
+				uint32_t sequence = Read32(in);
+				uint32_t& slot = table[Hash4(sequence)];
+				const uint8_t* candidate = begin + slot;
+				slot = (uint32_t)(in - begin);
+
+				if (candidate >= in || (uint32_t)(in - candidate) > s_MaxOffset || Read32(candidate) != sequence)
+				{
+					// Skip ahead faster the longer nothing matched, incompressible data stays cheap
+					in += 1 + ((in - anchor) >> 6);
+					continue;
+				}
+
+				while (in > anchor && candidate > begin && in[-1] == candidate[-1])
+				{
+					in--;
+					candidate--;
+				}
+
+				size_t length = s_MinMatch;
+				while (in + length < matchEndLimit && in[length] == candidate[length])
+					length++;
+
+				out = WriteSequence(out, outEnd, anchor, in - anchor, (uint32_t)(in - candidate), length);
+				if (!out)
+					return 0;
+
+				in += length;
+				anchor = in;
+				if (in <= matchStartLimit)
+					table[Hash4(Read32(in - 2))] = (uint32_t)(in - 2 - begin);
+			}
+		}
+
+		out = WriteSequence(out, outEnd, anchor, end - anchor, 0, 0);
+		return out ? out - static_cast<uint8_t*>(destination) : 0;
+	}
+
+	bool Compression::DecompressLZ4(const void* source, size_t compressedSize, void* destination, size_t size)
+	{
+		RE_PROFILE_FUNC();
+
+		const uint8_t* in = static_cast<const uint8_t*>(source);
+		const uint8_t* inEnd = in + compressedSize;
+		uint8_t* begin = static_cast<uint8_t*>(destination);
+		uint8_t* out = begin;
+		uint8_t* outEnd = begin + size;
+
+		auto readLength = [&](size_t& length)
+		{
+			uint8_t byte;
+			do
+			{
+				if (in == inEnd)
+					return false;
+				byte = *in++;
+				length += byte;
+			} while (byte == 255);
+			return true;
+		};
+
+		while (in < inEnd)
+		{
+			uint8_t token = *in++;
+
+			size_t literalLength = token >> 4;
+			if (literalLength == 15 && !readLength(literalLength))
+				return false;
+			if (literalLength > (size_t)(inEnd - in) || literalLength > (size_t)(outEnd - out))
+				return false;
+			std::memcpy(out, in, literalLength);
+			in += literalLength;
+			out += literalLength;
+
+			if (in == inEnd)
+				break;
+
+			if (inEnd - in < 2)
+				return false;
+			size_t offset = in[0] | (in[1] << 8);
+			in += 2;
+			if (offset == 0 || offset > (size_t)(out - begin))
+				return false;
+
+			size_t matchLength = token & 15;
+			if (matchLength == 15 && !readLength(matchLength))
+				return false;
+			matchLength += s_MinMatch;
+			if (matchLength > (size_t)(outEnd - out))
+				return false;
+
+			const uint8_t* match = out - offset;
+			if (offset >= matchLength)
+			{
+				std::memcpy(out, match, matchLength);
+				out += matchLength;
+			}
+			else
+			{
+				// Overlapping: the match repeats bytes it's writing itself
+				for (size_t i = 0; i < matchLength; i++)
+					*out++ = match[i];
+			}
+		}
+
+		return out == outEnd;
+	}
+}
\ No newline at end of file
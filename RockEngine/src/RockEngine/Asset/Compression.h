@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace RockEngine
+{
+	enum class CompressionType : uint8_t
+	{
+		None = 0,
+		LZ4 = 1		// LZ4 block format, no frame header
+	};
+
+	// Block compression for packed assets. Decompression is what the runtime pays for, so the
+	// format is LZ4: byte aligned literals and matches, no entropy coding.
+	class Compression
+	{
+	public:
+		// LZ4 turns one byte into at most 255, data claiming to expand further is damaged
+		static constexpr uint64_t MaxLZ4Ratio = 255;
+
+		// Worst case compressed size of `size` bytes
+		static size_t GetBound(size_t size);
+
+		// Returns the compressed size, 0 if it didn't fit into `capacity`
+		static size_t CompressLZ4(const void* source, size_t size, void* destination, size_t capacity);
+
+		// `size` has to be the exact uncompressed size. Returns false on corrupt input instead
+		// of reading or writing out of bounds, archives can come from anywhere.
+		static bool DecompressLZ4(const void* source, size_t compressedSize, void* destination, size_t size);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include "pch.h"
+#include "FileWatcher.h"
+
+#include <cstring>
+#include <filesystem>
+#include <unordered_set>
+
+#ifdef RE_PLATFORM_LINUX
+	#include <cerrno>
+	#include <poll.h>
+	#include <sys/eventfd.h>
+	#include <sys/inotify.h>
+	#include <unistd.h>
+#endif
+
+namespace RockEngine
+{
+	namespace fs = std::filesystem;
+
+	FileWatcher::FileWatcher(const FileWatcherProps& props /* = FileWatcherProps() */)
+		: m_Props(props)
+	{
+	}
+
+	FileWatcher::~FileWatcher()
+	{
+		Stop();
+	}
+
+	std::string FileWatcher::NormalizePath(const std::string& path)
+	{
+		std::error_code error;
+		fs::path normalized = fs::weakly_canonical(path, error);
+		if (error)
+			normalized = fs::absolute(path, error).lexically_normal();
+		return normalized.generic_string();
+	}
+
+	bool FileWatcher::PopChanges(FileChangeBatch& batch)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_Batches.empty())
+			return false;
+
+		batch = std::move(m_Batches.front());
+		m_Batches.pop_front();
+		return true;
+	}
+
+#ifdef RE_PLATFORM_LINUX
+	// What counts as a change: written and closed, touched, renamed in or out, deleted.
+	// Plain IN_MODIFY would report every write of a file still being saved.
+	static constexpr uint32_t s_WatchMask = IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+	bool FileWatcher::Start(const std::string& directory)
+	{
+		Stop();
+
+		std::error_code error;
+		m_Directory = NormalizePath(directory);
+		if (!fs::is_directory(m_Directory, error))
+		{
+			RE_CORE_ERROR("FileWatcher: {} isn't a directory", directory);
+			return false;
+		}
+
+		m_Inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		m_WakeEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (m_Inotify < 0 || m_WakeEvent < 0)
+		{
+			RE_CORE_ERROR("FileWatcher: can't create an inotify instance: {}", std::strerror(errno));
+			Stop();
+			return false;
+		}
+
+		// inotify isn't recursive, every directory gets a watch of its own
+		bool watched = AddWatch(m_Directory);
+		for (fs::recursive_directory_iterator it(m_Directory, error), end; watched && !error && it != end; it.increment(error))
+		{
+			if (it->is_directory(error))
+				watched = AddWatch(it->path().generic_string());
+		}
+		if (!watched)
+		{
+			Stop();
+			return false;
+		}
+
+		m_Thread = std::thread(&FileWatcher::Main, this);
+		RE_CORE_INFO("FileWatcher: watching {} ({} directories)", m_Directory, m_Watches.size());
+		return true;
+	}
+
+	void FileWatcher::Stop()
+	{
+		if (m_Thread.joinable())
+		{
+			uint64_t one = 1;
+			ssize_t written = write(m_WakeEvent, &one, sizeof(one));
+			(void)written;
+			m_Thread.join();
+		}
+
+		if (m_Inotify >= 0)
+			close(m_Inotify);
+		if (m_WakeEvent >= 0)
+			close(m_WakeEvent);
+		m_Inotify = -1;
+		m_WakeEvent = -1;
+		m_Watches.clear();
+	}
+
+	bool FileWatcher::AddWatch(const std::string& directory)
+	{
+		int watch = inotify_add_watch(m_Inotify, directory.c_str(), s_WatchMask | IN_ONLYDIR);
+		if (watch < 0)
+		{
+			// Usually fs.inotify.max_user_watches
+			RE_CORE_ERROR("FileWatcher: can't watch {}: {}", directory, std::strerror(errno));
+			return false;
+		}
+		m_Watches[watch] = directory;
+		return true;
+	}
+
+	void FileWatcher::Main()
+	{
+		RE_PROFILE_THREAD("FileWatcher");
+
+		// Paths of the batch being coalesced, in the order they first changed
+		std::vector<std::string> pending;
+		std::unordered_set<std::string> pendingSet;
+		uint64_t firstEvent = 0, lastEvent = 0;
+		const uint64_t coalesceNs = (uint64_t)(m_Props.CoalesceMs * 1e6);
+		const uint64_t maxDelayNs = (uint64_t)(m_Props.MaxDelayMs * 1e6);
+
+		auto addPending = [&](std::string path)
+		{
+			if (pendingSet.insert(path).second)
+				pending.push_back(std::move(path));
+		};
+
+		alignas(inotify_event) char buffer[16 * 1024];
+		for (;;)
+		{
+			int timeout = -1;
+			if (!pending.empty())
+			{
+				uint64_t now = Profiler::Now();
+				uint64_t due = std::min(lastEvent + coalesceNs, firstEvent + maxDelayNs);
+				timeout = due > now ? (int)((due - now + 999999) / 1000000) : 0;
+			}
+
+			pollfd fds[2] = { { m_Inotify, POLLIN, 0 }, { m_WakeEvent, POLLIN, 0 } };
+			if (poll(fds, 2, timeout) < 0 && errno != EINTR)
+			{
+				RE_CORE_ERROR("FileWatcher: poll failed: {}", std::strerror(errno));
+				break;
+			}
+			if (fds[1].revents & POLLIN)
+				break;
+
+			if (fds[0].revents & POLLIN)
+			{
+				ssize_t size;
+				uint64_t events = 0;
+				while ((size = read(m_Inotify, buffer, sizeof(buffer))) > 0)
+				{
+					for (char* at = buffer; at < buffer + size; )
+					{
+						const inotify_event* event = reinterpret_cast<const inotify_event*>(at);
+						at += sizeof(inotify_event) + event->len;
+						events++;
+
+						if (event->mask & IN_Q_OVERFLOW)
+						{
+							RE_CORE_WARN("FileWatcher: the event queue of {} overflowed, changes were missed", m_Directory);
+							continue;
+						}
+						if (event->mask & IN_IGNORED)
+						{
+							m_Watches.erase(event->wd);
+							continue;
+						}
+
+						auto watch = m_Watches.find(event->wd);
+						if (watch == m_Watches.end() || event->len == 0)
+							continue;
+						std::string path = watch->second + '/' + event->name;
+
+						if (!(event->mask & IN_ISDIR))
+						{
+							addPending(std::move(path));
+							continue;
+						}
+
+						// A new directory may have been filled before its watch existed, what's
+						// in it already counts as changed
+						if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && AddWatch(path))
+						{
+							std::error_code error;
+							for (fs::recursive_directory_iterator it(path, error), end; !error && it != end; it.increment(error))
+							{
+								if (it->is_directory(error))
+									AddWatch(it->path().generic_string());
+								else
+									addPending(it->path().generic_string());
+							}
+						}
+					}
+				}
+
+				if (events)
+				{
+					uint64_t now = Profiler::Now();
+					if (pending.size() && !firstEvent)
+						firstEvent = now;
+					lastEvent = now;
+					m_Events.fetch_add(events, std::memory_order_relaxed);
+				}
+			}
+
+			uint64_t now = Profiler::Now();
+			if (!pending.empty() && (now - lastEvent >= coalesceNs || now - firstEvent >= maxDelayNs))
+			{
+				FileChangeBatch batch;
+				batch.Paths = std::move(pending);
+				batch.FirstEventTime = firstEvent;
+				{
+					std::lock_guard<std::mutex> lock(m_Mutex);
+					m_Batches.push_back(std::move(batch));
+				}
+				pending.clear();
+				pendingSet.clear();
+				firstEvent = 0;
+			}
+		}
+	}
+#else
+	bool FileWatcher::Start(const std::string& directory)
+	{
+		RE_CORE_ERROR("FileWatcher: can't watch {}, file watching needs inotify (Linux)", directory);
+		return false;
+	}
+
+	void FileWatcher::Stop()
+	{
+	}
+
+	bool FileWatcher::AddWatch(const std::string& /*directory*/)
+	{
+		return false;
+	}
+
+	void FileWatcher::Main()
+	{
+	}
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace RockEngine
+{
+	struct FileWatcherProps
+	{
+		// A burst of events (an editor's save, a tool writing several files) becomes one batch
+		// once the directory was quiet this long
+		float CoalesceMs = 50.0f;
+		// ...or at the latest this long after its first event, for files that never stop changing
+		float MaxDelayMs = 500.0f;
+	};
+
+	// Files that changed, were created, deleted or renamed, each path once. Paths are absolute
+	// and normalized (see FileWatcher::NormalizePath).
+	struct FileChangeBatch
+	{
+		std::vector<std::string> Paths;
+		uint64_t FirstEventTime = 0;	// Profiler::Now of the batch's first event
+	};
+
+	// Watches a directory tree from a thread of its own, with inotify: directories created
+	// later are watched as they appear. Only available on Linux, Start fails elsewhere.
+	class FileWatcher
+	{
+	public:
+		explicit FileWatcher(const FileWatcherProps& props = FileWatcherProps());
+		~FileWatcher();
+
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+		bool Start(const std::string& directory);
+		void Stop();
+
+		inline bool IsRunning() const { return m_Thread.joinable(); }
+		inline const std::string& GetDirectory() const { return m_Directory; }
+		inline uint64_t GetEventCount() const { return m_Events.load(std::memory_order_relaxed); }
+
+		// Thread safe, oldest batch first. False if nothing changed since the last call.
+		bool PopChanges(FileChangeBatch& batch);
+
+		// The form changed paths are reported in, for comparing paths from elsewhere against them
+		static std::string NormalizePath(const std::string& path);
+	private:
+		void Main();
+		bool AddWatch(const std::string& directory);
+	private:
+		FileWatcherProps m_Props;
+		std::string m_Directory;
+		std::thread m_Thread;
+
+		int m_Inotify = -1;
+		int m_WakeEvent = -1;		// eventfd, written by Stop
+		std::unordered_map<int, std::string> m_Watches;		// watch descriptor to directory, watcher thread only
+
+		std::mutex m_Mutex;
+		std::deque<FileChangeBatch> m_Batches;
+		std::atomic<uint64_t> m_Events{ 0 };
+	};
+}
\ No newline at end of file
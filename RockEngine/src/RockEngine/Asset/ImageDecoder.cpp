@@ -0,0 +1,1341 @@
+#include "pch.h"
+#include "ImageDecoder.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "RockEngine/Math/Simd.h"
+
+namespace RockEngine
+{
+	static inline uint32_t ReadBigEndian32(const uint8_t* bytes)
+	{
+		return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+	}
+
+	static inline uint16_t ReadBigEndian16(const uint8_t* bytes)
+	{
+		return (uint16_t)(bytes[0] << 8 | bytes[1]);
+	}
+
+	static inline uint16_t ReadLittleEndian16(const uint8_t* bytes)
+	{
+		return (uint16_t)(bytes[0] | bytes[1] << 8);
+	}
+
+	static bool Fail(std::string_view name, const char* format, const char* problem)
+	{
+		RE_CORE_ERROR("ImageDecoder: can't decode {} ({}): {}", name, format, problem);
+		return false;
+	}
+
+	static bool Allocate(DecodedImage& image, uint32_t width, uint32_t height, std::string_view name, const char* format)
+	{
+		if (width == 0 || height == 0 || width > ImageDecoder::MaxDimension || height > ImageDecoder::MaxDimension)
+		{
+			RE_CORE_ERROR("ImageDecoder: can't decode {} ({}): it's {}x{}, at most {} pixels per side are supported", name, format, width, height, ImageDecoder::MaxDimension);
+			return false;
+		}
+
+		image.Width = width;
+		image.Height = height;
+		image.Pixels.assign((size_t)width * height * 4, 255);
+		return true;
+	}
+
+	static void FindAlpha(DecodedImage& image)
+	{
+		image.HasAlpha = false;
+		for (size_t i = 3; i < image.Pixels.size() && !image.HasAlpha; i += 4)
+			image.HasAlpha = image.Pixels[i] != 255;
+	}
+
+	// --- Inflate (RFC 1950, 1951) --------------------------------------
+
+	// Least significant bit first. Reads zeros past the end, Overrun tells whether it did.
+	struct InflateBits
+	{
+		const uint8_t* Data;
+		size_t Size;
+		size_t Position = 0;
+		uint64_t Bits = 0;
+		uint32_t Count = 0;
+
+		inline void Refill()
+		{
+			while (Count <= 56)
+			{
+				uint64_t byte = Position < Size ? Data[Position] : 0;
+				Position++;
+				Bits |= byte << Count;
+				Count += 8;
+			}
+		}
+
+		inline uint32_t Read(uint32_t count)
+		{
+			if (Count < count)
+				Refill();
+			uint32_t value = (uint32_t)(Bits & ((1ull << count) - 1));
+			Bits >>= count;
+			Count -= count;
+			return value;
+		}
+
+		inline bool Overrun() const { return Position * 8 - Count > Size * 8; }
+	};
+
+	struct InflateHuffman
+	{
+		static constexpr uint32_t FastBits = 10;
+
+		uint16_t Fast[1 << FastBits];	// length << 9 | symbol for codes of up to FastBits, 0 for longer ones
+		uint16_t Counts[16];			// codes of each length
+		uint16_t Symbols[288];			// by code length, then symbol: the canonical code order
+
+		bool Build(const uint8_t* lengths, uint32_t count)
+		{
+			std::memset(Counts, 0, sizeof(Counts));
+			for (uint32_t symbol = 0; symbol < count; symbol++)
+				Counts[lengths[symbol]]++;
+			Counts[0] = 0;
+
+			// Over-subscribed sets of lengths can't be decoded, incomplete ones can
+			int32_t left = 1;
+			for (uint32_t length = 1; length < 16; length++)
+			{
+				left = (left << 1) - Counts[length];
+				if (left < 0)
+					return false;
+			}
+
+			uint16_t offsets[16] = {};
+			for (uint32_t length = 1; length < 15; length++)
+				offsets[length + 1] = offsets[length] + Counts[length];
+			for (uint32_t symbol = 0; symbol < count; symbol++)
+			{
+				if (lengths[symbol])
+					Symbols[offsets[lengths[symbol]]++] = (uint16_t)symbol;
+			}
+
+			// Codes go into the stream most significant bit first, the table is indexed by the
+			// next bits least significant first: reversed, every entry starting with the code
+			std::memset(Fast, 0, sizeof(Fast));
+			uint32_t code = 0, index = 0;
+			for (uint32_t length = 1; length <= FastBits; length++)
+			{
+				for (uint32_t i = 0; i < Counts[length]; i++, code++, index++)
+				{
+					uint32_t reversed = 0;
+					for (uint32_t bit = 0; bit < length; bit++)
+						reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+					for (uint32_t entry = reversed; entry < (1u << FastBits); entry += 1u << length)
+						Fast[entry] = (uint16_t)(length << 9 | Symbols[index]);
+				}
+				code <<= 1;
+			}
+			return true;
+		}
+
+		inline int32_t Decode(InflateBits& bits) const
+		{
+			if (bits.Count < 16)
+				bits.Refill();
+
+			uint16_t entry = Fast[bits.Bits & ((1u << FastBits) - 1)];
+			if (entry)
+			{
+				bits.Bits >>= entry >> 9;
+				bits.Count -= entry >> 9;
+				return entry & 511;
+			}
+
+			// Longer codes a bit at a time, walking the canonical code ranges of each length
+			int32_t code = 0, first = 0, index = 0;
+			for (uint32_t length = 1; length < 16; length++)
+			{
+				code |= (int32_t)((bits.Bits >> (length - 1)) & 1);
+				int32_t count = Counts[length];
+				if (code - count < first)
+				{
+					bits.Bits >>= length;
+					bits.Count -= length;
+					return Symbols[index + (code - first)];
+				}
+				index += count;
+				first = (first + count) << 1;
+				code <<= 1;
+			}
+			return -1;
+		}
+	};
+
+	static const uint16_t s_LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	static const uint8_t s_LengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	static const uint16_t s_DistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	static const uint8_t s_DistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	static bool ReadDynamicTables(InflateBits& bits, InflateHuffman& literals, InflateHuffman& distances)
+	{
+		static const uint8_t s_Order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+		uint32_t literalCount = bits.Read(5) + 257;
+		uint32_t distanceCount = bits.Read(5) + 1;
+		uint32_t lengthCount = bits.Read(4) + 4;
+		if (literalCount > 286 || distanceCount > 30)
+			return false;
+
+		uint8_t codeLengths[19] = {};
+		for (uint32_t i = 0; i < lengthCount; i++)
+			codeLengths[s_Order[i]] = (uint8_t)bits.Read(3);
+		InflateHuffman lengthCode;
+		if (!lengthCode.Build(codeLengths, 19))
+			return false;
+
+		// Literal and distance code lengths are one sequence, repeats may run across both
+		uint8_t lengths[286 + 30];
+		uint32_t total = literalCount + distanceCount;
+		for (uint32_t n = 0; n < total; )
+		{
+			int32_t symbol = lengthCode.Decode(bits);
+			if (symbol < 0)
+				return false;
+			if (symbol < 16)
+			{
+				lengths[n++] = (uint8_t)symbol;
+				continue;
+			}
+
+			uint8_t value = 0;
+			uint32_t repeat;
+			if (symbol == 16)
+			{
+				if (n == 0)
+					return false;
+				value = lengths[n - 1];
+				repeat = 3 + bits.Read(2);
+			}
+			else if (symbol == 17)
+				repeat = 3 + bits.Read(3);
+			else
+				repeat = 11 + bits.Read(7);
+
+			if (repeat > total - n)
+				return false;
+			std::memset(lengths + n, value, repeat);
+			n += repeat;
+		}
+
+		return lengths[256] != 0 && literals.Build(lengths, literalCount) && distances.Build(lengths + literalCount, distanceCount);
+	}
+
+	// Inflates a zlib stream into exactly `size` bytes. Checksums aren't verified.
+	static bool Inflate(const uint8_t* data, size_t dataSize, uint8_t* out, size_t size)
+	{
+		RE_PROFILE_FUNC();
+
+		// Deflate, no preset dictionary
+		if (dataSize < 2 || (data[0] & 15) != 8 || (data[0] >> 4) > 7 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 32))
+			return false;
+
+		InflateBits bits{ data + 2, dataSize - 2 };
+		InflateHuffman literals, distances;
+		size_t written = 0;
+		bool last = false;
+		while (!last)
+		{
+			last = bits.Read(1) != 0;
+			uint32_t type = bits.Read(2);
+
+			if (type == 0)
+			{
+				// Stored: byte aligned, the whole bytes left in the bit buffer are handed back
+				bits.Read(bits.Count & 7);
+				size_t position = bits.Position - bits.Count / 8;
+				bits.Bits = 0;
+				bits.Count = 0;
+				if (position > bits.Size || bits.Size - position < 4)
+					return false;
+
+				uint32_t length = ReadLittleEndian16(bits.Data + position);
+				uint32_t inverse = ReadLittleEndian16(bits.Data + position + 2);
+				position += 4;
+				if ((length ^ inverse) != 0xFFFF || length > bits.Size - position || length > size - written)
+					return false;
+
+				std::memcpy(out + written, bits.Data + position, length);
+				written += length;
+				bits.Position = position + length;
+				continue;
+			}
+
+			if (type == 1)
+			{
+				uint8_t lengths[288 + 30];
+				std::memset(lengths, 8, 144);
+				std::memset(lengths + 144, 9, 112);
+				std::memset(lengths + 256, 7, 24);
+				std::memset(lengths + 280, 8, 8);
+				std::memset(lengths + 288, 5, 30);
+				literals.Build(lengths, 288);
+				distances.Build(lengths + 288, 30);
+			}
+			else if (type != 2 || !ReadDynamicTables(bits, literals, distances))
+				return false;
+
+			for (;;)
+			{
+				int32_t symbol = literals.Decode(bits);
+				if (symbol < 256)
+				{
+					if (symbol < 0 || written == size)
+						return false;
+					out[written++] = (uint8_t)symbol;
+					continue;
+				}
+				if (symbol == 256)
+					break;
+
+				symbol -= 257;
+				if (symbol >= 29)
+					return false;
+				uint32_t length = s_LengthBase[symbol] + bits.Read(s_LengthExtra[symbol]);
+				int32_t distanceSymbol = distances.Decode(bits);
+				if (distanceSymbol < 0 || distanceSymbol >= 30)
+					return false;
+				uint32_t distance = s_DistanceBase[distanceSymbol] + bits.Read(s_DistanceExtra[distanceSymbol]);
+				if (distance > written || length > size - written)
+					return false;
+
+				// Byte by byte, the copy may overlap what it writes
+				uint8_t* to = out + written;
+				const uint8_t* from = to - distance;
+				for (uint32_t i = 0; i < length; i++)
+					to[i] = from[i];
+				written += length;
+			}
+
+			if (bits.Overrun())
+				return false;
+		}
+		return written == size;
+	}
+
+	// --- PNG -----------------------------------------------------------
+
+	struct PNGInfo
+	{
+		uint32_t Depth;
+		uint32_t ColorType;
+		uint32_t Channels;
+		uint8_t Palette[256][4];
+		bool HasKey = false;		// tRNS of gray and RGB images: the one fully transparent color
+		uint16_t Key[3] = {};
+	};
+
+	static inline uint8_t PaethPredictor(int32_t a, int32_t b, int32_t c)
+	{
+		int32_t p = a + b - c;
+		int32_t pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+		if (pa <= pb && pa <= pc)
+			return (uint8_t)a;
+		return (uint8_t)(pb <= pc ? b : c);
+	}
+
+	static bool UnfilterRow(uint8_t filter, uint8_t* row, const uint8_t* prior, size_t rowBytes, uint32_t pixelBytes)
+	{
+		switch (filter)
+		{
+			case 0:
+				return true;
+			case 1:
+				for (size_t i = pixelBytes; i < rowBytes; i++)
+					row[i] += row[i - pixelBytes];
+				return true;
+			case 2:
+				for (size_t i = 0; i < rowBytes; i++)
+					row[i] += prior[i];
+				return true;
+			case 3:
+				for (size_t i = 0; i < rowBytes; i++)
+					row[i] += (uint8_t)(((i >= pixelBytes ? row[i - pixelBytes] : 0) + prior[i]) >> 1);
+				return true;
+			case 4:
+				for (size_t i = 0; i < rowBytes; i++)
+					row[i] += i >= pixelBytes ? PaethPredictor(row[i - pixelBytes], prior[i], prior[i - pixelBytes]) : prior[i];
+				return true;
+		}
+		return false;
+	}
+
+	// One unfiltered row to RGBA8, pixel x goes to out[x * step * 4]
+	static void ConvertPNGRow(const PNGInfo& info, const uint8_t* row, uint32_t width, uint8_t* out, uint32_t step)
+	{
+		const uint32_t channels = info.Channels, depth = info.Depth;
+		auto sample = [&](uint32_t x, uint32_t channel) -> uint32_t
+		{
+			if (depth == 8)
+				return row[x * channels + channel];
+			if (depth == 16)
+				return ReadBigEndian16(row + (x * channels + channel) * 2);
+			uint32_t bit = x * depth;
+			return (row[bit >> 3] >> (8 - depth - (bit & 7))) & ((1u << depth) - 1);
+		};
+		// To 8 bits: 16 bit samples are cut, 1/2/4 bit gray is scaled up
+		auto to8 = [depth](uint32_t value) -> uint8_t
+		{
+			if (depth == 16)
+				return (uint8_t)(value >> 8);
+			return (uint8_t)(depth == 8 ? value : value * 255 / ((1u << depth) - 1));
+		};
+
+		for (uint32_t x = 0; x < width; x++, out += step * 4)
+		{
+			switch (info.ColorType)
+			{
+				case 0:
+				{
+					uint32_t gray = sample(x, 0);
+					out[0] = out[1] = out[2] = to8(gray);
+					out[3] = info.HasKey && gray == info.Key[0] ? 0 : 255;
+					break;
+				}
+				case 2:
+				{
+					uint32_t r = sample(x, 0), g = sample(x, 1), b = sample(x, 2);
+					out[0] = to8(r);
+					out[1] = to8(g);
+					out[2] = to8(b);
+					out[3] = info.HasKey && r == info.Key[0] && g == info.Key[1] && b == info.Key[2] ? 0 : 255;
+					break;
+				}
+				case 3:
+					std::memcpy(out, info.Palette[sample(x, 0)], 4);
+					break;
+				case 4:
+					out[0] = out[1] = out[2] = to8(sample(x, 0));
+					out[3] = to8(sample(x, 1));
+					break;
+				case 6:
+					out[0] = to8(sample(x, 0));
+					out[1] = to8(sample(x, 1));
+					out[2] = to8(sample(x, 2));
+					out[3] = to8(sample(x, 3));
+					break;
+			}
+		}
+	}
+
+	bool ImageDecoder::DecodePNG(const uint8_t* data, size_t size, DecodedImage& image, std::string_view name)
+	{
+		RE_PROFILE_FUNC();
+
+		static const uint8_t s_Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		if (size < 8 || std::memcmp(data, s_Signature, 8) != 0)
+			return Fail(name, "PNG", "no PNG signature");
+
+		PNGInfo info;
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			info.Palette[i][0] = info.Palette[i][1] = info.Palette[i][2] = 0;
+			info.Palette[i][3] = 255;
+		}
+
+		uint32_t width = 0, height = 0, interlace = 0;
+		bool header = false;
+		std::vector<uint8_t> compressed;
+		for (size_t offset = 8; ; )
+		{
+			if (size - offset < 12 || ReadBigEndian32(data + offset) > size - offset - 12)
+				return Fail(name, "PNG", "truncated");
+
+			uint32_t length = ReadBigEndian32(data + offset);
+			const char* type = reinterpret_cast<const char*>(data + offset + 4);
+			const uint8_t* chunk = data + offset + 8;
+			offset += 12 + (size_t)length;
+
+			if (std::memcmp(type, "IHDR", 4) == 0)
+			{
+				if (length != 13 || header)
+					return Fail(name, "PNG", "broken IHDR chunk");
+				width = ReadBigEndian32(chunk);
+				height = ReadBigEndian32(chunk + 4);
+				info.Depth = chunk[8];
+				info.ColorType = chunk[9];
+				interlace = chunk[12];
+				if (chunk[10] != 0 || chunk[11] != 0 || interlace > 1)
+					return Fail(name, "PNG", "unknown compression, filter or interlace method");
+
+				static const uint32_t s_Channels[7] = { 1, 0, 3, 1, 2, 0, 4 };
+				uint32_t depth = info.Depth;
+				bool valid = info.ColorType < 7 && s_Channels[info.ColorType] && (depth == 8 || depth == 16 || (depth < 8 && (depth & (depth - 1)) == 0));
+				if (info.ColorType == 3)
+					valid = valid && depth <= 8;
+				else if (info.ColorType != 0)
+					valid = valid && depth >= 8;
+				if (!valid)
+					return Fail(name, "PNG", "unknown color type and bit depth combination");
+				info.Channels = s_Channels[info.ColorType];
+				header = true;
+			}
+			else if (!header)
+				return Fail(name, "PNG", "IHDR isn't the first chunk");
+			else if (std::memcmp(type, "PLTE", 4) == 0)
+			{
+				if (length % 3 != 0 || length > 768)
+					return Fail(name, "PNG", "broken PLTE chunk");
+				for (uint32_t i = 0; i < length / 3; i++)
+					std::memcpy(info.Palette[i], chunk + i * 3, 3);
+			}
+			else if (std::memcmp(type, "tRNS", 4) == 0)
+			{
+				if (info.ColorType == 3)
+				{
+					for (uint32_t i = 0; i < length && i < 256; i++)
+						info.Palette[i][3] = chunk[i];
+				}
+				else if ((info.ColorType == 0 && length >= 2) || (info.ColorType == 2 && length >= 6))
+				{
+					info.HasKey = true;
+					for (uint32_t i = 0; i < info.Channels; i++)
+						info.Key[i] = ReadBigEndian16(chunk + i * 2);
+				}
+			}
+			else if (std::memcmp(type, "IDAT", 4) == 0)
+				compressed.insert(compressed.end(), chunk, chunk + length);
+			else if (std::memcmp(type, "IEND", 4) == 0)
+				break;
+			else if (!(type[0] & 32))
+				return Fail(name, "PNG", "unknown critical chunk");
+		}
+
+		if (!header || !Allocate(image, width, height, name, "PNG"))
+			return false;
+
+		// Adam7 passes, or the whole image as one
+		static const uint32_t s_Adam7[7][4] = { { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 }, { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 } };
+		static const uint32_t s_SinglePass[1][4] = { { 0, 0, 1, 1 } };
+		const uint32_t (*passes)[4] = interlace ? s_Adam7 : s_SinglePass;
+		const uint32_t passCount = interlace ? 7 : 1;
+
+		const uint32_t bitsPerPixel = info.Depth * info.Channels;
+		const uint32_t pixelBytes = std::max(1u, bitsPerPixel / 8);
+		auto passSize = [&](uint32_t pass, uint32_t& passWidth, uint32_t& passHeight) -> size_t
+		{
+			passWidth = width > passes[pass][0] ? (width - passes[pass][0] + passes[pass][2] - 1) / passes[pass][2] : 0;
+			passHeight = height > passes[pass][1] ? (height - passes[pass][1] + passes[pass][3] - 1) / passes[pass][3] : 0;
+			return passWidth && passHeight ? ((size_t)passWidth * bitsPerPixel + 7) / 8 : 0;
+		};
+
+		size_t rawSize = 0;
+		for (uint32_t pass = 0; pass < passCount; pass++)
+		{
+			uint32_t passWidth, passHeight;
+			size_t rowBytes = passSize(pass, passWidth, passHeight);
+			rawSize += rowBytes ? (rowBytes + 1) * passHeight : 0;
+		}
+
+		std::vector<uint8_t> raw(rawSize);
+		if (!Inflate(compressed.data(), compressed.size(), raw.data(), raw.size()))
+			return Fail(name, "PNG", "corrupt image data");
+
+		std::vector<uint8_t> zeros(((size_t)width * bitsPerPixel + 7) / 8 + pixelBytes);
+		uint8_t* rows = raw.data();
+		for (uint32_t pass = 0; pass < passCount; pass++)
+		{
+			uint32_t passWidth, passHeight;
+			size_t rowBytes = passSize(pass, passWidth, passHeight);
+			if (!rowBytes)
+				continue;
+
+			const uint8_t* prior = zeros.data();
+			for (uint32_t y = 0; y < passHeight; y++, rows += rowBytes + 1)
+			{
+				if (!UnfilterRow(rows[0], rows + 1, prior, rowBytes, pixelBytes))
+					return Fail(name, "PNG", "unknown row filter");
+				prior = rows + 1;
+
+				uint32_t imageY = passes[pass][1] + y * passes[pass][3];
+				uint8_t* out = &image.Pixels[((size_t)imageY * width + passes[pass][0]) * 4];
+				ConvertPNGRow(info, rows + 1, passWidth, out, passes[pass][2]);
+			}
+		}
+
+		FindAlpha(image);
+		return true;
+	}
+
+	// --- JPEG (ITU T.81, JFIF) -----------------------------------------
+
+	// Most significant bit first, stuffed zero bytes removed. Stops in front of a marker and
+	// reads zeros from there, the marker is left for the segment parser.
+	struct JPEGBits
+	{
+		const uint8_t* Data;
+		size_t Size;
+		size_t Position;
+		uint64_t Bits = 0;			// next bit at bit 63
+		uint32_t Count = 0;
+		bool AtMarker = false;
+
+		inline void Refill()
+		{
+			while (Count <= 56)
+			{
+				uint64_t byte = 0;
+				if (!AtMarker && Position < Size)
+				{
+					byte = Data[Position];
+					if (byte != 0xFF)
+						Position++;
+					else if (Position + 1 < Size && Data[Position + 1] == 0x00)
+						Position += 2;
+					else
+					{
+						AtMarker = true;
+						byte = 0;
+					}
+				}
+				Bits |= byte << (56 - Count);
+				Count += 8;
+			}
+		}
+
+		inline uint32_t Peek(uint32_t count) const { return (uint32_t)(Bits >> (64 - count)); }
+		inline void Skip(uint32_t count) { Bits <<= count; Count -= count; }
+
+		inline uint32_t Read(uint32_t count)
+		{
+			if (count == 0)
+				return 0;
+			if (Count < count)
+				Refill();
+			uint32_t value = Peek(count);
+			Skip(count);
+			return value;
+		}
+
+		// Drops the partial byte and continues behind the next marker, which has to be RSTn
+		bool Restart()
+		{
+			Bits = 0;
+			Count = 0;
+			AtMarker = false;
+			while (Position + 1 < Size && (Data[Position] != 0xFF || Data[Position + 1] == 0x00 || Data[Position + 1] == 0xFF))
+				Position++;
+			if (Position + 1 >= Size || Data[Position + 1] < 0xD0 || Data[Position + 1] > 0xD7)
+				return false;
+			Position += 2;
+			return true;
+		}
+	};
+
+	struct JPEGHuffman
+	{
+		static constexpr uint32_t FastBits = 9;
+
+		uint16_t Fast[1 << FastBits];	// length << 8 | value for codes of up to FastBits, 0 for longer ones
+		int32_t MaxCode[17];			// largest code of each length, -1 if there's none
+		int32_t ValueOffset[17];		// index of a length's first value minus its first code
+		uint8_t Values[256];
+		bool Defined = false;
+
+		bool Build(const uint8_t* counts, const uint8_t* values, uint32_t valueCount)
+		{
+			std::memcpy(Values, values, valueCount);
+			std::memset(Fast, 0, sizeof(Fast));
+
+			int32_t code = 0, index = 0;
+			for (uint32_t length = 1; length <= 16; length++)
+			{
+				ValueOffset[length] = index - code;
+				for (uint32_t i = 0; i < counts[length - 1]; i++, code++, index++)
+				{
+					// More codes than the length has room for
+					if (code >= (1 << length))
+						return false;
+					if (length <= FastBits)
+					{
+						uint32_t first = (uint32_t)code << (FastBits - length);
+						for (uint32_t entry = 0; entry < (1u << (FastBits - length)); entry++)
+							Fast[first + entry] = (uint16_t)(length << 8 | values[index]);
+					}
+				}
+				MaxCode[length] = counts[length - 1] ? code - 1 : -1;
+				code <<= 1;
+			}
+			Defined = true;
+			return true;
+		}
+
+		inline int32_t Decode(JPEGBits& bits) const
+		{
+			if (bits.Count < 16)
+				bits.Refill();
+
+			uint16_t entry = Fast[bits.Peek(FastBits)];
+			if (entry)
+			{
+				bits.Skip(entry >> 8);
+				return entry & 255;
+			}
+
+			// Shorter codes are all in the fast table, so a longer code is the first prefix
+			// that's in its length's range
+			for (uint32_t length = FastBits + 1; length <= 16; length++)
+			{
+				int32_t code = (int32_t)bits.Peek(length);
+				if (code <= MaxCode[length])
+				{
+					bits.Skip(length);
+					return Values[ValueOffset[length] + code];
+				}
+			}
+			return -1;
+		}
+	};
+
+	struct JPEGComponent
+	{
+		uint8_t Id;
+		uint32_t H, V;					// sampling factors
+		uint32_t Quant;
+		uint32_t DC, AC;				// Huffman tables of the current scan
+		int32_t Predictor;
+		uint32_t BlocksX, BlocksY;		// whole MCUs worth of blocks
+		uint32_t Width, Height;			// samples that cover the image
+		std::vector<uint8_t> Plane;		// BlocksX * 8 wide
+	};
+
+	struct JPEGDecoder
+	{
+		std::string_view Name;
+		const uint8_t* Data;
+		size_t Size;
+
+		uint16_t Quant[4][64] = {};		// zig-zag order
+		JPEGHuffman Huffman[2][4];		// DC, AC
+		std::vector<JPEGComponent> Components;
+		uint32_t Width = 0, Height = 0;
+		uint32_t MaxH = 1, MaxV = 1;
+		uint32_t McusX = 0, McusY = 0;
+		uint32_t RestartInterval = 0;
+		int32_t AdobeTransform = -1;
+		bool Frame = false;
+		bool Scanned = false;
+	};
+
+	static const uint8_t s_ZigZag[64] =
+	{
+		0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+		12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+		35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+		58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+	};
+
+	static inline int32_t ExtendSign(uint32_t value, uint32_t bits)
+	{
+		return bits && value < (1u << (bits - 1)) ? (int32_t)value - (1 << bits) + 1 : (int32_t)value;
+	}
+
+	// Separable, both passes as 8 lane matrix products with a transpose in between
+	static void InverseDCT(const float* coefficients, uint8_t* out, size_t stride)
+	{
+		using Float8 = SimdTraits<SimdDefault>::Float8;
+		static const std::array<float, 64> s_Basis = []()
+		{
+			// s_Basis[x * 8 + u] = C(u) / 2 * cos((2x + 1) u pi / 16)
+			std::array<float, 64> basis;
+			for (uint32_t x = 0; x < 8; x++)
+			{
+				for (uint32_t u = 0; u < 8; u++)
+					basis[x * 8 + u] = (float)((u == 0 ? std::sqrt(0.125) : 0.5) * std::cos((2 * x + 1) * u * 3.14159265358979323846 / 16.0));
+			}
+			return basis;
+		}();
+
+		Float8 rows[8];
+		for (uint32_t i = 0; i < 8; i++)
+			rows[i] = Float8::Load(coefficients + i * 8);
+
+		for (uint32_t pass = 0; pass < 2; pass++)
+		{
+			Float8 result[8];
+			for (uint32_t x = 0; x < 8; x++)
+			{
+				Float8 sum = rows[0] * Float8::Splat(s_Basis[x * 8]);
+				for (uint32_t u = 1; u < 8; u++)
+					sum = MulAdd(rows[u], Float8::Splat(s_Basis[x * 8 + u]), sum);
+				result[x] = sum;
+			}
+			Transpose8x8(result);
+			std::copy(result, result + 8, rows);
+		}
+
+		alignas(32) float samples[64];
+		for (uint32_t i = 0; i < 8; i++)
+			rows[i].Store(samples + i * 8);
+		for (uint32_t y = 0; y < 8; y++)
+		{
+			for (uint32_t x = 0; x < 8; x++)
+			{
+				float value = samples[y * 8 + x] + 128.5f;
+				out[y * stride + x] = (uint8_t)(value <= 0.0f ? 0.0f : (value >= 255.0f ? 255.0f : value));
+			}
+		}
+	}
+
+	static bool DecodeBlock(JPEGDecoder& decoder, JPEGBits& bits, JPEGComponent& component, uint32_t blockX, uint32_t blockY)
+	{
+		const JPEGHuffman& dc = decoder.Huffman[0][component.DC];
+		const JPEGHuffman& ac = decoder.Huffman[1][component.AC];
+		const uint16_t* quant = decoder.Quant[component.Quant];
+
+		int32_t size = dc.Decode(bits);
+		if (size < 0 || size > 15)
+			return false;
+		component.Predictor += ExtendSign(bits.Read((uint32_t)size), (uint32_t)size);
+
+		alignas(32) float coefficients[64] = {};
+		coefficients[0] = (float)component.Predictor * quant[0];
+		bool hasAC = false;
+		for (uint32_t k = 1; k < 64; )
+		{
+			int32_t symbol = ac.Decode(bits);
+			if (symbol < 0)
+				return false;
+
+			uint32_t run = (uint32_t)symbol >> 4, bitCount = (uint32_t)symbol & 15;
+			if (bitCount == 0)
+			{
+				// End of block, or a run of 16 zeros
+				if (run != 15)
+					break;
+				k += 16;
+				continue;
+			}
+
+			k += run;
+			if (k > 63)
+				return false;
+			coefficients[s_ZigZag[k]] = (float)ExtendSign(bits.Read(bitCount), bitCount) * quant[k];
+			hasAC = true;
+			k++;
+		}
+
+		uint8_t* out = &component.Plane[((size_t)blockY * 8 * component.BlocksX + blockX) * 8];
+		size_t stride = (size_t)component.BlocksX * 8;
+		if (hasAC)
+		{
+			InverseDCT(coefficients, out, stride);
+			return true;
+		}
+
+		// Flat blocks are common and don't need the transform
+		float value = coefficients[0] * 0.125f + 128.5f;
+		uint8_t flat = (uint8_t)(value <= 0.0f ? 0.0f : (value >= 255.0f ? 255.0f : value));
+		for (uint32_t y = 0; y < 8; y++)
+			std::memset(out + y * stride, flat, 8);
+		return true;
+	}
+
+	// Decodes the entropy coded data behind a SOS header at `offset`, returns where it ends
+	static bool DecodeScan(JPEGDecoder& decoder, const uint8_t* segment, uint32_t length, size_t& offset)
+	{
+		RE_PROFILE_FUNC();
+
+		uint32_t count = segment[0];
+		if (count == 0 || count > 4 || length != 4 + count * 2)
+			return Fail(decoder.Name, "JPEG", "broken SOS segment");
+		if (segment[1 + count * 2] != 0 || segment[2 + count * 2] != 63 || segment[3 + count * 2] != 0)
+			return Fail(decoder.Name, "JPEG", "spectral selection in a sequential scan");
+
+		std::vector<JPEGComponent*> scan;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			uint8_t id = segment[1 + i * 2], tables = segment[2 + i * 2];
+			auto component = std::find_if(decoder.Components.begin(), decoder.Components.end(), [id](const JPEGComponent& c) { return c.Id == id; });
+			if (component == decoder.Components.end() || (tables >> 4) > 3 || (tables & 15) > 3)
+				return Fail(decoder.Name, "JPEG", "scan of an unknown component");
+			component->DC = tables >> 4;
+			component->AC = tables & 15;
+			if (!decoder.Huffman[0][component->DC].Defined || !decoder.Huffman[1][component->AC].Defined)
+				return Fail(decoder.Name, "JPEG", "scan uses an undefined Huffman table");
+			component->Predictor = 0;
+			scan.push_back(&*component);
+		}
+
+		// Interleaved scans go MCU by MCU, a single component one block at a time over the
+		// blocks that cover the image
+		uint32_t unitsX = decoder.McusX, unitsY = decoder.McusY;
+		if (count == 1)
+		{
+			unitsX = (scan[0]->Width + 7) / 8;
+			unitsY = (scan[0]->Height + 7) / 8;
+		}
+
+		JPEGBits bits{ decoder.Data, decoder.Size, offset };
+		uint32_t untilRestart = decoder.RestartInterval;
+		for (uint32_t unitY = 0; unitY < unitsY; unitY++)
+		{
+			for (uint32_t unitX = 0; unitX < unitsX; unitX++)
+			{
+				if (decoder.RestartInterval && untilRestart-- == 0)
+				{
+					if (!bits.Restart())
+						return Fail(decoder.Name, "JPEG", "missing restart marker");
+					for (JPEGComponent* component : scan)
+						component->Predictor = 0;
+					untilRestart = decoder.RestartInterval - 1;
+				}
+
+				bool decoded = true;
+				if (count == 1)
+					decoded = DecodeBlock(decoder, bits, *scan[0], unitX, unitY);
+				for (uint32_t i = 0; i < count && count > 1 && decoded; i++)
+				{
+					JPEGComponent& component = *scan[i];
+					for (uint32_t y = 0; y < component.V && decoded; y++)
+					{
+						for (uint32_t x = 0; x < component.H && decoded; x++)
+							decoded = DecodeBlock(decoder, bits, component, unitX * component.H + x, unitY * component.V + y);
+					}
+				}
+				if (!decoded)
+					return Fail(decoder.Name, "JPEG", "corrupt scan data");
+			}
+		}
+
+		// Continue at the marker the scan stopped in front of
+		offset = bits.Position;
+		decoder.Scanned = true;
+		return true;
+	}
+
+	static bool ReadFrame(JPEGDecoder& decoder, const uint8_t* segment, uint32_t length)
+	{
+		if (decoder.Frame || length < 6 || segment[0] != 8)
+			return Fail(decoder.Name, "JPEG", decoder.Frame ? "more than one frame" : "only 8 bit samples are supported");
+
+		uint32_t height = ReadBigEndian16(segment + 1), width = ReadBigEndian16(segment + 3), count = segment[5];
+		if (height == 0)
+			return Fail(decoder.Name, "JPEG", "the height is defined by a DNL marker");
+		if ((count != 1 && count != 3) || length != 6 + count * 3)
+			return Fail(decoder.Name, "JPEG", count == 4 ? "CMYK images are not supported" : "broken SOF segment");
+
+		decoder.Width = width;
+		decoder.Height = height;
+		decoder.Components.resize(count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			JPEGComponent& component = decoder.Components[i];
+			component.Id = segment[6 + i * 3];
+			component.H = segment[7 + i * 3] >> 4;
+			component.V = segment[7 + i * 3] & 15;
+			component.Quant = segment[8 + i * 3];
+			if (component.H < 1 || component.H > 4 || component.V < 1 || component.V > 4 || component.Quant > 3)
+				return Fail(decoder.Name, "JPEG", "broken SOF segment");
+			decoder.MaxH = std::max(decoder.MaxH, component.H);
+			decoder.MaxV = std::max(decoder.MaxV, component.V);
+		}
+		if (width == 0 || width > ImageDecoder::MaxDimension || height > ImageDecoder::MaxDimension)
+			return Fail(decoder.Name, "JPEG", "unsupported image size");
+
+		decoder.McusX = (width + decoder.MaxH * 8 - 1) / (decoder.MaxH * 8);
+		decoder.McusY = (height + decoder.MaxV * 8 - 1) / (decoder.MaxV * 8);
+		for (JPEGComponent& component : decoder.Components)
+		{
+			component.BlocksX = decoder.McusX * component.H;
+			component.BlocksY = decoder.McusY * component.V;
+			component.Width = (width * component.H + decoder.MaxH - 1) / decoder.MaxH;
+			component.Height = (height * component.V + decoder.MaxV - 1) / decoder.MaxV;
+			component.Plane.assign((size_t)component.BlocksX * component.BlocksY * 64, 128);
+		}
+		decoder.Frame = true;
+		return true;
+	}
+
+	static bool ReadTables(JPEGDecoder& decoder, uint8_t marker, const uint8_t* segment, uint32_t length)
+	{
+		for (uint32_t at = 0; at < length; )
+		{
+			uint32_t precision = segment[at] >> 4, index = segment[at] & 15;
+			if (marker == 0xDB)
+			{
+				uint32_t tableSize = 1 + 64 * (precision + 1);
+				if (precision > 1 || index > 3 || length - at < tableSize)
+					return Fail(decoder.Name, "JPEG", "broken DQT segment");
+				for (uint32_t i = 0; i < 64; i++)
+					decoder.Quant[index][i] = precision ? ReadBigEndian16(segment + at + 1 + i * 2) : segment[at + 1 + i];
+				at += tableSize;
+				continue;
+			}
+
+			if (precision > 1 || index > 3 || length - at < 17)
+				return Fail(decoder.Name, "JPEG", "broken DHT segment");
+			const uint8_t* counts = segment + at + 1;
+			uint32_t valueCount = 0;
+			for (uint32_t i = 0; i < 16; i++)
+				valueCount += counts[i];
+			if (valueCount > 256 || length - at - 17 < valueCount || !decoder.Huffman[precision][index].Build(counts, counts + 16, valueCount))
+				return Fail(decoder.Name, "JPEG", "broken DHT segment");
+			at += 17 + valueCount;
+		}
+		return true;
+	}
+
+	// Bilinear between sample centers, for 2x the same as libjpeg's "fancy" upsampling.
+	// Weights are 8 bit fixed point.
+	struct UpsampleTap
+	{
+		uint32_t First, Second;
+		uint32_t Weight;		// of Second
+	};
+
+	static void GetUpsampleTaps(uint32_t outSize, uint32_t factor, uint32_t maxFactor, uint32_t inSize, std::vector<UpsampleTap>& taps)
+	{
+		taps.resize(outSize);
+		for (uint32_t i = 0; i < outSize; i++)
+		{
+			float position = std::max(0.0f, (i + 0.5f) * factor / maxFactor - 0.5f);
+			uint32_t first = std::min((uint32_t)position, inSize - 1);
+			taps[i] = { first, std::min(first + 1, inSize - 1), (uint32_t)((position - first) * 256.0f + 0.5f) };
+		}
+	}
+
+	static void ConvertJPEG(const JPEGDecoder& decoder, DecodedImage& image)
+	{
+		RE_PROFILE_FUNC();
+
+		const uint32_t width = decoder.Width, height = decoder.Height;
+		const size_t count = decoder.Components.size();
+		std::vector<UpsampleTap> tapsX[3], tapsY[3];
+		std::vector<uint8_t> rows[3];
+		std::vector<uint16_t> blended;
+		for (size_t i = 0; i < count; i++)
+		{
+			const JPEGComponent& component = decoder.Components[i];
+			GetUpsampleTaps(width, component.H, decoder.MaxH, component.Width, tapsX[i]);
+			GetUpsampleTaps(height, component.V, decoder.MaxV, component.Height, tapsY[i]);
+			rows[i].resize(width);
+		}
+
+		// Adobe's transform flag wins, otherwise 'R', 'G', 'B' component ids mean no YCbCr
+		bool rgb = count == 3 && (decoder.AdobeTransform == 0 || (decoder.AdobeTransform < 0
+			&& decoder.Components[0].Id == 'R' && decoder.Components[1].Id == 'G' && decoder.Components[2].Id == 'B'));
+
+		for (uint32_t y = 0; y < height; y++)
+		{
+			const uint8_t* samples[3];
+			for (size_t i = 0; i < count; i++)
+			{
+				const JPEGComponent& component = decoder.Components[i];
+				const size_t stride = (size_t)component.BlocksX * 8;
+				if (component.H == decoder.MaxH && component.V == decoder.MaxV)
+				{
+					samples[i] = &component.Plane[y * stride];
+					continue;
+				}
+
+				const UpsampleTap& tapY = tapsY[i][y];
+				const uint8_t* first = &component.Plane[tapY.First * stride];
+				const uint8_t* second = &component.Plane[tapY.Second * stride];
+				blended.resize(component.Width);
+				for (uint32_t x = 0; x < component.Width; x++)
+					blended[x] = (uint16_t)(first[x] * (256 - tapY.Weight) + second[x] * tapY.Weight);
+				for (uint32_t x = 0; x < width; x++)
+				{
+					const UpsampleTap& tapX = tapsX[i][x];
+					rows[i][x] = (uint8_t)((blended[tapX.First] * (256 - tapX.Weight) + blended[tapX.Second] * tapX.Weight + 32768) >> 16);
+				}
+				samples[i] = rows[i].data();
+			}
+
+			uint8_t* out = &image.Pixels[(size_t)y * width * 4];
+			for (uint32_t x = 0; x < width; x++, out += 4)
+			{
+				if (count == 1)
+				{
+					out[0] = out[1] = out[2] = samples[0][x];
+					continue;
+				}
+				if (rgb)
+				{
+					out[0] = samples[0][x];
+					out[1] = samples[1][x];
+					out[2] = samples[2][x];
+					continue;
+				}
+
+				// JFIF YCbCr, 16.16 fixed point
+				int32_t luma = samples[0][x] * 65536 + 32768;
+				int32_t cb = samples[1][x] - 128, cr = samples[2][x] - 128;
+				int32_t r = (luma + 91881 * cr) >> 16;
+				int32_t g = (luma - 22554 * cb - 46802 * cr) >> 16;
+				int32_t b = (luma + 116130 * cb) >> 16;
+				out[0] = (uint8_t)std::clamp(r, 0, 255);
+				out[1] = (uint8_t)std::clamp(g, 0, 255);
+				out[2] = (uint8_t)std::clamp(b, 0, 255);
+			}
+		}
+	}
+
+	bool ImageDecoder::DecodeJPEG(const uint8_t* data, size_t size, DecodedImage& image, std::string_view name)
+	{
+		RE_PROFILE_FUNC();
+
+		if (size < 4 || data[0] != 0xFF || data[1] != 0xD8)
+			return Fail(name, "JPEG", "no SOI marker");
+
+		std::unique_ptr<JPEGDecoder> decoder = std::make_unique<JPEGDecoder>();
+		decoder->Name = name;
+		decoder->Data = data;
+		decoder->Size = size;
+
+		for (size_t offset = 2; ; )
+		{
+			// Markers may be preceded by any number of 0xFF fill bytes
+			while (offset < size && data[offset] != 0xFF)
+				offset++;
+			while (offset < size && data[offset] == 0xFF)
+				offset++;
+			if (offset >= size && decoder->Scanned)
+				break;
+			if (offset >= size)
+				return Fail(name, "JPEG", "truncated");
+
+			uint8_t marker = data[offset++];
+			if (marker == 0xD9)
+				break;
+			if ((marker >= 0xD0 && marker <= 0xD7) || marker == 0x01)
+				continue;
+			if (size - offset < 2 || ReadBigEndian16(data + offset) < 2 || ReadBigEndian16(data + offset) > size - offset)
+				return Fail(name, "JPEG", "truncated");
+
+			uint32_t length = ReadBigEndian16(data + offset) - 2u;
+			const uint8_t* segment = data + offset + 2;
+			offset += 2 + (size_t)length;
+
+			bool valid = true;
+			switch (marker)
+			{
+				case 0xC0:
+				case 0xC1:
+					valid = ReadFrame(*decoder, segment, length);
+					break;
+				case 0xC2:
+				case 0xC6:
+				case 0xCA:
+				case 0xCE:
+					return Fail(name, "JPEG", "progressive JPEG is not supported, save it as baseline");
+				case 0xC3:
+				case 0xC5:
+				case 0xC7:
+				case 0xC9:
+				case 0xCB:
+				case 0xCD:
+				case 0xCF:
+					return Fail(name, "JPEG", "lossless, hierarchical and arithmetic coded JPEG are not supported");
+				case 0xC4:
+				case 0xDB:
+					valid = ReadTables(*decoder, marker, segment, length);
+					break;
+				case 0xDD:
+					if (length < 2)
+						return Fail(name, "JPEG", "broken DRI segment");
+					decoder->RestartInterval = ReadBigEndian16(segment);
+					break;
+				case 0xDA:
+					if (!decoder->Frame)
+						return Fail(name, "JPEG", "scan before the frame header");
+					valid = DecodeScan(*decoder, segment, length, offset);
+					break;
+				case 0xEE:
+					if (length >= 12 && std::memcmp(segment, "Adobe", 5) == 0)
+						decoder->AdobeTransform = segment[11];
+					break;
+			}
+			if (!valid)
+				return false;
+		}
+
+		if (!decoder->Scanned)
+			return Fail(name, "JPEG", "no image data");
+		if (!Allocate(image, decoder->Width, decoder->Height, name, "JPEG"))
+			return false;
+
+		ConvertJPEG(*decoder, image);
+		image.HasAlpha = false;
+		return true;
+	}
+
+	// --- TGA -----------------------------------------------------------
+
+	struct TGAHeader
+	{
+		uint32_t IdLength, ColorMapType, ImageType;
+		uint32_t ColorMapFirst, ColorMapLength, ColorMapDepth;
+		uint32_t Width, Height, Depth, Descriptor;
+
+		explicit TGAHeader(const uint8_t* data)
+			: IdLength(data[0]), ColorMapType(data[1]), ImageType(data[2]),
+			ColorMapFirst(ReadLittleEndian16(data + 3)), ColorMapLength(ReadLittleEndian16(data + 5)), ColorMapDepth(data[7]),
+			Width(ReadLittleEndian16(data + 12)), Height(ReadLittleEndian16(data + 14)), Depth(data[16]), Descriptor(data[17]) {}
+
+		bool IsPlausible() const
+		{
+			uint32_t type = ImageType & 7;
+			bool depth = type == 2 ? Depth == 15 || Depth == 16 || Depth == 24 || Depth == 32 : Depth == 8;
+			bool colorMap = type == 1 ? ColorMapType == 1 && (ColorMapDepth == 15 || ColorMapDepth == 16 || ColorMapDepth == 24 || ColorMapDepth == 32) : ColorMapType <= 1;
+			return type >= 1 && type <= 3 && (ImageType & ~11u) == 0 && Width && Height && depth && colorMap;
+		}
+	};
+
+	// A little endian 15/16/24/32 bit BGR(A) color to RGBA8
+	static inline void ConvertTGAColor(const uint8_t* color, uint32_t depth, bool attributeAlpha, uint8_t* out)
+	{
+		if (depth >= 24)
+		{
+			out[0] = color[2];
+			out[1] = color[1];
+			out[2] = color[0];
+			out[3] = depth == 32 ? color[3] : 255;
+			return;
+		}
+
+		uint32_t value = ReadLittleEndian16(color);
+		uint32_t r = (value >> 10) & 31, g = (value >> 5) & 31, b = value & 31;
+		out[0] = (uint8_t)(r << 3 | r >> 2);
+		out[1] = (uint8_t)(g << 3 | g >> 2);
+		out[2] = (uint8_t)(b << 3 | b >> 2);
+		out[3] = attributeAlpha && !(value & 0x8000) ? 0 : 255;
+	}
+
+	bool ImageDecoder::DecodeTGA(const uint8_t* data, size_t size, DecodedImage& image, std::string_view name)
+	{
+		RE_PROFILE_FUNC();
+
+		if (size < 18 || !TGAHeader(data).IsPlausible())
+			return Fail(name, "TGA", "unknown header");
+
+		const TGAHeader header(data);
+		const uint32_t type = header.ImageType & 7;
+		const bool rle = header.ImageType & 8;
+		const uint32_t pixelBytes = (header.Depth + 7) / 8;
+		const bool attributeAlpha = (header.Descriptor & 15) != 0;
+
+		size_t offset = 18 + header.IdLength;
+		std::vector<uint8_t> palette;
+		if (header.ColorMapType == 1)
+		{
+			// True color and grayscale images may carry a color map too, it's skipped
+			uint32_t entryBytes = (header.ColorMapDepth + 7) / 8;
+			size_t mapSize = (size_t)header.ColorMapLength * entryBytes;
+			if (offset > size || size - offset < mapSize)
+				return Fail(name, "TGA", "truncated");
+
+			if (type == 1)
+			{
+				palette.resize((size_t)header.ColorMapLength * 4);
+				for (uint32_t i = 0; i < header.ColorMapLength; i++)
+					ConvertTGAColor(data + offset + i * entryBytes, header.ColorMapDepth, attributeAlpha, &palette[i * 4]);
+			}
+			offset += mapSize;
+		}
+
+		if (!Allocate(image, header.Width, header.Height, name, "TGA"))
+			return false;
+
+		// Run length packets may cross rows, the pixels are unpacked as one stream first
+		const size_t pixelCount = (size_t)header.Width * header.Height;
+		std::vector<uint8_t> raw;
+		const uint8_t* pixels = data + offset;
+		if (rle)
+		{
+			raw.resize(pixelCount * pixelBytes);
+			size_t written = 0;
+			while (written < raw.size())
+			{
+				if (offset >= size)
+					return Fail(name, "TGA", "truncated");
+				uint32_t packet = data[offset++];
+				size_t run = ((packet & 127) + 1) * (size_t)pixelBytes;
+				size_t read = packet & 128 ? pixelBytes : run;
+				if (size - offset < read || raw.size() - written < run)
+					return Fail(name, "TGA", "corrupt run length data");
+
+				if (packet & 128)
+				{
+					for (size_t i = 0; i < run; i += pixelBytes)
+						std::memcpy(&raw[written + i], data + offset, pixelBytes);
+				}
+				else
+					std::memcpy(&raw[written], data + offset, run);
+				offset += read;
+				written += run;
+			}
+			pixels = raw.data();
+		}
+		else if (offset > size || size - offset < pixelCount * pixelBytes)
+			return Fail(name, "TGA", "truncated");
+
+		// Bottom to top unless descriptor bit 5 says otherwise, right to left with bit 4
+		const bool topDown = header.Descriptor & 32;
+		const bool rightToLeft = header.Descriptor & 16;
+		for (uint32_t y = 0; y < header.Height; y++)
+		{
+			const uint8_t* row = pixels + (size_t)y * header.Width * pixelBytes;
+			uint32_t imageY = topDown ? y : header.Height - 1 - y;
+			for (uint32_t x = 0; x < header.Width; x++)
+			{
+				const uint8_t* pixel = row + (size_t)x * pixelBytes;
+				uint32_t imageX = rightToLeft ? header.Width - 1 - x : x;
+				uint8_t* out = &image.Pixels[((size_t)imageY * header.Width + imageX) * 4];
+
+				if (type == 2)
+					ConvertTGAColor(pixel, header.Depth, attributeAlpha, out);
+				else if (type == 3)
+					out[0] = out[1] = out[2] = pixel[0];
+				else
+				{
+					uint32_t index = pixel[0] - header.ColorMapFirst;
+					if (pixel[0] < header.ColorMapFirst || index >= header.ColorMapLength)
+						return Fail(name, "TGA", "color index outside the color map");
+					std::memcpy(out, &palette[index * 4], 4);
+				}
+			}
+		}
+
+		FindAlpha(image);
+		return true;
+	}
+
+	// --- ImageDecoder --------------------------------------------------
+
+	ImageFileFormat ImageDecoder::DetectFormat(const uint8_t* data, size_t size)
+	{
+		if (size >= 8 && std::memcmp(data, "\x89PNG\r\n\x1A\n", 8) == 0)
+			return ImageFileFormat::PNG;
+		if (size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF)
+			return ImageFileFormat::JPEG;
+		if (size >= 18 && TGAHeader(data).IsPlausible())
+			return ImageFileFormat::TGA;
+		return ImageFileFormat::Unknown;
+	}
+
+	bool ImageDecoder::Decode(const uint8_t* data, size_t size, DecodedImage& image, std::string_view name)
+	{
+		switch (DetectFormat(data, size))
+		{
+			case ImageFileFormat::PNG:
+				return DecodePNG(data, size, image, name);
+			case ImageFileFormat::JPEG:
+				return DecodeJPEG(data, size, image, name);
+			case ImageFileFormat::TGA:
+				return DecodeTGA(data, size, image, name);
+			default:
+				RE_CORE_ERROR("ImageDecoder: can't decode {}, it's not a PNG, JPEG or TGA file", name);
+				return false;
+		}
+	}
+}
\ No newline at end of file
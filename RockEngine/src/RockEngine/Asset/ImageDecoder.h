@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace RockEngine
+{
+	enum class ImageFileFormat : uint8_t
+	{
+		Unknown = 0,
+		PNG,
+		JPEG,
+		TGA
+	};
+
+	// 8 bit RGBA, red in the lowest byte, rows top to bottom
+	struct DecodedImage
+	{
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		bool HasAlpha = false;		// some pixel isn't fully opaque
+		std::vector<uint8_t> Pixels;
+	};
+
+	// Decodes source art for the texture pipeline, from memory so the files can be mapped.
+	// Supported:
+	//   PNG	every color type and bit depth, palettes and tRNS, interlaced; 16 bit is cut to 8
+	//   JPEG	baseline and extended sequential Huffman, grayscale or YCbCr/RGB, any chroma
+	//			subsampling, restart intervals. Progressive and arithmetic coded files fail.
+	//   TGA	true color, grayscale and color mapped, raw or RLE, 8/15/16/24/32 bit
+	// Like Compression::DecompressLZ4 these never read or write out of bounds on corrupt input,
+	// they log what's wrong (prefixed with `name`) and return false.
+	class ImageDecoder
+	{
+	public:
+		// PNG and JPEG by their signature, TGA (which has none) by a plausible header
+		static ImageFileFormat DetectFormat(const uint8_t* data, size_t size);
+
+		static bool Decode(const uint8_t* data, size_t size, DecodedImage& image, std::string_view name);
+		static bool DecodePNG(const uint8_t* data, size_t size, DecodedImage& image, std::string_view name);
+		static bool DecodeJPEG(const uint8_t* data, size_t size, DecodedImage& image, std::string_view name);
+		static bool DecodeTGA(const uint8_t* data, size_t size, DecodedImage& image, std::string_view name);
+
+		// Larger images are rejected before anything is allocated for them
+		static constexpr uint32_t MaxDimension = 16384;
+	};
+}
\ No newline at end of file
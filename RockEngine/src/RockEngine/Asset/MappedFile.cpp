@@ -0,0 +1,136 @@
+#include "pch.h"
+#include "MappedFile.h"
+
+#ifndef RE_PLATFORM_WINDOWS
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace RockEngine
+{
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+#ifdef RE_PLATFORM_WINDOWS
+	bool MappedFile::Open(const std::string& path)
+	{
+		Close();
+
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			RE_CORE_ERROR("MappedFile: can't open {}", path);
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		HANDLE mapping = nullptr;
+		const void* data = nullptr;
+		if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+			mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping)
+			data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+		if (!data)
+		{
+			RE_CORE_ERROR("MappedFile: can't map {}", path);
+			if (mapping)
+				CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		m_File = file;
+		m_Mapping = mapping;
+		m_Data = static_cast<const uint8_t*>(data);
+		m_Size = (size_t)size.QuadPart;
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (!m_Data)
+			return;
+
+		UnmapViewOfFile(m_Data);
+		CloseHandle(m_Mapping);
+		CloseHandle(m_File);
+		m_Data = nullptr;
+		m_Size = 0;
+		m_File = nullptr;
+		m_Mapping = nullptr;
+	}
+
+	void MappedFile::Prefetch(size_t offset, size_t size) const
+	{
+		if (offset >= m_Size)
+			return;
+
+		WIN32_MEMORY_RANGE_ENTRY range = { const_cast<uint8_t*>(m_Data) + offset, std::min(size, m_Size - offset) };
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	}
+#else
+	bool MappedFile::Open(const std::string& path)
+	{
+		Close();
+
+		int file = open(path.c_str(), O_RDONLY);
+		if (file < 0)
+		{
+			RE_CORE_ERROR("MappedFile: can't open {}", path);
+			return false;
+		}
+
+		struct stat status;
+		void* data = MAP_FAILED;
+		if (fstat(file, &status) == 0 && status.st_size > 0)
+			data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		// The mapping keeps the file alive on its own
+		close(file);
+
+		if (data == MAP_FAILED)
+		{
+			RE_CORE_ERROR("MappedFile: can't map {}", path);
+			return false;
+		}
+
+		m_Data = static_cast<const uint8_t*>(data);
+		m_Size = (size_t)status.st_size;
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (!m_Data)
+			return;
+
+		munmap(const_cast<uint8_t*>(m_Data), m_Size);
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+
+	void MappedFile::Prefetch(size_t offset, size_t size) const
+	{
+		if (offset >= m_Size)
+			return;
+
+		// madvise wants a page aligned start
+		size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+		size_t start = offset & ~(pageSize - 1);
+		size_t end = std::min(offset + size, m_Size);
+		madvise(const_cast<uint8_t*>(m_Data) + start, end - start, MADV_WILLNEED);
+	}
+#endif
+
+	void MappedFile::Touch(const uint8_t* data, size_t size)
+	{
+		uint8_t sum = 0;
+		for (size_t offset = 0; offset < size; offset += 4096)
+			sum += *static_cast<const volatile uint8_t*>(data + offset);
+		(void)sum;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace RockEngine
+{
+	// A whole file mapped read-only into the address space. Pages are read in by the OS when
+	// they're first touched, so opening is cheap no matter how large the file is.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const std::string& path);
+		void Close();
+
+		// Hints that [offset, offset + size) is needed soon, the OS starts reading it in
+		void Prefetch(size_t offset, size_t size) const;
+		// Reads a byte of every page of a mapped range, so the calling (job) thread takes the page
+		// faults instead of whoever reads the data first
+		static void Touch(const uint8_t* data, size_t size);
+
+		inline bool IsOpen() const { return m_Data != nullptr; }
+		inline const uint8_t* GetData() const { return m_Data; }
+		inline size_t GetSize() const { return m_Size; }
+	private:
+		const uint8_t* m_Data = nullptr;
+		size_t m_Size = 0;
+#ifdef RE_PLATFORM_WINDOWS
+		void* m_File = nullptr;
+		void* m_Mapping = nullptr;
+#endif
+	};
+}
\ No newline at end of file
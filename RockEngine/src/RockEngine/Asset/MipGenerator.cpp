@@ -0,0 +1,222 @@
+#include "pch.h"
+#include "MipGenerator.h"
+
+#include <cmath>
+
+#include "RockEngine/Core/JobSystem.h"
+
+namespace RockEngine
+{
+	// Half-width of the Kaiser window in destination texels, and its shape
+	static constexpr double s_KaiserWidth = 2.0;
+	static constexpr double s_KaiserAlpha = 4.0;
+
+	// Smaller levels aren't worth splitting over the job system
+	static constexpr uint32_t s_ParallelPixels = 128 * 128;
+
+	struct ColorTables
+	{
+		float ToLinear[256];		// sRGB to linear
+		uint8_t ToSRGB[65536];		// linear in steps of 1/65535 to sRGB, fine enough to round trip every 8 bit value
+	};
+
+	static const ColorTables& GetColorTables()
+	{
+		static const std::unique_ptr<ColorTables> s_Tables = []()
+		{
+			std::unique_ptr<ColorTables> tables = std::make_unique<ColorTables>();
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				double value = i / 255.0;
+				tables->ToLinear[i] = (float)(value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4));
+			}
+			for (uint32_t i = 0; i < 65536; i++)
+			{
+				double value = i / 65535.0;
+				double srgb = value <= 0.0031308 ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+				tables->ToSRGB[i] = (uint8_t)(srgb * 255.0 + 0.5);
+			}
+			return tables;
+		}();
+		return *s_Tables;
+	}
+
+	static double BesselI0(double x)
+	{
+		double sum = 1.0, term = 1.0;
+		for (uint32_t k = 1; k < 32; k++)
+		{
+			term *= (x * 0.5 / k) * (x * 0.5 / k);
+			sum += term;
+		}
+		return sum;
+	}
+
+	// `x` in destination texels
+	static double KaiserWeight(double x)
+	{
+		if (std::abs(x) >= s_KaiserWidth)
+			return 0.0;
+
+		constexpr double pi = 3.14159265358979323846;
+		double t = x / s_KaiserWidth;
+		double window = BesselI0(s_KaiserAlpha * std::sqrt(1.0 - t * t)) / BesselI0(s_KaiserAlpha);
+		double sinc = x == 0.0 ? 1.0 : std::sin(pi * x) / (pi * x);
+		return sinc * window;
+	}
+
+	template<typename Func>
+	static void ForRows(uint32_t rows, uint32_t pixels, const Func& func)
+	{
+		if (pixels < s_ParallelPixels || JobSystem::GetWorkerCount() <= 1)
+			func(0u, rows);
+		else
+			JobSystem::ParallelFor(rows, JobSystem::GetDefaultGrainSize(rows, 4), func);
+	}
+
+	uint32_t MipGenerator::GetMipCount(uint32_t width, uint32_t height)
+	{
+		uint32_t count = 1;
+		for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+			count++;
+		return count;
+	}
+
+	ResampleTaps MipGenerator::GetTaps(uint32_t sourceSize, uint32_t destinationSize, MipFilter filter, bool wrap)
+	{
+		const double scale = (double)sourceSize / destinationSize;
+		std::vector<std::vector<std::pair<uint32_t, double>>> outputs(destinationSize);
+		uint32_t tapCount = 1;
+		for (uint32_t i = 0; i < destinationSize; i++)
+		{
+			// The source interval output i covers, or the window around its center
+			double center = (i + 0.5) * scale;
+			double begin = filter == MipFilter::Box ? i * scale : center - s_KaiserWidth * scale;
+			double end = filter == MipFilter::Box ? (i + 1) * scale : center + s_KaiserWidth * scale;
+
+			double total = 0.0;
+			for (int32_t j = (int32_t)std::floor(begin); j < (int32_t)std::ceil(end); j++)
+			{
+				double weight = filter == MipFilter::Box ? std::min(end, j + 1.0) - std::max(begin, (double)j) : KaiserWeight((j + 0.5 - center) / scale);
+				if (weight == 0.0)
+					continue;
+
+				int32_t size = (int32_t)sourceSize;
+				int32_t index = wrap ? ((j % size) + size) % size : std::clamp(j, 0, size - 1);
+				outputs[i].emplace_back((uint32_t)index, weight);
+				total += weight;
+			}
+
+			for (auto& tap : outputs[i])
+				tap.second /= total;
+			tapCount = std::max(tapCount, (uint32_t)outputs[i].size());
+		}
+
+		ResampleTaps taps;
+		taps.TapCount = tapCount;
+		taps.Indices.assign((size_t)destinationSize * tapCount, 0);
+		taps.Weights.assign((size_t)destinationSize * tapCount, 0.0f);
+		for (uint32_t i = 0; i < destinationSize; i++)
+		{
+			for (size_t tap = 0; tap < outputs[i].size(); tap++)
+			{
+				taps.Indices[i * tapCount + tap] = outputs[i][tap].first;
+				taps.Weights[i * tapCount + tap] = (float)outputs[i][tap].second;
+			}
+		}
+		return taps;
+	}
+
+	void MipGenerator::Generate(const uint8_t* pixels, uint32_t width, uint32_t height, MipFilter filter, bool srgb, bool wrap, std::vector<MipLevel>& levels)
+	{
+		RE_PROFILE_FUNC();
+
+		using Kernels = MipKernels<SimdDefault>;
+		const ColorTables& tables = GetColorTables();
+
+		bool alpha = false;
+		for (size_t i = 3; i < (size_t)width * height * 4 && !alpha; i += 4)
+			alpha = pixels[i] != 255;
+
+		// Level 0 stays 8 bit, it's decoded to linear (premultiplied) a row at a time
+		auto decodeRow = [&](uint32_t y, float* out)
+		{
+			const uint8_t* row = pixels + (size_t)y * width * 4;
+			for (uint32_t x = 0; x < width; x++, row += 4, out += 4)
+			{
+				float a = row[3] * (1.0f / 255.0f);
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					float value = srgb ? tables.ToLinear[row[c]] : row[c] * (1.0f / 255.0f);
+					out[c] = alpha ? value * a : value;
+				}
+				out[3] = a;
+			}
+		};
+
+		auto encodeRow = [&](const float* row, uint32_t count, uint8_t* out)
+		{
+			for (uint32_t x = 0; x < count; x++, row += 4, out += 4)
+			{
+				// Sharpening filters overshoot, everything is clamped
+				float a = std::clamp(row[3], 0.0f, 1.0f);
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					float value = alpha ? (a > 0.0f ? row[c] / a : 0.0f) : row[c];
+					value = std::clamp(value, 0.0f, 1.0f);
+					out[c] = srgb ? tables.ToSRGB[(uint32_t)(value * 65535.0f + 0.5f)] : (uint8_t)(value * 255.0f + 0.5f);
+				}
+				out[3] = (uint8_t)(a * 255.0f + 0.5f);
+			}
+		};
+
+		std::vector<float> current, horizontal, next;
+		uint32_t currentWidth = width, currentHeight = height;
+		const uint32_t mipCount = GetMipCount(width, height);
+		for (uint32_t level = 1; level < mipCount; level++)
+		{
+			const uint32_t nextWidth = std::max(1u, currentWidth / 2), nextHeight = std::max(1u, currentHeight / 2);
+			const ResampleTaps tapsX = GetTaps(currentWidth, nextWidth, filter, wrap);
+			const ResampleTaps tapsY = GetTaps(currentHeight, nextHeight, filter, wrap);
+
+			// Horizontal first, which halves what the vertical pass reads
+			horizontal.resize((size_t)nextWidth * currentHeight * 4);
+			ForRows(currentHeight, currentWidth * currentHeight, [&](uint32_t begin, uint32_t end)
+			{
+				std::vector<float> decoded(level == 1 ? (size_t)currentWidth * 4 : 0);
+				for (uint32_t y = begin; y < end; y++)
+				{
+					const float* source = decoded.data();
+					if (level == 1)
+						decodeRow(y, decoded.data());
+					else
+						source = &current[(size_t)y * currentWidth * 4];
+					Kernels::ResampleRow(source, &horizontal[(size_t)y * nextWidth * 4], tapsX, nextWidth);
+				}
+			});
+
+			next.resize((size_t)nextWidth * nextHeight * 4);
+			MipLevel& mip = levels.emplace_back();
+			mip.Width = nextWidth;
+			mip.Height = nextHeight;
+			mip.Pixels.resize((size_t)nextWidth * nextHeight * 4);
+			ForRows(nextHeight, nextWidth * currentHeight, [&](uint32_t begin, uint32_t end)
+			{
+				// Odd sizes scale by up to 3, a Kaiser window then spans 13 rows
+				const float* rows[16];
+				for (uint32_t y = begin; y < end; y++)
+				{
+					for (uint32_t tap = 0; tap < tapsY.TapCount; tap++)
+						rows[tap] = &horizontal[(size_t)tapsY.Indices[y * tapsY.TapCount + tap] * nextWidth * 4];
+					float* out = &next[(size_t)y * nextWidth * 4];
+					Kernels::BlendRows(rows, &tapsY.Weights[y * tapsY.TapCount], tapsY.TapCount, out, nextWidth * 4);
+					encodeRow(out, nextWidth, &mip.Pixels[(size_t)y * nextWidth * 4]);
+				}
+			});
+
+			current.swap(next);
+			currentWidth = nextWidth;
+			currentHeight = nextHeight;
+		}
+	}
+}
\ No newline at end of file
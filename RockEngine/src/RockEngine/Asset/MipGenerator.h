@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "RockEngine/Math/Simd.h"
+
+namespace RockEngine
+{
+	enum class MipFilter : uint8_t
+	{
+		Box = 0,		// average of the texels a mip texel covers, cheap and soft
+		Kaiser			// Kaiser windowed sinc, keeps detail a box blurs away
+	};
+
+	// How one axis is resampled: every output sample reads TapCount source samples with edges
+	// already resolved (clamped or wrapped), unused taps have weight 0
+	struct ResampleTaps
+	{
+		uint32_t TapCount = 0;
+		std::vector<uint32_t> Indices;		// of output i at [i * TapCount, (i + 1) * TapCount)
+		std::vector<float> Weights;			// summing to 1 per output
+	};
+
+	// The two passes of a separable downsample of linear float RGBA, templated on the SIMD
+	// backend like BatchKernels
+	template<typename Backend>
+	class MipKernels
+	{
+	public:
+		using Float4 = typename SimdTraits<Backend>::Float4;
+		using Float8 = typename SimdTraits<Backend>::Float8;
+
+		// Horizontal: one row of `taps` output pixels, a 4 lane register per pixel
+		static void ResampleRow(const float* source, float* destination, const ResampleTaps& taps, uint32_t width)
+		{
+			for (uint32_t x = 0; x < width; x++)
+			{
+				const uint32_t* indices = &taps.Indices[(size_t)x * taps.TapCount];
+				const float* weights = &taps.Weights[(size_t)x * taps.TapCount];
+				Float4 sum = Float4::Load(source + (size_t)indices[0] * 4) * Float4::Splat(weights[0]);
+				for (uint32_t tap = 1; tap < taps.TapCount; tap++)
+					sum = MulAdd(Float4::Load(source + (size_t)indices[tap] * 4), Float4::Splat(weights[tap]), sum);
+				sum.Store(destination + (size_t)x * 4);
+			}
+		}
+
+		// Vertical: destination = sum of weights[t] * rows[t], 8 floats at a time. `count` is
+		// a multiple of 4 (whole pixels).
+		static void BlendRows(const float* const* rows, const float* weights, uint32_t tapCount, float* destination, uint32_t count)
+		{
+			uint32_t i = 0;
+			for (; i + Float8::Width <= count; i += Float8::Width)
+			{
+				Float8 sum = Float8::Load(rows[0] + i) * Float8::Splat(weights[0]);
+				for (uint32_t tap = 1; tap < tapCount; tap++)
+					sum = MulAdd(Float8::Load(rows[tap] + i), Float8::Splat(weights[tap]), sum);
+				sum.Store(destination + i);
+			}
+			for (; i < count; i += 4)
+			{
+				Float4 sum = Float4::Load(rows[0] + i) * Float4::Splat(weights[0]);
+				for (uint32_t tap = 1; tap < tapCount; tap++)
+					sum = MulAdd(Float4::Load(rows[tap] + i), Float4::Splat(weights[tap]), sum);
+				sum.Store(destination + i);
+			}
+		}
+	};
+
+	// RGBA8, rows top to bottom
+	struct MipLevel
+	{
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		std::vector<uint8_t> Pixels;
+	};
+
+	// Builds mip chains gamma correctly: sRGB texels are decoded to linear light, filtered there
+	// (a box filter in sRGB space darkens every bright-dark edge) and encoded again. Color is
+	// weighted by alpha while filtering, so fully transparent texels don't bleed into their
+	// neighbours. Each level is filtered from the one above in float, rows split over the job system.
+	class MipGenerator
+	{
+	public:
+		// Down to 1x1, halving each side (rounding down, at least 1)
+		static uint32_t GetMipCount(uint32_t width, uint32_t height);
+
+		// Appends levels 1 to the last to `levels`, level 0 is `pixels` itself
+		static void Generate(const uint8_t* pixels, uint32_t width, uint32_t height, MipFilter filter, bool srgb, bool wrap, std::vector<MipLevel>& levels);
+
+		// `wrap` for tiling textures, otherwise edges are clamped
+		static ResampleTaps GetTaps(uint32_t sourceSize, uint32_t destinationSize, MipFilter filter, bool wrap);
+	};
+}
\ No newline at end of file
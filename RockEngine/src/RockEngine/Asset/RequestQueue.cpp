@@ -0,0 +1,147 @@
+#include "pch.h"
+#include "RequestQueue.h"
+
+namespace RockEngine
+{
+	bool RequestQueue::StartsBefore(const QueuedRequest* a, const QueuedRequest* b)
+	{
+		if (a->Priority != b->Priority)
+			return a->Priority > b->Priority;
+		return a->m_Sequence < b->m_Sequence;
+	}
+
+	void RequestQueue::Push(QueuedRequest* request)
+	{
+		request->m_RequestTime = Profiler::Now();
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		request->m_Sequence = m_Sequence++;
+		m_Queue.push_back(request);
+		std::push_heap(m_Queue.begin(), m_Queue.end(), HeapCompare);
+	}
+
+	void RequestQueue::PushCompleted(QueuedRequest* request)
+	{
+		request->m_RequestTime = Profiler::Now();
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		request->m_Sequence = m_Sequence++;
+		m_Completed.push_back(request);
+	}
+
+	QueuedRequest* RequestQueue::PopQueued()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_Queue.empty())
+			return nullptr;
+
+		std::pop_heap(m_Queue.begin(), m_Queue.end(), HeapCompare);
+		QueuedRequest* request = m_Queue.back();
+		m_Queue.pop_back();
+		m_InFlight++;
+		return request;
+	}
+
+	void RequestQueue::Start(QueuedRequest* request)
+	{
+		request->Prefetch();
+		JobSystem::Run([this, request]() { Execute(request); }, &m_Jobs);
+	}
+
+	void RequestQueue::Execute(QueuedRequest* request)
+	{
+		request->Execute();
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Completed.push_back(request);
+		m_InFlight--;
+	}
+
+	void RequestQueue::DispatchCompleted()
+	{
+		std::vector<QueuedRequest*> completed;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			completed.swap(m_Completed);
+		}
+
+		// Requests finish in any order, complete them in the order they'd have started in
+		std::sort(completed.begin(), completed.end(), StartsBefore);
+		for (QueuedRequest* request : completed)
+		{
+			request->Complete((float)((Profiler::Now() - request->m_RequestTime) / 1e6));
+			delete request;
+		}
+	}
+
+	void RequestQueue::Update(uint32_t maxInFlight, float inlineBudgetMs)
+	{
+		if (JobSystem::GetWorkerCount() > 1)
+		{
+			while (true)
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_Mutex);
+					if (m_InFlight >= maxInFlight)
+						break;
+				}
+
+				QueuedRequest* request = PopQueued();
+				if (!request)
+					break;
+				Start(request);
+			}
+		}
+		else
+		{
+			// Nobody else would ever pick the jobs up, execute here until the budget is spent
+			uint64_t start = Profiler::Now();
+			while ((Profiler::Now() - start) / 1e6 < inlineBudgetMs)
+			{
+				QueuedRequest* request = PopQueued();
+				if (!request)
+					break;
+				Execute(request);
+			}
+		}
+
+		DispatchCompleted();
+	}
+
+	void RequestQueue::Flush()
+	{
+		// Complete may queue more requests, keep going until nothing is left
+		while (true)
+		{
+			while (QueuedRequest* request = PopQueued())
+				Start(request);
+			JobSystem::Wait(m_Jobs);
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				if (m_Completed.empty() && m_Queue.empty())
+					break;
+			}
+			DispatchCompleted();
+		}
+	}
+
+	void RequestQueue::Clear()
+	{
+		JobSystem::Wait(m_Jobs);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (QueuedRequest* request : m_Queue)
+			delete request;
+		for (QueuedRequest* request : m_Completed)
+			delete request;
+		m_Queue.clear();
+		m_Completed.clear();
+	}
+
+	RequestQueueStats RequestQueue::GetStats() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return { (uint32_t)m_Queue.size(), m_InFlight, (uint32_t)m_Completed.size() };
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "RockEngine/Core/JobSystem.h"
+
+namespace RockEngine
+{
+	// One request of a RequestQueue. Execute does the work on a job thread, Complete hands
+	// the result over on the main thread.
+	class QueuedRequest
+	{
+	public:
+		virtual ~QueuedRequest() = default;
+
+		// On the main thread, right before the request is handed to the job system
+		virtual void Prefetch() {}
+		// On a job thread, or on the main thread when there are no workers
+		virtual void Execute() = 0;
+		// On the main thread during Update or Flush, `latencyMs` is request to now
+		virtual void Complete(float latencyMs) = 0;
+
+		// Higher starts first, first come first served within a priority
+		uint8_t Priority = 0;
+	private:
+		uint64_t m_Sequence = 0;
+		uint64_t m_RequestTime = 0;
+
+		friend class RequestQueue;
+	};
+
+	struct RequestQueueStats
+	{
+		uint32_t Queued;
+		uint32_t InFlight;
+		uint32_t Completed;		// waiting for Complete
+	};
+
+	// The request pipeline behind AssetStreamer and TextureImporter: requests are queued from
+	// any thread, Update starts the most important ones on the job system and completes the
+	// finished ones on the main thread, in the order they'd have started in.
+	class RequestQueue
+	{
+	public:
+		RequestQueue() = default;
+
+		RequestQueue(const RequestQueue&) = delete;
+		RequestQueue& operator=(const RequestQueue&) = delete;
+
+		// Thread safe, the queue owns the request from here on
+		void Push(QueuedRequest* request);
+		// Thread safe, for requests that fail up front: they complete without executing
+		void PushCompleted(QueuedRequest* request);
+
+		// Starts queued requests until `maxInFlight` run at once. Without worker threads they
+		// execute right here instead, for at most `inlineBudgetMs`.
+		void Update(uint32_t maxInFlight, float inlineBudgetMs);
+		// Runs every queued request to completion, including ones queued by Complete
+		void Flush();
+		// Waits for the running requests, drops the rest without completing them. Owners call
+		// it from their Shutdown, while the job system is still running.
+		void Clear();
+
+		RequestQueueStats GetStats() const;
+	private:
+		QueuedRequest* PopQueued();
+		void Start(QueuedRequest* request);
+		void Execute(QueuedRequest* request);
+		void DispatchCompleted();
+
+		static bool StartsBefore(const QueuedRequest* a, const QueuedRequest* b);
+		// std heaps keep the largest on top
+		static bool HeapCompare(const QueuedRequest* a, const QueuedRequest* b) { return StartsBefore(b, a); }
+	private:
+		// m_Queue is a heap, most important and then oldest request on top
+		mutable std::mutex m_Mutex;
+		std::vector<QueuedRequest*> m_Queue;
+		std::vector<QueuedRequest*> m_Completed;
+		uint64_t m_Sequence = 0;
+		uint32_t m_InFlight = 0;
+		JobCounter m_Jobs;
+	};
+}
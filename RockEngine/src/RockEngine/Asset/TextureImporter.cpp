@@ -0,0 +1,384 @@
+#include "pch.h"
+#include "TextureImporter.h"
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+#include "RockEngine/Asset/BlockCompression.h"
+#include "RockEngine/Asset/ImageDecoder.h"
+#include "RockEngine/Asset/RequestQueue.h"
+#include "RockEngine/Core/Hash.h"
+#include "RockEngine/Core/JobSystem.h"
+#include "RockEngine/Memory/LinearAllocator.h"
+#include "RockEngine/Memory/MemoryTracker.h"
+
+namespace RockEngine
+{
+	namespace fs = std::filesystem;
+
+	// {CacheDirectory}/{key:016x}.rtex: the header, a TextureMip per level and the mip data,
+	// DataAlignment aligned like the levels within it
+	struct TextureCacheHeader
+	{
+		static constexpr uint32_t MagicValue = 0x58455452;	// "RTEX"
+		// Also the pipeline version: bump it whenever decoding, filtering or encoding changes
+		// what an import produces, every existing entry then misses
+		static constexpr uint32_t CurrentVersion = 1;
+		static constexpr uint64_t DataAlignment = 16;
+
+		uint32_t Magic;
+		uint32_t Version;
+		uint64_t Key;
+		uint64_t FileSize;
+		uint32_t Format;
+		uint32_t MipCount;
+		uint64_t DataOffset;
+		uint64_t DataSize;
+	};
+
+	static_assert(sizeof(TextureCacheHeader) == 48 && sizeof(TextureMip) == 24, "Texture cache structs are written as they are");
+
+	// How long each stage of one import took
+	struct ImportTimes
+	{
+		float DecodeMs = 0.0f;
+		float MipMs = 0.0f;
+		float EncodeMs = 0.0f;
+	};
+
+	static TextureImporterProps s_Props;
+
+	static std::mutex s_StatsMutex;
+	static TextureImporterStats s_Stats = {};
+
+	// Names the temporary files entries are written to before they're renamed into place
+	static std::atomic<uint64_t> s_TempCounter{ 0 };
+
+	static RequestQueue s_Requests;
+
+	static float MsSince(uint64_t start)
+	{
+		return (float)((Profiler::Now() - start) / 1e6);
+	}
+
+	static uint64_t GetMipSize(TextureFormat format, uint32_t width, uint32_t height)
+	{
+		switch (format)
+		{
+		case TextureFormat::BC1:
+		case TextureFormat::BC1_SRGB:
+			return BlockCompression::GetSize(width, height, BlockCompression::BC1BlockSize);
+		case TextureFormat::BC3:
+		case TextureFormat::BC3_SRGB:
+			return BlockCompression::GetSize(width, height, BlockCompression::BC3BlockSize);
+		default:
+			return (uint64_t)width * height * 4;
+		}
+	}
+
+	static std::string GetCachePath(uint64_t key)
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.rtex", (unsigned long long)key);
+		return (fs::path(s_Props.CacheDirectory) / name).string();
+	}
+
+	// Anything that doesn't check out is a miss, the entry is then simply written again
+	static bool LoadCached(const std::string& path, uint64_t key, TextureData& texture)
+	{
+		RE_PROFILE_FUNC();
+
+		// Misses are the normal case on a first import, not worth MappedFile's error
+		std::error_code error;
+		if (!fs::is_regular_file(path, error))
+			return false;
+
+		std::unique_ptr<MappedFile> file = std::make_unique<MappedFile>();
+		if (!file->Open(path))
+			return false;
+
+		const uint8_t* data = file->GetData();
+		const uint64_t size = file->GetSize();
+		TextureCacheHeader header;
+		if (size < sizeof(header))
+			return false;
+		std::memcpy(&header, data, sizeof(header));
+
+		bool valid = header.Magic == TextureCacheHeader::MagicValue && header.Version == TextureCacheHeader::CurrentVersion
+			&& header.Key == key && header.FileSize == size && header.Format <= (uint32_t)TextureFormat::BC3_SRGB
+			&& header.MipCount >= 1 && header.MipCount <= 32
+			&& sizeof(header) + (uint64_t)header.MipCount * sizeof(TextureMip) <= header.DataOffset
+			&& header.DataOffset <= size && header.DataSize <= size - header.DataOffset;
+		if (!valid)
+		{
+			RE_CORE_WARN("TextureImporter: ignoring stale or damaged cache entry {}", path);
+			return false;
+		}
+
+		texture.Format = (TextureFormat)header.Format;
+		texture.Mips.resize(header.MipCount);
+		std::memcpy(texture.Mips.data(), data + sizeof(header), header.MipCount * sizeof(TextureMip));
+		for (const TextureMip& mip : texture.Mips)
+		{
+			if (mip.Offset > header.DataSize || mip.Size > header.DataSize - mip.Offset || mip.Size != GetMipSize(texture.Format, mip.Width, mip.Height))
+			{
+				RE_CORE_WARN("TextureImporter: ignoring stale or damaged cache entry {}", path);
+				return false;
+			}
+		}
+
+		const uint8_t* mipData = data + header.DataOffset;
+		MappedFile::Touch(mipData, (size_t)header.DataSize);
+
+		texture.Data = AssetData(mipData, (size_t)header.DataSize);
+		texture.File = std::move(file);
+		return true;
+	}
+
+	static bool WriteCached(const std::string& path, uint64_t key, const TextureData& texture)
+	{
+		RE_PROFILE_FUNC();
+
+		std::error_code error;
+		fs::create_directories(s_Props.CacheDirectory, error);
+
+		TextureCacheHeader header = {};
+		header.Magic = TextureCacheHeader::MagicValue;
+		header.Version = TextureCacheHeader::CurrentVersion;
+		header.Key = key;
+		header.Format = (uint32_t)texture.Format;
+		header.MipCount = (uint32_t)texture.Mips.size();
+		header.DataOffset = AlignUp(sizeof(header) + texture.Mips.size() * sizeof(TextureMip), TextureCacheHeader::DataAlignment);
+		header.DataSize = texture.Data.GetSize();
+		header.FileSize = header.DataOffset + header.DataSize;
+
+		// Written aside and renamed into place, so a crash or another process importing the same
+		// texture never leaves a half written entry behind
+		std::string temporary = path + "." + std::to_string(Profiler::Now()) + "-" + std::to_string(s_TempCounter++) + ".tmp";
+		{
+			std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+			const char padding[TextureCacheHeader::DataAlignment] = {};
+			uint64_t tableEnd = sizeof(header) + texture.Mips.size() * sizeof(TextureMip);
+			stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			stream.write(reinterpret_cast<const char*>(texture.Mips.data()), texture.Mips.size() * sizeof(TextureMip));
+			stream.write(padding, (std::streamsize)(header.DataOffset - tableEnd));
+			stream.write(reinterpret_cast<const char*>(texture.Data.GetData()), (std::streamsize)texture.Data.GetSize());
+			if (!stream)
+			{
+				RE_CORE_WARN("TextureImporter: can't write cache entry {}", temporary);
+				stream.close();
+				fs::remove(temporary, error);
+				return false;
+			}
+		}
+
+		fs::rename(temporary, path, error);
+		if (error)
+		{
+			RE_CORE_WARN("TextureImporter: can't write cache entry {}: {}", path, error.message());
+			fs::remove(temporary, error);
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(s_StatsMutex);
+		s_Stats.CacheBytesWritten += header.FileSize;
+		return true;
+	}
+
+	static bool Process(const uint8_t* source, size_t size, const std::string& path, const TextureImportSettings& settings, TextureData& texture, ImportTimes& times)
+	{
+		uint64_t start = Profiler::Now();
+		DecodedImage image;
+		if (!ImageDecoder::Decode(source, size, image, path))
+			return false;
+		times.DecodeMs = MsSince(start);
+
+		start = Profiler::Now();
+		std::vector<MipLevel> levels;
+		if (settings.Mips)
+			MipGenerator::Generate(image.Pixels.data(), image.Width, image.Height, settings.Filter, settings.SRGB, settings.Wrap, levels);
+		times.MipMs = MsSince(start);
+
+		TextureCompression compression = settings.Compression;
+		if (compression == TextureCompression::Auto)
+			compression = image.HasAlpha ? TextureCompression::BC3 : TextureCompression::BC1;
+		switch (compression)
+		{
+		case TextureCompression::BC1: texture.Format = settings.SRGB ? TextureFormat::BC1_SRGB : TextureFormat::BC1; break;
+		case TextureCompression::BC3: texture.Format = settings.SRGB ? TextureFormat::BC3_SRGB : TextureFormat::BC3; break;
+		default: texture.Format = settings.SRGB ? TextureFormat::RGBA8_SRGB : TextureFormat::RGBA8; break;
+		}
+
+		// One allocation for the whole chain, laid out exactly as in the cache file
+		uint64_t offset = 0;
+		texture.Mips.resize(levels.size() + 1);
+		for (size_t level = 0; level < texture.Mips.size(); level++)
+		{
+			TextureMip& mip = texture.Mips[level];
+			mip.Width = level ? levels[level - 1].Width : image.Width;
+			mip.Height = level ? levels[level - 1].Height : image.Height;
+			mip.Offset = offset;
+			mip.Size = GetMipSize(texture.Format, mip.Width, mip.Height);
+			offset = AlignUp(offset + mip.Size, TextureCacheHeader::DataAlignment);
+		}
+
+		start = Profiler::Now();
+		std::unique_ptr<uint8_t[]> buffer = std::make_unique<uint8_t[]>((size_t)offset);
+		for (size_t level = 0; level < texture.Mips.size(); level++)
+		{
+			const TextureMip& mip = texture.Mips[level];
+			const uint8_t* pixels = level ? levels[level - 1].Pixels.data() : image.Pixels.data();
+			uint8_t* out = buffer.get() + mip.Offset;
+			if (compression == TextureCompression::BC1)
+				BlockCompression::EncodeBC1(pixels, mip.Width, mip.Height, out);
+			else if (compression == TextureCompression::BC3)
+				BlockCompression::EncodeBC3(pixels, mip.Width, mip.Height, out);
+			else
+				std::memcpy(out, pixels, (size_t)mip.Size);
+			// Alignment padding is zeroed so equal imports give byte identical cache files
+			std::memset(out + mip.Size, 0, (size_t)(AlignUp(mip.Offset + mip.Size, TextureCacheHeader::DataAlignment) - mip.Offset - mip.Size));
+		}
+		times.EncodeMs = MsSince(start);
+
+		texture.Data = AssetData(std::move(buffer), (size_t)offset);
+		return true;
+	}
+
+	static TextureImportStatus ImportTexture(const std::string& path, const TextureImportSettings& settings, TextureData& texture)
+	{
+		RE_PROFILE_SCOPE("TextureImporter::Import");
+		RE_MEMORY_SCOPE("Assets");
+
+		MappedFile source;
+		TextureImportStatus status = TextureImportStatus::Failed;
+		ImportTimes times;
+		if (!source.Open(path))
+		{
+			RE_CORE_ERROR("TextureImporter: can't read {}", path);
+		}
+		else
+		{
+			const bool cache = !s_Props.CacheDirectory.empty();
+			const uint64_t key = TextureImporter::GetCacheKey(source.GetData(), source.GetSize(), settings);
+			const std::string cachePath = cache ? GetCachePath(key) : std::string();
+			if (cache && LoadCached(cachePath, key, texture))
+			{
+				status = TextureImportStatus::Cached;
+			}
+			else
+			{
+				texture = TextureData();
+				if (Process(source.GetData(), source.GetSize(), path, settings, texture, times))
+				{
+					status = TextureImportStatus::Imported;
+					if (cache)
+						WriteCached(cachePath, key, texture);
+				}
+				else
+				{
+					texture = TextureData();
+				}
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(s_StatsMutex);
+		switch (status)
+		{
+		case TextureImportStatus::Imported: s_Stats.Imported++; break;
+		case TextureImportStatus::Cached: s_Stats.CacheHits++; break;
+		case TextureImportStatus::Failed: s_Stats.Failed++; break;
+		}
+		s_Stats.DecodeMs += times.DecodeMs;
+		s_Stats.MipMs += times.MipMs;
+		s_Stats.EncodeMs += times.EncodeMs;
+		return status;
+	}
+
+	class ImportRequest : public QueuedRequest
+	{
+	public:
+		TextureImportResult Result;
+		TextureImportSettings Settings;
+		TextureImportCallback Callback;
+
+		void Execute() override
+		{
+			uint64_t start = Profiler::Now();
+			Result.Status = ImportTexture(Result.Path, Settings, Result.Texture);
+			Result.ImportMs = MsSince(start);
+		}
+
+		void Complete(float latencyMs) override
+		{
+			Result.LatencyMs = latencyMs;
+			if (Callback)
+				Callback(Result);
+		}
+	};
+
+	void TextureImporter::Init(const TextureImporterProps& props /* = TextureImporterProps() */)
+	{
+		s_Props = props;
+		s_Stats = {};
+	}
+
+	void TextureImporter::Shutdown()
+	{
+		s_Requests.Clear();
+	}
+
+	void TextureImporter::Import(const std::string& path, const TextureImportSettings& settings, TextureImportCallback callback)
+	{
+		RE_MEMORY_SCOPE("Assets");
+
+		ImportRequest* request = new ImportRequest();
+		request->Result.Path = path;
+		request->Result.Status = TextureImportStatus::Failed;
+		request->Result.ImportMs = 0.0f;
+		request->Settings = settings;
+		request->Callback = std::move(callback);
+		s_Requests.Push(request);
+	}
+
+	void TextureImporter::Update()
+	{
+		RE_PROFILE_FUNC();
+
+		// Every import splits its mips and blocks over the workers as well, one per worker is
+		// enough to keep them all busy
+		s_Requests.Update(s_Props.MaxInFlight ? s_Props.MaxInFlight : JobSystem::GetWorkerCount(), s_Props.InlineBudgetMs);
+	}
+
+	void TextureImporter::Flush()
+	{
+		RE_PROFILE_FUNC();
+		s_Requests.Flush();
+	}
+
+	TextureImportStatus TextureImporter::ImportNow(const std::string& path, const TextureImportSettings& settings, TextureData& texture)
+	{
+		return ImportTexture(path, settings, texture);
+	}
+
+	TextureImporterStats TextureImporter::GetStats()
+	{
+		RequestQueueStats requests = s_Requests.GetStats();
+		std::lock_guard<std::mutex> lock(s_StatsMutex);
+		TextureImporterStats stats = s_Stats;
+		stats.Queued = requests.Queued;
+		stats.InFlight = requests.InFlight;
+		stats.Completed = requests.Completed;
+		return stats;
+	}
+
+	uint64_t TextureImporter::GetCacheKey(const uint8_t* source, size_t size, const TextureImportSettings& settings)
+	{
+		uint64_t packed = (uint64_t)settings.SRGB | (uint64_t)settings.Mips << 1 | (uint64_t)settings.Wrap << 2
+			| (uint64_t)settings.Filter << 8 | (uint64_t)settings.Compression << 16;
+		uint64_t hash = HashBytes(source, size, TextureCacheHeader::CurrentVersion);
+		return HashBytes(&packed, sizeof(packed), hash);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "RockEngine/Asset/AssetStreamer.h"
+#include "RockEngine/Asset/MappedFile.h"
+#include "RockEngine/Asset/MipGenerator.h"
+
+namespace RockEngine
+{
+	enum class TextureFormat : uint8_t
+	{
+		RGBA8 = 0,
+		RGBA8_SRGB,
+		BC1,
+		BC1_SRGB,
+		BC3,
+		BC3_SRGB
+	};
+
+	enum class TextureCompression : uint8_t
+	{
+		None = 0,
+		BC1,
+		BC3,
+		Auto		// BC3 if any texel isn't opaque, BC1 otherwise
+	};
+
+	struct TextureImportSettings
+	{
+		bool SRGB = true;			// color data; false for normal maps, masks and other linear data
+		bool Mips = true;
+		MipFilter Filter = MipFilter::Kaiser;
+		bool Wrap = false;			// tiles, mips filter across the edges
+		TextureCompression Compression = TextureCompression::None;
+	};
+
+	struct TextureMip
+	{
+		uint32_t Width;
+		uint32_t Height;
+		uint64_t Offset;		// into TextureData::Data
+		uint64_t Size;
+	};
+
+	// Mip data ready to upload, largest level first, rows top to bottom. Cache hits point into
+	// the mapped cache file, which the texture keeps open.
+	struct TextureData
+	{
+		TextureFormat Format = TextureFormat::RGBA8;
+		std::vector<TextureMip> Mips;
+		AssetData Data;
+		std::unique_ptr<MappedFile> File;
+
+		inline const uint8_t* GetMipData(uint32_t level) const { return Data.GetData() + Mips[level].Offset; }
+	};
+
+	enum class TextureImportStatus : uint8_t
+	{
+		Imported = 0,	// decoded and processed, and written to the cache
+		Cached,			// loaded from the cache
+		Failed
+	};
+
+	struct TextureImportResult
+	{
+		std::string Path;
+		TextureImportStatus Status;
+		TextureData Texture;		// move it out to keep it past the callback
+		float ImportMs;				// on the job thread
+		float LatencyMs;			// request to callback
+	};
+
+	using TextureImportCallback = std::function<void(TextureImportResult& result)>;
+
+	struct TextureImporterProps
+	{
+		// Where processed textures are kept between runs, empty disables the cache
+		std::string CacheDirectory = "Cache/Textures";
+		// Imports running on the job system at once, 0 is one per worker
+		uint32_t MaxInFlight = 0;
+		// Without worker threads Update imports on the main thread, at most this long per frame
+		float InlineBudgetMs = 2.0f;
+	};
+
+	struct TextureImporterStats
+	{
+		uint32_t Queued;
+		uint32_t InFlight;
+		uint32_t Completed;			// waiting for their callback
+		uint64_t Imported;			// since Init
+		uint64_t CacheHits;
+		uint64_t Failed;
+		uint64_t CacheBytesWritten;
+		double DecodeMs;			// summed over all imports and threads
+		double MipMs;
+		double EncodeMs;
+	};
+
+	// Turns source images (PNG, JPEG, TGA) into mip chains, block compressed if asked to.
+	// Imports go through the same RequestQueue as AssetStreamer loads, in the order they were
+	// asked for: decoding, the mip levels and the block encoding are all split over the workers. The result is stored in a derived data
+	// cache keyed by a hash of the source bytes and the settings, so the next import of an
+	// unchanged file, in this run or the next, just maps the finished data.
+	class TextureImporter
+	{
+	public:
+		static void Init(const TextureImporterProps& props = TextureImporterProps());
+		// Waits for the running imports, drops the queued ones without calling back
+		static void Shutdown();
+
+		// Thread safe, called back like AssetStreamer::Load
+		static void Import(const std::string& path, const TextureImportSettings& settings, TextureImportCallback callback);
+
+		static void Update();
+		// Runs every queued import to completion and calls back, for loading screens and tools
+		static void Flush();
+
+		// Imports on the calling thread, for tools
+		static TextureImportStatus ImportNow(const std::string& path, const TextureImportSettings& settings, TextureData& texture);
+
+		static TextureImporterStats GetStats();
+
+		// Cache entries of an older pipeline version or other settings never match
+		static uint64_t GetCacheKey(const uint8_t* source, size_t size, const TextureImportSettings& settings);
+	};
+}
\ No newline at end of file
@@ -1,57 +1,253 @@
 #include "pch.h"
 #include "Application.h"
+#include <RockEngine/Asset/AssetHotReload.h>
+#include <RockEngine/Asset/AssetStreamer.h>
+#include <RockEngine/Asset/TextureImporter.h>
+#include <RockEngine/Renderer/RenderCapture.h>
 #include <RockEngine/Renderer/RendererAPI.h>
+#include <RockEngine/Renderer/Renderer2D.h>
+#include <RockEngine/Memory/FrameAllocator.h>
+#include <RockEngine/Memory/MemoryTracker.h>
+#include <RockEngine/Scene/TransformHierarchy.h>
 
 namespace RockEngine
 {
 	Application* Application::s_Instance = nullptr;
 
 	Application::Application(const ApplicationProps& props)
+		: m_Props(props), m_FrameTimer(props.Timing)
 	{
 		s_Instance = this;
-		m_Window = std::unique_ptr<Window>( Window::Create({ props.Name, props.WindowWidth, props.WindowHeight }));
+
+		if (m_Props.Window == WindowType::Headless && m_Props.Renderer == RendererAPIType::OpenGL)
+		{
+			RE_CORE_ERROR("OpenGL needs a window with a graphics context, falling back to the Null renderer");
+			m_Props.Renderer = RendererAPIType::Null;
+		}
+
+		{
+			RE_MEMORY_SCOPE("Window");
+			m_Window = std::unique_ptr<Window>( Window::Create({ m_Props.Name, m_Props.WindowWidth, m_Props.WindowHeight }, m_Props.Window));
+			m_Window->SetEventQueue(&m_EventQueue);
+			m_Window->SetVSync(m_Props.Timing.VSync);
+		}
+		{
+			RE_MEMORY_SCOPE("Renderer");
+			RendererAPI::Init(m_Props.Renderer);
+			RendererAPI::GetBackend().Resize(m_Props.WindowWidth, m_Props.WindowHeight);
+			Renderer2D::Init();
+			if (!m_Props.CapturePath.empty())
+				RenderCapture::Begin(m_Props.CapturePath, m_Props.CaptureFrames, m_Props.WindowWidth, m_Props.WindowHeight, m_Props.Renderer);
+		}
+		AssetStreamer::Init();
+		TextureImporterProps textureProps;
+		textureProps.CacheDirectory = m_Props.TextureCacheDirectory;
+		TextureImporter::Init(textureProps);
+		if (!m_Props.HotReloadDirectory.empty())
+		{
+			AssetHotReloadProps hotReloadProps;
+			hotReloadProps.Directory = m_Props.HotReloadDirectory;
+			AssetHotReload::Init(hotReloadProps);
+		}
 
 		m_ImGuiLayer = new ImGuiLayer("ImGuiLayer");
-		PushLayer(m_ImGuiLayer);
+		m_ImGuiLayer->SetIdleProps(m_Props.IdleUI);
+		PushOverlay(m_ImGuiLayer);
 	}
 
 	Application::~Application()
 	{
+		// Callbacks may point into layers, pending loads are dropped before those go away
+		AssetHotReload::Shutdown();
+		TextureImporter::Shutdown();
+		AssetStreamer::Shutdown();
+
 		for (Layer* layer : m_LayerStack)
 			layer->OnDetach();
+
+		RenderCapture::End();
+		Renderer2D::Shutdown();
+		RendererAPI::Shutdown();
+
+#ifdef RE_ENABLE_MEMORY_TRACKING
+		MemoryTracker::WriteReport("RockEngine-memory.json");
+#endif
 	}
 
 	void Application::Run()
 	{
 		OnInit();
+
+		if (m_Props.RenderThread)
+		{
+			m_RenderThread = std::make_unique<RenderThread>(*m_Window, RendererAPI::GetBackend(), m_ImGuiLayer, RenderThreadProps{ m_Props.FramesInFlight });
+			m_RenderThread->Start();
+		}
+
 		while (m_Running)
 		{
-			for (Layer* layer : m_LayerStack)
-				layer->OnUpdate();
-			RenderImGui();
-			m_Window->OnUpdate();
+			m_FrameTimer.BeginFrame();
+			Profiler::BeginFrame();
+			uint64_t frameStart = Profiler::Now();
+			FrameAllocator::BeginFrame();
+			Renderer2D::BeginFrame();
+			m_LayerStack.BeginFrame();
+			DispatchEvents();
+			AssetStreamer::Update();
+			TextureImporter::Update();
+			// Frame boundary: reloaded assets are swapped in before anything of this frame uses them
+			AssetHotReload::Update();
 			RendererAPI::Clear(0.2f, 0.3f, 0.8f, 1);
+			{
+				RE_PROFILE_SCOPE("Application::FixedUpdate");
+				while (m_FrameTimer.StepFixed())
+					m_LayerStack.FixedUpdate(m_FrameTimer.GetFixedTimestep());
+			}
+			{
+				RE_PROFILE_SCOPE("Application::Update");
+				m_LayerStack.Update(m_FrameTimer.GetTimestep());
+			}
+			TransformSystem::Update();
+			JobSystem::Wait(m_FrameJobs);
+			Present(frameStart);
+			m_LayerStack.EndFrame();
+#ifdef RE_ENABLE_MEMORY_TRACKING
+			MemoryTracker::EndFrame();
+#endif
+			Profiler::EndFrame();
+
+			if (++m_FrameCount == m_Props.FrameLimit)
+				Close();
+
+			m_FrameTimer.Pace(GetTargetFrameRate());
+		}
+
+		if (m_RenderThread)
+		{
+			m_RenderThread->Stop();
+			m_RenderThread.reset();
 		}
 	}
 
+	void Application::Present(uint64_t frameStart)
+	{
+		if (!m_RenderThread)
+		{
+			{
+				// Layers and frame jobs record, the sorted stream runs here under ImGui
+				RE_PROFILE_SCOPE("RendererAPI::Flush");
+				RE_MEMORY_SCOPE("Renderer");
+				RendererAPI::Flush();
+			}
+			RenderImGui();
+			{
+				RE_PROFILE_SCOPE("Window::OnUpdate");
+				RE_MEMORY_SCOPE("Window");
+				m_Window->OnUpdate();
+			}
+			return;
+		}
+
+		// ImGui is built here, drawn and swapped on the render thread
+		RenderImGui();
+		{
+			RE_PROFILE_SCOPE("Application::SubmitFramePacket");
+			RE_MEMORY_SCOPE("Renderer");
+			FramePacket& packet = m_RenderThread->BeginPacket();
+			packet.Frame = m_FrameCount;
+			packet.FrameStart = frameStart;
+			RendererAPI::Flush(packet.Commands);
+			m_ImGuiLayer->CaptureDrawData(packet.UI);
+			m_RenderThread->SubmitPacket();
+		}
+		{
+			RE_PROFILE_SCOPE("Window::PollEvents");
+			RE_MEMORY_SCOPE("Window");
+			m_Window->PollEvents();
+		}
+	}
+
+	float Application::GetTargetFrameRate() const
+	{
+		const FrameTimingProps& timing = m_FrameTimer.GetProps();
+		float rate = timing.MaxFrameRate;
+
+		// A minimized window doesn't block in SwapBuffers, without this we'd spin a full core
+		float background = 0.0f;
+		if (m_Window->IsMinimized())
+			background = timing.MinimizedFrameRate;
+		else if (!m_Window->IsFocused())
+			background = timing.UnfocusedFrameRate;
+
+		if (background > 0.0f && (rate <= 0.0f || background < rate))
+			rate = background;
+		return rate;
+	}
+
+	void Application::Close()
+	{
+		m_Running = false;
+	}
+
 	void Application::PushLayer(Layer* layer)
 	{
 		m_LayerStack.PushLayer(layer);
-		layer->OnAttach();
+	}
+
+	void Application::PushOverlay(Layer* layer)
+	{
+		m_LayerStack.PushOverlay(layer);
 	}
 
 	void Application::PopLayer(Layer* layer)
 	{
 		m_LayerStack.PopLayer(layer);
-		layer->OnDetach();
+	}
+
+	void Application::DispatchEvents()
+	{
+		RE_PROFILE_FUNC();
+
+		constexpr uint32_t batchSize = 256;
+		Event batch[batchSize];
+
+		// Whatever producers push while we drain waits for the next frame
+		uint32_t remaining = m_EventQueue.GetCapacity();
+		while (remaining > 0)
+		{
+			uint32_t count = m_EventQueue.PopBatch(batch, std::min(batchSize, remaining));
+			if (count == 0)
+				break;
+			remaining -= count;
+
+			m_LayerStack.DispatchEvents(batch, count);
+			for (uint32_t i = 0; i < count; i++)
+			{
+				if (batch[i].Type == EventType::WindowClose)
+					Close();
+			}
+		}
 	}
 
 	void Application::RenderImGui()
 	{
+		RE_PROFILE_SCOPE("Application::RenderImGui");
+
+		// Nothing changed since the last UI frame: no layer runs, its draw data is presented again
+		if (!m_ImGuiLayer->ShouldBuildFrame())
+		{
+			m_ImGuiLayer->SkipFrame();
+			return;
+		}
+
 		m_ImGuiLayer->Begin();
 
 		for (Layer* layer : m_LayerStack)
+		{
+			RE_PROFILE_SCOPE(layer->GetName().c_str());
+			RE_MEMORY_SCOPE_DYNAMIC(layer->GetName().c_str());
 			layer->OnImGuiRender();
+		}
 
 		m_ImGuiLayer->End();
 	}
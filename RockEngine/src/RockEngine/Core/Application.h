@@ -3,16 +3,55 @@
 #include <string>
 
 #include "RockEngine/Core/Core.h"
+#include "RockEngine/Core/FrameTimer.h"
+#include "RockEngine/Core/JobSystem.h"
 #include "RockEngine/Core/LayerStack.h"
 #include <RockEngine/Core/Window.h>
+#include <RockEngine/Events/EventQueue.h>
 
 #include <RockEngine/ImGui/ImGuiLayer.h>
+#include <RockEngine/Renderer/RendererBackend.h>
+#include <RockEngine/Renderer/RenderThread.h>
 
 namespace RockEngine
 {
 	struct ApplicationProps {
 		uint32_t WindowWidth, WindowHeight;
 		std::string Name;
+
+		WindowType Window = WindowType::GLFW;
+		RendererAPIType Renderer = RendererAPIType::OpenGL;
+
+		// Run() returns after this many frames, 0 runs until Close()
+		uint64_t FrameLimit = 0;
+
+		// Fixed timestep, frame rate cap, vsync and background throttling
+		FrameTimingProps Timing;
+
+		// Present from a dedicated render thread, overlapping the next frame's update
+		bool RenderThread = false;
+		uint32_t FramesInFlight = 2;
+
+		// Records the command streams of the first CaptureFrames frames to this file, for RockReplay
+		std::string CapturePath;
+		uint32_t CaptureFrames = 60;
+
+		// Skip building the UI while nothing changes, see ImGuiIdleProps
+		ImGuiIdleProps IdleUI;
+
+		// Watches this directory and swaps in reprocessed assets between frames, see AssetHotReload
+		std::string HotReloadDirectory;
+
+		// Derived data cache of TextureImporter, empty disables it
+		std::string TextureCacheDirectory = "Cache/Textures";
+	};
+
+	struct ApplicationCommandLineArgs
+	{
+		int Count = 0;
+		char** Args = nullptr;
+
+		const char* operator[](int index) const { return Args[index]; }
 	};
 
 	class Application
@@ -27,21 +66,49 @@ namespace RockEngine
 
 		void RenderImGui();
 
+		// Safe to call from a layer during the frame, the change is applied once the frame ends
 		void PushLayer(Layer* layer);
+		void PushOverlay(Layer* layer);
 		void PopLayer(Layer* layer);
 
 		virtual void Run();
+		void Close();
+
+		// Returned from main once Run() ends
+		void SetExitCode(int exitCode) { m_ExitCode = exitCode; }
+		inline int GetExitCode() const { return m_ExitCode; }
 
 		inline Window& GetWindow() { return *m_Window; }
+		inline EventQueue& GetEventQueue() { return m_EventQueue; }
+		// Null unless ApplicationProps::RenderThread is set and Run() is running
+		inline RenderThread* GetRenderThread() { return m_RenderThread.get(); }
+		inline const ApplicationProps& GetProps() const { return m_Props; }
+		inline uint64_t GetFrameCount() const { return m_FrameCount; }
+		inline FrameTimer& GetFrameTimer() { return m_FrameTimer; }
+		inline ImGuiLayer& GetImGuiLayer() { return *m_ImGuiLayer; }
+
+		// Jobs attached to this counter are waited on before the frame's render commands are flushed
+		inline JobCounter& GetFrameJobs() { return m_FrameJobs; }
 		inline static Application& Get() { return *s_Instance; }
 	private:
+		void DispatchEvents();
+		void Present(uint64_t frameStart);
+		float GetTargetFrameRate() const;
+	private:
+		ApplicationProps m_Props;
 		std::unique_ptr<Window> m_Window;
+		EventQueue m_EventQueue;
+		std::unique_ptr<RenderThread> m_RenderThread;
 		LayerStack m_LayerStack;
 		bool m_Running = true;
+		int m_ExitCode = 0;
+		uint64_t m_FrameCount = 0;
+		FrameTimer m_FrameTimer;
+		JobCounter m_FrameJobs;
 		ImGuiLayer* m_ImGuiLayer;
 		static Application* s_Instance;
 	};
 
 	//Iml. by client
-	Application* CreateApplication();
+	Application* CreateApplication(ApplicationCommandLineArgs args);
 }
\ No newline at end of file
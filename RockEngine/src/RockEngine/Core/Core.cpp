@@ -1,10 +1,25 @@
 #include "pch.h"
 #include "Core.h"
+#include "JobSystem.h"
+#include "RockEngine/Memory/FrameAllocator.h"
+#include "RockEngine/Memory/PoolAllocator.h"
 
 namespace RockEngine
 {
 	void InitializeCore()
 	{
 		RockEngine::Log::Init();
+		RockEngine::Profiler::Init();
+		RockEngine::FrameAllocator::Init();
+		RockEngine::JobSystem::Init();
+	}
+
+	void ShutdownCore()
+	{
+		RockEngine::JobSystem::Shutdown();
+		RockEngine::FrameAllocator::Shutdown();
+		RockEngine::SmallObjectAllocator::Shutdown();
+		RockEngine::Profiler::Shutdown();
+		RockEngine::Log::Shutdown();
 	}
 }
\ No newline at end of file
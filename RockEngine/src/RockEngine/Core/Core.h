@@ -5,6 +5,7 @@
 namespace RockEngine
 {
 	void InitializeCore();
+	void ShutdownCore();
 }
 
 
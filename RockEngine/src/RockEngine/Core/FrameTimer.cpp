@@ -0,0 +1,109 @@
+#include "pch.h"
+#include "FrameTimer.h"
+
+#include <cmath>
+#include <thread>
+
+namespace RockEngine
+{
+	FrameTimer::FrameTimer(const FrameTimingProps& props)
+		: m_Props(props)
+	{
+	}
+
+	Timestep FrameTimer::BeginFrame()
+	{
+		uint64_t now = Profiler::Now();
+		if (m_FrameStart == 0)
+		{
+			// First frame, pretend it took exactly one fixed step
+			m_FrameStart = now - (uint64_t)(m_Props.FixedTimestep * 1e9);
+		}
+
+		double delta = (now - m_FrameStart) / 1e9;
+		m_FrameStart = now;
+
+		m_History[m_HistoryOffset] = (float)(delta * 1000.0);
+		m_HistoryOffset = (m_HistoryOffset + 1) % HistorySize;
+		m_HistoryCount = std::min(m_HistoryCount + 1, HistorySize);
+
+		m_DeltaTime = (float)std::min(delta, (double)m_Props.MaxDeltaTime);
+		m_Accumulator += m_DeltaTime;
+		m_FixedSteps = 0;
+		return Timestep(m_DeltaTime);
+	}
+
+	bool FrameTimer::StepFixed()
+	{
+		if (m_Props.FixedTimestep <= 0.0f || m_Accumulator < m_Props.FixedTimestep)
+			return false;
+
+		if (m_FixedSteps == m_Props.MaxFixedSteps)
+		{
+			uint64_t dropped = (uint64_t)(m_Accumulator / m_Props.FixedTimestep);
+			m_DroppedFixedSteps += dropped;
+			m_Accumulator -= dropped * (double)m_Props.FixedTimestep;
+			return false;
+		}
+
+		m_Accumulator -= m_Props.FixedTimestep;
+		m_FixedSteps++;
+		return true;
+	}
+
+	Timestep FrameTimer::GetTimestep() const
+	{
+		if (m_Props.FixedTimestep <= 0.0f)
+			return Timestep(m_DeltaTime);
+		return Timestep(m_DeltaTime, (float)(m_Accumulator / m_Props.FixedTimestep));
+	}
+
+	void FrameTimer::Pace(float frameRate)
+	{
+		if (frameRate <= 0.0f)
+			return;
+
+		RE_PROFILE_FUNC();
+		uint64_t target = m_FrameStart + (uint64_t)(1e9 / frameRate);
+		for (uint64_t now = Profiler::Now(); now < target; now = Profiler::Now())
+		{
+			double margin = m_SleepMean + std::sqrt(m_SleepM2 / m_SleepCount);
+			if (target - now > margin)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				double observed = (double)(Profiler::Now() - now);
+
+				m_SleepCount++;
+				double delta = observed - m_SleepMean;
+				m_SleepMean += delta / m_SleepCount;
+				m_SleepM2 += delta * (observed - m_SleepMean);
+			}
+			else
+			{
+				// Close enough that a sleep would likely overshoot
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void FrameTimer::GetStats(FrameTimeStats& stats) const
+	{
+		stats = FrameTimeStats();
+		stats.Samples = m_HistoryCount;
+		if (m_HistoryCount == 0)
+			return;
+
+		std::array<float, HistorySize> sorted;
+		std::copy(m_History.begin(), m_History.begin() + m_HistoryCount, sorted.begin());
+		std::sort(sorted.begin(), sorted.begin() + m_HistoryCount);
+
+		float total = 0.0f;
+		for (uint32_t i = 0; i < m_HistoryCount; i++)
+			total += sorted[i];
+
+		stats.AverageMs = total / m_HistoryCount;
+		stats.P50Ms = sorted[(m_HistoryCount - 1) / 2];
+		stats.P99Ms = sorted[(m_HistoryCount - 1) * 99 / 100];
+		stats.MaxMs = sorted[m_HistoryCount - 1];
+	}
+}
\ No newline at end of file
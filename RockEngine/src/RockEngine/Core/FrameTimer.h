@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "RockEngine/Core/Timestep.h"
+
+namespace RockEngine
+{
+	struct FrameTimingProps
+	{
+		float FixedTimestep = 1.0f / 60.0f;	// seconds, 0 disables Layer::OnFixedUpdate
+		uint32_t MaxFixedSteps = 5;			// per frame, older backlog is dropped instead of spiralling
+		float MaxDeltaTime = 0.25f;			// clamps hitches (breakpoints, window drags)
+
+		float MaxFrameRate = 0.0f;			// 0 = uncapped
+		float UnfocusedFrameRate = 30.0f;	// 0 = don't throttle
+		float MinimizedFrameRate = 10.0f;
+		bool VSync = true;					// initial state, toggle later through Window::SetVSync
+	};
+
+	struct FrameTimeStats
+	{
+		float AverageMs = 0.0f;
+		float P50Ms = 0.0f;
+		float P99Ms = 0.0f;
+		float MaxMs = 0.0f;
+		uint32_t Samples = 0;
+	};
+
+	// Measures the time between frames (including pacing and vsync waits, unlike the
+	// profiler's frame time), feeds the fixed-step accumulator and caps the frame rate.
+	class FrameTimer
+	{
+	public:
+		static constexpr uint32_t HistorySize = 256;
+
+		FrameTimer(const FrameTimingProps& props = FrameTimingProps());
+
+		// Starts a frame and returns its clamped delta time
+		Timestep BeginFrame();
+
+		// True while another fixed step is due this frame, call in a loop before the variable update
+		bool StepFixed();
+		Timestep GetFixedTimestep() const { return Timestep(m_Props.FixedTimestep); }
+		// Delta time with the interpolation alpha left over after the fixed steps
+		Timestep GetTimestep() const;
+
+		// Waits until 1 / frameRate seconds have passed since the last BeginFrame. Sleeps for
+		// most of it and spins the rest, the sleep margin adapts to how much the OS oversleeps.
+		void Pace(float frameRate);
+
+		void GetStats(FrameTimeStats& stats) const;
+
+		inline const FrameTimingProps& GetProps() const { return m_Props; }
+		inline void SetProps(const FrameTimingProps& props) { m_Props = props; }
+		inline uint64_t GetDroppedFixedSteps() const { return m_DroppedFixedSteps; }
+	private:
+		FrameTimingProps m_Props;
+
+		uint64_t m_FrameStart = 0;
+		float m_DeltaTime = 0.0f;
+		double m_Accumulator = 0.0;
+		uint32_t m_FixedSteps = 0;
+		uint64_t m_DroppedFixedSteps = 0;
+
+		// Running estimate of how long a 1 ms sleep really takes (Welford)
+		double m_SleepMean = 1e6;
+		double m_SleepM2 = 0.0;
+		uint64_t m_SleepCount = 1;
+
+		std::array<float, HistorySize> m_History = {};
+		uint32_t m_HistoryOffset = 0;
+		uint32_t m_HistoryCount = 0;
+	};
+}
\ No newline at end of file
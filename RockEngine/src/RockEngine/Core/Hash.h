@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace RockEngine
+{
+	// Fast non-cryptographic 64-bit hash for change detection and cache keys. Four
+	// independent multiply-xor lanes keep it close to memory bandwidth on large buffers.
+	// The result is part of on-disk formats (scene checksums, texture cache keys), so
+	// changing it means bumping their versions.
+	inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0)
+	{
+		constexpr uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		uint64_t lanes[4] = { seed, seed ^ 0x6A09E667F3BCC909ull, seed ^ 0xBB67AE8584CAA73Bull, seed ^ 0x3C6EF372FE94F82Bull };
+
+		size_t i = 0;
+		for (; i + 32 <= size; i += 32)
+		{
+			for (uint32_t lane = 0; lane < 4; lane++)
+			{
+				uint64_t value;
+				std::memcpy(&value, bytes + i + lane * 8, sizeof(value));
+				lanes[lane] = (lanes[lane] ^ value) * multiplier;
+				lanes[lane] ^= lanes[lane] >> 29;
+			}
+		}
+
+		uint64_t hash = lanes[0] ^ (lanes[1] * 3) ^ (lanes[2] * 5) ^ (lanes[3] * 7) ^ size;
+		for (; i < size; i++)
+			hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+		hash ^= hash >> 32;
+		return hash * multiplier;
+	}
+}
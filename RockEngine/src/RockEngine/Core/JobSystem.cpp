@@ -0,0 +1,276 @@
+#include "pch.h"
+#include "JobSystem.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "RockEngine/Memory/MemoryTracker.h"
+
+namespace RockEngine
+{
+	// Chase-Lev work-stealing deque. The owning worker pushes and pops at the bottom,
+	// every other thread steals from the top.
+	class JobDeque
+	{
+	public:
+		static constexpr int64_t Capacity = 4096;
+
+		bool Push(Job* job)
+		{
+			int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+			int64_t top = m_Top.load(std::memory_order_acquire);
+			if (bottom - top >= Capacity)
+				return false;
+
+			m_Jobs[bottom & (Capacity - 1)].store(job, std::memory_order_release);
+			m_Bottom.store(bottom + 1, std::memory_order_release);
+			return true;
+		}
+
+		Job* Pop()
+		{
+			int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+			m_Bottom.store(bottom, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t top = m_Top.load(std::memory_order_relaxed);
+
+			if (top > bottom)
+			{
+				m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			Job* job = m_Jobs[bottom & (Capacity - 1)].load(std::memory_order_acquire);
+			if (top == bottom)
+			{
+				// Last job, race the thieves for it
+				if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					job = nullptr;
+				m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			}
+			return job;
+		}
+
+		Job* Steal()
+		{
+			int64_t top = m_Top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+			if (top >= bottom)
+				return nullptr;
+
+			Job* job = m_Jobs[top & (Capacity - 1)].load(std::memory_order_acquire);
+			if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return nullptr;
+			return job;
+		}
+	private:
+		alignas(64) std::atomic<int64_t> m_Top{ 0 };
+		alignas(64) std::atomic<int64_t> m_Bottom{ 0 };
+		std::atomic<Job*> m_Jobs[Capacity];
+	};
+
+	struct Worker
+	{
+		static constexpr uint32_t PoolSize = 4096;
+
+		JobDeque Deque;
+		std::unique_ptr<Job[]> Pool = std::make_unique<Job[]>(PoolSize);
+		uint32_t PoolIndex = 0;
+		uint32_t RandomState;
+		std::thread Thread;
+	};
+
+	static constexpr uint32_t s_NotAWorker = ~0u;
+	static thread_local uint32_t s_WorkerIndex = s_NotAWorker;
+
+	static std::vector<std::unique_ptr<Worker>> s_Workers;
+	static std::atomic<bool> s_Running{ false };
+
+	// Sleeping workers are woken when jobs are submitted
+	static std::atomic<int32_t> s_PendingJobs{ 0 };
+	static std::atomic<int32_t> s_SleepingWorkers{ 0 };
+	static std::mutex s_SleepMutex;
+	static std::condition_variable s_WakeCondition;
+
+	uint32_t JobSystem::s_WorkerCount = 0;
+
+	void JobSystem::Init(const JobSystemProps& props /* = JobSystemProps() */)
+	{
+		RE_MEMORY_SCOPE("JobSystem");
+
+		uint32_t workerCount = props.WorkerCount;
+		if (workerCount == 0)
+			workerCount = std::max(1u, std::thread::hardware_concurrency());
+
+		s_WorkerCount = workerCount;
+		s_Running.store(true);
+		s_PendingJobs.store(0);
+
+		s_Workers.clear();
+		for (uint32_t i = 0; i < workerCount; i++)
+		{
+			s_Workers.push_back(std::make_unique<Worker>());
+			s_Workers.back()->RandomState = 0x9E3779B9u * (i + 1);
+		}
+
+		// The calling thread is worker 0 and helps out whenever it waits on a counter
+		s_WorkerIndex = 0;
+		for (uint32_t i = 1; i < workerCount; i++)
+			s_Workers[i]->Thread = std::thread(WorkerMain, i);
+
+		RE_CORE_INFO("JobSystem: {} workers", workerCount);
+	}
+
+	void JobSystem::Shutdown()
+	{
+		if (!s_Running.exchange(false))
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(s_SleepMutex);
+		}
+		s_WakeCondition.notify_all();
+
+		for (uint32_t i = 1; i < s_Workers.size(); i++)
+			s_Workers[i]->Thread.join();
+
+		s_Workers.clear();
+		s_WorkerCount = 0;
+		s_WorkerIndex = s_NotAWorker;
+	}
+
+	uint32_t JobSystem::GetCurrentWorkerIndex()
+	{
+		return s_WorkerIndex;
+	}
+
+	uint32_t JobSystem::GetDefaultGrainSize(uint32_t count, uint32_t minGrainSize /* = 64 */)
+	{
+		uint32_t ranges = std::max(1u, s_WorkerCount * 4);
+		return std::max(minGrainSize, (count + ranges - 1) / ranges);
+	}
+
+	Job* JobSystem::AllocateJob()
+	{
+		if (s_WorkerIndex == s_NotAWorker || s_WorkerIndex >= s_Workers.size())
+			return nullptr;
+
+		Worker& worker = *s_Workers[s_WorkerIndex];
+		Job* job = &worker.Pool[worker.PoolIndex & (Worker::PoolSize - 1)];
+		if (!job->Finished.load(std::memory_order_acquire))
+			return nullptr;
+
+		worker.PoolIndex++;
+		job->Finished.store(false, std::memory_order_relaxed);
+		return job;
+	}
+
+	void JobSystem::Submit(Job* job)
+	{
+		if (!s_Workers[s_WorkerIndex]->Deque.Push(job))
+		{
+			Execute(job);
+			return;
+		}
+
+		s_PendingJobs.fetch_add(1);
+		if (s_SleepingWorkers.load() > 0)
+		{
+			{
+				std::lock_guard<std::mutex> lock(s_SleepMutex);
+			}
+			s_WakeCondition.notify_one();
+		}
+	}
+
+	void JobSystem::Execute(Job* job)
+	{
+		job->Invoke(job->Storage);
+		if (job->Destroy)
+			job->Destroy(job->Storage);
+
+		JobCounter* counter = job->Counter;
+		job->Finished.store(true, std::memory_order_release);
+		if (counter)
+			counter->m_Pending.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	bool JobSystem::ExecuteNext()
+	{
+		uint32_t index = s_WorkerIndex;
+		uint32_t workerCount = (uint32_t)s_Workers.size();
+
+		Job* job = nullptr;
+		uint32_t randomState = 0x2545F491u;
+		if (index < workerCount)
+		{
+			job = s_Workers[index]->Deque.Pop();
+			randomState = s_Workers[index]->RandomState;
+		}
+
+		if (!job && workerCount > 1)
+		{
+			// xorshift to pick where to start stealing, so thieves don't all hit the same victim
+			randomState ^= randomState << 13;
+			randomState ^= randomState >> 17;
+			randomState ^= randomState << 5;
+			if (index < workerCount)
+				s_Workers[index]->RandomState = randomState;
+
+			uint32_t start = randomState % workerCount;
+			for (uint32_t i = 0; i < workerCount && !job; i++)
+			{
+				uint32_t victim = (start + i) % workerCount;
+				if (victim != index)
+					job = s_Workers[victim]->Deque.Steal();
+			}
+		}
+
+		if (!job)
+			return false;
+
+		s_PendingJobs.fetch_sub(1);
+		Execute(job);
+		return true;
+	}
+
+	void JobSystem::Wait(const JobCounter& counter)
+	{
+		RE_PROFILE_FUNC();
+
+		while (!counter.IsDone())
+		{
+			if (!ExecuteNext())
+				std::this_thread::yield();
+		}
+	}
+
+	void JobSystem::WorkerMain(uint32_t index)
+	{
+		s_WorkerIndex = index;
+		RE_PROFILE_THREAD("Worker " + std::to_string(index));
+
+		while (s_Running.load(std::memory_order_acquire))
+		{
+			if (ExecuteNext())
+				continue;
+
+			// Spin briefly before going to sleep, jobs tend to come in bursts
+			bool found = false;
+			for (uint32_t spin = 0; spin < 64 && !found; spin++)
+			{
+				std::this_thread::yield();
+				found = s_PendingJobs.load(std::memory_order_relaxed) > 0;
+			}
+			if (found)
+				continue;
+
+			std::unique_lock<std::mutex> lock(s_SleepMutex);
+			s_SleepingWorkers.fetch_add(1);
+			s_WakeCondition.wait(lock, []() { return s_PendingJobs.load() > 0 || !s_Running.load(); });
+			s_SleepingWorkers.fetch_sub(1);
+		}
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace RockEngine
+{
+	// Number of jobs still in flight. Jobs decrement it when they finish, so a zero counter
+	// means everything that was attached to it is done.
+	class JobCounter
+	{
+	public:
+		JobCounter() = default;
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		inline bool IsDone() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+		inline uint32_t GetPending() const { return m_Pending.load(std::memory_order_acquire); }
+	private:
+		std::atomic<uint32_t> m_Pending{ 0 };
+
+		friend class JobSystem;
+	};
+
+	struct alignas(64) Job
+	{
+		void (*Invoke)(void* storage) = nullptr;
+		void (*Destroy)(void* storage) = nullptr;
+		JobCounter* Counter = nullptr;
+		std::atomic<bool> Finished{ true };
+		alignas(16) unsigned char Storage[96];
+	};
+
+	struct JobSystemProps
+	{
+		// 0 uses every hardware thread (the calling thread counts as worker 0)
+		uint32_t WorkerCount = 0;
+	};
+
+	class JobSystem
+	{
+	public:
+		static void Init(const JobSystemProps& props = JobSystemProps());
+		static void Shutdown();
+
+		inline static uint32_t GetWorkerCount() { return s_WorkerCount; }
+		static uint32_t GetCurrentWorkerIndex();
+
+		// Schedules `func` on the pool, `counter` (optional) is incremented now and decremented when it finishes.
+		// Captures have to fit into Job::Storage.
+		template<typename Func>
+		static void Run(Func&& func, JobCounter* counter = nullptr)
+		{
+			using FuncType = std::decay_t<Func>;
+			static_assert(sizeof(FuncType) <= sizeof(Job::Storage), "Job capture is too large");
+			static_assert(alignof(FuncType) <= 16, "Job capture is over-aligned");
+
+			Job* job = AllocateJob();
+			if (!job)
+			{
+				// Pool exhausted or not a worker thread: run inline rather than fail
+				func();
+				return;
+			}
+
+			new (job->Storage) FuncType(std::forward<Func>(func));
+			job->Invoke = [](void* storage) { (*reinterpret_cast<FuncType*>(storage))(); };
+			job->Destroy = nullptr;
+			if constexpr (!std::is_trivially_destructible_v<FuncType>)
+				job->Destroy = [](void* storage) { reinterpret_cast<FuncType*>(storage)->~FuncType(); };
+			job->Counter = counter;
+			if (counter)
+				counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+
+			Submit(job);
+		}
+
+		// Splits [0, count) into ranges of `grainSize` and calls func(begin, end) for each, in parallel.
+		// `func` is referenced, not copied, so it has to outlive `counter`.
+		template<typename Func>
+		static void ParallelFor(uint32_t count, uint32_t grainSize, const Func& func, JobCounter& counter)
+		{
+			if (grainSize == 0)
+				grainSize = 1;
+
+			for (uint32_t begin = 0; begin < count; begin += grainSize)
+			{
+				uint32_t end = begin + grainSize < count ? begin + grainSize : count;
+				Run([&func, begin, end]() { func(begin, end); }, &counter);
+			}
+		}
+
+		template<typename Func>
+		static void ParallelFor(uint32_t count, uint32_t grainSize, const Func& func)
+		{
+			JobCounter counter;
+			ParallelFor(count, grainSize, func, counter);
+			Wait(counter);
+		}
+
+		// Picks a grain size that gives every worker a few ranges to balance over
+		static uint32_t GetDefaultGrainSize(uint32_t count, uint32_t minGrainSize = 64);
+
+		// Helps executing jobs until `counter` reaches zero
+		static void Wait(const JobCounter& counter);
+	private:
+		static Job* AllocateJob();
+		static void Submit(Job* job);
+		static bool ExecuteNext();
+		static void Execute(Job* job);
+		static void WorkerMain(uint32_t index);
+	private:
+		static uint32_t s_WorkerCount;
+	};
+}
@@ -8,4 +8,27 @@ namespace RockEngine
 	{
 
 	}
+
+	void Layer::DeclareRead(const std::string& resource)
+	{
+		m_Dependencies.Reads.push_back(resource);
+		m_Dependencies.Declared = true;
+	}
+
+	void Layer::DeclareWrite(const std::string& resource)
+	{
+		m_Dependencies.Writes.push_back(resource);
+		m_Dependencies.Declared = true;
+	}
+
+	void Layer::DeclareRunAfter(const std::string& layerName)
+	{
+		m_Dependencies.RunAfter.push_back(layerName);
+		m_Dependencies.Declared = true;
+	}
+
+	void Layer::DeclareIndependent()
+	{
+		m_Dependencies.Declared = true;
+	}
 }
\ No newline at end of file
@@ -1,11 +1,41 @@
 #pragma once
 
+#include <array>
 #include <string>
+#include <vector>
 
 #include "RockEngine/Core/Core.h"
+#include "RockEngine/Core/Timestep.h"
+#include "RockEngine/Events/Event.h"
 
 namespace RockEngine
 {
+	// What a layer's OnUpdate/OnFixedUpdate touches. Layers that declared their accesses may update
+	// concurrently with layers they don't conflict with, the others keep the stack order.
+	struct LayerDependencies
+	{
+		std::vector<std::string> Reads;
+		std::vector<std::string> Writes;
+		std::vector<std::string> RunAfter; // layer names
+
+		bool Declared = false;
+	};
+
+	class Layer;
+
+	// Returns true when the event was handled and shouldn't reach the layers below
+	using EventHandler = bool(*)(Layer* layer, const Event& event);
+
+	template<typename Handler>
+	struct EventHandlerTraits;
+
+	template<typename LayerType, typename EventPayload>
+	struct EventHandlerTraits<bool (LayerType::*)(const EventPayload&)>
+	{
+		using LayerT = LayerType;
+		using EventT = EventPayload;
+	};
+
 	class Layer
 	{
 	public:
@@ -14,12 +44,37 @@ namespace RockEngine
 
 		virtual void OnAttach() {}
 		virtual void OnDetach() {}
-		virtual void OnUpdate() {}
+		virtual void OnUpdate(Timestep /*ts*/) {}
+		// Runs zero or more times per frame before OnUpdate, always with ApplicationProps::Timing.FixedTimestep
+		virtual void OnFixedUpdate(Timestep /*ts*/) {}
 
 		virtual void OnImGuiRender() {}
 
-		inline const std::string& GetName() { return m_Name; }
+		inline const std::string& GetName() const { return m_Name; }
+		inline const LayerDependencies& GetDependencies() const { return m_Dependencies; }
+		inline EventHandler GetEventHandler(EventType type) const { return m_EventHandlers[(size_t)type]; }
+	protected:
+		// Call from the constructor or OnAttach, the frame graph is built when the layer is pushed
+		void DeclareRead(const std::string& resource);
+		void DeclareWrite(const std::string& resource);
+		void DeclareRunAfter(const std::string& layerName);
+		// OnUpdate touches no state shared with other layers
+		void DeclareIndependent();
+
+		// Routes one event type to a member function, e.g. Subscribe<&MyLayer::OnWindowResize>().
+		// Subscribe before the layer is pushed (constructor or OnAttach).
+		template<auto Handler>
+		void Subscribe()
+		{
+			using Traits = EventHandlerTraits<decltype(Handler)>;
+			m_EventHandlers[(size_t)Traits::EventT::Type] = [](Layer* layer, const Event& event)
+			{
+				return (static_cast<typename Traits::LayerT*>(layer)->*Handler)(event.As<typename Traits::EventT>());
+			};
+		}
 	private:
 		std::string m_Name;
+		LayerDependencies m_Dependencies;
+		std::array<EventHandler, (size_t)EventType::Count> m_EventHandlers = {};
 	};
 }
\ No newline at end of file
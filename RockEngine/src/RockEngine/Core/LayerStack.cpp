@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "LayerStack.h"
 
+#include "RockEngine/Memory/MemoryTracker.h"
+
 namespace RockEngine
 {
 	LayerStack::LayerStack()
@@ -16,19 +18,260 @@ namespace RockEngine
 
 	void LayerStack::PushLayer(Layer* layer)
 	{
-		m_Layers.push_back(layer);
+		{
+			std::lock_guard<std::mutex> lock(m_PendingMutex);
+			if (m_InFrame)
+			{
+				m_PendingChanges.push_back({ layer, true, false });
+				return;
+			}
+		}
+		ApplyChange({ layer, true, false });
+	}
+
+	void LayerStack::PushOverlay(Layer* layer)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_PendingMutex);
+			if (m_InFrame)
+			{
+				m_PendingChanges.push_back({ layer, true, true });
+				return;
+			}
+		}
+		ApplyChange({ layer, true, true });
 	}
 
 	void LayerStack::PopLayer(Layer* layer)
 	{
-		auto it = m_Layers.begin();
-		while (it != m_Layers.end()) {
-			if (*it == layer)
+		{
+			std::lock_guard<std::mutex> lock(m_PendingMutex);
+			if (m_InFrame)
+			{
+				m_PendingChanges.push_back({ layer, false, false });
+				return;
+			}
+		}
+		ApplyChange({ layer, false, false });
+	}
+
+	void LayerStack::BeginFrame()
+	{
+		std::lock_guard<std::mutex> lock(m_PendingMutex);
+		m_InFrame = true;
+	}
+
+	void LayerStack::EndFrame()
+	{
+		std::vector<LayerChange> changes;
+		{
+			std::lock_guard<std::mutex> lock(m_PendingMutex);
+			m_InFrame = false;
+			changes.swap(m_PendingChanges);
+		}
+
+		// OnAttach/OnDetach may push or pop more layers, those are applied right away
+		for (const LayerChange& change : changes)
+			ApplyChange(change);
+	}
+
+	void LayerStack::ApplyChange(const LayerChange& change)
+	{
+		if (change.Push)
+		{
+			if (change.Overlay)
+				m_Layers.push_back(change.Target);
+			else
+				m_Layers.insert(m_Layers.begin() + m_LayerInsertIndex++, change.Target);
+			change.Target->OnAttach();
+		}
+		else
+		{
+			auto it = std::find(m_Layers.begin(), m_Layers.end(), change.Target);
+			if (it == m_Layers.end())
+				return;
+			if ((uint32_t)(it - m_Layers.begin()) < m_LayerInsertIndex)
+				m_LayerInsertIndex--;
+			m_Layers.erase(it);
+			change.Target->OnDetach();
+		}
+		m_GraphDirty = true;
+		m_EventRoutesDirty = true;
+	}
+
+	static bool Intersects(const std::vector<std::string>& a, const std::vector<std::string>& b)
+	{
+		for (const std::string& resource : a)
+		{
+			if (std::find(b.begin(), b.end(), resource) != b.end())
+				return true;
+		}
+		return false;
+	}
+
+	static bool Conflicts(const Layer& a, const Layer& b)
+	{
+		const LayerDependencies& depsA = a.GetDependencies();
+		const LayerDependencies& depsB = b.GetDependencies();
+		if (!depsA.Declared || !depsB.Declared)
+			return true;
+
+		return Intersects(depsA.Writes, depsB.Writes) || Intersects(depsA.Writes, depsB.Reads) || Intersects(depsA.Reads, depsB.Writes);
+	}
+
+	void LayerStack::BuildFrameGraph()
+	{
+		RE_PROFILE_FUNC();
+
+		uint32_t count = (uint32_t)m_Layers.size();
+		m_Successors.assign(count, {});
+		m_PredecessorCount.assign(count, 0);
+		m_Roots.clear();
+		m_Remaining = std::make_unique<std::atomic<uint32_t>[]>(count);
+		m_GraphDirty = false;
+
+		auto addEdge = [this](uint32_t from, uint32_t to)
+		{
+			if (std::find(m_Successors[from].begin(), m_Successors[from].end(), to) != m_Successors[from].end())
+				return;
+			m_Successors[from].push_back(to);
+			m_PredecessorCount[to]++;
+		};
+
+		// Conflicting layers keep their stack order, explicit constraints may point either way
+		for (uint32_t i = 0; i < count; i++)
+		{
+			for (uint32_t j = i + 1; j < count; j++)
+			{
+				if (Conflicts(*m_Layers[i], *m_Layers[j]))
+					addEdge(i, j);
+			}
+
+			for (const std::string& name : m_Layers[i]->GetDependencies().RunAfter)
+			{
+				for (uint32_t j = 0; j < count; j++)
+				{
+					if (j != i && m_Layers[j]->GetName() == name)
+						addEdge(j, i);
+				}
+			}
+		}
+
+		// Kahn's algorithm, to reject cycles and to see whether anything can overlap at all
+		std::vector<uint32_t> remaining = m_PredecessorCount;
+		std::vector<uint32_t> ready;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if (remaining[i] == 0)
+				ready.push_back(i);
+		}
+		m_Roots = ready;
+
+		bool overlaps = false;
+		uint32_t visited = 0;
+		while (!ready.empty())
+		{
+			overlaps |= ready.size() > 1;
+			uint32_t node = ready.back();
+			ready.pop_back();
+			visited++;
+			for (uint32_t successor : m_Successors[node])
+			{
+				if (--remaining[successor] == 0)
+					ready.push_back(successor);
+			}
+		}
+
+		if (visited != count)
+		{
+			RE_CORE_WARN("LayerStack: layer ordering constraints form a cycle, updating layers serially");
+			m_Serial = true;
+			return;
+		}
+
+		m_Serial = !overlaps;
+	}
+
+	void LayerStack::Update(Timestep ts)
+	{
+		RunLayers(&Layer::OnUpdate, ts);
+	}
+
+	void LayerStack::FixedUpdate(Timestep ts)
+	{
+		RunLayers(&Layer::OnFixedUpdate, ts);
+	}
+
+	void LayerStack::RunLayers(UpdateFunction function, Timestep ts)
+	{
+		if (m_GraphDirty)
+			BuildFrameGraph();
+
+		if (m_Serial || JobSystem::GetWorkerCount() <= 1)
+		{
+			for (Layer* layer : m_Layers)
+			{
+				RE_PROFILE_SCOPE(layer->GetName().c_str());
+				RE_MEMORY_SCOPE_DYNAMIC(layer->GetName().c_str());
+				(layer->*function)(ts);
+			}
+			return;
+		}
+
+		for (uint32_t i = 0; i < m_Layers.size(); i++)
+			m_Remaining[i].store(m_PredecessorCount[i], std::memory_order_relaxed);
+
+		JobCounter counter;
+		for (uint32_t root : m_Roots)
+			JobSystem::Run([this, root, function, ts, &counter]() { RunNode(root, function, ts, counter); }, &counter);
+		JobSystem::Wait(counter);
+	}
+
+	void LayerStack::RunNode(uint32_t index, UpdateFunction function, Timestep ts, JobCounter& counter)
+	{
+		Layer* layer = m_Layers[index];
+		{
+			RE_PROFILE_SCOPE(layer->GetName().c_str());
+			RE_MEMORY_SCOPE_DYNAMIC(layer->GetName().c_str());
+			(layer->*function)(ts);
+		}
+
+		for (uint32_t successor : m_Successors[index])
+		{
+			if (m_Remaining[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+				JobSystem::Run([this, successor, function, ts, &counter]() { RunNode(successor, function, ts, counter); }, &counter);
+		}
+	}
+
+	void LayerStack::BuildEventRoutes()
+	{
+		for (std::vector<EventRoute>& routes : m_EventRoutes)
+			routes.clear();
+
+		for (auto it = m_Layers.rbegin(); it != m_Layers.rend(); ++it)
+		{
+			for (size_t type = 0; type < m_EventRoutes.size(); type++)
+			{
+				if (EventHandler handler = (*it)->GetEventHandler((EventType)type))
+					m_EventRoutes[type].push_back({ *it, handler });
+			}
+		}
+		m_EventRoutesDirty = false;
+	}
+
+	void LayerStack::DispatchEvents(const Event* events, uint32_t count)
+	{
+		if (m_EventRoutesDirty)
+			BuildEventRoutes();
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const Event& event = events[i];
+			for (const EventRoute& route : m_EventRoutes[(size_t)event.Type])
 			{
-				m_Layers.erase(it);
-				break;
+				if (route.Handler(route.Target, event))
+					break;
 			}
-			++it;
 		}
 	}
 }
\ No newline at end of file
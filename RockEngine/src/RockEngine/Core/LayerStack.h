@@ -1,8 +1,11 @@
 #pragma once
 
+#include <atomic>
+#include <mutex>
 #include <vector>
 
 #include "Layer.h"
+#include "JobSystem.h"
 
 namespace RockEngine
 {
@@ -12,12 +15,65 @@ namespace RockEngine
 		LayerStack();
 		~LayerStack();
 
+		// Attaches/detaches right away, or at EndFrame() when called while a frame is running.
+		// Overlays always stay above regular layers, PopLayer removes either kind.
 		void PushLayer(Layer* layer);
+		void PushOverlay(Layer* layer);
 		void PopLayer(Layer* layer);
 
+		void BeginFrame();
+		void EndFrame();
+
+		// Runs every layer's OnUpdate (or OnFixedUpdate), independent layers in parallel on the job system
+		void Update(Timestep ts);
+		void FixedUpdate(Timestep ts);
+
+		// Hands each event to the subscribed layers, top (last overlay) first, until one handles it
+		void DispatchEvents(const Event* events, uint32_t count);
+
+		inline bool IsSerial() const { return m_Serial; }
+
 		std::vector<Layer*>::iterator begin() { return m_Layers.begin(); }
 		std::vector<Layer*>::iterator end() { return m_Layers.end(); }
+	private:
+		struct LayerChange
+		{
+			Layer* Target;
+			bool Push;
+			bool Overlay;
+		};
+
+		using UpdateFunction = void (Layer::*)(Timestep);
+
+		struct EventRoute
+		{
+			Layer* Target;
+			EventHandler Handler;
+		};
+
+		void ApplyChange(const LayerChange& change);
+		void BuildFrameGraph();
+		void BuildEventRoutes();
+		void RunLayers(UpdateFunction function, Timestep ts);
+		void RunNode(uint32_t index, UpdateFunction function, Timestep ts, JobCounter& counter);
 	private:
 		std::vector<Layer*> m_Layers;
+		uint32_t m_LayerInsertIndex = 0;
+
+		bool m_InFrame = false;
+		std::mutex m_PendingMutex;
+		std::vector<LayerChange> m_PendingChanges;
+
+		// Frame graph, rebuilt whenever the stack changes
+		bool m_GraphDirty = true;
+		bool m_Serial = true;
+		std::vector<std::vector<uint32_t>> m_Successors;
+		std::vector<uint32_t> m_PredecessorCount;
+		std::vector<uint32_t> m_Roots;
+		std::unique_ptr<std::atomic<uint32_t>[]> m_Remaining;
+
+		// Per event type, the subscribed layers top to bottom
+		bool m_EventRoutesDirty = true;
+		std::array<std::vector<EventRoute>, (size_t)EventType::Count> m_EventRoutes;
 	};
-}
+}
\ No newline at end of file
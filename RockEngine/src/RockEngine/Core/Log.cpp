@@ -1,17 +1,219 @@
 #include "pch.h"
 #include "Log.h"
 
+#include <thread>
+
+#include "spdlog/fmt/bundled/args.h"
+
+#include "RockEngine/Memory/MemoryTracker.h"
+
 namespace RockEngine
 {
 	std::shared_ptr<spdlog::logger> Log::s_CoreLogger;
+	std::atomic<LogMode> Log::s_Mode{ LogMode::Sync };
+
+	// Bounded MPSC ring (Vyukov). Each cell carries a sequence number that tells producers
+	// and the sink whose turn it is, so neither side ever takes a lock.
+	struct LogQueueCell
+	{
+		std::atomic<uint64_t> Sequence;
+		LogRecord Record;
+	};
+
+	static std::unique_ptr<LogQueueCell[]> s_Cells;
+	static uint64_t s_Mask = 0;
+	alignas(64) static std::atomic<uint64_t> s_EnqueuePos{ 0 };
+	alignas(64) static std::atomic<uint64_t> s_DequeuePos{ 0 };
+
+	static LogProps s_Props;
+	static std::thread s_SinkThread;
+	static std::atomic<bool> s_SinkRunning{ false };
+
+	static std::atomic<uint64_t> s_Written{ 0 };
+	static std::atomic<uint64_t> s_Dropped{ 0 };
+	static std::atomic<uint64_t> s_Blocked{ 0 };
+	static std::atomic<uint64_t> s_Late{ 0 };
+
+	static bool TryEnqueue(const LogRecord& record)
+	{
+		uint64_t pos = s_EnqueuePos.load(std::memory_order_relaxed);
+		LogQueueCell* cell;
+		for (;;)
+		{
+			cell = &s_Cells[pos & s_Mask];
+			uint64_t sequence = cell->Sequence.load(std::memory_order_acquire);
+			int64_t diff = (int64_t)sequence - (int64_t)pos;
+			if (diff == 0)
+			{
+				if (s_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+				return false;
+			else
+				pos = s_EnqueuePos.load(std::memory_order_relaxed);
+		}
+
+		cell->Record = record;
+		cell->Sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	static bool TryDequeue(LogRecord& record)
+	{
+		uint64_t pos = s_DequeuePos.load(std::memory_order_relaxed);
+		LogQueueCell& cell = s_Cells[pos & s_Mask];
+		if (cell.Sequence.load(std::memory_order_acquire) != pos + 1)
+			return false;
+
+		record = cell.Record;
+		cell.Sequence.store(pos + s_Mask + 1, std::memory_order_release);
+		s_DequeuePos.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	static void WriteRecord(const LogRecord& record)
+	{
+		static fmt::dynamic_format_arg_store<fmt::format_context> s_Args;
+		static fmt::memory_buffer s_Buffer;
+
+		s_Args.clear();
+		const char* payload = record.Payload;
+		for (uint32_t i = 0; i < record.ArgCount; i++)
+		{
+			switch (record.ArgTypes[i])
+			{
+				case LogRecord::ArgType::Bool:    { bool v;        std::memcpy(&v, payload, sizeof(v)); payload += sizeof(v); s_Args.push_back(v); break; }
+				case LogRecord::ArgType::Char:    { char v;        std::memcpy(&v, payload, sizeof(v)); payload += sizeof(v); s_Args.push_back(v); break; }
+				case LogRecord::ArgType::Int:     { int64_t v;     std::memcpy(&v, payload, sizeof(v)); payload += sizeof(v); s_Args.push_back(v); break; }
+				case LogRecord::ArgType::UInt:    { uint64_t v;    std::memcpy(&v, payload, sizeof(v)); payload += sizeof(v); s_Args.push_back(v); break; }
+				case LogRecord::ArgType::Double:  { double v;      std::memcpy(&v, payload, sizeof(v)); payload += sizeof(v); s_Args.push_back(v); break; }
+				case LogRecord::ArgType::Pointer: { const void* v; std::memcpy(&v, payload, sizeof(v)); payload += sizeof(v); s_Args.push_back(v); break; }
+				case LogRecord::ArgType::String:
+				{
+					uint16_t size;
+					std::memcpy(&size, payload, sizeof(size));
+					s_Args.push_back(fmt::string_view(payload + sizeof(size), size));
+					payload += sizeof(size) + size;
+					break;
+				}
+			}
+		}
+
+		s_Buffer.clear();
+		try
+		{
+			fmt::vformat_to(fmt::appender(s_Buffer), record.Format, s_Args);
+		}
+		catch (const fmt::format_error&)
+		{
+			s_Buffer.clear();
+			fmt::format_to(fmt::appender(s_Buffer), "{} [bad log arguments]", record.Format);
+		}
+
+		spdlog::log_clock::time_point time{ std::chrono::duration_cast<spdlog::log_clock::duration>(std::chrono::nanoseconds(record.Timestamp)) };
+		Log::GetCoreLogger()->log(time, spdlog::source_loc{}, (spdlog::level::level_enum)record.Level, spdlog::string_view_t(s_Buffer.data(), s_Buffer.size()));
+
+		auto latency = spdlog::log_clock::now() - time;
+		if (latency > std::chrono::milliseconds(s_Props.LateThresholdMs))
+			s_Late.fetch_add(1, std::memory_order_relaxed);
+		s_Written.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	static void SinkThread()
+	{
+		RE_PROFILE_THREAD("Log Sink");
+		RE_MEMORY_SCOPE("Log");
+
+		LogRecord record;
+		while (s_SinkRunning.load(std::memory_order_acquire))
+		{
+			if (TryDequeue(record))
+				WriteRecord(record);
+			else
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+		}
+
+		while (TryDequeue(record))
+			WriteRecord(record);
+	}
 
-	void Log::Init()
+	void Log::Init(const LogProps& props /* = LogProps() */)
 	{
+		RE_MEMORY_SCOPE("Log");
+		s_Props = props;
+
 		// change log pattern
 		spdlog::set_pattern("%^[%T] %n: %v%$");
 
 		// Core
 		s_CoreLogger = spdlog::stdout_color_mt("RockEngine");
 		s_CoreLogger->set_level(spdlog::level::trace);
+
+		if (props.Mode == LogMode::Async)
+		{
+			uint64_t capacity = 2;
+			while (capacity < props.QueueCapacity)
+				capacity <<= 1;
+
+			s_Cells = std::make_unique<LogQueueCell[]>(capacity);
+			for (uint64_t i = 0; i < capacity; i++)
+				s_Cells[i].Sequence.store(i, std::memory_order_relaxed);
+			s_Mask = capacity - 1;
+			s_EnqueuePos.store(0);
+			s_DequeuePos.store(0);
+
+			s_SinkRunning.store(true);
+			s_SinkThread = std::thread(SinkThread);
+		}
+		s_Mode.store(props.Mode);
+	}
+
+	void Log::Shutdown()
+	{
+		if (s_Mode.exchange(LogMode::Sync) == LogMode::Async)
+		{
+			s_SinkRunning.store(false, std::memory_order_release);
+			s_SinkThread.join();
+			s_Cells.reset();
+		}
+
+		LogStats stats = GetStats();
+		if (stats.Dropped || stats.Late)
+			RE_CORE_WARN("Log: {} messages dropped, {} late, {} producer stalls", stats.Dropped, stats.Late, stats.Blocked);
+
+		s_CoreLogger->flush();
+	}
+
+	void Log::Flush()
+	{
+		if (s_Mode.load(std::memory_order_relaxed) == LogMode::Async)
+		{
+			uint64_t target = s_EnqueuePos.load(std::memory_order_acquire);
+			while (s_DequeuePos.load(std::memory_order_acquire) < target)
+				std::this_thread::yield();
+		}
+		s_CoreLogger->flush();
+	}
+
+	void Log::Enqueue(const LogRecord& record)
+	{
+		if (TryEnqueue(record))
+			return;
+
+		if (s_Props.OverflowPolicy == LogOverflowPolicy::Drop)
+		{
+			s_Dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		s_Blocked.fetch_add(1, std::memory_order_relaxed);
+		while (!TryEnqueue(record))
+			std::this_thread::yield();
+	}
+
+	LogStats Log::GetStats()
+	{
+		return { s_Written.load(), s_Dropped.load(), s_Blocked.load(), s_Late.load() };
 	}
 }
@@ -1,21 +1,194 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
 #include "spdlog/spdlog.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 
+// Levels below RE_LOG_ACTIVE_LEVEL are compiled out entirely
+#define RE_LOG_LEVEL_TRACE		0
+#define RE_LOG_LEVEL_INFO		2
+#define RE_LOG_LEVEL_WARN		3
+#define RE_LOG_LEVEL_ERROR		4
+#define RE_LOG_LEVEL_OFF		6
+
+#ifndef RE_LOG_ACTIVE_LEVEL
+	#ifdef RE_DIST
+		#define RE_LOG_ACTIVE_LEVEL RE_LOG_LEVEL_INFO
+	#else
+		#define RE_LOG_ACTIVE_LEVEL RE_LOG_LEVEL_TRACE
+	#endif
+#endif
+
 namespace RockEngine
 {
+	enum class LogMode
+	{
+		Sync = 0,
+		Async
+	};
+
+	enum class LogOverflowPolicy
+	{
+		Drop = 0,
+		Block
+	};
+
+	struct LogProps
+	{
+		LogMode Mode = LogMode::Async;
+		LogOverflowPolicy OverflowPolicy = LogOverflowPolicy::Block;
+		uint32_t QueueCapacity = 8192; // records, rounded up to a power of two
+		uint32_t LateThresholdMs = 100;
+	};
+
+	struct LogStats
+	{
+		uint64_t Written;
+		uint64_t Dropped;	// queue was full under LogOverflowPolicy::Drop
+		uint64_t Blocked;	// producer had to wait for space under LogOverflowPolicy::Block
+		uint64_t Late;		// reached the sink later than LateThresholdMs after being logged
+	};
+
+	// Compact, trivially copyable log message. The format string literal doubles as the
+	// format id, arguments are stored raw and only formatted on the sink thread.
+	struct LogRecord
+	{
+		static constexpr uint32_t MaxArgs = 8;
+		static constexpr uint32_t PayloadSize = 176;
+
+		enum class ArgType : uint8_t
+		{
+			Bool, Char, Int, UInt, Double, Pointer, String
+		};
+
+		const char* Format;
+		int64_t Timestamp; // ns, log_clock
+		uint8_t Level;
+		uint8_t ArgCount;
+		ArgType ArgTypes[MaxArgs];
+		uint16_t PayloadUsed;
+		alignas(8) char Payload[PayloadSize];
+
+		template<typename T>
+		void Write(ArgType type, const T& value)
+		{
+			if (ArgCount == MaxArgs || PayloadUsed + sizeof(T) > PayloadSize)
+				return;
+			ArgTypes[ArgCount++] = type;
+			std::memcpy(Payload + PayloadUsed, &value, sizeof(T));
+			PayloadUsed += sizeof(T);
+		}
+
+		void WriteString(std::string_view string)
+		{
+			if (ArgCount == MaxArgs || PayloadUsed + sizeof(uint16_t) > PayloadSize)
+				return;
+			uint16_t size = (uint16_t)std::min<size_t>(string.size(), PayloadSize - PayloadUsed - sizeof(uint16_t));
+			ArgTypes[ArgCount++] = ArgType::String;
+			std::memcpy(Payload + PayloadUsed, &size, sizeof(uint16_t));
+			std::memcpy(Payload + PayloadUsed + sizeof(uint16_t), string.data(), size);
+			PayloadUsed += sizeof(uint16_t) + size;
+		}
+	};
+
 	class Log
 	{
 	public:
-		static void Init();
+		static void Init(const LogProps& props = LogProps());
+		static void Shutdown();
+
+		// Blocks until every record queued so far reached the sink
+		static void Flush();
+
 		static std::shared_ptr<spdlog::logger>& GetCoreLogger() { return s_CoreLogger; }
+		static LogStats GetStats();
+
+		template<typename... Args>
+		static void Write(spdlog::level::level_enum level, const char* format, const Args&... args)
+		{
+			if (!s_CoreLogger->should_log(level))
+				return;
+
+			if (s_Mode.load(std::memory_order_relaxed) == LogMode::Sync)
+			{
+				s_CoreLogger->log(level, fmt::runtime(format), args...);
+				return;
+			}
+
+			LogRecord record;
+			record.Format = format;
+			record.Timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(spdlog::log_clock::now().time_since_epoch()).count();
+			record.Level = (uint8_t)level;
+			record.ArgCount = 0;
+			record.PayloadUsed = 0;
+			(Encode(record, args), ...);
+			Enqueue(record);
+		}
+	private:
+		template<typename T>
+		static void Encode(LogRecord& record, const T& value)
+		{
+			using Type = std::decay_t<T>;
+			if constexpr (std::is_same_v<Type, bool>)
+				record.Write(LogRecord::ArgType::Bool, value);
+			else if constexpr (std::is_same_v<Type, char>)
+				record.Write(LogRecord::ArgType::Char, value);
+			else if constexpr (std::is_integral_v<Type> && std::is_signed_v<Type>)
+				record.Write(LogRecord::ArgType::Int, (int64_t)value);
+			else if constexpr (std::is_integral_v<Type>)
+				record.Write(LogRecord::ArgType::UInt, (uint64_t)value);
+			else if constexpr (std::is_enum_v<Type>)
+				record.Write(LogRecord::ArgType::Int, (int64_t)value);
+			else if constexpr (std::is_floating_point_v<Type>)
+				record.Write(LogRecord::ArgType::Double, (double)value);
+			else if constexpr ((std::is_same_v<Type, const char*> || std::is_same_v<Type, char*>) && !std::is_array_v<T>)
+				record.WriteString(value ? std::string_view(value) : std::string_view("(null)"));
+			else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+				record.WriteString(std::string_view(value));
+			else if constexpr (std::is_pointer_v<Type>)
+				record.Write(LogRecord::ArgType::Pointer, (const void*)value);
+			else
+			{
+				// Anything else is formatted up front, into the stack, and travels as a string
+				char buffer[LogRecord::PayloadSize];
+				auto result = fmt::format_to_n(buffer, sizeof(buffer), "{}", value);
+				record.WriteString(std::string_view(buffer, std::min<size_t>(result.size, sizeof(buffer))));
+			}
+		}
+
+		static void Enqueue(const LogRecord& record);
 	private:
 		static std::shared_ptr<spdlog::logger> s_CoreLogger;
+		static std::atomic<LogMode> s_Mode;
 	};
 }
 
 // Core Logging Macros
-#define RE_CORE_TRACE(...)					RockEngine::Log::GetCoreLogger()->trace(__VA_ARGS__);
-#define RE_CORE_INFO(...)					RockEngine::Log::GetCoreLogger()->info(__VA_ARGS__);
-#define RE_CORE_ERROR(...)					RockEngine::Log::GetCoreLogger()->error(__VA_ARGS__);
\ No newline at end of file
+#if RE_LOG_ACTIVE_LEVEL <= RE_LOG_LEVEL_TRACE
+	#define RE_CORE_TRACE(...)				RockEngine::Log::Write(spdlog::level::trace, __VA_ARGS__)
+#else
+	#define RE_CORE_TRACE(...)				(void)0
+#endif
+
+#if RE_LOG_ACTIVE_LEVEL <= RE_LOG_LEVEL_INFO
+	#define RE_CORE_INFO(...)				RockEngine::Log::Write(spdlog::level::info, __VA_ARGS__)
+#else
+	#define RE_CORE_INFO(...)				(void)0
+#endif
+
+#if RE_LOG_ACTIVE_LEVEL <= RE_LOG_LEVEL_WARN
+	#define RE_CORE_WARN(...)				RockEngine::Log::Write(spdlog::level::warn, __VA_ARGS__)
+#else
+	#define RE_CORE_WARN(...)				(void)0
+#endif
+
+#if RE_LOG_ACTIVE_LEVEL <= RE_LOG_LEVEL_ERROR
+	#define RE_CORE_ERROR(...)				RockEngine::Log::Write(spdlog::level::err, __VA_ARGS__)
+#else
+	#define RE_CORE_ERROR(...)				(void)0
+#endif
@@ -0,0 +1,229 @@
+#include "pch.h"
+#include "Profiler.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace RockEngine
+{
+	struct CapturedEvent
+	{
+		const std::string* Name;
+		uint64_t Start;
+		uint64_t End;
+		uint32_t ThreadID;
+	};
+
+	static std::mutex s_BuffersMutex;
+	static std::vector<std::unique_ptr<ProfileThreadBuffer>> s_Buffers;
+	static thread_local ProfileThreadBuffer* s_ThreadBuffer = nullptr;
+
+	static std::chrono::steady_clock::time_point s_Epoch = std::chrono::steady_clock::now();
+
+	static std::unordered_set<std::string> s_Names;
+	static std::unordered_map<const char*, const std::string*> s_NameCache;
+
+	static std::vector<CapturedEvent> s_Capture;
+	static std::string s_CapturePath;
+	static uint32_t s_CaptureFramesLeft = 0;
+
+	std::array<float, Profiler::FrameHistorySize> Profiler::s_FrameTimes = {};
+	uint32_t Profiler::s_FrameTimeOffset = 0;
+	float Profiler::s_LastFrameTime = 0.0f;
+	uint64_t Profiler::s_FrameStart = 0;
+	std::vector<ProfileScopeStats> Profiler::s_LastFrameScopes;
+	uint64_t Profiler::s_DroppedEvents = 0;
+
+	void Profiler::Init()
+	{
+		s_Epoch = std::chrono::steady_clock::now();
+		SetThreadName("Main");
+	}
+
+	void Profiler::Shutdown()
+	{
+		if (IsCapturing())
+			WriteChromeTrace(s_CapturePath);
+
+		std::lock_guard<std::mutex> lock(s_BuffersMutex);
+		s_Buffers.clear();
+		s_ThreadBuffer = nullptr;
+	}
+
+	uint64_t Profiler::Now()
+	{
+		return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_Epoch).count();
+	}
+
+	ProfileThreadBuffer& Profiler::GetThreadBuffer()
+	{
+		if (!s_ThreadBuffer)
+		{
+			std::lock_guard<std::mutex> lock(s_BuffersMutex);
+			uint32_t threadID = (uint32_t)s_Buffers.size();
+			s_Buffers.push_back(std::make_unique<ProfileThreadBuffer>(threadID, "Thread " + std::to_string(threadID)));
+			s_ThreadBuffer = s_Buffers.back().get();
+		}
+		return *s_ThreadBuffer;
+	}
+
+	void Profiler::Record(const char* name, uint64_t start, uint64_t end)
+	{
+		GetThreadBuffer().Push(name, start, end);
+	}
+
+	void Profiler::SetThreadName(const std::string& name)
+	{
+		ProfileThreadBuffer& buffer = GetThreadBuffer();
+		std::lock_guard<std::mutex> lock(s_BuffersMutex);
+		buffer.SetName(name);
+	}
+
+	void Profiler::BeginFrame()
+	{
+		s_FrameStart = Now();
+	}
+
+	void Profiler::EndFrame()
+	{
+		uint64_t frameEnd = Now();
+		Record("Frame", s_FrameStart, frameEnd);
+
+		s_LastFrameTime = (float)((frameEnd - s_FrameStart) / 1e6);
+		s_FrameTimes[s_FrameTimeOffset] = s_LastFrameTime;
+		s_FrameTimeOffset = (s_FrameTimeOffset + 1) % FrameHistorySize;
+
+		s_LastFrameScopes.clear();
+		{
+			std::lock_guard<std::mutex> lock(s_BuffersMutex);
+			for (auto& buffer : s_Buffers)
+				Drain(*buffer);
+		}
+
+		if (s_CaptureFramesLeft > 0 && --s_CaptureFramesLeft == 0)
+		{
+			WriteChromeTrace(s_CapturePath);
+			s_Capture.clear();
+		}
+	}
+
+	void Profiler::Drain(ProfileThreadBuffer& buffer)
+	{
+		uint64_t head = buffer.m_Head.load(std::memory_order_acquire);
+		uint64_t tail = buffer.m_Tail;
+		// Slot head - Capacity is the one the owner writes next, so at most Capacity - 1 events are safe to read
+		if (head - tail >= ProfileThreadBuffer::Capacity)
+		{
+			s_DroppedEvents += head - tail - ProfileThreadBuffer::Capacity + 1;
+			tail = head - ProfileThreadBuffer::Capacity + 1;
+		}
+
+		for (; tail < head; tail++)
+		{
+			ProfileEvent event = buffer.m_Events[tail & (ProfileThreadBuffer::Capacity - 1)];
+
+			// The owner may have lapped us while we were reading, in which case the slot is stale
+			if (buffer.m_Head.load(std::memory_order_acquire) - tail >= ProfileThreadBuffer::Capacity)
+			{
+				s_DroppedEvents++;
+				continue;
+			}
+
+			const std::string* name = Intern(event.Name);
+
+			auto it = std::find_if(s_LastFrameScopes.begin(), s_LastFrameScopes.end(), [name](const ProfileScopeStats& stats) { return stats.Name == name; });
+			if (it == s_LastFrameScopes.end())
+			{
+				s_LastFrameScopes.push_back({ name, 0.0, 0 });
+				it = s_LastFrameScopes.end() - 1;
+			}
+			it->TotalMs += (event.End - event.Start) / 1e6;
+			it->Calls++;
+
+			if (s_CaptureFramesLeft > 0)
+				s_Capture.push_back({ name, event.Start, event.End, buffer.GetThreadID() });
+		}
+		buffer.m_Tail = tail;
+	}
+
+	const std::string* Profiler::Intern(const char* name)
+	{
+		auto it = s_NameCache.find(name);
+		if (it != s_NameCache.end() && std::strcmp(it->second->c_str(), name) == 0)
+			return it->second;
+
+		const std::string* interned = &*s_Names.emplace(name).first;
+		s_NameCache[name] = interned;
+		return interned;
+	}
+
+	void Profiler::BeginCapture(const std::string& filepath, uint32_t frames)
+	{
+		s_Capture.clear();
+		s_CapturePath = filepath;
+		s_CaptureFramesLeft = frames;
+		RE_CORE_INFO("Profiler: capturing {} frames to {}", frames, filepath);
+	}
+
+	bool Profiler::IsCapturing()
+	{
+		return s_CaptureFramesLeft > 0;
+	}
+
+	static void WriteJsonString(std::ofstream& stream, const std::string& string)
+	{
+		stream << '"';
+		for (char c : string)
+		{
+			if (c == '"' || c == '\\')
+				stream << '\\';
+			stream << c;
+		}
+		stream << '"';
+	}
+
+	bool Profiler::WriteChromeTrace(const std::string& filepath)
+	{
+		std::ofstream stream(filepath);
+		if (!stream)
+		{
+			RE_CORE_ERROR("Profiler: could not open {}", filepath);
+			return false;
+		}
+
+		stream << "{\"otherData\":{},\"traceEvents\":[";
+
+		bool first = true;
+		{
+			std::lock_guard<std::mutex> lock(s_BuffersMutex);
+			for (auto& buffer : s_Buffers)
+			{
+				stream << (first ? "" : ",") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->GetThreadID() << ",\"args\":{\"name\":";
+				WriteJsonString(stream, buffer->GetName());
+				stream << "}}";
+				first = false;
+			}
+		}
+
+		stream.setf(std::ios::fixed);
+		stream.precision(3);
+		for (const CapturedEvent& event : s_Capture)
+		{
+			stream << (first ? "" : ",") << "{\"cat\":\"function\",\"ph\":\"X\",\"pid\":0,\"name\":";
+			WriteJsonString(stream, *event.Name);
+			stream << ",\"tid\":" << event.ThreadID
+				<< ",\"ts\":" << event.Start / 1000.0
+				<< ",\"dur\":" << (event.End - event.Start) / 1000.0 << "}";
+			first = false;
+		}
+
+		stream << "]}";
+
+		RE_CORE_INFO("Profiler: wrote {} events to {}", s_Capture.size(), filepath);
+		return true;
+	}
+}
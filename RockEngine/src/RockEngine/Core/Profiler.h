@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#ifndef RE_DIST
+#define RE_ENABLE_PROFILING
+#endif
+
+namespace RockEngine
+{
+	struct ProfileEvent
+	{
+		const char* Name;
+		uint64_t Start; // ns since profiler epoch
+		uint64_t End;
+	};
+
+	// Single-producer ring of events owned by one thread. The owning thread is the
+	// only writer, the profiler drains it from the main thread at the end of a frame.
+	class ProfileThreadBuffer
+	{
+	public:
+		static constexpr uint32_t Capacity = 1u << 14;
+
+		ProfileThreadBuffer(uint32_t threadID, const std::string& name)
+			: m_ThreadID(threadID), m_Name(name) {}
+
+		void Push(const char* name, uint64_t start, uint64_t end)
+		{
+			uint64_t head = m_Head.load(std::memory_order_relaxed);
+			m_Events[head & (Capacity - 1)] = { name, start, end };
+			m_Head.store(head + 1, std::memory_order_release);
+		}
+
+		uint32_t GetThreadID() const { return m_ThreadID; }
+		const std::string& GetName() const { return m_Name; }
+		void SetName(const std::string& name) { m_Name = name; }
+	private:
+		std::array<ProfileEvent, Capacity> m_Events;
+		std::atomic<uint64_t> m_Head{ 0 };
+		uint64_t m_Tail = 0; // only touched by the collecting thread
+
+		uint32_t m_ThreadID;
+		std::string m_Name;
+
+		friend class Profiler;
+	};
+
+	struct ProfileScopeStats
+	{
+		const std::string* Name;
+		double TotalMs;
+		uint32_t Calls;
+	};
+
+	class Profiler
+	{
+	public:
+		static constexpr uint32_t FrameHistorySize = 240;
+
+		static void Init();
+		static void Shutdown();
+
+		static void BeginFrame();
+		static void EndFrame();
+
+		static uint64_t Now();
+		static void Record(const char* name, uint64_t start, uint64_t end);
+		static void SetThreadName(const std::string& name);
+
+		// Captures every event for the next `frames` frames and writes them as a Chrome trace
+		// (chrome://tracing, Perfetto) once the capture completes.
+		static void BeginCapture(const std::string& filepath, uint32_t frames);
+		static bool IsCapturing();
+		static bool WriteChromeTrace(const std::string& filepath);
+
+		static const float* GetFrameTimes() { return s_FrameTimes.data(); }
+		static uint32_t GetFrameTimeOffset() { return s_FrameTimeOffset; }
+		static float GetLastFrameTime() { return s_LastFrameTime; }
+		static const std::vector<ProfileScopeStats>& GetLastFrameScopes() { return s_LastFrameScopes; }
+		static uint64_t GetDroppedEvents() { return s_DroppedEvents; }
+	private:
+		static ProfileThreadBuffer& GetThreadBuffer();
+		static void Drain(ProfileThreadBuffer& buffer);
+		static const std::string* Intern(const char* name);
+	private:
+		static std::array<float, FrameHistorySize> s_FrameTimes;
+		static uint32_t s_FrameTimeOffset;
+		static float s_LastFrameTime;
+		static uint64_t s_FrameStart;
+		static std::vector<ProfileScopeStats> s_LastFrameScopes;
+		static uint64_t s_DroppedEvents;
+	};
+
+	class ProfileScope
+	{
+	public:
+		ProfileScope(const char* name)
+			: m_Name(name), m_Start(Profiler::Now()) {}
+
+		~ProfileScope()
+		{
+			Profiler::Record(m_Name, m_Start, Profiler::Now());
+		}
+	private:
+		const char* m_Name;
+		uint64_t m_Start;
+	};
+}
+
+// Profiling Macros
+#ifdef RE_ENABLE_PROFILING
+	#if defined(_MSC_VER)
+		#define RE_FUNC_SIG __FUNCSIG__
+	#else
+		#define RE_FUNC_SIG __PRETTY_FUNCTION__
+	#endif
+
+	#define RE_PROFILE_CONCAT_IMPL(a, b) a##b
+	#define RE_PROFILE_CONCAT(a, b) RE_PROFILE_CONCAT_IMPL(a, b)
+
+	#define RE_PROFILE_SCOPE(name)			RockEngine::ProfileScope RE_PROFILE_CONCAT(reProfileScope, __LINE__)(name)
+	#define RE_PROFILE_FUNC()				RE_PROFILE_SCOPE(RE_FUNC_SIG)
+	#define RE_PROFILE_THREAD(name)			RockEngine::Profiler::SetThreadName(name)
+#else
+	#define RE_PROFILE_SCOPE(name)
+	#define RE_PROFILE_FUNC()
+	#define RE_PROFILE_THREAD(name)
+#endif
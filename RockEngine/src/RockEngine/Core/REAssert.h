@@ -4,10 +4,17 @@
 #define RE_ENABLE_ASSERTS
 #endif
 
+#if defined(_MSC_VER)
+#define RE_DEBUGBREAK() __debugbreak()
+#else
+#include <csignal>
+#define RE_DEBUGBREAK() raise(SIGTRAP)
+#endif
+
 #ifdef RE_ENABLE_ASSERTS
 
-#define RE_ASSERT_NO_MESSAGE(condition) { if(!(condition)) { RE_CORE_ERROR("Assertion Failed!"); __debugbreak(); } }
-#define RE_ASSERT_MESSAGE(condition, ...) { if(!(condition)) { RE_CORE_ERROR("Assertion Failed: {0}", __VA_ARGS__); __debugbreak(); } }
+#define RE_ASSERT_NO_MESSAGE(condition) { if(!(condition)) { RE_CORE_ERROR("Assertion Failed!"); RockEngine::Log::Flush(); RE_DEBUGBREAK(); } }
+#define RE_ASSERT_MESSAGE(condition, ...) { if(!(condition)) { RE_CORE_ERROR("Assertion Failed: {0}", __VA_ARGS__); RockEngine::Log::Flush(); RE_DEBUGBREAK(); } }
 
 #define RE_ASSERT_RESOLVE(arg1, arg2, macro, ...) macro
 
@@ -0,0 +1,22 @@
+#pragma once
+
+namespace RockEngine
+{
+	class Timestep
+	{
+	public:
+		Timestep(float seconds = 0.0f, float alpha = 1.0f)
+			: m_Seconds(seconds), m_Alpha(alpha) {}
+
+		operator float() const { return m_Seconds; }
+
+		float GetSeconds() const { return m_Seconds; }
+		float GetMilliseconds() const { return m_Seconds * 1000.0f; }
+		// Fraction of a fixed step left in the accumulator after this frame's fixed updates,
+		// blend the previous and the current fixed-step state with it when drawing
+		float GetAlpha() const { return m_Alpha; }
+	private:
+		float m_Seconds;
+		float m_Alpha;
+	};
+}
\ No newline at end of file
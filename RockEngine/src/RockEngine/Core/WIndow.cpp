@@ -1,11 +1,17 @@
 #include "pch.h"
 #include "Window.h"
 #include "RockEngine/Platform/Windows/WindowsWindow.h"
+#include "RockEngine/Platform/Headless/HeadlessWindow.h"
 
 namespace RockEngine
 {
-	Window* Window::Create(const WindowProps& props /* = WindowProps() */)
+	Window* Window::Create(const WindowProps& props /* = WindowProps() */, WindowType type /* = WindowType::GLFW */)
 	{
-		return new WindowsWindow(props);
+		switch (type)
+		{
+			case WindowType::Headless: return new HeadlessWindow(props);
+			case WindowType::GLFW:     return new WindowsWindow(props);
+		}
+		return nullptr;
 	}
 }
\ No newline at end of file
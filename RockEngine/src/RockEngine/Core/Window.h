@@ -2,6 +2,14 @@
 
 namespace RockEngine
 {
+	class EventQueue;
+
+	enum class WindowType
+	{
+		GLFW = 0,
+		Headless
+	};
+
 	struct WindowProps{
 		std::string Title;
 		uint32_t Width, Height;
@@ -15,15 +23,31 @@ namespace RockEngine
 	public:
 		virtual ~Window(){}
 
-		virtual void OnUpdate() = 0;
+		virtual void OnUpdate() { PollEvents(); SwapBuffers(); }
+
+		// Split so a render thread that owns the context can present while the main thread polls
+		virtual void PollEvents() = 0;
+		virtual void SwapBuffers() = 0;
+		// Binds (or releases) the graphics context on the calling thread
+		virtual void SetContextCurrent(bool /*current*/) {}
 
 		// Windows attributes
 		virtual unsigned int GetWidth() = 0;
 		virtual unsigned int GetHeight() = 0;
 
+		// Applied on the next SwapBuffers, so it works from any thread
+		virtual void SetVSync(bool enabled) = 0;
+		virtual bool IsVSync() const = 0;
+
+		virtual bool IsMinimized() const = 0;
+		virtual bool IsFocused() const = 0;
+
 		inline virtual void* GetNativeWindow() = 0;
 
+		// Input and window events are pushed here as they arrive
+		virtual void SetEventQueue(EventQueue* queue) = 0;
+
 		// Instance of window
-		static Window* Create(const WindowProps& props = WindowProps());
+		static Window* Create(const WindowProps& props = WindowProps(), WindowType type = WindowType::GLFW);
 	};
 }
\ No newline at end of file
@@ -1,12 +1,14 @@
 #pragma once
 
-extern RockEngine::Application* RockEngine::CreateApplication();
+extern RockEngine::Application* RockEngine::CreateApplication(RockEngine::ApplicationCommandLineArgs args);
 
-int main(int arc, char** argv)
+int main(int argc, char** argv)
 {
 	RockEngine::InitializeCore();
-	auto app = RockEngine::CreateApplication();
+	auto app = RockEngine::CreateApplication({ argc, argv });
 	app->Run();
+	int exitCode = app->GetExitCode();
 	delete app;
-	return 0;
+	RockEngine::ShutdownCore();
+	return exitCode;
 }
\ No newline at end of file
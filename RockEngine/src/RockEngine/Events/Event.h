@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace RockEngine
+{
+	enum class EventType : uint8_t
+	{
+		None = 0,
+		WindowClose, WindowResize, WindowFocus,
+		KeyPressed, KeyReleased, KeyTyped,
+		MouseButtonPressed, MouseButtonReleased, MouseMoved, MouseScrolled,
+		Count
+	};
+
+	// Payloads are plain data, the queue copies them around by value
+	struct WindowCloseEvent { static constexpr EventType Type = EventType::WindowClose; };
+	struct WindowResizeEvent { static constexpr EventType Type = EventType::WindowResize; uint32_t Width, Height; };
+	struct WindowFocusEvent { static constexpr EventType Type = EventType::WindowFocus; bool Focused; };
+
+	struct KeyPressedEvent { static constexpr EventType Type = EventType::KeyPressed; int32_t KeyCode; int32_t Mods; bool Repeat; };
+	struct KeyReleasedEvent { static constexpr EventType Type = EventType::KeyReleased; int32_t KeyCode; int32_t Mods; };
+	struct KeyTypedEvent { static constexpr EventType Type = EventType::KeyTyped; uint32_t Codepoint; };
+
+	struct MouseButtonPressedEvent { static constexpr EventType Type = EventType::MouseButtonPressed; int32_t Button; int32_t Mods; };
+	struct MouseButtonReleasedEvent { static constexpr EventType Type = EventType::MouseButtonReleased; int32_t Button; int32_t Mods; };
+	struct MouseMovedEvent { static constexpr EventType Type = EventType::MouseMoved; float X, Y; };
+	struct MouseScrolledEvent { static constexpr EventType Type = EventType::MouseScrolled; float XOffset, YOffset; };
+
+	struct Event
+	{
+		EventType Type = EventType::None;
+		union
+		{
+			WindowResizeEvent WindowResize;
+			WindowFocusEvent WindowFocus;
+			KeyPressedEvent KeyPressed;
+			KeyReleasedEvent KeyReleased;
+			KeyTypedEvent KeyTyped;
+			MouseButtonPressedEvent MouseButtonPressed;
+			MouseButtonReleasedEvent MouseButtonReleased;
+			MouseMovedEvent MouseMoved;
+			MouseScrolledEvent MouseScrolled;
+			uint8_t Payload[12];
+		};
+
+		Event() : Payload{} {}
+
+		template<typename T>
+		static Event Make(const T& payload)
+		{
+			static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(Payload), "Events have to be small plain data");
+			Event event;
+			event.Type = T::Type;
+			std::memcpy(event.Payload, &payload, sizeof(T));
+			return event;
+		}
+
+		template<typename T>
+		const T& As() const
+		{
+			return *reinterpret_cast<const T*>(Payload);
+		}
+	};
+	static_assert(sizeof(Event) == 16, "Keep events at 16 bytes");
+}
\ No newline at end of file
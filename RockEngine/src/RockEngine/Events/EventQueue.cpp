@@ -0,0 +1,66 @@
+#include "pch.h"
+#include "EventQueue.h"
+
+namespace RockEngine
+{
+	EventQueue::EventQueue(uint32_t capacity /* = 4096 */)
+	{
+		uint64_t size = 2;
+		while (size < capacity)
+			size <<= 1;
+
+		m_Cells = std::make_unique<Cell[]>(size);
+		for (uint64_t i = 0; i < size; i++)
+			m_Cells[i].Sequence.store(i, std::memory_order_relaxed);
+		m_Mask = size - 1;
+	}
+
+	EventQueue::~EventQueue()
+	{
+	}
+
+	bool EventQueue::Push(const Event& event)
+	{
+		// Same scheme as the log queue: a cell's sequence says whose turn it is
+		uint64_t pos = m_EnqueuePos.load(std::memory_order_relaxed);
+		Cell* cell;
+		for (;;)
+		{
+			cell = &m_Cells[pos & m_Mask];
+			uint64_t sequence = cell->Sequence.load(std::memory_order_acquire);
+			int64_t diff = (int64_t)sequence - (int64_t)pos;
+			if (diff == 0)
+			{
+				if (m_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+			{
+				m_Dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			else
+				pos = m_EnqueuePos.load(std::memory_order_relaxed);
+		}
+
+		cell->Data = event;
+		cell->Sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	uint32_t EventQueue::PopBatch(Event* events, uint32_t maxCount)
+	{
+		uint32_t count = 0;
+		while (count < maxCount)
+		{
+			Cell& cell = m_Cells[m_DequeuePos & m_Mask];
+			if (cell.Sequence.load(std::memory_order_acquire) != m_DequeuePos + 1)
+				break;
+
+			events[count++] = cell.Data;
+			cell.Sequence.store(m_DequeuePos + m_Mask + 1, std::memory_order_release);
+			m_DequeuePos++;
+		}
+		return count;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "Event.h"
+
+namespace RockEngine
+{
+	// Bounded multi-producer, single-consumer ring of events. Window callbacks (or any
+	// thread) push, Application::Run drains it in batches at the start of a frame.
+	// Nothing is allocated after construction.
+	class EventQueue
+	{
+	public:
+		EventQueue(uint32_t capacity = 4096); // rounded up to a power of two
+		~EventQueue();
+
+		EventQueue(const EventQueue&) = delete;
+		EventQueue& operator=(const EventQueue&) = delete;
+
+		// Returns false and drops the event when the queue is full
+		bool Push(const Event& event);
+
+		template<typename T>
+		bool Push(const T& payload) { return Push(Event::Make(payload)); }
+
+		// Consumer only. Returns how many events were written to `events`.
+		uint32_t PopBatch(Event* events, uint32_t maxCount);
+
+		inline uint32_t GetCapacity() const { return (uint32_t)(m_Mask + 1); }
+		inline uint64_t GetDropped() const { return m_Dropped.load(std::memory_order_relaxed); }
+	private:
+		struct Cell
+		{
+			std::atomic<uint64_t> Sequence;
+			Event Data;
+		};
+
+		std::unique_ptr<Cell[]> m_Cells;
+		uint64_t m_Mask;
+		alignas(64) std::atomic<uint64_t> m_EnqueuePos{ 0 };
+		alignas(64) uint64_t m_DequeuePos = 0;
+		std::atomic<uint64_t> m_Dropped{ 0 };
+	};
+}
\ No newline at end of file
@@ -1,5 +1,4 @@
 #include "pch.h"
 
-#define IMGUI_IMPL_OPENGL_LOADER_GLAD
-#include "backends/imgui_impl_opengl3.cpp"
+// Drawing is OpenGLImGuiRenderer's, only the GLFW platform backend is built
 #include "backends/imgui_impl_glfw.cpp"
\ No newline at end of file
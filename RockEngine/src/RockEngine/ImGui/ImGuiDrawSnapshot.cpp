@@ -0,0 +1,36 @@
+#include "pch.h"
+#include "ImGuiDrawSnapshot.h"
+
+namespace RockEngine
+{
+	ImGuiDrawSnapshot::~ImGuiDrawSnapshot()
+	{
+		Clear();
+	}
+
+	void ImGuiDrawSnapshot::Capture(const ImDrawData* source, uint64_t generation /* = 0 */)
+	{
+		RE_PROFILE_FUNC();
+
+		Clear();
+		if (!source || !source->Valid)
+			return;
+
+		m_Data = *source;
+		m_Lists.reserve(source->CmdListsCount);
+		for (int i = 0; i < source->CmdListsCount; i++)
+			m_Lists.push_back(source->CmdLists[i]->CloneOutput());
+		m_Data.CmdLists = m_Lists.data();
+		m_Generation = generation;
+		m_Valid = true;
+	}
+
+	void ImGuiDrawSnapshot::Clear()
+	{
+		for (ImDrawList* list : m_Lists)
+			IM_DELETE(list);
+		m_Lists.clear();
+		m_Generation = 0;
+		m_Valid = false;
+	}
+}
\ No newline at end of file
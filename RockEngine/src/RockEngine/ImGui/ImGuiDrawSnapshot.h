@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+
+#include "imgui.h"
+
+namespace RockEngine
+{
+	// Deep copy of a frame's ImGui draw data. ImGui reuses its draw lists as soon as the
+	// next frame starts, so a render thread presenting frame N has to own a copy. Snapshots
+	// remember the generation of the UI frame they copied, an idle UI isn't copied again.
+	class ImGuiDrawSnapshot
+	{
+	public:
+		ImGuiDrawSnapshot() = default;
+		~ImGuiDrawSnapshot();
+
+		ImGuiDrawSnapshot(const ImGuiDrawSnapshot&) = delete;
+		ImGuiDrawSnapshot& operator=(const ImGuiDrawSnapshot&) = delete;
+
+		void Capture(const ImDrawData* source, uint64_t generation = 0);
+		void Clear();
+
+		inline bool IsValid() const { return m_Valid; }
+		inline uint64_t GetGeneration() const { return m_Generation; }
+		inline ImDrawData* GetDrawData() { return m_Valid ? &m_Data : nullptr; }
+	private:
+		ImDrawData m_Data = {};
+		std::vector<ImDrawList*> m_Lists;
+		uint64_t m_Generation = 0;
+		bool m_Valid = false;
+	};
+}
\ No newline at end of file
@@ -3,22 +3,36 @@
 
 #define IMGUI_IMPL_API
 #include "backends/imgui_impl_glfw.h"
-#include "backends/imgui_impl_opengl3.h"
 
 #include "RockEngine/Core/Application.h"
+#include "RockEngine/Memory/MemoryTracker.h"
+#include "RockEngine/Renderer/Renderer2D.h"
 #include <GLFW/glfw3.h>
 
 
 namespace RockEngine {
 
 	ImGuiLayer::ImGuiLayer()
+		: ImGuiLayer("ImGuiLayer")
 	{
-
 	}
 
 	ImGuiLayer::ImGuiLayer(const std::string& name)
+		: Layer(name)
 	{
+		DeclareIndependent();
 
+		// ImGui gets input straight from its GLFW backend, these only keep what it
+		// captured from reaching the layers below, and wake an idle UI
+		Subscribe<&ImGuiLayer::OnWindowResize>();
+		Subscribe<&ImGuiLayer::OnWindowFocus>();
+		Subscribe<&ImGuiLayer::OnKeyPressed>();
+		Subscribe<&ImGuiLayer::OnKeyReleased>();
+		Subscribe<&ImGuiLayer::OnKeyTyped>();
+		Subscribe<&ImGuiLayer::OnMouseButtonPressed>();
+		Subscribe<&ImGuiLayer::OnMouseButtonReleased>();
+		Subscribe<&ImGuiLayer::OnMouseMoved>();
+		Subscribe<&ImGuiLayer::OnMouseScrolled>();
 	}
 
 	ImGuiLayer::~ImGuiLayer()
@@ -31,6 +45,14 @@ namespace RockEngine {
 		// Setup Dear ImGui context
 		IMGUI_CHECKVERSION();
 
+#ifdef RE_ENABLE_MEMORY_TRACKING
+		// ImGui allocates through malloc unless told otherwise
+		static MemoryTag s_ImGuiTag = MemoryTracker::RegisterTag("ImGui");
+		ImGui::SetAllocatorFunctions(
+			[](size_t size, void*) { return MemoryTracker::Allocate(size, s_ImGuiTag); },
+			[](void* ptr, void*) { MemoryTracker::Free(ptr); });
+#endif
+
 		ImGui::CreateContext();
 		ImGuiIO& io = ImGui::GetIO();
 		io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;       // Enable Keyboard Controls
@@ -42,25 +64,95 @@ namespace RockEngine {
 
 		Application& app = Application::Get();
 		GLFWwindow* window = static_cast<GLFWwindow*>(app.GetWindow().GetNativeWindow());
+		m_DisplayWidth = app.GetWindow().GetWidth();
+		m_DisplayHeight = app.GetWindow().GetHeight();
+
+		// Without a native window there is nothing to bind to, the UI is still built every frame
+		// so its CPU cost shows up in headless runs
+		m_Headless = window == nullptr;
+		if (m_Headless)
+		{
+			unsigned char* pixels;
+			int width, height;
+			io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+			RE_CORE_INFO("ImGui was attached (headless)");
+			return;
+		}
 
-		// Setup Platform/Renderer bindings
+		// Setup Platform/Renderer bindings, the render thread takes the context over later
 		ImGui_ImplGlfw_InitForOpenGL(window, true);
-		ImGui_ImplOpenGL3_Init("#version 410");
+		m_Renderer.Init();
 
 		RE_CORE_INFO("ImGui was attached");
 	}
 
 	void ImGuiLayer::OnDetach()
 	{
-		ImGui_ImplOpenGL3_Shutdown();
-		ImGui_ImplGlfw_Shutdown();
+		if (m_IdleProps.Enabled)
+		{
+			ImGuiLayerStats stats = GetStats();
+			RE_CORE_INFO("ImGui: built {} frames, skipped {} while idle (~{:.1f} ms CPU saved), {} of {} buffer uploads skipped",
+				stats.FramesBuilt, stats.FramesSkipped, stats.SavedMs, stats.Renderer.BuffersReused, stats.Renderer.BuffersReused + stats.Renderer.BuffersUploaded);
+		}
+
+		if (!m_Headless)
+		{
+			m_Renderer.Shutdown();
+			ImGui_ImplGlfw_Shutdown();
+		}
 		ImGui::DestroyContext();
 	}
 
+	bool ImGuiLayer::ShouldBuildFrame()
+	{
+		// The first frame has nothing to present again
+		if (!m_IdleProps.Enabled || m_Stats.FramesBuilt == 0)
+			return true;
+
+		uint64_t now = Profiler::Now();
+		if (m_Dirty.exchange(false, std::memory_order_relaxed))
+			m_LastActivity = now;
+		if (now - m_LastActivity < (uint64_t)(m_IdleProps.ActiveSeconds * 1e9))
+			return true;
+		return m_IdleProps.RefreshSeconds > 0.0f && now - m_BuildStart >= (uint64_t)(m_IdleProps.RefreshSeconds * 1e9);
+	}
+
+	void ImGuiLayer::SkipFrame()
+	{
+		m_Stats.FramesSkipped++;
+
+		// Nothing started a new ImGui frame, the draw data End() built last is still valid
+		if (!m_Headless && !m_RenderThreaded)
+			m_Renderer.Render(ImGui::GetDrawData(), m_Generation);
+	}
+
+	ImGuiLayerStats ImGuiLayer::GetStats() const
+	{
+		ImGuiLayerStats stats = m_Stats;
+		stats.SavedMs = (double)stats.FramesSkipped * stats.AverageBuildMs;
+		stats.Renderer = m_Renderer.GetStats();
+		return stats;
+	}
+
+	void ImGuiLayer::MarkActive()
+	{
+		m_LastActivity = Profiler::Now();
+	}
+
 	void ImGuiLayer::Begin()
 	{
-		ImGui_ImplOpenGL3_NewFrame();
-		ImGui_ImplGlfw_NewFrame();
+		m_BuildStart = Profiler::Now();
+
+		if (m_Headless)
+		{
+			ImGuiIO& io = ImGui::GetIO();
+			io.DisplaySize = ImVec2((float)m_DisplayWidth, (float)m_DisplayHeight);
+			io.DeltaTime = 1.0f / 60.0f;
+		}
+		else
+		{
+			ImGui_ImplGlfw_NewFrame();
+		}
 		ImGui::NewFrame();
 		//ImGuizmo::BeginFrame(); TODO: Add a ImGuizmo
 	}
@@ -68,18 +160,220 @@ namespace RockEngine {
 	void ImGuiLayer::End()
 	{
 		ImGuiIO& io = ImGui::GetIO();
-		Application& app = Application::Get();
-		io.DisplaySize = ImVec2((float)app.GetWindow().GetWidth(), (float)app.GetWindow().GetHeight());
+		io.DisplaySize = ImVec2((float)m_DisplayWidth, (float)m_DisplayHeight);
 
 		// Rendering
 		ImGui::Render();
-		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		m_Generation++;
+
+		// Dragging a slider or typing animates without further events
+		if (ImGui::IsAnyItemActive())
+			MarkActive();
+
+		float buildMs = (float)((Profiler::Now() - m_BuildStart) / 1e6);
+		m_Stats.FramesBuilt++;
+		m_Stats.AverageBuildMs += (buildMs - m_Stats.AverageBuildMs) / (float)std::min<uint64_t>(m_Stats.FramesBuilt, 60);
+
+		if (!m_Headless && !m_RenderThreaded)
+			m_Renderer.Render(ImGui::GetDrawData(), m_Generation);
+	}
+
+	void ImGuiLayer::CaptureDrawData(ImGuiDrawSnapshot& snapshot)
+	{
+		// Packets are reused round robin, one that already holds this frame keeps its copy
+		if (snapshot.IsValid() && snapshot.GetGeneration() == m_Generation)
+			return;
+		snapshot.Capture(ImGui::GetDrawData(), m_Generation);
+	}
+
+	void ImGuiLayer::RenderDrawData(ImGuiDrawSnapshot& snapshot)
+	{
+		if (!m_Headless && snapshot.IsValid())
+			m_Renderer.Render(snapshot.GetDrawData(), snapshot.GetGeneration());
+	}
+
+	bool ImGuiLayer::OnWindowResize(const WindowResizeEvent& event)
+	{
+		m_DisplayWidth = event.Width;
+		m_DisplayHeight = event.Height;
+		MarkActive();
+		return false;
+	}
+
+	bool ImGuiLayer::OnWindowFocus(const WindowFocusEvent& event)
+	{
+		MarkActive();
+		return false;
+	}
+
+	bool ImGuiLayer::OnKeyPressed(const KeyPressedEvent& event)
+	{
+		MarkActive();
+		return ImGui::GetIO().WantCaptureKeyboard;
+	}
+
+	bool ImGuiLayer::OnKeyReleased(const KeyReleasedEvent& event)
+	{
+		MarkActive();
+		return ImGui::GetIO().WantCaptureKeyboard;
+	}
+
+	bool ImGuiLayer::OnKeyTyped(const KeyTypedEvent& event)
+	{
+		MarkActive();
+		return ImGui::GetIO().WantCaptureKeyboard;
+	}
+
+	bool ImGuiLayer::OnMouseButtonPressed(const MouseButtonPressedEvent& event)
+	{
+		MarkActive();
+		return ImGui::GetIO().WantCaptureMouse;
+	}
+
+	bool ImGuiLayer::OnMouseButtonReleased(const MouseButtonReleasedEvent& event)
+	{
+		MarkActive();
+		return ImGui::GetIO().WantCaptureMouse;
+	}
+
+	bool ImGuiLayer::OnMouseMoved(const MouseMovedEvent& event)
+	{
+		MarkActive();
+		return false;
+	}
+
+	bool ImGuiLayer::OnMouseScrolled(const MouseScrolledEvent& event)
+	{
+		MarkActive();
+		return ImGui::GetIO().WantCaptureMouse;
 	}
 
 	void ImGuiLayer::OnImGuiRender()
 	{
 		ImGui::ShowDemoWindow();
 
+#ifdef RE_ENABLE_PROFILING
+		DrawProfilerPanel();
+#endif
+#ifdef RE_ENABLE_MEMORY_TRACKING
+		DrawMemoryPanel();
+#endif
+	}
+
+	void ImGuiLayer::DrawProfilerPanel()
+	{
+		ImGui::Begin("Profiler");
+
+		float frameTime = Profiler::GetLastFrameTime();
+		ImGui::Text("Frame: %.3f ms (%.1f FPS)", frameTime, frameTime > 0.0f ? 1000.0f / frameTime : 0.0f);
+		ImGui::PlotLines("##FrameTimes", Profiler::GetFrameTimes(), Profiler::FrameHistorySize, Profiler::GetFrameTimeOffset(),
+			"Frame time (ms)", 0.0f, 33.3f, ImVec2(0, 80));
+
+		// Frame to frame, including pacing and vsync waits
+		Window& window = Application::Get().GetWindow();
+		FrameTimer& timer = Application::Get().GetFrameTimer();
+		FrameTimeStats timing;
+		timer.GetStats(timing);
+		ImGui::Text("Interval: avg %.2f  p50 %.2f  p99 %.2f  max %.2f ms", timing.AverageMs, timing.P50Ms, timing.P99Ms, timing.MaxMs);
+		if (timer.GetDroppedFixedSteps())
+			ImGui::Text("Dropped fixed steps: %llu", (unsigned long long)timer.GetDroppedFixedSteps());
+
+		bool vsync = window.IsVSync();
+		if (ImGui::Checkbox("VSync", &vsync))
+			window.SetVSync(vsync);
+
+		FrameTimingProps props = timer.GetProps();
+		if (ImGui::SliderFloat("FPS cap", &props.MaxFrameRate, 0.0f, 240.0f, props.MaxFrameRate > 0.0f ? "%.0f" : "off"))
+			timer.SetProps(props);
+
+		const Renderer2DStats& stats2D = Renderer2D::GetLastFrameStats();
+		ImGui::Text("2D: %u draw calls, %u quads, %u vertices", stats2D.DrawCalls, stats2D.Quads, stats2D.GetVertexCount());
+
+		ImGuiLayerStats statsUI = GetStats();
+		ImGui::Text("UI: %.3f ms/build, %llu built, %llu skipped idle (~%.0f ms saved)", statsUI.AverageBuildMs,
+			(unsigned long long)statsUI.FramesBuilt, (unsigned long long)statsUI.FramesSkipped, statsUI.SavedMs);
+		ImGui::Text("UI buffers: %llu uploaded (%.1f MB), %llu unchanged", (unsigned long long)statsUI.Renderer.BuffersUploaded,
+			statsUI.Renderer.BytesUploaded / (1024.0 * 1024.0), (unsigned long long)statsUI.Renderer.BuffersReused);
+		if (ImGui::Checkbox("Idle UI", &m_IdleProps.Enabled))
+			MarkDirty();
+
+		if (Profiler::IsCapturing())
+			ImGui::Text("Capturing...");
+		else if (ImGui::Button("Capture 120 frames"))
+			Profiler::BeginCapture("RockEngine-trace.json", 120);
+
+		if (Profiler::GetDroppedEvents())
+			ImGui::Text("Dropped events: %llu", (unsigned long long)Profiler::GetDroppedEvents());
+
+		ImGui::Separator();
+		if (ImGui::BeginTable("##Scopes", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+		{
+			ImGui::TableSetupColumn("Scope");
+			ImGui::TableSetupColumn("ms");
+			ImGui::TableSetupColumn("Calls");
+			ImGui::TableHeadersRow();
+
+			for (const ProfileScopeStats& scope : Profiler::GetLastFrameScopes())
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(scope.Name->c_str());
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", scope.TotalMs);
+				ImGui::TableNextColumn();
+				ImGui::Text("%u", scope.Calls);
+			}
+			ImGui::EndTable();
+		}
+
+		ImGui::End();
+	}
+
+	void ImGuiLayer::DrawMemoryPanel()
+	{
+		static std::vector<MemoryTagStats> s_Stats;
+		MemoryTracker::GetStats(s_Stats);
+
+		ImGui::Begin("Memory");
+
+		if (ImGui::BeginTable("##MemoryTags", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+		{
+			ImGui::TableSetupColumn("Tag");
+			ImGui::TableSetupColumn("Live KB");
+			ImGui::TableSetupColumn("Peak KB");
+			ImGui::TableSetupColumn("Allocs/frame");
+			ImGui::TableSetupColumn("Peak allocs/frame");
+			ImGui::TableSetupColumn("Budget");
+			ImGui::TableHeadersRow();
+
+			for (const MemoryTagStats& tag : s_Stats)
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				if (tag.OverBudget)
+					ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", tag.Name);
+				else
+					ImGui::TextUnformatted(tag.Name);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1f", tag.CurrentBytes / 1024.0);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1f", tag.PeakBytes / 1024.0);
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", (unsigned long long)tag.FrameAllocations);
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", (unsigned long long)tag.PeakFrameAllocations);
+				ImGui::TableNextColumn();
+				if (tag.Budget.MaxBytes)
+					ImGui::ProgressBar((float)tag.CurrentBytes / tag.Budget.MaxBytes, ImVec2(-1, 0));
+				else if (tag.Budget.MaxAllocationsPerFrame)
+					ImGui::ProgressBar((float)tag.FrameAllocations / tag.Budget.MaxAllocationsPerFrame, ImVec2(-1, 0));
+				else
+					ImGui::TextUnformatted("-");
+			}
+			ImGui::EndTable();
+		}
+
+		ImGui::End();
 	}
 
 }
\ No newline at end of file
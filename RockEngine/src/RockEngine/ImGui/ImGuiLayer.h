@@ -1,9 +1,33 @@
 #pragma once
 
+#include <atomic>
+
 #include "RockEngine/Core/Layer.h"
+#include "RockEngine/ImGui/ImGuiDrawSnapshot.h"
+#include "RockEngine/Platform/OpenGL/OpenGLImGuiRenderer.h"
 
 namespace RockEngine
 { 
+	struct ImGuiIdleProps
+	{
+		// Off: the UI is built every frame
+		bool Enabled = false;
+		// After input, a resize or MarkDirty() frames keep being built this long, so hover
+		// highlights, fades and scrolling settle
+		float ActiveSeconds = 0.5f;
+		// Live panels (profiler, memory) still refresh this often while idle, 0 never
+		float RefreshSeconds = 0.25f;
+	};
+
+	struct ImGuiLayerStats
+	{
+		uint64_t FramesBuilt = 0;
+		uint64_t FramesSkipped = 0;		// idle, the last frame's draw data presented again
+		float AverageBuildMs = 0.0f;	// Begin, every layer's OnImGuiRender and End
+		double SavedMs = 0.0;			// skipped frames at the average build cost
+		ImGuiRendererStats Renderer;
+	};
+
 	class ImGuiLayer : public Layer
 	{
 	public:
@@ -14,12 +38,54 @@ namespace RockEngine
 		void Begin();
 		void End();
 
+		// Idle UI: while nothing happened, Application::RenderImGui skips Begin, the layers and
+		// End, and SkipFrame() presents the last frame's draw data again
+		void SetIdleProps(const ImGuiIdleProps& props) { m_IdleProps = props; }
+		inline const ImGuiIdleProps& GetIdleProps() const { return m_IdleProps; }
+		bool ShouldBuildFrame();
+		void SkipFrame();
+		// For layers whose UI changes without input (a finished load, new log lines), from any thread
+		void MarkDirty() { m_Dirty.store(true, std::memory_order_relaxed); }
+
+		ImGuiLayerStats GetStats() const;
+
+		// With a render thread End() only builds the draw data, the render thread presents a
+		// snapshot of it. CaptureDrawData copies a frame once per snapshot, RenderDrawData runs
+		// on the thread owning the graphics context.
+		void SetRenderThreaded(bool threaded) { m_RenderThreaded = threaded; }
+		void CaptureDrawData(ImGuiDrawSnapshot& snapshot);
+		void RenderDrawData(ImGuiDrawSnapshot& snapshot);
 
 		virtual void OnAttach() override;
 		virtual void OnDetach() override;
 		virtual void OnImGuiRender() override;
+	private:
+		bool OnWindowResize(const WindowResizeEvent& event);
+		bool OnWindowFocus(const WindowFocusEvent& event);
+		bool OnKeyPressed(const KeyPressedEvent& event);
+		bool OnKeyReleased(const KeyReleasedEvent& event);
+		bool OnKeyTyped(const KeyTypedEvent& event);
+		bool OnMouseButtonPressed(const MouseButtonPressedEvent& event);
+		bool OnMouseButtonReleased(const MouseButtonReleasedEvent& event);
+		bool OnMouseMoved(const MouseMovedEvent& event);
+		bool OnMouseScrolled(const MouseScrolledEvent& event);
+		void MarkActive();
+
+		void DrawProfilerPanel();
+		void DrawMemoryPanel();
 	private:
 		float m_Time = 0.0f;
+		bool m_Headless = false;
+		bool m_RenderThreaded = false;
+		uint32_t m_DisplayWidth = 0, m_DisplayHeight = 0;
+		OpenGLImGuiRenderer m_Renderer;
+
+		ImGuiIdleProps m_IdleProps;
+		std::atomic<bool> m_Dirty{ false };
+		uint64_t m_LastActivity = 0;
+		uint64_t m_BuildStart = 0;
+		uint64_t m_Generation = 0;		// of the draw data End() built last
+		ImGuiLayerStats m_Stats;
 	};
 
 }
\ No newline at end of file
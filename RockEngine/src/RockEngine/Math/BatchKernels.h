@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+
+#include "RockEngine/Math/Matrix.h"
+
+namespace RockEngine
+{
+	// Structure-of-arrays views: element n is (X[n], Y[n], Z[n]). Streams of one call may alias
+	// each other only where noted.
+	struct Vec3Stream
+	{
+		float* X;
+		float* Y;
+		float* Z;
+	};
+
+	struct ConstVec3Stream
+	{
+		const float* X;
+		const float* Y;
+		const float* Z;
+
+		ConstVec3Stream(const float* x, const float* y, const float* z) : X(x), Y(y), Z(z) {}
+		ConstVec3Stream(const Vec3Stream& stream) : X(stream.X), Y(stream.Y), Z(stream.Z) {}
+	};
+
+	struct ConstQuatStream
+	{
+		const float* X;
+		const float* Y;
+		const float* Z;
+		const float* W;
+	};
+
+	// Loops over many elements at once, 8 lanes per iteration in every backend (the SSE 8 lane
+	// register is two 4 lane halves). Tails run through the same code on a padded copy.
+	template<typename Backend>
+	class BatchKernels
+	{
+	public:
+		using Float8 = typename SimdTraits<Backend>::Float8;
+		using Mat4 = BasicMat4<Backend>;
+
+		static constexpr uint32_t Width = Float8::Width;
+
+		// out[n] = (m * (points[n], 1)).xyz, no perspective divide. `out` may be `points`.
+		static void TransformPoints(const Mat4& m, ConstVec3Stream points, Vec3Stream out, uint32_t count)
+		{
+			Float8 e[12];
+			for (uint32_t column = 0; column < 4; column++)
+			{
+				for (uint32_t row = 0; row < 3; row++)
+					e[column * 3 + row] = Float8::Splat(m.Get(row, column));
+			}
+
+			auto transform = [&e](const float* x, const float* y, const float* z, float* outX, float* outY, float* outZ)
+			{
+				Float8 px = Float8::Load(x), py = Float8::Load(y), pz = Float8::Load(z);
+				MulAdd(e[0], px, MulAdd(e[3], py, MulAdd(e[6], pz, e[9]))).Store(outX);
+				MulAdd(e[1], px, MulAdd(e[4], py, MulAdd(e[7], pz, e[10]))).Store(outY);
+				MulAdd(e[2], px, MulAdd(e[5], py, MulAdd(e[8], pz, e[11]))).Store(outZ);
+			};
+
+			uint32_t n = 0;
+			for (; n + Width <= count; n += Width)
+				transform(points.X + n, points.Y + n, points.Z + n, out.X + n, out.Y + n, out.Z + n);
+
+			if (n < count)
+			{
+				float tail[6][Width] = {};
+				uint32_t remaining = count - n;
+				std::copy(points.X + n, points.X + count, tail[0]);
+				std::copy(points.Y + n, points.Y + count, tail[1]);
+				std::copy(points.Z + n, points.Z + count, tail[2]);
+				transform(tail[0], tail[1], tail[2], tail[3], tail[4], tail[5]);
+				std::copy(tail[3], tail[3] + remaining, out.X + n);
+				std::copy(tail[4], tail[4] + remaining, out.Y + n);
+				std::copy(tail[5], tail[5] + remaining, out.Z + n);
+			}
+		}
+
+		// out[n] = a[n] * b[n]. `out` may be `a` or `b`.
+		static void MultiplyMatrices(const Mat4* a, const Mat4* b, Mat4* out, uint32_t count)
+		{
+			for (uint32_t n = 0; n < count; n++)
+				out[n] = a[n] * b[n];
+		}
+
+		// out[n] = parent * local[n], the parent's columns stay in registers. `out` may be `local`.
+		static void MultiplyMatrices(const Mat4& parent, const Mat4* local, Mat4* out, uint32_t count)
+		{
+			const float* p = parent.Data();
+			Float8 a0 = Float8::BroadcastFloat4(p);
+			Float8 a1 = Float8::BroadcastFloat4(p + 4);
+			Float8 a2 = Float8::BroadcastFloat4(p + 8);
+			Float8 a3 = Float8::BroadcastFloat4(p + 12);
+			for (uint32_t n = 0; n < count; n++)
+			{
+				const float* source = local[n].Data();
+				Float8 lo = Float8::Load(source), hi = Float8::Load(source + 8);
+				Float8 rlo = MulAdd(a3, SplatLane4<3>(lo), MulAdd(a2, SplatLane4<2>(lo), MulAdd(a1, SplatLane4<1>(lo), a0 * SplatLane4<0>(lo))));
+				Float8 rhi = MulAdd(a3, SplatLane4<3>(hi), MulAdd(a2, SplatLane4<2>(hi), MulAdd(a1, SplatLane4<1>(hi), a0 * SplatLane4<0>(hi))));
+				rlo.Store(out[n].Data());
+				rhi.Store(out[n].Data() + 8);
+			}
+		}
+
+		// out[n] = Mat4::TRS(translations[n], rotations[n], scales[n]). The matrix elements are
+		// built 8 matrices at a time, one element per register, then transposed into place.
+		static void BuildTRS(ConstVec3Stream translations, ConstQuatStream rotations, ConstVec3Stream scales, Mat4* out, uint32_t count)
+		{
+			auto build = [](const float* const* in, Mat4* matrices)
+			{
+				Float8 x = Float8::Load(in[3]), y = Float8::Load(in[4]), z = Float8::Load(in[5]), w = Float8::Load(in[6]);
+				Float8 sx = Float8::Load(in[7]), sy = Float8::Load(in[8]), sz = Float8::Load(in[9]);
+				Float8 one = Float8::Splat(1.0f), two = Float8::Splat(2.0f), zero = Float8::Zero();
+
+				Float8 x2 = x * two, y2 = y * two, z2 = z * two;
+				Float8 xx = x * x2, yy = y * y2, zz = z * z2;
+				Float8 xy = x * y2, xz = x * z2, yz = y * z2;
+				Float8 wx = w * x2, wy = w * y2, wz = w * z2;
+
+				// Column-major element order (see BasicMat3::Rotation), split into the two 8x8 blocks
+				Float8 e[2][8] =
+				{
+					{
+						(one - yy - zz) * sx, (xy + wz) * sx, (xz - wy) * sx, zero,
+						(xy - wz) * sy, (one - xx - zz) * sy, (yz + wx) * sy, zero
+					},
+					{
+						(xz + wy) * sz, (yz - wx) * sz, (one - xx - yy) * sz, zero,
+						Float8::Load(in[0]), Float8::Load(in[1]), Float8::Load(in[2]), one
+					}
+				};
+
+				Transpose8x8(e[0]);
+				Transpose8x8(e[1]);
+				for (uint32_t i = 0; i < Width; i++)
+				{
+					e[0][i].Store(matrices[i].Data());
+					e[1][i].Store(matrices[i].Data() + 8);
+				}
+			};
+
+			const float* const streams[10] =
+			{
+				translations.X, translations.Y, translations.Z,
+				rotations.X, rotations.Y, rotations.Z, rotations.W,
+				scales.X, scales.Y, scales.Z
+			};
+
+			uint32_t n = 0;
+			for (; n + Width <= count; n += Width)
+			{
+				const float* const in[10] =
+				{
+					streams[0] + n, streams[1] + n, streams[2] + n, streams[3] + n, streams[4] + n,
+					streams[5] + n, streams[6] + n, streams[7] + n, streams[8] + n, streams[9] + n
+				};
+				build(in, out + n);
+			}
+
+			if (n < count)
+			{
+				float tail[10][Width] = {};
+				const float* in[10];
+				for (uint32_t s = 0; s < 10; s++)
+				{
+					std::copy(streams[s] + n, streams[s] + count, tail[s]);
+					in[s] = tail[s];
+				}
+
+				Mat4 matrices[Width];
+				build(in, matrices);
+				std::copy(matrices, matrices + (count - n), out + n);
+			}
+		}
+	};
+
+	using Batch = BatchKernels<SimdDefault>;
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "RockEngine/Math/Simd.h"
+#include "RockEngine/Math/Vector.h"
+#include "RockEngine/Math/Quat.h"
+#include "RockEngine/Math/Matrix.h"
+#include "RockEngine/Math/BatchKernels.h"
+
+namespace RockEngine
+{
+	static constexpr float Pi = 3.14159265358979323846f;
+
+	inline constexpr float Radians(float degrees) { return degrees * (Pi / 180.0f); }
+	inline constexpr float Degrees(float radians) { return radians * (180.0f / Pi); }
+}
\ No newline at end of file
@@ -0,0 +1,269 @@
+#pragma once
+
+#include "RockEngine/Math/Quat.h"
+
+namespace RockEngine
+{
+	// Column-major like the renderer, columns padded to 4 floats (the padding stays 0)
+	template<typename Backend>
+	class BasicMat3
+	{
+	public:
+		using Float4 = typename SimdTraits<Backend>::Float4;
+		using Vec3 = BasicVec3<Backend>;
+		using Quat = BasicQuat<Backend>;
+
+		BasicMat3() : BasicMat3(Vec3(1.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f), Vec3(0.0f, 0.0f, 1.0f)) {}
+		BasicMat3(const Vec3& c0, const Vec3& c1, const Vec3& c2)
+		{
+			c0.GetValue().Store(m_Elements);
+			c1.GetValue().Store(m_Elements + 4);
+			c2.GetValue().Store(m_Elements + 8);
+		}
+
+		static BasicMat3 Identity() { return BasicMat3(); }
+		static BasicMat3 Scale(const Vec3& scale)
+		{
+			return BasicMat3(Vec3(scale.GetX(), 0.0f, 0.0f), Vec3(0.0f, scale.GetY(), 0.0f), Vec3(0.0f, 0.0f, scale.GetZ()));
+		}
+
+		// `rotation` must be normalized
+		static BasicMat3 Rotation(const Quat& rotation)
+		{
+			float x = rotation.GetX(), y = rotation.GetY(), z = rotation.GetZ(), w = rotation.GetW();
+			float xx = x * x, yy = y * y, zz = z * z;
+			float xy = x * y, xz = x * z, yz = y * z;
+			float wx = w * x, wy = w * y, wz = w * z;
+			return BasicMat3(
+				Vec3(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy)),
+				Vec3(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx)),
+				Vec3(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy)));
+		}
+
+		inline Vec3 GetColumn(uint32_t column) const { return Vec3(Float4::Load(m_Elements + column * 4)); }
+		inline float Get(uint32_t row, uint32_t column) const { return m_Elements[column * 4 + row]; }
+
+		Vec3 operator*(const Vec3& v) const
+		{
+			const Float4& value = v.GetValue();
+			Float4 r = Float4::Load(m_Elements) * Swizzle<0, 0, 0, 0>(value);
+			r = MulAdd(Float4::Load(m_Elements + 4), Swizzle<1, 1, 1, 1>(value), r);
+			return Vec3(MulAdd(Float4::Load(m_Elements + 8), Swizzle<2, 2, 2, 2>(value), r));
+		}
+
+		BasicMat3 operator*(const BasicMat3& other) const
+		{
+			return BasicMat3(*this * other.GetColumn(0), *this * other.GetColumn(1), *this * other.GetColumn(2));
+		}
+
+		BasicMat3 Transposed() const
+		{
+			Float4 c0 = Float4::Load(m_Elements), c1 = Float4::Load(m_Elements + 4), c2 = Float4::Load(m_Elements + 8), c3 = Float4::Zero();
+			Transpose(c0, c1, c2, c3);
+			return BasicMat3(Vec3(c0), Vec3(c1), Vec3(c2));
+		}
+
+		inline float Determinant() const { return Dot(GetColumn(0), Cross(GetColumn(1), GetColumn(2))); }
+
+		// Rows of the inverse are the cross products of the other two columns over the determinant
+		BasicMat3 Inverse() const
+		{
+			Vec3 c0 = GetColumn(0), c1 = GetColumn(1), c2 = GetColumn(2);
+			Vec3 r0 = Cross(c1, c2), r1 = Cross(c2, c0), r2 = Cross(c0, c1);
+			float invDeterminant = 1.0f / Dot(c0, r0);
+			return BasicMat3(r0 * invDeterminant, r1 * invDeterminant, r2 * invDeterminant).Transposed();
+		}
+
+		inline const float* Data() const { return m_Elements; }
+	private:
+		alignas(16) float m_Elements[12];
+	};
+
+	template<typename Backend>
+	class BasicMat4
+	{
+	public:
+		using Float4 = typename SimdTraits<Backend>::Float4;
+		using Float8 = typename SimdTraits<Backend>::Float8;
+		using Vec3 = BasicVec3<Backend>;
+		using Vec4 = BasicVec4<Backend>;
+		using Quat = BasicQuat<Backend>;
+		using Mat3 = BasicMat3<Backend>;
+
+		BasicMat4() : BasicMat4(Vec4(1.0f, 0.0f, 0.0f, 0.0f), Vec4(0.0f, 1.0f, 0.0f, 0.0f), Vec4(0.0f, 0.0f, 1.0f, 0.0f), Vec4(0.0f, 0.0f, 0.0f, 1.0f)) {}
+		BasicMat4(const Vec4& c0, const Vec4& c1, const Vec4& c2, const Vec4& c3)
+		{
+			c0.GetValue().Store(m_Elements);
+			c1.GetValue().Store(m_Elements + 4);
+			c2.GetValue().Store(m_Elements + 8);
+			c3.GetValue().Store(m_Elements + 12);
+		}
+		// Upper 3x3 plus a translation column
+		BasicMat4(const Mat3& linear, const Vec3& translation)
+			: BasicMat4(Vec4(linear.GetColumn(0).GetValue()), Vec4(linear.GetColumn(1).GetValue()), Vec4(linear.GetColumn(2).GetValue()),
+				Vec4(translation.GetValue() + Float4::Set(0.0f, 0.0f, 0.0f, 1.0f)))
+		{}
+
+		static BasicMat4 Identity() { return BasicMat4(); }
+		static BasicMat4 FromData(const float* columnMajor)
+		{
+			BasicMat4 result;
+			std::copy(columnMajor, columnMajor + 16, result.m_Elements);
+			return result;
+		}
+
+		static BasicMat4 Translation(const Vec3& translation) { return BasicMat4(Mat3(), translation); }
+		static BasicMat4 Scale(const Vec3& scale) { return BasicMat4(Mat3::Scale(scale), Vec3()); }
+		static BasicMat4 Rotation(const Quat& rotation) { return BasicMat4(Mat3::Rotation(rotation), Vec3()); }
+
+		// Scale, then rotate, then translate
+		static BasicMat4 TRS(const Vec3& translation, const Quat& rotation, const Vec3& scale)
+		{
+			Mat3 r = Mat3::Rotation(rotation);
+			return BasicMat4(Mat3(r.GetColumn(0) * scale.GetX(), r.GetColumn(1) * scale.GetY(), r.GetColumn(2) * scale.GetZ()), translation);
+		}
+
+		// OpenGL clip space, z in [-1, 1]
+		static BasicMat4 Orthographic(float left, float right, float bottom, float top, float nearPlane, float farPlane)
+		{
+			return BasicMat4(
+				Vec4(2.0f / (right - left), 0.0f, 0.0f, 0.0f),
+				Vec4(0.0f, 2.0f / (top - bottom), 0.0f, 0.0f),
+				Vec4(0.0f, 0.0f, -2.0f / (farPlane - nearPlane), 0.0f),
+				Vec4(-(right + left) / (right - left), -(top + bottom) / (top - bottom), -(farPlane + nearPlane) / (farPlane - nearPlane), 1.0f));
+		}
+
+		static BasicMat4 Perspective(float fovY, float aspect, float nearPlane, float farPlane)
+		{
+			float f = 1.0f / std::tan(0.5f * fovY);
+			return BasicMat4(
+				Vec4(f / aspect, 0.0f, 0.0f, 0.0f),
+				Vec4(0.0f, f, 0.0f, 0.0f),
+				Vec4(0.0f, 0.0f, (farPlane + nearPlane) / (nearPlane - farPlane), -1.0f),
+				Vec4(0.0f, 0.0f, 2.0f * farPlane * nearPlane / (nearPlane - farPlane), 0.0f));
+		}
+
+		// Right handed view matrix, looking down -z
+		static BasicMat4 LookAt(const Vec3& eye, const Vec3& target, const Vec3& up)
+		{
+			Vec3 forward = Normalize(target - eye);
+			Vec3 side = Normalize(Cross(forward, up));
+			Vec3 cameraUp = Cross(side, forward);
+
+			Float4 r0 = side.GetValue(), r1 = cameraUp.GetValue(), r2 = (-forward).GetValue(), r3 = Float4::Zero();
+			Transpose(r0, r1, r2, r3);
+			return BasicMat4(Vec4(r0), Vec4(r1), Vec4(r2), Vec4(-Dot(side, eye), -Dot(cameraUp, eye), Dot(forward, eye), 1.0f));
+		}
+
+		inline Vec4 GetColumn(uint32_t column) const { return Vec4(Float4::Load(m_Elements + column * 4)); }
+		inline float Get(uint32_t row, uint32_t column) const { return m_Elements[column * 4 + row]; }
+		inline Mat3 GetMat3() const { return Mat3(GetColumn(0).GetXYZ(), GetColumn(1).GetXYZ(), GetColumn(2).GetXYZ()); }
+
+		// Two result columns per step: each half of an 8 lane register holds one column, so AVX
+		// does the product in 8 multiply-adds
+		BasicMat4 operator*(const BasicMat4& other) const
+		{
+			BasicMat4 result;
+			Float8 a0 = Float8::BroadcastFloat4(m_Elements);
+			Float8 a1 = Float8::BroadcastFloat4(m_Elements + 4);
+			Float8 a2 = Float8::BroadcastFloat4(m_Elements + 8);
+			Float8 a3 = Float8::BroadcastFloat4(m_Elements + 12);
+			for (uint32_t i = 0; i < 16; i += 8)
+			{
+				Float8 b = Float8::Load(other.m_Elements + i);
+				Float8 r = a0 * SplatLane4<0>(b);
+				r = MulAdd(a1, SplatLane4<1>(b), r);
+				r = MulAdd(a2, SplatLane4<2>(b), r);
+				r = MulAdd(a3, SplatLane4<3>(b), r);
+				r.Store(result.m_Elements + i);
+			}
+			return result;
+		}
+
+		Vec4 operator*(const Vec4& v) const
+		{
+			const Float4& value = v.GetValue();
+			Float4 r = Float4::Load(m_Elements) * Swizzle<0, 0, 0, 0>(value);
+			r = MulAdd(Float4::Load(m_Elements + 4), Swizzle<1, 1, 1, 1>(value), r);
+			r = MulAdd(Float4::Load(m_Elements + 8), Swizzle<2, 2, 2, 2>(value), r);
+			return Vec4(MulAdd(Float4::Load(m_Elements + 12), Swizzle<3, 3, 3, 3>(value), r));
+		}
+
+		// w = 1, no perspective divide
+		inline Vec3 TransformPoint(const Vec3& point) const { return (*this * Vec4(point.GetValue() + Float4::Set(0.0f, 0.0f, 0.0f, 1.0f))).GetXYZ(); }
+		// w = 0
+		inline Vec3 TransformDirection(const Vec3& direction) const { return (*this * Vec4(direction.GetValue())).GetXYZ(); }
+
+		BasicMat4 Transposed() const
+		{
+			Float4 c0 = Float4::Load(m_Elements), c1 = Float4::Load(m_Elements + 4), c2 = Float4::Load(m_Elements + 8), c3 = Float4::Load(m_Elements + 12);
+			Transpose(c0, c1, c2, c3);
+			return BasicMat4(Vec4(c0), Vec4(c1), Vec4(c2), Vec4(c3));
+		}
+
+		// For [linear | translation] matrices: the inverse linear part and its -inverse * translation
+		BasicMat4 AffineInverse() const
+		{
+			Mat3 inverse = GetMat3().Inverse();
+			return BasicMat4(inverse, -(inverse * GetColumn(3).GetXYZ()));
+		}
+
+		// General inverse by 2x2 sub-determinants (Laplace expansion along the top two rows).
+		// Scalar in every backend, prefer AffineInverse where it applies.
+		BasicMat4 Inverse() const
+		{
+			auto a = [this](uint32_t row, uint32_t column) { return m_Elements[column * 4 + row]; };
+
+			float s0 = a(0, 0) * a(1, 1) - a(1, 0) * a(0, 1);
+			float s1 = a(0, 0) * a(1, 2) - a(1, 0) * a(0, 2);
+			float s2 = a(0, 0) * a(1, 3) - a(1, 0) * a(0, 3);
+			float s3 = a(0, 1) * a(1, 2) - a(1, 1) * a(0, 2);
+			float s4 = a(0, 1) * a(1, 3) - a(1, 1) * a(0, 3);
+			float s5 = a(0, 2) * a(1, 3) - a(1, 2) * a(0, 3);
+
+			float c5 = a(2, 2) * a(3, 3) - a(3, 2) * a(2, 3);
+			float c4 = a(2, 1) * a(3, 3) - a(3, 1) * a(2, 3);
+			float c3 = a(2, 1) * a(3, 2) - a(3, 1) * a(2, 2);
+			float c2 = a(2, 0) * a(3, 3) - a(3, 0) * a(2, 3);
+			float c1 = a(2, 0) * a(3, 2) - a(3, 0) * a(2, 2);
+			float c0 = a(2, 0) * a(3, 1) - a(3, 0) * a(2, 1);
+
+			float invDeterminant = 1.0f / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+			// Rows of the inverse, transposed into columns on the way out
+			float rows[16] =
+			{
+				 a(1, 1) * c5 - a(1, 2) * c4 + a(1, 3) * c3,
+				-a(0, 1) * c5 + a(0, 2) * c4 - a(0, 3) * c3,
+				 a(3, 1) * s5 - a(3, 2) * s4 + a(3, 3) * s3,
+				-a(2, 1) * s5 + a(2, 2) * s4 - a(2, 3) * s3,
+
+				-a(1, 0) * c5 + a(1, 2) * c2 - a(1, 3) * c1,
+				 a(0, 0) * c5 - a(0, 2) * c2 + a(0, 3) * c1,
+				-a(3, 0) * s5 + a(3, 2) * s2 - a(3, 3) * s1,
+				 a(2, 0) * s5 - a(2, 2) * s2 + a(2, 3) * s1,
+
+				 a(1, 0) * c4 - a(1, 1) * c2 + a(1, 3) * c0,
+				-a(0, 0) * c4 + a(0, 1) * c2 - a(0, 3) * c0,
+				 a(3, 0) * s4 - a(3, 1) * s2 + a(3, 3) * s0,
+				-a(2, 0) * s4 + a(2, 1) * s2 - a(2, 3) * s0,
+
+				-a(1, 0) * c3 + a(1, 1) * c1 - a(1, 2) * c0,
+				 a(0, 0) * c3 - a(0, 1) * c1 + a(0, 2) * c0,
+				-a(3, 0) * s3 + a(3, 1) * s1 - a(3, 2) * s0,
+				 a(2, 0) * s3 - a(2, 1) * s1 + a(2, 2) * s0
+			};
+			for (float& element : rows)
+				element *= invDeterminant;
+			return FromData(rows).Transposed();
+		}
+
+		inline const float* Data() const { return m_Elements; }
+		inline float* Data() { return m_Elements; }
+	private:
+		alignas(16) float m_Elements[16];
+	};
+
+	using Mat3 = BasicMat3<SimdDefault>;
+	using Mat4 = BasicMat4<SimdDefault>;
+}
\ No newline at end of file
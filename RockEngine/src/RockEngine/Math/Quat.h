@@ -0,0 +1,93 @@
+#pragma once
+
+#include "RockEngine/Math/Vector.h"
+
+namespace RockEngine
+{
+	// Rotation quaternion, stored x, y, z, w
+	template<typename Backend>
+	class BasicQuat
+	{
+	public:
+		using Float4 = typename SimdTraits<Backend>::Float4;
+		using Vec3 = BasicVec3<Backend>;
+
+		BasicQuat() : m_Value(Float4::Set(0.0f, 0.0f, 0.0f, 1.0f)) {}
+		BasicQuat(float x, float y, float z, float w) : m_Value(Float4::Set(x, y, z, w)) {}
+		explicit BasicQuat(const Float4& value) : m_Value(value) {}
+
+		static BasicQuat Identity() { return BasicQuat(); }
+
+		// `axis` must be normalized
+		static BasicQuat FromAxisAngle(const Vec3& axis, float radians)
+		{
+			float s = std::sin(0.5f * radians);
+			return BasicQuat(axis.GetValue() * Float4::Splat(s) + Float4::Set(0.0f, 0.0f, 0.0f, std::cos(0.5f * radians)));
+		}
+
+		inline float GetX() const { return m_Value.GetX(); }
+		inline float GetY() const { return m_Value.GetY(); }
+		inline float GetZ() const { return m_Value.GetZ(); }
+		inline float GetW() const { return m_Value.GetW(); }
+		inline const Float4& GetValue() const { return m_Value; }
+
+		// Hamilton product: applies `other` first, then this
+		BasicQuat operator*(const BasicQuat& other) const
+		{
+			const Float4& q = other.m_Value;
+			Float4 r = Swizzle<3, 3, 3, 3>(m_Value) * q;
+			r = MulAdd(Swizzle<0, 0, 0, 0>(m_Value), Swizzle<3, 2, 1, 0>(q) * Float4::Set(1.0f, -1.0f, 1.0f, -1.0f), r);
+			r = MulAdd(Swizzle<1, 1, 1, 1>(m_Value), Swizzle<2, 3, 0, 1>(q) * Float4::Set(1.0f, 1.0f, -1.0f, -1.0f), r);
+			r = MulAdd(Swizzle<2, 2, 2, 2>(m_Value), Swizzle<1, 0, 3, 2>(q) * Float4::Set(-1.0f, 1.0f, 1.0f, -1.0f), r);
+			return BasicQuat(r);
+		}
+
+		// v' = v + w t + q x t with t = 2 (q x v), for unit quaternions
+		Vec3 Rotate(const Vec3& v) const
+		{
+			Vec3 axis(m_Value * Float4::Set(1.0f, 1.0f, 1.0f, 0.0f));
+			Vec3 t = Cross(axis, v) * 2.0f;
+			return v + t * GetW() + Cross(axis, t);
+		}
+
+		inline BasicQuat Conjugate() const { return BasicQuat(m_Value * Float4::Set(-1.0f, -1.0f, -1.0f, 1.0f)); }
+		inline BasicQuat Inverse() const { return BasicQuat(Conjugate().m_Value / Dot4(m_Value, m_Value)); }
+		inline BasicQuat Normalized() const { return BasicQuat(m_Value / Sqrt(Dot4(m_Value, m_Value))); }
+	private:
+		Float4 m_Value;
+	};
+
+	template<typename B>
+	inline float Dot(const BasicQuat<B>& a, const BasicQuat<B>& b) { return Dot4(a.GetValue(), b.GetValue()).GetX(); }
+
+	// Normalized lerp along the shorter arc. Not constant speed, but close for small angles and
+	// much cheaper than Slerp.
+	template<typename B>
+	inline BasicQuat<B> Nlerp(const BasicQuat<B>& a, const BasicQuat<B>& b, float t)
+	{
+		using Float4 = typename BasicQuat<B>::Float4;
+		float sign = Dot(a, b) < 0.0f ? -1.0f : 1.0f;
+		Float4 value = MulAdd(b.GetValue() * Float4::Splat(sign) - a.GetValue(), Float4::Splat(t), a.GetValue());
+		return BasicQuat<B>(value).Normalized();
+	}
+
+	template<typename B>
+	inline BasicQuat<B> Slerp(const BasicQuat<B>& a, const BasicQuat<B>& b, float t)
+	{
+		using Float4 = typename BasicQuat<B>::Float4;
+		float cosine = Dot(a, b);
+		float sign = cosine < 0.0f ? -1.0f : 1.0f;
+		cosine *= sign;
+		// Nearly parallel: sin(angle) is too small to divide by
+		if (cosine > 0.9995f)
+			return Nlerp(a, b, t);
+
+		float angle = std::acos(cosine);
+		float invSin = 1.0f / std::sin(angle);
+		float wa = std::sin((1.0f - t) * angle) * invSin;
+		float wb = std::sin(t * angle) * invSin * sign;
+		return BasicQuat<B>(a.GetValue() * Float4::Splat(wa) + b.GetValue() * Float4::Splat(wb));
+	}
+
+	using Quat = BasicQuat<SimdDefault>;
+}
\ No newline at end of file
@@ -0,0 +1,352 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+	#define RE_SIMD_SSE 1
+	#include <immintrin.h>
+	#if defined(__AVX__)
+		#define RE_SIMD_AVX 1
+	#endif
+	#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+		#define RE_SIMD_FMA 1
+	#endif
+#endif
+
+namespace RockEngine
+{
+	// Index of the lowest set bit, `mask` must not be 0. For walking lane masks.
+	inline uint32_t CountTrailingZeros(uint32_t mask)
+	{
+	#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return (uint32_t)index;
+	#else
+		return (uint32_t)__builtin_ctz(mask);
+	#endif
+	}
+
+	// Backend tags. The math types take one as a template parameter, the plain aliases (Vec3,
+	// Mat4, ...) use SimdDefault: the widest instruction set the build targets. x64 always has
+	// SSE2, AVX needs the --avx premake option.
+	struct SimdScalar {};
+	struct SimdSSE {};
+	struct SimdAVX {};
+
+	// 4 and 8 lane float registers. Every backend has both: the scalar ones are plain arrays,
+	// the SSE 8 lane register is a pair of 128 bit halves. Generic code uses the free functions
+	// below (MulAdd, Swizzle, ...), which are overloaded for each register type.
+
+	struct Float4Scalar
+	{
+		static constexpr uint32_t Width = 4;
+		float V[4];
+
+		static inline Float4Scalar Zero() { return { { 0.0f, 0.0f, 0.0f, 0.0f } }; }
+		static inline Float4Scalar Splat(float value) { return { { value, value, value, value } }; }
+		static inline Float4Scalar Set(float x, float y, float z, float w) { return { { x, y, z, w } }; }
+		static inline Float4Scalar Load(const float* source) { return { { source[0], source[1], source[2], source[3] } }; }
+		inline void Store(float* destination) const { std::copy(V, V + 4, destination); }
+
+		inline float GetX() const { return V[0]; }
+		inline float GetY() const { return V[1]; }
+		inline float GetZ() const { return V[2]; }
+		inline float GetW() const { return V[3]; }
+	};
+
+	struct Float8Scalar
+	{
+		static constexpr uint32_t Width = 8;
+		float V[8];
+
+		static inline Float8Scalar Zero() { return Splat(0.0f); }
+		static inline Float8Scalar Splat(float value) { Float8Scalar r; std::fill(r.V, r.V + 8, value); return r; }
+		static inline Float8Scalar Load(const float* source) { Float8Scalar r; std::copy(source, source + 8, r.V); return r; }
+		// The same four floats in both halves
+		static inline Float8Scalar BroadcastFloat4(const float* source) { Float8Scalar r; std::copy(source, source + 4, r.V); std::copy(source, source + 4, r.V + 4); return r; }
+		inline void Store(float* destination) const { std::copy(V, V + 8, destination); }
+	};
+
+	template<typename F, uint32_t N, typename Op>
+	inline F ScalarLanes(const F& a, const F& b, Op op)
+	{
+		F r;
+		for (uint32_t i = 0; i < N; i++)
+			r.V[i] = op(a.V[i], b.V[i]);
+		return r;
+	}
+
+	inline Float4Scalar operator+(const Float4Scalar& a, const Float4Scalar& b) { return ScalarLanes<Float4Scalar, 4>(a, b, [](float x, float y) { return x + y; }); }
+	inline Float4Scalar operator-(const Float4Scalar& a, const Float4Scalar& b) { return ScalarLanes<Float4Scalar, 4>(a, b, [](float x, float y) { return x - y; }); }
+	inline Float4Scalar operator*(const Float4Scalar& a, const Float4Scalar& b) { return ScalarLanes<Float4Scalar, 4>(a, b, [](float x, float y) { return x * y; }); }
+	inline Float4Scalar operator/(const Float4Scalar& a, const Float4Scalar& b) { return ScalarLanes<Float4Scalar, 4>(a, b, [](float x, float y) { return x / y; }); }
+	inline Float4Scalar operator-(const Float4Scalar& a) { return Float4Scalar::Zero() - a; }
+	inline Float4Scalar MulAdd(const Float4Scalar& a, const Float4Scalar& b, const Float4Scalar& c) { return a * b + c; }
+	inline Float4Scalar Min(const Float4Scalar& a, const Float4Scalar& b) { return ScalarLanes<Float4Scalar, 4>(a, b, [](float x, float y) { return std::min(x, y); }); }
+	inline Float4Scalar Max(const Float4Scalar& a, const Float4Scalar& b) { return ScalarLanes<Float4Scalar, 4>(a, b, [](float x, float y) { return std::max(x, y); }); }
+	inline Float4Scalar Sqrt(const Float4Scalar& a) { return ScalarLanes<Float4Scalar, 4>(a, a, [](float x, float) { return std::sqrt(x); }); }
+
+	// Comparisons return a lane mask: bit i is set if lane i compares true
+	template<typename F, uint32_t N, typename Op>
+	inline uint32_t ScalarMask(const F& a, const F& b, Op op)
+	{
+		uint32_t mask = 0;
+		for (uint32_t i = 0; i < N; i++)
+			mask |= op(a.V[i], b.V[i]) ? 1u << i : 0u;
+		return mask;
+	}
+
+	inline uint32_t CompareLess(const Float4Scalar& a, const Float4Scalar& b) { return ScalarMask<Float4Scalar, 4>(a, b, [](float x, float y) { return x < y; }); }
+	inline uint32_t CompareLessEqual(const Float4Scalar& a, const Float4Scalar& b) { return ScalarMask<Float4Scalar, 4>(a, b, [](float x, float y) { return x <= y; }); }
+
+	template<int X, int Y, int Z, int W>
+	inline Float4Scalar Swizzle(const Float4Scalar& a) { return { { a.V[X], a.V[Y], a.V[Z], a.V[W] } }; }
+
+	// Dot products, splatted to every lane
+	inline Float4Scalar Dot4(const Float4Scalar& a, const Float4Scalar& b) { return Float4Scalar::Splat(a.V[0] * b.V[0] + a.V[1] * b.V[1] + a.V[2] * b.V[2] + a.V[3] * b.V[3]); }
+	inline Float4Scalar Dot3(const Float4Scalar& a, const Float4Scalar& b) { return Float4Scalar::Splat(a.V[0] * b.V[0] + a.V[1] * b.V[1] + a.V[2] * b.V[2]); }
+
+	inline void Transpose(Float4Scalar& r0, Float4Scalar& r1, Float4Scalar& r2, Float4Scalar& r3)
+	{
+		std::swap(r0.V[1], r1.V[0]); std::swap(r0.V[2], r2.V[0]); std::swap(r0.V[3], r3.V[0]);
+		std::swap(r1.V[2], r2.V[1]); std::swap(r1.V[3], r3.V[1]); std::swap(r2.V[3], r3.V[2]);
+	}
+
+	inline Float8Scalar operator+(const Float8Scalar& a, const Float8Scalar& b) { return ScalarLanes<Float8Scalar, 8>(a, b, [](float x, float y) { return x + y; }); }
+	inline Float8Scalar operator-(const Float8Scalar& a, const Float8Scalar& b) { return ScalarLanes<Float8Scalar, 8>(a, b, [](float x, float y) { return x - y; }); }
+	inline Float8Scalar operator*(const Float8Scalar& a, const Float8Scalar& b) { return ScalarLanes<Float8Scalar, 8>(a, b, [](float x, float y) { return x * y; }); }
+	inline Float8Scalar operator/(const Float8Scalar& a, const Float8Scalar& b) { return ScalarLanes<Float8Scalar, 8>(a, b, [](float x, float y) { return x / y; }); }
+	inline Float8Scalar MulAdd(const Float8Scalar& a, const Float8Scalar& b, const Float8Scalar& c) { return a * b + c; }
+	inline Float8Scalar Min(const Float8Scalar& a, const Float8Scalar& b) { return ScalarLanes<Float8Scalar, 8>(a, b, [](float x, float y) { return std::min(x, y); }); }
+	inline Float8Scalar Max(const Float8Scalar& a, const Float8Scalar& b) { return ScalarLanes<Float8Scalar, 8>(a, b, [](float x, float y) { return std::max(x, y); }); }
+	inline Float8Scalar Sqrt(const Float8Scalar& a) { return ScalarLanes<Float8Scalar, 8>(a, a, [](float x, float) { return std::sqrt(x); }); }
+	inline uint32_t CompareLess(const Float8Scalar& a, const Float8Scalar& b) { return ScalarMask<Float8Scalar, 8>(a, b, [](float x, float y) { return x < y; }); }
+	inline uint32_t CompareLessEqual(const Float8Scalar& a, const Float8Scalar& b) { return ScalarMask<Float8Scalar, 8>(a, b, [](float x, float y) { return x <= y; }); }
+
+	// Lane `i` of each half, broadcast within that half
+	template<int I>
+	inline Float8Scalar SplatLane4(const Float8Scalar& a)
+	{
+		Float8Scalar r;
+		std::fill(r.V, r.V + 4, a.V[I]);
+		std::fill(r.V + 4, r.V + 8, a.V[4 + I]);
+		return r;
+	}
+
+	inline void Transpose8x8(Float8Scalar (&rows)[8])
+	{
+		for (uint32_t i = 0; i < 8; i++)
+		{
+			for (uint32_t j = i + 1; j < 8; j++)
+				std::swap(rows[i].V[j], rows[j].V[i]);
+		}
+	}
+
+#ifdef RE_SIMD_SSE
+	struct Float4SSE
+	{
+		static constexpr uint32_t Width = 4;
+		__m128 V;
+
+		static inline Float4SSE Zero() { return { _mm_setzero_ps() }; }
+		static inline Float4SSE Splat(float value) { return { _mm_set1_ps(value) }; }
+		static inline Float4SSE Set(float x, float y, float z, float w) { return { _mm_setr_ps(x, y, z, w) }; }
+		static inline Float4SSE Load(const float* source) { return { _mm_loadu_ps(source) }; }
+		inline void Store(float* destination) const { _mm_storeu_ps(destination, V); }
+
+		inline float GetX() const { return _mm_cvtss_f32(V); }
+		inline float GetY() const { return _mm_cvtss_f32(_mm_shuffle_ps(V, V, _MM_SHUFFLE(1, 1, 1, 1))); }
+		inline float GetZ() const { return _mm_cvtss_f32(_mm_movehl_ps(V, V)); }
+		inline float GetW() const { return _mm_cvtss_f32(_mm_shuffle_ps(V, V, _MM_SHUFFLE(3, 3, 3, 3))); }
+	};
+
+	inline Float4SSE operator+(const Float4SSE& a, const Float4SSE& b) { return { _mm_add_ps(a.V, b.V) }; }
+	inline Float4SSE operator-(const Float4SSE& a, const Float4SSE& b) { return { _mm_sub_ps(a.V, b.V) }; }
+	inline Float4SSE operator*(const Float4SSE& a, const Float4SSE& b) { return { _mm_mul_ps(a.V, b.V) }; }
+	inline Float4SSE operator/(const Float4SSE& a, const Float4SSE& b) { return { _mm_div_ps(a.V, b.V) }; }
+	inline Float4SSE operator-(const Float4SSE& a) { return { _mm_xor_ps(a.V, _mm_set1_ps(-0.0f)) }; }
+	inline Float4SSE Min(const Float4SSE& a, const Float4SSE& b) { return { _mm_min_ps(a.V, b.V) }; }
+	inline Float4SSE Max(const Float4SSE& a, const Float4SSE& b) { return { _mm_max_ps(a.V, b.V) }; }
+	inline Float4SSE Sqrt(const Float4SSE& a) { return { _mm_sqrt_ps(a.V) }; }
+	inline uint32_t CompareLess(const Float4SSE& a, const Float4SSE& b) { return (uint32_t)_mm_movemask_ps(_mm_cmplt_ps(a.V, b.V)); }
+	inline uint32_t CompareLessEqual(const Float4SSE& a, const Float4SSE& b) { return (uint32_t)_mm_movemask_ps(_mm_cmple_ps(a.V, b.V)); }
+	inline Float4SSE MulAdd(const Float4SSE& a, const Float4SSE& b, const Float4SSE& c)
+	{
+	#ifdef RE_SIMD_FMA
+		return { _mm_fmadd_ps(a.V, b.V, c.V) };
+	#else
+		return { _mm_add_ps(_mm_mul_ps(a.V, b.V), c.V) };
+	#endif
+	}
+
+	template<int X, int Y, int Z, int W>
+	inline Float4SSE Swizzle(const Float4SSE& a) { return { _mm_shuffle_ps(a.V, a.V, _MM_SHUFFLE(W, Z, Y, X)) }; }
+
+	inline Float4SSE Dot4(const Float4SSE& a, const Float4SSE& b)
+	{
+		__m128 m = _mm_mul_ps(a.V, b.V);
+		m = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+		return { _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2))) };
+	}
+
+	inline Float4SSE Dot3(const Float4SSE& a, const Float4SSE& b)
+	{
+		__m128 m = _mm_mul_ps(a.V, b.V);
+		__m128 x = _mm_shuffle_ps(m, m, _MM_SHUFFLE(0, 0, 0, 0));
+		__m128 y = _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1));
+		__m128 z = _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2));
+		return { _mm_add_ps(_mm_add_ps(x, y), z) };
+	}
+
+	inline void Transpose(Float4SSE& r0, Float4SSE& r1, Float4SSE& r2, Float4SSE& r3)
+	{
+		_MM_TRANSPOSE4_PS(r0.V, r1.V, r2.V, r3.V);
+	}
+
+	struct Float8SSE
+	{
+		static constexpr uint32_t Width = 8;
+		__m128 Lo, Hi;
+
+		static inline Float8SSE Zero() { return { _mm_setzero_ps(), _mm_setzero_ps() }; }
+		static inline Float8SSE Splat(float value) { return { _mm_set1_ps(value), _mm_set1_ps(value) }; }
+		static inline Float8SSE Load(const float* source) { return { _mm_loadu_ps(source), _mm_loadu_ps(source + 4) }; }
+		static inline Float8SSE BroadcastFloat4(const float* source) { __m128 v = _mm_loadu_ps(source); return { v, v }; }
+		inline void Store(float* destination) const { _mm_storeu_ps(destination, Lo); _mm_storeu_ps(destination + 4, Hi); }
+	};
+
+	inline Float8SSE operator+(const Float8SSE& a, const Float8SSE& b) { return { _mm_add_ps(a.Lo, b.Lo), _mm_add_ps(a.Hi, b.Hi) }; }
+	inline Float8SSE operator-(const Float8SSE& a, const Float8SSE& b) { return { _mm_sub_ps(a.Lo, b.Lo), _mm_sub_ps(a.Hi, b.Hi) }; }
+	inline Float8SSE operator*(const Float8SSE& a, const Float8SSE& b) { return { _mm_mul_ps(a.Lo, b.Lo), _mm_mul_ps(a.Hi, b.Hi) }; }
+	inline Float8SSE operator/(const Float8SSE& a, const Float8SSE& b) { return { _mm_div_ps(a.Lo, b.Lo), _mm_div_ps(a.Hi, b.Hi) }; }
+	inline Float8SSE Min(const Float8SSE& a, const Float8SSE& b) { return { _mm_min_ps(a.Lo, b.Lo), _mm_min_ps(a.Hi, b.Hi) }; }
+	inline Float8SSE Max(const Float8SSE& a, const Float8SSE& b) { return { _mm_max_ps(a.Lo, b.Lo), _mm_max_ps(a.Hi, b.Hi) }; }
+	inline Float8SSE Sqrt(const Float8SSE& a) { return { _mm_sqrt_ps(a.Lo), _mm_sqrt_ps(a.Hi) }; }
+	inline uint32_t CompareLess(const Float8SSE& a, const Float8SSE& b) { return (uint32_t)(_mm_movemask_ps(_mm_cmplt_ps(a.Lo, b.Lo)) | _mm_movemask_ps(_mm_cmplt_ps(a.Hi, b.Hi)) << 4); }
+	inline uint32_t CompareLessEqual(const Float8SSE& a, const Float8SSE& b) { return (uint32_t)(_mm_movemask_ps(_mm_cmple_ps(a.Lo, b.Lo)) | _mm_movemask_ps(_mm_cmple_ps(a.Hi, b.Hi)) << 4); }
+	inline Float8SSE MulAdd(const Float8SSE& a, const Float8SSE& b, const Float8SSE& c)
+	{
+		Float4SSE lo = MulAdd(Float4SSE{ a.Lo }, Float4SSE{ b.Lo }, Float4SSE{ c.Lo });
+		Float4SSE hi = MulAdd(Float4SSE{ a.Hi }, Float4SSE{ b.Hi }, Float4SSE{ c.Hi });
+		return { lo.V, hi.V };
+	}
+
+	template<int I>
+	inline Float8SSE SplatLane4(const Float8SSE& a) { return { _mm_shuffle_ps(a.Lo, a.Lo, _MM_SHUFFLE(I, I, I, I)), _mm_shuffle_ps(a.Hi, a.Hi, _MM_SHUFFLE(I, I, I, I)) }; }
+
+	// Four 4x4 block transposes, then the off-diagonal blocks trade places
+	inline void Transpose8x8(Float8SSE (&rows)[8])
+	{
+		_MM_TRANSPOSE4_PS(rows[0].Lo, rows[1].Lo, rows[2].Lo, rows[3].Lo);
+		_MM_TRANSPOSE4_PS(rows[0].Hi, rows[1].Hi, rows[2].Hi, rows[3].Hi);
+		_MM_TRANSPOSE4_PS(rows[4].Lo, rows[5].Lo, rows[6].Lo, rows[7].Lo);
+		_MM_TRANSPOSE4_PS(rows[4].Hi, rows[5].Hi, rows[6].Hi, rows[7].Hi);
+		for (uint32_t i = 0; i < 4; i++)
+			std::swap(rows[i].Hi, rows[4 + i].Lo);
+	}
+#endif
+
+#ifdef RE_SIMD_AVX
+	struct Float8AVX
+	{
+		static constexpr uint32_t Width = 8;
+		__m256 V;
+
+		static inline Float8AVX Zero() { return { _mm256_setzero_ps() }; }
+		static inline Float8AVX Splat(float value) { return { _mm256_set1_ps(value) }; }
+		static inline Float8AVX Load(const float* source) { return { _mm256_loadu_ps(source) }; }
+		static inline Float8AVX BroadcastFloat4(const float* source) { return { _mm256_broadcast_ps(reinterpret_cast<const __m128*>(source)) }; }
+		inline void Store(float* destination) const { _mm256_storeu_ps(destination, V); }
+	};
+
+	inline Float8AVX operator+(const Float8AVX& a, const Float8AVX& b) { return { _mm256_add_ps(a.V, b.V) }; }
+	inline Float8AVX operator-(const Float8AVX& a, const Float8AVX& b) { return { _mm256_sub_ps(a.V, b.V) }; }
+	inline Float8AVX operator*(const Float8AVX& a, const Float8AVX& b) { return { _mm256_mul_ps(a.V, b.V) }; }
+	inline Float8AVX operator/(const Float8AVX& a, const Float8AVX& b) { return { _mm256_div_ps(a.V, b.V) }; }
+	inline Float8AVX Min(const Float8AVX& a, const Float8AVX& b) { return { _mm256_min_ps(a.V, b.V) }; }
+	inline Float8AVX Max(const Float8AVX& a, const Float8AVX& b) { return { _mm256_max_ps(a.V, b.V) }; }
+	inline Float8AVX Sqrt(const Float8AVX& a) { return { _mm256_sqrt_ps(a.V) }; }
+	inline uint32_t CompareLess(const Float8AVX& a, const Float8AVX& b) { return (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(a.V, b.V, _CMP_LT_OQ)); }
+	inline uint32_t CompareLessEqual(const Float8AVX& a, const Float8AVX& b) { return (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(a.V, b.V, _CMP_LE_OQ)); }
+	inline Float8AVX MulAdd(const Float8AVX& a, const Float8AVX& b, const Float8AVX& c)
+	{
+	#ifdef RE_SIMD_FMA
+		return { _mm256_fmadd_ps(a.V, b.V, c.V) };
+	#else
+		return { _mm256_add_ps(_mm256_mul_ps(a.V, b.V), c.V) };
+	#endif
+	}
+
+	template<int I>
+	inline Float8AVX SplatLane4(const Float8AVX& a) { return { _mm256_shuffle_ps(a.V, a.V, _MM_SHUFFLE(I, I, I, I)) }; }
+
+	inline void Transpose8x8(Float8AVX (&rows)[8])
+	{
+		__m256 t[8], s[8];
+		for (uint32_t i = 0; i < 8; i += 2)
+		{
+			t[i] = _mm256_unpacklo_ps(rows[i].V, rows[i + 1].V);
+			t[i + 1] = _mm256_unpackhi_ps(rows[i].V, rows[i + 1].V);
+		}
+		for (uint32_t i = 0; i < 8; i += 4)
+		{
+			s[i] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+			s[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+			s[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+			s[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+		}
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			rows[i].V = _mm256_permute2f128_ps(s[i], s[i + 4], 0x20);
+			rows[i + 4].V = _mm256_permute2f128_ps(s[i], s[i + 4], 0x31);
+		}
+	}
+#endif
+
+	template<typename Backend>
+	struct SimdTraits;
+
+	template<>
+	struct SimdTraits<SimdScalar>
+	{
+		using Float4 = Float4Scalar;
+		using Float8 = Float8Scalar;
+		static constexpr const char* Name = "Scalar";
+	};
+
+#ifdef RE_SIMD_SSE
+	template<>
+	struct SimdTraits<SimdSSE>
+	{
+		using Float4 = Float4SSE;
+		using Float8 = Float8SSE;
+		static constexpr const char* Name = "SSE";
+	};
+#endif
+
+#ifdef RE_SIMD_AVX
+	template<>
+	struct SimdTraits<SimdAVX>
+	{
+		using Float4 = Float4SSE;
+		using Float8 = Float8AVX;
+		static constexpr const char* Name = "AVX";
+	};
+#endif
+
+#if defined(RE_SIMD_AVX)
+	using SimdDefault = SimdAVX;
+#elif defined(RE_SIMD_SSE)
+	using SimdDefault = SimdSSE;
+#else
+	using SimdDefault = SimdScalar;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cmath>
+
+#include "RockEngine/Math/Simd.h"
+
+namespace RockEngine
+{
+	// Two floats don't fill a register, so Vec2 is plain scalar code in every backend
+	struct Vec2
+	{
+		float X = 0.0f;
+		float Y = 0.0f;
+
+		Vec2() = default;
+		Vec2(float x, float y) : X(x), Y(y) {}
+		explicit Vec2(float value) : X(value), Y(value) {}
+
+		inline Vec2 operator+(const Vec2& other) const { return { X + other.X, Y + other.Y }; }
+		inline Vec2 operator-(const Vec2& other) const { return { X - other.X, Y - other.Y }; }
+		inline Vec2 operator*(const Vec2& other) const { return { X * other.X, Y * other.Y }; }
+		inline Vec2 operator/(const Vec2& other) const { return { X / other.X, Y / other.Y }; }
+		inline Vec2 operator*(float scale) const { return { X * scale, Y * scale }; }
+		inline Vec2 operator-() const { return { -X, -Y }; }
+		inline Vec2& operator+=(const Vec2& other) { return *this = *this + other; }
+		inline Vec2& operator-=(const Vec2& other) { return *this = *this - other; }
+		inline Vec2& operator*=(float scale) { return *this = *this * scale; }
+	};
+
+	inline float Dot(const Vec2& a, const Vec2& b) { return a.X * b.X + a.Y * b.Y; }
+	inline float Length(const Vec2& v) { return std::sqrt(Dot(v, v)); }
+	inline Vec2 Normalize(const Vec2& v) { return v * (1.0f / Length(v)); }
+	inline Vec2 Lerp(const Vec2& a, const Vec2& b, float t) { return a + (b - a) * t; }
+
+	// A 4 lane register with w kept at 0, so Vec3 is 16 bytes. Use float streams (see
+	// BatchKernels) for large packed arrays.
+	template<typename Backend>
+	class BasicVec3
+	{
+	public:
+		using Float4 = typename SimdTraits<Backend>::Float4;
+
+		BasicVec3() : m_Value(Float4::Zero()) {}
+		BasicVec3(float x, float y, float z) : m_Value(Float4::Set(x, y, z, 0.0f)) {}
+		explicit BasicVec3(float value) : m_Value(Float4::Set(value, value, value, 0.0f)) {}
+		explicit BasicVec3(const Float4& value) : m_Value(value) {}
+
+		inline float GetX() const { return m_Value.GetX(); }
+		inline float GetY() const { return m_Value.GetY(); }
+		inline float GetZ() const { return m_Value.GetZ(); }
+		inline const Float4& GetValue() const { return m_Value; }
+
+		inline BasicVec3 operator+(const BasicVec3& other) const { return BasicVec3(m_Value + other.m_Value); }
+		inline BasicVec3 operator-(const BasicVec3& other) const { return BasicVec3(m_Value - other.m_Value); }
+		inline BasicVec3 operator*(const BasicVec3& other) const { return BasicVec3(m_Value * other.m_Value); }
+		inline BasicVec3 operator*(float scale) const { return BasicVec3(m_Value * Float4::Splat(scale)); }
+		inline BasicVec3 operator-() const { return BasicVec3(-m_Value); }
+		inline BasicVec3& operator+=(const BasicVec3& other) { return *this = *this + other; }
+		inline BasicVec3& operator-=(const BasicVec3& other) { return *this = *this - other; }
+		inline BasicVec3 operator/(float divisor) const { return *this * (1.0f / divisor); }
+		inline BasicVec3& operator*=(float scale) { return *this = *this * scale; }
+	private:
+		Float4 m_Value;
+	};
+
+	template<typename Backend>
+	class BasicVec4
+	{
+	public:
+		using Float4 = typename SimdTraits<Backend>::Float4;
+
+		BasicVec4() : m_Value(Float4::Zero()) {}
+		BasicVec4(float x, float y, float z, float w) : m_Value(Float4::Set(x, y, z, w)) {}
+		BasicVec4(const BasicVec3<Backend>& xyz, float w) : m_Value(Float4::Set(xyz.GetX(), xyz.GetY(), xyz.GetZ(), w)) {}
+		explicit BasicVec4(float value) : m_Value(Float4::Splat(value)) {}
+		explicit BasicVec4(const Float4& value) : m_Value(value) {}
+
+		inline float GetX() const { return m_Value.GetX(); }
+		inline float GetY() const { return m_Value.GetY(); }
+		inline float GetZ() const { return m_Value.GetZ(); }
+		inline float GetW() const { return m_Value.GetW(); }
+		inline const Float4& GetValue() const { return m_Value; }
+		inline BasicVec3<Backend> GetXYZ() const { return BasicVec3<Backend>(m_Value * Float4::Set(1.0f, 1.0f, 1.0f, 0.0f)); }
+
+		inline BasicVec4 operator+(const BasicVec4& other) const { return BasicVec4(m_Value + other.m_Value); }
+		inline BasicVec4 operator-(const BasicVec4& other) const { return BasicVec4(m_Value - other.m_Value); }
+		inline BasicVec4 operator*(const BasicVec4& other) const { return BasicVec4(m_Value * other.m_Value); }
+		inline BasicVec4 operator/(const BasicVec4& other) const { return BasicVec4(m_Value / other.m_Value); }
+		inline BasicVec4 operator*(float scale) const { return BasicVec4(m_Value * Float4::Splat(scale)); }
+		inline BasicVec4 operator/(float divisor) const { return BasicVec4(m_Value / Float4::Splat(divisor)); }
+		inline BasicVec4 operator-() const { return BasicVec4(-m_Value); }
+		inline BasicVec4& operator+=(const BasicVec4& other) { return *this = *this + other; }
+		inline BasicVec4& operator-=(const BasicVec4& other) { return *this = *this - other; }
+		inline BasicVec4& operator*=(float scale) { return *this = *this * scale; }
+	private:
+		Float4 m_Value;
+	};
+
+	template<typename B>
+	inline float Dot(const BasicVec3<B>& a, const BasicVec3<B>& b) { return Dot3(a.GetValue(), b.GetValue()).GetX(); }
+	template<typename B>
+	inline float Dot(const BasicVec4<B>& a, const BasicVec4<B>& b) { return Dot4(a.GetValue(), b.GetValue()).GetX(); }
+
+	template<typename B>
+	inline BasicVec3<B> Cross(const BasicVec3<B>& a, const BasicVec3<B>& b)
+	{
+		const auto& u = a.GetValue();
+		const auto& v = b.GetValue();
+		return BasicVec3<B>(Swizzle<1, 2, 0, 3>(u) * Swizzle<2, 0, 1, 3>(v) - Swizzle<2, 0, 1, 3>(u) * Swizzle<1, 2, 0, 3>(v));
+	}
+
+	template<typename B>
+	inline float Length(const BasicVec3<B>& v) { return std::sqrt(Dot(v, v)); }
+	template<typename B>
+	inline float Length(const BasicVec4<B>& v) { return std::sqrt(Dot(v, v)); }
+
+	template<typename B>
+	inline BasicVec3<B> Normalize(const BasicVec3<B>& v) { return v * (1.0f / Length(v)); }
+	template<typename B>
+	inline BasicVec4<B> Normalize(const BasicVec4<B>& v) { return v * (1.0f / Length(v)); }
+
+	template<typename B>
+	inline BasicVec3<B> Lerp(const BasicVec3<B>& a, const BasicVec3<B>& b, float t) { return a + (b - a) * t; }
+	template<typename B>
+	inline BasicVec4<B> Lerp(const BasicVec4<B>& a, const BasicVec4<B>& b, float t) { return a + (b - a) * t; }
+
+	template<typename B>
+	inline BasicVec3<B> Min(const BasicVec3<B>& a, const BasicVec3<B>& b) { return BasicVec3<B>(Min(a.GetValue(), b.GetValue())); }
+	template<typename B>
+	inline BasicVec3<B> Max(const BasicVec3<B>& a, const BasicVec3<B>& b) { return BasicVec3<B>(Max(a.GetValue(), b.GetValue())); }
+	template<typename B>
+	inline BasicVec4<B> Min(const BasicVec4<B>& a, const BasicVec4<B>& b) { return BasicVec4<B>(Min(a.GetValue(), b.GetValue())); }
+	template<typename B>
+	inline BasicVec4<B> Max(const BasicVec4<B>& a, const BasicVec4<B>& b) { return BasicVec4<B>(Max(a.GetValue(), b.GetValue())); }
+
+	using Vec3 = BasicVec3<SimdDefault>;
+	using Vec4 = BasicVec4<SimdDefault>;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "pch.h"
+#include "FrameAllocator.h"
+
+#include <mutex>
+
+namespace RockEngine
+{
+	static std::unique_ptr<LinearAllocator> s_Buffers[2];
+	static uint32_t s_Current = 0;
+
+	static std::atomic<uint64_t> s_Allocations{ 0 };
+	static std::atomic<uint64_t> s_Overflows{ 0 };
+
+	// Overflowing allocations, freed when their buffer comes around again
+	static std::mutex s_OverflowMutex;
+	static std::vector<void*> s_OverflowBlocks[2];
+
+	FrameAllocatorStats FrameAllocator::s_LastFrameStats = {};
+
+	static void FreeOverflow(uint32_t buffer)
+	{
+		std::lock_guard<std::mutex> lock(s_OverflowMutex);
+		for (void* block : s_OverflowBlocks[buffer])
+			::operator delete(block, std::align_val_t(64));
+		s_OverflowBlocks[buffer].clear();
+	}
+
+	void FrameAllocator::Init(size_t capacityPerFrame /* = 16 * 1024 * 1024 */)
+	{
+		s_Buffers[0] = std::make_unique<LinearAllocator>(capacityPerFrame);
+		s_Buffers[1] = std::make_unique<LinearAllocator>(capacityPerFrame);
+		s_Current = 0;
+	}
+
+	void FrameAllocator::Shutdown()
+	{
+		FreeOverflow(0);
+		FreeOverflow(1);
+		s_Buffers[0].reset();
+		s_Buffers[1].reset();
+	}
+
+	void FrameAllocator::BeginFrame()
+	{
+		s_LastFrameStats = GetStats();
+		if (s_LastFrameStats.Overflows)
+			RE_CORE_WARN("FrameAllocator: {} allocations overflowed the {} byte frame arena", s_LastFrameStats.Overflows, s_LastFrameStats.Capacity);
+
+		// The buffer we switch to was last used two frames ago, nothing may reference it anymore
+		s_Current ^= 1;
+		s_Buffers[s_Current]->Reset();
+		FreeOverflow(s_Current);
+
+		s_Allocations.store(0, std::memory_order_relaxed);
+		s_Overflows.store(0, std::memory_order_relaxed);
+	}
+
+	void* FrameAllocator::Allocate(size_t size, size_t alignment /* = alignof(std::max_align_t) */)
+	{
+		s_Allocations.fetch_add(1, std::memory_order_relaxed);
+		if (void* memory = s_Buffers[s_Current]->Allocate(size, alignment))
+			return memory;
+
+		RE_CORE_ASSERT(alignment <= 64, "FrameAllocator supports at most 64 byte alignment");
+		s_Overflows.fetch_add(1, std::memory_order_relaxed);
+		void* block = ::operator new(size, std::align_val_t(64));
+		std::lock_guard<std::mutex> lock(s_OverflowMutex);
+		s_OverflowBlocks[s_Current].push_back(block);
+		return block;
+	}
+
+	FrameAllocatorStats FrameAllocator::GetStats()
+	{
+		const LinearAllocator& buffer = *s_Buffers[s_Current];
+		return { buffer.GetUsed(), buffer.GetCapacity(), std::max(buffer.GetHighWaterMark(), buffer.GetUsed()), s_Allocations.load(), s_Overflows.load() };
+	}
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <new>
+#include <utility>
+
+#include "LinearAllocator.h"
+
+namespace RockEngine
+{
+	struct FrameAllocatorStats
+	{
+		size_t Used;			// bytes handed out this frame
+		size_t Capacity;		// per buffer
+		size_t HighWaterMark;
+		uint64_t Allocations;
+		uint64_t Overflows;		// allocations that didn't fit and went to the heap
+	};
+
+	// Double-buffered per-frame arena. Memory allocated during frame N stays valid until
+	// the end of frame N + 1, so data can be handed to the next frame without copying.
+	// Nothing is destructed: only put trivially destructible data (or STL containers using
+	// FrameSTLAllocator) in here.
+	class FrameAllocator
+	{
+	public:
+		static void Init(size_t capacityPerFrame = 16 * 1024 * 1024);
+		static void Shutdown();
+
+		// Called by Application::Run at the start of every frame
+		static void BeginFrame();
+
+		static void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+		template<typename T, typename... Args>
+		static T* New(Args&&... args)
+		{
+			return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		}
+
+		template<typename T>
+		static T* NewArray(size_t count)
+		{
+			return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		static FrameAllocatorStats GetStats();
+		static const FrameAllocatorStats& GetLastFrameStats() { return s_LastFrameStats; }
+	private:
+		static FrameAllocatorStats s_LastFrameStats;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "pch.h"
+#include "LinearAllocator.h"
+
+namespace RockEngine
+{
+	static constexpr size_t s_CacheLineSize = 64;
+
+	LinearAllocator::LinearAllocator(size_t capacity)
+		: m_Capacity(capacity)
+	{
+		m_Base = static_cast<uint8_t*>(::operator new(capacity, std::align_val_t(s_CacheLineSize)));
+	}
+
+	LinearAllocator::~LinearAllocator()
+	{
+		::operator delete(m_Base, std::align_val_t(s_CacheLineSize));
+	}
+
+	void* LinearAllocator::Allocate(size_t size, size_t alignment /* = alignof(std::max_align_t) */)
+	{
+		size_t offset = m_Offset.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			size_t aligned = AlignUp(offset, alignment);
+			size_t end = aligned + size;
+			if (end > m_Capacity)
+				return nullptr;
+
+			if (m_Offset.compare_exchange_weak(offset, end, std::memory_order_relaxed))
+				return m_Base + aligned;
+		}
+	}
+
+	void LinearAllocator::Reset()
+	{
+		m_HighWaterMark = std::max(m_HighWaterMark, m_Offset.load(std::memory_order_relaxed));
+		m_Offset.store(0, std::memory_order_relaxed);
+	}
+}
\ No newline at end of file
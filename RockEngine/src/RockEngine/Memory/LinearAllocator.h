@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace RockEngine
+{
+	inline size_t AlignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	// Bump allocator over a fixed block. Allocation is a single CAS so any thread may allocate,
+	// nothing is freed individually - Reset() releases everything at once.
+	class LinearAllocator
+	{
+	public:
+		LinearAllocator(size_t capacity);
+		~LinearAllocator();
+
+		LinearAllocator(const LinearAllocator&) = delete;
+		LinearAllocator& operator=(const LinearAllocator&) = delete;
+
+		// Returns nullptr when the block is exhausted
+		void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+		void Reset();
+
+		inline size_t GetUsed() const { return m_Offset.load(std::memory_order_relaxed); }
+		inline size_t GetCapacity() const { return m_Capacity; }
+		inline size_t GetHighWaterMark() const { return m_HighWaterMark; }
+		inline bool Owns(const void* ptr) const { return ptr >= m_Base && ptr < m_Base + m_Capacity; }
+	private:
+		uint8_t* m_Base;
+		size_t m_Capacity;
+		std::atomic<size_t> m_Offset{ 0 };
+		size_t m_HighWaterMark = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,293 @@
+#include "pch.h"
+#include "MemoryTracker.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <new>
+
+namespace RockEngine
+{
+	// Sits right in front of every tracked allocation
+	struct AllocationHeader
+	{
+		uint64_t Size;
+		MemoryTag Tag;
+		uint16_t Offset;	// from the start of the malloc'ed block to the user pointer
+		uint32_t Magic;
+	};
+	static_assert(sizeof(AllocationHeader) == 16, "Allocation header has to keep 16 byte alignment");
+
+	static constexpr uint32_t s_HeaderMagic = 0x52454D54; // "REMT"
+
+	// Counters are touched from every thread on every allocation, keep tags on separate cache lines
+	struct alignas(64) TagData
+	{
+		char Name[MemoryTracker::MaxTagNameLength] = {};
+		std::atomic<int64_t> CurrentBytes{ 0 };
+		std::atomic<int64_t> PeakBytes{ 0 };
+		std::atomic<uint64_t> TotalAllocations{ 0 };
+		std::atomic<uint64_t> LiveAllocations{ 0 };
+		std::atomic<uint64_t> FrameAllocations{ 0 };
+		std::atomic<uint64_t> FrameBytes{ 0 };
+
+		// Main thread only, updated in EndFrame
+		uint64_t LastFrameAllocations = 0;
+		uint64_t LastFrameBytes = 0;
+		uint64_t PeakFrameAllocations = 0;
+		MemoryBudget Budget = {};
+		uint64_t BudgetViolations = 0;
+		bool OverBudget = false;
+	};
+
+	// Plain arrays and a std::mutex: none of this may allocate, it runs inside operator new
+	static TagData s_Tags[MemoryTracker::MaxTags] = { { "Untagged" } };
+	static std::atomic<uint32_t> s_TagCount{ 1 };
+	static std::mutex s_TagMutex;
+	static thread_local MemoryTag s_CurrentTag = MemoryTracker::UntaggedTag;
+
+	bool MemoryTracker::IsEnabled()
+	{
+#ifdef RE_ENABLE_MEMORY_TRACKING
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	static MemoryTag FindTag(const char* name, uint32_t count)
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if (std::strncmp(s_Tags[i].Name, name, MemoryTracker::MaxTagNameLength - 1) == 0)
+				return (MemoryTag)i;
+		}
+		return (MemoryTag)MemoryTracker::MaxTags;
+	}
+
+	MemoryTag MemoryTracker::RegisterTag(const char* name)
+	{
+		MemoryTag tag = FindTag(name, s_TagCount.load(std::memory_order_acquire));
+		if (tag < MaxTags)
+			return tag;
+
+		std::lock_guard<std::mutex> lock(s_TagMutex);
+		uint32_t count = s_TagCount.load(std::memory_order_relaxed);
+		tag = FindTag(name, count);
+		if (tag < MaxTags)
+			return tag;
+
+		// Out of tags, lump the rest together rather than failing
+		if (count == MaxTags)
+			return UntaggedTag;
+
+		std::strncpy(s_Tags[count].Name, name, MaxTagNameLength - 1);
+		s_TagCount.store(count + 1, std::memory_order_release);
+		return (MemoryTag)count;
+	}
+
+	MemoryTag MemoryTracker::GetCurrentTag()
+	{
+		return s_CurrentTag;
+	}
+
+	void MemoryTracker::SetCurrentTag(MemoryTag tag)
+	{
+		s_CurrentTag = tag;
+	}
+
+	void MemoryTracker::SetBudget(const char* tagName, const MemoryBudget& budget)
+	{
+		MemoryTag tag = RegisterTag(tagName);
+		std::lock_guard<std::mutex> lock(s_TagMutex);
+		s_Tags[tag].Budget = budget;
+	}
+
+	void* MemoryTracker::Allocate(size_t size, MemoryTag tag, size_t alignment /* = alignof(std::max_align_t) */)
+	{
+		alignment = std::max<size_t>(alignment, sizeof(AllocationHeader));
+		size_t padding = alignment > sizeof(AllocationHeader) ? alignment : 0;
+
+		uint8_t* block = static_cast<uint8_t*>(std::malloc(size + sizeof(AllocationHeader) + padding));
+		if (!block)
+			return nullptr;
+
+		uintptr_t user = ((uintptr_t)block + sizeof(AllocationHeader) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		AllocationHeader* header = reinterpret_cast<AllocationHeader*>(user) - 1;
+		header->Size = size;
+		header->Tag = tag < MaxTags ? tag : UntaggedTag;
+		header->Offset = (uint16_t)(user - (uintptr_t)block);
+		header->Magic = s_HeaderMagic;
+
+		TagData& data = s_Tags[header->Tag];
+		int64_t current = data.CurrentBytes.fetch_add((int64_t)size, std::memory_order_relaxed) + (int64_t)size;
+		int64_t peak = data.PeakBytes.load(std::memory_order_relaxed);
+		while (current > peak && !data.PeakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+			;
+		data.TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+		data.LiveAllocations.fetch_add(1, std::memory_order_relaxed);
+		data.FrameAllocations.fetch_add(1, std::memory_order_relaxed);
+		data.FrameBytes.fetch_add(size, std::memory_order_relaxed);
+
+		return reinterpret_cast<void*>(user);
+	}
+
+	void MemoryTracker::Free(void* ptr)
+	{
+		if (!ptr)
+			return;
+
+		AllocationHeader* header = static_cast<AllocationHeader*>(ptr) - 1;
+		if (header->Magic != s_HeaderMagic)
+		{
+			// Not ours, or the header got trampled. Leaking is safer than freeing garbage.
+			RE_CORE_ERROR("MemoryTracker: bad allocation header at {}", ptr);
+			return;
+		}
+
+		TagData& data = s_Tags[header->Tag];
+		data.CurrentBytes.fetch_sub((int64_t)header->Size, std::memory_order_relaxed);
+		data.LiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+
+		header->Magic = 0;
+		std::free(static_cast<uint8_t*>(ptr) - header->Offset);
+	}
+
+	void MemoryTracker::EndFrame()
+	{
+		std::lock_guard<std::mutex> lock(s_TagMutex);
+		uint32_t count = s_TagCount.load(std::memory_order_relaxed);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			TagData& data = s_Tags[i];
+			data.LastFrameAllocations = data.FrameAllocations.exchange(0, std::memory_order_relaxed);
+			data.LastFrameBytes = data.FrameBytes.exchange(0, std::memory_order_relaxed);
+			data.PeakFrameAllocations = std::max(data.PeakFrameAllocations, data.LastFrameAllocations);
+
+			int64_t current = data.CurrentBytes.load(std::memory_order_relaxed);
+			bool overBytes = data.Budget.MaxBytes && current > (int64_t)data.Budget.MaxBytes;
+			bool overAllocations = data.Budget.MaxAllocationsPerFrame && data.LastFrameAllocations > data.Budget.MaxAllocationsPerFrame;
+			bool overBudget = overBytes || overAllocations;
+
+			// Only warn when a tag goes over, not on every frame it stays there
+			if (overBudget)
+			{
+				data.BudgetViolations++;
+				if (!data.OverBudget)
+				{
+					RE_CORE_WARN("MemoryTracker: '{}' over budget, {} bytes live (budget {}), {} allocations last frame (budget {})",
+						data.Name, current, data.Budget.MaxBytes, data.LastFrameAllocations, data.Budget.MaxAllocationsPerFrame);
+				}
+			}
+			data.OverBudget = overBudget;
+		}
+	}
+
+	void MemoryTracker::GetStats(std::vector<MemoryTagStats>& stats)
+	{
+		std::lock_guard<std::mutex> lock(s_TagMutex);
+		uint32_t count = s_TagCount.load(std::memory_order_relaxed);
+		stats.resize(count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const TagData& data = s_Tags[i];
+			stats[i] = {
+				data.Name,
+				data.CurrentBytes.load(std::memory_order_relaxed),
+				data.PeakBytes.load(std::memory_order_relaxed),
+				data.TotalAllocations.load(std::memory_order_relaxed),
+				data.LiveAllocations.load(std::memory_order_relaxed),
+				data.LastFrameAllocations,
+				data.LastFrameBytes,
+				data.PeakFrameAllocations,
+				data.Budget,
+				data.BudgetViolations,
+				data.OverBudget
+			};
+		}
+	}
+
+	static void WriteJsonString(std::ofstream& stream, const char* string)
+	{
+		stream << '"';
+		for (; *string; string++)
+		{
+			if (*string == '"' || *string == '\\')
+				stream << '\\';
+			stream << *string;
+		}
+		stream << '"';
+	}
+
+	bool MemoryTracker::WriteReport(const std::string& filepath)
+	{
+		std::vector<MemoryTagStats> stats;
+		GetStats(stats);
+
+		std::ofstream stream(filepath);
+		if (!stream)
+		{
+			RE_CORE_ERROR("MemoryTracker: could not open {}", filepath);
+			return false;
+		}
+
+		stream << "{\"enabled\":" << (IsEnabled() ? "true" : "false") << ",\"tags\":[";
+		for (size_t i = 0; i < stats.size(); i++)
+		{
+			const MemoryTagStats& tag = stats[i];
+			stream << (i ? "," : "") << "{\"name\":";
+			WriteJsonString(stream, tag.Name);
+			stream << ",\"currentBytes\":" << tag.CurrentBytes
+				<< ",\"peakBytes\":" << tag.PeakBytes
+				<< ",\"totalAllocations\":" << tag.TotalAllocations
+				<< ",\"liveAllocations\":" << tag.LiveAllocations
+				<< ",\"lastFrameAllocations\":" << tag.FrameAllocations
+				<< ",\"lastFrameBytes\":" << tag.FrameBytes
+				<< ",\"peakFrameAllocations\":" << tag.PeakFrameAllocations
+				<< ",\"budgetBytes\":" << tag.Budget.MaxBytes
+				<< ",\"budgetAllocationsPerFrame\":" << tag.Budget.MaxAllocationsPerFrame
+				<< ",\"budgetViolations\":" << tag.BudgetViolations << "}";
+		}
+		stream << "]}";
+
+		RE_CORE_INFO("MemoryTracker: wrote {} tags to {}", stats.size(), filepath);
+		return true;
+	}
+}
+
+#ifdef RE_ENABLE_MEMORY_TRACKING
+
+// Replacing the global allocation functions routes everything, STL, spdlog and client code
+// included, through the tracker under the calling thread's current tag
+
+static void* TrackedNew(size_t size, size_t alignment)
+{
+	void* ptr = RockEngine::MemoryTracker::Allocate(size ? size : 1, RockEngine::MemoryTracker::GetCurrentTag(), alignment);
+	if (!ptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new(size_t size) { return TrackedNew(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size) { return TrackedNew(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t alignment) { return TrackedNew(size, (size_t)alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return TrackedNew(size, (size_t)alignment); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return RockEngine::MemoryTracker::Allocate(size ? size : 1, RockEngine::MemoryTracker::GetCurrentTag()); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return RockEngine::MemoryTracker::Allocate(size ? size : 1, RockEngine::MemoryTracker::GetCurrentTag()); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return RockEngine::MemoryTracker::Allocate(size ? size : 1, RockEngine::MemoryTracker::GetCurrentTag(), (size_t)alignment); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return RockEngine::MemoryTracker::Allocate(size ? size : 1, RockEngine::MemoryTracker::GetCurrentTag(), (size_t)alignment); }
+
+void operator delete(void* ptr) noexcept { RockEngine::MemoryTracker::Free(ptr); }
+void operator delete[](void* ptr) noexcept { RockEngine::MemoryTracker::Free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { RockEngine::MemoryTracker::Free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { RockEngine::MemoryTracker::Free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { RockEngine::MemoryTracker::Free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { RockEngine::MemoryTracker::Free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { RockEngine::MemoryTracker::Free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { RockEngine::MemoryTracker::Free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { RockEngine::MemoryTracker::Free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { RockEngine::MemoryTracker::Free(ptr); }
+
+#endif
\ No newline at end of file
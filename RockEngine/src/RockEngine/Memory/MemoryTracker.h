@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Opt-in, build with `premake5 --memory-tracking <action>`. When enabled the global
+// operator new/delete are replaced and every allocation carries a small header with
+// its size and the tag that was active when it was made.
+
+namespace RockEngine
+{
+	using MemoryTag = uint16_t;
+
+	struct MemoryBudget
+	{
+		size_t MaxBytes = 0;				// live bytes, 0 = unlimited
+		uint64_t MaxAllocationsPerFrame = 0;	// 0 = unlimited
+	};
+
+	struct MemoryTagStats
+	{
+		const char* Name;
+		int64_t CurrentBytes;
+		int64_t PeakBytes;
+		uint64_t TotalAllocations;
+		uint64_t LiveAllocations;
+		uint64_t FrameAllocations;			// during the last finished frame
+		uint64_t FrameBytes;
+		uint64_t PeakFrameAllocations;
+		MemoryBudget Budget;
+		uint64_t BudgetViolations;			// frames that ended over budget
+		bool OverBudget;
+	};
+
+	class MemoryTracker
+	{
+	public:
+		static constexpr uint32_t MaxTags = 64;
+		static constexpr uint32_t MaxTagNameLength = 32;
+		static constexpr MemoryTag UntaggedTag = 0;
+
+		static bool IsEnabled();
+
+		// Returns the tag with that name, registering it on first use. Doesn't allocate.
+		static MemoryTag RegisterTag(const char* name);
+		static MemoryTag GetCurrentTag();
+		static void SetCurrentTag(MemoryTag tag);
+
+		static void SetBudget(const char* tagName, const MemoryBudget& budget);
+
+		// Called by Application::Run at the end of every frame, checks budgets
+		static void EndFrame();
+
+		// Tracked allocations under an explicit tag, for libraries with allocator hooks (ImGui)
+		static void* Allocate(size_t size, MemoryTag tag, size_t alignment = alignof(std::max_align_t));
+		static void Free(void* ptr);
+
+		static void GetStats(std::vector<MemoryTagStats>& stats);
+		static bool WriteReport(const std::string& filepath);
+	};
+
+	// Tags every allocation made on this thread while in scope
+	class MemoryScope
+	{
+	public:
+		MemoryScope(MemoryTag tag)
+			: m_Previous(MemoryTracker::GetCurrentTag())
+		{
+			MemoryTracker::SetCurrentTag(tag);
+		}
+
+		~MemoryScope()
+		{
+			MemoryTracker::SetCurrentTag(m_Previous);
+		}
+	private:
+		MemoryTag m_Previous;
+	};
+}
+
+#ifdef RE_ENABLE_MEMORY_TRACKING
+	#define RE_MEMORY_CONCAT_IMPL(a, b) a##b
+	#define RE_MEMORY_CONCAT(a, b) RE_MEMORY_CONCAT_IMPL(a, b)
+
+	// The tag is looked up once per call site
+	#define RE_MEMORY_SCOPE(name)			static const RockEngine::MemoryTag RE_MEMORY_CONCAT(reMemoryTag, __LINE__) = RockEngine::MemoryTracker::RegisterTag(name); \
+											RockEngine::MemoryScope RE_MEMORY_CONCAT(reMemoryScope, __LINE__)(RE_MEMORY_CONCAT(reMemoryTag, __LINE__))
+	// For names only known at runtime (layer names), looked up every time
+	#define RE_MEMORY_SCOPE_DYNAMIC(name)	RockEngine::MemoryScope RE_MEMORY_CONCAT(reMemoryScope, __LINE__)(RockEngine::MemoryTracker::RegisterTag(name))
+#else
+	#define RE_MEMORY_SCOPE(name)
+	#define RE_MEMORY_SCOPE_DYNAMIC(name)
+#endif
\ No newline at end of file
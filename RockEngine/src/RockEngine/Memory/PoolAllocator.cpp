@@ -0,0 +1,153 @@
+#include "pch.h"
+#include "PoolAllocator.h"
+
+#include <mutex>
+
+namespace RockEngine
+{
+	// Chunk storage is global so blocks stay valid after the thread that carved them exits
+	static std::mutex s_ChunkMutex;
+	static std::vector<void*> s_Chunks;
+
+	static std::atomic<uint64_t> s_Allocations{ 0 };
+	static std::atomic<uint64_t> s_Frees{ 0 };
+	static std::atomic<size_t> s_ReservedBytes{ 0 };
+
+	PoolAllocator::PoolAllocator(size_t blockSize, size_t blocksPerChunk /* = 256 */)
+		: m_BlockSize(std::max(blockSize, sizeof(FreeBlock))), m_BlocksPerChunk(blocksPerChunk)
+	{
+	}
+
+	void PoolAllocator::AllocateChunk()
+	{
+		size_t chunkSize = m_BlockSize * m_BlocksPerChunk;
+		uint8_t* chunk = static_cast<uint8_t*>(::operator new(chunkSize, std::align_val_t(64)));
+		{
+			std::lock_guard<std::mutex> lock(s_ChunkMutex);
+			s_Chunks.push_back(chunk);
+		}
+		s_ReservedBytes.fetch_add(chunkSize, std::memory_order_relaxed);
+
+		// Thread the new blocks onto the free list in address order
+		for (size_t i = m_BlocksPerChunk; i-- > 0;)
+		{
+			FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + i * m_BlockSize);
+			block->Next = m_FreeList;
+			m_FreeList = block;
+		}
+	}
+
+	void* PoolAllocator::Allocate()
+	{
+		if (!m_FreeList)
+			AllocateChunk();
+
+		FreeBlock* block = m_FreeList;
+		m_FreeList = block->Next;
+		return block;
+	}
+
+	void PoolAllocator::Free(void* block)
+	{
+		FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+		freeBlock->Next = m_FreeList;
+		m_FreeList = freeBlock;
+	}
+
+	void PoolAllocator::MergeInto(PoolAllocator& other)
+	{
+		while (m_FreeList)
+		{
+			FreeBlock* block = m_FreeList;
+			m_FreeList = block->Next;
+			other.Free(block);
+		}
+	}
+
+	// Free lists of exited threads, picked up by the next thread that needs blocks
+	static std::mutex s_OrphanMutex;
+	static std::vector<std::unique_ptr<PoolAllocator>> s_OrphanPools;
+
+	struct ThreadPools
+	{
+		std::unique_ptr<PoolAllocator> Pools[SmallObjectAllocator::SizeClassCount];
+
+		ThreadPools()
+		{
+			std::lock_guard<std::mutex> lock(s_OrphanMutex);
+			for (size_t i = 0; i < SmallObjectAllocator::SizeClassCount; i++)
+				Pools[i] = std::make_unique<PoolAllocator>((i + 1) * SmallObjectAllocator::Granularity);
+
+			if (!s_OrphanPools.empty())
+			{
+				for (size_t i = 0; i < SmallObjectAllocator::SizeClassCount; i++)
+					Pools[i] = std::move(s_OrphanPools[i]);
+				s_OrphanPools.clear();
+			}
+		}
+
+		~ThreadPools()
+		{
+			std::lock_guard<std::mutex> lock(s_OrphanMutex);
+			if (s_OrphanPools.empty())
+			{
+				for (auto& pool : Pools)
+					s_OrphanPools.push_back(std::move(pool));
+			}
+			else
+			{
+				for (size_t i = 0; i < SmallObjectAllocator::SizeClassCount; i++)
+					Pools[i]->MergeInto(*s_OrphanPools[i]);
+			}
+		}
+
+		PoolAllocator& Get(size_t sizeClass) { return *Pools[sizeClass]; }
+	};
+
+	static thread_local ThreadPools s_ThreadPools;
+
+	static size_t GetSizeClass(size_t size)
+	{
+		return (std::max<size_t>(size, 1) - 1) / SmallObjectAllocator::Granularity;
+	}
+
+	void* SmallObjectAllocator::Allocate(size_t size)
+	{
+		RE_CORE_ASSERT(size <= MaxSize);
+		s_Allocations.fetch_add(1, std::memory_order_relaxed);
+		return s_ThreadPools.Get(GetSizeClass(size)).Allocate();
+	}
+
+	void SmallObjectAllocator::Free(void* block, size_t size)
+	{
+		if (!block)
+			return;
+
+		s_Frees.fetch_add(1, std::memory_order_relaxed);
+		s_ThreadPools.Get(GetSizeClass(size)).Free(block);
+	}
+
+	PoolAllocatorStats SmallObjectAllocator::GetStats()
+	{
+		uint64_t allocations = s_Allocations.load();
+		uint64_t frees = s_Frees.load();
+		return { allocations, frees, allocations - frees, s_ReservedBytes.load() };
+	}
+
+	void SmallObjectAllocator::Shutdown()
+	{
+		// Every other thread that used the pools has to be gone by now
+		{
+			std::lock_guard<std::mutex> lock(s_OrphanMutex);
+			s_OrphanPools.clear();
+		}
+		for (size_t i = 0; i < SizeClassCount; i++)
+			s_ThreadPools.Get(i).Clear();
+
+		std::lock_guard<std::mutex> lock(s_ChunkMutex);
+		for (void* chunk : s_Chunks)
+			::operator delete(chunk, std::align_val_t(64));
+		s_Chunks.clear();
+		s_ReservedBytes.store(0);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace RockEngine
+{
+	struct PoolAllocatorStats
+	{
+		uint64_t Allocations;
+		uint64_t Frees;
+		uint64_t LiveBlocks;
+		size_t ReservedBytes;	// chunk memory obtained from the heap
+	};
+
+	// Fixed-size block pool with an intrusive free list. Not thread-safe on its own,
+	// SmallObjectAllocator gives every thread its own set of pools.
+	class PoolAllocator
+	{
+	public:
+		PoolAllocator(size_t blockSize, size_t blocksPerChunk = 256);
+
+		PoolAllocator(const PoolAllocator&) = delete;
+		PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+		void* Allocate();
+		void Free(void* block);
+
+		inline size_t GetBlockSize() const { return m_BlockSize; }
+
+		// Hands the free list over to `other` (same block size), used when a thread exits
+		void MergeInto(PoolAllocator& other);
+		// Forgets the free list without touching it, for when the chunks are released
+		void Clear() { m_FreeList = nullptr; }
+	private:
+		void AllocateChunk();
+	private:
+		struct FreeBlock
+		{
+			FreeBlock* Next;
+		};
+
+		FreeBlock* m_FreeList = nullptr;
+		size_t m_BlockSize;
+		size_t m_BlocksPerChunk;
+	};
+
+	// Thread-local size-class pools for small objects (up to MaxSize bytes). Blocks may be
+	// freed on any thread, they join that thread's pool. Chunks are only returned to the
+	// heap at shutdown.
+	class SmallObjectAllocator
+	{
+	public:
+		static constexpr size_t Granularity = 16;
+		static constexpr size_t MaxSize = 256;
+		static constexpr size_t SizeClassCount = MaxSize / Granularity;
+
+		static void* Allocate(size_t size);
+		static void Free(void* block, size_t size);
+
+		static PoolAllocatorStats GetStats();
+		static void Shutdown();
+	};
+}
\ No newline at end of file
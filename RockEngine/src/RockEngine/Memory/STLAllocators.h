@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "FrameAllocator.h"
+#include "PoolAllocator.h"
+
+namespace RockEngine
+{
+	// Allocates from the current frame arena, deallocate is a no-op. Containers using it
+	// must not outlive the next frame.
+	template<typename T>
+	class FrameSTLAllocator
+	{
+	public:
+		using value_type = T;
+
+		FrameSTLAllocator() noexcept = default;
+		template<typename U>
+		FrameSTLAllocator(const FrameSTLAllocator<U>&) noexcept {}
+
+		T* allocate(size_t count) { return static_cast<T*>(FrameAllocator::Allocate(sizeof(T) * count, alignof(T))); }
+		void deallocate(T*, size_t) noexcept {}
+
+		template<typename U>
+		bool operator==(const FrameSTLAllocator<U>&) const noexcept { return true; }
+		template<typename U>
+		bool operator!=(const FrameSTLAllocator<U>&) const noexcept { return false; }
+	};
+
+	// Small requests go to the thread-local pools, larger ones to the heap
+	template<typename T>
+	class PoolSTLAllocator
+	{
+	public:
+		using value_type = T;
+
+		PoolSTLAllocator() noexcept = default;
+		template<typename U>
+		PoolSTLAllocator(const PoolSTLAllocator<U>&) noexcept {}
+
+		T* allocate(size_t count)
+		{
+			size_t size = sizeof(T) * count;
+			if (size <= SmallObjectAllocator::MaxSize && alignof(T) <= SmallObjectAllocator::Granularity)
+				return static_cast<T*>(SmallObjectAllocator::Allocate(size));
+			return static_cast<T*>(::operator new(size));
+		}
+
+		void deallocate(T* ptr, size_t count) noexcept
+		{
+			size_t size = sizeof(T) * count;
+			if (size <= SmallObjectAllocator::MaxSize && alignof(T) <= SmallObjectAllocator::Granularity)
+				SmallObjectAllocator::Free(ptr, size);
+			else
+				::operator delete(ptr);
+		}
+
+		template<typename U>
+		bool operator==(const PoolSTLAllocator<U>&) const noexcept { return true; }
+		template<typename U>
+		bool operator!=(const PoolSTLAllocator<U>&) const noexcept { return false; }
+	};
+
+	template<typename T>
+	using FrameVector = std::vector<T, FrameSTLAllocator<T>>;
+	using FrameString = std::basic_string<char, std::char_traits<char>, FrameSTLAllocator<char>>;
+
+	template<typename T>
+	using PoolVector = std::vector<T, PoolSTLAllocator<T>>;
+	template<typename Key, typename Value, typename Hash = std::hash<Key>>
+	using PoolUnorderedMap = std::unordered_map<Key, Value, Hash, std::equal_to<Key>, PoolSTLAllocator<std::pair<const Key, Value>>>;
+}
\ No newline at end of file
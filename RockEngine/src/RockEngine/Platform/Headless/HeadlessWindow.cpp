@@ -0,0 +1,14 @@
+#include "pch.h"
+#include "HeadlessWindow.h"
+
+namespace RockEngine
+{
+	HeadlessWindow::HeadlessWindow(const WindowProps& props)
+	{
+		m_Data.Title = props.Title;
+		m_Data.Height = props.Height;
+		m_Data.Width = props.Width;
+
+		RE_CORE_TRACE("Creating headless window: {} - {} - {}", props.Title, props.Width, props.Height);
+	}
+}
\ No newline at end of file
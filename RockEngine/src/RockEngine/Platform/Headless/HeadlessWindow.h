@@ -0,0 +1,42 @@
+#pragma once
+
+#include "RockEngine/Core/Window.h"
+
+namespace RockEngine
+{
+	// Window without a display or graphics context, used for GPU-less runs and benchmarks
+	class HeadlessWindow : public Window {
+	public:
+		HeadlessWindow(const WindowProps& props);
+
+		void PollEvents() override {}
+		void SwapBuffers() override {}
+
+		// Windows attributes
+		uint32_t GetWidth() override { return m_Data.Width; }
+		uint32_t GetHeight() override { return m_Data.Height; }
+
+		void SetEventQueue(EventQueue* queue) override { m_Data.Queue = queue; }
+
+		void SetVSync(bool enabled) override { m_Data.VSync = enabled; }
+		bool IsVSync() const override { return m_Data.VSync; }
+
+		bool IsMinimized() const override { return false; }
+		bool IsFocused() const override { return true; }
+
+		inline void* GetNativeWindow() { return nullptr; }
+	private:
+		struct WindowData
+		{
+			std::string Title;
+			uint32_t Width;
+			uint32_t Height;
+
+			EventQueue* Queue = nullptr;
+
+			bool VSync = false;
+		};
+
+		WindowData m_Data;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "pch.h"
+#include "NullRendererBackend.h"
+
+namespace RockEngine
+{
+	void NullRendererBackend::Execute(const RenderCommand* commands, uint32_t count)
+	{
+		uint32_t boundShader = ~0u;
+		uint32_t boundMaterial = ~0u;
+		uint32_t boundMesh = ~0u;
+
+		m_Stats.Commands += count;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const RenderCommand& command = commands[i];
+			switch (command.Type)
+			{
+				case RenderCommandType::Clear:
+					std::copy(command.Clear.Color, command.Clear.Color + 4, m_Stats.ClearColor);
+					m_Stats.Clears++;
+					break;
+				case RenderCommandType::SetClearColor:
+					std::copy(command.SetClearColor.Color, command.SetClearColor.Color + 4, m_Stats.ClearColor);
+					m_Stats.ClearColorChanges++;
+					break;
+				case RenderCommandType::SetViewport:
+					m_Stats.ViewportChanges++;
+					break;
+				case RenderCommandType::Draw:
+				{
+					const DrawCommand& draw = command.Draw;
+					m_Stats.ShaderChanges += draw.Shader != boundShader;
+					m_Stats.MaterialChanges += draw.Material != boundMaterial || draw.Shader != boundShader;
+					m_Stats.MeshChanges += draw.Mesh != boundMesh;
+					boundShader = draw.Shader;
+					boundMaterial = draw.Material;
+					boundMesh = draw.Mesh;
+
+					m_Stats.Draws++;
+					m_Stats.Instances += draw.InstanceCount;
+					m_Stats.Indices += (uint64_t)draw.IndexCount * draw.InstanceCount;
+					break;
+				}
+				case RenderCommandType::DrawQuads:
+				{
+					const DrawQuadsCommand& draw = command.DrawQuads;
+					RE_CORE_ASSERT(m_QuadFrames && draw.Frame < m_QuadFrameCount
+						&& (size_t)(draw.FirstQuad + draw.QuadCount) * 4 <= m_QuadFrames[draw.Frame].Vertices.size(), "DrawQuads out of range");
+					boundShader = boundMaterial = boundMesh = ~0u;
+
+					m_Stats.Draws++;
+					m_Stats.Instances++;
+					m_Stats.Indices += (uint64_t)draw.QuadCount * 6;
+					m_Stats.QuadBatches++;
+					m_Stats.Quads += draw.QuadCount;
+					m_Stats.QuadTextureBinds += draw.TextureCount;
+					break;
+				}
+				default:
+					break;
+			}
+		}
+
+		if (m_SimulatedCommandCost)
+		{
+			uint64_t end = Profiler::Now() + (uint64_t)m_SimulatedCommandCost * count;
+			while (Profiler::Now() < end)
+				;
+		}
+	}
+}
\ No newline at end of file
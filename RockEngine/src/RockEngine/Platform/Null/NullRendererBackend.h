@@ -0,0 +1,46 @@
+#pragma once
+
+#include "RockEngine/Renderer/RendererBackend.h"
+
+namespace RockEngine
+{
+	// Backend that touches no GPU. It only records what it was asked to do so the
+	// CPU side of the renderer can be run and measured on machines without a display.
+	class NullRendererBackend : public RendererBackend
+	{
+	public:
+		struct Stats
+		{
+			uint64_t Commands = 0;
+			uint64_t Clears = 0;
+			uint64_t ClearColorChanges = 0;
+			float ClearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			uint64_t ViewportChanges = 0;
+			uint64_t Draws = 0;
+			uint64_t Instances = 0;
+			uint64_t Indices = 0;
+
+			// Binds a GPU backend would have had to make, the number key sorting tries to keep down
+			uint64_t ShaderChanges = 0;
+			uint64_t MaterialChanges = 0;
+			uint64_t MeshChanges = 0;
+
+			// Renderer2D batches, each one draw call
+			uint64_t QuadBatches = 0;
+			uint64_t Quads = 0;
+			uint64_t QuadTextureBinds = 0;
+		};
+
+		void Execute(const RenderCommand* commands, uint32_t count) override;
+
+		const Stats& GetStats() const { return m_Stats; }
+		void ResetStats() { m_Stats = Stats(); }
+
+		// Busy-waits this long per executed command, standing in for driver overhead when
+		// measuring how submission overlaps with the rest of the frame
+		void SetSimulatedCommandCost(uint32_t nanoseconds) { m_SimulatedCommandCost = nanoseconds; }
+	private:
+		Stats m_Stats;
+		uint32_t m_SimulatedCommandCost = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,284 @@
+#include "pch.h"
+#include "OpenGLImGuiRenderer.h"
+
+#include "Glad/glad.h"
+
+#include "RockEngine/Core/Hash.h"
+
+namespace RockEngine
+{
+	static const char* s_ImGuiVertexSource = R"(
+		#version 410 core
+		layout(location = 0) in vec2 a_Position;
+		layout(location = 1) in vec2 a_TexCoord;
+		layout(location = 2) in vec4 a_Color;
+
+		uniform mat4 u_Projection;
+
+		out vec2 v_TexCoord;
+		out vec4 v_Color;
+
+		void main()
+		{
+			v_TexCoord = a_TexCoord;
+			v_Color = a_Color;
+			gl_Position = u_Projection * vec4(a_Position, 0.0, 1.0);
+		}
+	)";
+
+	static const char* s_ImGuiFragmentSource = R"(
+		#version 410 core
+		in vec2 v_TexCoord;
+		in vec4 v_Color;
+
+		uniform sampler2D u_Texture;
+
+		layout(location = 0) out vec4 o_Color;
+
+		void main()
+		{
+			o_Color = v_Color * texture(u_Texture, v_TexCoord);
+		}
+	)";
+
+	static GLuint CompileShader(GLenum type, const char* source)
+	{
+		GLuint shader = glCreateShader(type);
+		glShaderSource(shader, 1, &source, nullptr);
+		glCompileShader(shader);
+
+		GLint compiled = 0;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+		if (!compiled)
+		{
+			char log[1024];
+			glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+			RE_CORE_ERROR("OpenGL: ImGui shader failed to compile: {}", log);
+		}
+		return shader;
+	}
+
+	void OpenGLImGuiRenderer::Init()
+	{
+		GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, s_ImGuiVertexSource);
+		GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, s_ImGuiFragmentSource);
+		m_Shader = glCreateProgram();
+		glAttachShader(m_Shader, vertexShader);
+		glAttachShader(m_Shader, fragmentShader);
+		glLinkProgram(m_Shader);
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+
+		m_ProjectionLocation = glGetUniformLocation(m_Shader, "u_Projection");
+		glUseProgram(m_Shader);
+		glUniform1i(glGetUniformLocation(m_Shader, "u_Texture"), 0);
+		glUseProgram(0);
+
+		ImGuiIO& io = ImGui::GetIO();
+		io.BackendRendererName = "RockEngine OpenGL";
+		io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;	// draws with a base vertex, lists can pass 64k vertices
+
+		unsigned char* pixels;
+		int width, height;
+		io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+		glGenTextures(1, &m_FontTexture);
+		glBindTexture(GL_TEXTURE_2D, m_FontTexture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		io.Fonts->SetTexID((ImTextureID)(intptr_t)m_FontTexture);
+	}
+
+	void OpenGLImGuiRenderer::Shutdown()
+	{
+		for (CachedList& cached : m_Lists)
+		{
+			glDeleteVertexArrays(1, &cached.VertexArray);
+			glDeleteBuffers(1, &cached.VertexBuffer);
+			glDeleteBuffers(1, &cached.IndexBuffer);
+		}
+		m_Lists.clear();
+		m_Generation = 0;
+
+		if (m_FontTexture)
+		{
+			ImGui::GetIO().Fonts->SetTexID((ImTextureID)0);
+			glDeleteTextures(1, &m_FontTexture);
+			m_FontTexture = 0;
+		}
+		glDeleteProgram(m_Shader);
+		m_Shader = 0;
+	}
+
+	ImGuiRendererStats OpenGLImGuiRenderer::GetStats() const
+	{
+		ImGuiRendererStats stats;
+		stats.BuffersUploaded = m_BuffersUploaded.load(std::memory_order_relaxed);
+		stats.BuffersReused = m_BuffersReused.load(std::memory_order_relaxed);
+		stats.BytesUploaded = m_BytesUploaded.load(std::memory_order_relaxed);
+		stats.FramesReused = m_FramesReused.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void OpenGLImGuiRenderer::Upload(CachedList& cached, const ImDrawList& list)
+	{
+		if (!cached.VertexArray)
+		{
+			glGenVertexArrays(1, &cached.VertexArray);
+			glGenBuffers(1, &cached.VertexBuffer);
+			glGenBuffers(1, &cached.IndexBuffer);
+
+			glBindVertexArray(cached.VertexArray);
+			glBindBuffer(GL_ARRAY_BUFFER, cached.VertexBuffer);
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (const void*)offsetof(ImDrawVert, pos));
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (const void*)offsetof(ImDrawVert, uv));
+			glEnableVertexAttribArray(2);
+			glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (const void*)offsetof(ImDrawVert, col));
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cached.IndexBuffer);
+		}
+
+		// Both buffers start with a zero hash and capacity, so new ones always upload
+		size_t vertexBytes = (size_t)list.VtxBuffer.Size * sizeof(ImDrawVert);
+		size_t indexBytes = (size_t)list.IdxBuffer.Size * sizeof(ImDrawIdx);
+		uint64_t vertexHash = HashBytes(list.VtxBuffer.Data, vertexBytes, vertexBytes + 1);
+		uint64_t indexHash = HashBytes(list.IdxBuffer.Data, indexBytes, indexBytes + 1);
+		uint64_t uploaded = 0, bytes = 0;
+
+		if (vertexHash != cached.VertexHash)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, cached.VertexBuffer);
+			if (vertexBytes > cached.VertexCapacity)
+			{
+				// Room to grow, a window getting a bit longer shouldn't reallocate every frame
+				cached.VertexCapacity = vertexBytes + vertexBytes / 2;
+				glBufferData(GL_ARRAY_BUFFER, cached.VertexCapacity, nullptr, GL_DYNAMIC_DRAW);
+			}
+			glBufferSubData(GL_ARRAY_BUFFER, 0, vertexBytes, list.VtxBuffer.Data);
+			cached.VertexHash = vertexHash;
+			uploaded++;
+			bytes += vertexBytes;
+		}
+		if (indexHash != cached.IndexHash)
+		{
+			// The element buffer binding is part of the vertex array's state
+			glBindVertexArray(cached.VertexArray);
+			if (indexBytes > cached.IndexCapacity)
+			{
+				cached.IndexCapacity = indexBytes + indexBytes / 2;
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, cached.IndexCapacity, nullptr, GL_DYNAMIC_DRAW);
+			}
+			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexBytes, list.IdxBuffer.Data);
+			cached.IndexHash = indexHash;
+			uploaded++;
+			bytes += indexBytes;
+		}
+
+		m_BuffersUploaded.fetch_add(uploaded, std::memory_order_relaxed);
+		m_BuffersReused.fetch_add(2 - uploaded, std::memory_order_relaxed);
+		m_BytesUploaded.fetch_add(bytes, std::memory_order_relaxed);
+	}
+
+	void OpenGLImGuiRenderer::SetupRenderState(const ImDrawData& data, int width, int height)
+	{
+		glEnable(GL_BLEND);
+		glBlendEquation(GL_FUNC_ADD);
+		glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		glDisable(GL_CULL_FACE);
+		glDisable(GL_DEPTH_TEST);
+		glEnable(GL_SCISSOR_TEST);
+		glViewport(0, 0, width, height);
+
+		// Display space to clip space, y down
+		float left = data.DisplayPos.x, right = data.DisplayPos.x + data.DisplaySize.x;
+		float top = data.DisplayPos.y, bottom = data.DisplayPos.y + data.DisplaySize.y;
+		const float projection[16] = {
+			2.0f / (right - left), 0.0f, 0.0f, 0.0f,
+			0.0f, 2.0f / (top - bottom), 0.0f, 0.0f,
+			0.0f, 0.0f, -1.0f, 0.0f,
+			(right + left) / (left - right), (top + bottom) / (bottom - top), 0.0f, 1.0f
+		};
+		glUseProgram(m_Shader);
+		glUniformMatrix4fv(m_ProjectionLocation, 1, GL_FALSE, projection);
+		glActiveTexture(GL_TEXTURE0);
+	}
+
+	void OpenGLImGuiRenderer::Render(const ImDrawData* data, uint64_t generation /* = 0 */)
+	{
+		RE_PROFILE_FUNC();
+
+		int width = data ? (int)(data->DisplaySize.x * data->FramebufferScale.x) : 0;
+		int height = data ? (int)(data->DisplaySize.y * data->FramebufferScale.y) : 0;
+		if (width <= 0 || height <= 0)
+			return;
+
+		// Lists are matched by position: ImGui keeps windows in a stable order, so unless one
+		// opens, closes or comes to the front every list lands on its own buffers again
+		if (m_Lists.size() < (size_t)data->CmdListsCount)
+			m_Lists.resize(data->CmdListsCount);
+		if (generation && generation == m_Generation)
+		{
+			m_FramesReused.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			RE_PROFILE_SCOPE("OpenGLImGuiRenderer::Upload");
+			for (int i = 0; i < data->CmdListsCount; i++)
+				Upload(m_Lists[i], *data->CmdLists[i]);
+		}
+		m_Generation = generation;
+
+		// Only what the backends don't set themselves before drawing is put back
+		GLint lastViewport[4];
+		glGetIntegerv(GL_VIEWPORT, lastViewport);
+		GLboolean lastBlend = glIsEnabled(GL_BLEND);
+		GLboolean lastCullFace = glIsEnabled(GL_CULL_FACE);
+		GLboolean lastDepthTest = glIsEnabled(GL_DEPTH_TEST);
+
+		SetupRenderState(*data, width, height);
+
+		ImVec2 clipOffset = data->DisplayPos;
+		ImVec2 clipScale = data->FramebufferScale;
+		for (int i = 0; i < data->CmdListsCount; i++)
+		{
+			const ImDrawList* list = data->CmdLists[i];
+			glBindVertexArray(m_Lists[i].VertexArray);
+			for (const ImDrawCmd& command : list->CmdBuffer)
+			{
+				if (command.UserCallback)
+				{
+					if (command.UserCallback != ImDrawCallback_ResetRenderState)
+						command.UserCallback(list, &command);
+					SetupRenderState(*data, width, height);
+					glBindVertexArray(m_Lists[i].VertexArray);
+					continue;
+				}
+
+				float minX = (command.ClipRect.x - clipOffset.x) * clipScale.x;
+				float minY = (command.ClipRect.y - clipOffset.y) * clipScale.y;
+				float maxX = (command.ClipRect.z - clipOffset.x) * clipScale.x;
+				float maxY = (command.ClipRect.w - clipOffset.y) * clipScale.y;
+				if (maxX <= minX || maxY <= minY)
+					continue;
+
+				// Scissor boxes have their origin bottom left
+				glScissor((GLint)minX, (GLint)((float)height - maxY), (GLsizei)(maxX - minX), (GLsizei)(maxY - minY));
+				glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)command.TextureId);
+				glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)command.ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+					(const void*)(intptr_t)(command.IdxOffset * sizeof(ImDrawIdx)), (GLint)command.VtxOffset);
+			}
+		}
+
+		glBindVertexArray(0);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glUseProgram(0);
+		glDisable(GL_SCISSOR_TEST);
+		glViewport(lastViewport[0], lastViewport[1], lastViewport[2], lastViewport[3]);
+		if (!lastBlend) glDisable(GL_BLEND);
+		if (lastCullFace) glEnable(GL_CULL_FACE);
+		if (lastDepthTest) glEnable(GL_DEPTH_TEST);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "imgui.h"
+
+namespace RockEngine
+{
+	struct ImGuiRendererStats
+	{
+		uint64_t BuffersUploaded = 0;
+		uint64_t BuffersReused = 0;		// contents matched what the buffer already held
+		uint64_t BytesUploaded = 0;
+		uint64_t FramesReused = 0;		// same draw data as the last frame, nothing hashed or uploaded
+	};
+
+	// Draws ImGui draw data, in place of the stock OpenGL3 backend. Every draw list keeps a
+	// vertex and index buffer of its own across frames, and a buffer is only re-uploaded when
+	// the hash of its contents changed: windows that didn't move or redraw cost no uploads.
+	// Init, Render and Shutdown run on the thread owning the graphics context.
+	class OpenGLImGuiRenderer
+	{
+	public:
+		// Creates the shader and the font atlas texture, the atlas has to be built by then
+		void Init();
+		void Shutdown();
+
+		// `generation` identifies the draw data's contents: the same non-zero value as the last
+		// call draws the buffers as they are, without hashing anything
+		void Render(const ImDrawData* data, uint64_t generation = 0);
+
+		ImGuiRendererStats GetStats() const;
+	private:
+		struct CachedList
+		{
+			uint32_t VertexArray = 0;
+			uint32_t VertexBuffer = 0;
+			uint32_t IndexBuffer = 0;
+			size_t VertexCapacity = 0, IndexCapacity = 0;
+			uint64_t VertexHash = 0, IndexHash = 0;
+		};
+
+		void Upload(CachedList& cached, const ImDrawList& list);
+		void SetupRenderState(const ImDrawData& data, int width, int height);
+	private:
+		uint32_t m_Shader = 0;
+		int32_t m_ProjectionLocation = -1;
+		uint32_t m_FontTexture = 0;
+
+		std::vector<CachedList> m_Lists;
+		uint64_t m_Generation = 0;
+
+		// Written on the render thread, read by the UI panels
+		std::atomic<uint64_t> m_BuffersUploaded{ 0 };
+		std::atomic<uint64_t> m_BuffersReused{ 0 };
+		std::atomic<uint64_t> m_BytesUploaded{ 0 };
+		std::atomic<uint64_t> m_FramesReused{ 0 };
+	};
+}
\ No newline at end of file
@@ -1,18 +0,0 @@
-#include "pch.h"
-#include "RockEngine/Renderer/RendererAPI.h"
-
-#include "Glad/glad.h"
-
-namespace RockEngine
-{
-	void RendererAPI::Clear(float r, float g, float b, float a)
-	{
-		glClearColor(r, g, b, a);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	}
-
-	void RendererAPI::SetClearColor(float r, float g, float b, float a)
-	{
-		glClearColor(r, g, b, a);
-	}
-}
\ No newline at end of file
@@ -0,0 +1,280 @@
+#include "pch.h"
+#include "OpenGLRendererBackend.h"
+
+#include "Glad/glad.h"
+
+namespace RockEngine
+{
+	static const char* s_QuadVertexSource = R"(
+		#version 410 core
+		layout(location = 0) in vec4 a_Position;
+		layout(location = 1) in vec2 a_TexCoord;
+		layout(location = 2) in vec4 a_Color;
+		layout(location = 3) in uint a_TextureSlot;
+
+		out vec2 v_TexCoord;
+		out vec4 v_Color;
+		flat out uint v_TextureSlot;
+
+		void main()
+		{
+			v_TexCoord = a_TexCoord;
+			v_Color = a_Color;
+			v_TextureSlot = a_TextureSlot;
+			gl_Position = a_Position;
+		}
+	)";
+
+	// Samplers are picked with a switch, indexing a sampler array with a varying isn't portable in 4.1
+	static const char* s_QuadFragmentSource = R"(
+		#version 410 core
+		in vec2 v_TexCoord;
+		in vec4 v_Color;
+		flat in uint v_TextureSlot;
+
+		uniform sampler2D u_Textures[16];
+
+		layout(location = 0) out vec4 o_Color;
+
+		void main()
+		{
+			vec4 texel;
+			switch (v_TextureSlot)
+			{
+				case 0u:  texel = texture(u_Textures[0], v_TexCoord); break;
+				case 1u:  texel = texture(u_Textures[1], v_TexCoord); break;
+				case 2u:  texel = texture(u_Textures[2], v_TexCoord); break;
+				case 3u:  texel = texture(u_Textures[3], v_TexCoord); break;
+				case 4u:  texel = texture(u_Textures[4], v_TexCoord); break;
+				case 5u:  texel = texture(u_Textures[5], v_TexCoord); break;
+				case 6u:  texel = texture(u_Textures[6], v_TexCoord); break;
+				case 7u:  texel = texture(u_Textures[7], v_TexCoord); break;
+				case 8u:  texel = texture(u_Textures[8], v_TexCoord); break;
+				case 9u:  texel = texture(u_Textures[9], v_TexCoord); break;
+				case 10u: texel = texture(u_Textures[10], v_TexCoord); break;
+				case 11u: texel = texture(u_Textures[11], v_TexCoord); break;
+				case 12u: texel = texture(u_Textures[12], v_TexCoord); break;
+				case 13u: texel = texture(u_Textures[13], v_TexCoord); break;
+				case 14u: texel = texture(u_Textures[14], v_TexCoord); break;
+				default:  texel = texture(u_Textures[15], v_TexCoord); break;
+			}
+			o_Color = texel * v_Color;
+		}
+	)";
+
+	static constexpr size_t s_QuadRegionSize = (size_t)DrawQuadsCommand::MaxQuads * 4 * sizeof(QuadVertex);
+
+	static GLuint CompileShader(GLenum type, const char* source)
+	{
+		GLuint shader = glCreateShader(type);
+		glShaderSource(shader, 1, &source, nullptr);
+		glCompileShader(shader);
+
+		GLint compiled = 0;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+		if (!compiled)
+		{
+			char log[1024];
+			glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+			RE_CORE_ERROR("OpenGL: quad shader failed to compile: {}", log);
+		}
+		return shader;
+	}
+
+	void OpenGLRendererBackend::Init()
+	{
+		GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, s_QuadVertexSource);
+		GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, s_QuadFragmentSource);
+		m_QuadShader = glCreateProgram();
+		glAttachShader(m_QuadShader, vertexShader);
+		glAttachShader(m_QuadShader, fragmentShader);
+		glLinkProgram(m_QuadShader);
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+
+		GLint samplers[DrawQuadsCommand::MaxTextures];
+		for (GLint i = 0; i < (GLint)DrawQuadsCommand::MaxTextures; i++)
+			samplers[i] = i;
+		glUseProgram(m_QuadShader);
+		glUniform1iv(glGetUniformLocation(m_QuadShader, "u_Textures"), DrawQuadsCommand::MaxTextures, samplers);
+		glUseProgram(0);
+
+		glGenVertexArrays(1, &m_QuadVertexArray);
+		glBindVertexArray(m_QuadVertexArray);
+
+		glGenBuffers(1, &m_QuadVertexBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, m_QuadVertexBuffer);
+		if (GLAD_GL_VERSION_4_4)
+		{
+			GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(GL_ARRAY_BUFFER, s_QuadRegionSize * QuadRegions, nullptr, flags);
+			m_QuadMapped = (uint8_t*)glMapBufferRange(GL_ARRAY_BUFFER, 0, s_QuadRegionSize * QuadRegions, flags);
+		}
+		else
+		{
+			glBufferData(GL_ARRAY_BUFFER, s_QuadRegionSize, nullptr, GL_STREAM_DRAW);
+		}
+
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(QuadVertex), (const void*)offsetof(QuadVertex, Position));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(QuadVertex), (const void*)offsetof(QuadVertex, TexCoord));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(QuadVertex), (const void*)offsetof(QuadVertex, Color));
+		glEnableVertexAttribArray(3);
+		glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(QuadVertex), (const void*)offsetof(QuadVertex, TextureSlot));
+
+		// Every batch uses the same index pattern, so one static buffer covers them all
+		std::vector<uint16_t> indices((size_t)DrawQuadsCommand::MaxQuads * 6);
+		for (uint32_t quad = 0; quad < DrawQuadsCommand::MaxQuads; quad++)
+		{
+			uint16_t base = (uint16_t)(quad * 4);
+			uint16_t* out = &indices[(size_t)quad * 6];
+			out[0] = base; out[1] = base + 1; out[2] = base + 2;
+			out[3] = base + 2; out[4] = base + 3; out[5] = base;
+		}
+		glGenBuffers(1, &m_QuadIndexBuffer);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_QuadIndexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+		glBindVertexArray(0);
+
+		uint32_t white = 0xffffffff;
+		glGenTextures(1, &m_WhiteTexture);
+		glBindTexture(GL_TEXTURE_2D, m_WhiteTexture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &white);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	void OpenGLRendererBackend::Shutdown()
+	{
+		for (void*& fence : m_QuadFences)
+		{
+			if (fence)
+				glDeleteSync((GLsync)fence);
+			fence = nullptr;
+		}
+		if (m_QuadMapped)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, m_QuadVertexBuffer);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			m_QuadMapped = nullptr;
+		}
+		glDeleteTextures(1, &m_WhiteTexture);
+		glDeleteBuffers(1, &m_QuadIndexBuffer);
+		glDeleteBuffers(1, &m_QuadVertexBuffer);
+		glDeleteVertexArrays(1, &m_QuadVertexArray);
+		glDeleteProgram(m_QuadShader);
+	}
+
+	void OpenGLRendererBackend::DrawQuads(const DrawQuadsCommand& draw)
+	{
+		const QuadBatchData& frame = m_QuadFrames[draw.Frame];
+		const QuadVertex* vertices = frame.Vertices.data() + (size_t)draw.FirstQuad * 4;
+		size_t size = (size_t)draw.QuadCount * 4 * sizeof(QuadVertex);
+
+		glBindVertexArray(m_QuadVertexArray);
+		GLint baseVertex = 0;
+		if (m_QuadMapped)
+		{
+			// Region is free once the draw that last read it has finished
+			m_QuadRegion = (m_QuadRegion + 1) % QuadRegions;
+			if (GLsync fence = (GLsync)m_QuadFences[m_QuadRegion])
+			{
+				glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, ~0ull);
+				glDeleteSync(fence);
+			}
+			std::memcpy(m_QuadMapped + s_QuadRegionSize * m_QuadRegion, vertices, size);
+			baseVertex = (GLint)(m_QuadRegion * DrawQuadsCommand::MaxQuads * 4);
+		}
+		else
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, m_QuadVertexBuffer);
+			glBufferData(GL_ARRAY_BUFFER, s_QuadRegionSize, nullptr, GL_STREAM_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices);
+		}
+
+		for (uint32_t slot = 0; slot < draw.TextureCount; slot++)
+		{
+			uint32_t texture = frame.Textures[draw.FirstTexture + slot];
+			glActiveTexture(GL_TEXTURE0 + slot);
+			glBindTexture(GL_TEXTURE_2D, texture ? texture : m_WhiteTexture);
+		}
+		glActiveTexture(GL_TEXTURE0);
+
+		glDrawElementsBaseVertex(GL_TRIANGLES, draw.QuadCount * 6, GL_UNSIGNED_SHORT, nullptr, baseVertex);
+		if (m_QuadMapped)
+			m_QuadFences[m_QuadRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	void OpenGLRendererBackend::Execute(const RenderCommand* commands, uint32_t count)
+	{
+		// Commands arrive sorted by shader then material, so most binds are skipped
+		uint32_t boundShader = ~0u;
+		uint32_t boundMesh = ~0u;
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const RenderCommand& command = commands[i];
+			switch (command.Type)
+			{
+				case RenderCommandType::Clear:
+				{
+					const float* color = command.Clear.Color;
+					glClearColor(color[0], color[1], color[2], color[3]);
+					glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+					break;
+				}
+				case RenderCommandType::SetClearColor:
+				{
+					const float* color = command.SetClearColor.Color;
+					glClearColor(color[0], color[1], color[2], color[3]);
+					break;
+				}
+				case RenderCommandType::SetViewport:
+				{
+					const SetViewportCommand& viewport = command.SetViewport;
+					glViewport(viewport.X, viewport.Y, viewport.Width, viewport.Height);
+					break;
+				}
+				case RenderCommandType::Draw:
+				{
+					// Handles are GL names for now: program and vertex array. Materials have no
+					// GL state of their own yet.
+					const DrawCommand& draw = command.Draw;
+					if (draw.Shader != boundShader)
+					{
+						glUseProgram(draw.Shader);
+						boundShader = draw.Shader;
+					}
+					if (draw.Mesh != boundMesh)
+					{
+						glBindVertexArray(draw.Mesh);
+						boundMesh = draw.Mesh;
+					}
+					glDrawElementsInstanced(GL_TRIANGLES, draw.IndexCount, GL_UNSIGNED_INT,
+						(const void*)(uintptr_t)(draw.FirstIndex * sizeof(uint32_t)), draw.InstanceCount);
+					break;
+				}
+				case RenderCommandType::DrawQuads:
+				{
+					// Blended, in submission order
+					if (boundShader != m_QuadShader)
+					{
+						glUseProgram(m_QuadShader);
+						boundShader = m_QuadShader;
+					}
+					glEnable(GL_BLEND);
+					glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+					DrawQuads(command.DrawQuads);
+					boundMesh = m_QuadVertexArray;
+					glDisable(GL_BLEND);
+					break;
+				}
+				default:
+					break;
+			}
+		}
+	}
+}
\ No newline at end of file
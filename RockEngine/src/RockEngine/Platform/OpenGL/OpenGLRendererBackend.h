@@ -0,0 +1,31 @@
+#pragma once
+
+#include "RockEngine/Renderer/RendererBackend.h"
+
+namespace RockEngine
+{
+	class OpenGLRendererBackend : public RendererBackend
+	{
+	public:
+		void Init() override;
+		void Shutdown() override;
+
+		void Execute(const RenderCommand* commands, uint32_t count) override;
+	private:
+		void DrawQuads(const DrawQuadsCommand& draw);
+	private:
+		// Renderer2D: pass-through shader over a ring of persistently mapped vertex regions,
+		// one batch per region, fenced so the CPU never overwrites vertices still being read
+		static constexpr uint32_t QuadRegions = 8;
+
+		uint32_t m_QuadShader = 0;
+		uint32_t m_QuadVertexArray = 0;
+		uint32_t m_QuadVertexBuffer = 0;
+		uint32_t m_QuadIndexBuffer = 0;
+		uint32_t m_WhiteTexture = 0;
+
+		uint8_t* m_QuadMapped = nullptr;	// null without GL 4.4, uploads then orphan the buffer
+		void* m_QuadFences[QuadRegions] = {};
+		uint32_t m_QuadRegion = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "pch.h"
+#include "SoftwareFramebuffer.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace RockEngine
+{
+	SoftwareFramebuffer::SoftwareFramebuffer(uint32_t width, uint32_t height)
+	{
+		Resize(width, height);
+	}
+
+	void SoftwareFramebuffer::Resize(uint32_t width, uint32_t height)
+	{
+		m_Width = width;
+		m_Height = height;
+		m_Color.assign((size_t)width * height, 0);
+		m_Depth.assign((size_t)width * height, 1.0f);
+	}
+
+	void SoftwareFramebuffer::Clear(uint32_t color, float depth)
+	{
+		RE_PROFILE_FUNC();
+		std::fill(m_Color.begin(), m_Color.end(), color);
+		std::fill(m_Depth.begin(), m_Depth.end(), depth);
+	}
+
+	static uint32_t UpdateCrc32(uint32_t crc, const uint8_t* data, size_t size)
+	{
+		static const std::array<uint32_t, 256> s_Table = []()
+		{
+			std::array<uint32_t, 256> table;
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				uint32_t value = i;
+				for (uint32_t bit = 0; bit < 8; bit++)
+					value = value & 1 ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+				table[i] = value;
+			}
+			return table;
+		}();
+
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++)
+			crc = s_Table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+		return ~crc;
+	}
+
+	static void AppendBigEndian(std::vector<uint8_t>& out, uint32_t value)
+	{
+		uint8_t bytes[4] = { (uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value };
+		out.insert(out.end(), bytes, bytes + 4);
+	}
+
+	static void AppendChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+	{
+		AppendBigEndian(out, (uint32_t)data.size());
+		size_t start = out.size();
+		out.insert(out.end(), type, type + 4);
+		out.insert(out.end(), data.begin(), data.end());
+		AppendBigEndian(out, UpdateCrc32(0, &out[start], out.size() - start));
+	}
+
+	bool SoftwareFramebuffer::SavePNG(const std::string& path) const
+	{
+		RE_PROFILE_FUNC();
+
+		// Filter type 0 (none) in front of every row
+		size_t rowSize = (size_t)m_Width * 4 + 1;
+		std::vector<uint8_t> raw(rowSize * m_Height);
+		for (uint32_t y = 0; y < m_Height; y++)
+		{
+			uint8_t* row = &raw[y * rowSize];
+			row[0] = 0;
+			for (uint32_t x = 0; x < m_Width; x++)
+			{
+				uint32_t pixel = m_Color[(size_t)y * m_Width + x];
+				row[1 + x * 4 + 0] = (uint8_t)pixel;
+				row[1 + x * 4 + 1] = (uint8_t)(pixel >> 8);
+				row[1 + x * 4 + 2] = (uint8_t)(pixel >> 16);
+				row[1 + x * 4 + 3] = (uint8_t)(pixel >> 24);
+			}
+		}
+
+		// zlib stream of stored blocks, at most 65535 bytes each
+		std::vector<uint8_t> zlib = { 0x78, 0x01 };
+		zlib.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+		size_t offset = 0;
+		do
+		{
+			uint16_t length = (uint16_t)std::min<size_t>(raw.size() - offset, 65535);
+			bool last = offset + length == raw.size();
+			uint8_t header[5] = { (uint8_t)last, (uint8_t)length, (uint8_t)(length >> 8), (uint8_t)~length, (uint8_t)(~length >> 8) };
+			zlib.insert(zlib.end(), header, header + 5);
+			zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+			offset += length;
+		} while (offset < raw.size());
+
+		uint32_t a = 1, b = 0;
+		for (size_t i = 0; i < raw.size(); i++)
+		{
+			a = (a + raw[i]) % 65521;
+			b = (b + a) % 65521;
+		}
+		AppendBigEndian(zlib, b << 16 | a);
+
+		std::vector<uint8_t> header;
+		AppendBigEndian(header, m_Width);
+		AppendBigEndian(header, m_Height);
+		uint8_t format[5] = { 8, 6, 0, 0, 0 };		// 8 bit RGBA, deflate, no filtering choice, not interlaced
+		header.insert(header.end(), format, format + 5);
+
+		static const uint8_t s_Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		std::vector<uint8_t> file(s_Signature, s_Signature + 8);
+		AppendChunk(file, "IHDR", header);
+		AppendChunk(file, "IDAT", zlib);
+		AppendChunk(file, "IEND", {});
+
+		std::ofstream stream(path, std::ios::binary);
+		stream.write(reinterpret_cast<const char*>(file.data()), file.size());
+		if (!stream)
+		{
+			RE_CORE_ERROR("SoftwareFramebuffer: can't write {}", path);
+			return false;
+		}
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace RockEngine
+{
+	// Color (RGBA8, red in the lowest byte like QuadVertex::Color) and depth, rows top to bottom
+	class SoftwareFramebuffer
+	{
+	public:
+		SoftwareFramebuffer() = default;
+		SoftwareFramebuffer(uint32_t width, uint32_t height);
+
+		void Resize(uint32_t width, uint32_t height);
+		void Clear(uint32_t color, float depth = 1.0f);
+
+		inline uint32_t GetWidth() const { return m_Width; }
+		inline uint32_t GetHeight() const { return m_Height; }
+		inline uint32_t* GetColor() { return m_Color.data(); }
+		inline const uint32_t* GetColor() const { return m_Color.data(); }
+		inline float* GetDepth() { return m_Depth.data(); }
+		inline const float* GetDepth() const { return m_Depth.data(); }
+		inline uint32_t GetPixel(uint32_t x, uint32_t y) const { return m_Color[(size_t)y * m_Width + x]; }
+
+		// Uncompressed (stored deflate blocks) 8 bit RGBA, readable by anything that reads PNG
+		bool SavePNG(const std::string& path) const;
+	private:
+		uint32_t m_Width = 0;
+		uint32_t m_Height = 0;
+		std::vector<uint32_t> m_Color;
+		std::vector<float> m_Depth;
+	};
+
+	inline uint32_t PackRGBA8(float r, float g, float b, float a)
+	{
+		auto channel = [](float value) { return (uint32_t)(value <= 0.0f ? 0.0f : (value >= 1.0f ? 255.0f : value * 255.0f + 0.5f)); };
+		return channel(r) | channel(g) << 8 | channel(b) << 16 | channel(a) << 24;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,492 @@
+#include "pch.h"
+#include "SoftwareRasterizer.h"
+
+#include <climits>
+#include <cstring>
+
+#include "RockEngine/Core/JobSystem.h"
+#include "RockEngine/Math/Simd.h"
+#include "RockEngine/Memory/LinearAllocator.h"
+
+namespace RockEngine
+{
+	using Float8 = SimdTraits<SimdDefault>::Float8;
+
+	// Polygon vertices while clipping: position and varyings
+	static constexpr uint32_t s_MaxVertexFloats = 4 + SoftwareMaxVaryings;
+	// Near plane, w > 0 and the four guard band planes each add at most one vertex
+	static constexpr uint32_t s_MaxClipVertices = 3 + 6;
+	static constexpr float s_MinW = 1e-5f;
+
+	static uint32_t BlendRGBA8(uint32_t source, uint32_t destination)
+	{
+		uint32_t alpha = source >> 24;
+		uint32_t result = 0;
+		for (uint32_t shift = 0; shift < 32; shift += 8)
+		{
+			uint32_t value = ((source >> shift) & 0xff) * alpha + ((destination >> shift) & 0xff) * (255 - alpha) + 128;
+			result |= ((value + (value >> 8)) >> 8) << shift;
+		}
+		return result;
+	}
+
+	void SoftwareRasterizer::SetTarget(SoftwareFramebuffer* target)
+	{
+		Flush();
+		m_Target = target;
+		m_TilesX = target ? (target->GetWidth() + TileSize - 1) / TileSize : 0;
+		m_TilesY = target ? (target->GetHeight() + TileSize - 1) / TileSize : 0;
+		if (target)
+			SetViewport(0, 0, target->GetWidth(), target->GetHeight());
+	}
+
+	void SoftwareRasterizer::SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+	{
+		RE_CORE_ASSERT(m_Target, "No render target");
+		int32_t top = (int32_t)m_Target->GetHeight() - (int32_t)(y + height);
+
+		m_Viewport.X = (float)x;
+		m_Viewport.Y = (float)top;
+		m_Viewport.Width = (float)width;
+		m_Viewport.Height = (float)height;
+		m_Viewport.MinX = (int32_t)x;
+		m_Viewport.MinY = std::max(top, 0);
+		m_Viewport.MaxX = std::min((int32_t)(x + width), (int32_t)m_Target->GetWidth()) - 1;
+		m_Viewport.MaxY = std::min(top + (int32_t)height, (int32_t)m_Target->GetHeight()) - 1;
+
+		// Screen coordinates stay within 16k pixels, so edge functions fit their fixed point
+		m_Viewport.GuardBand = std::max(1.0f, 16384.0f / (float)std::max(std::max(width, height), 1u));
+	}
+
+	void SoftwareRasterizer::Draw(const SoftwareDrawCall& call)
+	{
+		RE_PROFILE_FUNC();
+		const SoftwareShader* shader = call.Shader;
+		if (!m_Target || !shader || !shader->Vertex || !shader->Fragment || call.IndexCount < 3 || !call.VertexCount || !call.InstanceCount)
+			return;
+		RE_CORE_ASSERT(shader->VaryingCount <= SoftwareMaxVaryings, "Too many varyings");
+
+		if (m_DrawCount == m_Draws.size())
+			m_Draws.emplace_back();
+		uint32_t drawIndex = m_DrawCount++;
+		PendingDraw& draw = m_Draws[drawIndex];
+		draw.Shader = *shader;
+		draw.VertexCount = call.VertexCount;
+
+		// Uniforms are copied, fragment shaders read them when the tiles are rasterized
+		draw.Uniforms = AlignUp(m_Uniforms.size(), 16);
+		draw.UniformSize = call.UniformSize;
+		m_Uniforms.resize(draw.Uniforms + call.UniformSize);
+		if (call.UniformSize)
+			std::memcpy(m_Uniforms.data() + draw.Uniforms, call.Uniforms, call.UniformSize);
+		const void* uniforms = call.UniformSize ? m_Uniforms.data() + draw.Uniforms : nullptr;
+
+		uint32_t stride = 4 + draw.Shader.VaryingCount;
+		uint32_t vertexCount = call.VertexCount * call.InstanceCount;
+		draw.Vertices.resize((size_t)vertexCount * stride);
+		JobSystem::ParallelFor(vertexCount, JobSystem::GetDefaultGrainSize(vertexCount, 256), [&](uint32_t begin, uint32_t end)
+		{
+			SoftwareVertexOutput out;
+			for (uint32_t i = begin; i < end; i++)
+			{
+				const uint8_t* vertex = static_cast<const uint8_t*>(call.Vertices) + (size_t)(i % call.VertexCount) * call.VertexStride;
+				draw.Shader.Vertex(vertex, i / call.VertexCount, uniforms, out);
+				float* shaded = &draw.Vertices[(size_t)i * stride];
+				std::memcpy(shaded, out.Position, 4 * sizeof(float));
+				std::memcpy(shaded + 4, out.Varyings, draw.Shader.VaryingCount * sizeof(float));
+			}
+		});
+
+		uint32_t triangleCount = call.IndexCount / 3 * call.InstanceCount;
+		uint32_t batchCount = (triangleCount + BatchSize - 1) / BatchSize;
+		uint32_t firstBatch = m_BatchCount;
+		m_BatchCount += batchCount;
+		if (m_Batches.size() < m_BatchCount)
+			m_Batches.resize(m_BatchCount);
+
+		JobSystem::ParallelFor(batchCount, 1, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t batch = begin; batch < end; batch++)
+				BinTriangles(m_Batches[firstBatch + batch], drawIndex, call, batch * BatchSize, std::min(BatchSize, triangleCount - batch * BatchSize));
+		});
+
+		m_Stats.Draws++;
+		m_Stats.Vertices += vertexCount;
+		m_Stats.Triangles += triangleCount;
+		for (uint32_t batch = firstBatch; batch < m_BatchCount; batch++)
+		{
+			m_Stats.TrianglesClipped += m_Batches[batch].Clipped;
+			m_Stats.TrianglesCulled += m_Batches[batch].Culled;
+			m_Stats.BinEntries += m_Batches[batch].Bins.size();
+		}
+	}
+
+	void SoftwareRasterizer::BinTriangles(TriangleBatch& batch, uint32_t draw, const SoftwareDrawCall& call, uint32_t first, uint32_t count)
+	{
+		RE_PROFILE_FUNC();
+		batch.Triangles.clear();
+		batch.Planes.clear();
+		batch.Bins.clear();
+		batch.MinTileX = batch.MinTileY = INT_MAX;
+		batch.MaxTileX = batch.MaxTileY = -1;
+		batch.Clipped = batch.Culled = 0;
+
+		const PendingDraw& pending = m_Draws[draw];
+		const uint32_t floats = 4 + pending.Shader.VaryingCount;
+		const uint32_t trianglesPerInstance = call.IndexCount / 3;
+		const float guard = m_Viewport.GuardBand;
+
+		// Planes as distances, inside is >= 0: clipped against are near, w > 0 and the guard band,
+		// the frustum sides and far plane only reject
+		auto outcode = [guard](const float* v)
+		{
+			float x = v[0], y = v[1], z = v[2], w = v[3];
+			uint32_t code = 0;
+			code |= (z + w < 0.0f) << 0 | (w < s_MinW) << 1;
+			code |= (guard * w - x < 0.0f) << 2 | (guard * w + x < 0.0f) << 3 | (guard * w - y < 0.0f) << 4 | (guard * w + y < 0.0f) << 5;
+			code |= (w - x < 0.0f) << 6 | (w + x < 0.0f) << 7 | (w - y < 0.0f) << 8 | (w + y < 0.0f) << 9 | (w - z < 0.0f) << 10;
+			return code;
+		};
+		constexpr uint32_t clipPlanes = 0x3f;
+
+		for (uint32_t triangle = first; triangle < first + count; triangle++)
+		{
+			uint32_t instance = triangle / trianglesPerInstance;
+			const uint32_t* indices = call.Indices + (size_t)(triangle % trianglesPerInstance) * 3;
+			if (indices[0] >= pending.VertexCount || indices[1] >= pending.VertexCount || indices[2] >= pending.VertexCount)
+			{
+				batch.Culled++;
+				continue;
+			}
+
+			const float* base = pending.Vertices.data() + (size_t)instance * pending.VertexCount * floats;
+			const float* v[3] = { base + (size_t)indices[0] * floats, base + (size_t)indices[1] * floats, base + (size_t)indices[2] * floats };
+			uint32_t codes[3] = { outcode(v[0]), outcode(v[1]), outcode(v[2]) };
+			if (codes[0] & codes[1] & codes[2])
+			{
+				batch.Culled++;
+				continue;
+			}
+			if (!((codes[0] | codes[1] | codes[2]) & clipPlanes))
+			{
+				SetupTriangle(batch, draw, v[0], v[1], v[2]);
+				continue;
+			}
+
+			// Sutherland-Hodgman in clip space, where interpolating linearly is perspective correct
+			float polygons[2][s_MaxClipVertices][s_MaxVertexFloats];
+			uint32_t vertexCount = 3;
+			for (uint32_t i = 0; i < 3; i++)
+				std::memcpy(polygons[0][i], v[i], floats * sizeof(float));
+
+			uint32_t current = 0;
+			for (uint32_t plane = 0; plane < 6 && vertexCount >= 3; plane++)
+			{
+				if (!(((codes[0] | codes[1] | codes[2]) >> plane) & 1))
+					continue;
+
+				auto distance = [plane, guard](const float* p)
+				{
+					switch (plane)
+					{
+						case 0: return p[2] + p[3];
+						case 1: return p[3] - s_MinW;
+						case 2: return guard * p[3] - p[0];
+						case 3: return guard * p[3] + p[0];
+						case 4: return guard * p[3] - p[1];
+						default: return guard * p[3] + p[1];
+					}
+				};
+
+				uint32_t outCount = 0;
+				for (uint32_t i = 0; i < vertexCount; i++)
+				{
+					const float* a = polygons[current][i];
+					const float* b = polygons[current][(i + 1) % vertexCount];
+					float da = distance(a), db = distance(b);
+					if (da >= 0.0f)
+						std::memcpy(polygons[current ^ 1][outCount++], a, floats * sizeof(float));
+					if ((da >= 0.0f) != (db >= 0.0f))
+					{
+						float t = da / (da - db);
+						float* out = polygons[current ^ 1][outCount++];
+						for (uint32_t k = 0; k < floats; k++)
+							out[k] = a[k] + (b[k] - a[k]) * t;
+					}
+				}
+				vertexCount = outCount;
+				current ^= 1;
+			}
+
+			if (vertexCount < 3)
+			{
+				batch.Culled++;
+				continue;
+			}
+			batch.Clipped++;
+			for (uint32_t i = 1; i + 1 < vertexCount; i++)
+				SetupTriangle(batch, draw, polygons[current][0], polygons[current][i], polygons[current][i + 1]);
+		}
+
+		std::sort(batch.Bins.begin(), batch.Bins.end());
+	}
+
+	void SoftwareRasterizer::SetupTriangle(TriangleBatch& batch, uint32_t draw, const float* v0, const float* v1, const float* v2)
+	{
+		const SoftwareShader& shader = m_Draws[draw].Shader;
+		const Viewport& viewport = m_Viewport;
+		const float* v[3] = { v0, v1, v2 };
+
+		float invW[3];
+		int32_t x[3], y[3];
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			invW[i] = 1.0f / v[i][3];
+			float screenX = viewport.X + (v[i][0] * invW[i] * 0.5f + 0.5f) * viewport.Width;
+			float screenY = viewport.Y + (0.5f - v[i][1] * invW[i] * 0.5f) * viewport.Height;
+			x[i] = (int32_t)std::lrint(screenX * 16.0f);
+			y[i] = (int32_t)std::lrint(screenY * 16.0f);
+		}
+
+		// Rows go down, so counter-clockwise (front facing) triangles have a negative area here
+		int64_t area = (int64_t)(x[1] - x[0]) * (y[2] - y[0]) - (int64_t)(x[2] - x[0]) * (y[1] - y[0]);
+		if (area == 0 || (area > 0 && shader.CullBackFaces))
+		{
+			batch.Culled++;
+			return;
+		}
+		if (area < 0)
+		{
+			std::swap(v[1], v[2]);
+			std::swap(invW[1], invW[2]);
+			std::swap(x[1], x[2]);
+			std::swap(y[1], y[2]);
+		}
+
+		// Pixels whose centers (x * 16 + 8) the bounds contain
+		TriangleSetup setup;
+		setup.MinX = std::max((std::min({ x[0], x[1], x[2] }) - 8 + 15) >> 4, viewport.MinX);
+		setup.MinY = std::max((std::min({ y[0], y[1], y[2] }) - 8 + 15) >> 4, viewport.MinY);
+		setup.MaxX = std::min((std::max({ x[0], x[1], x[2] }) - 8) >> 4, viewport.MaxX);
+		setup.MaxY = std::min((std::max({ y[0], y[1], y[2] }) - 8) >> 4, viewport.MaxY);
+		if (setup.MinX > setup.MaxX || setup.MinY > setup.MaxY)
+		{
+			batch.Culled++;
+			return;
+		}
+
+		for (uint32_t edge = 0; edge < 3; edge++)
+		{
+			uint32_t a = edge, b = (edge + 1) % 3;
+			setup.A[edge] = y[a] - y[b];
+			setup.B[edge] = x[b] - x[a];
+			setup.C[edge] = -((int64_t)setup.A[edge] * x[a] + (int64_t)setup.B[edge] * y[a]);
+
+			// Top-left rule: pixels exactly on an edge belong to the triangle on its left or top
+			bool topLeft = setup.A[edge] > 0 || (setup.A[edge] == 0 && setup.B[edge] > 0);
+			if (!topLeft)
+				setup.C[edge]--;
+		}
+
+		// Attribute planes: depth and 1/w are affine in screen space, varyings / w too
+		setup.OriginX = x[0] / 16.0f;
+		setup.OriginY = y[0] / 16.0f;
+		float dx1 = (x[1] - x[0]) / 16.0f, dy1 = (y[1] - y[0]) / 16.0f;
+		float dx2 = (x[2] - x[0]) / 16.0f, dy2 = (y[2] - y[0]) / 16.0f;
+		float invArea = 1.0f / (dx1 * dy2 - dx2 * dy1);
+
+		setup.Draw = draw;
+		setup.Planes = (uint32_t)batch.Planes.size();
+		auto addPlane = [&](float a0, float a1, float a2)
+		{
+			float d1 = a1 - a0, d2 = a2 - a0;
+			batch.Planes.push_back(a0);
+			batch.Planes.push_back((d1 * dy2 - d2 * dy1) * invArea);
+			batch.Planes.push_back((d2 * dx1 - d1 * dx2) * invArea);
+		};
+		addPlane(v[0][2] * invW[0] * 0.5f + 0.5f, v[1][2] * invW[1] * 0.5f + 0.5f, v[2][2] * invW[2] * 0.5f + 0.5f);
+		addPlane(invW[0], invW[1], invW[2]);
+		for (uint32_t k = 0; k < shader.VaryingCount; k++)
+			addPlane(v[0][4 + k] * invW[0], v[1][4 + k] * invW[1], v[2][4 + k] * invW[2]);
+
+		uint32_t index = (uint32_t)batch.Triangles.size();
+		batch.Triangles.push_back(setup);
+
+		int32_t minTileX = setup.MinX / (int32_t)TileSize, maxTileX = setup.MaxX / (int32_t)TileSize;
+		int32_t minTileY = setup.MinY / (int32_t)TileSize, maxTileY = setup.MaxY / (int32_t)TileSize;
+		for (int32_t tileY = minTileY; tileY <= maxTileY; tileY++)
+		{
+			for (int32_t tileX = minTileX; tileX <= maxTileX; tileX++)
+				batch.Bins.push_back((uint64_t)(tileY * m_TilesX + tileX) << 32 | index);
+		}
+		batch.MinTileX = std::min(batch.MinTileX, minTileX);
+		batch.MinTileY = std::min(batch.MinTileY, minTileY);
+		batch.MaxTileX = std::max(batch.MaxTileX, maxTileX);
+		batch.MaxTileY = std::max(batch.MaxTileY, maxTileY);
+	}
+
+	void SoftwareRasterizer::Flush()
+	{
+		RE_PROFILE_FUNC();
+		if (m_BatchCount && m_Target)
+		{
+			uint32_t tileCount = m_TilesX * m_TilesY;
+			JobSystem::ParallelFor(tileCount, 1, [this](uint32_t begin, uint32_t end)
+			{
+				for (uint32_t tile = begin; tile < end; tile++)
+					RasterizeTile(tile);
+			});
+		}
+
+		m_Stats.Pixels += m_PixelCount.exchange(0, std::memory_order_relaxed);
+		m_DrawCount = 0;
+		m_BatchCount = 0;
+		m_Uniforms.clear();
+	}
+
+	void SoftwareRasterizer::RasterizeTile(uint32_t tile)
+	{
+		int32_t tileX = (int32_t)(tile % m_TilesX), tileY = (int32_t)(tile / m_TilesX);
+		uint64_t pixels = 0;
+
+		// Batches in submission order, each one's triangles in order: blending stays in order
+		for (uint32_t index = 0; index < m_BatchCount; index++)
+		{
+			const TriangleBatch& batch = m_Batches[index];
+			if (tileX < batch.MinTileX || tileX > batch.MaxTileX || tileY < batch.MinTileY || tileY > batch.MaxTileY)
+				continue;
+
+			auto bin = std::lower_bound(batch.Bins.begin(), batch.Bins.end(), (uint64_t)tile << 32);
+			for (; bin != batch.Bins.end() && (*bin >> 32) == tile; ++bin)
+			{
+				const TriangleSetup& triangle = batch.Triangles[(uint32_t)*bin];
+				RasterizeTriangle(triangle, &batch.Planes[triangle.Planes], tileX * TileSize, tileY * TileSize, pixels);
+			}
+		}
+
+		if (pixels)
+			m_PixelCount.fetch_add(pixels, std::memory_order_relaxed);
+	}
+
+	void SoftwareRasterizer::RasterizeTriangle(const TriangleSetup& triangle, const float* planes, int32_t tileX, int32_t tileY, uint64_t& pixels)
+	{
+		int32_t minX = std::max(triangle.MinX, tileX), maxX = std::min(triangle.MaxX, tileX + (int32_t)TileSize - 1);
+		int32_t minY = std::max(triangle.MinY, tileY), maxY = std::min(triangle.MaxY, tileY + (int32_t)TileSize - 1);
+		if (minX > maxX || minY > maxY)
+			return;
+
+		const PendingDraw& draw = m_Draws[triangle.Draw];
+		const SoftwareShader& shader = draw.Shader;
+		const void* uniforms = draw.UniformSize ? m_Uniforms.data() + draw.Uniforms : nullptr;
+		// Locals, the compiler can't keep them in registers across the color buffer stores otherwise
+		const auto fragment = shader.Fragment;
+		const uint32_t varyingCount = shader.VaryingCount;
+		const uint32_t planeCount = 2 + varyingCount;
+		const bool depthTest = shader.DepthTest, writeDepth = shader.DepthTest && shader.DepthWrite, blend = shader.Blend;
+
+		const uint32_t width = m_Target->GetWidth();
+		uint32_t* colorBuffer = m_Target->GetColor();
+		float* depthBuffer = m_Target->GetDepth();
+
+		static const float s_LaneCenters[8] = { 0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f };
+		const Float8 laneCenters = Float8::Load(s_LaneCenters);
+
+		// Edge values of the 8 lanes relative to lane 0, exact in float for the spans that need them
+		Float8 laneSteps[3];
+		int64_t spanSteps[3];
+		for (uint32_t edge = 0; edge < 3; edge++)
+		{
+			float steps[8];
+			for (uint32_t lane = 0; lane < 8; lane++)
+				steps[lane] = (float)(triangle.A[edge] * 16 * (int32_t)lane);
+			laneSteps[edge] = Float8::Load(steps);
+			spanSteps[edge] = (int64_t)triangle.A[edge] * 16 * 8;
+		}
+
+		// Spans are 8 aligned pixels, tiles are a multiple of 8 wide
+		const int32_t spanStart = minX & ~7;
+		float rowBase[2 + SoftwareMaxVaryings];
+		float varyings[SoftwareMaxVaryings][8];
+		float depths[8];
+		float fragmentInput[SoftwareMaxVaryings];
+
+		for (int32_t y = minY; y <= maxY; y++)
+		{
+			int64_t edges[3];
+			for (uint32_t edge = 0; edge < 3; edge++)
+				edges[edge] = (int64_t)triangle.A[edge] * (spanStart * 16 + 8) + (int64_t)triangle.B[edge] * (y * 16 + 8) + triangle.C[edge];
+
+			float dy = (float)y + 0.5f - triangle.OriginY;
+			for (uint32_t plane = 0; plane < planeCount; plane++)
+				rowBase[plane] = planes[plane * 3] + planes[plane * 3 + 2] * dy;
+
+			for (int32_t x = spanStart; x <= maxX; x += 8)
+			{
+				int64_t spanEdges[3] = { edges[0], edges[1], edges[2] };
+				for (uint32_t edge = 0; edge < 3; edge++)
+					edges[edge] += spanSteps[edge];
+
+				// Lanes inside the bounds, then coverage: spans entirely inside or outside an
+				// edge are decided in integers, only the ones it crosses go through SIMD
+				uint32_t mask = 0xff;
+				if (x < minX)
+					mask &= 0xffu << (minX - x);
+				if (x + 7 > maxX)
+					mask &= 0xffu >> (x + 7 - maxX);
+				for (uint32_t edge = 0; edge < 3 && mask; edge++)
+				{
+					int64_t first = spanEdges[edge], last = first + spanSteps[edge] - triangle.A[edge] * 16;
+					if (first >= 0 && last >= 0)
+						continue;
+					if (first < 0 && last < 0)
+						mask = 0;
+					else
+						mask &= ~CompareLess(Float8::Splat((float)first) + laneSteps[edge], Float8::Zero());
+				}
+				if (!mask)
+					continue;
+
+				const Float8 dx = laneCenters + Float8::Splat((float)x - triangle.OriginX);
+				const Float8 depth = MulAdd(Float8::Splat(planes[1]), dx, Float8::Splat(rowBase[0]));
+				const size_t row = (size_t)y * width + x;
+				if (depthTest)
+				{
+					// The last span of a row can hang over the buffer's edge
+					if ((uint32_t)x + 8 <= width)
+					{
+						mask &= CompareLess(depth, Float8::Load(depthBuffer + row));
+					}
+					else
+					{
+						float stored[8] = {};
+						std::memcpy(stored, depthBuffer + row, (width - x) * sizeof(float));
+						mask &= CompareLess(depth, Float8::Load(stored));
+					}
+					if (!mask)
+						continue;
+				}
+
+				const Float8 w = Float8::Splat(1.0f) / MulAdd(Float8::Splat(planes[4]), dx, Float8::Splat(rowBase[1]));
+				for (uint32_t k = 0; k < varyingCount; k++)
+					(MulAdd(Float8::Splat(planes[(2 + k) * 3 + 1]), dx, Float8::Splat(rowBase[2 + k])) * w).Store(varyings[k]);
+				depth.Store(depths);
+
+				while (mask)
+				{
+					uint32_t lane = CountTrailingZeros(mask);
+					mask &= mask - 1;
+
+					for (uint32_t k = 0; k < varyingCount; k++)
+						fragmentInput[k] = varyings[k][lane];
+					uint32_t color = fragment(fragmentInput, uniforms);
+
+					size_t index = row + lane;
+					colorBuffer[index] = blend ? BlendRGBA8(color, colorBuffer[index]) : color;
+					if (writeDepth)
+						depthBuffer[index] = depths[lane];
+					pixels++;
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
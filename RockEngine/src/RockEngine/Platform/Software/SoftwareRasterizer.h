@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "RockEngine/Platform/Software/SoftwareFramebuffer.h"
+
+namespace RockEngine
+{
+	static constexpr uint32_t SoftwareMaxVaryings = 12;
+
+	struct SoftwareVertexOutput
+	{
+		float Position[4];							// clip space, GL conventions
+		float Varyings[SoftwareMaxVaryings];		// interpolated perspective correct
+	};
+
+	// The shader model: plain function pointers, Vertex once per vertex and instance, Fragment
+	// once per covered pixel that passed the depth test. Both run on job system workers.
+	struct SoftwareShader
+	{
+		void (*Vertex)(const void* vertex, uint32_t instance, const void* uniforms, SoftwareVertexOutput& out) = nullptr;
+		// Returns RGBA8
+		uint32_t (*Fragment)(const float* varyings, const void* uniforms) = nullptr;
+		uint32_t VaryingCount = 0;
+
+		bool DepthTest = false;			// less, like the GL defaults these are all off
+		bool DepthWrite = false;
+		bool Blend = false;				// source alpha, one minus source alpha
+		bool CullBackFaces = false;		// counter-clockwise is the front
+	};
+
+	struct SoftwareDrawCall
+	{
+		const SoftwareShader* Shader = nullptr;
+		const void* Uniforms = nullptr;		// copied, up to UniformSize bytes
+		uint32_t UniformSize = 0;
+
+		const void* Vertices = nullptr;
+		uint32_t VertexStride = 0;
+		uint32_t VertexCount = 0;
+		const uint32_t* Indices = nullptr;	// triangle list, indices past VertexCount drop the triangle
+		uint32_t IndexCount = 0;
+		uint32_t InstanceCount = 1;
+	};
+
+	struct SoftwareRasterizerStats
+	{
+		uint64_t Draws = 0;
+		uint64_t Vertices = 0;			// shaded, instances included
+		uint64_t Triangles = 0;			// submitted
+		uint64_t TrianglesClipped = 0;	// split at the near plane or guard band
+		uint64_t TrianglesCulled = 0;	// back faces, degenerate, outside the viewport
+		uint64_t BinEntries = 0;		// triangle and tile pairs
+		uint64_t Pixels = 0;			// shaded
+	};
+
+	// Sort-middle tiled rasterizer. Draw shades vertices and bins the triangles into 64x64
+	// tiles, both spread over the job system. Flush rasterizes every tile in parallel, each
+	// tile walking its triangles in submission order so blending matches a GPU's. Coverage
+	// and depth are evaluated 8 pixels at a time with the Simd.h registers; edges use 1/16
+	// pixel fixed point and the top-left fill rule, so shared edges are drawn exactly once.
+	class SoftwareRasterizer
+	{
+	public:
+		static constexpr uint32_t TileSize = 64;
+		static constexpr uint32_t BatchSize = 1024;		// triangles binned by one job
+
+		void SetTarget(SoftwareFramebuffer* target);
+		// GL convention, `y` is measured from the bottom. Clips like a scissor.
+		void SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+		void Draw(const SoftwareDrawCall& call);
+		// Rasterizes everything drawn since the last flush into the target
+		void Flush();
+
+		inline const SoftwareRasterizerStats& GetStats() const { return m_Stats; }
+		inline void ResetStats() { m_Stats = SoftwareRasterizerStats(); }
+	private:
+		struct TriangleSetup
+		{
+			int32_t A[3], B[3];			// edge functions A * x + B * y + C in 1/16 pixels
+			int64_t C[3];				// top-left bias included: inside is >= 0
+			int32_t MinX, MinY, MaxX, MaxY;
+			float OriginX, OriginY;		// attribute planes are relative to this
+			uint32_t Draw;
+			uint32_t Planes;			// offset into the batch's planes: depth, 1/w, varyings/w
+		};
+
+		struct TriangleBatch
+		{
+			std::vector<TriangleSetup> Triangles;
+			std::vector<float> Planes;	// value at the origin, d/dx, d/dy
+			std::vector<uint64_t> Bins;	// tile << 32 | triangle, sorted
+			int32_t MinTileX, MinTileY, MaxTileX, MaxTileY;
+			uint64_t Clipped, Culled;
+		};
+
+		struct PendingDraw
+		{
+			SoftwareShader Shader;
+			size_t Uniforms;				// offset into m_Uniforms
+			uint32_t UniformSize;
+			std::vector<float> Vertices;	// shaded: position, then the varyings
+			uint32_t VertexCount;
+		};
+
+		struct Viewport
+		{
+			float X, Y, Width, Height;		// top-left origin
+			int32_t MinX, MinY, MaxX, MaxY;	// pixels, inclusive, clamped to the target
+			float GuardBand;				// in multiples of w, triangles past it are clipped
+		};
+
+		void BinTriangles(TriangleBatch& batch, uint32_t draw, const SoftwareDrawCall& call, uint32_t first, uint32_t count);
+		void SetupTriangle(TriangleBatch& batch, uint32_t draw, const float* v0, const float* v1, const float* v2);
+		void RasterizeTile(uint32_t tile);
+		void RasterizeTriangle(const TriangleSetup& triangle, const float* planes, int32_t tileX, int32_t tileY, uint64_t& pixels);
+	private:
+		SoftwareFramebuffer* m_Target = nullptr;
+		Viewport m_Viewport = {};
+		uint32_t m_TilesX = 0, m_TilesY = 0;
+
+		// Reused across flushes, only the counts are reset
+		std::vector<PendingDraw> m_Draws;
+		uint32_t m_DrawCount = 0;
+		std::vector<TriangleBatch> m_Batches;
+		uint32_t m_BatchCount = 0;
+		std::vector<uint8_t> m_Uniforms;
+
+		SoftwareRasterizerStats m_Stats;
+		std::atomic<uint64_t> m_PixelCount{ 0 };
+	};
+
+	// RGBA8 texture for fragment shaders, nearest sampling with repeat
+	struct SoftwareTexture
+	{
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		std::vector<uint32_t> Pixels;
+
+		inline uint32_t Sample(float u, float v) const
+		{
+			uint32_t x = (uint32_t)((u - std::floor(u)) * (float)Width);
+			uint32_t y = (uint32_t)((v - std::floor(v)) * (float)Height);
+			return Pixels[(size_t)std::min(y, Height - 1) * Width + std::min(x, Width - 1)];
+		}
+	};
+
+	// Channel-wise a * b / 255
+	inline uint32_t ModulateRGBA8(uint32_t a, uint32_t b)
+	{
+		uint32_t result = 0;
+		for (uint32_t shift = 0; shift < 32; shift += 8)
+		{
+			uint32_t product = ((a >> shift) & 0xff) * ((b >> shift) & 0xff) + 128;
+			result |= ((product + (product >> 8)) >> 8) << shift;
+		}
+		return result;
+	}
+}
\ No newline at end of file
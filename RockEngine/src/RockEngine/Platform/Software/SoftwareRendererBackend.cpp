@@ -0,0 +1,191 @@
+#include "pch.h"
+#include "SoftwareRendererBackend.h"
+
+#include <cstring>
+
+namespace RockEngine
+{
+	// Renderer2D's pass-through shader: texture coordinates, color and texture slot
+	struct QuadUniforms
+	{
+		const SoftwareTexture* Textures[DrawQuadsCommand::MaxTextures];
+	};
+
+	static void QuadVertexShader(const void* vertex, uint32_t /*instance*/, const void* /*uniforms*/, SoftwareVertexOutput& out)
+	{
+		const QuadVertex& quad = *static_cast<const QuadVertex*>(vertex);
+		std::memcpy(out.Position, quad.Position, sizeof(out.Position));
+		out.Varyings[0] = quad.TexCoord[0];
+		out.Varyings[1] = quad.TexCoord[1];
+		for (uint32_t channel = 0; channel < 4; channel++)
+			out.Varyings[2 + channel] = (float)((quad.Color >> (channel * 8)) & 0xff) * (1.0f / 255.0f);
+		out.Varyings[6] = (float)quad.TextureSlot;
+	}
+
+	static uint32_t QuadFragmentShader(const float* varyings, const void* uniforms)
+	{
+		const QuadUniforms& quad = *static_cast<const QuadUniforms*>(uniforms);
+		uint32_t slot = std::min((uint32_t)(varyings[6] + 0.5f), DrawQuadsCommand::MaxTextures - 1);
+		uint32_t texel = quad.Textures[slot]->Sample(varyings[0], varyings[1]);
+		return ModulateRGBA8(texel, PackRGBA8(varyings[2], varyings[3], varyings[4], varyings[5]));
+	}
+
+	SoftwareRendererBackend::SoftwareRendererBackend(uint32_t width, uint32_t height)
+		: m_Framebuffer(width, height)
+	{
+	}
+
+	void SoftwareRendererBackend::Init()
+	{
+		m_Rasterizer.SetTarget(&m_Framebuffer);
+
+		m_QuadShader.Vertex = QuadVertexShader;
+		m_QuadShader.Fragment = QuadFragmentShader;
+		m_QuadShader.VaryingCount = 7;
+		m_QuadShader.Blend = true;
+
+		// Every batch uses the same index pattern, like the OpenGL backend's static buffer
+		m_QuadIndices.resize((size_t)DrawQuadsCommand::MaxQuads * 6);
+		for (uint32_t quad = 0; quad < DrawQuadsCommand::MaxQuads; quad++)
+		{
+			uint32_t base = quad * 4;
+			uint32_t* out = &m_QuadIndices[(size_t)quad * 6];
+			out[0] = base; out[1] = base + 1; out[2] = base + 2;
+			out[3] = base + 2; out[4] = base + 3; out[5] = base;
+		}
+
+		m_WhiteTexture.Width = m_WhiteTexture.Height = 1;
+		m_WhiteTexture.Pixels.assign(1, 0xffffffff);
+	}
+
+	void SoftwareRendererBackend::Resize(uint32_t width, uint32_t height)
+	{
+		m_Rasterizer.SetTarget(nullptr);
+		m_Framebuffer.Resize(width, height);
+		m_Rasterizer.SetTarget(&m_Framebuffer);
+	}
+
+	uint32_t SoftwareRendererBackend::CreateTexture(uint32_t width, uint32_t height, const uint32_t* pixels)
+	{
+		auto texture = std::make_unique<SoftwareTexture>();
+		texture->Width = width;
+		texture->Height = height;
+		texture->Pixels.assign(pixels, pixels + (size_t)width * height);
+		m_Textures.push_back(std::move(texture));
+		return (uint32_t)m_Textures.size();
+	}
+
+	uint32_t SoftwareRendererBackend::CreateShader(const SoftwareShader& shader)
+	{
+		m_Shaders.push_back(std::make_unique<SoftwareShader>(shader));
+		return (uint32_t)m_Shaders.size();
+	}
+
+	uint32_t SoftwareRendererBackend::CreateMesh(const void* vertices, uint32_t vertexCount, uint32_t vertexStride, const uint32_t* indices, uint32_t indexCount)
+	{
+		auto mesh = std::make_unique<Mesh>();
+		const uint8_t* bytes = static_cast<const uint8_t*>(vertices);
+		mesh->Vertices.assign(bytes, bytes + (size_t)vertexCount * vertexStride);
+		mesh->VertexCount = vertexCount;
+		mesh->VertexStride = vertexStride;
+		mesh->Indices.assign(indices, indices + indexCount);
+		m_Meshes.push_back(std::move(mesh));
+		return (uint32_t)m_Meshes.size();
+	}
+
+	uint32_t SoftwareRendererBackend::CreateMaterial(const void* uniforms, uint32_t size)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(uniforms);
+		m_Materials.emplace_back(bytes, bytes + size);
+		return (uint32_t)m_Materials.size();
+	}
+
+	const SoftwareTexture* SoftwareRendererBackend::GetTexture(uint32_t handle) const
+	{
+		return handle && handle <= m_Textures.size() ? m_Textures[handle - 1].get() : &m_WhiteTexture;
+	}
+
+	void SoftwareRendererBackend::DrawQuads(const DrawQuadsCommand& draw)
+	{
+		RE_CORE_ASSERT(m_QuadFrames && draw.Frame < m_QuadFrameCount
+			&& (size_t)(draw.FirstQuad + draw.QuadCount) * 4 <= m_QuadFrames[draw.Frame].Vertices.size(), "DrawQuads out of range");
+		const QuadBatchData& frame = m_QuadFrames[draw.Frame];
+
+		QuadUniforms uniforms;
+		for (uint32_t slot = 0; slot < DrawQuadsCommand::MaxTextures; slot++)
+			uniforms.Textures[slot] = slot < draw.TextureCount ? GetTexture(frame.Textures[draw.FirstTexture + slot]) : &m_WhiteTexture;
+
+		SoftwareDrawCall call;
+		call.Shader = &m_QuadShader;
+		call.Uniforms = &uniforms;
+		call.UniformSize = sizeof(uniforms);
+		call.Vertices = frame.Vertices.data() + (size_t)draw.FirstQuad * 4;
+		call.VertexStride = sizeof(QuadVertex);
+		call.VertexCount = draw.QuadCount * 4;
+		call.Indices = m_QuadIndices.data();
+		call.IndexCount = draw.QuadCount * 6;
+		m_Rasterizer.Draw(call);
+	}
+
+	void SoftwareRendererBackend::Execute(const RenderCommand* commands, uint32_t count)
+	{
+		RE_PROFILE_FUNC();
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const RenderCommand& command = commands[i];
+			switch (command.Type)
+			{
+				case RenderCommandType::Clear:
+				{
+					std::copy(command.Clear.Color, command.Clear.Color + 4, m_ClearColor);
+					m_Rasterizer.Flush();
+					m_Framebuffer.Clear(PackRGBA8(m_ClearColor[0], m_ClearColor[1], m_ClearColor[2], m_ClearColor[3]));
+					break;
+				}
+				case RenderCommandType::SetClearColor:
+					std::copy(command.SetClearColor.Color, command.SetClearColor.Color + 4, m_ClearColor);
+					break;
+				case RenderCommandType::SetViewport:
+				{
+					const SetViewportCommand& viewport = command.SetViewport;
+					m_Rasterizer.SetViewport(viewport.X, viewport.Y, viewport.Width, viewport.Height);
+					break;
+				}
+				case RenderCommandType::Draw:
+				{
+					// Shader and mesh are handles from this backend, the material is optional
+					const DrawCommand& draw = command.Draw;
+					if (!draw.Shader || draw.Shader > m_Shaders.size() || !draw.Mesh || draw.Mesh > m_Meshes.size() || draw.Material > m_Materials.size())
+					{
+						RE_CORE_ASSERT(false, "Draw with an unknown software renderer handle");
+						break;
+					}
+
+					const Mesh& mesh = *m_Meshes[draw.Mesh - 1];
+					SoftwareDrawCall call;
+					call.Shader = m_Shaders[draw.Shader - 1].get();
+					if (draw.Material)
+					{
+						call.Uniforms = m_Materials[draw.Material - 1].data();
+						call.UniformSize = (uint32_t)m_Materials[draw.Material - 1].size();
+					}
+					call.Vertices = mesh.Vertices.data();
+					call.VertexStride = mesh.VertexStride;
+					call.VertexCount = mesh.VertexCount;
+					call.Indices = mesh.Indices.data() + std::min<size_t>(draw.FirstIndex, mesh.Indices.size());
+					call.IndexCount = (uint32_t)std::min<size_t>(draw.IndexCount, mesh.Indices.size() - std::min<size_t>(draw.FirstIndex, mesh.Indices.size()));
+					call.InstanceCount = draw.InstanceCount;
+					m_Rasterizer.Draw(call);
+					break;
+				}
+				case RenderCommandType::DrawQuads:
+					DrawQuads(command.DrawQuads);
+					break;
+				default:
+					break;
+			}
+		}
+
+		m_Rasterizer.Flush();
+	}
+}
\ No newline at end of file
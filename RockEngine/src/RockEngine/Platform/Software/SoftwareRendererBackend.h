@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory>
+
+#include "RockEngine/Platform/Software/SoftwareRasterizer.h"
+#include "RockEngine/Renderer/RendererBackend.h"
+
+namespace RockEngine
+{
+	// Backend that renders on the CPU into an in-memory framebuffer: real pixels without a GPU,
+	// for thumbnails on servers and golden image tests. Resources are created here and their
+	// handles (1 based, 0 is none) go into the commands like GL names do for OpenGL.
+	class SoftwareRendererBackend : public RendererBackend
+	{
+	public:
+		SoftwareRendererBackend(uint32_t width = 1280, uint32_t height = 720);
+
+		void Init() override;
+		void Resize(uint32_t width, uint32_t height) override;
+		void Execute(const RenderCommand* commands, uint32_t count) override;
+
+		// Copied. Textures take RGBA8 pixels, bottom row first like glTexImage2D.
+		uint32_t CreateTexture(uint32_t width, uint32_t height, const uint32_t* pixels);
+		uint32_t CreateShader(const SoftwareShader& shader);
+		uint32_t CreateMesh(const void* vertices, uint32_t vertexCount, uint32_t vertexStride, const uint32_t* indices, uint32_t indexCount);
+		// Uniforms the shader callbacks get, Draw's Material
+		uint32_t CreateMaterial(const void* uniforms, uint32_t size);
+		const SoftwareTexture* GetTexture(uint32_t handle) const;
+
+		inline SoftwareFramebuffer& GetFramebuffer() { return m_Framebuffer; }
+		inline SoftwareRasterizer& GetRasterizer() { return m_Rasterizer; }
+	private:
+		void DrawQuads(const DrawQuadsCommand& draw);
+	private:
+		struct Mesh
+		{
+			std::vector<uint8_t> Vertices;
+			uint32_t VertexCount;
+			uint32_t VertexStride;
+			std::vector<uint32_t> Indices;
+		};
+
+		SoftwareFramebuffer m_Framebuffer;
+		SoftwareRasterizer m_Rasterizer;
+		float m_ClearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+		// unique_ptrs so handles can be resolved while more are created
+		std::vector<std::unique_ptr<SoftwareTexture>> m_Textures;
+		std::vector<std::unique_ptr<SoftwareShader>> m_Shaders;
+		std::vector<std::unique_ptr<Mesh>> m_Meshes;
+		std::vector<std::vector<uint8_t>> m_Materials;
+
+		SoftwareShader m_QuadShader;
+		SoftwareTexture m_WhiteTexture;
+		std::vector<uint32_t> m_QuadIndices;
+	};
+}
\ No newline at end of file
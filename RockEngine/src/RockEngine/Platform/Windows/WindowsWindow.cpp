@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "WindowsWindow.h"
 
+#include "RockEngine/Events/EventQueue.h"
+
 namespace RockEngine
 {
 	static void GLFWErrorCallback(int error, const char* description)
@@ -8,6 +10,14 @@ namespace RockEngine
 		RE_CORE_ERROR("GLFW Error: ({}: {})", error, description);
 	}
 
+	template<typename T>
+	void WindowsWindow::PushEvent(GLFWwindow* window, const T& event)
+	{
+		WindowData& data = *static_cast<WindowData*>(glfwGetWindowUserPointer(window));
+		if (data.Queue)
+			data.Queue->Push(event);
+	}
+
 	WindowsWindow::WindowsWindow(const WindowProps& props)
 	{
 		m_Data.Title = props.Title;
@@ -23,6 +33,8 @@ namespace RockEngine
 		glfwSetErrorCallback(GLFWErrorCallback);
 		m_Window = glfwCreateWindow(m_Data.Width, m_Data.Height, m_Data.Title.c_str(), nullptr, nullptr);
 		glfwMakeContextCurrent(m_Window);
+		glfwSetWindowUserPointer(m_Window, &m_Data);
+		SetCallbacks();
 
 		if (auto isInit = gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
 		{
@@ -30,9 +42,89 @@ namespace RockEngine
 		}
 	}
 
-	void WindowsWindow::OnUpdate()
+	void WindowsWindow::SetCallbacks()
+	{
+		glfwSetWindowSizeCallback(m_Window, [](GLFWwindow* window, int width, int height)
+		{
+			auto& data = *static_cast<WindowData*>(glfwGetWindowUserPointer(window));
+			data.Width = width;
+			data.Height = height;
+			PushEvent(window, WindowResizeEvent{ (uint32_t)width, (uint32_t)height });
+		});
+
+		glfwSetWindowCloseCallback(m_Window, [](GLFWwindow* window)
+		{
+			PushEvent(window, WindowCloseEvent{});
+		});
+
+		glfwSetWindowIconifyCallback(m_Window, [](GLFWwindow* window, int iconified)
+		{
+			auto& data = *static_cast<WindowData*>(glfwGetWindowUserPointer(window));
+			data.Minimized = iconified == GLFW_TRUE;
+		});
+
+		glfwSetWindowFocusCallback(m_Window, [](GLFWwindow* window, int focused)
+		{
+			auto& data = *static_cast<WindowData*>(glfwGetWindowUserPointer(window));
+			data.Focused = focused == GLFW_TRUE;
+			PushEvent(window, WindowFocusEvent{ focused == GLFW_TRUE });
+		});
+
+		glfwSetKeyCallback(m_Window, [](GLFWwindow* window, int key, int scancode, int action, int mods)
+		{
+			if (action == GLFW_RELEASE)
+				PushEvent(window, KeyReleasedEvent{ key, mods });
+			else
+				PushEvent(window, KeyPressedEvent{ key, mods, action == GLFW_REPEAT });
+		});
+
+		glfwSetCharCallback(m_Window, [](GLFWwindow* window, unsigned int codepoint)
+		{
+			PushEvent(window, KeyTypedEvent{ codepoint });
+		});
+
+		glfwSetMouseButtonCallback(m_Window, [](GLFWwindow* window, int button, int action, int mods)
+		{
+			if (action == GLFW_PRESS)
+				PushEvent(window, MouseButtonPressedEvent{ button, mods });
+			else
+				PushEvent(window, MouseButtonReleasedEvent{ button, mods });
+		});
+
+		glfwSetCursorPosCallback(m_Window, [](GLFWwindow* window, double x, double y)
+		{
+			PushEvent(window, MouseMovedEvent{ (float)x, (float)y });
+		});
+
+		glfwSetScrollCallback(m_Window, [](GLFWwindow* window, double xOffset, double yOffset)
+		{
+			PushEvent(window, MouseScrolledEvent{ (float)xOffset, (float)yOffset });
+		});
+	}
+
+	void WindowsWindow::PollEvents()
 	{
+		RE_PROFILE_SCOPE("glfwPollEvents");
 		glfwPollEvents();
+	}
+
+	void WindowsWindow::SwapBuffers()
+	{
+		if (m_SwapIntervalDirty.exchange(false, std::memory_order_acquire))
+			glfwSwapInterval(m_Data.VSync ? 1 : 0);
+
+		RE_PROFILE_SCOPE("glfwSwapBuffers");
 		glfwSwapBuffers(m_Window);
 	}
+
+	void WindowsWindow::SetVSync(bool enabled)
+	{
+		m_Data.VSync = enabled;
+		m_SwapIntervalDirty.store(true, std::memory_order_release);
+	}
+
+	void WindowsWindow::SetContextCurrent(bool current)
+	{
+		glfwMakeContextCurrent(current ? m_Window : nullptr);
+	}
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include <Glad/glad.h>
 #include <GLFW/glfw3.h>
 
@@ -11,12 +13,22 @@ namespace RockEngine
 	public:
 		WindowsWindow(const WindowProps& props);
 
-		void OnUpdate() override;
+		void PollEvents() override;
+		void SwapBuffers() override;
+		void SetContextCurrent(bool current) override;
 
 		// Windows attributes
 		uint32_t GetWidth() override { return m_Data.Width; }
 		uint32_t GetHeight() override { return m_Data.Height; }
 
+		void SetEventQueue(EventQueue* queue) override { m_Data.Queue = queue; }
+
+		void SetVSync(bool enabled) override;
+		bool IsVSync() const override { return m_Data.VSync; }
+
+		bool IsMinimized() const override { return m_Data.Minimized; }
+		bool IsFocused() const override { return m_Data.Focused; }
+
 		inline void* GetNativeWindow() { return m_Window; }
 	private:
 		struct WindowData
@@ -25,10 +37,23 @@ namespace RockEngine
 			uint32_t Width;
 			uint32_t Height;
 
+			EventQueue* Queue = nullptr;
+
 			bool VSync = false;
+			// Written by the callbacks on the main thread, read by the pacing code on the same thread
+			bool Minimized = false;
+			bool Focused = true;
 		};
 
+		void SetCallbacks();
+
+		// Callbacks only copy the event into the queue, Application::Run dispatches it next frame
+		template<typename T>
+		static void PushEvent(GLFWwindow* window, const T& event);
+	private:
 		WindowData m_Data;
 		GLFWwindow* m_Window;
+		// The swap interval belongs to the context, so it is set by whichever thread swaps
+		std::atomic<bool> m_SwapIntervalDirty{ true };
 	};
 }
\ No newline at end of file
@@ -0,0 +1,291 @@
+#include "pch.h"
+#include "QuadBatcher.h"
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+	#define RE_QUAD_SIMD 1
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define RE_TARGET_AVX
+	#else
+		#define RE_TARGET_AVX __attribute__((target("avx")))
+	#endif
+#endif
+
+namespace RockEngine
+{
+	// Every kernel works on the same per-quad decomposition: the clip space center plus the
+	// clip space half extents along the quad's rotated x and y axes,
+	//   corner = center +- halfX +- halfY
+	// so the matrix is applied once per quad instead of once per vertex.
+
+	static void GenerateScalar(const QuadInstance* quads, const uint8_t* slots, uint32_t count, const float* m, QuadVertex* vertices)
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const QuadInstance& quad = quads[i];
+			float c = 1.0f, s = 0.0f;
+			if (quad.Rotation != 0.0f)
+			{
+				c = std::cos(quad.Rotation);
+				s = std::sin(quad.Rotation);
+			}
+			float xx = 0.5f * quad.Size[0] * c, xy = 0.5f * quad.Size[0] * s;
+			float yx = -0.5f * quad.Size[1] * s, yy = 0.5f * quad.Size[1] * c;
+
+			float center[4], halfX[4], halfY[4];
+			for (int r = 0; r < 4; r++)
+			{
+				center[r] = m[r] * quad.Position[0] + m[4 + r] * quad.Position[1] + m[8 + r] * quad.Position[2] + m[12 + r];
+				halfX[r] = m[r] * xx + m[4 + r] * xy;
+				halfY[r] = m[r] * yx + m[4 + r] * yy;
+			}
+
+			static constexpr float signX[4] = { -1.0f, 1.0f, 1.0f, -1.0f };
+			static constexpr float signY[4] = { -1.0f, -1.0f, 1.0f, 1.0f };
+			QuadVertex* out = vertices + (size_t)i * 4;
+			for (int v = 0; v < 4; v++)
+			{
+				for (int r = 0; r < 4; r++)
+					out[v].Position[r] = center[r] + signX[v] * halfX[r] + signY[v] * halfY[r];
+				out[v].TexCoord[0] = quad.TexCoords[signX[v] < 0.0f ? 0 : 2];
+				out[v].TexCoord[1] = quad.TexCoords[signY[v] < 0.0f ? 1 : 3];
+				out[v].Color = quad.Color;
+				out[v].TextureSlot = slots[i];
+			}
+		}
+	}
+
+#ifdef RE_QUAD_SIMD
+	// Second half of each vertex: u, v, color, slot
+	static inline void QuadTails(const QuadInstance& quad, uint32_t slot, __m128 tails[4])
+	{
+		__m128 uv = _mm_loadu_ps(quad.TexCoords);											// u0 v0 u1 v1
+		__m128 rest = _mm_castsi128_ps(_mm_setr_epi32((int)quad.Color, (int)slot, 0, 0));	// color slot
+		__m128 u1v0 = _mm_shuffle_ps(uv, uv, _MM_SHUFFLE(1, 2, 1, 2));
+		__m128 u0v1 = _mm_shuffle_ps(uv, uv, _MM_SHUFFLE(3, 0, 3, 0));
+		tails[0] = _mm_movelh_ps(uv, rest);
+		tails[1] = _mm_movelh_ps(u1v0, rest);
+		tails[2] = _mm_movelh_ps(_mm_movehl_ps(uv, uv), rest);
+		tails[3] = _mm_movelh_ps(u0v1, rest);
+	}
+
+	static inline void QuadAxes(const QuadInstance& quad, float& c, float& s)
+	{
+		c = 1.0f;
+		s = 0.0f;
+		if (quad.Rotation != 0.0f)
+		{
+			c = std::cos(quad.Rotation);
+			s = std::sin(quad.Rotation);
+		}
+	}
+
+	static void GenerateSSE(const QuadInstance* quads, const uint8_t* slots, uint32_t count, const float* m, QuadVertex* vertices)
+	{
+		const __m128 col0 = _mm_loadu_ps(m), col1 = _mm_loadu_ps(m + 4), col2 = _mm_loadu_ps(m + 8), col3 = _mm_loadu_ps(m + 12);
+		const __m128 half = _mm_set1_ps(0.5f);
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const QuadInstance& quad = quads[i];
+			float c, s;
+			QuadAxes(quad, c, s);
+
+			__m128 center = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col0, _mm_set1_ps(quad.Position[0])), _mm_mul_ps(col1, _mm_set1_ps(quad.Position[1]))),
+				_mm_add_ps(_mm_mul_ps(col2, _mm_set1_ps(quad.Position[2])), col3));
+			__m128 sizeX = _mm_mul_ps(half, _mm_set1_ps(quad.Size[0]));
+			__m128 sizeY = _mm_mul_ps(half, _mm_set1_ps(quad.Size[1]));
+			__m128 halfX = _mm_mul_ps(sizeX, _mm_add_ps(_mm_mul_ps(col0, _mm_set1_ps(c)), _mm_mul_ps(col1, _mm_set1_ps(s))));
+			__m128 halfY = _mm_mul_ps(sizeY, _mm_sub_ps(_mm_mul_ps(col1, _mm_set1_ps(c)), _mm_mul_ps(col0, _mm_set1_ps(s))));
+
+			__m128 bottom = _mm_sub_ps(center, halfY);
+			__m128 top = _mm_add_ps(center, halfY);
+			__m128 tails[4];
+			QuadTails(quad, slots[i], tails);
+
+			float* out = vertices[(size_t)i * 4].Position;
+			_mm_storeu_ps(out + 0, _mm_sub_ps(bottom, halfX));
+			_mm_storeu_ps(out + 4, tails[0]);
+			_mm_storeu_ps(out + 8, _mm_add_ps(bottom, halfX));
+			_mm_storeu_ps(out + 12, tails[1]);
+			_mm_storeu_ps(out + 16, _mm_add_ps(top, halfX));
+			_mm_storeu_ps(out + 20, tails[2]);
+			_mm_storeu_ps(out + 24, _mm_sub_ps(top, halfX));
+			_mm_storeu_ps(out + 28, tails[3]);
+		}
+	}
+
+	RE_TARGET_AVX static inline __m256 Pair(__m128 low, __m128 high)
+	{
+		return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+	}
+
+	RE_TARGET_AVX static inline __m256 Broadcast(float low, float high)
+	{
+		return Pair(_mm_set1_ps(low), _mm_set1_ps(high));
+	}
+
+	// Two quads per iteration, one in each 128 bit lane, whole 32 byte vertices per store
+	RE_TARGET_AVX static void GenerateAVX(const QuadInstance* quads, const uint8_t* slots, uint32_t count, const float* m, QuadVertex* vertices)
+	{
+		const __m256 col0 = _mm256_broadcast_ps((const __m128*)m), col1 = _mm256_broadcast_ps((const __m128*)(m + 4));
+		const __m256 col2 = _mm256_broadcast_ps((const __m128*)(m + 8)), col3 = _mm256_broadcast_ps((const __m128*)(m + 12));
+		const __m256 half = _mm256_set1_ps(0.5f);
+
+		uint32_t i = 0;
+		for (; i + 2 <= count; i += 2)
+		{
+			const QuadInstance& a = quads[i];
+			const QuadInstance& b = quads[i + 1];
+			float ca, sa, cb, sb;
+			QuadAxes(a, ca, sa);
+			QuadAxes(b, cb, sb);
+
+			__m256 center = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(col0, Broadcast(a.Position[0], b.Position[0])), _mm256_mul_ps(col1, Broadcast(a.Position[1], b.Position[1]))),
+				_mm256_add_ps(_mm256_mul_ps(col2, Broadcast(a.Position[2], b.Position[2])), col3));
+			__m256 sizeX = _mm256_mul_ps(half, Broadcast(a.Size[0], b.Size[0]));
+			__m256 sizeY = _mm256_mul_ps(half, Broadcast(a.Size[1], b.Size[1]));
+			__m256 c = Broadcast(ca, cb), s = Broadcast(sa, sb);
+			__m256 halfX = _mm256_mul_ps(sizeX, _mm256_add_ps(_mm256_mul_ps(col0, c), _mm256_mul_ps(col1, s)));
+			__m256 halfY = _mm256_mul_ps(sizeY, _mm256_sub_ps(_mm256_mul_ps(col1, c), _mm256_mul_ps(col0, s)));
+
+			__m256 bottom = _mm256_sub_ps(center, halfY);
+			__m256 top = _mm256_add_ps(center, halfY);
+			__m256 corners[4] = { _mm256_sub_ps(bottom, halfX), _mm256_add_ps(bottom, halfX), _mm256_add_ps(top, halfX), _mm256_sub_ps(top, halfX) };
+
+			__m128 tailsA[4], tailsB[4];
+			QuadTails(a, slots[i], tailsA);
+			QuadTails(b, slots[i + 1], tailsB);
+
+			float* outA = vertices[(size_t)i * 4].Position;
+			float* outB = outA + 32;
+			for (int v = 0; v < 4; v++)
+			{
+				_mm256_storeu_ps(outA + v * 8, Pair(_mm256_castps256_ps128(corners[v]), tailsA[v]));
+				_mm256_storeu_ps(outB + v * 8, Pair(_mm256_extractf128_ps(corners[v], 1), tailsB[v]));
+			}
+		}
+
+		if (i < count)
+			GenerateSSE(quads + i, slots + i, count - i, m, vertices + (size_t)i * 4);
+	}
+
+	static bool CPUSupportsAVX()
+	{
+	#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		return osxsave && avx && (_xgetbv(0) & 6) == 6;
+	#else
+		return __builtin_cpu_supports("avx");
+	#endif
+	}
+#endif
+
+	QuadKernel QuadBatcher::GetDefaultKernel()
+	{
+#ifdef RE_QUAD_SIMD
+		static const QuadKernel kernel = CPUSupportsAVX() ? QuadKernel::AVX : QuadKernel::SSE;
+		return kernel;
+#else
+		return QuadKernel::Scalar;
+#endif
+	}
+
+	const char* QuadBatcher::GetKernelName(QuadKernel kernel)
+	{
+		switch (kernel)
+		{
+			case QuadKernel::SSE: return "SSE";
+			case QuadKernel::AVX: return "AVX";
+			default:              return "Scalar";
+		}
+	}
+
+	void GenerateQuadVertices(QuadKernel kernel, const QuadInstance* quads, const uint8_t* slots, uint32_t count,
+		const float viewProjection[16], QuadVertex* vertices)
+	{
+#ifdef RE_QUAD_SIMD
+		if (kernel == QuadKernel::AVX)
+			return GenerateAVX(quads, slots, count, viewProjection, vertices);
+		if (kernel == QuadKernel::SSE)
+			return GenerateSSE(quads, slots, count, viewProjection, vertices);
+#endif
+		GenerateScalar(quads, slots, count, viewProjection, vertices);
+	}
+
+	QuadBatcher::QuadBatcher(QuadKernel kernel /* = GetDefaultKernel() */)
+		: m_Kernel(kernel)
+	{
+#ifndef RE_QUAD_SIMD
+		m_Kernel = QuadKernel::Scalar;
+#endif
+	}
+
+	void QuadBatcher::Build(const QuadInstance* quads, uint32_t count, const float viewProjection[16], uint32_t frame,
+		QuadBatchData& data, std::vector<DrawQuadsCommand>& commands)
+	{
+		RE_PROFILE_FUNC();
+		if (count == 0)
+			return;
+
+		uint32_t firstQuad = (uint32_t)(data.Vertices.size() / 4);
+		m_Slots.resize(count);
+
+		uint32_t textures[DrawQuadsCommand::MaxTextures];
+		uint32_t textureCount = 0;
+		uint32_t lastTexture = ~0u, lastSlot = 0;
+		uint32_t batchStart = 0;
+
+		auto closeBatch = [&](uint32_t end)
+		{
+			commands.push_back({ frame, firstQuad + batchStart, end - batchStart, (uint32_t)data.Textures.size(), textureCount });
+			data.Textures.insert(data.Textures.end(), textures, textures + textureCount);
+			m_Stats.Batches++;
+			batchStart = end;
+			textureCount = 0;
+			lastTexture = ~0u;
+		};
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if (i - batchStart == DrawQuadsCommand::MaxQuads)
+			{
+				closeBatch(i);
+				m_Stats.CapacitySplits++;
+			}
+
+			uint32_t texture = quads[i].Texture;
+			if (texture != lastTexture)
+			{
+				// Runs of the same texture skip the table search
+				uint32_t slot = 0;
+				while (slot < textureCount && textures[slot] != texture)
+					slot++;
+
+				if (slot == DrawQuadsCommand::MaxTextures)
+				{
+					closeBatch(i);
+					m_Stats.TextureSplits++;
+					slot = 0;
+				}
+				if (slot == textureCount)
+					textures[textureCount++] = texture;
+
+				lastTexture = texture;
+				lastSlot = slot;
+			}
+			m_Slots[i] = (uint8_t)lastSlot;
+		}
+		closeBatch(count);
+
+		data.Vertices.resize(data.Vertices.size() + (size_t)count * 4);
+		GenerateQuadVertices(m_Kernel, quads, m_Slots.data(), count, viewProjection, data.Vertices.data() + (size_t)firstQuad * 4);
+		m_Stats.Quads += count;
+	}
+}
\ No newline at end of file
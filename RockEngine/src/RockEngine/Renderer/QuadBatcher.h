@@ -0,0 +1,72 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "RockEngine/Renderer/RenderCommand.h"
+
+namespace RockEngine
+{
+	struct QuadInstance
+	{
+		float Position[3];		// center
+		float Rotation;			// radians around z
+		float Size[2];
+		float TexCoords[4];		// u0, v0, u1, v1, past 1 repeats the texture
+		uint32_t Color;			// RGBA8, see PackColor
+		uint32_t Texture;		// backend handle, 0 = white
+	};
+
+	inline uint32_t PackColor(float r, float g, float b, float a)
+	{
+		auto channel = [](float value) { return (uint32_t)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f); };
+		return channel(r) | (channel(g) << 8) | (channel(b) << 16) | (channel(a) << 24);
+	}
+
+	enum class QuadKernel
+	{
+		Scalar = 0,
+		SSE,
+		AVX
+	};
+
+	struct QuadBatcherStats
+	{
+		uint64_t Quads = 0;
+		uint64_t Batches = 0;
+		uint64_t TextureSplits = 0;		// batches closed because the texture table was full
+		uint64_t CapacitySplits = 0;	// batches closed at DrawQuadsCommand::MaxQuads
+	};
+
+	// Turns quads into DrawQuads batches: assigns texture slots in submission order, starting
+	// a new batch when the texture table or the index range is full, then generates the
+	// transformed vertices for everything in one pass.
+	class QuadBatcher
+	{
+	public:
+		// Best kernel this CPU runs
+		static QuadKernel GetDefaultKernel();
+		static const char* GetKernelName(QuadKernel kernel);
+
+		QuadBatcher(QuadKernel kernel = GetDefaultKernel());
+
+		// Appends to data and commands. viewProjection is column-major.
+		void Build(const QuadInstance* quads, uint32_t count, const float viewProjection[16], uint32_t frame,
+			QuadBatchData& data, std::vector<DrawQuadsCommand>& commands);
+
+		inline QuadKernel GetKernel() const { return m_Kernel; }
+		inline void SetKernel(QuadKernel kernel) { m_Kernel = kernel; }
+
+		inline const QuadBatcherStats& GetStats() const { return m_Stats; }
+		inline void ResetStats() { m_Stats = QuadBatcherStats(); }
+	private:
+		QuadKernel m_Kernel;
+		QuadBatcherStats m_Stats;
+		std::vector<uint8_t> m_Slots;
+	};
+
+	// 4 vertices per quad, slots[i] is quad i's index into its batch's texture table
+	void GenerateQuadVertices(QuadKernel kernel, const QuadInstance* quads, const uint8_t* slots, uint32_t count,
+		const float viewProjection[16], QuadVertex* vertices);
+}
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "pch.h"
+#include "RenderCapture.h"
+
+#include <cstring>
+
+#include "RockEngine/Asset/Compression.h"
+
+namespace RockEngine
+{
+	std::mutex RenderCapture::s_Mutex;
+	std::ofstream RenderCapture::s_File;
+	std::string RenderCapture::s_Path;
+	RenderCaptureHeader RenderCapture::s_Header;
+	std::atomic<uint32_t> RenderCapture::s_FramesLeft{ 0 };
+	std::vector<RenderCaptureFrameEntry> RenderCapture::s_Frames;
+	std::vector<uint8_t> RenderCapture::s_Buffer;
+	std::vector<uint8_t> RenderCapture::s_Compressed;
+	RenderCaptureStats RenderCapture::s_Stats;
+
+	static uint64_t GetFrameSize(uint64_t commands, uint64_t quads, uint64_t textures)
+	{
+		return commands * sizeof(RenderCommand) + quads * 4 * sizeof(QuadVertex) + textures * sizeof(uint32_t);
+	}
+
+	bool RenderCapture::Begin(const std::string& path, uint32_t frames, uint32_t width, uint32_t height, RendererAPIType renderer)
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		if (s_File.is_open())
+		{
+			RE_CORE_ERROR("RenderCapture: already capturing to {}", s_Path);
+			return false;
+		}
+
+		s_File.open(path, std::ios::binary | std::ios::trunc);
+		if (!s_File || frames == 0)
+		{
+			RE_CORE_ERROR("RenderCapture: can't capture {} frames to {}", frames, path);
+			s_File.close();
+			return false;
+		}
+
+		// Rewritten with the frame count and table once the capture ends
+		s_Header = { RenderCaptureHeader::MagicValue, RenderCaptureHeader::CurrentVersion, 0, width, height, (uint32_t)renderer, 0 };
+		s_File.write(reinterpret_cast<const char*>(&s_Header), sizeof(s_Header));
+
+		s_Path = path;
+		s_Frames.clear();
+		s_Stats = RenderCaptureStats();
+		s_Stats.FileBytes = sizeof(s_Header);
+		s_FramesLeft = frames;
+		RE_CORE_INFO("RenderCapture: capturing {} frames to {}", frames, path);
+		return true;
+	}
+
+	void RenderCapture::End()
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		EndLocked();
+	}
+
+	void RenderCapture::EndLocked()
+	{
+		if (!s_File.is_open())
+			return;
+
+		s_FramesLeft = 0;
+		s_Header.FrameCount = (uint32_t)s_Frames.size();
+		s_Header.FrameTableOffset = s_Stats.FileBytes;
+		s_File.write(reinterpret_cast<const char*>(s_Frames.data()), s_Frames.size() * sizeof(RenderCaptureFrameEntry));
+		s_File.seekp(0);
+		s_File.write(reinterpret_cast<const char*>(&s_Header), sizeof(s_Header));
+		s_Stats.FileBytes += s_Frames.size() * sizeof(RenderCaptureFrameEntry);
+
+		bool written = (bool)s_File;
+		s_File.close();
+		if (!written)
+			RE_CORE_ERROR("RenderCapture: writing {} failed", s_Path);
+		else
+			RE_CORE_INFO("RenderCapture: {} frames, {} commands, {} KB ({} KB uncompressed) in {}",
+				s_Stats.Frames, s_Stats.Commands, s_Stats.FileBytes / 1024, s_Stats.RawBytes / 1024, s_Path);
+	}
+
+	bool RenderCapture::IsCapturing()
+	{
+		return s_FramesLeft.load(std::memory_order_relaxed) > 0;
+	}
+
+	RenderCaptureStats RenderCapture::GetStats()
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		return s_Stats;
+	}
+
+	void RenderCapture::Record(const RendererBackend& backend, const RenderCommand* commands, uint32_t count)
+	{
+		RE_PROFILE_FUNC();
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		if (!s_FramesLeft)
+			return;
+
+		const QuadBatchData* quadFrames = backend.GetQuadFrames();
+		uint32_t quadCount = 0, textureCount = 0;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if (commands[i].Type != RenderCommandType::DrawQuads)
+				continue;
+			const DrawQuadsCommand& draw = commands[i].DrawQuads;
+			RE_CORE_ASSERT(quadFrames && draw.Frame < backend.GetQuadFrameCount()
+				&& (size_t)(draw.FirstQuad + draw.QuadCount) * 4 <= quadFrames[draw.Frame].Vertices.size()
+				&& draw.FirstTexture + draw.TextureCount <= quadFrames[draw.Frame].Textures.size(), "DrawQuads out of range");
+			quadCount += draw.QuadCount;
+			textureCount += draw.TextureCount;
+		}
+
+		// Commands, then only the quads and texture tables they use: DrawQuads are rebased
+		// onto the packed arrays and all point at frame slot 0
+		s_Buffer.resize(GetFrameSize(count, quadCount, textureCount));
+		uint8_t* out = s_Buffer.data();
+		QuadVertex* vertices = reinterpret_cast<QuadVertex*>(out + (size_t)count * sizeof(RenderCommand));
+		uint32_t* textures = reinterpret_cast<uint32_t*>(vertices + (size_t)quadCount * 4);
+		uint32_t quad = 0, texture = 0;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			RenderCommand command = commands[i];
+			if (command.Type == RenderCommandType::DrawQuads)
+			{
+				DrawQuadsCommand& draw = command.DrawQuads;
+				const QuadBatchData& frame = quadFrames[draw.Frame];
+				std::memcpy(vertices + (size_t)quad * 4, &frame.Vertices[(size_t)draw.FirstQuad * 4], (size_t)draw.QuadCount * 4 * sizeof(QuadVertex));
+				std::memcpy(textures + texture, frame.Textures.data() + draw.FirstTexture, draw.TextureCount * sizeof(uint32_t));
+				draw.Frame = 0;
+				draw.FirstQuad = quad;
+				draw.FirstTexture = texture;
+				quad += draw.QuadCount;
+				texture += draw.TextureCount;
+			}
+			std::memcpy(out + (size_t)i * sizeof(RenderCommand), &command, sizeof(RenderCommand));
+		}
+
+		s_Compressed.resize(Compression::GetBound(s_Buffer.size()));
+		size_t compressed = Compression::CompressLZ4(s_Buffer.data(), s_Buffer.size(), s_Compressed.data(), s_Compressed.size());
+		s_File.write(reinterpret_cast<const char*>(s_Compressed.data()), compressed);
+
+		s_Frames.push_back({ s_Stats.FileBytes, (uint32_t)compressed, count, quadCount, textureCount });
+		s_Stats.Frames++;
+		s_Stats.Commands += count;
+		s_Stats.Quads += quadCount;
+		s_Stats.RawBytes += s_Buffer.size();
+		s_Stats.FileBytes += compressed;
+
+		if (--s_FramesLeft == 0)
+			EndLocked();
+	}
+
+	bool RenderCaptureFile::Open(const std::string& path)
+	{
+		Close();
+		if (!m_File.Open(path))
+			return false;
+
+		const uint8_t* data = m_File.GetData();
+		const uint64_t size = m_File.GetSize();
+		if (size >= sizeof(RenderCaptureHeader))
+			std::memcpy(&m_Header, data, sizeof(m_Header));
+
+		if (size < sizeof(RenderCaptureHeader) || m_Header.Magic != RenderCaptureHeader::MagicValue || m_Header.Version != RenderCaptureHeader::CurrentVersion
+			|| m_Header.FrameTableOffset < sizeof(RenderCaptureHeader) || m_Header.FrameTableOffset > size
+			|| (size - m_Header.FrameTableOffset) / sizeof(RenderCaptureFrameEntry) < m_Header.FrameCount)
+		{
+			RE_CORE_ERROR("RenderCaptureFile: {} isn't a complete version {} capture", path, RenderCaptureHeader::CurrentVersion);
+			Close();
+			return false;
+		}
+
+		m_Frames.resize(m_Header.FrameCount);
+		std::memcpy(m_Frames.data(), data + m_Header.FrameTableOffset, m_Frames.size() * sizeof(RenderCaptureFrameEntry));
+		for (const RenderCaptureFrameEntry& entry : m_Frames)
+		{
+			if (entry.Offset < sizeof(RenderCaptureHeader) || entry.Offset > m_Header.FrameTableOffset || entry.CompressedSize > m_Header.FrameTableOffset - entry.Offset)
+			{
+				RE_CORE_ERROR("RenderCaptureFile: {} has a frame outside the file", path);
+				Close();
+				return false;
+			}
+
+			// ReadFrame allocates the decompressed size up front, it can't be trusted any more than the rest
+			if (GetFrameSize(entry.CommandCount, entry.QuadCount, entry.TextureCount) > (uint64_t)entry.CompressedSize * Compression::MaxLZ4Ratio)
+			{
+				RE_CORE_ERROR("RenderCaptureFile: {} has a frame larger than its data can decompress to", path);
+				Close();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void RenderCaptureFile::Close()
+	{
+		m_File.Close();
+		m_Header = {};
+		m_Frames.clear();
+	}
+
+	bool RenderCaptureFile::ReadFrame(uint32_t index, RenderCaptureFrame& frame) const
+	{
+		RE_PROFILE_FUNC();
+		if (index >= m_Frames.size())
+			return false;
+
+		const RenderCaptureFrameEntry& entry = m_Frames[index];
+		std::vector<uint8_t> data(GetFrameSize(entry.CommandCount, entry.QuadCount, entry.TextureCount));
+		if (!Compression::DecompressLZ4(m_File.GetData() + entry.Offset, entry.CompressedSize, data.data(), data.size()))
+		{
+			RE_CORE_ERROR("RenderCaptureFile: frame {} is corrupt", index);
+			return false;
+		}
+
+		const uint8_t* in = data.data();
+		frame.Commands.resize(entry.CommandCount);
+		std::memcpy(frame.Commands.data(), in, (size_t)entry.CommandCount * sizeof(RenderCommand));
+		in += (size_t)entry.CommandCount * sizeof(RenderCommand);
+		frame.Quads.Vertices.resize((size_t)entry.QuadCount * 4);
+		std::memcpy(frame.Quads.Vertices.data(), in, frame.Quads.Vertices.size() * sizeof(QuadVertex));
+		in += frame.Quads.Vertices.size() * sizeof(QuadVertex);
+		frame.Quads.Textures.resize(entry.TextureCount);
+		std::memcpy(frame.Quads.Textures.data(), in, frame.Quads.Textures.size() * sizeof(uint32_t));
+
+		// Backends trust their commands, these came from a file
+		for (const RenderCommand& command : frame.Commands)
+		{
+			bool valid = command.Type > RenderCommandType::None && command.Type < RenderCommandType::Count;
+			if (command.Type == RenderCommandType::DrawQuads)
+			{
+				const DrawQuadsCommand& draw = command.DrawQuads;
+				valid = draw.Frame == 0 && draw.QuadCount <= DrawQuadsCommand::MaxQuads && draw.TextureCount <= DrawQuadsCommand::MaxTextures
+					&& (uint64_t)draw.FirstQuad + draw.QuadCount <= entry.QuadCount && (uint64_t)draw.FirstTexture + draw.TextureCount <= entry.TextureCount;
+			}
+			if (!valid)
+			{
+				RE_CORE_ERROR("RenderCaptureFile: frame {} has an invalid command", index);
+				return false;
+			}
+		}
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "RockEngine/Asset/MappedFile.h"
+#include "RockEngine/Renderer/RendererBackend.h"
+
+namespace RockEngine
+{
+	// Capture file: the header, then one LZ4 compressed block per frame, then the frame table.
+	// A frame is the sorted command stream one Execute call got, followed by the quad vertices
+	// and texture tables its DrawQuads commands referenced, repacked into a single frame slot.
+	// Resource handles are stored as they were: captures replay on other backends, but meshes
+	// and textures of the captured process aren't in the file.
+	struct RenderCaptureHeader
+	{
+		static constexpr uint32_t MagicValue = 0x50414352;		// "RCAP"
+		static constexpr uint32_t CurrentVersion = 1;
+
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t FrameCount;
+		uint32_t Width, Height;		// of the surface the frames were drawn to
+		uint32_t Renderer;			// RendererAPIType captured from
+		uint64_t FrameTableOffset;	// FrameCount RenderCaptureFrameEntry
+	};
+	static_assert(sizeof(RenderCaptureHeader) == 32, "Capture headers are written as is");
+
+	struct RenderCaptureFrameEntry
+	{
+		uint64_t Offset;
+		uint32_t CompressedSize;
+		uint32_t CommandCount;
+		uint32_t QuadCount;
+		uint32_t TextureCount;
+	};
+	static_assert(sizeof(RenderCaptureFrameEntry) == 24, "Capture frame entries are written as is");
+
+	// One frame read back, ready to Execute: set Quads as the backend's only quad frame slot
+	struct RenderCaptureFrame
+	{
+		std::vector<RenderCommand> Commands;
+		QuadBatchData Quads;
+	};
+
+	struct RenderCaptureStats
+	{
+		uint32_t Frames = 0;
+		uint64_t Commands = 0;
+		uint64_t Quads = 0;
+		uint64_t RawBytes = 0;		// frames before compression
+		uint64_t FileBytes = 0;
+	};
+
+	// Records what backends execute, for replaying a frame's workload offline (RockReplay).
+	// RenderQueue::Execute and the render thread report every stream right before executing
+	// it; capturing then costs the copy and compression of each frame on that thread.
+	class RenderCapture
+	{
+	public:
+		// Starts writing the next `frames` executed streams to `path`. Returns false if the file
+		// can't be created or a capture is already running.
+		static bool Begin(const std::string& path, uint32_t frames, uint32_t width, uint32_t height, RendererAPIType renderer);
+		// Writes the frame table. Called by itself after the last frame; a capture ended early
+		// keeps the frames recorded so far.
+		static void End();
+		static bool IsCapturing();
+
+		// From the thread that executes `commands` on `backend`
+		static void Record(const RendererBackend& backend, const RenderCommand* commands, uint32_t count);
+
+		static RenderCaptureStats GetStats();
+	private:
+		static void EndLocked();
+	private:
+		static std::mutex s_Mutex;
+		static std::ofstream s_File;
+		static std::string s_Path;
+		static RenderCaptureHeader s_Header;
+		static std::atomic<uint32_t> s_FramesLeft;
+		static std::vector<RenderCaptureFrameEntry> s_Frames;
+		static std::vector<uint8_t> s_Buffer;
+		static std::vector<uint8_t> s_Compressed;
+		static RenderCaptureStats s_Stats;
+	};
+
+	// A capture file read back. Everything is validated on Open and ReadFrame, so a damaged
+	// capture fails to load instead of handing a backend out of range commands.
+	class RenderCaptureFile
+	{
+	public:
+		bool Open(const std::string& path);
+		void Close();
+
+		inline const RenderCaptureHeader& GetHeader() const { return m_Header; }
+		inline uint32_t GetFrameCount() const { return m_Header.FrameCount; }
+		inline const RenderCaptureFrameEntry& GetFrameEntry(uint32_t index) const { return m_Frames[index]; }
+
+		bool ReadFrame(uint32_t index, RenderCaptureFrame& frame) const;
+	private:
+		MappedFile m_File;
+		RenderCaptureHeader m_Header = {};
+		std::vector<RenderCaptureFrameEntry> m_Frames;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace RockEngine
+{
+	enum class RenderCommandType : uint8_t
+	{
+		None = 0,
+		Clear, SetClearColor, SetViewport, Draw, DrawQuads,
+		Count
+	};
+
+	// Resource handles are raw backend ids (GL names for OpenGL) until there is a resource system
+	struct ClearCommand { static constexpr RenderCommandType Type = RenderCommandType::Clear; float Color[4]; };
+	struct SetClearColorCommand { static constexpr RenderCommandType Type = RenderCommandType::SetClearColor; float Color[4]; };
+	struct SetViewportCommand { static constexpr RenderCommandType Type = RenderCommandType::SetViewport; uint32_t X, Y, Width, Height; };
+	struct DrawCommand
+	{
+		static constexpr RenderCommandType Type = RenderCommandType::Draw;
+		uint32_t Shader;
+		uint32_t Material;
+		uint32_t Mesh;
+		uint32_t IndexCount;
+		uint32_t FirstIndex;
+		uint32_t InstanceCount;
+	};
+
+	// Pre-transformed (clip space) vertex generated by Renderer2D
+	struct QuadVertex
+	{
+		// Left uninitialized so growing the vertex array doesn't zero memory the batcher overwrites anyway
+		QuadVertex() {}
+
+		float Position[4];
+		float TexCoord[2];
+		uint32_t Color;			// RGBA8
+		uint32_t TextureSlot;	// into the batch's texture table
+	};
+	static_assert(sizeof(QuadVertex) == 32, "Quad vertices are uploaded as is");
+
+	// One frame's worth of 2D geometry. Renderer2D keeps it alive until the frame was presented.
+	struct QuadBatchData
+	{
+		std::vector<QuadVertex> Vertices;	// 4 per quad
+		std::vector<uint32_t> Textures;		// texture tables of all batches, backend handles (0 = white)
+	};
+
+	// Quads [FirstQuad, FirstQuad + QuadCount) of frame slot Frame, textured from
+	// Textures[FirstTexture, FirstTexture + TextureCount)
+	struct DrawQuadsCommand
+	{
+		static constexpr RenderCommandType Type = RenderCommandType::DrawQuads;
+		static constexpr uint32_t MaxQuads = 16384;		// 16 bit indices
+		static constexpr uint32_t MaxTextures = 16;
+
+		uint32_t Frame;
+		uint32_t FirstQuad;
+		uint32_t QuadCount;
+		uint32_t FirstTexture;
+		uint32_t TextureCount;
+	};
+
+	struct RenderCommand
+	{
+		RenderCommandType Type = RenderCommandType::None;
+		union
+		{
+			ClearCommand Clear;
+			SetClearColorCommand SetClearColor;
+			SetViewportCommand SetViewport;
+			DrawCommand Draw;
+			DrawQuadsCommand DrawQuads;
+			uint8_t Payload[24];
+		};
+
+		RenderCommand() : Payload{} {}
+
+		template<typename T>
+		static RenderCommand Make(const T& payload)
+		{
+			static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(Payload), "Render commands have to be small plain data");
+			RenderCommand command;
+			command.Type = T::Type;
+			std::memcpy(command.Payload, &payload, sizeof(T));
+			return command;
+		}
+	};
+	static_assert(sizeof(RenderCommand) == 28, "Keep render commands compact");
+
+	// Commands execute in ascending key order. Most significant bits first:
+	//   opaque:       | pass 8 | shader 12 | material 20 | depth 24 |  (state changes minimized, front to back)
+	//   back to front:| pass 8 | ~depth 24 | shader 12 | material 20 |  (for blending)
+	// Commands with equal keys keep the order they were recorded in.
+	struct RenderSortKey
+	{
+		static constexpr uint32_t PassBits = 8, ShaderBits = 12, MaterialBits = 20, DepthBits = 24;
+
+		static constexpr uint64_t Make(uint32_t pass, uint32_t shader, uint32_t material, uint32_t depth)
+		{
+			return ((uint64_t)(pass & Mask(PassBits)) << 56)
+				| ((uint64_t)(shader & Mask(ShaderBits)) << 44)
+				| ((uint64_t)(material & Mask(MaterialBits)) << 24)
+				| (uint64_t)(depth & Mask(DepthBits));
+		}
+
+		static constexpr uint64_t MakeBackToFront(uint32_t pass, uint32_t depth, uint32_t shader, uint32_t material)
+		{
+			return ((uint64_t)(pass & Mask(PassBits)) << 56)
+				| ((uint64_t)(~depth & Mask(DepthBits)) << 32)
+				| ((uint64_t)(shader & Mask(ShaderBits)) << 20)
+				| (uint64_t)(material & Mask(MaterialBits));
+		}
+
+		// [0, 1] view depth to the 24 bit key field
+		static uint32_t QuantizeDepth(float depth)
+		{
+			depth = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+			return (uint32_t)(depth * (float)Mask(DepthBits));
+		}
+
+		static constexpr uint32_t Mask(uint32_t bits) { return (1u << bits) - 1; }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "pch.h"
+#include "RenderQueue.h"
+
+#include "RockEngine/Core/JobSystem.h"
+#include "RockEngine/Renderer/RenderCapture.h"
+#include "RockEngine/Renderer/RendererBackend.h"
+
+namespace RockEngine
+{
+	RenderQueue::RenderQueue()
+	{
+		Init();
+	}
+
+	RenderQueue::~RenderQueue()
+	{
+	}
+
+	void RenderQueue::Init()
+	{
+		// The last buffer is for threads that aren't workers
+		uint32_t count = JobSystem::GetWorkerCount() + 1;
+		while (m_Buffers.size() < count)
+			m_Buffers.push_back(std::make_unique<RenderCommandBuffer>());
+	}
+
+	void RenderQueue::Submit(uint64_t key, const RenderCommand& command)
+	{
+		uint32_t worker = JobSystem::GetCurrentWorkerIndex();
+		if (worker < m_Buffers.size() - 1)
+		{
+			m_Buffers[worker]->Record(key, command);
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(m_SharedMutex);
+		m_Buffers.back()->Record(key, command);
+	}
+
+	void RenderQueue::Sort()
+	{
+		RE_PROFILE_FUNC();
+		uint64_t start = Profiler::Now();
+
+		m_Items.clear();
+		m_Stats.Buffers = 0;
+		for (uint32_t b = 0; b < m_Buffers.size(); b++)
+		{
+			const RenderCommandBuffer& buffer = *m_Buffers[b];
+			for (uint32_t i = 0; i < buffer.GetCount(); i++)
+				m_Items.push_back({ buffer.GetKey(i), b, i });
+			m_Stats.Buffers += buffer.GetCount() > 0;
+		}
+
+		// LSD radix sort, one byte per pass. It's stable, so equal keys stay in buffer then
+		// record order. Passes where every key has the same byte are skipped - with a handful
+		// of passes and shaders most of the high bytes are.
+		size_t count = m_Items.size();
+		m_Scratch.resize(count);
+		SortItem* source = m_Items.data();
+		SortItem* destination = m_Scratch.data();
+
+		uint32_t histograms[8][256] = {};
+		for (size_t i = 0; i < count; i++)
+		{
+			uint64_t key = source[i].Key;
+			for (uint32_t pass = 0; pass < 8; pass++)
+				histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+		}
+
+		for (uint32_t pass = 0; pass < 8; pass++)
+		{
+			uint32_t* histogram = histograms[pass];
+			if (count == 0 || histogram[(source[0].Key >> (pass * 8)) & 0xFF] == count)
+				continue;
+
+			uint32_t offset = 0;
+			for (uint32_t bucket = 0; bucket < 256; bucket++)
+			{
+				uint32_t size = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += size;
+			}
+
+			for (size_t i = 0; i < count; i++)
+				destination[histogram[(source[i].Key >> (pass * 8)) & 0xFF]++] = source[i];
+			std::swap(source, destination);
+		}
+
+		// Gather into one contiguous stream so the executor walks memory linearly
+		m_Sorted.resize(count);
+		m_SortedKeys.resize(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			m_Sorted[i] = m_Buffers[source[i].Buffer]->GetCommand(source[i].Index);
+			m_SortedKeys[i] = source[i].Key;
+		}
+
+		m_Stats.Commands = (uint32_t)count;
+		m_Stats.SortMs = (float)((Profiler::Now() - start) / 1e6);
+	}
+
+	void RenderQueue::Execute(RendererBackend& backend)
+	{
+		RE_PROFILE_FUNC();
+		if (RenderCapture::IsCapturing())
+			RenderCapture::Record(backend, m_Sorted.data(), (uint32_t)m_Sorted.size());
+		uint64_t start = Profiler::Now();
+
+		backend.Execute(m_Sorted.data(), (uint32_t)m_Sorted.size());
+
+		m_Stats.ExecuteMs = (float)((Profiler::Now() - start) / 1e6);
+	}
+
+	void RenderQueue::TakeSorted(std::vector<RenderCommand>& commands)
+	{
+		commands.swap(m_Sorted);
+		m_Sorted.clear();
+	}
+
+	void RenderQueue::Reset()
+	{
+		for (auto& buffer : m_Buffers)
+			buffer->Reset();
+		m_Sorted.clear();
+		m_SortedKeys.clear();
+	}
+}
\ No newline at end of file
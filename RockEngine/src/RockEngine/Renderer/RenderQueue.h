@@ -0,0 +1,94 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "RockEngine/Renderer/RenderCommand.h"
+
+namespace RockEngine
+{
+	class RendererBackend;
+
+	// Commands recorded by one thread. Storage is kept between frames, so recording stops
+	// allocating once the buffer has grown to a frame's worth of commands.
+	class RenderCommandBuffer
+	{
+	public:
+		void Record(uint64_t key, const RenderCommand& command)
+		{
+			m_Keys.push_back(key);
+			m_Commands.push_back(command);
+		}
+
+		template<typename T>
+		void Record(uint64_t key, const T& payload) { Record(key, RenderCommand::Make(payload)); }
+
+		void Reset()
+		{
+			m_Keys.clear();
+			m_Commands.clear();
+		}
+
+		inline uint32_t GetCount() const { return (uint32_t)m_Commands.size(); }
+		inline uint64_t GetKey(uint32_t index) const { return m_Keys[index]; }
+		inline const RenderCommand& GetCommand(uint32_t index) const { return m_Commands[index]; }
+	private:
+		std::vector<uint64_t> m_Keys;
+		std::vector<RenderCommand> m_Commands;
+	};
+
+	struct RenderQueueStats
+	{
+		uint32_t Commands;
+		uint32_t Buffers;		// that had anything recorded
+		float SortMs;
+		float ExecuteMs;
+	};
+
+	// One command buffer per job system worker plus a locked one shared by every other thread.
+	// Sort() merges them into a single stream ordered by key, Execute() hands that to a backend.
+	class RenderQueue
+	{
+	public:
+		RenderQueue();
+		~RenderQueue();
+
+		// Call after JobSystem::Init, and again if the worker count changes
+		void Init();
+
+		void Submit(uint64_t key, const RenderCommand& command);
+
+		template<typename T>
+		void Submit(uint64_t key, const T& payload) { Submit(key, RenderCommand::Make(payload)); }
+
+		// Only while nothing is recording
+		void Sort();
+		void Execute(RendererBackend& backend);
+		// Swaps the sorted stream out instead of executing it, e.g. into a render thread's frame packet
+		void TakeSorted(std::vector<RenderCommand>& commands);
+		void Reset();
+
+		inline const RenderCommand* GetSortedCommands() const { return m_Sorted.data(); }
+		inline const uint64_t* GetSortedKeys() const { return m_SortedKeys.data(); }
+		inline uint32_t GetSortedCount() const { return (uint32_t)m_Sorted.size(); }
+		inline const RenderQueueStats& GetLastStats() const { return m_Stats; }
+	private:
+		struct SortItem
+		{
+			uint64_t Key;
+			uint32_t Buffer;
+			uint32_t Index;
+		};
+	private:
+		std::vector<std::unique_ptr<RenderCommandBuffer>> m_Buffers;
+		std::mutex m_SharedMutex;
+
+		std::vector<SortItem> m_Items;
+		std::vector<SortItem> m_Scratch;
+		std::vector<RenderCommand> m_Sorted;
+		std::vector<uint64_t> m_SortedKeys;
+
+		RenderQueueStats m_Stats = {};
+	};
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "pch.h"
+#include "RenderThread.h"
+
+#include "RockEngine/Core/Window.h"
+#include "RockEngine/ImGui/ImGuiLayer.h"
+#include "RockEngine/Memory/MemoryTracker.h"
+#include "RockEngine/Renderer/RenderCapture.h"
+#include "RockEngine/Renderer/RendererBackend.h"
+
+namespace RockEngine
+{
+	RenderThread::RenderThread(Window& window, RendererBackend& backend, ImGuiLayer* ui, const RenderThreadProps& props /* = RenderThreadProps() */)
+		: m_Window(window), m_Backend(backend), m_UI(ui), m_Props(props)
+	{
+		// Per-frame data outside the packet (Renderer2D vertices) is only kept this many frames
+		m_Props.FramesInFlight = std::clamp(m_Props.FramesInFlight, 1u, RenderThreadProps::MaxFramesInFlight);
+
+		// One packet is being presented while the others queue up behind it
+		uint32_t packets = m_Props.FramesInFlight + 1;
+		for (uint32_t i = 0; i < packets; i++)
+			m_Packets.push_back(std::make_unique<FramePacket>());
+	}
+
+	RenderThread::~RenderThread()
+	{
+		Stop();
+	}
+
+	void RenderThread::Start()
+	{
+		if (m_Running)
+			return;
+
+		m_Window.SetContextCurrent(false);
+		m_StopRequested = false;
+		m_Running = true;
+		if (m_UI)
+			m_UI->SetRenderThreaded(true);
+		m_Thread = std::thread(&RenderThread::Main, this);
+
+		RE_CORE_INFO("RenderThread: started, {} frames in flight", m_Props.FramesInFlight);
+	}
+
+	void RenderThread::Stop()
+	{
+		if (!m_Running)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_StopRequested = true;
+		}
+		m_PacketReady.notify_all();
+		m_Thread.join();
+		m_Running = false;
+
+		if (m_UI)
+			m_UI->SetRenderThreaded(false);
+		m_Window.SetContextCurrent(true);
+
+		RE_CORE_INFO("RenderThread: presented {} frames, average latency {:.2f} ms", m_Stats.FramesPresented, m_Stats.AverageLatencyMs);
+	}
+
+	FramePacket& RenderThread::BeginPacket()
+	{
+		uint64_t start = Profiler::Now();
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_PacketFree.wait(lock, [this]() { return m_Pending < m_Packets.size(); });
+		}
+		m_Stats.LastWaitMs = (float)((Profiler::Now() - start) / 1e6);
+
+		return *m_Packets[m_WriteIndex];
+	}
+
+	void RenderThread::SubmitPacket()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_WriteIndex = (m_WriteIndex + 1) % m_Packets.size();
+			m_Pending++;
+		}
+		m_PacketReady.notify_one();
+	}
+
+	void RenderThread::WaitIdle()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_PacketFree.wait(lock, [this]() { return m_Pending == 0; });
+	}
+
+	RenderThreadStats RenderThread::GetStats()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Stats;
+	}
+
+	void RenderThread::Main()
+	{
+		RE_PROFILE_THREAD("Render");
+		RE_MEMORY_SCOPE("Renderer");
+
+		m_Window.SetContextCurrent(true);
+
+		for (;;)
+		{
+			FramePacket* packet;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_PacketReady.wait(lock, [this]() { return m_Pending > 0 || m_StopRequested; });
+				// Whatever was submitted before Stop() still gets presented
+				if (m_Pending == 0)
+					break;
+				packet = m_Packets[m_ReadIndex].get();
+			}
+
+			{
+				RE_PROFILE_SCOPE("RenderThread::Present");
+				if (RenderCapture::IsCapturing())
+					RenderCapture::Record(m_Backend, packet->Commands.data(), (uint32_t)packet->Commands.size());
+				m_Backend.Execute(packet->Commands.data(), (uint32_t)packet->Commands.size());
+				if (m_UI)
+					m_UI->RenderDrawData(packet->UI);
+				m_Window.SwapBuffers();
+			}
+
+			float latency = (float)((Profiler::Now() - packet->FrameStart) / 1e6);
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_ReadIndex = (m_ReadIndex + 1) % m_Packets.size();
+				m_Pending--;
+
+				m_Stats.FramesPresented++;
+				m_Stats.LastLatencyMs = latency;
+				m_Stats.AverageLatencyMs += (latency - m_Stats.AverageLatencyMs) / (float)std::min<uint64_t>(m_Stats.FramesPresented, 60);
+			}
+			m_PacketFree.notify_all();
+		}
+
+		m_Window.SetContextCurrent(false);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "RockEngine/Renderer/RenderCommand.h"
+#include "RockEngine/ImGui/ImGuiDrawSnapshot.h"
+
+namespace RockEngine
+{
+	class Window;
+	class RendererBackend;
+	class ImGuiLayer;
+
+	// Everything the render thread needs to present one frame
+	struct FramePacket
+	{
+		uint64_t Frame = 0;
+		uint64_t FrameStart = 0;	// Profiler::Now() when the main thread started the frame
+		std::vector<RenderCommand> Commands;
+		ImGuiDrawSnapshot UI;
+	};
+
+	struct RenderThreadProps
+	{
+		static constexpr uint32_t MaxFramesInFlight = 3;
+
+		// Packets the main thread may have queued ahead of the one being presented
+		uint32_t FramesInFlight = 2;
+	};
+
+	struct RenderThreadStats
+	{
+		uint64_t FramesPresented;
+		float LastLatencyMs;		// frame start on the main thread to swap on the render thread
+		float AverageLatencyMs;
+		float LastWaitMs;			// main thread blocked on a free packet
+	};
+
+	// Owns the graphics context and presents frame packets produced by the main thread, so
+	// simulation of frame N + 1 overlaps submission of frame N.
+	class RenderThread
+	{
+	public:
+		RenderThread(Window& window, RendererBackend& backend, ImGuiLayer* ui, const RenderThreadProps& props = RenderThreadProps());
+		~RenderThread();
+
+		// Moves the graphics context from the calling thread to the render thread and back
+		void Start();
+		void Stop();
+
+		// Blocks while all packets are in flight
+		FramePacket& BeginPacket();
+		void SubmitPacket();
+
+		// Blocks until every submitted packet was presented
+		void WaitIdle();
+
+		inline bool IsRunning() const { return m_Running; }
+		RenderThreadStats GetStats();
+	private:
+		void Main();
+	private:
+		Window& m_Window;
+		RendererBackend& m_Backend;
+		ImGuiLayer* m_UI;
+		RenderThreadProps m_Props;
+
+		std::thread m_Thread;
+		bool m_Running = false;
+		bool m_StopRequested = false;
+
+		// Ring of packets: [m_ReadIndex, m_ReadIndex + m_Pending) are queued or being presented
+		std::vector<std::unique_ptr<FramePacket>> m_Packets;
+		uint32_t m_WriteIndex = 0;
+		uint32_t m_ReadIndex = 0;
+		uint32_t m_Pending = 0;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_PacketReady;
+		std::condition_variable m_PacketFree;
+
+		RenderThreadStats m_Stats = {};
+	};
+}
\ No newline at end of file
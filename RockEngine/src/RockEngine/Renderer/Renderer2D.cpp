@@ -0,0 +1,125 @@
+#include "pch.h"
+#include "Renderer2D.h"
+
+#include "RockEngine/Renderer/RendererAPI.h"
+
+namespace RockEngine
+{
+	struct Renderer2DData
+	{
+		QuadBatcher Batcher;
+		QuadBatchData Frames[Renderer2D::FrameSlots];
+		uint32_t Frame = 0;
+
+		bool InScene = false;
+		float ViewProjection[16];
+		uint32_t Pass = 0;
+		uint32_t SceneBatches = 0;		// this frame, keeps scenes in submission order
+		std::vector<QuadInstance> Quads;
+		std::vector<DrawQuadsCommand> Commands;
+
+		Renderer2DStats Stats;
+		Renderer2DStats LastFrameStats;
+	};
+
+	static std::unique_ptr<Renderer2DData> s_Data;
+
+	void Renderer2D::Init()
+	{
+		s_Data = std::make_unique<Renderer2DData>();
+		RendererAPI::GetBackend().SetQuadBatchSource(s_Data->Frames, FrameSlots);
+
+		RE_CORE_INFO("Renderer2D: {} kernel", QuadBatcher::GetKernelName(s_Data->Batcher.GetKernel()));
+	}
+
+	void Renderer2D::Shutdown()
+	{
+		RendererAPI::GetBackend().SetQuadBatchSource(nullptr, 0);
+		s_Data.reset();
+	}
+
+	void Renderer2D::BeginFrame()
+	{
+		RE_CORE_ASSERT(!s_Data->InScene, "Renderer2D: frame ended inside a scene");
+
+		// The slot was last used FrameSlots frames ago, that frame has been presented by now
+		s_Data->Frame = (s_Data->Frame + 1) % FrameSlots;
+		QuadBatchData& frame = s_Data->Frames[s_Data->Frame];
+		frame.Vertices.clear();
+		frame.Textures.clear();
+
+		s_Data->SceneBatches = 0;
+		s_Data->LastFrameStats = s_Data->Stats;
+		s_Data->Stats = Renderer2DStats();
+	}
+
+	void Renderer2D::BeginScene(const float viewProjection[16], uint32_t pass /* = 0 */)
+	{
+		RE_CORE_ASSERT(!s_Data->InScene, "Renderer2D: BeginScene without EndScene");
+		s_Data->InScene = true;
+		std::copy(viewProjection, viewProjection + 16, s_Data->ViewProjection);
+		s_Data->Pass = pass;
+		s_Data->Quads.clear();
+	}
+
+	void Renderer2D::EndScene()
+	{
+		RE_PROFILE_FUNC();
+		RE_CORE_ASSERT(s_Data->InScene, "Renderer2D: EndScene without BeginScene");
+		s_Data->InScene = false;
+
+		QuadBatcher& batcher = s_Data->Batcher;
+		QuadBatcherStats before = batcher.GetStats();
+		s_Data->Commands.clear();
+		batcher.Build(s_Data->Quads.data(), (uint32_t)s_Data->Quads.size(), s_Data->ViewProjection, s_Data->Frame,
+			s_Data->Frames[s_Data->Frame], s_Data->Commands);
+
+		// Highest shader bits put 2D after the pass's 3D draws, the batch counter keeps order
+		for (const DrawQuadsCommand& command : s_Data->Commands)
+			RendererAPI::Submit(RenderSortKey::Make(s_Data->Pass, RenderSortKey::Mask(RenderSortKey::ShaderBits), s_Data->SceneBatches++, 0), command);
+
+		const QuadBatcherStats& after = batcher.GetStats();
+		Renderer2DStats& stats = s_Data->Stats;
+		stats.Scenes++;
+		stats.DrawCalls += (uint32_t)(after.Batches - before.Batches);
+		stats.Quads += (uint32_t)(after.Quads - before.Quads);
+		stats.TextureSplits += (uint32_t)(after.TextureSplits - before.TextureSplits);
+		stats.CapacitySplits += (uint32_t)(after.CapacitySplits - before.CapacitySplits);
+	}
+
+	void Renderer2D::DrawQuad(const QuadInstance& quad)
+	{
+		RE_CORE_ASSERT(s_Data->InScene, "Renderer2D: DrawQuad outside of a scene");
+		s_Data->Quads.push_back(quad);
+	}
+
+	void Renderer2D::DrawQuad(float x, float y, float width, float height, uint32_t color, uint32_t texture /* = 0 */)
+	{
+		DrawQuad({ { x, y, 0.0f }, 0.0f, { width, height }, { 0.0f, 0.0f, 1.0f, 1.0f }, color, texture });
+	}
+
+	void Renderer2D::DrawRotatedQuad(float x, float y, float width, float height, float rotation, uint32_t color, uint32_t texture /* = 0 */)
+	{
+		DrawQuad({ { x, y, 0.0f }, rotation, { width, height }, { 0.0f, 0.0f, 1.0f, 1.0f }, color, texture });
+	}
+
+	void Renderer2D::SetKernel(QuadKernel kernel)
+	{
+		s_Data->Batcher.SetKernel(kernel);
+	}
+
+	QuadKernel Renderer2D::GetKernel()
+	{
+		return s_Data->Batcher.GetKernel();
+	}
+
+	const Renderer2DStats& Renderer2D::GetStats()
+	{
+		return s_Data->Stats;
+	}
+
+	const Renderer2DStats& Renderer2D::GetLastFrameStats()
+	{
+		return s_Data->LastFrameStats;
+	}
+}
\ No newline at end of file
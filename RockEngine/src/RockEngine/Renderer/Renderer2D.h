@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+#include "RockEngine/Renderer/QuadBatcher.h"
+#include "RockEngine/Renderer/RenderThread.h"
+
+namespace RockEngine
+{
+	struct Renderer2DStats
+	{
+		uint32_t Scenes = 0;
+		uint32_t DrawCalls = 0;			// one per batch
+		uint32_t Quads = 0;
+		uint32_t TextureSplits = 0;		// batches closed because the texture table was full
+		uint32_t CapacitySplits = 0;
+
+		uint32_t GetVertexCount() const { return Quads * 4; }
+		uint32_t GetIndexCount() const { return Quads * 6; }
+	};
+
+	// Batched quads on top of RendererAPI. Quads keep their submission order (2D is usually
+	// blended), consecutive quads share a draw call as long as their textures fit the table.
+	// Not thread safe: layers drawing 2D should declare a write to "Renderer2D".
+	class Renderer2D
+	{
+	public:
+		// Frames whose vertices are kept alive, one more than the render thread can queue
+		static constexpr uint32_t FrameSlots = RenderThreadProps::MaxFramesInFlight + 2;
+
+		static void Init();
+		static void Shutdown();
+
+		// Called by Application::Run at the start of every frame
+		static void BeginFrame();
+
+		// viewProjection is column-major. The scene's batches draw after the pass's 3D draws.
+		static void BeginScene(const float viewProjection[16], uint32_t pass = 0);
+		static void EndScene();
+
+		static void DrawQuad(const QuadInstance& quad);
+		static void DrawQuad(float x, float y, float width, float height, uint32_t color, uint32_t texture = 0);
+		static void DrawRotatedQuad(float x, float y, float width, float height, float rotation, uint32_t color, uint32_t texture = 0);
+
+		static void SetKernel(QuadKernel kernel);
+		static QuadKernel GetKernel();
+
+		// Current frame so far / last finished frame
+		static const Renderer2DStats& GetStats();
+		static const Renderer2DStats& GetLastFrameStats();
+	};
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include "pch.h"
+#include "RendererAPI.h"
+
+#include "RockEngine/Platform/OpenGL/OpenGLRendererBackend.h"
+#include "RockEngine/Platform/Null/NullRendererBackend.h"
+#include "RockEngine/Platform/Software/SoftwareRendererBackend.h"
+
+namespace RockEngine
+{
+	RendererAPIType RendererAPI::s_Type = RendererAPIType::Null;
+	std::unique_ptr<RendererBackend> RendererAPI::s_Backend;
+	RenderQueue RendererAPI::s_Queue;
+
+	void RendererAPI::Init(RendererAPIType type)
+	{
+		switch (type)
+		{
+			case RendererAPIType::OpenGL:   s_Backend = std::make_unique<OpenGLRendererBackend>(); break;
+			case RendererAPIType::Null:     s_Backend = std::make_unique<NullRendererBackend>(); break;
+			case RendererAPIType::Software: s_Backend = std::make_unique<SoftwareRendererBackend>(); break;
+		}
+		s_Type = type;
+		s_Backend->Init();
+		s_Queue.Init();
+
+		static const char* s_Names[] = { "Null", "OpenGL", "Software" };
+		RE_CORE_INFO("RendererAPI: {}", s_Names[(int)type]);
+	}
+
+	void RendererAPI::Shutdown()
+	{
+		if (s_Backend)
+			s_Backend->Shutdown();
+		s_Backend.reset();
+		s_Queue.Reset();
+	}
+
+	void RendererAPI::Flush()
+	{
+		s_Queue.Sort();
+		s_Queue.Execute(*s_Backend);
+		s_Queue.Reset();
+	}
+
+	void RendererAPI::Flush(std::vector<RenderCommand>& commands)
+	{
+		s_Queue.Sort();
+		s_Queue.TakeSorted(commands);
+		s_Queue.Reset();
+	}
+}
\ No newline at end of file
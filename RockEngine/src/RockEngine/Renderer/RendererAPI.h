@@ -1,11 +1,41 @@
 #pragma once
 
+#include <memory>
+
+#include "RockEngine/Renderer/RendererBackend.h"
+#include "RockEngine/Renderer/RenderQueue.h"
+
 namespace RockEngine
 {
+	// Front-end over the active backend. Calls record commands into the render queue
+	// (from any thread), Flush() sorts them and executes them on the backend.
 	class RendererAPI
 	{
 	public:
-		static void Clear(float r, float g, float b, float a);
-		static void SetClearColor(float r, float g, float b, float a);
+		static void Init(RendererAPIType type);
+		static void Shutdown();
+
+		static void Submit(uint64_t key, const RenderCommand& command) { s_Queue.Submit(key, command); }
+
+		template<typename T>
+		static void Submit(uint64_t key, const T& payload) { s_Queue.Submit(key, payload); }
+
+		// Clears and state changes sort to the front of their pass
+		static void Clear(float r, float g, float b, float a, uint32_t pass = 0) { Submit(RenderSortKey::Make(pass, 0, 0, 0), ClearCommand{ { r, g, b, a } }); }
+		static void SetClearColor(float r, float g, float b, float a, uint32_t pass = 0) { Submit(RenderSortKey::Make(pass, 0, 0, 0), SetClearColorCommand{ { r, g, b, a } }); }
+		static void SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t pass = 0) { Submit(RenderSortKey::Make(pass, 0, 0, 0), SetViewportCommand{ x, y, width, height }); }
+
+		// Sorts and executes everything recorded since the last flush. Main thread only.
+		static void Flush();
+		// Render thread mode: sorts, but hands the stream over instead of executing it
+		static void Flush(std::vector<RenderCommand>& commands);
+
+		inline static RendererAPIType GetType() { return s_Type; }
+		inline static RendererBackend& GetBackend() { return *s_Backend; }
+		inline static RenderQueue& GetQueue() { return s_Queue; }
+	private:
+		static RendererAPIType s_Type;
+		static std::unique_ptr<RendererBackend> s_Backend;
+		static RenderQueue s_Queue;
 	};
 }
\ No newline at end of file
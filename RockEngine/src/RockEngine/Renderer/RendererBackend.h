@@ -0,0 +1,35 @@
+#pragma once
+
+#include "RockEngine/Renderer/RenderCommand.h"
+
+namespace RockEngine
+{
+	enum class RendererAPIType
+	{
+		Null = 0,
+		OpenGL,
+		Software
+	};
+
+	class RendererBackend
+	{
+	public:
+		virtual ~RendererBackend() {}
+
+		virtual void Init() {}
+		virtual void Shutdown() {}
+		// Size of the surface drawn to. GPU backends draw to the window's and ignore it.
+		virtual void Resize(uint32_t /*width*/, uint32_t /*height*/) {}
+
+		// Runs a sorted command stream, always from the thread that owns the graphics context
+		virtual void Execute(const RenderCommand* commands, uint32_t count) = 0;
+
+		// Frame slots DrawQuads commands index into, owned by Renderer2D
+		void SetQuadBatchSource(const QuadBatchData* frames, uint32_t count) { m_QuadFrames = frames; m_QuadFrameCount = count; }
+		inline const QuadBatchData* GetQuadFrames() const { return m_QuadFrames; }
+		inline uint32_t GetQuadFrameCount() const { return m_QuadFrameCount; }
+	protected:
+		const QuadBatchData* m_QuadFrames = nullptr;
+		uint32_t m_QuadFrameCount = 0;
+	};
+}
\ No newline at end of file
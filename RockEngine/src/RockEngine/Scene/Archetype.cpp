@@ -0,0 +1,174 @@
+#include "pch.h"
+#include "Archetype.h"
+
+#include <cstring>
+
+#include "RockEngine/Memory/LinearAllocator.h"
+
+namespace RockEngine
+{
+	static constexpr size_t s_ChunkAlignment = 64;
+
+	static size_t ChunkLayoutSize(const std::vector<ComponentID>& components, uint32_t capacity)
+	{
+		size_t size = sizeof(Entity) * capacity;
+		for (ComponentID id : components)
+		{
+			const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+			size = AlignUp(size, info.Alignment) + (size_t)info.Size * capacity;
+		}
+		return size;
+	}
+
+	Archetype::Archetype(ComponentMask mask)
+		: m_Mask(mask)
+	{
+		uint32_t rowSize = sizeof(Entity);
+		for (ComponentID id = 0; id < ComponentRegistry::MaxComponents; id++)
+		{
+			if (!Has(id))
+				continue;
+			m_Components.push_back(id);
+
+			const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+			rowSize += info.Size;
+			m_Trivial &= !info.MoveConstruct;
+		}
+
+		// Largest capacity whose columns, padded for alignment, still fit the chunk
+		m_ChunkCapacity = std::max(1u, ChunkSize / rowSize);
+		while (m_ChunkCapacity > 1 && ChunkLayoutSize(m_Components, m_ChunkCapacity) > ChunkSize)
+			m_ChunkCapacity--;
+
+		size_t offset = sizeof(Entity) * m_ChunkCapacity;
+		for (ComponentID id : m_Components)
+		{
+			const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+			offset = AlignUp(offset, info.Alignment);
+			m_ColumnOffsets[id] = (uint32_t)offset;
+			offset += (size_t)info.Size * m_ChunkCapacity;
+		}
+	}
+
+	Archetype::~Archetype()
+	{
+		if (!m_Trivial)
+		{
+			for (uint32_t row = 0; row < m_Count; row++)
+				DestroyComponents(row);
+		}
+
+		for (uint8_t* chunk : m_Chunks)
+			::operator delete(chunk, std::align_val_t(s_ChunkAlignment));
+	}
+
+	uint32_t Archetype::Allocate(Entity entity)
+	{
+		uint32_t row = m_Count++;
+		if (row / m_ChunkCapacity == m_Chunks.size())
+		{
+			size_t size = std::max((size_t)ChunkSize, ChunkLayoutSize(m_Components, m_ChunkCapacity));
+			m_Chunks.push_back(static_cast<uint8_t*>(::operator new(size, std::align_val_t(s_ChunkAlignment))));
+		}
+
+		GetEntities(row / m_ChunkCapacity)[row % m_ChunkCapacity] = entity;
+		return row;
+	}
+
+	uint32_t Archetype::AllocateRange(const Entity* entities, uint32_t count)
+	{
+		uint32_t first = m_Count;
+		m_Count += count;
+
+		size_t size = std::max((size_t)ChunkSize, ChunkLayoutSize(m_Components, m_ChunkCapacity));
+		while ((size_t)m_Count > m_Chunks.size() * m_ChunkCapacity)
+			m_Chunks.push_back(static_cast<uint8_t*>(::operator new(size, std::align_val_t(s_ChunkAlignment))));
+
+		for (uint32_t done = 0; done < count;)
+		{
+			uint32_t row = first + done;
+			uint32_t rows = std::min(count - done, m_ChunkCapacity - row % m_ChunkCapacity);
+			std::memcpy(GetEntities(row / m_ChunkCapacity) + row % m_ChunkCapacity, entities + done, rows * sizeof(Entity));
+			done += rows;
+		}
+		return first;
+	}
+
+	Entity Archetype::Remove(uint32_t row)
+	{
+		DestroyComponents(row);
+		return RemoveMoved(row);
+	}
+
+	Entity Archetype::RemoveMoved(uint32_t row)
+	{
+		uint32_t last = --m_Count;
+		Entity moved;
+		if (row != last)
+		{
+			MoveComponents(last, row);
+			moved = GetEntity(last);
+			GetEntities(row / m_ChunkCapacity)[row % m_ChunkCapacity] = moved;
+		}
+
+		// Keep one spare chunk around so an entity bouncing across a chunk boundary doesn't thrash
+		size_t needed = (m_Count + m_ChunkCapacity - 1) / m_ChunkCapacity;
+		if (m_Chunks.size() > needed + 1)
+		{
+			::operator delete(m_Chunks.back(), std::align_val_t(s_ChunkAlignment));
+			m_Chunks.pop_back();
+		}
+		return moved;
+	}
+
+	void Archetype::MoveRow(uint32_t row, Archetype& target, uint32_t targetRow)
+	{
+		for (ComponentID id : m_Components)
+		{
+			const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+			void* source = GetComponent(row, id);
+			if (target.Has(id))
+			{
+				void* destination = target.GetComponent(targetRow, id);
+				if (info.MoveConstruct)
+					info.MoveConstruct(destination, source);
+				else
+					std::memcpy(destination, source, info.Size);
+			}
+			if (info.Destroy)
+				info.Destroy(source);
+		}
+	}
+
+	void Archetype::MoveComponents(uint32_t fromRow, uint32_t toRow)
+	{
+		for (ComponentID id : m_Components)
+		{
+			const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+			void* source = GetComponent(fromRow, id);
+			void* destination = GetComponent(toRow, id);
+			if (info.MoveConstruct)
+			{
+				info.MoveConstruct(destination, source);
+				info.Destroy(source);
+			}
+			else
+			{
+				std::memcpy(destination, source, info.Size);
+			}
+		}
+	}
+
+	void Archetype::DestroyComponents(uint32_t row)
+	{
+		if (m_Trivial)
+			return;
+
+		for (ComponentID id : m_Components)
+		{
+			const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+			if (info.Destroy)
+				info.Destroy(GetComponent(row, id));
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "RockEngine/Scene/Component.h"
+#include "RockEngine/Scene/Entity.h"
+
+namespace RockEngine
+{
+	// All entities with exactly one set of components. They live in fixed-size chunks, each
+	// chunk holding one array (column) per component plus the entity handles:
+	//   | Entity[capacity] | A[capacity] | B[capacity] | ...
+	// Rows are dense: every chunk but the last is full, removal swaps the last row in.
+	class Archetype
+	{
+	public:
+		static constexpr uint32_t ChunkSize = 16 * 1024;
+
+		Archetype(ComponentMask mask);
+		~Archetype();
+
+		Archetype(const Archetype&) = delete;
+		Archetype& operator=(const Archetype&) = delete;
+
+		// Appends a row with uninitialized components
+		uint32_t Allocate(Entity entity);
+		// Appends `count` rows at once, returns the first
+		uint32_t AllocateRange(const Entity* entities, uint32_t count);
+		// Destroys the row's components and fills the hole with the last row.
+		// Returns the entity that moved into `row`, or a null entity if `row` was the last.
+		Entity Remove(uint32_t row);
+		// Same, for rows whose components were already moved out
+		Entity RemoveMoved(uint32_t row);
+
+		// Moves the row's components into a row of `target`, destroying those target doesn't have
+		void MoveRow(uint32_t row, Archetype& target, uint32_t targetRow);
+
+		inline ComponentMask GetMask() const { return m_Mask; }
+		inline const std::vector<ComponentID>& GetComponents() const { return m_Components; }
+		inline bool Has(ComponentID id) const { return (m_Mask >> id) & 1; }
+
+		inline uint32_t GetEntityCount() const { return m_Count; }
+		inline uint32_t GetChunkCapacity() const { return m_ChunkCapacity; }
+		inline uint32_t GetChunkCount() const { return (uint32_t)m_Chunks.size(); }
+		inline uint32_t GetChunkEntityCount(uint32_t chunk) const
+		{
+			// The spare chunk kept after removals is empty
+			uint32_t first = chunk * m_ChunkCapacity;
+			return m_Count <= first ? 0 : std::min(m_Count - first, m_ChunkCapacity);
+		}
+
+		inline Entity* GetEntities(uint32_t chunk) { return reinterpret_cast<Entity*>(m_Chunks[chunk]); }
+		inline Entity GetEntity(uint32_t row) const { return reinterpret_cast<const Entity*>(m_Chunks[row / m_ChunkCapacity])[row % m_ChunkCapacity]; }
+
+		// Start of a component's column in a chunk, the archetype must have the component
+		inline void* GetColumn(uint32_t chunk, ComponentID id) { return m_Chunks[chunk] + m_ColumnOffsets[id]; }
+		inline void* GetComponent(uint32_t row, ComponentID id)
+		{
+			return m_Chunks[row / m_ChunkCapacity] + m_ColumnOffsets[id] + (size_t)(row % m_ChunkCapacity) * ComponentRegistry::GetInfo(id).Size;
+		}
+
+		template<typename T>
+		inline T* GetColumn(uint32_t chunk) { return static_cast<T*>(GetColumn(chunk, ComponentRegistry::GetID<T>())); }
+
+		// Archetypes one component away, filled in by the scene as transitions happen
+		std::array<Archetype*, ComponentRegistry::MaxComponents> AddEdges = {};
+		std::array<Archetype*, ComponentRegistry::MaxComponents> RemoveEdges = {};
+	private:
+		void MoveComponents(uint32_t fromRow, uint32_t toRow);
+		void DestroyComponents(uint32_t row);
+	private:
+		ComponentMask m_Mask;
+		std::vector<ComponentID> m_Components;
+		std::array<uint32_t, ComponentRegistry::MaxComponents> m_ColumnOffsets = {};
+		uint32_t m_ChunkCapacity = 0;
+		bool m_Trivial = true;
+
+		std::vector<uint8_t*> m_Chunks;
+		uint32_t m_Count = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+namespace RockEngine
+{
+	using ComponentID = uint32_t;
+	using ComponentMask = uint64_t;
+
+	// How the scene moves and destroys a component it only knows by id. Trivially copyable
+	// components leave the function pointers null and are moved with memcpy.
+	struct ComponentInfo
+	{
+		const char* Name;
+		uint32_t Size;
+		uint32_t Alignment;
+		void (*MoveConstruct)(void* destination, void* source);
+		void (*Destroy)(void* component);
+	};
+
+	class ComponentRegistry
+	{
+	public:
+		static constexpr uint32_t MaxComponents = 64;
+
+		// Ids are handed out on first use and are the same for every scene
+		template<typename T>
+		static ComponentID GetID()
+		{
+			static const ComponentID id = Register(MakeInfo<T>());
+			return id;
+		}
+
+		static const ComponentInfo& GetInfo(ComponentID id);
+		static uint32_t GetCount();
+	private:
+		template<typename T>
+		static ComponentInfo MakeInfo()
+		{
+			static_assert(std::is_default_constructible_v<T> && std::is_move_constructible_v<T>, "Components need a default and a move constructor");
+			static_assert(alignof(T) <= 64, "Components are at most cache line aligned");
+
+			ComponentInfo info = { typeid(T).name(), (uint32_t)sizeof(T), (uint32_t)alignof(T), nullptr, nullptr };
+			if constexpr (!std::is_trivially_copyable_v<T>)
+			{
+				info.MoveConstruct = [](void* destination, void* source) { new (destination) T(std::move(*static_cast<T*>(source))); };
+				info.Destroy = [](void* component) { static_cast<T*>(component)->~T(); };
+			}
+			return info;
+		}
+
+		static ComponentID Register(const ComponentInfo& info);
+	};
+
+	template<typename... Ts>
+	inline ComponentMask MakeComponentMask()
+	{
+		return (ComponentMask(0) | ... | (ComponentMask(1) << ComponentRegistry::GetID<Ts>()));
+	}
+
+	// Exclusion filter for Scene::Each and friends, e.g. scene.Each<Position>(func, Without<Frozen>())
+	template<typename... Ts>
+	inline ComponentMask Without()
+	{
+		return MakeComponentMask<Ts...>();
+	}
+}
\ No newline at end of file
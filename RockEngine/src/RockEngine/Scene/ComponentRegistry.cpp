@@ -0,0 +1,35 @@
+#include "pch.h"
+#include "Component.h"
+
+#include <atomic>
+
+namespace RockEngine
+{
+	static ComponentInfo s_Components[ComponentRegistry::MaxComponents];
+	static std::atomic<uint32_t> s_ComponentCount{ 0 };
+
+	ComponentID ComponentRegistry::Register(const ComponentInfo& info)
+	{
+		// Called once per type from the function-local static in GetID, which serializes per type only
+		ComponentID id = s_ComponentCount.fetch_add(1, std::memory_order_relaxed);
+		RE_CORE_ASSERT(id < MaxComponents, "Too many component types");
+		if (id >= MaxComponents)
+		{
+			RE_CORE_ERROR("ComponentRegistry: more than {} component types, {} aliases the last one", MaxComponents, info.Name);
+			return MaxComponents - 1;
+		}
+
+		s_Components[id] = info;
+		return id;
+	}
+
+	const ComponentInfo& ComponentRegistry::GetInfo(ComponentID id)
+	{
+		return s_Components[id];
+	}
+
+	uint32_t ComponentRegistry::GetCount()
+	{
+		return std::min(s_ComponentCount.load(std::memory_order_relaxed), MaxComponents);
+	}
+}
\ No newline at end of file
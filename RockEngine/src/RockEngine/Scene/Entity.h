@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace RockEngine
+{
+	// Index into the scene's entity table plus the generation of that slot, so handles to
+	// destroyed entities stop resolving once the slot is reused
+	struct Entity
+	{
+		uint32_t Index = ~0u;
+		uint32_t Generation = 0;
+
+		inline bool IsNull() const { return Index == ~0u; }
+
+		inline bool operator==(const Entity& other) const { return Index == other.Index && Generation == other.Generation; }
+		inline bool operator!=(const Entity& other) const { return !(*this == other); }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "pch.h"
+#include "EntityCommandBuffer.h"
+
+#include <cstring>
+
+#include "RockEngine/Memory/LinearAllocator.h"
+#include "RockEngine/Scene/Scene.h"
+
+namespace RockEngine
+{
+	EntityCommandBuffer::EntityCommandBuffer(Scene& scene)
+		: m_Scene(scene)
+	{
+	}
+
+	EntityCommandBuffer::~EntityCommandBuffer()
+	{
+		Reset();
+	}
+
+	Entity EntityCommandBuffer::Create()
+	{
+		return m_Scene.ReserveEntity();
+	}
+
+	void EntityCommandBuffer::Destroy(Entity entity)
+	{
+		m_Commands.push_back({ Operation::Destroy, 0, entity, nullptr });
+	}
+
+	void* EntityCommandBuffer::AllocatePayload(size_t size, size_t alignment)
+	{
+		for (; m_Block < m_Blocks.size(); m_Block++, m_BlockOffset = 0)
+		{
+			uintptr_t base = (uintptr_t)m_Blocks[m_Block].get();
+			size_t offset = AlignUp(base + m_BlockOffset, alignment) - base;
+			if (offset + size <= m_BlockSizes[m_Block])
+			{
+				m_BlockOffset = offset + size;
+				return m_Blocks[m_Block].get() + offset;
+			}
+		}
+
+		// Nothing left to reuse (or the payload is larger than a block)
+		size_t blockSize = std::max(BlockSize, size + alignment);
+		m_Blocks.push_back(std::unique_ptr<uint8_t[]>(new uint8_t[blockSize]));
+		m_BlockSizes.push_back(blockSize);
+
+		uintptr_t base = (uintptr_t)m_Blocks.back().get();
+		size_t offset = AlignUp(base, alignment) - base;
+		m_BlockOffset = offset + size;
+		return m_Blocks.back().get() + offset;
+	}
+
+	void EntityCommandBuffer::Playback()
+	{
+		if (m_Commands.empty())
+			return;
+
+		RE_PROFILE_FUNC();
+		m_Scene.AssertNotIterating();
+		m_Scene.FlushReservedEntities();
+
+		for (Command& command : m_Commands)
+		{
+			switch (command.Op)
+			{
+				case Operation::Destroy:
+					m_Scene.DestroyEntity(command.Target);
+					break;
+				case Operation::Add:
+				{
+					const ComponentInfo& info = ComponentRegistry::GetInfo(command.Component);
+					if (m_Scene.IsAlive(command.Target))
+					{
+						bool existed;
+						void* storage = m_Scene.AddComponent(command.Target, command.Component, existed);
+						if (existed && info.Destroy)
+							info.Destroy(storage);
+						if (info.MoveConstruct)
+							info.MoveConstruct(storage, command.Payload);
+						else
+							std::memcpy(storage, command.Payload, info.Size);
+					}
+					if (info.Destroy)
+						info.Destroy(command.Payload);
+					command.Payload = nullptr;
+					break;
+				}
+				case Operation::Remove:
+					m_Scene.RemoveComponent(command.Target, command.Component);
+					break;
+			}
+		}
+
+		m_Commands.clear();
+		m_Block = 0;
+		m_BlockOffset = 0;
+	}
+
+	void EntityCommandBuffer::Reset()
+	{
+		for (const Command& command : m_Commands)
+		{
+			if (command.Op != Operation::Add || !command.Payload)
+				continue;
+			const ComponentInfo& info = ComponentRegistry::GetInfo(command.Component);
+			if (info.Destroy)
+				info.Destroy(command.Payload);
+		}
+
+		m_Commands.clear();
+		m_Block = 0;
+		m_BlockOffset = 0;
+	}
+}
\ No newline at end of file
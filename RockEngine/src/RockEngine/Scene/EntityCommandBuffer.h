@@ -0,0 +1,81 @@
+#pragma once
+
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "RockEngine/Scene/Component.h"
+#include "RockEngine/Scene/Entity.h"
+
+namespace RockEngine
+{
+	class Scene;
+
+	// Structural changes recorded while the scene is being iterated (or from jobs), applied in
+	// record order by Playback(). One buffer per thread, see Scene::GetCommandBuffer.
+	class EntityCommandBuffer
+	{
+	public:
+		EntityCommandBuffer(Scene& scene);
+		~EntityCommandBuffer();
+
+		EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+		EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+
+		// The handle can be used in later commands right away, the entity exists after the next
+		// playback of any buffer of the scene
+		Entity Create();
+		void Destroy(Entity entity);
+
+		// Adding a component the entity already has replaces it
+		template<typename T>
+		void Add(Entity entity, T component = T())
+		{
+			ComponentID id = ComponentRegistry::GetID<T>();
+			void* payload = AllocatePayload(sizeof(T), alignof(T));
+			new (payload) T(std::move(component));
+			m_Commands.push_back({ Operation::Add, id, entity, payload });
+		}
+
+		template<typename T>
+		void Remove(Entity entity)
+		{
+			m_Commands.push_back({ Operation::Remove, ComponentRegistry::GetID<T>(), entity, nullptr });
+		}
+
+		void Playback();
+		// Drops everything recorded without applying it
+		void Reset();
+
+		inline bool IsEmpty() const { return m_Commands.empty(); }
+		inline uint32_t GetCommandCount() const { return (uint32_t)m_Commands.size(); }
+	private:
+		enum class Operation : uint8_t
+		{
+			Destroy, Add, Remove
+		};
+
+		struct Command
+		{
+			Operation Op;
+			ComponentID Component;
+			Entity Target;
+			void* Payload;
+		};
+
+		void* AllocatePayload(size_t size, size_t alignment);
+	private:
+		static constexpr size_t BlockSize = 16 * 1024;
+
+		Scene& m_Scene;
+		std::vector<Command> m_Commands;
+
+		// Payloads never move once written (components may not be trivially relocatable), so
+		// they go to fixed blocks that are reused after every playback
+		std::vector<std::unique_ptr<uint8_t[]>> m_Blocks;
+		std::vector<size_t> m_BlockSizes;
+		uint32_t m_Block = 0;
+		size_t m_BlockOffset = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+namespace RockEngine
+{
+	// Pointer stored as the distance from its own address, so a block of data containing them
+	// works wherever it's loaded or mapped, without fixups. Only meaningful in place: never copy
+	// one out of the block it points into.
+	template<typename T>
+	struct RelativePtr
+	{
+		int64_t Offset = 0;		// 0 is null
+
+		inline const T* Get() const
+		{
+			return Offset ? reinterpret_cast<const T*>(reinterpret_cast<const uint8_t*>(this) + Offset) : nullptr;
+		}
+
+		inline const T* operator->() const { return Get(); }
+		inline const T& operator*() const { return *Get(); }
+		inline explicit operator bool() const { return Offset != 0; }
+	};
+
+	template<typename T>
+	struct RelativeArray
+	{
+		int64_t Offset = 0;
+		uint64_t Count = 0;
+
+		inline const T* Data() const { return reinterpret_cast<const T*>(reinterpret_cast<const uint8_t*>(this) + Offset); }
+		inline uint64_t Size() const { return Count; }
+		inline bool Empty() const { return Count == 0; }
+
+		inline const T& operator[](uint64_t index) const { return Data()[index]; }
+		inline const T* begin() const { return Data(); }
+		inline const T* end() const { return Data() + Count; }
+	};
+}
\ No newline at end of file
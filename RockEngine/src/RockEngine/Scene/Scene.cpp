@@ -0,0 +1,212 @@
+#include "pch.h"
+#include "Scene.h"
+
+namespace RockEngine
+{
+	Scene::Scene()
+	{
+		m_EmptyArchetype = GetArchetype(0);
+
+		for (uint32_t i = 0; i < std::max(1u, JobSystem::GetWorkerCount()); i++)
+			m_CommandBuffers.push_back(std::make_unique<EntityCommandBuffer>(*this));
+	}
+
+	Scene::~Scene()
+	{
+		// Unplayed payloads are destroyed before the archetypes
+		m_CommandBuffers.clear();
+	}
+
+	Archetype* Scene::GetArchetype(ComponentMask mask)
+	{
+		auto it = m_ArchetypeLookup.find(mask);
+		if (it != m_ArchetypeLookup.end())
+			return it->second;
+
+		m_Archetypes.push_back(std::make_unique<Archetype>(mask));
+		Archetype* archetype = m_Archetypes.back().get();
+		m_ArchetypeLookup[mask] = archetype;
+		return archetype;
+	}
+
+	const std::vector<Archetype*>& Scene::GetQuery(ComponentMask include, ComponentMask exclude)
+	{
+		std::lock_guard<std::mutex> lock(m_QueryMutex);
+
+		QueryCache* query = nullptr;
+		for (const std::unique_ptr<QueryCache>& cache : m_Queries)
+		{
+			if (cache->Include == include && cache->Exclude == exclude)
+			{
+				query = cache.get();
+				break;
+			}
+		}
+		if (!query)
+		{
+			m_Queries.push_back(std::make_unique<QueryCache>());
+			query = m_Queries.back().get();
+			query->Include = include;
+			query->Exclude = exclude;
+		}
+
+		// Archetypes are never destroyed, so only the ones created since the last lookup need checking
+		for (; query->CheckedArchetypes < m_Archetypes.size(); query->CheckedArchetypes++)
+		{
+			Archetype* archetype = m_Archetypes[query->CheckedArchetypes].get();
+			ComponentMask mask = archetype->GetMask();
+			if ((mask & include) == include && (mask & exclude) == 0)
+				query->Archetypes.push_back(archetype);
+		}
+		return query->Archetypes;
+	}
+
+	Entity Scene::CreateEntity()
+	{
+		return AllocateEntity(m_EmptyArchetype);
+	}
+
+	Entity Scene::AllocateEntity(Archetype* archetype)
+	{
+		AssertNotIterating();
+		FlushReservedEntities();
+
+		uint32_t index;
+		if (!m_FreeIndices.empty())
+		{
+			index = m_FreeIndices.back();
+			m_FreeIndices.pop_back();
+		}
+		else
+		{
+			// ReserveEntity may have run on another thread since the flush above, the indices
+			// it handed out in between come before this one
+			index = m_ReservedEnd.fetch_add(1, std::memory_order_relaxed);
+			CreateReservedEntities(index);
+			m_Records.emplace_back();
+		}
+
+		EntityRecord& record = m_Records[index];
+		Entity entity = { index, record.Generation };
+		record.Owner = archetype;
+		record.Row = archetype->Allocate(entity);
+		m_EntityCount++;
+		return entity;
+	}
+
+	Entity Scene::ReserveEntity()
+	{
+		return { m_ReservedEnd.fetch_add(1, std::memory_order_relaxed), 0 };
+	}
+
+	void Scene::FlushReservedEntities()
+	{
+		CreateReservedEntities(m_ReservedEnd.load(std::memory_order_relaxed));
+	}
+
+	void Scene::CreateReservedEntities(uint32_t end)
+	{
+		for (uint32_t index = (uint32_t)m_Records.size(); index < end; index++)
+		{
+			EntityRecord record;
+			record.Owner = m_EmptyArchetype;
+			record.Row = m_EmptyArchetype->Allocate({ index, 0 });
+			m_Records.push_back(record);
+			m_EntityCount++;
+		}
+	}
+
+	void Scene::DestroyEntity(Entity entity)
+	{
+		AssertNotIterating();
+		if (!IsAlive(entity))
+			return;
+
+		EntityRecord& record = m_Records[entity.Index];
+		Entity moved = record.Owner->Remove(record.Row);
+		UpdateMovedEntity(moved, record.Row);
+
+		record.Owner = nullptr;
+		record.Generation++;
+		m_FreeIndices.push_back(entity.Index);
+		m_EntityCount--;
+	}
+
+	bool Scene::IsAlive(Entity entity) const
+	{
+		return entity.Index < m_Records.size() && m_Records[entity.Index].Owner && m_Records[entity.Index].Generation == entity.Generation;
+	}
+
+	void Scene::UpdateMovedEntity(Entity moved, uint32_t row)
+	{
+		if (!moved.IsNull())
+			m_Records[moved.Index].Row = row;
+	}
+
+	void* Scene::AddComponent(Entity entity, ComponentID id, bool& existed)
+	{
+		RE_CORE_ASSERT(IsAlive(entity), "AddComponent on a dead entity");
+		EntityRecord& record = m_Records[entity.Index];
+		Archetype* source = record.Owner;
+
+		existed = source->Has(id);
+		if (existed)
+			return source->GetComponent(record.Row, id);
+
+		AssertNotIterating();
+		Archetype* target = source->AddEdges[id];
+		if (!target)
+		{
+			target = GetArchetype(source->GetMask() | (ComponentMask(1) << id));
+			source->AddEdges[id] = target;
+			target->RemoveEdges[id] = source;
+		}
+
+		uint32_t row = target->Allocate(entity);
+		source->MoveRow(record.Row, *target, row);
+		UpdateMovedEntity(source->RemoveMoved(record.Row), record.Row);
+
+		record.Owner = target;
+		record.Row = row;
+		return target->GetComponent(row, id);
+	}
+
+	void Scene::RemoveComponent(Entity entity, ComponentID id)
+	{
+		if (!IsAlive(entity) || !m_Records[entity.Index].Owner->Has(id))
+			return;
+
+		AssertNotIterating();
+		EntityRecord& record = m_Records[entity.Index];
+		Archetype* source = record.Owner;
+		Archetype* target = source->RemoveEdges[id];
+		if (!target)
+		{
+			target = GetArchetype(source->GetMask() & ~(ComponentMask(1) << id));
+			source->RemoveEdges[id] = target;
+			target->AddEdges[id] = source;
+		}
+
+		uint32_t row = target->Allocate(entity);
+		source->MoveRow(record.Row, *target, row);
+		UpdateMovedEntity(source->RemoveMoved(record.Row), record.Row);
+
+		record.Owner = target;
+		record.Row = row;
+	}
+
+	EntityCommandBuffer& Scene::GetCommandBuffer()
+	{
+		uint32_t worker = JobSystem::GetCurrentWorkerIndex();
+		RE_CORE_ASSERT(worker < m_CommandBuffers.size(), "Scene::GetCommandBuffer from a thread that isn't a job system worker");
+		return *m_CommandBuffers[worker < m_CommandBuffers.size() ? worker : 0];
+	}
+
+	void Scene::PlaybackCommands()
+	{
+		RE_PROFILE_FUNC();
+		for (const std::unique_ptr<EntityCommandBuffer>& buffer : m_CommandBuffers)
+			buffer->Playback();
+		FlushReservedEntities();
+	}
+}
\ No newline at end of file
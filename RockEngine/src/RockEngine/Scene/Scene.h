@@ -0,0 +1,247 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "RockEngine/Core/Core.h"
+#include "RockEngine/Core/JobSystem.h"
+#include "RockEngine/Core/Log.h"
+#include "RockEngine/Scene/Archetype.h"
+#include "RockEngine/Scene/EntityCommandBuffer.h"
+#include "RockEngine/Scene/TransformHierarchy.h"
+
+namespace RockEngine
+{
+	// Entities and their components, stored by archetype (see Archetype). Structural changes
+	// (create, destroy, add, remove) are immediate and main thread only; while iterating, or
+	// from jobs, record them in a command buffer instead.
+	class Scene
+	{
+	public:
+		Scene();
+		~Scene();
+
+		Scene(const Scene&) = delete;
+		Scene& operator=(const Scene&) = delete;
+
+		Entity CreateEntity();
+
+		// Creates the entity directly in its final archetype
+		template<typename... Ts>
+		Entity CreateEntity(Ts... components)
+		{
+			Entity entity = AllocateEntity(GetArchetype(MakeComponentMask<Ts...>()));
+			const EntityRecord& record = m_Records[entity.Index];
+			(new (record.Owner->GetComponent(record.Row, ComponentRegistry::GetID<Ts>())) Ts(std::move(components)), ...);
+			return entity;
+		}
+
+		void DestroyEntity(Entity entity);
+		bool IsAlive(Entity entity) const;
+
+		// Replaces the component if the entity already has one
+		template<typename T>
+		T& AddComponent(Entity entity, T component = T())
+		{
+			bool existed;
+			void* storage = AddComponent(entity, ComponentRegistry::GetID<T>(), existed);
+			if (existed)
+				static_cast<T*>(storage)->~T();
+			return *new (storage) T(std::move(component));
+		}
+
+		template<typename T>
+		void RemoveComponent(Entity entity)
+		{
+			RemoveComponent(entity, ComponentRegistry::GetID<T>());
+		}
+
+		template<typename T>
+		bool HasComponent(Entity entity) const
+		{
+			return IsAlive(entity) && m_Records[entity.Index].Owner->Has(ComponentRegistry::GetID<T>());
+		}
+
+		// Null if the entity is dead or doesn't have the component. Invalidated by structural changes.
+		template<typename T>
+		T* TryGetComponent(Entity entity)
+		{
+			if (!HasComponent<T>(entity))
+				return nullptr;
+			const EntityRecord& record = m_Records[entity.Index];
+			return static_cast<T*>(record.Owner->GetComponent(record.Row, ComponentRegistry::GetID<T>()));
+		}
+
+		template<typename T>
+		T& GetComponent(Entity entity)
+		{
+			T* component = TryGetComponent<T>(entity);
+			RE_CORE_ASSERT(component, "Entity doesn't have the component");
+			return *component;
+		}
+
+		// Thread safe. The entity exists after the next command buffer playback.
+		Entity ReserveEntity();
+
+		// The calling job system worker's buffer. Threads that aren't workers need their own.
+		EntityCommandBuffer& GetCommandBuffer();
+		// Plays every worker's buffer back, in worker order
+		void PlaybackCommands();
+
+		// func(Ts&...) or func(Entity, Ts&...) for every entity with all of Ts and none of `exclude`
+		template<typename... Ts, typename Func>
+		void Each(Func&& func, ComponentMask exclude = 0)
+		{
+			EachChunk<Ts...>([&func](uint32_t count, const Entity* entities, Ts*... columns)
+			{
+				for (uint32_t i = 0; i < count; i++)
+				{
+					if constexpr (std::is_invocable_v<Func, Entity, Ts&...>)
+						func(entities[i], columns[i]...);
+					else
+						func(columns[i]...);
+				}
+			}, exclude);
+		}
+
+		// func(count, entities, Ts* columns...) once per chunk, the columns are contiguous arrays
+		template<typename... Ts, typename Func>
+		void EachChunk(Func&& func, ComponentMask exclude = 0)
+		{
+			const std::vector<Archetype*>& archetypes = GetQuery(MakeComponentMask<Ts...>(), exclude);
+			m_Iterating.fetch_add(1, std::memory_order_relaxed);
+			for (Archetype* archetype : archetypes)
+			{
+				for (uint32_t chunk = 0; chunk < archetype->GetChunkCount(); chunk++)
+				{
+					uint32_t count = archetype->GetChunkEntityCount(chunk);
+					if (count)
+						func(count, archetype->GetEntities(chunk), archetype->GetColumn<Ts>(chunk)...);
+				}
+			}
+			m_Iterating.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		// Like Each, with chunks spread over the job system. `func` runs concurrently.
+		template<typename... Ts, typename Func>
+		void ParallelEach(Func&& func, ComponentMask exclude = 0)
+		{
+			ParallelEachChunk<Ts...>([&func](uint32_t count, const Entity* entities, Ts*... columns)
+			{
+				for (uint32_t i = 0; i < count; i++)
+				{
+					if constexpr (std::is_invocable_v<Func, Entity, Ts&...>)
+						func(entities[i], columns[i]...);
+					else
+						func(columns[i]...);
+				}
+			}, exclude);
+		}
+
+		template<typename... Ts, typename Func>
+		void ParallelEachChunk(Func&& func, ComponentMask exclude = 0)
+		{
+			std::vector<ChunkRef> chunks;
+			for (Archetype* archetype : GetQuery(MakeComponentMask<Ts...>(), exclude))
+			{
+				for (uint32_t chunk = 0; chunk < archetype->GetChunkCount(); chunk++)
+				{
+					if (archetype->GetChunkEntityCount(chunk))
+						chunks.push_back({ archetype, chunk });
+				}
+			}
+
+			m_Iterating.fetch_add(1, std::memory_order_relaxed);
+			JobSystem::ParallelFor((uint32_t)chunks.size(), JobSystem::GetDefaultGrainSize((uint32_t)chunks.size(), 1), [&](uint32_t begin, uint32_t end)
+			{
+				for (uint32_t i = begin; i < end; i++)
+				{
+					Archetype* archetype = chunks[i].Owner;
+					uint32_t chunk = chunks[i].Chunk;
+					func(archetype->GetChunkEntityCount(chunk), archetype->GetEntities(chunk), archetype->GetColumn<Ts>(chunk)...);
+				}
+			});
+			m_Iterating.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		// Entities with all of Ts and none of `exclude`
+		template<typename... Ts>
+		uint32_t Count(ComponentMask exclude = 0)
+		{
+			uint32_t count = 0;
+			for (Archetype* archetype : GetQuery(MakeComponentMask<Ts...>(), exclude))
+				count += archetype->GetEntityCount();
+			return count;
+		}
+
+		// Entities that need a place in the world keep a TransformNode of this in a component
+		inline TransformHierarchy& GetTransforms() { return m_Transforms; }
+
+		inline uint32_t GetEntityCount() const { return m_EntityCount; }
+		inline uint32_t GetArchetypeCount() const { return (uint32_t)m_Archetypes.size(); }
+		inline uint32_t GetQueryCount() const { return (uint32_t)m_Queries.size(); }
+	private:
+		struct EntityRecord
+		{
+			Archetype* Owner = nullptr;		// null while the slot is free
+			uint32_t Row = 0;
+			uint32_t Generation = 0;
+		};
+
+		// Archetypes matching a component set, extended as new archetypes appear
+		struct QueryCache
+		{
+			ComponentMask Include;
+			ComponentMask Exclude;
+			std::vector<Archetype*> Archetypes;
+			uint32_t CheckedArchetypes = 0;
+		};
+
+		struct ChunkRef
+		{
+			Archetype* Owner;
+			uint32_t Chunk;
+		};
+
+		Archetype* GetArchetype(ComponentMask mask);
+		const std::vector<Archetype*>& GetQuery(ComponentMask include, ComponentMask exclude);
+
+		Entity AllocateEntity(Archetype* archetype);
+		void FlushReservedEntities();
+		// Creates the reserved entities with an index below `end` that don't have a record yet
+		void CreateReservedEntities(uint32_t end);
+		void UpdateMovedEntity(Entity moved, uint32_t row);
+
+		// Moves the entity to the archetype with the component and returns its (uninitialized
+		// unless `existed`) storage
+		void* AddComponent(Entity entity, ComponentID id, bool& existed);
+		void RemoveComponent(Entity entity, ComponentID id);
+
+		inline void AssertNotIterating() const { RE_CORE_ASSERT(m_Iterating.load(std::memory_order_relaxed) == 0, "Structural scene change while iterating, use a command buffer"); }
+	private:
+		std::vector<std::unique_ptr<Archetype>> m_Archetypes;
+		std::unordered_map<ComponentMask, Archetype*> m_ArchetypeLookup;
+		Archetype* m_EmptyArchetype;
+
+		std::vector<EntityRecord> m_Records;
+		std::vector<uint32_t> m_FreeIndices;
+		std::atomic<uint32_t> m_ReservedEnd{ 0 };	// m_Records grows up to here on the next flush
+		uint32_t m_EntityCount = 0;
+
+		// Queries can be looked up from layers updating in parallel
+		std::mutex m_QueryMutex;
+		std::vector<std::unique_ptr<QueryCache>> m_Queries;
+		std::atomic<uint32_t> m_Iterating{ 0 };
+
+		std::vector<std::unique_ptr<EntityCommandBuffer>> m_CommandBuffers;
+		TransformHierarchy m_Transforms;
+
+		friend class EntityCommandBuffer;
+		friend class SceneWriter;
+		friend class SceneSerializer;
+	};
+}
\ No newline at end of file
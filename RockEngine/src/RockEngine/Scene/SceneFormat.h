@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+
+#include "RockEngine/Scene/Entity.h"
+#include "RockEngine/Scene/RelativePointer.h"
+
+namespace RockEngine
+{
+	// Scene file layout, little endian, every reference a relative pointer:
+	//   SceneFileHeader		at 0, points to the current directory
+	//   chunk blobs			Entity[Count], then one column per component of the archetype in
+	//							schema order, each aligned to SceneColumnAlignment (or more)
+	//   SceneDirectory		schema, archetypes with their chunk lists, entity generations and free slots
+	// SceneWriter appends changed chunks and a new directory, then repoints the header, so
+	// blobs of older directories stay valid until the file is rewritten.
+	static constexpr uint32_t SceneBlobAlignment = 64;
+	static constexpr uint32_t SceneColumnAlignment = 16;
+
+	struct SceneComponentSchema
+	{
+		RelativeArray<char> Name;		// SceneSchema name, not terminated
+		uint32_t Version;
+		uint32_t Size;
+		uint32_t Alignment;
+		uint32_t Reserved;
+	};
+
+	struct SceneChunk
+	{
+		RelativePtr<uint8_t> Data;
+		uint64_t Hash;					// of the saved rows, to skip unchanged chunks
+		uint32_t Count;
+		uint32_t Reserved;
+	};
+
+	struct SceneArchetype
+	{
+		RelativeArray<uint32_t> Components;	// indices into SceneDirectory::Components, ascending
+		RelativeArray<SceneChunk> Chunks;
+		uint64_t EntityCount;
+	};
+
+	struct SceneDirectory
+	{
+		RelativeArray<SceneComponentSchema> Components;
+		RelativeArray<SceneArchetype> Archetypes;
+		RelativeArray<uint32_t> Generations;	// of every entity slot, dead ones included
+		RelativeArray<uint32_t> FreeIndices;	// the dead slots, in the order they're reused (last first)
+		uint64_t EntityCount;
+	};
+
+	struct SceneFileHeader
+	{
+		static constexpr uint32_t MagicValue = 0x4E435352;	// "RSCN"
+		static constexpr uint32_t CurrentVersion = 1;
+
+		uint32_t Magic;
+		uint32_t Version;
+		uint64_t FileSize;
+		RelativePtr<SceneDirectory> Directory;
+		uint64_t Reserved;
+	};
+
+	static_assert(sizeof(SceneFileHeader) == 32, "SceneFileHeader is read in place");
+	static_assert(sizeof(SceneChunk) == 24 && sizeof(SceneArchetype) == 40 && sizeof(SceneDirectory) == 72, "Scene file structs are read in place");
+	static_assert(sizeof(Entity) == 8, "Entity columns are read in place");
+
+	inline uint64_t AlignSceneOffset(uint64_t offset, uint64_t alignment)
+	{
+		return (offset + alignment - 1) & ~(alignment - 1);
+	}
+
+	inline uint32_t GetSceneColumnAlignment(uint32_t componentAlignment)
+	{
+		return componentAlignment > SceneColumnAlignment ? componentAlignment : SceneColumnAlignment;
+	}
+}
\ No newline at end of file
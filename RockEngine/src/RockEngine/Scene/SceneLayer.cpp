@@ -0,0 +1,46 @@
+#include "pch.h"
+#include "SceneLayer.h"
+
+#include "RockEngine/Memory/MemoryTracker.h"
+
+namespace RockEngine
+{
+	SceneLayer::SceneLayer(const std::string& name /* = "Scene" */)
+		: Layer(name)
+	{
+		DeclareWrite(name);
+	}
+
+	void SceneLayer::AddSystem(const std::string& name, SceneSystem system)
+	{
+		m_Systems.push_back({ name, std::move(system) });
+	}
+
+	void SceneLayer::AddFixedSystem(const std::string& name, SceneSystem system)
+	{
+		m_FixedSystems.push_back({ name, std::move(system) });
+	}
+
+	void SceneLayer::OnUpdate(Timestep ts)
+	{
+		// Fixed systems may have moved things, variable ones (drawing) want current world matrices
+		m_Scene.GetTransforms().Update();
+		RunSystems(m_Systems, ts);
+	}
+
+	void SceneLayer::OnFixedUpdate(Timestep ts)
+	{
+		RunSystems(m_FixedSystems, ts);
+	}
+
+	void SceneLayer::RunSystems(std::vector<NamedSystem>& systems, Timestep ts)
+	{
+		RE_MEMORY_SCOPE("Scene");
+		for (NamedSystem& system : systems)
+		{
+			RE_PROFILE_SCOPE(system.Name.c_str());
+			system.Function(m_Scene, ts);
+			m_Scene.PlaybackCommands();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "RockEngine/Core/Layer.h"
+#include "RockEngine/Scene/Scene.h"
+
+namespace RockEngine
+{
+	using SceneSystem = std::function<void(Scene& scene, Timestep ts)>;
+
+	// Owns a scene and runs its systems as part of the layer stack. Systems run in the order
+	// they were added; after each one, the commands it recorded are played back so the next
+	// system sees the changes. The layer declares a write to its own name, so other layers
+	// reaching into the scene should declare a read or write of it too.
+	class SceneLayer : public Layer
+	{
+	public:
+		SceneLayer(const std::string& name = "Scene");
+
+		void AddSystem(const std::string& name, SceneSystem system);
+		void AddFixedSystem(const std::string& name, SceneSystem system);
+
+		void OnUpdate(Timestep ts) override;
+		void OnFixedUpdate(Timestep ts) override;
+
+		inline Scene& GetScene() { return m_Scene; }
+	private:
+		struct NamedSystem
+		{
+			std::string Name;
+			SceneSystem Function;
+		};
+
+		void RunSystems(std::vector<NamedSystem>& systems, Timestep ts);
+	private:
+		Scene m_Scene;
+		std::vector<NamedSystem> m_Systems;
+		std::vector<NamedSystem> m_FixedSystems;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,617 @@
+#include "pch.h"
+#include "SceneSerializer.h"
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+#include "RockEngine/Core/Hash.h"
+#include "RockEngine/Memory/MemoryTracker.h"
+#include "RockEngine/Scene/Scene.h"
+
+namespace RockEngine
+{
+	static SerializedComponentInfo s_Schema[ComponentRegistry::MaxComponents];
+	static ComponentMask s_SchemaMask = 0;
+
+	void SceneSchema::Register(const SerializedComponentInfo& info)
+	{
+		// A name belongs to one type at a time, the last one registered
+		for (ComponentID id = 0; id < ComponentRegistry::MaxComponents; id++)
+		{
+			if (((s_SchemaMask >> id) & 1) && id != info.ID && std::strcmp(s_Schema[id].Name, info.Name) == 0)
+				s_SchemaMask &= ~(ComponentMask(1) << id);
+		}
+
+		s_Schema[info.ID] = info;
+		s_SchemaMask |= ComponentMask(1) << info.ID;
+	}
+
+	const SerializedComponentInfo* SceneSchema::Find(ComponentID id)
+	{
+		return ((s_SchemaMask >> id) & 1) ? &s_Schema[id] : nullptr;
+	}
+
+	const SerializedComponentInfo* SceneSchema::Find(std::string_view name)
+	{
+		for (ComponentID id = 0; id < ComponentRegistry::MaxComponents; id++)
+		{
+			if (((s_SchemaMask >> id) & 1) && name == s_Schema[id].Name)
+				return &s_Schema[id];
+		}
+		return nullptr;
+	}
+
+	ComponentMask SceneSchema::GetMask()
+	{
+		return s_SchemaMask;
+	}
+
+	// Column offsets of a chunk blob with `count` rows, returns the blob's size
+	static uint64_t LayoutChunk(uint32_t count, uint32_t columnCount, const uint32_t* sizes, const uint32_t* alignments, uint64_t* offsets)
+	{
+		uint64_t offset = (uint64_t)count * sizeof(Entity);
+		for (uint32_t i = 0; i < columnCount; i++)
+		{
+			offset = AlignSceneOffset(offset, GetSceneColumnAlignment(alignments[i]));
+			offsets[i] = offset;
+			offset += (uint64_t)count * sizes[i];
+		}
+		return offset;
+	}
+
+	// --- SceneFile -----------------------------------------------------
+
+	bool SceneFile::Open(const std::string& path)
+	{
+		RE_PROFILE_FUNC();
+		Close();
+
+		if (!m_File.Open(path))
+			return false;
+
+		const uint8_t* data = m_File.GetData();
+		const SceneFileHeader* header = reinterpret_cast<const SceneFileHeader*>(data);
+		bool valid = m_File.GetSize() >= sizeof(SceneFileHeader) && header->Magic == SceneFileHeader::MagicValue
+			&& header->Version == SceneFileHeader::CurrentVersion && header->FileSize <= m_File.GetSize();
+
+		if (valid)
+		{
+			// An interrupted save leaves a tail past FileSize, it's never referenced
+			int64_t directory = (int64_t)offsetof(SceneFileHeader, Directory) + header->Directory.Offset;
+			valid = directory >= (int64_t)sizeof(SceneFileHeader) && directory % alignof(SceneDirectory) == 0
+				&& (uint64_t)directory + sizeof(SceneDirectory) <= header->FileSize;
+			if (valid)
+				m_Directory = header->Directory.Get();
+		}
+
+		if (!valid || !Validate())
+		{
+			RE_CORE_ERROR("SceneFile: {} is not a valid version {} scene file", path, SceneFileHeader::CurrentVersion);
+			Close();
+			return false;
+		}
+
+		std::fill(std::begin(m_SchemaIndices), std::end(m_SchemaIndices), ~0u);
+		for (uint32_t i = 0; i < (uint32_t)m_Directory->Components.Size(); i++)
+		{
+			const SceneComponentSchema& schema = m_Directory->Components[i];
+			const SerializedComponentInfo* info = SceneSchema::Find(std::string_view(schema.Name.Data(), schema.Name.Size()));
+			if (info && info->Version == schema.Version && info->Size == schema.Size)
+				m_SchemaIndices[info->ID] = i;
+		}
+		return true;
+	}
+
+	void SceneFile::Close()
+	{
+		m_File.Close();
+		m_Directory = nullptr;
+	}
+
+	template<typename T>
+	bool SceneFile::Contains(const RelativeArray<T>& array) const
+	{
+		int64_t target = (int64_t)(reinterpret_cast<const uint8_t*>(&array) - m_File.GetData()) + array.Offset;
+		uint64_t size = m_File.GetSize();
+		return target >= 0 && (uint64_t)target <= size && target % alignof(T) == 0 && array.Count <= (size - (uint64_t)target) / sizeof(T);
+	}
+
+	// Everything Load and the in place accessors rely on. Entity handles are checked by Load,
+	// here that would touch every chunk.
+	bool SceneFile::Validate() const
+	{
+		const SceneDirectory& directory = *m_Directory;
+		if (!Contains(directory.Components) || !Contains(directory.Archetypes) || !Contains(directory.Generations) || !Contains(directory.FreeIndices))
+			return false;
+		if (directory.Components.Size() > ComponentRegistry::MaxComponents)
+			return false;
+
+		uint32_t sizes[ComponentRegistry::MaxComponents];
+		uint32_t alignments[ComponentRegistry::MaxComponents];
+		uint64_t offsets[ComponentRegistry::MaxComponents];
+		for (const SceneComponentSchema& schema : directory.Components)
+		{
+			if (!Contains(schema.Name) || schema.Alignment == 0 || schema.Alignment > 64 || (schema.Alignment & (schema.Alignment - 1)))
+				return false;
+		}
+
+		uint64_t entities = 0;
+		for (const SceneArchetype& archetype : directory.Archetypes)
+		{
+			if (!Contains(archetype.Components) || !Contains(archetype.Chunks) || archetype.Components.Size() > ComponentRegistry::MaxComponents)
+				return false;
+
+			uint32_t columnCount = (uint32_t)archetype.Components.Size();
+			for (uint32_t i = 0; i < columnCount; i++)
+			{
+				uint32_t index = archetype.Components[i];
+				if (index >= directory.Components.Size() || (i > 0 && index <= archetype.Components[i - 1]))
+					return false;
+				sizes[i] = directory.Components[index].Size;
+				alignments[i] = directory.Components[index].Alignment;
+			}
+
+			uint64_t archetypeEntities = 0;
+			for (const SceneChunk& chunk : archetype.Chunks)
+			{
+				int64_t data = (int64_t)(reinterpret_cast<const uint8_t*>(&chunk.Data) - m_File.GetData()) + chunk.Data.Offset;
+				uint64_t size = LayoutChunk(chunk.Count, columnCount, sizes, alignments, offsets);
+				if (chunk.Count == 0 || data < 0 || data % SceneBlobAlignment || (uint64_t)data > m_File.GetSize() || size > m_File.GetSize() - (uint64_t)data)
+					return false;
+				archetypeEntities += chunk.Count;
+			}
+			if (archetypeEntities != archetype.EntityCount)
+				return false;
+			entities += archetypeEntities;
+		}
+		return entities == directory.EntityCount && entities + directory.FreeIndices.Size() == directory.Generations.Size();
+	}
+
+	const void* SceneFile::GetColumn(const SceneArchetype& archetype, const SceneChunk& chunk, uint32_t schemaIndex) const
+	{
+		uint64_t offset = (uint64_t)chunk.Count * sizeof(Entity);
+		for (uint32_t index : archetype.Components)
+		{
+			const SceneComponentSchema& schema = m_Directory->Components[index];
+			offset = AlignSceneOffset(offset, GetSceneColumnAlignment(schema.Alignment));
+			if (index == schemaIndex)
+				return chunk.Data.Get() + offset;
+			offset += (uint64_t)chunk.Count * schema.Size;
+		}
+		return nullptr;
+	}
+
+	// --- SceneWriter ---------------------------------------------------
+
+	// Builds the directory in memory, positions are relative to its start
+	class SceneDirectoryBuilder
+	{
+	public:
+		explicit SceneDirectoryBuilder(uint64_t base)
+			: m_Base(base) {}
+
+		template<typename T>
+		uint64_t Allocate(uint64_t count = 1)
+		{
+			uint64_t position = AlignSceneOffset(m_Bytes.size(), 8);
+			m_Bytes.resize(position + sizeof(T) * count);
+			return position;
+		}
+
+		template<typename T>
+		void Set(uint64_t position, const T& value)
+		{
+			std::memcpy(&m_Bytes[position], &value, sizeof(T));
+		}
+
+		// Points the RelativeArray at `field` to `count` elements at `target`
+		template<typename T>
+		void Link(uint64_t field, uint64_t target, uint64_t count)
+		{
+			RelativeArray<T> array;
+			array.Offset = (int64_t)target - (int64_t)field;
+			array.Count = count;
+			Set(field, array);
+		}
+
+		// Points the RelativePtr at `field` to an absolute file offset
+		void LinkFile(uint64_t field, uint64_t fileOffset)
+		{
+			int64_t offset = (int64_t)fileOffset - (int64_t)(m_Base + field);
+			Set(field, offset);
+		}
+
+		inline const std::vector<uint8_t>& GetBytes() const { return m_Bytes; }
+	private:
+		uint64_t m_Base;
+		std::vector<uint8_t> m_Bytes;
+	};
+
+	static void WritePadding(std::fstream& stream, uint64_t size)
+	{
+		static const char s_Zeros[SceneBlobAlignment] = {};
+		for (; size > 0; size -= std::min<uint64_t>(size, sizeof(s_Zeros)))
+			stream.write(s_Zeros, std::min<uint64_t>(size, sizeof(s_Zeros)));
+	}
+
+	SceneWriter::SceneWriter(const std::string& path)
+		: m_Path(path)
+	{
+	}
+
+	void SceneWriter::Reset()
+	{
+		m_Saved.clear();
+		m_SavedSchema.clear();
+		m_SavedScene = nullptr;
+		m_FileSize = 0;
+		m_LiveBytes = 0;
+	}
+
+	bool SceneWriter::Save(Scene& scene)
+	{
+		RE_PROFILE_FUNC();
+		RE_MEMORY_SCOPE("Scene");
+
+		scene.AssertNotIterating();
+		scene.FlushReservedEntities();
+		m_Stats = {};
+
+		// The serialized components the scene uses, in ComponentID order
+		ComponentMask serialized = SceneSchema::GetMask();
+		ComponentMask used = 0;
+		for (const std::unique_ptr<Archetype>& archetype : scene.m_Archetypes)
+		{
+			if (archetype->GetEntityCount())
+				used |= archetype->GetMask() & serialized;
+		}
+
+		std::vector<ComponentID> schema;
+		uint32_t schemaIndices[ComponentRegistry::MaxComponents];
+		for (ComponentID id = 0; id < ComponentRegistry::MaxComponents; id++)
+		{
+			schemaIndices[id] = (uint32_t)schema.size();
+			if ((used >> id) & 1)
+				schema.push_back(id);
+		}
+
+		bool rewrite = m_FileSize == 0 || m_SavedScene != &scene || schema != m_SavedSchema || m_FileSize > 2 * m_LiveBytes;
+		std::fstream stream;
+		if (rewrite)
+		{
+			m_Saved.clear();
+			stream.open(m_Path, std::ios::out | std::ios::binary | std::ios::trunc);
+			// Zeroed until the end: a save interrupted before that leaves an invalid file
+			WritePadding(stream, sizeof(SceneFileHeader));
+			m_FileSize = sizeof(SceneFileHeader);
+		}
+		else
+		{
+			stream.open(m_Path, std::ios::in | std::ios::out | std::ios::binary);
+			stream.seekp((std::streamoff)m_FileSize);
+		}
+		if (!stream)
+		{
+			RE_CORE_ERROR("SceneWriter: can't open {}", m_Path);
+			Reset();
+			return false;
+		}
+
+		struct SavedArchetype
+		{
+			std::vector<uint32_t> Components;
+			const std::vector<SavedChunk>* Chunks;
+			uint64_t EntityCount;
+		};
+		std::vector<SavedArchetype> archetypes;
+		std::unordered_map<ComponentMask, std::vector<SavedChunk>> saved;
+		uint64_t liveBytes = sizeof(SceneFileHeader);
+
+		for (const std::unique_ptr<Archetype>& archetype : scene.m_Archetypes)
+		{
+			if (!archetype->GetEntityCount())
+				continue;
+
+			// Columns in the file are the archetype's serialized components
+			uint32_t columnCount = 0;
+			ComponentID columns[ComponentRegistry::MaxComponents];
+			uint32_t sizes[ComponentRegistry::MaxComponents];
+			uint32_t alignments[ComponentRegistry::MaxComponents];
+			uint64_t offsets[ComponentRegistry::MaxComponents];
+			SavedArchetype out = { {}, nullptr, archetype->GetEntityCount() };
+			for (ComponentID id : archetype->GetComponents())
+			{
+				if (!((serialized >> id) & 1))
+					continue;
+				columns[columnCount] = id;
+				sizes[columnCount] = s_Schema[id].Size;
+				alignments[columnCount] = s_Schema[id].Alignment;
+				out.Components.push_back(schemaIndices[id]);
+				columnCount++;
+			}
+
+			auto previous = m_Saved.find(archetype->GetMask());
+			std::vector<SavedChunk>& chunks = saved[archetype->GetMask()];
+			for (uint32_t chunk = 0; chunk < archetype->GetChunkCount(); chunk++)
+			{
+				uint32_t count = archetype->GetChunkEntityCount(chunk);
+				if (!count)
+					continue;
+
+				const Entity* entities = archetype->GetEntities(chunk);
+				uint64_t hash = HashBytes(entities, count * sizeof(Entity), count);
+				for (uint32_t i = 0; i < columnCount; i++)
+					hash = HashBytes(archetype->GetColumn(chunk, columns[i]), (size_t)count * sizes[i], hash);
+				uint64_t size = LayoutChunk(count, columnCount, sizes, alignments, offsets);
+				liveBytes += size;
+
+				SavedChunk savedChunk = { 0, hash, count };
+				if (previous != m_Saved.end() && chunk < previous->second.size() && previous->second[chunk].Hash == hash && previous->second[chunk].Count == count)
+				{
+					savedChunk.Offset = previous->second[chunk].Offset;
+					m_Stats.ChunksReused++;
+					chunks.push_back(savedChunk);
+					continue;
+				}
+
+				savedChunk.Offset = AlignSceneOffset(m_FileSize, SceneBlobAlignment);
+				WritePadding(stream, savedChunk.Offset - m_FileSize);
+				stream.write(reinterpret_cast<const char*>(entities), count * sizeof(Entity));
+				uint64_t written = count * sizeof(Entity);
+				for (uint32_t i = 0; i < columnCount; i++)
+				{
+					WritePadding(stream, offsets[i] - written);
+					stream.write(static_cast<const char*>(archetype->GetColumn(chunk, columns[i])), (std::streamsize)count * sizes[i]);
+					written = offsets[i] + (uint64_t)count * sizes[i];
+				}
+
+				m_Stats.ChunksWritten++;
+				m_Stats.BytesWritten += savedChunk.Offset + size - m_FileSize;
+				m_FileSize = savedChunk.Offset + size;
+				chunks.push_back(savedChunk);
+			}
+			out.Chunks = &chunks;
+			archetypes.push_back(std::move(out));
+		}
+
+		// The directory goes after the blobs
+		uint64_t directoryOffset = AlignSceneOffset(m_FileSize, SceneBlobAlignment);
+		SceneDirectoryBuilder builder(directoryOffset);
+		uint64_t directory = builder.Allocate<SceneDirectory>();
+		builder.Set(directory, SceneDirectory{ {}, {}, {}, {}, scene.m_EntityCount });
+
+		uint64_t components = builder.Allocate<SceneComponentSchema>(schema.size());
+		for (uint64_t i = 0; i < schema.size(); i++)
+		{
+			const SerializedComponentInfo& info = s_Schema[schema[i]];
+			uint64_t field = components + i * sizeof(SceneComponentSchema);
+			uint64_t nameLength = std::strlen(info.Name);
+			uint64_t name = builder.Allocate<char>(nameLength);
+			for (uint64_t c = 0; c < nameLength; c++)
+				builder.Set(name + c, info.Name[c]);
+
+			builder.Set(field, SceneComponentSchema{ {}, info.Version, info.Size, info.Alignment, 0 });
+			builder.Link<char>(field + offsetof(SceneComponentSchema, Name), name, nameLength);
+		}
+		builder.Link<SceneComponentSchema>(directory + offsetof(SceneDirectory, Components), components, schema.size());
+
+		uint64_t archetypeTable = builder.Allocate<SceneArchetype>(archetypes.size());
+		for (uint64_t i = 0; i < archetypes.size(); i++)
+		{
+			const SavedArchetype& archetype = archetypes[i];
+			uint64_t field = archetypeTable + i * sizeof(SceneArchetype);
+			builder.Set(field, SceneArchetype{ {}, {}, archetype.EntityCount });
+
+			uint64_t indices = builder.Allocate<uint32_t>(archetype.Components.size());
+			for (uint64_t k = 0; k < archetype.Components.size(); k++)
+				builder.Set(indices + k * sizeof(uint32_t), archetype.Components[k]);
+			builder.Link<uint32_t>(field + offsetof(SceneArchetype, Components), indices, archetype.Components.size());
+
+			uint64_t chunkTable = builder.Allocate<SceneChunk>(archetype.Chunks->size());
+			for (uint64_t k = 0; k < archetype.Chunks->size(); k++)
+			{
+				const SavedChunk& chunk = (*archetype.Chunks)[k];
+				uint64_t chunkField = chunkTable + k * sizeof(SceneChunk);
+				builder.Set(chunkField, SceneChunk{ {}, chunk.Hash, chunk.Count, 0 });
+				builder.LinkFile(chunkField + offsetof(SceneChunk, Data), chunk.Offset);
+			}
+			builder.Link<SceneChunk>(field + offsetof(SceneArchetype, Chunks), chunkTable, archetype.Chunks->size());
+		}
+		builder.Link<SceneArchetype>(directory + offsetof(SceneDirectory, Archetypes), archetypeTable, archetypes.size());
+
+		uint64_t generations = builder.Allocate<uint32_t>(scene.m_Records.size());
+		for (uint64_t i = 0; i < scene.m_Records.size(); i++)
+			builder.Set(generations + i * sizeof(uint32_t), scene.m_Records[i].Generation);
+		builder.Link<uint32_t>(directory + offsetof(SceneDirectory, Generations), generations, scene.m_Records.size());
+
+		uint64_t freeIndices = builder.Allocate<uint32_t>(scene.m_FreeIndices.size());
+		for (uint64_t i = 0; i < scene.m_FreeIndices.size(); i++)
+			builder.Set(freeIndices + i * sizeof(uint32_t), scene.m_FreeIndices[i]);
+		builder.Link<uint32_t>(directory + offsetof(SceneDirectory, FreeIndices), freeIndices, scene.m_FreeIndices.size());
+
+		const std::vector<uint8_t>& bytes = builder.GetBytes();
+		WritePadding(stream, directoryOffset - m_FileSize);
+		stream.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+		m_Stats.BytesWritten += directoryOffset + bytes.size() - m_FileSize;
+		m_FileSize = directoryOffset + bytes.size();
+		liveBytes += bytes.size();
+
+		// Everything the new directory references is written before the header points to it
+		stream.flush();
+		SceneFileHeader header = {};
+		header.Magic = SceneFileHeader::MagicValue;
+		header.Version = SceneFileHeader::CurrentVersion;
+		header.FileSize = m_FileSize;
+		header.Directory.Offset = (int64_t)directoryOffset - (int64_t)offsetof(SceneFileHeader, Directory);
+		stream.seekp(0);
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		stream.flush();
+
+		if (!stream)
+		{
+			RE_CORE_ERROR("SceneWriter: writing {} failed", m_Path);
+			Reset();
+			return false;
+		}
+
+		m_Saved = std::move(saved);
+		m_SavedSchema = std::move(schema);
+		m_SavedScene = &scene;
+		m_LiveBytes = liveBytes;
+		m_Stats.BytesWritten += sizeof(header);
+		m_Stats.FileSize = m_FileSize;
+		m_Stats.Rewritten = rewrite;
+		return true;
+	}
+
+	// --- SceneSerializer -----------------------------------------------
+
+	bool SceneSerializer::Save(Scene& scene, const std::string& path)
+	{
+		SceneWriter writer(path);
+		return writer.Save(scene);
+	}
+
+	// Copies `count` rows into an archetype's column starting at `firstRow`, chunk by chunk
+	static void CopyColumn(Archetype& archetype, uint32_t firstRow, uint32_t count, ComponentID id, uint32_t size, const uint8_t* source)
+	{
+		for (uint32_t done = 0; done < count;)
+		{
+			uint32_t row = firstRow + done;
+			uint32_t chunk = row / archetype.GetChunkCapacity();
+			uint32_t offset = row % archetype.GetChunkCapacity();
+			uint32_t rows = std::min(count - done, archetype.GetChunkCapacity() - offset);
+			std::memcpy(static_cast<uint8_t*>(archetype.GetColumn(chunk, id)) + (size_t)offset * size, source + (size_t)done * size, (size_t)rows * size);
+			done += rows;
+		}
+	}
+
+	bool SceneSerializer::Load(const SceneFile& file, Scene& scene)
+	{
+		RE_PROFILE_FUNC();
+		RE_MEMORY_SCOPE("Scene");
+
+		scene.AssertNotIterating();
+		scene.FlushReservedEntities();
+		if (!file.IsOpen() || scene.GetEntityCount() != 0)
+		{
+			RE_CORE_ERROR("SceneSerializer: scenes are loaded into an empty scene from an open file");
+			return false;
+		}
+
+		const SceneDirectory& directory = file.GetDirectory();
+		const RelativeArray<uint32_t>& generations = directory.Generations;
+
+		// Entity handles first, so a bad file is refused before the scene changes
+		std::vector<uint8_t> seen(generations.Size(), 0);
+		for (const SceneArchetype& archetype : directory.Archetypes)
+		{
+			for (const SceneChunk& chunk : archetype.Chunks)
+			{
+				const Entity* entities = SceneFile::GetEntities(chunk);
+				for (uint32_t i = 0; i < chunk.Count; i++)
+				{
+					const Entity& entity = entities[i];
+					if (entity.Index >= generations.Size() || generations[entity.Index] != entity.Generation || seen[entity.Index])
+					{
+						RE_CORE_ERROR("SceneSerializer: the scene file has an invalid entity {}", entity.Index);
+						return false;
+					}
+					seen[entity.Index] = 1;
+				}
+			}
+		}
+		// Validate checked the counts add up, so this covers every slot exactly once
+		for (uint32_t index : directory.FreeIndices)
+		{
+			if (index >= generations.Size() || seen[index])
+			{
+				RE_CORE_ERROR("SceneSerializer: the scene file has an invalid free slot {}", index);
+				return false;
+			}
+			seen[index] = 1;
+		}
+
+		// What each of the file's components becomes
+		const uint32_t componentCount = (uint32_t)directory.Components.Size();
+		const SerializedComponentInfo* targets[ComponentRegistry::MaxComponents] = {};
+		bool upgrade[ComponentRegistry::MaxComponents] = {};
+		for (uint32_t i = 0; i < componentCount; i++)
+		{
+			const SceneComponentSchema& schema = directory.Components[i];
+			std::string_view name(schema.Name.Data(), schema.Name.Size());
+			const SerializedComponentInfo* info = SceneSchema::Find(name);
+			if (info && info->Version == schema.Version && info->Size == schema.Size)
+			{
+				targets[i] = info;
+			}
+			else if (info && info->Version > schema.Version && info->Upgrade)
+			{
+				targets[i] = info;
+				upgrade[i] = true;
+			}
+			else
+			{
+				RE_CORE_WARN("SceneSerializer: dropping {} version {}, it's {}", name, schema.Version,
+					info ? "a different version without an upgrade" : "not in the schema");
+			}
+		}
+
+		scene.m_Records.assign(generations.Size(), Scene::EntityRecord());
+		scene.m_FreeIndices.clear();
+		for (uint64_t i = 0; i < generations.Size(); i++)
+			scene.m_Records[i].Generation = generations[i];
+
+		for (const SceneArchetype& archetype : directory.Archetypes)
+		{
+			ComponentMask mask = 0;
+			for (uint32_t index : archetype.Components)
+			{
+				if (targets[index])
+					mask |= ComponentMask(1) << targets[index]->ID;
+			}
+			Archetype& target = *scene.GetArchetype(mask);
+
+			for (const SceneChunk& chunk : archetype.Chunks)
+			{
+				const Entity* entities = SceneFile::GetEntities(chunk);
+				uint32_t firstRow = target.AllocateRange(entities, chunk.Count);
+
+				for (uint32_t index : archetype.Components)
+				{
+					const SerializedComponentInfo* info = targets[index];
+					if (!info)
+						continue;
+
+					const uint8_t* column = static_cast<const uint8_t*>(file.GetColumn(archetype, chunk, index));
+					if (!upgrade[index])
+					{
+						CopyColumn(target, firstRow, chunk.Count, info->ID, info->Size, column);
+						continue;
+					}
+
+					const SceneComponentSchema& schema = directory.Components[index];
+					for (uint32_t row = 0; row < chunk.Count; row++)
+					{
+						void* component = target.GetComponent(firstRow + row, info->ID);
+						info->Construct(component);
+						info->Upgrade(column + (size_t)row * schema.Size, schema.Version, schema.Size, component);
+					}
+				}
+
+				for (uint32_t row = 0; row < chunk.Count; row++)
+				{
+					Scene::EntityRecord& record = scene.m_Records[entities[row].Index];
+					record.Owner = &target;
+					record.Row = firstRow + row;
+				}
+			}
+		}
+
+		scene.m_FreeIndices.assign(directory.FreeIndices.begin(), directory.FreeIndices.end());
+		scene.m_ReservedEnd.store((uint32_t)generations.Size(), std::memory_order_relaxed);
+		scene.m_EntityCount = (uint32_t)directory.EntityCount;
+		return true;
+	}
+}
\ No newline at end of file
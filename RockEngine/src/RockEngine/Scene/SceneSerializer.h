@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "RockEngine/Asset/MappedFile.h"
+#include "RockEngine/Scene/Component.h"
+#include "RockEngine/Scene/SceneFormat.h"
+
+namespace RockEngine
+{
+	class Scene;
+
+	// Converts a component saved with an older version (`old` holds `oldSize` bytes of it) into
+	// `component`, which is default constructed
+	using ComponentUpgrade = void(*)(const void* old, uint32_t oldVersion, uint32_t oldSize, void* component);
+
+	struct SerializedComponentInfo
+	{
+		const char* Name;
+		uint32_t Version;
+		ComponentID ID;
+		uint32_t Size;
+		uint32_t Alignment;
+		void (*Construct)(void* component);
+		ComponentUpgrade Upgrade;
+	};
+
+	// Components that go into scene files, by a name that's stable across builds (ComponentIDs
+	// are handed out at runtime). Bump the version whenever the layout changes; files with older
+	// versions are converted by the upgrade function, or the component is dropped when loading.
+	// Register everything at startup, before saving or loading. Registering a name again for
+	// another type moves the name to it.
+	class SceneSchema
+	{
+	public:
+		template<typename T>
+		static void Register(const char* name, uint32_t version = 1, ComponentUpgrade upgrade = nullptr)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Serialized components are saved and loaded as raw bytes");
+			Register({ name, version, ComponentRegistry::GetID<T>(), (uint32_t)sizeof(T), (uint32_t)alignof(T),
+				[](void* component) { new (component) T(); }, upgrade });
+		}
+
+		// Null if the component isn't serialized
+		static const SerializedComponentInfo* Find(ComponentID id);
+		static const SerializedComponentInfo* Find(std::string_view name);
+		static ComponentMask GetMask();
+	private:
+		static void Register(const SerializedComponentInfo& info);
+	};
+
+	// A scene file mapped into memory and used in place: the directory and the chunks' columns
+	// are read straight from the mapping, nothing is deserialized. Load it into a Scene with
+	// SceneSerializer::Load to change it.
+	class SceneFile
+	{
+	public:
+		SceneFile() = default;
+
+		bool Open(const std::string& path);
+		void Close();
+
+		inline bool IsOpen() const { return m_Directory != nullptr; }
+		inline const SceneDirectory& GetDirectory() const { return *m_Directory; }
+		inline uint64_t GetEntityCount() const { return m_Directory ? m_Directory->EntityCount : 0; }
+
+		// The file's schema index of a component, ~0u unless the file has it with the version and
+		// size it's registered with now
+		inline uint32_t GetSchemaIndex(ComponentID id) const { return m_SchemaIndices[id]; }
+
+		static const Entity* GetEntities(const SceneChunk& chunk) { return reinterpret_cast<const Entity*>(chunk.Data.Get()); }
+		// Null if the archetype doesn't have the component
+		const void* GetColumn(const SceneArchetype& archetype, const SceneChunk& chunk, uint32_t schemaIndex) const;
+
+		// func(count, entities, const Ts* columns...) once per chunk with all of Ts, read-only and
+		// straight from the mapping
+		template<typename... Ts, typename Func>
+		void EachChunk(Func&& func) const
+		{
+			if (!m_Directory)
+				return;
+
+			const uint32_t indices[] = { GetSchemaIndex(ComponentRegistry::GetID<Ts>())... };
+			for (uint32_t index : indices)
+			{
+				if (index == ~0u)
+					return;
+			}
+
+			for (const SceneArchetype& archetype : m_Directory->Archetypes)
+			{
+				bool matches = true;
+				for (uint32_t index : indices)
+					matches &= std::find(archetype.Components.begin(), archetype.Components.end(), index) != archetype.Components.end();
+				if (!matches)
+					continue;
+
+				for (const SceneChunk& chunk : archetype.Chunks)
+					CallChunk<Ts...>(func, archetype, chunk, indices, std::index_sequence_for<Ts...>());
+			}
+		}
+	private:
+		template<typename... Ts, typename Func, size_t... I>
+		void CallChunk(Func& func, const SceneArchetype& archetype, const SceneChunk& chunk, const uint32_t* indices, std::index_sequence<I...>) const
+		{
+			func(chunk.Count, GetEntities(chunk), static_cast<const Ts*>(GetColumn(archetype, chunk, indices[I]))...);
+		}
+
+		bool Validate() const;
+		template<typename T>
+		bool Contains(const RelativeArray<T>& array) const;
+	private:
+		MappedFile m_File;
+		const SceneDirectory* m_Directory = nullptr;
+		uint32_t m_SchemaIndices[ComponentRegistry::MaxComponents];
+	};
+
+	struct SceneWriterStats
+	{
+		uint32_t ChunksWritten;
+		uint32_t ChunksReused;		// unchanged since the last save, still in the file
+		uint64_t BytesWritten;
+		uint64_t FileSize;
+		bool Rewritten;				// the whole file, not just the changes
+	};
+
+	// Saves one scene to one file again and again. The first save writes everything; later ones
+	// hash every chunk, append only those that changed plus a new directory, and repoint the
+	// header last, so an interrupted save leaves the previous one intact. Once more than half of
+	// the file is stale it's rewritten, so close SceneFiles mapping the path before saving.
+	class SceneWriter
+	{
+	public:
+		explicit SceneWriter(const std::string& path);
+
+		bool Save(Scene& scene);
+		// The next save rewrites the file
+		void Reset();
+
+		inline const std::string& GetPath() const { return m_Path; }
+		inline const SceneWriterStats& GetStats() const { return m_Stats; }
+	private:
+		struct SavedChunk
+		{
+			uint64_t Offset;
+			uint64_t Hash;
+			uint32_t Count;
+		};
+	private:
+		std::string m_Path;
+		// Per runtime archetype and chunk index, what's in the file
+		std::unordered_map<ComponentMask, std::vector<SavedChunk>> m_Saved;
+		std::vector<ComponentID> m_SavedSchema;
+		const Scene* m_SavedScene = nullptr;
+		uint64_t m_FileSize = 0;
+		uint64_t m_LiveBytes = 0;
+		SceneWriterStats m_Stats = {};
+	};
+
+	class SceneSerializer
+	{
+	public:
+		// Writes the whole scene, for one-off saves
+		static bool Save(Scene& scene, const std::string& path);
+
+		// Recreates the file's entities, with their indices and generations, and its free slots
+		// in an empty scene: one copy per column and chunk. Components unknown to the schema are
+		// dropped, older versions are upgraded.
+		static bool Load(const SceneFile& file, Scene& scene);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,462 @@
+#include "pch.h"
+#include "TransformHierarchy.h"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+#include "RockEngine/Core/JobSystem.h"
+#include "RockEngine/Memory/MemoryTracker.h"
+
+namespace RockEngine
+{
+	// Levels smaller than this are updated inline, a job per range costs more than it saves
+	static constexpr uint32_t s_ParallelLevelSize = 2048;
+
+	template<typename T>
+	static void Permute(std::vector<T>& values, const std::vector<uint32_t>& order)
+	{
+		std::vector<T> permuted(order.size());
+		for (size_t i = 0; i < order.size(); i++)
+			permuted[i] = values[order[i]];
+		values.swap(permuted);
+	}
+
+	TransformHierarchy::TransformHierarchy()
+	{
+		TransformSystem::Register(this);
+	}
+
+	TransformHierarchy::~TransformHierarchy()
+	{
+		TransformSystem::Unregister(this);
+	}
+
+	TransformNode TransformHierarchy::Create(TransformNode parent /* = {} */)
+	{
+		RE_CORE_ASSERT(parent.IsNull() || IsAlive(parent), "TransformHierarchy::Create with a dead parent");
+
+		uint32_t index;
+		if (!m_FreeRecords.empty())
+		{
+			index = m_FreeRecords.back();
+			m_FreeRecords.pop_back();
+		}
+		else
+		{
+			index = (uint32_t)m_Records.size();
+			m_Records.emplace_back();
+		}
+
+		uint32_t slot = (uint32_t)m_Parents.size();
+		NodeRecord& record = m_Records[index];
+		record.Slot = slot;
+		record.Alive = true;
+
+		for (std::vector<float>& stream : m_Translation)
+			stream.push_back(0.0f);
+		for (uint32_t i = 0; i < 4; i++)
+			m_Rotation[i].push_back(i == 3 ? 1.0f : 0.0f);
+		for (std::vector<float>& stream : m_Scale)
+			stream.push_back(1.0f);
+		m_LocalMatrices.emplace_back();
+		m_WorldMatrices.emplace_back();
+		m_Parents.push_back(parent.IsNull() ? NoParent : GetSlot(parent));
+		m_SlotRecords.push_back(index);
+		m_Alive.push_back(1);
+		m_Dirty.push_back(0);
+		m_Changed.push_back(0);
+
+		MarkDirty(slot);
+		m_StructureChanged = true;
+		return { index, record.Generation };
+	}
+
+	void TransformHierarchy::Destroy(TransformNode node)
+	{
+		if (!IsAlive(node))
+			return;
+
+		NodeRecord& record = m_Records[node.Index];
+		m_Alive[record.Slot] = 0;
+		record.Alive = false;
+		record.Generation++;
+		m_FreeRecords.push_back(node.Index);
+		m_StructureChanged = true;
+	}
+
+	bool TransformHierarchy::IsAlive(TransformNode node) const
+	{
+		return node.Index < m_Records.size() && m_Records[node.Index].Alive && m_Records[node.Index].Generation == node.Generation;
+	}
+
+	bool TransformHierarchy::SetParent(TransformNode node, TransformNode parent)
+	{
+		RE_CORE_ASSERT(IsAlive(node) && (parent.IsNull() || IsAlive(parent)), "TransformHierarchy::SetParent on a dead node");
+
+		uint32_t slot = GetSlot(node);
+		uint32_t parentSlot = parent.IsNull() ? NoParent : GetSlot(parent);
+		for (uint32_t ancestor = parentSlot; ancestor != NoParent; ancestor = m_Parents[ancestor])
+		{
+			if (ancestor == slot)
+				return false;
+		}
+
+		m_Parents[slot] = parentSlot;
+		MarkDirty(slot);
+		m_StructureChanged = true;
+		return true;
+	}
+
+	TransformNode TransformHierarchy::GetParent(TransformNode node) const
+	{
+		uint32_t parent = m_Parents[GetSlot(node)];
+		if (parent == NoParent)
+			return {};
+
+		uint32_t index = m_SlotRecords[parent];
+		return { index, m_Records[index].Generation };
+	}
+
+	void TransformHierarchy::SetLocal(TransformNode node, const Vec3& translation, const Quat& rotation, const Vec3& scale)
+	{
+		SetTranslation(node, translation);
+		SetRotation(node, rotation);
+		SetScale(node, scale);
+	}
+
+	void TransformHierarchy::SetTranslation(TransformNode node, const Vec3& translation)
+	{
+		RE_CORE_ASSERT(IsAlive(node), "TransformHierarchy::SetTranslation on a dead node");
+		uint32_t slot = GetSlot(node);
+		m_Translation[0][slot] = translation.GetX();
+		m_Translation[1][slot] = translation.GetY();
+		m_Translation[2][slot] = translation.GetZ();
+		MarkDirty(slot);
+	}
+
+	void TransformHierarchy::SetRotation(TransformNode node, const Quat& rotation)
+	{
+		RE_CORE_ASSERT(IsAlive(node), "TransformHierarchy::SetRotation on a dead node");
+		uint32_t slot = GetSlot(node);
+		m_Rotation[0][slot] = rotation.GetX();
+		m_Rotation[1][slot] = rotation.GetY();
+		m_Rotation[2][slot] = rotation.GetZ();
+		m_Rotation[3][slot] = rotation.GetW();
+		MarkDirty(slot);
+	}
+
+	void TransformHierarchy::SetScale(TransformNode node, const Vec3& scale)
+	{
+		RE_CORE_ASSERT(IsAlive(node), "TransformHierarchy::SetScale on a dead node");
+		uint32_t slot = GetSlot(node);
+		m_Scale[0][slot] = scale.GetX();
+		m_Scale[1][slot] = scale.GetY();
+		m_Scale[2][slot] = scale.GetZ();
+		MarkDirty(slot);
+	}
+
+	Vec3 TransformHierarchy::GetTranslation(TransformNode node) const
+	{
+		uint32_t slot = GetSlot(node);
+		return Vec3(m_Translation[0][slot], m_Translation[1][slot], m_Translation[2][slot]);
+	}
+
+	Quat TransformHierarchy::GetRotation(TransformNode node) const
+	{
+		uint32_t slot = GetSlot(node);
+		return Quat(m_Rotation[0][slot], m_Rotation[1][slot], m_Rotation[2][slot], m_Rotation[3][slot]);
+	}
+
+	Vec3 TransformHierarchy::GetScale(TransformNode node) const
+	{
+		uint32_t slot = GetSlot(node);
+		return Vec3(m_Scale[0][slot], m_Scale[1][slot], m_Scale[2][slot]);
+	}
+
+	const Mat4& TransformHierarchy::GetWorld(TransformNode node) const
+	{
+		RE_CORE_ASSERT(IsAlive(node), "TransformHierarchy::GetWorld on a dead node");
+		return m_WorldMatrices[GetSlot(node)];
+	}
+
+	void TransformHierarchy::MarkDirty(uint32_t slot)
+	{
+		if (!m_Dirty[slot])
+		{
+			m_Dirty[slot] = 1;
+			m_DirtySlots.push_back(slot);
+		}
+	}
+
+	// Breadth first from the roots, so every level is contiguous and ordered by parent. Nodes
+	// under a destroyed node aren't reached and are released here.
+	void TransformHierarchy::Rebuild()
+	{
+		RE_PROFILE_FUNC();
+		RE_MEMORY_SCOPE("Scene");
+
+		uint32_t count = (uint32_t)m_Parents.size();
+		std::vector<uint32_t> childStarts(count + 1, 0);
+		for (uint32_t slot = 0; slot < count; slot++)
+		{
+			if (m_Alive[slot] && m_Parents[slot] != NoParent)
+				childStarts[m_Parents[slot] + 1]++;
+		}
+		for (uint32_t slot = 0; slot < count; slot++)
+			childStarts[slot + 1] += childStarts[slot];
+
+		std::vector<uint32_t> children(childStarts[count]);
+		std::vector<uint32_t> fill(childStarts.begin(), childStarts.end() - 1);
+		for (uint32_t slot = 0; slot < count; slot++)
+		{
+			if (m_Alive[slot] && m_Parents[slot] != NoParent)
+				children[fill[m_Parents[slot]]++] = slot;
+		}
+
+		std::vector<uint32_t> order;
+		order.reserve(count);
+		for (uint32_t slot = 0; slot < count; slot++)
+		{
+			if (m_Alive[slot] && m_Parents[slot] == NoParent)
+				order.push_back(slot);
+		}
+
+		m_LevelStarts.assign(1, 0);
+		for (uint32_t begin = 0; begin < order.size();)
+		{
+			uint32_t end = (uint32_t)order.size();
+			for (uint32_t i = begin; i < end; i++)
+			{
+				for (uint32_t child = childStarts[order[i]]; child < childStarts[order[i] + 1]; child++)
+					order.push_back(children[child]);
+			}
+			m_LevelStarts.push_back(end);
+			begin = end;
+		}
+
+		std::vector<uint32_t> newSlots(count, NoParent);
+		for (uint32_t i = 0; i < order.size(); i++)
+			newSlots[order[i]] = i;
+
+		for (uint32_t slot = 0; slot < count; slot++)
+		{
+			if (newSlots[slot] != NoParent || !m_Alive[slot])
+				continue;
+
+			NodeRecord& record = m_Records[m_SlotRecords[slot]];
+			record.Alive = false;
+			record.Generation++;
+			m_FreeRecords.push_back(m_SlotRecords[slot]);
+		}
+
+		for (std::vector<float>& stream : m_Translation)
+			Permute(stream, order);
+		for (std::vector<float>& stream : m_Rotation)
+			Permute(stream, order);
+		for (std::vector<float>& stream : m_Scale)
+			Permute(stream, order);
+		Permute(m_LocalMatrices, order);
+		Permute(m_WorldMatrices, order);
+		Permute(m_SlotRecords, order);
+		Permute(m_Dirty, order);
+		Permute(m_Parents, order);
+		for (uint32_t& parent : m_Parents)
+		{
+			if (parent != NoParent)
+				parent = newSlots[parent];
+		}
+
+		// BFS keeps every node's children contiguous and in the order of their parents
+		m_ChildStarts.resize(order.size() + 1);
+		uint32_t nextChild = m_LevelStarts.size() > 1 ? m_LevelStarts[1] : 0;
+		for (uint32_t slot = 0; slot < order.size(); slot++)
+		{
+			m_ChildStarts[slot] = nextChild;
+			nextChild += childStarts[order[slot] + 1] - childStarts[order[slot]];
+		}
+		m_ChildStarts[order.size()] = nextChild;
+
+		m_SubtreeSizes.assign(order.size(), 1);
+		for (uint32_t slot = (uint32_t)order.size(); slot-- > 0;)
+		{
+			if (m_Parents[slot] != NoParent)
+				m_SubtreeSizes[m_Parents[slot]] += m_SubtreeSizes[slot];
+		}
+
+		m_Alive.assign(order.size(), 1);
+		m_Changed.assign(order.size(), 0);
+		m_DirtySlots.clear();
+		for (uint32_t slot = 0; slot < order.size(); slot++)
+		{
+			m_Records[m_SlotRecords[slot]].Slot = slot;
+			if (m_Dirty[slot])
+				m_DirtySlots.push_back(slot);
+		}
+
+		m_StructureChanged = false;
+		m_Stats.Rebuilds++;
+	}
+
+	void TransformHierarchy::Update()
+	{
+		RE_PROFILE_FUNC();
+		if (m_StructureChanged)
+			Rebuild();
+
+		m_Stats.Nodes = (uint32_t)m_Parents.size();
+		m_Stats.Levels = (uint32_t)m_LevelStarts.size() - 1;
+		m_Stats.UpdatedNodes = 0;
+		if (m_DirtySlots.empty())
+			return;
+
+		// Bounded by the subtree sizes, nodes under two dirty ancestors count twice
+		uint32_t estimate = 0;
+		for (uint32_t slot : m_DirtySlots)
+			estimate += m_SubtreeSizes[slot];
+		if (estimate < s_ParallelLevelSize)
+		{
+			m_Stats.UpdatedNodes = UpdateSubtrees();
+			m_DirtySlots.clear();
+			return;
+		}
+
+		// Nothing above the shallowest dirty node can change, and below the deepest one only
+		// levels under a changed parent can
+		auto [lowest, highest] = std::minmax_element(m_DirtySlots.begin(), m_DirtySlots.end());
+		uint32_t firstLevel = (uint32_t)(std::upper_bound(m_LevelStarts.begin(), m_LevelStarts.end(), *lowest) - m_LevelStarts.begin()) - 1;
+		uint32_t lastDirtyLevel = (uint32_t)(std::upper_bound(m_LevelStarts.begin(), m_LevelStarts.end(), *highest) - m_LevelStarts.begin()) - 1;
+
+		uint32_t level = firstLevel;
+		for (; level < m_Stats.Levels; level++)
+		{
+			uint32_t begin = m_LevelStarts[level], end = m_LevelStarts[level + 1];
+			uint32_t changed = 0;
+			if (end - begin < s_ParallelLevelSize)
+			{
+				changed = UpdateRange(begin, end);
+			}
+			else
+			{
+				std::atomic<uint32_t> parallelChanged{ 0 };
+				JobSystem::ParallelFor(end - begin, JobSystem::GetDefaultGrainSize(end - begin, 1024), [&](uint32_t rangeBegin, uint32_t rangeEnd)
+				{
+					parallelChanged.fetch_add(UpdateRange(begin + rangeBegin, begin + rangeEnd), std::memory_order_relaxed);
+				});
+				changed = parallelChanged.load(std::memory_order_relaxed);
+			}
+
+			m_Stats.UpdatedNodes += changed;
+			if (changed == 0 && level >= lastDirtyLevel)
+			{
+				level++;
+				break;
+			}
+		}
+
+		// m_Changed is all zero between updates
+		uint32_t touchedEnd = m_LevelStarts[std::min(level, m_Stats.Levels)];
+		std::memset(m_Changed.data() + m_LevelStarts[firstLevel], 0, touchedEnd - m_LevelStarts[firstLevel]);
+		m_DirtySlots.clear();
+	}
+
+	uint32_t TransformHierarchy::UpdateRange(uint32_t begin, uint32_t end)
+	{
+		uint32_t changed = 0;
+		for (uint32_t slot = begin; slot < end;)
+		{
+			// Runs of locally changed nodes get their matrices from the batch kernel
+			uint32_t runEnd = slot;
+			while (runEnd < end && m_Dirty[runEnd])
+				runEnd++;
+			if (runEnd > slot)
+			{
+				ConstVec3Stream translations(m_Translation[0].data() + slot, m_Translation[1].data() + slot, m_Translation[2].data() + slot);
+				ConstQuatStream rotations = { m_Rotation[0].data() + slot, m_Rotation[1].data() + slot, m_Rotation[2].data() + slot, m_Rotation[3].data() + slot };
+				ConstVec3Stream scales(m_Scale[0].data() + slot, m_Scale[1].data() + slot, m_Scale[2].data() + slot);
+				Batch::BuildTRS(translations, rotations, scales, m_LocalMatrices.data() + slot, runEnd - slot);
+
+				for (; slot < runEnd; slot++)
+				{
+					uint32_t parent = m_Parents[slot];
+					m_WorldMatrices[slot] = parent == NoParent ? m_LocalMatrices[slot] : m_WorldMatrices[parent] * m_LocalMatrices[slot];
+					m_Dirty[slot] = 0;
+					m_Changed[slot] = 1;
+					changed++;
+				}
+				continue;
+			}
+
+			uint32_t parent = m_Parents[slot];
+			if (parent != NoParent && m_Changed[parent])
+			{
+				m_WorldMatrices[slot] = m_WorldMatrices[parent] * m_LocalMatrices[slot];
+				m_Changed[slot] = 1;
+				changed++;
+			}
+			slot++;
+		}
+		return changed;
+	}
+
+	// Depth first from each dirty node. Slots are sorted by depth, so ancestors come first and
+	// a dirty node they already reached is skipped.
+	uint32_t TransformHierarchy::UpdateSubtrees()
+	{
+		std::sort(m_DirtySlots.begin(), m_DirtySlots.end());
+
+		uint32_t changed = 0;
+		for (uint32_t dirty : m_DirtySlots)
+		{
+			if (!m_Dirty[dirty])
+				continue;
+
+			m_Stack.push_back(dirty);
+			while (!m_Stack.empty())
+			{
+				uint32_t slot = m_Stack.back();
+				m_Stack.pop_back();
+
+				if (m_Dirty[slot])
+				{
+					ConstVec3Stream translation(&m_Translation[0][slot], &m_Translation[1][slot], &m_Translation[2][slot]);
+					ConstQuatStream rotation = { &m_Rotation[0][slot], &m_Rotation[1][slot], &m_Rotation[2][slot], &m_Rotation[3][slot] };
+					ConstVec3Stream scale(&m_Scale[0][slot], &m_Scale[1][slot], &m_Scale[2][slot]);
+					Batch::BuildTRS(translation, rotation, scale, &m_LocalMatrices[slot], 1);
+					m_Dirty[slot] = 0;
+				}
+
+				uint32_t parent = m_Parents[slot];
+				m_WorldMatrices[slot] = parent == NoParent ? m_LocalMatrices[slot] : m_WorldMatrices[parent] * m_LocalMatrices[slot];
+				changed++;
+
+				for (uint32_t child = m_ChildStarts[slot]; child < m_ChildStarts[slot + 1]; child++)
+					m_Stack.push_back(child);
+			}
+		}
+		return changed;
+	}
+
+	static std::mutex s_HierarchyMutex;
+	static std::vector<TransformHierarchy*> s_Hierarchies;
+
+	void TransformSystem::Register(TransformHierarchy* hierarchy)
+	{
+		std::lock_guard<std::mutex> lock(s_HierarchyMutex);
+		s_Hierarchies.push_back(hierarchy);
+	}
+
+	void TransformSystem::Unregister(TransformHierarchy* hierarchy)
+	{
+		std::lock_guard<std::mutex> lock(s_HierarchyMutex);
+		s_Hierarchies.erase(std::find(s_Hierarchies.begin(), s_Hierarchies.end(), hierarchy));
+	}
+
+	void TransformSystem::Update()
+	{
+		RE_PROFILE_FUNC();
+		std::lock_guard<std::mutex> lock(s_HierarchyMutex);
+		for (TransformHierarchy* hierarchy : s_Hierarchies)
+			hierarchy->Update();
+	}
+}
\ No newline at end of file
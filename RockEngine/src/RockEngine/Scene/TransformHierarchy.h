@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "RockEngine/Math/Math.h"
+
+namespace RockEngine
+{
+	// Handle to a node of a TransformHierarchy, see Entity for the generation scheme
+	struct TransformNode
+	{
+		uint32_t Index = ~0u;
+		uint32_t Generation = 0;
+
+		inline bool IsNull() const { return Index == ~0u; }
+
+		inline bool operator==(const TransformNode& other) const { return Index == other.Index && Generation == other.Generation; }
+		inline bool operator!=(const TransformNode& other) const { return !(*this == other); }
+	};
+
+	struct TransformHierarchyStats
+	{
+		uint32_t Nodes = 0;
+		uint32_t Levels = 0;
+		uint32_t UpdatedNodes = 0;		// world matrices recomputed by the last Update
+		uint32_t Rebuilds = 0;			// sorts after structural changes, since creation
+	};
+
+	// Local TRS and world matrices of a forest of nodes, in flat arrays sorted by depth: all roots,
+	// then all their children, and so on, siblings next to each other. Parents always come first,
+	// so Update is one pass per level, and the nodes of one level are independent subtrees that
+	// are spread over the job system.
+	//
+	// Only dirty nodes and their descendants are recomputed: a few small subtrees are walked
+	// directly, anything larger goes level by level. Structural changes (create, destroy,
+	// reparent) append or flag and are sorted in once, by the next Update.
+	class TransformHierarchy
+	{
+	public:
+		TransformHierarchy();
+		~TransformHierarchy();
+
+		TransformHierarchy(const TransformHierarchy&) = delete;
+		TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+
+		// Identity local transform. `parent` null makes a root.
+		TransformNode Create(TransformNode parent = {});
+		// The node's descendants go with it on the next Update
+		void Destroy(TransformNode node);
+		bool IsAlive(TransformNode node) const;
+
+		// Returns false (and changes nothing) if `parent` is the node or one of its descendants
+		bool SetParent(TransformNode node, TransformNode parent);
+		TransformNode GetParent(TransformNode node) const;
+
+		void SetLocal(TransformNode node, const Vec3& translation, const Quat& rotation, const Vec3& scale);
+		void SetTranslation(TransformNode node, const Vec3& translation);
+		void SetRotation(TransformNode node, const Quat& rotation);
+		void SetScale(TransformNode node, const Vec3& scale);
+
+		Vec3 GetTranslation(TransformNode node) const;
+		Quat GetRotation(TransformNode node) const;
+		Vec3 GetScale(TransformNode node) const;
+
+		// As of the last Update
+		const Mat4& GetWorld(TransformNode node) const;
+
+		// Sorts in pending structural changes and recomputes the dirty subtrees. Called for every
+		// hierarchy by TransformSystem::Update; call it directly to read world matrices earlier.
+		void Update();
+
+		inline bool IsDirty() const { return m_StructureChanged || !m_DirtySlots.empty(); }
+		inline const TransformHierarchyStats& GetStats() const { return m_Stats; }
+	private:
+		static constexpr uint32_t NoParent = ~0u;
+
+		struct NodeRecord
+		{
+			uint32_t Slot = 0;
+			uint32_t Generation = 0;
+			bool Alive = false;
+		};
+
+		inline uint32_t GetSlot(TransformNode node) const { return m_Records[node.Index].Slot; }
+		void MarkDirty(uint32_t slot);
+
+		void Rebuild();
+		// Return how many world matrices they recomputed
+		uint32_t UpdateRange(uint32_t begin, uint32_t end);
+		uint32_t UpdateSubtrees();
+	private:
+		std::vector<NodeRecord> m_Records;
+		std::vector<uint32_t> m_FreeRecords;
+
+		// Per slot, in depth order once sorted; new nodes are appended until the next Update
+		std::vector<float> m_Translation[3];
+		std::vector<float> m_Rotation[4];
+		std::vector<float> m_Scale[3];
+		std::vector<Mat4> m_LocalMatrices;
+		std::vector<Mat4> m_WorldMatrices;
+		std::vector<uint32_t> m_Parents;		// slot, NoParent for roots
+		std::vector<uint32_t> m_SlotRecords;	// back to m_Records
+		std::vector<uint8_t> m_Alive;
+		std::vector<uint8_t> m_Dirty;			// local transform changed
+		std::vector<uint8_t> m_Changed;			// world matrix recomputed by the running Update
+
+		std::vector<uint32_t> m_LevelStarts = { 0 };	// first slot of each level, plus the end
+		std::vector<uint32_t> m_ChildStarts = { 0 };	// children of slot n are [m_ChildStarts[n], m_ChildStarts[n + 1])
+		std::vector<uint32_t> m_SubtreeSizes;
+		std::vector<uint32_t> m_DirtySlots;
+		std::vector<uint32_t> m_Stack;
+		bool m_StructureChanged = false;
+
+		TransformHierarchyStats m_Stats;
+	};
+
+	// Updates every live TransformHierarchy once per frame, after the layers' updates and before
+	// the frame is presented (see Application::Run)
+	class TransformSystem
+	{
+	public:
+		static void Update();
+	private:
+		static void Register(TransformHierarchy* hierarchy);
+		static void Unregister(TransformHierarchy* hierarchy);
+
+		friend class TransformHierarchy;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+#include "RockEngine/Math/Math.h"
+
+namespace RockEngine
+{
+	// Axis aligned box. Default constructed it's empty (inverted), so merging into it works.
+	struct AABB
+	{
+		Vec3 Min = Vec3(std::numeric_limits<float>::max());
+		Vec3 Max = Vec3(-std::numeric_limits<float>::max());
+
+		AABB() = default;
+		AABB(const Vec3& min, const Vec3& max) : Min(min), Max(max) {}
+
+		static AABB FromCenterExtents(const Vec3& center, const Vec3& extents) { return AABB(center - extents, center + extents); }
+
+		inline bool IsEmpty() const { return Min.GetX() > Max.GetX() || Min.GetY() > Max.GetY() || Min.GetZ() > Max.GetZ(); }
+		inline Vec3 GetCenter() const { return (Min + Max) * 0.5f; }
+		inline Vec3 GetExtents() const { return (Max - Min) * 0.5f; }
+
+		// Half the surface area, which is all the SAH needs
+		inline float GetArea() const
+		{
+			Vec3 size = Max - Min;
+			return size.GetX() * size.GetY() + size.GetY() * size.GetZ() + size.GetZ() * size.GetX();
+		}
+
+		inline bool Contains(const AABB& other) const
+		{
+			return Min.GetX() <= other.Min.GetX() && Min.GetY() <= other.Min.GetY() && Min.GetZ() <= other.Min.GetZ()
+				&& Max.GetX() >= other.Max.GetX() && Max.GetY() >= other.Max.GetY() && Max.GetZ() >= other.Max.GetZ();
+		}
+
+		inline AABB Expanded(float margin) const { return AABB(Min - Vec3(margin), Max + Vec3(margin)); }
+	};
+
+	inline AABB Union(const AABB& a, const AABB& b) { return AABB(Min(a.Min, b.Min), Max(a.Max, b.Max)); }
+
+	// Six planes (left, right, bottom, top, near, far) with unit normals pointing inwards:
+	// a point p is inside a plane if dot(normal, p) + distance >= 0
+	struct Frustum
+	{
+		static constexpr uint32_t PlaneCount = 6;
+		Vec4 Planes[PlaneCount];
+
+		// From a column-major, OpenGL convention (clip z in [-w, w]) view projection matrix
+		static Frustum FromViewProjection(const Mat4& viewProjection)
+		{
+			Frustum frustum;
+			Vec4 rows[4];
+			for (uint32_t row = 0; row < 4; row++)
+				rows[row] = Vec4(viewProjection.Get(row, 0), viewProjection.Get(row, 1), viewProjection.Get(row, 2), viewProjection.Get(row, 3));
+
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				frustum.Planes[axis * 2] = rows[3] + rows[axis];
+				frustum.Planes[axis * 2 + 1] = rows[3] - rows[axis];
+			}
+			for (Vec4& plane : frustum.Planes)
+				plane = plane * (1.0f / Length(plane.GetXYZ()));
+			return frustum;
+		}
+
+		// Scalar reference of the CullingKernels test: false only if the box is entirely outside
+		// one of the planes. Conservative near the frustum's corners, like every plane test.
+		bool Intersects(const AABB& box) const
+		{
+			for (const Vec4& plane : Planes)
+			{
+				float nx = plane.GetX(), ny = plane.GetY(), nz = plane.GetZ();
+				// The corner furthest along the normal
+				float px = nx > 0.0f ? box.Max.GetX() : box.Min.GetX();
+				float py = ny > 0.0f ? box.Max.GetY() : box.Min.GetY();
+				float pz = nz > 0.0f ? box.Max.GetZ() : box.Min.GetZ();
+				if (nx * px + ny * py + nz * pz + plane.GetW() < 0.0f)
+					return false;
+			}
+			return true;
+		}
+	};
+
+	// Direction doesn't have to be normalized, distances are in multiples of it
+	struct Ray
+	{
+		Vec3 Origin;
+		Vec3 Direction;
+		Vec3 InverseDirection;
+
+		Ray(const Vec3& origin, const Vec3& direction)
+			: Origin(origin), Direction(direction)
+		{
+			// Zero components become tiny ones: the slab test stays finite and NaN free
+			auto inverse = [](float d) { return 1.0f / (std::abs(d) < 1e-20f ? (d < 0.0f ? -1e-20f : 1e-20f) : d); };
+			InverseDirection = Vec3(inverse(direction.GetX()), inverse(direction.GetY()), inverse(direction.GetZ()));
+		}
+
+		inline Vec3 GetPoint(float t) const { return Origin + Direction * t; }
+
+		// Scalar reference of the CullingKernels slab test. On a hit within [0, maxT], t is where
+		// the ray enters the box (0 if it starts inside).
+		bool Intersects(const AABB& box, float maxT, float& t) const
+		{
+			float origin[3] = { Origin.GetX(), Origin.GetY(), Origin.GetZ() };
+			float inverse[3] = { InverseDirection.GetX(), InverseDirection.GetY(), InverseDirection.GetZ() };
+			float min[3] = { box.Min.GetX(), box.Min.GetY(), box.Min.GetZ() };
+			float max[3] = { box.Max.GetX(), box.Max.GetY(), box.Max.GetZ() };
+
+			float tNear = 0.0f, tFar = maxT;
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				float nearSide = inverse[axis] >= 0.0f ? min[axis] : max[axis];
+				float farSide = inverse[axis] >= 0.0f ? max[axis] : min[axis];
+				tNear = std::max(tNear, (nearSide - origin[axis]) * inverse[axis]);
+				tFar = std::min(tFar, (farSide - origin[axis]) * inverse[axis]);
+			}
+
+			t = tNear;
+			return tNear <= tFar;
+		}
+	};
+
+	struct RayHit
+	{
+		uint32_t Object = ~0u;		// the user value the box was inserted with
+		float T = std::numeric_limits<float>::max();
+	};
+}
\ No newline at end of file
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <type_traits>
+
+#include "RockEngine/Spatial/Bounds.h"
+
+namespace RockEngine
+{
+	// Structure-of-arrays boxes: box n is (MinX[n], MinY[n], MinZ[n]) - (MaxX[n], MaxY[n], MaxZ[n])
+	struct ConstBoxStream
+	{
+		const float* MinX;
+		const float* MinY;
+		const float* MinZ;
+		const float* MaxX;
+		const float* MaxY;
+		const float* MaxZ;
+	};
+
+	// Frustum and ray tests of a register's worth of boxes at once, returning one bit per lane.
+	// The lane tests work on 4 or 8 lane registers (the BVH's node width picks one), the brute
+	// force loops over whole arrays use 8. Results match the scalar Frustum/Ray tests exactly,
+	// except for rounding where FMA is enabled.
+	template<typename Backend>
+	class CullingKernels
+	{
+	public:
+		using Float4 = typename SimdTraits<Backend>::Float4;
+		using Float8 = typename SimdTraits<Backend>::Float8;
+
+		template<uint32_t Width>
+		using Float = std::conditional_t<Width == 8, Float8, Float4>;
+
+		// A frustum splatted once per query. Corner selects which box corner is furthest along
+		// each plane's normal: bit 0 for x, 1 for y, 2 for z set where the max side is.
+		template<typename F>
+		struct FrustumLanes
+		{
+			F X[Frustum::PlaneCount], Y[Frustum::PlaneCount], Z[Frustum::PlaneCount], W[Frustum::PlaneCount];
+			uint32_t Corner[Frustum::PlaneCount];
+		};
+
+		template<typename F>
+		struct RayLanes
+		{
+			F Origin[3];
+			F Inverse[3];
+			bool Positive[3];
+		};
+
+		template<typename F>
+		static FrustumLanes<F> SplatFrustum(const Frustum& frustum)
+		{
+			FrustumLanes<F> lanes;
+			for (uint32_t p = 0; p < Frustum::PlaneCount; p++)
+			{
+				const Vec4& plane = frustum.Planes[p];
+				lanes.X[p] = F::Splat(plane.GetX());
+				lanes.Y[p] = F::Splat(plane.GetY());
+				lanes.Z[p] = F::Splat(plane.GetZ());
+				lanes.W[p] = F::Splat(plane.GetW());
+				lanes.Corner[p] = (plane.GetX() > 0.0f ? 1 : 0) | (plane.GetY() > 0.0f ? 2 : 0) | (plane.GetZ() > 0.0f ? 4 : 0);
+			}
+			return lanes;
+		}
+
+		template<typename F>
+		static RayLanes<F> SplatRay(const Ray& ray)
+		{
+			float origin[3] = { ray.Origin.GetX(), ray.Origin.GetY(), ray.Origin.GetZ() };
+			float inverse[3] = { ray.InverseDirection.GetX(), ray.InverseDirection.GetY(), ray.InverseDirection.GetZ() };
+
+			RayLanes<F> lanes;
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				lanes.Origin[axis] = F::Splat(origin[axis]);
+				lanes.Inverse[axis] = F::Splat(inverse[axis]);
+				lanes.Positive[axis] = inverse[axis] >= 0.0f;
+			}
+			return lanes;
+		}
+
+		// `bounds` points to the MinX, MinY, MinZ, MaxX, MaxY, MaxZ of F::Width boxes. Returns the
+		// lanes that intersect the frustum, `inside` gets the ones entirely inside it.
+		template<typename F>
+		static uint32_t TestFrustum(const FrustumLanes<F>& frustum, const float* const* bounds, uint32_t& inside)
+		{
+			F min[3] = { F::Load(bounds[0]), F::Load(bounds[1]), F::Load(bounds[2]) };
+			F max[3] = { F::Load(bounds[3]), F::Load(bounds[4]), F::Load(bounds[5]) };
+			F zero = F::Zero();
+
+			uint32_t outside = 0, crossing = 0;
+			for (uint32_t p = 0; p < Frustum::PlaneCount; p++)
+			{
+				uint32_t corner = frustum.Corner[p];
+				const F& farX = corner & 1 ? max[0] : min[0];
+				const F& farY = corner & 2 ? max[1] : min[1];
+				const F& farZ = corner & 4 ? max[2] : min[2];
+				const F& nearX = corner & 1 ? min[0] : max[0];
+				const F& nearY = corner & 2 ? min[1] : max[1];
+				const F& nearZ = corner & 4 ? min[2] : max[2];
+
+				F farDistance = MulAdd(frustum.Z[p], farZ, MulAdd(frustum.Y[p], farY, frustum.X[p] * farX)) + frustum.W[p];
+				F nearDistance = MulAdd(frustum.Z[p], nearZ, MulAdd(frustum.Y[p], nearY, frustum.X[p] * nearX)) + frustum.W[p];
+				outside |= CompareLess(farDistance, zero);
+				crossing |= CompareLess(nearDistance, zero);
+			}
+
+			constexpr uint32_t all = (1u << F::Width) - 1;
+			inside = ~(outside | crossing) & all;
+			return ~outside & all;
+		}
+
+		// Returns the lanes the ray hits within [0, maxT], `entry` gets where it enters each box
+		template<typename F>
+		static uint32_t TestRay(const RayLanes<F>& ray, const float* const* bounds, const F& maxT, F& entry)
+		{
+			F tNear = F::Zero(), tFar = maxT;
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				F min = F::Load(bounds[axis]), max = F::Load(bounds[3 + axis]);
+				const F& nearSide = ray.Positive[axis] ? min : max;
+				const F& farSide = ray.Positive[axis] ? max : min;
+				tNear = Max(tNear, (nearSide - ray.Origin[axis]) * ray.Inverse[axis]);
+				tFar = Min(tFar, (farSide - ray.Origin[axis]) * ray.Inverse[axis]);
+			}
+
+			entry = tNear;
+			return CompareLessEqual(tNear, tFar);
+		}
+
+		// Brute force: writes the indices of the boxes intersecting the frustum, returns how many
+		static uint32_t CullBoxes(const ConstBoxStream& boxes, uint32_t count, const Frustum& frustum, uint32_t* visible)
+		{
+			FrustumLanes<Float8> lanes = SplatFrustum<Float8>(frustum);
+			uint32_t visibleCount = 0;
+			ForEachBlock(boxes, count, [&](const float* const* bounds, uint32_t first, uint32_t valid)
+			{
+				uint32_t inside;
+				uint32_t mask = TestFrustum(lanes, bounds, inside) & valid;
+				visibleCount += WriteLanes(mask, first, visible + visibleCount);
+			});
+			return visibleCount;
+		}
+
+		// Brute force: the closest box the ray hits within [0, maxT]
+		static bool Raycast(const ConstBoxStream& boxes, uint32_t count, const Ray& ray, float maxT, RayHit& hit)
+		{
+			RayLanes<Float8> lanes = SplatRay<Float8>(ray);
+			hit = RayHit();
+			hit.T = maxT;
+			ForEachBlock(boxes, count, [&](const float* const* bounds, uint32_t first, uint32_t valid)
+			{
+				Float8 entry;
+				uint32_t mask = TestRay(lanes, bounds, Float8::Splat(hit.T), entry) & valid;
+				if (!mask)
+					return;
+
+				float t[8];
+				entry.Store(t);
+				for (; mask; mask &= mask - 1)
+				{
+					uint32_t lane = CountTrailingZeros(mask);
+					if (t[lane] < hit.T || hit.Object == ~0u)
+						hit = { first + lane, t[lane] };
+				}
+			});
+			return hit.Object != ~0u;
+		}
+
+		// Writes first + i for every set bit i of `mask`, returns how many
+		static inline uint32_t WriteLanes(uint32_t mask, uint32_t first, uint32_t* out)
+		{
+			uint32_t count = 0;
+			for (; mask; mask &= mask - 1)
+				out[count++] = first + CountTrailingZeros(mask);
+			return count;
+		}
+	private:
+		// Calls func(bounds, first, validLanes) for every 8 boxes, the tail from a padded copy
+		template<typename Func>
+		static void ForEachBlock(const ConstBoxStream& boxes, uint32_t count, Func&& func)
+		{
+			const float* streams[6] = { boxes.MinX, boxes.MinY, boxes.MinZ, boxes.MaxX, boxes.MaxY, boxes.MaxZ };
+			uint32_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				const float* bounds[6];
+				for (uint32_t k = 0; k < 6; k++)
+					bounds[k] = streams[k] + i;
+				func(bounds, i, 0xFFu);
+			}
+
+			if (i < count)
+			{
+				float padded[6][8] = {};
+				const float* bounds[6];
+				for (uint32_t k = 0; k < 6; k++)
+				{
+					std::copy(streams[k] + i, streams[k] + count, padded[k]);
+					bounds[k] = padded[k];
+				}
+				func(bounds, i, (1u << (count - i)) - 1);
+			}
+		}
+	};
+
+	using Culling = CullingKernels<SimdDefault>;
+}
\ No newline at end of file
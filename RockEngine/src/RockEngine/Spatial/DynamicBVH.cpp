@@ -0,0 +1,397 @@
+#include "pch.h"
+#include "DynamicBVH.h"
+
+#include "RockEngine/Memory/MemoryTracker.h"
+
+namespace RockEngine
+{
+	static constexpr uint32_t s_BuildBins = 16;
+	// Below this depth Rebuild splits at the median instead, so degenerate inputs can't make the
+	// tree deeper than the query stacks
+	static constexpr uint32_t s_MaxSAHDepth = 40;
+
+	DynamicBVH::DynamicBVH(float margin /* = 0.1f */)
+		: m_Margin(margin)
+	{
+	}
+
+	uint32_t DynamicBVH::Insert(const AABB& bounds, uint32_t userData)
+	{
+		uint32_t proxy = AllocateNode();
+		Node& node = m_Nodes[proxy];
+		node.Bounds = bounds.Expanded(m_Margin);
+		node.ObjectBounds = bounds;
+		node.UserData = userData;
+		node.Height = 0;
+
+		InsertLeaf(proxy);
+		m_ProxyCount++;
+		m_Version++;
+		return proxy;
+	}
+
+	void DynamicBVH::Remove(uint32_t proxy)
+	{
+		RE_CORE_ASSERT(proxy < m_Nodes.size() && m_Nodes[proxy].Height == 0, "DynamicBVH::Remove on something that isn't a proxy");
+		RemoveLeaf(proxy);
+		FreeNode(proxy);
+		m_ProxyCount--;
+		m_Version++;
+	}
+
+	bool DynamicBVH::Move(uint32_t proxy, const AABB& bounds)
+	{
+		RE_CORE_ASSERT(proxy < m_Nodes.size() && m_Nodes[proxy].Height == 0, "DynamicBVH::Move on something that isn't a proxy");
+		Node& node = m_Nodes[proxy];
+		node.ObjectBounds = bounds;
+		m_Version++;
+		if (node.Bounds.Contains(bounds))
+			return false;
+
+		RemoveLeaf(proxy);
+		m_Nodes[proxy].Bounds = bounds.Expanded(m_Margin);
+		InsertLeaf(proxy);
+		return true;
+	}
+
+	void DynamicBVH::SetBounds(uint32_t proxy, const AABB& bounds)
+	{
+		RE_CORE_ASSERT(proxy < m_Nodes.size() && m_Nodes[proxy].Height == 0, "DynamicBVH::SetBounds on something that isn't a proxy");
+		Node& node = m_Nodes[proxy];
+		node.ObjectBounds = bounds;
+		node.Bounds = bounds.Expanded(m_Margin);
+		m_NeedsRefit = true;
+		m_Version++;
+	}
+
+	// Reversed preorder visits children before their parents
+	void DynamicBVH::Refit()
+	{
+		RE_PROFILE_FUNC();
+		m_NeedsRefit = false;
+		if (m_Root == Null)
+			return;
+
+		m_Scratch.clear();
+		m_Scratch.push_back(m_Root);
+		for (size_t i = 0; i < m_Scratch.size(); i++)
+		{
+			const Node& node = m_Nodes[m_Scratch[i]];
+			if (!node.IsLeaf())
+			{
+				m_Scratch.push_back(node.Children[0]);
+				m_Scratch.push_back(node.Children[1]);
+			}
+		}
+
+		for (size_t i = m_Scratch.size(); i-- > 0;)
+		{
+			Node& node = m_Nodes[m_Scratch[i]];
+			if (!node.IsLeaf())
+				node.Bounds = Union(m_Nodes[node.Children[0]].Bounds, m_Nodes[node.Children[1]].Bounds);
+		}
+		m_Version++;
+	}
+
+	void DynamicBVH::Rebuild()
+	{
+		RE_PROFILE_FUNC();
+		RE_MEMORY_SCOPE("Spatial");
+
+		m_Scratch.clear();
+		for (uint32_t i = 0; i < m_Nodes.size(); i++)
+		{
+			if (m_Nodes[i].Height == 0)
+				m_Scratch.push_back(i);
+			else if (m_Nodes[i].Height > 0)
+				FreeNode(i);
+		}
+
+		m_Root = m_Scratch.empty() ? Null : BuildRange(m_Scratch.data(), (uint32_t)m_Scratch.size(), 0);
+		if (m_Root != Null)
+			m_Nodes[m_Root].Parent = Null;
+		m_NeedsRefit = false;
+		m_Version++;
+	}
+
+	float DynamicBVH::GetCost() const
+	{
+		if (m_Root == Null)
+			return 0.0f;
+
+		float area = 0.0f;
+		for (const Node& node : m_Nodes)
+		{
+			if (node.Height > 0)
+				area += node.Bounds.GetArea();
+		}
+		return area / std::max(m_Nodes[m_Root].Bounds.GetArea(), 1e-30f);
+	}
+
+	uint32_t DynamicBVH::AllocateNode()
+	{
+		uint32_t index;
+		if (m_FreeList != Null)
+		{
+			index = m_FreeList;
+			m_FreeList = m_Nodes[index].Parent;
+			m_Nodes[index] = Node();
+		}
+		else
+		{
+			RE_MEMORY_SCOPE("Spatial");
+			index = (uint32_t)m_Nodes.size();
+			m_Nodes.emplace_back();
+		}
+		return index;
+	}
+
+	void DynamicBVH::FreeNode(uint32_t index)
+	{
+		Node& node = m_Nodes[index];
+		node.Height = -1;
+		node.Children[0] = node.Children[1] = Null;
+		node.Parent = m_FreeList;
+		m_FreeList = index;
+	}
+
+	void DynamicBVH::InsertLeaf(uint32_t leaf)
+	{
+		if (m_Root == Null)
+		{
+			m_Root = leaf;
+			m_Nodes[leaf].Parent = Null;
+			return;
+		}
+
+		// Descend while going into a child is cheaper than pairing the leaf with this node. Both
+		// options pay for growing the ancestors, entering a child also for growing that child.
+		AABB leafBounds = m_Nodes[leaf].Bounds;
+		uint32_t index = m_Root;
+		while (!m_Nodes[index].IsLeaf())
+		{
+			const Node& node = m_Nodes[index];
+			float area = node.Bounds.GetArea();
+			float combinedArea = Union(node.Bounds, leafBounds).GetArea();
+
+			float cost = 2.0f * combinedArea;
+			float inheritanceCost = 2.0f * (combinedArea - area);
+
+			float childCosts[2];
+			for (uint32_t i = 0; i < 2; i++)
+			{
+				const Node& child = m_Nodes[node.Children[i]];
+				float childArea = Union(leafBounds, child.Bounds).GetArea();
+				childCosts[i] = (child.IsLeaf() ? childArea : childArea - child.Bounds.GetArea()) + inheritanceCost;
+			}
+
+			if (cost < childCosts[0] && cost < childCosts[1])
+				break;
+			index = childCosts[0] < childCosts[1] ? node.Children[0] : node.Children[1];
+		}
+
+		uint32_t sibling = index;
+		uint32_t oldParent = m_Nodes[sibling].Parent;
+		uint32_t newParent = AllocateNode();
+
+		Node& parent = m_Nodes[newParent];
+		parent.Parent = oldParent;
+		parent.Bounds = Union(leafBounds, m_Nodes[sibling].Bounds);
+		parent.Height = m_Nodes[sibling].Height + 1;
+		parent.Children[0] = sibling;
+		parent.Children[1] = leaf;
+
+		if (oldParent != Null)
+		{
+			Node& grandparent = m_Nodes[oldParent];
+			grandparent.Children[grandparent.Children[0] == sibling ? 0 : 1] = newParent;
+		}
+		else
+		{
+			m_Root = newParent;
+		}
+		m_Nodes[sibling].Parent = newParent;
+		m_Nodes[leaf].Parent = newParent;
+
+		FixUpwards(newParent);
+	}
+
+	void DynamicBVH::RemoveLeaf(uint32_t leaf)
+	{
+		if (leaf == m_Root)
+		{
+			m_Root = Null;
+			return;
+		}
+
+		uint32_t parent = m_Nodes[leaf].Parent;
+		uint32_t grandparent = m_Nodes[parent].Parent;
+		uint32_t sibling = m_Nodes[parent].Children[0] == leaf ? m_Nodes[parent].Children[1] : m_Nodes[parent].Children[0];
+
+		m_Nodes[sibling].Parent = grandparent;
+		FreeNode(parent);
+		if (grandparent == Null)
+		{
+			m_Root = sibling;
+			return;
+		}
+
+		Node& node = m_Nodes[grandparent];
+		node.Children[node.Children[0] == parent ? 0 : 1] = sibling;
+		FixUpwards(grandparent);
+	}
+
+	void DynamicBVH::FixUpwards(uint32_t index)
+	{
+		while (index != Null)
+		{
+			index = Balance(index);
+
+			Node& node = m_Nodes[index];
+			const Node& left = m_Nodes[node.Children[0]];
+			const Node& right = m_Nodes[node.Children[1]];
+			node.Height = 1 + std::max(left.Height, right.Height);
+			node.Bounds = Union(left.Bounds, right.Bounds);
+			index = node.Parent;
+		}
+	}
+
+	uint32_t DynamicBVH::Balance(uint32_t a)
+	{
+		Node& nodeA = m_Nodes[a];
+		if (nodeA.IsLeaf() || nodeA.Height < 2)
+			return a;
+
+		uint32_t b = nodeA.Children[0];
+		uint32_t c = nodeA.Children[1];
+		int32_t balance = m_Nodes[c].Height - m_Nodes[b].Height;
+		if (balance >= -1 && balance <= 1)
+			return a;
+
+		// `up` (the taller child) takes a's place, a keeps its other child plus the shorter of
+		// up's children, up keeps its taller one
+		uint32_t upSide = balance > 1 ? 1 : 0;
+		uint32_t up = nodeA.Children[upSide];
+		uint32_t stay = nodeA.Children[1 - upSide];
+		Node& nodeUp = m_Nodes[up];
+
+		uint32_t f = nodeUp.Children[0];
+		uint32_t g = nodeUp.Children[1];
+		uint32_t taller = m_Nodes[f].Height > m_Nodes[g].Height ? f : g;
+		uint32_t shorter = taller == f ? g : f;
+
+		nodeUp.Parent = nodeA.Parent;
+		nodeA.Parent = up;
+		if (nodeUp.Parent != Null)
+		{
+			Node& parent = m_Nodes[nodeUp.Parent];
+			parent.Children[parent.Children[0] == a ? 0 : 1] = up;
+		}
+		else
+		{
+			m_Root = up;
+		}
+
+		nodeA.Children[upSide] = shorter;
+		m_Nodes[shorter].Parent = a;
+		nodeA.Bounds = Union(m_Nodes[stay].Bounds, m_Nodes[shorter].Bounds);
+		nodeA.Height = 1 + std::max(m_Nodes[stay].Height, m_Nodes[shorter].Height);
+
+		nodeUp.Children[0] = a;
+		nodeUp.Children[1] = taller;
+		nodeUp.Bounds = Union(nodeA.Bounds, m_Nodes[taller].Bounds);
+		nodeUp.Height = 1 + std::max(nodeA.Height, m_Nodes[taller].Height);
+		return up;
+	}
+
+	// Top down: split the centroids where the binned SAH cost is lowest, along the axis they
+	// spread the most on
+	uint32_t DynamicBVH::BuildRange(uint32_t* leaves, uint32_t count, uint32_t depth)
+	{
+		if (count == 1)
+			return leaves[0];
+
+		AABB centroids;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			Vec3 center = m_Nodes[leaves[i]].Bounds.GetCenter();
+			centroids = Union(centroids, AABB(center, center));
+		}
+
+		Vec3 spread = centroids.Max - centroids.Min;
+		float spreads[3] = { spread.GetX(), spread.GetY(), spread.GetZ() };
+		uint32_t axis = spreads[0] > spreads[1] ? (spreads[0] > spreads[2] ? 0 : 2) : (spreads[1] > spreads[2] ? 1 : 2);
+		float low = axis == 0 ? centroids.Min.GetX() : axis == 1 ? centroids.Min.GetY() : centroids.Min.GetZ();
+
+		auto centroid = [this, axis](uint32_t leaf)
+		{
+			Vec3 center = m_Nodes[leaf].Bounds.GetCenter();
+			return axis == 0 ? center.GetX() : axis == 1 ? center.GetY() : center.GetZ();
+		};
+
+		uint32_t middle = 0;
+		if (spreads[axis] > 0.0f && depth < s_MaxSAHDepth)
+		{
+			float scale = (float)s_BuildBins / spreads[axis];
+			auto bin = [&](uint32_t leaf) { return std::min((uint32_t)((centroid(leaf) - low) * scale), s_BuildBins - 1); };
+
+			AABB binBounds[s_BuildBins];
+			uint32_t binCounts[s_BuildBins] = {};
+			for (uint32_t i = 0; i < count; i++)
+			{
+				uint32_t b = bin(leaves[i]);
+				binBounds[b] = Union(binBounds[b], m_Nodes[leaves[i]].Bounds);
+				binCounts[b]++;
+			}
+
+			// Cost of splitting after bin i: left area * left count + right area * right count
+			float leftCosts[s_BuildBins];
+			AABB sweep;
+			uint32_t sweepCount = 0;
+			for (uint32_t i = 0; i < s_BuildBins - 1; i++)
+			{
+				sweep = Union(sweep, binBounds[i]);
+				sweepCount += binCounts[i];
+				leftCosts[i] = sweepCount ? sweep.GetArea() * sweepCount : 0.0f;
+			}
+
+			float bestCost = std::numeric_limits<float>::max();
+			uint32_t bestSplit = 0;
+			sweep = AABB();
+			sweepCount = 0;
+			for (uint32_t i = s_BuildBins - 1; i > 0; i--)
+			{
+				sweep = Union(sweep, binBounds[i]);
+				sweepCount += binCounts[i];
+				uint32_t leftCount = count - sweepCount;
+				float cost = leftCosts[i - 1] + sweep.GetArea() * sweepCount;
+				if (leftCount && sweepCount && cost < bestCost)
+				{
+					bestCost = cost;
+					bestSplit = i;
+				}
+			}
+
+			middle = (uint32_t)(std::partition(leaves, leaves + count, [&](uint32_t leaf) { return bin(leaf) < bestSplit; }) - leaves);
+		}
+
+		if (middle == 0 || middle == count)
+		{
+			middle = count / 2;
+			std::nth_element(leaves, leaves + middle, leaves + count, [&](uint32_t a, uint32_t b) { return centroid(a) < centroid(b); });
+		}
+
+		uint32_t left = BuildRange(leaves, middle, depth + 1);
+		uint32_t right = BuildRange(leaves + middle, count - middle, depth + 1);
+
+		uint32_t index = AllocateNode();
+		Node& node = m_Nodes[index];
+		node.Children[0] = left;
+		node.Children[1] = right;
+		node.Bounds = Union(m_Nodes[left].Bounds, m_Nodes[right].Bounds);
+		node.Height = 1 + std::max(m_Nodes[left].Height, m_Nodes[right].Height);
+		m_Nodes[left].Parent = index;
+		m_Nodes[right].Parent = index;
+		return index;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "RockEngine/Spatial/Bounds.h"
+
+namespace RockEngine
+{
+	// Binary tree of boxes with one leaf (proxy) per object, for objects that come, go and move
+	// at runtime:
+	//  - Insert walks down the side the surface area heuristic (SAH) prefers, then rebalances by
+	//    rotations on the way back up
+	//  - Leaves store their box fattened by a margin, Move only restructures once an object
+	//    leaves it
+	//  - SetBounds changes a box without restructuring, Refit fixes the ancestors afterwards
+	//  - Rebuild makes a fresh binned SAH tree over all proxies when the incremental one degrades
+	// Queries run on a BasicQueryBVH compiled from it.
+	class DynamicBVH
+	{
+	public:
+		static constexpr uint32_t Null = ~0u;
+
+		struct Node
+		{
+			AABB Bounds;			// leaves: fattened ObjectBounds
+			AABB ObjectBounds;		// leaves only
+			uint32_t Parent = Null;	// next free node while free
+			uint32_t Children[2] = { Null, Null };
+			uint32_t UserData = 0;
+			int32_t Height = 0;		// leaves 0, free nodes -1
+
+			inline bool IsLeaf() const { return Children[0] == Null; }
+		};
+
+		explicit DynamicBVH(float margin = 0.1f);
+
+		// Returns the proxy, valid until it's removed
+		uint32_t Insert(const AABB& bounds, uint32_t userData);
+		void Remove(uint32_t proxy);
+		// Returns true if the proxy left its fattened box and was reinserted
+		bool Move(uint32_t proxy, const AABB& bounds);
+		// Leaves the ancestors stale until Refit, for many small moves in one frame
+		void SetBounds(uint32_t proxy, const AABB& bounds);
+		void Refit();
+		void Rebuild();
+
+		inline uint32_t GetRoot() const { return m_Root; }
+		inline const Node& GetNode(uint32_t index) const { return m_Nodes[index]; }
+		inline const AABB& GetBounds(uint32_t proxy) const { return m_Nodes[proxy].ObjectBounds; }
+		inline uint32_t GetUserData(uint32_t proxy) const { return m_Nodes[proxy].UserData; }
+		inline uint32_t GetProxyCount() const { return m_ProxyCount; }
+		inline uint32_t GetHeight() const { return m_Root == Null ? 0 : (uint32_t)m_Nodes[m_Root].Height; }
+		inline bool NeedsRefit() const { return m_NeedsRefit; }
+
+		// Changes with every edit, so compiled query trees know when they're stale
+		inline uint64_t GetVersion() const { return m_Version; }
+
+		// Internal node area summed, relative to the root's: the expected number of nodes a random
+		// ray visits. Lower is better, compare before and after Rebuild.
+		float GetCost() const;
+	private:
+		uint32_t AllocateNode();
+		void FreeNode(uint32_t index);
+
+		void InsertLeaf(uint32_t leaf);
+		void RemoveLeaf(uint32_t leaf);
+		// Rotates the taller grandchild up if the children's heights differ by more than one,
+		// returns the node now at index's place
+		uint32_t Balance(uint32_t index);
+		void FixUpwards(uint32_t index);
+
+		uint32_t BuildRange(uint32_t* leaves, uint32_t count, uint32_t depth);
+	private:
+		std::vector<Node> m_Nodes;
+		uint32_t m_Root = Null;
+		uint32_t m_FreeList = Null;
+		uint32_t m_ProxyCount = 0;
+		float m_Margin;
+
+		uint64_t m_Version = 0;
+		bool m_NeedsRefit = false;
+		std::vector<uint32_t> m_Scratch;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <vector>
+
+#include "RockEngine/Core/Core.h"
+#include "RockEngine/Core/Profiler.h"
+#include "RockEngine/Spatial/CullingKernels.h"
+#include "RockEngine/Spatial/DynamicBVH.h"
+
+namespace RockEngine
+{
+	// Read-only copy of a DynamicBVH for queries: every node holds up to Width children as
+	// structure-of-arrays boxes, so one node is one 4 or 8 lane kernel call. Leaves carry the
+	// objects' own (not fattened) boxes, so results are exact. Compile with Build whenever the
+	// tree's version changed; the queries are const and can run on several threads at once.
+	template<typename Backend, uint32_t Width>
+	class BasicQueryBVH
+	{
+	public:
+		static_assert(Width == 4 || Width == 8, "Query BVH nodes are 4 or 8 wide");
+
+		static constexpr uint32_t NodeWidth = Width;
+
+		using Kernels = CullingKernels<Backend>;
+		using Float = typename Kernels::template Float<Width>;
+
+		// Each node opens the largest of its descendants until it has Width children
+		void Build(const DynamicBVH& tree)
+		{
+			RE_PROFILE_FUNC();
+			RE_CORE_ASSERT(!tree.NeedsRefit(), "DynamicBVH::Refit the tree before compiling it");
+
+			m_Nodes.clear();
+			m_Objects.clear();
+			m_Version = tree.GetVersion();
+			if (tree.GetRoot() == DynamicBVH::Null)
+				return;
+
+			m_Nodes.reserve(tree.GetProxyCount() / (Width - 1) + 1);
+			m_Objects.reserve(tree.GetProxyCount());
+			Collapse(tree, tree.GetRoot());
+		}
+
+		inline bool IsCurrent(const DynamicBVH& tree) const { return m_Version == tree.GetVersion(); }
+		inline uint32_t GetNodeCount() const { return (uint32_t)m_Nodes.size(); }
+		inline uint32_t GetObjectCount() const { return (uint32_t)m_Objects.size(); }
+
+		// Appends the user values of the objects intersecting the frustum, returns how many.
+		// Subtrees entirely inside are appended without testing their boxes.
+		uint32_t CullFrustum(const Frustum& frustum, std::vector<uint32_t>& visible) const
+		{
+			if (m_Nodes.empty())
+				return 0;
+
+			auto lanes = Kernels::template SplatFrustum<Float>(frustum);
+			size_t first = visible.size();
+
+			uint32_t stack[StackSize];
+			uint32_t top = 0;
+			stack[top++] = 0;
+			while (top)
+			{
+				const Node& node = m_Nodes[stack[--top]];
+				const float* bounds[6] = { node.Bounds[0], node.Bounds[1], node.Bounds[2], node.Bounds[3], node.Bounds[4], node.Bounds[5] };
+				uint32_t inside;
+				uint32_t mask = Kernels::TestFrustum(lanes, bounds, inside) & node.LaneMask;
+				for (; mask; mask &= mask - 1)
+				{
+					uint32_t lane = CountTrailingZeros(mask);
+					uint32_t child = node.Children[lane];
+					if (child & LeafBit)
+					{
+						visible.push_back(m_Objects[child & ~LeafBit]);
+					}
+					else if (inside & (1u << lane))
+					{
+						const Node& subtree = m_Nodes[child];
+						visible.insert(visible.end(), m_Objects.begin() + subtree.FirstObject, m_Objects.begin() + subtree.EndObject);
+					}
+					else
+					{
+						RE_CORE_ASSERT(top < StackSize, "Query BVH stack overflow");
+						stack[top++] = child;
+					}
+				}
+			}
+			return (uint32_t)(visible.size() - first);
+		}
+
+		// The closest object box the ray hits within [0, maxT]
+		bool Raycast(const Ray& ray, float maxT, RayHit& hit) const
+		{
+			hit = RayHit();
+			hit.T = maxT;
+			if (m_Nodes.empty())
+				return false;
+
+			auto lanes = Kernels::template SplatRay<Float>(ray);
+			uint32_t stack[StackSize];
+			float stackT[StackSize];
+			uint32_t top = 0;
+			stack[top] = 0;
+			stackT[top++] = 0.0f;
+			while (top)
+			{
+				top--;
+				if (stackT[top] > hit.T)
+					continue;
+
+				const Node& node = m_Nodes[stack[top]];
+				const float* bounds[6] = { node.Bounds[0], node.Bounds[1], node.Bounds[2], node.Bounds[3], node.Bounds[4], node.Bounds[5] };
+				Float entry;
+				uint32_t mask = Kernels::TestRay(lanes, bounds, Float::Splat(hit.T), entry) & node.LaneMask;
+				if (!mask)
+					continue;
+
+				float t[Width];
+				entry.Store(t);
+
+				// Nearest child on top of the stack
+				uint32_t children[Width];
+				float childT[Width];
+				uint32_t childCount = 0;
+				for (; mask; mask &= mask - 1)
+				{
+					uint32_t lane = CountTrailingZeros(mask);
+					uint32_t child = node.Children[lane];
+					if (child & LeafBit)
+					{
+						if (t[lane] < hit.T || hit.Object == ~0u)
+							hit = { m_Objects[child & ~LeafBit], t[lane] };
+						continue;
+					}
+
+					uint32_t i = childCount++;
+					for (; i > 0 && childT[i - 1] < t[lane]; i--)
+					{
+						children[i] = children[i - 1];
+						childT[i] = childT[i - 1];
+					}
+					children[i] = child;
+					childT[i] = t[lane];
+				}
+
+				RE_CORE_ASSERT(top + childCount <= StackSize, "Query BVH stack overflow");
+				for (uint32_t i = 0; i < childCount; i++)
+				{
+					stack[top] = children[i];
+					stackT[top++] = childT[i];
+				}
+			}
+			return hit.Object != ~0u;
+		}
+
+		// Appends every object whose box the ray hits within [0, maxT], in no particular order
+		uint32_t RayQuery(const Ray& ray, float maxT, std::vector<uint32_t>& hits) const
+		{
+			if (m_Nodes.empty())
+				return 0;
+
+			auto lanes = Kernels::template SplatRay<Float>(ray);
+			Float farT = Float::Splat(maxT);
+			size_t first = hits.size();
+
+			uint32_t stack[StackSize];
+			uint32_t top = 0;
+			stack[top++] = 0;
+			while (top)
+			{
+				const Node& node = m_Nodes[stack[--top]];
+				const float* bounds[6] = { node.Bounds[0], node.Bounds[1], node.Bounds[2], node.Bounds[3], node.Bounds[4], node.Bounds[5] };
+				Float entry;
+				uint32_t mask = Kernels::TestRay(lanes, bounds, farT, entry) & node.LaneMask;
+				for (; mask; mask &= mask - 1)
+				{
+					uint32_t child = node.Children[CountTrailingZeros(mask)];
+					if (child & LeafBit)
+					{
+						hits.push_back(m_Objects[child & ~LeafBit]);
+					}
+					else
+					{
+						RE_CORE_ASSERT(top < StackSize, "Query BVH stack overflow");
+						stack[top++] = child;
+					}
+				}
+			}
+			return (uint32_t)(hits.size() - first);
+		}
+	private:
+		static constexpr uint32_t LeafBit = 1u << 31;
+		// Every pop pushes at most Width - 1 more than it took, DynamicBVH keeps its height below 64
+		static constexpr uint32_t StackSize = 64 * Width;
+
+		struct Node
+		{
+			float Bounds[6][Width];		// MinX, MinY, MinZ, MaxX, MaxY, MaxZ per lane
+			uint32_t Children[Width];	// node index, or LeafBit | index into m_Objects
+			uint32_t LaneMask;			// lanes in use
+			uint32_t FirstObject;		// the subtree's objects are m_Objects[FirstObject, EndObject)
+			uint32_t EndObject;
+		};
+
+		uint32_t Collapse(const DynamicBVH& tree, uint32_t root)
+		{
+			uint32_t candidates[Width];
+			uint32_t count = 0;
+			const DynamicBVH::Node& rootNode = tree.GetNode(root);
+			if (rootNode.IsLeaf())
+			{
+				candidates[count++] = root;
+			}
+			else
+			{
+				candidates[count++] = rootNode.Children[0];
+				candidates[count++] = rootNode.Children[1];
+			}
+
+			while (count < Width)
+			{
+				uint32_t open = Width;
+				float openArea = -1.0f;
+				for (uint32_t i = 0; i < count; i++)
+				{
+					const DynamicBVH::Node& candidate = tree.GetNode(candidates[i]);
+					if (!candidate.IsLeaf() && candidate.Bounds.GetArea() > openArea)
+					{
+						open = i;
+						openArea = candidate.Bounds.GetArea();
+					}
+				}
+				if (open == Width)
+					break;
+
+				const DynamicBVH::Node& opened = tree.GetNode(candidates[open]);
+				candidates[open] = opened.Children[0];
+				candidates[count++] = opened.Children[1];
+			}
+
+			uint32_t index = (uint32_t)m_Nodes.size();
+			m_Nodes.emplace_back();
+			m_Nodes[index].LaneMask = (1u << count) - 1;
+			m_Nodes[index].FirstObject = (uint32_t)m_Objects.size();
+
+			for (uint32_t lane = 0; lane < Width; lane++)
+			{
+				AABB box(Vec3(0.0f), Vec3(0.0f));
+				uint32_t child = 0;
+				if (lane < count)
+				{
+					const DynamicBVH::Node& node = tree.GetNode(candidates[lane]);
+					if (node.IsLeaf())
+					{
+						box = node.ObjectBounds;
+						child = LeafBit | (uint32_t)m_Objects.size();
+						m_Objects.push_back(node.UserData);
+					}
+					else
+					{
+						box = node.Bounds;
+						child = Collapse(tree, candidates[lane]);
+					}
+				}
+
+				Node& node = m_Nodes[index];
+				float values[6] = { box.Min.GetX(), box.Min.GetY(), box.Min.GetZ(), box.Max.GetX(), box.Max.GetY(), box.Max.GetZ() };
+				for (uint32_t k = 0; k < 6; k++)
+					node.Bounds[k][lane] = values[k];
+				node.Children[lane] = child;
+			}
+
+			m_Nodes[index].EndObject = (uint32_t)m_Objects.size();
+			return index;
+		}
+	private:
+		std::vector<Node> m_Nodes;
+		std::vector<uint32_t> m_Objects;	// user values, depth first
+		uint64_t m_Version = ~0ull;
+	};
+
+	// As wide as the build's registers: 8 with AVX, 4 otherwise
+#ifdef RE_SIMD_AVX
+	using QueryBVH = BasicQueryBVH<SimdDefault, 8>;
+#else
+	using QueryBVH = BasicQueryBVH<SimdDefault, 4>;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include "pch.h"
+#include "Visibility.h"
+
+#include "RockEngine/Core/JobSystem.h"
+
+namespace RockEngine
+{
+	// Lists shorter than this are recorded inline
+	static constexpr uint32_t s_ParallelSubmitSize = 4096;
+
+	void Visibility::Submit(RenderQueue& queue, const uint32_t* visible, uint32_t count, const Drawable* drawables, const Mat4& viewProjection)
+	{
+		RE_PROFILE_FUNC();
+
+		// Clip z and w of a point are rows 2 and 3 of the matrix
+		float zRow[4], wRow[4];
+		for (uint32_t column = 0; column < 4; column++)
+		{
+			zRow[column] = viewProjection.Get(2, column);
+			wRow[column] = viewProjection.Get(3, column);
+		}
+
+		auto submit = [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; i++)
+			{
+				const Drawable& drawable = drawables[visible[i]];
+				const float* c = drawable.Center;
+				float z = zRow[0] * c[0] + zRow[1] * c[1] + zRow[2] * c[2] + zRow[3];
+				float w = wRow[0] * c[0] + wRow[1] * c[1] + wRow[2] * c[2] + wRow[3];
+				float depth = w > 0.0f ? z / w * 0.5f + 0.5f : 0.0f;
+
+				const DrawCommand& draw = drawable.Draw;
+				queue.Submit(RenderSortKey::Make(drawable.Pass, draw.Shader, draw.Material, RenderSortKey::QuantizeDepth(depth)), draw);
+			}
+		};
+
+		if (count < s_ParallelSubmitSize)
+			submit(0, count);
+		else
+			JobSystem::ParallelFor(count, JobSystem::GetDefaultGrainSize(count, 1024), submit);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+
+#include "RockEngine/Renderer/RenderQueue.h"
+#include "RockEngine/Spatial/QueryBVH.h"
+
+namespace RockEngine
+{
+	// What a cullable object draws. The user value it was inserted into the BVH with indexes an
+	// array of these.
+	struct Drawable
+	{
+		DrawCommand Draw;
+		uint32_t Pass = 0;
+		float Center[3] = {};		// world space, for the sort depth
+	};
+
+	// The step between culling and the render queue: visible lists become keyed draw commands
+	class Visibility
+	{
+	public:
+		// Records one Draw per visible object, keyed opaque (state, then front to back by the
+		// depth of its center). Long lists are recorded from every worker, into their own buffers.
+		static void Submit(RenderQueue& queue, const uint32_t* visible, uint32_t count, const Drawable* drawables, const Mat4& viewProjection);
+
+		// Culls `bvh` against the view and submits what's left. `visible` is scratch that keeps its
+		// storage between frames; afterwards it holds the visible user values.
+		template<typename Backend, uint32_t Width>
+		static uint32_t CullAndSubmit(RenderQueue& queue, const BasicQueryBVH<Backend, Width>& bvh, const Drawable* drawables, const Mat4& viewProjection, std::vector<uint32_t>& visible)
+		{
+			RE_PROFILE_FUNC();
+			visible.clear();
+			uint32_t count = bvh.CullFrustum(Frustum::FromViewProjection(viewProjection), visible);
+			Submit(queue, visible.data(), count, drawables, viewProjection);
+			return count;
+		}
+	};
+}
\ No newline at end of file
@@ -3,12 +3,24 @@
 #include "RockEngine/Core/Application.h"
 #include "RockEngine/EntryPoint.h"
 #include "RockEngine/Core/Log.h"
+#include "RockEngine/Core/Profiler.h"
+#include "RockEngine/Core/JobSystem.h"
+#include "RockEngine/Events/Event.h"
+#include "RockEngine/Memory/STLAllocators.h"
+#include "RockEngine/Memory/MemoryTracker.h"
+#include "RockEngine/Math/Math.h"
+#include "RockEngine/Asset/AssetHotReload.h"
+#include "RockEngine/Asset/TextureImporter.h"
 
 //---------------------------------------------
 
 // --- TheRock Renderer API -------------------
 
 #include "RockEngine/Renderer/RendererAPI.h"
+#include "RockEngine/Renderer/Renderer2D.h"
+#include "RockEngine/Platform/Software/SoftwareRendererBackend.h"
+#include "RockEngine/Scene/Scene.h"
+#include "RockEngine/Scene/SceneLayer.h"
 
 
 //---------------------------------------------
\ No newline at end of file
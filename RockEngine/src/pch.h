@@ -8,7 +8,9 @@
 #include <string>
 #include <array>
 #include <memory>
+#include <algorithm>
 
 // Core
 #include "RockEngine/Core/Log.h"
+#include "RockEngine/Core/Profiler.h"
 #include "RockEngine/Core/Core.h"
\ No newline at end of file
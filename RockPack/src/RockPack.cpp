@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "RockEngine/Core/Core.h"
+#include "RockEngine/Core/Log.h"
+#include "RockEngine/Asset/ArchiveWriter.h"
+
+// 0 unless all of `text` is a number that fits, which the usage check then refuses
+static uint32_t ParseUInt(const char* text)
+{
+	const char* end = text + std::strlen(text);
+	uint32_t value = 0;
+	std::from_chars_result result = std::from_chars(text, end, value);
+	return result.ec == std::errc() && result.ptr == end ? value : 0;
+}
+
+// Packs every file under a directory into one asset archive, named by their path relative to it:
+//   RockPack <input directory> <output archive> [--no-compress] [--align <bytes>] [--verify]
+int main(int argc, char** argv)
+{
+	namespace fs = std::filesystem;
+
+	RockEngine::InitializeCore();
+
+	std::vector<std::string> positional;
+	RockEngine::ArchiveWriterProps props;
+	bool verify = false;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--no-compress")
+			props.Compress = false;
+		else if (arg == "--align" && i + 1 < argc)
+			props.Alignment = ParseUInt(argv[++i]);
+		else if (arg == "--verify")
+			verify = true;
+		else
+			positional.push_back(arg);
+	}
+
+	if (positional.size() != 2 || props.Alignment == 0 || (props.Alignment & (props.Alignment - 1)))
+	{
+		RE_CORE_ERROR("Usage: RockPack <input directory> <output archive> [--no-compress] [--align <power of two>] [--verify]");
+		RockEngine::ShutdownCore();
+		return 1;
+	}
+
+	const fs::path input = positional[0];
+	const std::string output = positional[1];
+
+	std::error_code error;
+	std::vector<fs::path> files;
+	for (const fs::directory_entry& entry : fs::recursive_directory_iterator(input, error))
+	{
+		if (entry.is_regular_file())
+			files.push_back(entry.path());
+	}
+	if (error)
+	{
+		RE_CORE_ERROR("RockPack: can't read {}: {}", input.string(), error.message());
+		RockEngine::ShutdownCore();
+		return 1;
+	}
+
+	// Same input, same archive
+	std::sort(files.begin(), files.end());
+
+	RockEngine::ArchiveWriter writer(props);
+	bool success = true;
+	for (const fs::path& file : files)
+		success &= writer.AddFile(fs::relative(file, input).generic_string(), file.string());
+
+	success = success && writer.Write(output);
+	if (success)
+	{
+		const RockEngine::ArchiveWriterStats& stats = writer.GetStats();
+		RE_CORE_INFO("RockPack: {} assets ({} compressed), {} KB -> {} KB", stats.Assets, stats.Compressed, stats.InputBytes / 1024, stats.FileBytes / 1024);
+	}
+
+	if (success && verify)
+	{
+		RockEngine::AssetArchive archive;
+		success = archive.Open(output);
+		for (uint32_t i = 0; success && i < (uint32_t)files.size(); i++)
+		{
+			std::string name = fs::relative(files[i], input).generic_string();
+			const RockEngine::ArchiveEntry* entry = archive.Find(name);
+			std::vector<uint8_t> packed(entry ? (size_t)entry->Size : 0);
+			std::ifstream stream(files[i], std::ios::binary);
+			std::vector<uint8_t> original((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+			if (!entry || !archive.Read(*entry, packed.data()) || packed != original)
+			{
+				RE_CORE_ERROR("RockPack: {} doesn't match its source", name);
+				success = false;
+			}
+		}
+		if (success)
+			RE_CORE_INFO("RockPack: verified {}", output);
+	}
+
+	RockEngine::ShutdownCore();
+	return success ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "RockEngine/Core/Core.h"
+#include "RockEngine/Core/Hash.h"
+#include "RockEngine/Core/Log.h"
+#include "RockEngine/Core/Profiler.h"
+#include "RockEngine/Core/Window.h"
+#include "RockEngine/Platform/Null/NullRendererBackend.h"
+#include "RockEngine/Platform/OpenGL/OpenGLRendererBackend.h"
+#include "RockEngine/Platform/Software/SoftwareRendererBackend.h"
+#include "RockEngine/Renderer/RenderCapture.h"
+
+namespace
+{
+	struct CommandTiming
+	{
+		uint64_t Count = 0;
+		double TotalMs = 0.0;
+		double MaxMs = 0.0;
+	};
+
+	const char* s_CommandNames[] = { "None", "Clear", "SetClearColor", "SetViewport", "Draw", "DrawQuads" };
+	static_assert(sizeof(s_CommandNames) / sizeof(s_CommandNames[0]) == (size_t)RockEngine::RenderCommandType::Count, "A name for every command");
+
+	double Percentile(const std::vector<double>& sorted, double fraction)
+	{
+		return sorted[std::min(sorted.size() - 1, (size_t)(fraction * (double)sorted.size()))];
+	}
+
+	// The same capture has to produce the same pixels every time
+	uint64_t HashFramebuffer(const RockEngine::SoftwareFramebuffer& framebuffer)
+	{
+		return RockEngine::HashBytes(framebuffer.GetColor(), (size_t)framebuffer.GetWidth() * framebuffer.GetHeight() * sizeof(uint32_t));
+	}
+
+	// 0 unless all of `text` is a number that fits, which the usage check then refuses
+	uint32_t ParseUInt(const char* text)
+	{
+		const char* end = text + std::strlen(text);
+		uint32_t value = 0;
+		std::from_chars_result result = std::from_chars(text, end, value);
+		return result.ec == std::errc() && result.ptr == end ? value : 0;
+	}
+}
+
+// Re-issues the frames of a RenderCapture on a backend and times them, per frame and per command:
+//   RockReplay <capture> [--backend null|software|opengl] [--loops <n>] [--per-command] [--csv <file>] [--png <file>]
+// --per-command executes every command on its own, so a software backend's time includes rasterizing it.
+// OpenGL times are what submission costs the CPU, swaps aren't included.
+int main(int argc, char** argv)
+{
+	RockEngine::InitializeCore();
+
+	std::vector<std::string> positional;
+	std::string backendName = "null", csvPath, pngPath;
+	uint32_t loops = 10;
+	bool perCommand = false;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--backend" && i + 1 < argc)
+			backendName = argv[++i];
+		else if (arg == "--loops" && i + 1 < argc)
+			loops = ParseUInt(argv[++i]);
+		else if (arg == "--per-command")
+			perCommand = true;
+		else if (arg == "--csv" && i + 1 < argc)
+			csvPath = argv[++i];
+		else if (arg == "--png" && i + 1 < argc)
+			pngPath = argv[++i];
+		else
+			positional.push_back(arg);
+	}
+
+	if (positional.size() != 1 || loops == 0 || (backendName != "null" && backendName != "software" && backendName != "opengl"))
+	{
+		RE_CORE_ERROR("Usage: RockReplay <capture> [--backend null|software|opengl] [--loops <n>] [--per-command] [--csv <file>] [--png <file>]");
+		RockEngine::ShutdownCore();
+		return 1;
+	}
+
+	RockEngine::RenderCaptureFile capture;
+	if (!capture.Open(positional[0]) || capture.GetFrameCount() == 0)
+	{
+		RE_CORE_ERROR("RockReplay: no frames to replay in {}", positional[0]);
+		RockEngine::ShutdownCore();
+		return 1;
+	}
+
+	// Everything is decompressed up front, so only the backend is timed
+	const RockEngine::RenderCaptureHeader& header = capture.GetHeader();
+	std::vector<RockEngine::RenderCaptureFrame> frames(capture.GetFrameCount());
+	for (uint32_t i = 0; i < capture.GetFrameCount(); i++)
+	{
+		if (!capture.ReadFrame(i, frames[i]))
+		{
+			RockEngine::ShutdownCore();
+			return 1;
+		}
+	}
+
+	std::unique_ptr<RockEngine::Window> window;
+	std::unique_ptr<RockEngine::RendererBackend> backend;
+	if (backendName == "opengl")
+	{
+		window.reset(RockEngine::Window::Create({ "RockReplay", header.Width, header.Height }, RockEngine::WindowType::GLFW));
+		window->SetVSync(false);
+		backend = std::make_unique<RockEngine::OpenGLRendererBackend>();
+	}
+	else if (backendName == "software")
+		backend = std::make_unique<RockEngine::SoftwareRendererBackend>(header.Width, header.Height);
+	else
+		backend = std::make_unique<RockEngine::NullRendererBackend>();
+	backend->Init();
+	backend->Resize(header.Width, header.Height);
+
+	// Mesh draws and quad texture tables name resources of the captured process (GL names until
+	// there is a resource system), which only the null backend can take. Quads keep drawing with
+	// texture 0, the backends' white texture.
+	uint64_t meshDraws = 0;
+	uint64_t textures = 0;
+	if (backendName != "null")
+	{
+		for (RockEngine::RenderCaptureFrame& frame : frames)
+		{
+			auto draws = std::remove_if(frame.Commands.begin(), frame.Commands.end(), [](const RockEngine::RenderCommand& command) { return command.Type == RockEngine::RenderCommandType::Draw; });
+			meshDraws += frame.Commands.end() - draws;
+			frame.Commands.erase(draws, frame.Commands.end());
+
+			for (uint32_t& texture : frame.Quads.Textures)
+			{
+				textures += texture != 0;
+				texture = 0;
+			}
+		}
+		if (meshDraws)
+			RE_CORE_WARN("RockReplay: skipping {} mesh draws, their meshes aren't in the capture", meshDraws);
+		if (textures)
+			RE_CORE_WARN("RockReplay: drawing {} quad texture bindings with the white texture, their textures aren't in the capture", textures);
+	}
+
+	RE_CORE_INFO("RockReplay: {} frames of {}x{} on the {} backend, {} loops{}", frames.size(), header.Width, header.Height, backendName, loops, perCommand ? ", per command" : "");
+
+	std::vector<double> frameTimes;
+	frameTimes.reserve((size_t)frames.size() * loops);
+	CommandTiming commandTimings[(size_t)RockEngine::RenderCommandType::Count];
+	uint64_t firstHash = 0;
+	bool deterministic = true;
+	for (uint32_t loop = 0; loop < loops; loop++)
+	{
+		for (const RockEngine::RenderCaptureFrame& frame : frames)
+		{
+			backend->SetQuadBatchSource(&frame.Quads, 1);
+			const uint32_t count = (uint32_t)frame.Commands.size();
+
+			uint64_t start = RockEngine::Profiler::Now();
+			if (perCommand)
+			{
+				for (const RockEngine::RenderCommand& command : frame.Commands)
+				{
+					uint64_t commandStart = RockEngine::Profiler::Now();
+					backend->Execute(&command, 1);
+					double ms = (double)(RockEngine::Profiler::Now() - commandStart) / 1e6;
+
+					CommandTiming& timing = commandTimings[(size_t)command.Type];
+					timing.Count++;
+					timing.TotalMs += ms;
+					timing.MaxMs = std::max(timing.MaxMs, ms);
+				}
+			}
+			else
+			{
+				backend->Execute(frame.Commands.data(), count);
+			}
+			frameTimes.push_back((double)(RockEngine::Profiler::Now() - start) / 1e6);
+
+			if (window)
+				window->OnUpdate();
+		}
+
+		if (backendName == "software")
+		{
+			uint64_t hash = HashFramebuffer(static_cast<RockEngine::SoftwareRendererBackend&>(*backend).GetFramebuffer());
+			if (loop == 0)
+				firstHash = hash;
+			else
+				deterministic &= hash == firstHash;
+		}
+	}
+	backend->SetQuadBatchSource(nullptr, 0);
+
+	if (!csvPath.empty())
+	{
+		std::ofstream csv(csvPath);
+		csv << "loop,frame,ms\n";
+		for (size_t i = 0; i < frameTimes.size(); i++)
+			csv << i / frames.size() << ',' << i % frames.size() << ',' << frameTimes[i] << '\n';
+		if (!csv)
+			RE_CORE_ERROR("RockReplay: can't write {}", csvPath);
+	}
+
+	double totalMs = 0.0;
+	for (double ms : frameTimes)
+		totalMs += ms;
+	std::vector<double> sorted = frameTimes;
+	std::sort(sorted.begin(), sorted.end());
+	RE_CORE_INFO("  frame ms: mean {:.3f}, min {:.3f}, median {:.3f}, p95 {:.3f}, max {:.3f}",
+		totalMs / sorted.size(), sorted.front(), Percentile(sorted, 0.5), Percentile(sorted, 0.95), sorted.back());
+
+	if (perCommand)
+	{
+		for (uint32_t type = 1; type < (uint32_t)RockEngine::RenderCommandType::Count; type++)
+		{
+			const CommandTiming& timing = commandTimings[type];
+			if (timing.Count)
+				RE_CORE_INFO("  {:<14} {:>9} commands, {:>10.3f} ms total, {:>8.4f} ms mean, {:>8.3f} ms max",
+					s_CommandNames[type], timing.Count, timing.TotalMs, timing.TotalMs / timing.Count, timing.MaxMs);
+		}
+	}
+
+	bool success = true;
+	if (backendName == "software")
+	{
+		RockEngine::SoftwareFramebuffer& framebuffer = static_cast<RockEngine::SoftwareRendererBackend&>(*backend).GetFramebuffer();
+		RE_CORE_INFO("  last frame hash {:016x}", firstHash);
+		if (!deterministic)
+		{
+			RE_CORE_ERROR("RockReplay: the last frame differs between loops");
+			success = false;
+		}
+		if (!pngPath.empty())
+			success &= framebuffer.SavePNG(pngPath);
+	}
+	else if (!pngPath.empty())
+	{
+		RE_CORE_WARN("RockReplay: --png needs the software backend");
+	}
+
+	backend->Shutdown();
+	backend.reset();
+	window.reset();
+	RockEngine::ShutdownCore();
+	return success ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <TheRock.h>
+
+namespace RockEngine
+{
+	namespace Particles
+	{
+		struct Position { float X, Y; };
+		struct Velocity { float X, Y; };
+		struct Sprite { uint32_t Color; };
+		struct Lifetime { float Remaining; };
+	}
+
+	// Bouncing quads in a SceneLayer: movement is a parallel fixed-step system, expired particles
+	// are respawned through the command buffer, drawing goes through Renderer2D
+	class ParticleLayer : public SceneLayer
+	{
+	public:
+		ParticleLayer(uint32_t count, float width, float height)
+			: SceneLayer("Particles"), m_Width(width), m_Height(height)
+		{
+			DeclareWrite("Renderer2D");
+
+			for (uint32_t i = 0; i < count; i++)
+				GetScene().CreateEntity(RandomPosition(), RandomVelocity(), Particles::Sprite{ RandomColor() }, Particles::Lifetime{ RandomLifetime() });
+
+			AddFixedSystem("Move", [this](Scene& scene, Timestep ts)
+			{
+				float dt = ts.GetSeconds();
+				scene.ParallelEach<Particles::Position, Particles::Velocity>([&](Particles::Position& position, Particles::Velocity& velocity)
+				{
+					position.X += velocity.X * dt;
+					position.Y += velocity.Y * dt;
+					if (position.X < 0.0f || position.X > m_Width)
+						velocity.X = -velocity.X;
+					if (position.Y < 0.0f || position.Y > m_Height)
+						velocity.Y = -velocity.Y;
+				});
+			});
+
+			AddFixedSystem("Respawn", [this](Scene& scene, Timestep ts)
+			{
+				EntityCommandBuffer& commands = scene.GetCommandBuffer();
+				scene.Each<Particles::Lifetime>([&](Entity entity, Particles::Lifetime& lifetime)
+				{
+					lifetime.Remaining -= ts.GetSeconds();
+					if (lifetime.Remaining <= 0.0f)
+					{
+						commands.Destroy(entity);
+						Spawn(commands.Create(), commands);
+					}
+				});
+			});
+
+			AddSystem("Draw", [this](Scene& scene, Timestep)
+			{
+				Mat4 viewProjection = Mat4::Orthographic(0.0f, m_Width, 0.0f, m_Height, -1.0f, 1.0f);
+				Renderer2D::BeginScene(viewProjection.Data());
+				scene.EachChunk<Particles::Position, Particles::Sprite>([](uint32_t count, const Entity*, const Particles::Position* positions, const Particles::Sprite* sprites)
+				{
+					for (uint32_t i = 0; i < count; i++)
+						Renderer2D::DrawQuad(positions[i].X, positions[i].Y, 4.0f, 4.0f, sprites[i].Color);
+				});
+				Renderer2D::EndScene();
+			});
+		}
+	private:
+		float Random()
+		{
+			m_Random = m_Random * 1664525u + 1013904223u;
+			return (float)(m_Random >> 8) / (float)(1u << 24);
+		}
+
+		Particles::Position RandomPosition() { return { Random() * m_Width, Random() * m_Height }; }
+		Particles::Velocity RandomVelocity() { return { (Random() - 0.5f) * 400.0f, (Random() - 0.5f) * 400.0f }; }
+		uint32_t RandomColor() { return PackColor(Random(), Random(), Random(), 1.0f); }
+		float RandomLifetime() { return 1.0f + Random() * 4.0f; }
+
+		void Spawn(Entity entity, EntityCommandBuffer& commands)
+		{
+			commands.Add(entity, RandomPosition());
+			commands.Add(entity, RandomVelocity());
+			commands.Add(entity, Particles::Sprite{ RandomColor() });
+			commands.Add(entity, Particles::Lifetime{ RandomLifetime() });
+		}
+	private:
+		float m_Width;
+		float m_Height;
+		uint32_t m_Random = 1;
+	};
+}
\ No newline at end of file
@@ -1,11 +1,42 @@
+#include <filesystem>
+
 #include "TheRock.h"
+#include "ParticleLayer.h"
 
 class Sandbox : public RockEngine::Application
 {
 public:
-	Sandbox(const RockEngine::ApplicationProps& props)
-		: RockEngine::Application(props)
-	{}
+	Sandbox(const RockEngine::ApplicationProps& props, uint32_t particles, const std::string& screenshot, const std::string& textures)
+		: RockEngine::Application(props), m_Screenshot(screenshot)
+	{
+		if (particles)
+			PushLayer(new RockEngine::ParticleLayer(particles, (float)props.WindowWidth, (float)props.WindowHeight));
+
+		// Nothing consumes them yet: every file is preprocessed like a shader and its reloads logged
+		if (RockEngine::AssetHotReload::IsRunning())
+		{
+			std::error_code error;
+			for (const auto& entry : std::filesystem::recursive_directory_iterator(props.HotReloadDirectory, error))
+			{
+				if (entry.is_regular_file())
+					RockEngine::AssetHotReload::Register(std::filesystem::relative(entry.path(), props.HotReloadDirectory).generic_string(),
+						entry.path().string(), RockEngine::AssetHotReload::ExpandIncludes, nullptr);
+			}
+		}
+
+		if (!textures.empty())
+			ImportTextures(textures);
+	}
+
+	~Sandbox()
+	{
+		if (!m_Screenshot.empty() && RockEngine::RendererAPI::GetType() == RockEngine::RendererAPIType::Software)
+		{
+			auto& backend = static_cast<RockEngine::SoftwareRendererBackend&>(RockEngine::RendererAPI::GetBackend());
+			if (backend.GetFramebuffer().SavePNG(m_Screenshot))
+				RE_CORE_INFO("Saved the last frame to {}", m_Screenshot);
+		}
+	}
 
 	/*void OnInit() override
 	{
@@ -13,13 +44,118 @@ public:
 	}
 	virtual void OnShutdown(){}
 	virtual void OnUpdate(){}*/
+private:
+	// Nothing renders them yet: every image is imported with mips and BC compression and the
+	// totals logged, a second run should find them all in the cache
+	void ImportTextures(const std::string& directory)
+	{
+		m_TextureStart = RockEngine::Profiler::Now();
+		std::error_code error;
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(directory, error))
+		{
+			std::string extension = entry.path().extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+			if (!entry.is_regular_file() || (extension != ".png" && extension != ".jpg" && extension != ".jpeg" && extension != ".tga"))
+				continue;
+
+			RockEngine::TextureImportSettings settings;
+			settings.Compression = RockEngine::TextureCompression::Auto;
+			m_TexturesPending++;
+			RockEngine::TextureImporter::Import(entry.path().string(), settings, [this](RockEngine::TextureImportResult& result)
+			{
+				m_TexturesCached += result.Status == RockEngine::TextureImportStatus::Cached;
+				m_TexturesFailed += result.Status == RockEngine::TextureImportStatus::Failed;
+				m_TextureBytes += result.Texture.Data.GetSize();
+				if (--m_TexturesPending == 0)
+				{
+					RE_CORE_INFO("Imported {} textures ({} from the cache, {} failed), {:.1f} MB of mips in {:.1f} ms", m_TexturesImported,
+						m_TexturesCached, m_TexturesFailed, m_TextureBytes / (1024.0 * 1024.0), (RockEngine::Profiler::Now() - m_TextureStart) / 1e6);
+				}
+			});
+			m_TexturesImported++;
+		}
+		if (!m_TexturesImported)
+			RE_CORE_WARN("No textures in {}", directory);
+	}
+
+	std::string m_Screenshot;
+	uint32_t m_TexturesImported = 0;
+	uint32_t m_TexturesPending = 0;
+	uint32_t m_TexturesCached = 0;
+	uint32_t m_TexturesFailed = 0;
+	uint64_t m_TextureBytes = 0;
+	uint64_t m_TextureStart = 0;
 };
 
-RockEngine::Application* RockEngine::CreateApplication()
+RockEngine::Application* RockEngine::CreateApplication(RockEngine::ApplicationCommandLineArgs args)
 {
 	RockEngine::ApplicationProps props;
 	props.WindowHeight = 1600;
 	props.WindowWidth = 1600;
 	props.Name = "Title";
-	return new Sandbox(props);
+
+	// --headless [frames]: no display, null renderer, e.g. for CI and soak runs
+	// --render-thread [frames in flight]: present from a dedicated render thread
+	// --fps <cap>, --no-vsync: frame pacing
+	// --scene [particles]: bouncing quads from a SceneLayer
+	// --software [png]: no display, rendered on the CPU, the last frame saved (TheRock.png)
+	// --capture <file> [frames]: record the renderer's command streams for RockReplay (60 frames)
+	// --idle-ui: only rebuild the UI after input, or a few times a second for live panels
+	// --hot-reload <dir>: watch a directory, reprocessing its files as they change
+	// --textures <dir>: import every PNG, JPEG and TGA in a directory through the texture cache
+	uint32_t particles = 0;
+	bool software = false;
+	std::string screenshot;
+	std::string textures;
+	for (int i = 1; i < args.Count; i++)
+	{
+		bool hasNumber = i + 1 < args.Count && args[i + 1][0] >= '0' && args[i + 1][0] <= '9';
+		if (std::string(args[i]) == "--headless")
+		{
+			props.Window = RockEngine::WindowType::Headless;
+			props.Renderer = RockEngine::RendererAPIType::Null;
+			if (hasNumber)
+				props.FrameLimit = std::stoull(args[++i]);
+		}
+		else if (std::string(args[i]) == "--render-thread")
+		{
+			props.RenderThread = true;
+			if (hasNumber)
+				props.FramesInFlight = (uint32_t)std::stoul(args[++i]);
+		}
+		else if (std::string(args[i]) == "--fps" && hasNumber)
+			props.Timing.MaxFrameRate = std::stof(args[++i]);
+		else if (std::string(args[i]) == "--no-vsync")
+			props.Timing.VSync = false;
+		else if (std::string(args[i]) == "--scene")
+			particles = hasNumber ? (uint32_t)std::stoul(args[++i]) : 10000;
+		else if (std::string(args[i]) == "--software")
+		{
+			software = true;
+			screenshot = i + 1 < args.Count && args[i + 1][0] != '-' ? args[++i] : "TheRock.png";
+		}
+		else if (std::string(args[i]) == "--capture" && i + 1 < args.Count)
+		{
+			props.CapturePath = args[++i];
+			if (i + 1 < args.Count && args[i + 1][0] >= '0' && args[i + 1][0] <= '9')
+				props.CaptureFrames = (uint32_t)std::stoul(args[++i]);
+		}
+		else if (std::string(args[i]) == "--idle-ui")
+			props.IdleUI.Enabled = true;
+		else if (std::string(args[i]) == "--hot-reload" && i + 1 < args.Count)
+			props.HotReloadDirectory = args[++i];
+		else if (std::string(args[i]) == "--textures" && i + 1 < args.Count)
+			textures = args[++i];
+	}
+	if (software)
+	{
+		props.Window = RockEngine::WindowType::Headless;
+		props.Renderer = RockEngine::RendererAPIType::Software;
+	}
+
+	// Only checked in --memory-tracking builds
+	RockEngine::MemoryTracker::SetBudget("ImGui", { 16 * 1024 * 1024, 0 });
+	RockEngine::MemoryTracker::SetBudget("Renderer", { 0, 64 });
+
+	return new Sandbox(props, particles, screenshot, textures);
 }
\ No newline at end of file
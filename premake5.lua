@@ -11,6 +11,26 @@ workspace "RockEngine"
     
 outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
 
+newoption
+{
+	trigger = "memory-tracking",
+	description = "Route every allocation through the MemoryTracker (per-subsystem stats and budgets)"
+}
+
+filter "options:memory-tracking"
+	defines "RE_ENABLE_MEMORY_TRACKING"
+filter {}
+
+newoption
+{
+	trigger = "avx",
+	description = "Target AVX2: the math library's default backend (Vec3, Mat4, Batch, ...) becomes SimdAVX"
+}
+
+filter "options:avx"
+	vectorextensions "AVX2"
+filter {}
+
 include "Dependencies.lua"
 
 group "Dependencies"
@@ -63,11 +83,30 @@ project "RockEngine"
 		{ 
             "RE_PLATFORM_WINDOWS"
 		}
+
+	filter "system:linux"
+		cppdialect "C++17"
+        staticruntime "On"
+
+		defines 
+		{ 
+            "RE_PLATFORM_LINUX"
+		}
 					
     filter "configurations:Debug"
         defines "RE_DEBUG"
 		runtime "Debug"
         symbols "On"
+
+    filter "configurations:Release"
+        defines "RE_RELEASE"
+		runtime "Release"
+        optimize "On"
+
+    filter "configurations:Dist"
+        defines "RE_DIST"
+		runtime "Release"
+        optimize "On"
 group ""
 
 group "Tools"
@@ -113,10 +152,278 @@ project "TheRock"
 		{ 
             "RE_PLATFORM_WINDOWS",
 		}
+
+	filter "system:linux"
+        cppdialect "C++17"
+        staticruntime "On"
+        
+		links 
+		{ 
+			"RockEngine",
+			"imgui",
+			"GLFW",
+			"Glad",
+			"GL",
+			"X11",
+			"pthread",
+			"dl"
+		}
+        
+		defines 
+		{ 
+            "RE_PLATFORM_LINUX",
+		}
+    
+   filter "configurations:Debug"
+        defines "RE_DEBUG"
+		runtime "Debug"
+        symbols "On"
+
+   filter "configurations:Release"
+        defines "RE_RELEASE"
+		runtime "Release"
+        optimize "On"
+
+   filter "configurations:Dist"
+        defines "RE_DIST"
+		runtime "Release"
+        optimize "On"
+
+project "RockPack"
+    location "RockPack"
+    kind "ConsoleApp"
+    language "C++"
+    
+	targetdir ("build/bin/" .. outputdir .. "/%{prj.name}")
+    objdir ("build/bin-int/" .. outputdir .. "/%{prj.name}")
+
+	dependson 
+	{ 
+		"RockEngine"
+    }
+    
+	files 
+	{ 
+		"%{prj.name}/**.h", 
+		"%{prj.name}/**.c", 
+		"%{prj.name}/**.hpp", 
+		"%{prj.name}/**.cpp" 
+	}
+    
+	includedirs 
+	{
+        "%{prj.name}/src",
+        "RockEngine/src",
+        "RockEngine/vendor",
+    }
+	
+	filter "system:windows"
+        cppdialect "C++17"
+        staticruntime "On"
+        
+		links 
+		{ 
+			"RockEngine",
+			"%{LinksDir.ImGui}"
+		}
+        
+		defines 
+		{ 
+            "RE_PLATFORM_WINDOWS",
+		}
+
+	filter "system:linux"
+        cppdialect "C++17"
+        staticruntime "On"
+        
+		links 
+		{ 
+			"RockEngine",
+			"imgui",
+			"GLFW",
+			"Glad",
+			"GL",
+			"X11",
+			"pthread",
+			"dl"
+		}
+        
+		defines 
+		{ 
+            "RE_PLATFORM_LINUX",
+		}
     
    filter "configurations:Debug"
         defines "RE_DEBUG"
 		runtime "Debug"
         symbols "On"
+
+   filter "configurations:Release"
+        defines "RE_RELEASE"
+		runtime "Release"
+        optimize "On"
+
+   filter "configurations:Dist"
+        defines "RE_DIST"
+		runtime "Release"
+        optimize "On"
+
+project "RockReplay"
+    location "RockReplay"
+    kind "ConsoleApp"
+    language "C++"
+    
+	targetdir ("build/bin/" .. outputdir .. "/%{prj.name}")
+    objdir ("build/bin-int/" .. outputdir .. "/%{prj.name}")
+
+	dependson 
+	{ 
+		"RockEngine"
+    }
+    
+	files 
+	{ 
+		"%{prj.name}/**.h", 
+		"%{prj.name}/**.c", 
+		"%{prj.name}/**.hpp", 
+		"%{prj.name}/**.cpp" 
+	}
+    
+	includedirs 
+	{
+        "%{prj.name}/src",
+        "RockEngine/src",
+        "RockEngine/vendor",
+    }
+	
+	filter "system:windows"
+        cppdialect "C++17"
+        staticruntime "On"
+        
+		links 
+		{ 
+			"RockEngine",
+			"%{LinksDir.ImGui}"
+		}
+        
+		defines 
+		{ 
+            "RE_PLATFORM_WINDOWS",
+		}
+
+	filter "system:linux"
+        cppdialect "C++17"
+        staticruntime "On"
+        
+		links 
+		{ 
+			"RockEngine",
+			"imgui",
+			"GLFW",
+			"Glad",
+			"GL",
+			"X11",
+			"pthread",
+			"dl"
+		}
+        
+		defines 
+		{ 
+            "RE_PLATFORM_LINUX",
+		}
+    
+   filter "configurations:Debug"
+        defines "RE_DEBUG"
+		runtime "Debug"
+        symbols "On"
+
+   filter "configurations:Release"
+        defines "RE_RELEASE"
+		runtime "Release"
+        optimize "On"
+
+   filter "configurations:Dist"
+        defines "RE_DIST"
+		runtime "Release"
+        optimize "On"
+
+project "RockBench"
+    location "RockBench"
+    kind "ConsoleApp"
+    language "C++"
+    
+	targetdir ("build/bin/" .. outputdir .. "/%{prj.name}")
+    objdir ("build/bin-int/" .. outputdir .. "/%{prj.name}")
+
+	dependson 
+	{ 
+		"RockEngine"
+    }
+    
+	files 
+	{ 
+		"%{prj.name}/**.h", 
+		"%{prj.name}/**.c", 
+		"%{prj.name}/**.hpp", 
+		"%{prj.name}/**.cpp" 
+	}
+    
+	includedirs 
+	{
+        "%{prj.name}/src",
+        "RockEngine/src",
+        "RockEngine/vendor",
+    }
+	
+	filter "system:windows"
+        cppdialect "C++17"
+        staticruntime "On"
+        
+		links 
+		{ 
+			"RockEngine",
+			"%{LinksDir.ImGui}"
+		}
+        
+		defines 
+		{ 
+            "RE_PLATFORM_WINDOWS",
+		}
+
+	filter "system:linux"
+        cppdialect "C++17"
+        staticruntime "On"
+        
+		links 
+		{ 
+			"RockEngine",
+			"imgui",
+			"GLFW",
+			"Glad",
+			"GL",
+			"X11",
+			"pthread",
+			"dl"
+		}
+        
+		defines 
+		{ 
+            "RE_PLATFORM_LINUX",
+		}
+    
+   filter "configurations:Debug"
+        defines "RE_DEBUG"
+		runtime "Debug"
+        symbols "On"
+
+   filter "configurations:Release"
+        defines "RE_RELEASE"
+		runtime "Release"
+        optimize "On"
+
+   filter "configurations:Dist"
+        defines "RE_DIST"
+		runtime "Release"
+        optimize "On"
 group ""   
   
\ No newline at end of file